@@ -364,6 +364,78 @@ def instantiateComponent(usbDeviceComponent):
 	usbDeviceFeatureEnableAutioTimeRemoteWakeup.setLabel("Use Auto Timed Remote Wake up Functions")	
 	usbDeviceFeatureEnableAutioTimeRemoteWakeup.setVisible(False)	
 	
+	# Endpoint statistics enable 
+	usbDeviceFeatureEnableStatistics = usbDeviceComponent.createBooleanSymbol("CONFIG_USB_DEVICE_FEATURE_ENABLE_STATISTICS", usbDeviceFeatureEnable)
+	usbDeviceFeatureEnableStatistics.setLabel("Enable Endpoint Statistics")
+	usbDeviceFeatureEnableStatistics.setVisible(True)
+	usbDeviceFeatureEnableStatistics.setDefaultValue(False)
+	
+	# Number of endpoints for which statistics are collected 
+	usbDeviceStatisticsEndpointsNumber = usbDeviceComponent.createIntegerSymbol("CONFIG_USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER", usbDeviceFeatureEnableStatistics)
+	usbDeviceStatisticsEndpointsNumber.setLabel("Number of Endpoints")
+	usbDeviceStatisticsEndpointsNumber.setVisible(False)
+	usbDeviceStatisticsEndpointsNumber.setMin(1)
+	usbDeviceStatisticsEndpointsNumber.setMax(16)
+	usbDeviceStatisticsEndpointsNumber.setDefaultValue(4)
+	usbDeviceStatisticsEndpointsNumber.setDependencies(setVisible, ["CONFIG_USB_DEVICE_FEATURE_ENABLE_STATISTICS"])
+	
+	# Size of the IRP tracking table 
+	usbDeviceStatisticsIrpsNumber = usbDeviceComponent.createIntegerSymbol("CONFIG_USB_DEVICE_STATISTICS_IRPS_NUMBER", usbDeviceFeatureEnableStatistics)
+	usbDeviceStatisticsIrpsNumber.setLabel("Number of Tracked IRPs")
+	usbDeviceStatisticsIrpsNumber.setVisible(False)
+	usbDeviceStatisticsIrpsNumber.setMin(1)
+	usbDeviceStatisticsIrpsNumber.setMax(255)
+	usbDeviceStatisticsIrpsNumber.setDefaultValue(16)
+	usbDeviceStatisticsIrpsNumber.setDependencies(setVisible, ["CONFIG_USB_DEVICE_FEATURE_ENABLE_STATISTICS"])
+	
+	# Statistics vendor request 
+	usbDeviceStatisticsVendorRequest = usbDeviceComponent.createIntegerSymbol("CONFIG_USB_DEVICE_STATISTICS_VENDOR_REQUEST", usbDeviceFeatureEnableStatistics)
+	usbDeviceStatisticsVendorRequest.setLabel("Statistics Vendor Request (0 to disable)")
+	usbDeviceStatisticsVendorRequest.setVisible(False)
+	usbDeviceStatisticsVendorRequest.setMin(0)
+	usbDeviceStatisticsVendorRequest.setMax(255)
+	usbDeviceStatisticsVendorRequest.setDefaultValue(0)
+	usbDeviceStatisticsVendorRequest.setDependencies(setVisible, ["CONFIG_USB_DEVICE_FEATURE_ENABLE_STATISTICS"])
+	
+	# Bounce buffers for IRPs with data segments 
+	usbDeviceFeatureEnableIrpBounce = usbDeviceComponent.createBooleanSymbol("CONFIG_USB_DEVICE_FEATURE_ENABLE_IRP_BOUNCE_BUFFERS", usbDeviceFeatureEnable)
+	usbDeviceFeatureEnableIrpBounce.setLabel("Enable Bounce Buffers for Segmented IRPs")
+	usbDeviceFeatureEnableIrpBounce.setVisible(True)
+	usbDeviceFeatureEnableIrpBounce.setDefaultValue(False)
+	
+	# Number of bounce buffers 
+	usbDeviceIrpBounceBuffersNumber = usbDeviceComponent.createIntegerSymbol("CONFIG_USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER", usbDeviceFeatureEnableIrpBounce)
+	usbDeviceIrpBounceBuffersNumber.setLabel("Number of Bounce Buffers")
+	usbDeviceIrpBounceBuffersNumber.setVisible(False)
+	usbDeviceIrpBounceBuffersNumber.setMin(1)
+	usbDeviceIrpBounceBuffersNumber.setMax(32)
+	usbDeviceIrpBounceBuffersNumber.setDefaultValue(2)
+	usbDeviceIrpBounceBuffersNumber.setDependencies(setVisible, ["CONFIG_USB_DEVICE_FEATURE_ENABLE_IRP_BOUNCE_BUFFERS"])
+	
+	# Size of each bounce buffer 
+	usbDeviceIrpBounceBufferSize = usbDeviceComponent.createIntegerSymbol("CONFIG_USB_DEVICE_IRP_BOUNCE_BUFFER_SIZE", usbDeviceFeatureEnableIrpBounce)
+	usbDeviceIrpBounceBufferSize.setLabel("Bounce Buffer Size")
+	usbDeviceIrpBounceBufferSize.setVisible(False)
+	usbDeviceIrpBounceBufferSize.setMin(1)
+	usbDeviceIrpBounceBufferSize.setMax(65535)
+	usbDeviceIrpBounceBufferSize.setDefaultValue(512)
+	usbDeviceIrpBounceBufferSize.setDependencies(setVisible, ["CONFIG_USB_DEVICE_FEATURE_ENABLE_IRP_BOUNCE_BUFFERS"])
+	
+	# Shared function driver IRP pool 
+	usbDeviceFeatureEnableIrpPool = usbDeviceComponent.createBooleanSymbol("CONFIG_USB_DEVICE_FEATURE_ENABLE_IRP_POOL", usbDeviceFeatureEnable)
+	usbDeviceFeatureEnableIrpPool.setLabel("Share IRP Pool across Function Drivers")
+	usbDeviceFeatureEnableIrpPool.setVisible(True)
+	usbDeviceFeatureEnableIrpPool.setDefaultValue(False)
+	
+	# Number of IRPs in the shared pool 
+	usbDeviceIrpPoolSize = usbDeviceComponent.createIntegerSymbol("CONFIG_USB_DEVICE_IRP_POOL_SIZE", usbDeviceFeatureEnableIrpPool)
+	usbDeviceIrpPoolSize.setLabel("Number of IRPs in the Pool")
+	usbDeviceIrpPoolSize.setVisible(False)
+	usbDeviceIrpPoolSize.setMin(1)
+	usbDeviceIrpPoolSize.setMax(65535)
+	usbDeviceIrpPoolSize.setDefaultValue(8)
+	usbDeviceIrpPoolSize.setDependencies(setVisible, ["CONFIG_USB_DEVICE_FEATURE_ENABLE_IRP_POOL"])
+	
 	# USB Device EP0 Buffer Size  
 	usbDeviceEp0BufferSize = usbDeviceComponent.createComboSymbol("CONFIG_USB_DEVICE_EP0_BUFFER_SIZE", None, usbDeviceEp0BufferSizes)
 	usbDeviceEp0BufferSize.setLabel("Endpoint 0 Buffer Size")
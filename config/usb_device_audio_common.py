@@ -21,7 +21,24 @@
 * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
 *****************************************************************************"""
 
+def showOnStreamEnable(symbol, event):
+	symbol.setVisible(event["value"])
+
 def instantiateComponent(usbAudioComponentCommon):
+	usbDeviceAudioV2StreamEnable = usbAudioComponentCommon.createBooleanSymbol("CONFIG_USB_DEVICE_AUDIO_V2_STREAM_ENABLE", None)
+	usbDeviceAudioV2StreamEnable.setLabel("Enable Audio 2.0 Streaming Engine")
+	usbDeviceAudioV2StreamEnable.setDescription("Adds isochronous streams with explicit feedback that the application reads and writes in place")
+	usbDeviceAudioV2StreamEnable.setDefaultValue(False)
+	usbDeviceAudioV2StreamEnable.setVisible(True)
+
+	usbDeviceAudioV2StreamPackets = usbAudioComponentCommon.createIntegerSymbol("CONFIG_USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER", usbDeviceAudioV2StreamEnable)
+	usbDeviceAudioV2StreamPackets.setLabel("Number of Packets per Stream")
+	usbDeviceAudioV2StreamPackets.setMin(2)
+	usbDeviceAudioV2StreamPackets.setMax(64)
+	usbDeviceAudioV2StreamPackets.setDefaultValue(16)
+	usbDeviceAudioV2StreamPackets.setVisible(False)
+	usbDeviceAudioV2StreamPackets.setDependencies(showOnStreamEnable, ["CONFIG_USB_DEVICE_AUDIO_V2_STREAM_ENABLE"])
+
 	################################################
 	# system_config.h file for USB Device stack    
 	################################################
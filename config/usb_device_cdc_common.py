@@ -33,6 +33,9 @@ def handleMessage(messageID, args):
 		usbDeviceCdcQueuDepth.setValue(args["cdcQueueDepth"])
 	return args
 	
+def showOnStreamEnable(symbol, event):
+	symbol.setVisible(event["value"])
+
 def instantiateComponent(usbCdcComponentCommon):
 	global usbDeviceCdcInstnces
 	global usbDeviceCdcQueuDepth
@@ -54,6 +57,28 @@ def instantiateComponent(usbCdcComponentCommon):
 	usbDeviceCdcQueuDepth.setDefaultValue(3)
 	#usbDeviceCdcQueuDepth.setUseSingleDynamicValue(True)
 	usbDeviceCdcQueuDepth.setVisible(True)
+
+	usbDeviceCdcStreamEnable = usbCdcComponentCommon.createBooleanSymbol("CONFIG_USB_DEVICE_CDC_STREAM_ENABLE", None)
+	usbDeviceCdcStreamEnable.setLabel("Enable Streaming Mode")
+	usbDeviceCdcStreamEnable.setDescription("Adds driver owned receive and transmit rings that the application reads and writes in place")
+	usbDeviceCdcStreamEnable.setDefaultValue(False)
+	usbDeviceCdcStreamEnable.setVisible(True)
+
+	usbDeviceCdcStreamBufferSize = usbCdcComponentCommon.createIntegerSymbol("CONFIG_USB_DEVICE_CDC_STREAM_BUFFER_SIZE", usbDeviceCdcStreamEnable)
+	usbDeviceCdcStreamBufferSize.setLabel("Ring Size (Bytes)")
+	usbDeviceCdcStreamBufferSize.setMin(128)
+	usbDeviceCdcStreamBufferSize.setMax(65536)
+	usbDeviceCdcStreamBufferSize.setDefaultValue(4096)
+	usbDeviceCdcStreamBufferSize.setVisible(False)
+	usbDeviceCdcStreamBufferSize.setDependencies(showOnStreamEnable, ["CONFIG_USB_DEVICE_CDC_STREAM_ENABLE"])
+
+	usbDeviceCdcStreamIrpsNumber = usbCdcComponentCommon.createIntegerSymbol("CONFIG_USB_DEVICE_CDC_STREAM_IRPS_NUMBER", usbDeviceCdcStreamEnable)
+	usbDeviceCdcStreamIrpsNumber.setLabel("Number of IRPs per Endpoint")
+	usbDeviceCdcStreamIrpsNumber.setMin(1)
+	usbDeviceCdcStreamIrpsNumber.setMax(16)
+	usbDeviceCdcStreamIrpsNumber.setDefaultValue(2)
+	usbDeviceCdcStreamIrpsNumber.setVisible(False)
+	usbDeviceCdcStreamIrpsNumber.setDependencies(showOnStreamEnable, ["CONFIG_USB_DEVICE_CDC_STREAM_ENABLE"])
 	
 	################################################
 	# system_config.h file for USB Device stack    
@@ -21,7 +21,13 @@
 * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
 *****************************************************************************"""
 usbDeviceMsdInstnces = None
-usbDeviceMsdMaxNumberofSectors = ["1", "2", "4", "8"]	
+usbDeviceMsdMaxNumberofSectors = ["1", "2", "4", "8", "16", "32", "64"]	
+
+def showOnWriteCacheEnable(symbol, event):
+	symbol.setVisible(event["value"])
+
+def showOnReadAheadEnable(symbol, event):
+	symbol.setVisible(event["value"])
 
 
 def instantiateComponent(usbMsdComponentCommon):
@@ -35,7 +41,44 @@ def instantiateComponent(usbMsdComponentCommon):
 	usbDeviceMsdMaxSectorsToBufferCommon = usbMsdComponentCommon.createComboSymbol("CONFIG_USB_DEVICE_FUNCTION_MSD_MAX_SECTORS_COMMON", None, usbDeviceMsdMaxNumberofSectors)
 	usbDeviceMsdMaxSectorsToBufferCommon.setLabel("Max Sectors To Buffer")
 	usbDeviceMsdMaxSectorsToBufferCommon.setDefaultValue("1")
+	usbDeviceMsdMaxSectorsToBufferCommon.setDescription("Buffers of 2 or more sectors are split into two banks so that media access overlaps with the USB transfer")
 	usbDeviceMsdMaxSectorsToBufferCommon.setVisible(True)
+
+	usbDeviceMsdWriteCacheEnable = usbMsdComponentCommon.createBooleanSymbol("CONFIG_USB_DEVICE_FUNCTION_MSD_WRITE_CACHE_ENABLE", None)
+	usbDeviceMsdWriteCacheEnable.setLabel("Enable Write Cache")
+	usbDeviceMsdWriteCacheEnable.setDescription("Caches media write blocks that are larger than the sector size, so that sector writes to the same block are merged")
+	usbDeviceMsdWriteCacheEnable.setDefaultValue(False)
+	usbDeviceMsdWriteCacheEnable.setVisible(True)
+
+	usbDeviceMsdWriteCacheBlocks = usbMsdComponentCommon.createIntegerSymbol("CONFIG_USB_DEVICE_FUNCTION_MSD_WRITE_CACHE_BLOCKS", usbDeviceMsdWriteCacheEnable)
+	usbDeviceMsdWriteCacheBlocks.setLabel("Number of Cache Blocks")
+	usbDeviceMsdWriteCacheBlocks.setMin(1)
+	usbDeviceMsdWriteCacheBlocks.setMax(255)
+	usbDeviceMsdWriteCacheBlocks.setDefaultValue(4)
+	usbDeviceMsdWriteCacheBlocks.setVisible(False)
+	usbDeviceMsdWriteCacheBlocks.setDependencies(showOnWriteCacheEnable, ["CONFIG_USB_DEVICE_FUNCTION_MSD_WRITE_CACHE_ENABLE"])
+
+	usbDeviceMsdWriteCacheBlockSize = usbMsdComponentCommon.createIntegerSymbol("CONFIG_USB_DEVICE_FUNCTION_MSD_WRITE_CACHE_BLOCK_SIZE", usbDeviceMsdWriteCacheEnable)
+	usbDeviceMsdWriteCacheBlockSize.setLabel("Cache Block Size (Bytes)")
+	usbDeviceMsdWriteCacheBlockSize.setMin(512)
+	usbDeviceMsdWriteCacheBlockSize.setMax(65536)
+	usbDeviceMsdWriteCacheBlockSize.setDefaultValue(4096)
+	usbDeviceMsdWriteCacheBlockSize.setVisible(False)
+	usbDeviceMsdWriteCacheBlockSize.setDependencies(showOnWriteCacheEnable, ["CONFIG_USB_DEVICE_FUNCTION_MSD_WRITE_CACHE_ENABLE"])
+
+	usbDeviceMsdReadAheadEnable = usbMsdComponentCommon.createBooleanSymbol("CONFIG_USB_DEVICE_FUNCTION_MSD_READ_AHEAD_ENABLE", None)
+	usbDeviceMsdReadAheadEnable.setLabel("Enable Read Ahead")
+	usbDeviceMsdReadAheadEnable.setDescription("Reads the sectors that follow a host read into a per LUN buffer, so that the media read of one LUN overlaps with host accesses to the other LUNs. Also enables the per LUN statistics")
+	usbDeviceMsdReadAheadEnable.setDefaultValue(False)
+	usbDeviceMsdReadAheadEnable.setVisible(True)
+
+	usbDeviceMsdReadAheadSectors = usbMsdComponentCommon.createIntegerSymbol("CONFIG_USB_DEVICE_FUNCTION_MSD_READ_AHEAD_SECTORS", usbDeviceMsdReadAheadEnable)
+	usbDeviceMsdReadAheadSectors.setLabel("Read Ahead Sectors per LUN")
+	usbDeviceMsdReadAheadSectors.setMin(1)
+	usbDeviceMsdReadAheadSectors.setMax(128)
+	usbDeviceMsdReadAheadSectors.setDefaultValue(8)
+	usbDeviceMsdReadAheadSectors.setVisible(False)
+	usbDeviceMsdReadAheadSectors.setDependencies(showOnReadAheadEnable, ["CONFIG_USB_DEVICE_FUNCTION_MSD_READ_AHEAD_ENABLE"])
 	
 	#########################################################
 	# system_config.h file for USB Device MSD function driver 
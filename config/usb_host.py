@@ -122,6 +122,80 @@ def instantiateComponent(usbHostComponent):
 	usbHostTransfersNumber.setDefaultValue(10)
 	usbHostTransfersNumber.setDependencies(blUsbHostMaxInterfaceNumber, ["USB_OPERATION_MODE"])	
 	
+	# USB Host Trace 
+	usbHostTraceEnable = usbHostComponent.createBooleanSymbol("CONFIG_USB_HOST_TRACE_ENABLE", None)
+	usbHostTraceEnable.setLabel("Enable Transfer Trace")
+	usbHostTraceEnable.setVisible(True)
+	usbHostTraceEnable.setDescription("Record the IRPs submitted by the host layer and their completion")
+	usbHostTraceEnable.setDefaultValue(False)
+	
+	usbHostTraceRecordsNumber = usbHostComponent.createIntegerSymbol("CONFIG_USB_HOST_TRACE_RECORDS_NUMBER", usbHostTraceEnable)
+	usbHostTraceRecordsNumber.setLabel("Number of Trace Records")
+	usbHostTraceRecordsNumber.setVisible(False)
+	usbHostTraceRecordsNumber.setDescription("Number of records in the trace ring")
+	usbHostTraceRecordsNumber.setMin(1)
+	usbHostTraceRecordsNumber.setDefaultValue(64)
+	usbHostTraceRecordsNumber.setDependencies(setVisible, ["CONFIG_USB_HOST_TRACE_ENABLE"])
+	
+	# USB Host Memory Pool 
+	usbHostMemoryPoolEnable = usbHostComponent.createBooleanSymbol("CONFIG_USB_HOST_MEMORY_POOL_ENABLE", None)
+	usbHostMemoryPoolEnable.setLabel("Enable Static Memory Pool")
+	usbHostMemoryPoolEnable.setVisible(True)
+	usbHostMemoryPoolEnable.setDescription("Allocate descriptor buffers from a static pool instead of the heap")
+	usbHostMemoryPoolEnable.setDefaultValue(False)
+	
+	usbHostMemoryPoolSymbols = [
+		("SMALL_BLOCK_SIZE", "Small Block Size", 64),
+		("SMALL_BLOCKS_NUMBER", "Number of Small Blocks", 2),
+		("MEDIUM_BLOCK_SIZE", "Medium Block Size", 256),
+		("MEDIUM_BLOCKS_NUMBER", "Number of Medium Blocks", 2),
+		("LARGE_BLOCK_SIZE", "Large Block Size", 1024),
+		("LARGE_BLOCKS_NUMBER", "Number of Large Blocks", 1),
+	]
+	for usbHostMemoryPoolSymbolName, usbHostMemoryPoolSymbolLabel, usbHostMemoryPoolSymbolDefault in usbHostMemoryPoolSymbols:
+		usbHostMemoryPoolSymbol = usbHostComponent.createIntegerSymbol("CONFIG_USB_HOST_MEMORY_POOL_" + usbHostMemoryPoolSymbolName, usbHostMemoryPoolEnable)
+		usbHostMemoryPoolSymbol.setLabel(usbHostMemoryPoolSymbolLabel)
+		usbHostMemoryPoolSymbol.setVisible(False)
+		usbHostMemoryPoolSymbol.setMin(1)
+		usbHostMemoryPoolSymbol.setDefaultValue(usbHostMemoryPoolSymbolDefault)
+		usbHostMemoryPoolSymbol.setDependencies(setVisible, ["CONFIG_USB_HOST_MEMORY_POOL_ENABLE"])
+	
+	# USB Host Descriptor Cache 
+	usbHostDescriptorCacheEnable = usbHostComponent.createBooleanSymbol("CONFIG_USB_HOST_DESCRIPTOR_CACHE_ENABLE", None)
+	usbHostDescriptorCacheEnable.setLabel("Enable Descriptor Cache")
+	usbHostDescriptorCacheEnable.setVisible(True)
+	usbHostDescriptorCacheEnable.setDescription("Skip configuration descriptor requests for devices that were enumerated before")
+	usbHostDescriptorCacheEnable.setDefaultValue(False)
+	
+	usbHostDescriptorCacheEntries = usbHostComponent.createIntegerSymbol("CONFIG_USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER", usbHostDescriptorCacheEnable)
+	usbHostDescriptorCacheEntries.setLabel("Number of Cached Devices")
+	usbHostDescriptorCacheEntries.setVisible(False)
+	usbHostDescriptorCacheEntries.setMin(1)
+	usbHostDescriptorCacheEntries.setDefaultValue(4)
+	usbHostDescriptorCacheEntries.setDependencies(setVisible, ["CONFIG_USB_HOST_DESCRIPTOR_CACHE_ENABLE"])
+	
+	usbHostDescriptorCacheSize = usbHostComponent.createIntegerSymbol("CONFIG_USB_HOST_DESCRIPTOR_CACHE_CONFIGURATION_SIZE", usbHostDescriptorCacheEnable)
+	usbHostDescriptorCacheSize.setLabel("Largest Cached Configuration Descriptor")
+	usbHostDescriptorCacheSize.setVisible(False)
+	usbHostDescriptorCacheSize.setMin(9)
+	usbHostDescriptorCacheSize.setDefaultValue(256)
+	usbHostDescriptorCacheSize.setDependencies(setVisible, ["CONFIG_USB_HOST_DESCRIPTOR_CACHE_ENABLE"])
+	
+	# USB Host TPL Index 
+	usbHostTplIndexEnable = usbHostComponent.createBooleanSymbol("CONFIG_USB_HOST_TPL_INDEX_ENABLE", None)
+	usbHostTplIndexEnable.setLabel("Enable TPL Index")
+	usbHostTplIndexEnable.setVisible(True)
+	usbHostTplIndexEnable.setDescription("Find drivers in a large Target Peripheral List with a binary search")
+	usbHostTplIndexEnable.setDefaultValue(False)
+	
+	usbHostTplIndexEntries = usbHostComponent.createIntegerSymbol("CONFIG_USB_HOST_TPL_INDEX_ENTRIES_NUMBER", usbHostTplIndexEnable)
+	usbHostTplIndexEntries.setLabel("Largest Indexed TPL")
+	usbHostTplIndexEntries.setVisible(False)
+	usbHostTplIndexEntries.setMin(1)
+	usbHostTplIndexEntries.setMax(65535)
+	usbHostTplIndexEntries.setDefaultValue(64)
+	usbHostTplIndexEntries.setDependencies(setVisible, ["CONFIG_USB_HOST_TPL_INDEX_ENABLE"])
+	
 	# USB Host Hub Support
 	if any(x in Variables.get("__PROCESSOR") for x in ["PIC32MZ" , "PIC32MX" , "SAMA5D2", "SAM9X60" ]):
 		usbHostHubsupport = usbHostComponent.createBooleanSymbol("CONFIG_USB_HOST_HUB_SUPPORT", None)
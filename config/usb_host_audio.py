@@ -39,6 +39,9 @@ def onAttachmentDisconnected(source, target):
 def destroyComponent(component):	
 	print("USB HOST Audio Client Driver: Destroyed")
 	
+def showOnConversionEnable(symbol, event):
+	symbol.setVisible(event["value"])
+
 def instantiateComponent(usbHostAudioComponent):
 
 	res = Database.activateComponents(["usb_host"])
@@ -51,6 +54,21 @@ def instantiateComponent(usbHostAudioComponent):
 	usbHostAudioClientDriverInstance.setVisible(True)
 
 	
+	# USB Host Audio stream conversion
+	usbHostAudioConversionEnable = usbHostAudioComponent.createBooleanSymbol("CONFIG_USB_HOST_AUDIO_CONVERSION_ENABLE", None)
+	usbHostAudioConversionEnable.setLabel("Enable Stream Conversion")
+	usbHostAudioConversionEnable.setDescription("Adds functions that convert between 32 bit integer or float application buffers and the PCM format of the audio stream, with gain and rate adaptation.")
+	usbHostAudioConversionEnable.setDefaultValue(False)
+	usbHostAudioConversionEnable.setVisible(True)
+
+	usbHostAudioConversionChannels = usbHostAudioComponent.createIntegerSymbol("CONFIG_USB_HOST_AUDIO_CONVERSION_CHANNELS_NUMBER", usbHostAudioConversionEnable)
+	usbHostAudioConversionChannels.setLabel("Maximum Channels per Converted Stream")
+	usbHostAudioConversionChannels.setMin(1)
+	usbHostAudioConversionChannels.setMax(32)
+	usbHostAudioConversionChannels.setDefaultValue(2)
+	usbHostAudioConversionChannels.setVisible(False)
+	usbHostAudioConversionChannels.setDependencies(showOnConversionEnable, ["CONFIG_USB_HOST_AUDIO_CONVERSION_ENABLE"])
+
 	#USB Host Audio Attach Listeners Number 
 	# usbHostAudioClientDriverAttachListnerNumber = usbHostAudioComponent.createIntegerSymbol("CONFIG_USB_HOST_AUDIO_ATTACH_LISTENERS_NUMBER", None)
 	# usbHostAudioClientDriverAttachListnerNumber.setLabel("Number of Audio Host Attach Listeners")
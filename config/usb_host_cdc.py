@@ -39,6 +39,9 @@ def onAttachmentDisconnected(source, target):
 def destroyComponent(component):	
 	print("USB HOST CDC Client Driver: Destroyed")
 	
+def showOnStreamEnable(symbol, event):
+	symbol.setVisible(event["value"])
+	
 def instantiateComponent(usbHostCdcComponent):
 
 	res = Database.activateComponents(["usb_host"])
@@ -57,6 +60,37 @@ def instantiateComponent(usbHostCdcComponent):
 	usbHostCdcClientDriverAttachListnerNumber.setDefaultValue(1)
 	usbHostCdcClientDriverAttachListnerNumber.setVisible(True)
 
+	# USB Host CDC streaming mode
+	usbHostCdcStreamEnable = usbHostCdcComponent.createBooleanSymbol("CONFIG_USB_HOST_CDC_STREAM_ENABLE", None)
+	usbHostCdcStreamEnable.setLabel("Enable Streaming Mode")
+	usbHostCdcStreamEnable.setDescription("Keeps bulk IN transfers queued into a receive ring and coalesces writes in a transmit ring")
+	usbHostCdcStreamEnable.setDefaultValue(False)
+	usbHostCdcStreamEnable.setVisible(True)
+
+	usbHostCdcStreamBufferSize = usbHostCdcComponent.createIntegerSymbol("CONFIG_USB_HOST_CDC_STREAM_BUFFER_SIZE", usbHostCdcStreamEnable)
+	usbHostCdcStreamBufferSize.setLabel("Ring Size (Bytes)")
+	usbHostCdcStreamBufferSize.setMin(128)
+	usbHostCdcStreamBufferSize.setMax(65536)
+	usbHostCdcStreamBufferSize.setDefaultValue(4096)
+	usbHostCdcStreamBufferSize.setVisible(False)
+	usbHostCdcStreamBufferSize.setDependencies(showOnStreamEnable, ["CONFIG_USB_HOST_CDC_STREAM_ENABLE"])
+
+	usbHostCdcStreamIrpsNumber = usbHostCdcComponent.createIntegerSymbol("CONFIG_USB_HOST_CDC_STREAM_IRPS_NUMBER", usbHostCdcStreamEnable)
+	usbHostCdcStreamIrpsNumber.setLabel("Number of Queued Transfers per Pipe")
+	usbHostCdcStreamIrpsNumber.setMin(1)
+	usbHostCdcStreamIrpsNumber.setMax(16)
+	usbHostCdcStreamIrpsNumber.setDefaultValue(2)
+	usbHostCdcStreamIrpsNumber.setVisible(False)
+	usbHostCdcStreamIrpsNumber.setDependencies(showOnStreamEnable, ["CONFIG_USB_HOST_CDC_STREAM_ENABLE"])
+
+	usbHostCdcStreamTransferSize = usbHostCdcComponent.createIntegerSymbol("CONFIG_USB_HOST_CDC_STREAM_TRANSFER_SIZE", usbHostCdcStreamEnable)
+	usbHostCdcStreamTransferSize.setLabel("Receive Transfer Size (Bytes)")
+	usbHostCdcStreamTransferSize.setMin(64)
+	usbHostCdcStreamTransferSize.setMax(16384)
+	usbHostCdcStreamTransferSize.setDefaultValue(512)
+	usbHostCdcStreamTransferSize.setVisible(False)
+	usbHostCdcStreamTransferSize.setDependencies(showOnStreamEnable, ["CONFIG_USB_HOST_CDC_STREAM_ENABLE"])
+
 
 	##############################################################
 	# system_definitions.h file for USB Host CDC Client driver   
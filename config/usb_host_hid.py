@@ -156,6 +156,24 @@ def instantiateComponent(usbHostHidComponent):
 	usbHostHidClientDriverPushPopStackSize.setDescription("Enter the number of PUSH items that can be saved in the Global item queue per field per HID interface.")
 	usbHostHidClientDriverPushPopStackSize.setVisible(True)
 	usbHostHidClientDriverPushPopStackSize.setDefaultValue(1)
+
+	# Main item index size
+	usbHostHidClientDriverMainItemIndexSize = usbHostHidComponent.createIntegerSymbol("CONFIG_USB_HOST_HID_MAIN_ITEM_INDEX_SIZE", None)
+	usbHostHidClientDriverMainItemIndexSize.setLabel("Number of indexed Main items")
+	usbHostHidClientDriverMainItemIndexSize.setDescription("Enter the number of Report Descriptor main items that are indexed per HID interface. Enter 0 to disable the index.")
+	usbHostHidClientDriverMainItemIndexSize.setVisible(True)
+	usbHostHidClientDriverMainItemIndexSize.setDefaultValue(0)
+	usbHostHidClientDriverMainItemIndexSize.setMin(0)
+	usbHostHidClientDriverMainItemIndexSize.setMax(255)
+
+	# Report buffers of the batched report engine
+	usbHostHidClientDriverReportBuffersNumber = usbHostHidComponent.createIntegerSymbol("CONFIG_USB_HOST_HID_REPORT_BUFFERS_NUMBER", None)
+	usbHostHidClientDriverReportBuffersNumber.setLabel("Number of Report buffers")
+	usbHostHidClientDriverReportBuffersNumber.setDescription("Enter the number of INTERRUPT IN report buffers per HID interface used by the batched report engine. Enter 0 to disable the batched report engine. The engine needs at least 2 buffers.")
+	usbHostHidClientDriverReportBuffersNumber.setVisible(True)
+	usbHostHidClientDriverReportBuffersNumber.setDefaultValue(0)
+	usbHostHidClientDriverReportBuffersNumber.setMin(0)
+	usbHostHidClientDriverReportBuffersNumber.setMax(32)
 	
 	# USB Host HID Client driver Mouse 
 	usbHostHidClientDriverMouse = usbHostHidComponent.createBooleanSymbol("CONFIG_USB_HOST_USE_MOUSE", None)
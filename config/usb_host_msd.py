@@ -59,6 +59,14 @@ def instantiateComponent(usbHostMsdComponent):
 	usbHostMsdClientDriverInstance.setDescription("Enter the number of MSD Class Driver instances required in the application.")
 	usbHostMsdClientDriverInstance.setDefaultValue(1)
 	usbHostMsdClientDriverInstance.setVisible(True)
+
+	# USB Host SCSI command queue depth
+	usbHostScsiCommandQueueDepth = usbHostMsdComponent.createIntegerSymbol("CONFIG_USB_HOST_SCSI_COMMAND_QUEUE_DEPTH", None)
+	usbHostScsiCommandQueueDepth.setLabel("SCSI Command Queue Depth per LUN")
+	usbHostScsiCommandQueueDepth.setDescription("Enter the number of block read and write requests that can be queued per Logical Unit.")
+	usbHostScsiCommandQueueDepth.setDefaultValue(1)
+	usbHostScsiCommandQueueDepth.setMin(1)
+	usbHostScsiCommandQueueDepth.setVisible(True)
 	
 	##############################################################
 	# system_definitions.h file for USB Host MSD Client driver   
@@ -83,6 +83,22 @@ def instantiateComponent(usbDriverComponent):
 	usbDriverHostResetDuration.setDescription("Set USB Host Attach De-bounce duration")
 	usbDriverHostResetDuration.setDefaultValue(100)
 	usbDriverHostResetDuration.setDependencies(blUSBDriverOperationModeChanged, ["USB_OPERATION_MODE"])
+
+	# USB Driver Host mode EHCI qTD pool size
+	usbDriverHostEhciQtdNumber = usbDriverComponent.createIntegerSymbol("USB_DRV_HOST_EHCI_QTD_NUMBER", None)
+	usbDriverHostEhciQtdNumber.setLabel("EHCI qTD Pool Size")
+	usbDriverHostEhciQtdNumber.setDescription("Number of EHCI qTDs shared by the bulk pipes. Each qTD transfers up to 20 KB.")
+	usbDriverHostEhciQtdNumber.setMin(4)
+	usbDriverHostEhciQtdNumber.setMax(1024)
+	usbDriverHostEhciQtdNumber.setDefaultValue(32)
+
+	# USB Driver Host mode EHCI iTDs per isochronous pipe
+	usbDriverHostEhciItdNumber = usbDriverComponent.createIntegerSymbol("USB_DRV_HOST_EHCI_ITD_NUMBER", None)
+	usbDriverHostEhciItdNumber.setLabel("EHCI iTDs per Isochronous Pipe")
+	usbDriverHostEhciItdNumber.setDescription("Number of frames that can be queued on an isochronous pipe")
+	usbDriverHostEhciItdNumber.setMin(2)
+	usbDriverHostEhciItdNumber.setMax(64)
+	usbDriverHostEhciItdNumber.setDefaultValue(8)
 	
 	enable_rtos_settings = False
 
@@ -162,6 +162,42 @@ def instantiateComponent(usbDriverComponent):
 	usbDriverHostResetDuration.setDefaultValue(100)
 	usbDriverHostResetDuration.setDependencies(blUSBDriverOperationModeChanged, ["USB_OPERATION_MODE"])
 	
+	if any(x in Variables.get("__PROCESSOR") for x in ["PIC32MZ"]):
+		# USB Driver Device mode DMA scheduler
+		usbDriverDeviceDMAScheduler = usbDriverComponent.createBooleanSymbol("USB_DRV_DEVICE_DMA_SCHEDULER_ENABLE", usbOpMode)
+		usbDriverDeviceDMAScheduler.setLabel("Enable DMA Scheduler")
+		usbDriverDeviceDMAScheduler.setDescription("Share the DMA channels by endpoint weight, use bounce buffers for unaligned buffers and count the packets moved with DMA and PIO per endpoint")
+		usbDriverDeviceDMAScheduler.setVisible(True)
+		usbDriverDeviceDMAScheduler.setDefaultValue(False)
+		usbDriverDeviceDMAScheduler.setDependencies(blUSBDriverOperationModeDevice, ["USB_OPERATION_MODE"])
+
+		usbDriverDeviceDMAReserved = usbDriverComponent.createIntegerSymbol("USB_DRV_DEVICE_DMA_CHANNELS_RESERVED", usbDriverDeviceDMAScheduler)
+		usbDriverDeviceDMAReserved.setLabel("DMA Channels Reserved per Weight Level")
+		usbDriverDeviceDMAReserved.setDescription("Number of DMA channels that each higher weight level reserves")
+		usbDriverDeviceDMAReserved.setVisible(False)
+		usbDriverDeviceDMAReserved.setMin(0)
+		usbDriverDeviceDMAReserved.setMax(2)
+		usbDriverDeviceDMAReserved.setDefaultValue(1)
+		usbDriverDeviceDMAReserved.setDependencies(setVisible, ["USB_DRV_DEVICE_DMA_SCHEDULER_ENABLE"])
+
+		usbDriverDeviceDMABounceNumber = usbDriverComponent.createIntegerSymbol("USB_DRV_DEVICE_DMA_BOUNCE_BUFFERS_NUMBER", usbDriverDeviceDMAScheduler)
+		usbDriverDeviceDMABounceNumber.setLabel("Number of DMA Bounce Buffers")
+		usbDriverDeviceDMABounceNumber.setDescription("Number of bounce buffers for transfers from and to buffers that are not 4 byte aligned")
+		usbDriverDeviceDMABounceNumber.setVisible(False)
+		usbDriverDeviceDMABounceNumber.setMin(1)
+		usbDriverDeviceDMABounceNumber.setMax(8)
+		usbDriverDeviceDMABounceNumber.setDefaultValue(2)
+		usbDriverDeviceDMABounceNumber.setDependencies(setVisible, ["USB_DRV_DEVICE_DMA_SCHEDULER_ENABLE"])
+
+		usbDriverDeviceDMABounceSize = usbDriverComponent.createIntegerSymbol("USB_DRV_DEVICE_DMA_BOUNCE_BUFFER_SIZE", usbDriverDeviceDMAScheduler)
+		usbDriverDeviceDMABounceSize.setLabel("DMA Bounce Buffer Size")
+		usbDriverDeviceDMABounceSize.setDescription("Size of a bounce buffer. Should be the largest endpoint size that uses unaligned buffers.")
+		usbDriverDeviceDMABounceSize.setVisible(False)
+		usbDriverDeviceDMABounceSize.setMin(64)
+		usbDriverDeviceDMABounceSize.setMax(1024)
+		usbDriverDeviceDMABounceSize.setDefaultValue(512)
+		usbDriverDeviceDMABounceSize.setDependencies(setVisible, ["USB_DRV_DEVICE_DMA_SCHEDULER_ENABLE"])
+
 	enable_rtos_settings = False
 
 	if (Database.getSymbolValue("HarmonyCore", "SELECT_RTOS") != "BareMetal"):
@@ -131,4 +131,25 @@
 
 #define USB_DEVICE_AUDIO_V2_MAX_ALTERNATE_SETTING /*DOM-IGNORE-BEGIN*/ 2 /*DOM-IGNORE-END*/
 
+// *****************************************************************************
+/* Audio 2.0 Stream Packets
+
+  Summary:
+    Specifies the number of packet IRPs of an Audio 2.0 isochronous stream.
+
+  Description:
+    This macro enables the isochronous streaming functions
+    (USB_DEVICE_AUDIO_V2_StreamStart() and related functions) and defines the
+    number of packet IRPs of each stream. On an OUT data endpoint, this is also
+    the number of slots of the application ring. More packets tolerate a longer
+    application latency at the cost of one USB_DEVICE_IRP and two data segments
+    per packet for each streaming interface.
+
+  Remarks:
+    This macro is optional. The streaming functions are not available if it
+    is not defined.
+*/
+
+#define USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER /*DOM-IGNORE-BEGIN*/ 16 /*DOM-IGNORE-END*/
+
 #endif
@@ -95,6 +95,51 @@
 
 #define USB_DEVICE_CDC_QUEUE_DEPTH_COMBINED /*DOM-IGNORE-BEGIN*/ 2 /*DOM-IGNORE-END*/
 
+// *****************************************************************************
+/* USB device CDC Stream Buffer Size
+
+  Summary:
+    Enables the CDC streaming mode and specifies the size of its rings.
+
+  Description:
+    Specifying this macro enables the USB_DEVICE_CDC_Stream* functions. Each
+    CDC instance then owns a receive ring and a transmit ring of this size in
+    bytes. The application reads and writes the rings in place, and the CDC
+    function driver keeps the bulk endpoints busy without per transfer
+    requests or events from the application.
+
+    The receive ring is split into USB_DEVICE_CDC_STREAM_IRPS_NUMBER slots.
+    The slot size must be a multiple of the bulk OUT endpoint size, so the
+    value should be a multiple of USB_DEVICE_CDC_STREAM_IRPS_NUMBER * 512 for
+    a high speed device and USB_DEVICE_CDC_STREAM_IRPS_NUMBER * 64 for a full
+    speed device.
+
+  Remarks:
+    This macro is optional. The streaming mode requires
+    2 * USB_DEVICE_CDC_STREAM_BUFFER_SIZE bytes of RAM per CDC instance.
+*/
+
+#define USB_DEVICE_CDC_STREAM_BUFFER_SIZE /*DOM-IGNORE-BEGIN*/ 4096 /*DOM-IGNORE-END*/
+
+// *****************************************************************************
+/* USB device CDC Stream IRPs Number
+
+  Summary:
+    Specifies the number of IRPs that a CDC stream keeps on each bulk endpoint.
+
+  Description:
+    This macro defines the number of receive ring slots and the maximum number
+    of transmit transfers in flight per CDC instance. A value of 2 or more
+    lets the controller driver start the next transfer while the application
+    handles the data of the last one.
+
+  Remarks:
+    This macro is optional. A value of 2 is used if it is not specified and
+    USB_DEVICE_CDC_STREAM_BUFFER_SIZE is specified.
+*/
+
+#define USB_DEVICE_CDC_STREAM_IRPS_NUMBER /*DOM-IGNORE-BEGIN*/ 2 /*DOM-IGNORE-END*/
+
 #endif // #ifndef _USB_DEVICE_CDC_CONFIG_TEMPLATE_H_
 
 /*******************************************************************************
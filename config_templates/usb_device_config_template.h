@@ -175,6 +175,179 @@
 
 #define USB_DEVICE_ENDPOINT_QUEUE_DEPTH_COMBINED  2
 
+// *****************************************************************************
+/* USB Device Layer Shared IRP Pool Size
+
+  Summary:
+    Specifies the size of the IRP pool that the CDC, HID, Printer and Audio
+    function drivers share in each USB Device Layer instance.
+
+  Description:
+    By default each of the CDC, HID, Printer and Audio function drivers
+    allocates its own IRP array, sized by the respective
+    *_QUEUE_DEPTH_COMBINED constant. Specifying this configuration constant
+    replaces these arrays with one IRP pool per USB Device Layer instance. All
+    function drivers that are active in the device layer instance allocate
+    their IRPs from this pool. The read, write and notification queue sizes
+    specified in the function driver initialization data still limit the
+    number of IRPs that each function driver instance can hold.
+
+    In a composite device, the value should be set to the number of IRPs
+    that can be pending at the same time across all function drivers in the
+    device layer instance. This is typically smaller than the sum of the
+    *_QUEUE_DEPTH_COMBINED constants. The value must not exceed 65535.
+
+  Remarks:
+    This constant is optional. When it is not specified, each function driver
+    uses its own IRP array.
+*/
+
+#define USB_DEVICE_IRP_POOL_SIZE  8
+
+// *****************************************************************************
+/* USB Device Layer Endpoint Statistics Endpoints Number
+
+  Summary:
+    Enables the endpoint transfer statistics and specifies the number of
+    endpoints for which they are collected.
+
+  Description:
+    Specifying this configuration constant causes the Device Layer to collect
+    transfer statistics for every IRP that is submitted through
+    USB_DEVICE_IRPSubmit on endpoints whose number is less than this value.
+    This includes the IRPs of all function drivers and of the endpoint read
+    and write functions. For each endpoint and direction the Device Layer
+    counts the submitted IRPs, the transferred bytes, the failed and aborted
+    IRPs and the endpoint stalls, tracks the number of pending IRPs and its
+    high water mark and records a log2 histogram of the IRP latency. The
+    statistics are read with USB_DEVICE_EndpointStatisticsGet.
+
+    The latency is measured in USB frames using the SOF frame number of the
+    USB controller driver, unless USB_DEVICE_STATISTICS_TIMESTAMP_GET is
+    specified.
+
+  Remarks:
+    This constant is optional. No statistics are collected and no code is
+    added when it is not specified. NAK handshakes are handled by the USB
+    controller hardware and are not counted.
+*/
+
+#define USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER  4
+
+// *****************************************************************************
+/* USB Device Layer Endpoint Statistics IRPs Number
+
+  Summary:
+    Specifies the number of pending IRPs that can be tracked for the endpoint
+    statistics.
+
+  Description:
+    The Device Layer keeps a table of the pending IRPs to measure their
+    latency. This constant defines the size of the table in each Device Layer
+    instance. It should be set to the number of IRPs that can be pending at
+    the same time on the endpoints for which statistics are collected. IRPs
+    that are submitted while the table is full are counted in the untracked
+    member of the statistics and their bytes and latency are not recorded.
+
+  Remarks:
+    This constant is optional. A default value of 16 is used if it is not
+    specified.
+*/
+
+#define USB_DEVICE_STATISTICS_IRPS_NUMBER  16
+
+// *****************************************************************************
+/* USB Device Layer Endpoint Statistics Time Stamp Function
+
+  Summary:
+    Specifies the function that provides the time stamp for the IRP latency.
+
+  Description:
+    This configuration macro can be set to an expression that returns a free
+    running uint32_t time stamp, for example a core cycle counter. The
+    latency histogram is then recorded in the units of this time stamp
+    instead of USB frames. The expression is evaluated in the USB interrupt
+    context.
+
+  Remarks:
+    This macro is optional. The SOF frame number is used if it is not
+    specified.
+*/
+
+#define USB_DEVICE_STATISTICS_TIMESTAMP_GET()  
+
+// *****************************************************************************
+/* USB Device Layer Endpoint Statistics Vendor Request
+
+  Summary:
+    Specifies the bRequest value of the endpoint statistics vendor request.
+
+  Description:
+    Specifying this configuration constant allows the host to read the
+    endpoint statistics with a vendor device request, without support from
+    the application. The request has the following format:
+    - bmRequestType: 0xC0 (device to host, vendor, device)
+    - bRequest: USB_DEVICE_STATISTICS_VENDOR_REQUEST
+    - wValue: bit 0 set clears the statistics after they have been read
+    - wIndex: endpoint address (number and direction)
+    - wLength: size of USB_DEVICE_ENDPOINT_STATISTICS
+    
+    The data stage contains a USB_DEVICE_ENDPOINT_STATISTICS object. Vendor
+    device requests with other bRequest values are still forwarded to the
+    application.
+
+  Remarks:
+    This constant is optional and requires
+    USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER to be specified. The value must
+    not be used by the application for its own vendor device requests.
+*/
+
+#define USB_DEVICE_STATISTICS_VENDOR_REQUEST  0x5A
+
+// *****************************************************************************
+/* USB Device Layer IRP Bounce Buffers Number
+
+  Summary:
+    Specifies the number of bounce buffers for IRPs with data segments.
+
+  Description:
+    An IRP that is submitted with the USB_DEVICE_IRP_FLAG_DATA_SEGMENTS flag
+    is normally only accepted if the USB controller driver reports the
+    DRV_USB_CAPABILITY_IRP_DATA_SEGMENTS capability. Specifying this
+    configuration constant lets the Device Layer accept such IRPs on any
+    driver. The Device Layer copies the segments to or from a bounce buffer
+    and submits the bounce buffer to the driver. This constant defines the
+    number of bounce buffers in each Device Layer instance, which is the
+    number of IRPs with data segments that can be pending at the same time.
+    The bounce buffers are only used when the driver does not support data
+    segments.
+
+  Remarks:
+    This constant is optional. IRPs with data segments are rejected by
+    drivers without the capability when it is not specified.
+*/
+
+#define USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER  2
+
+// *****************************************************************************
+/* USB Device Layer IRP Bounce Buffer Size
+
+  Summary:
+    Specifies the size of each bounce buffer for IRPs with data segments.
+
+  Description:
+    This constant defines the size in bytes of each bounce buffer. An IRP
+    with data segments whose size is larger than this value is rejected when
+    it would need a bounce buffer.
+
+  Remarks:
+    This constant is optional and only used when
+    USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER is specified. A default value of 512
+    is used if it is not specified.
+*/
+
+#define USB_DEVICE_IRP_BOUNCE_BUFFER_SIZE  512
+
 // *****************************************************************************
 /* USB Device Layer BOS Descriptor Support Enable 
  
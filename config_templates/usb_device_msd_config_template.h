@@ -95,6 +95,107 @@
 
 #define USB_DEVICE_MSD_LUNS_NUMBER  1
 
+// *****************************************************************************
+/* Number of Write Cache Blocks
+
+  Summary:
+    Enables the write-back cache and defines the number of media write blocks
+    that it can hold.
+
+  Description:
+    Specifying this configuration constant enables a write-back cache of media
+    write blocks in each MSD function driver instance. The cache is used for
+    media whose write block is larger than the sector size, such as serial
+    flash with a 4096 byte erase block. Without the cache, every sector written
+    by the host causes the whole media write block to be read, updated and
+    written back. With the cache, sectors written to a block that is already
+    in the cache are merged into the cached block and the block is written to
+    the media only once.
+
+    The least recently used block is written back to the media when room is
+    needed for another block. All modified blocks are written back to the
+    media when the host sends a SYNCHRONIZE CACHE command, when the host allows
+    medium removal, when no command has been received from the host for
+    USB_DEVICE_MSD_WRITE_CACHE_IDLE_FLUSH_COUNT calls of the MSD tasks routine
+    and when the function driver is deinitialized.
+
+  Remarks:
+    This constant is optional. The cache is disabled if this constant is not
+    specified. The cache requires
+    USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER * USB_DEVICE_MSD_WRITE_CACHE_BLOCK_SIZE
+    bytes of RAM per MSD function driver instance.
+*/
+
+#define USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER  4
+
+// *****************************************************************************
+/* Write Cache Block Size
+
+  Summary:
+    Defines the size of a write cache block in bytes.
+
+  Description:
+    This constant defines the size of a block in the write-back cache. It
+    should be set to the largest media write block size of the media that
+    should use the cache. Media whose write block size is larger than this
+    value do not use the cache.
+
+  Remarks:
+    This constant is required if USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER is
+    specified.
+*/
+
+#define USB_DEVICE_MSD_WRITE_CACHE_BLOCK_SIZE  4096
+
+// *****************************************************************************
+/* Write Cache Idle Flush Count
+
+  Summary:
+    Defines the number of idle MSD task calls after which the write cache is
+    flushed.
+
+  Description:
+    The MSD function driver writes all modified cache blocks back to the media
+    when it has been waiting for a command from the host for this number of
+    calls of the MSD tasks routine.
+
+  Remarks:
+    This constant is optional. A default value of 10000 is used if it is not
+    specified.
+*/
+
+#define USB_DEVICE_MSD_WRITE_CACHE_IDLE_FLUSH_COUNT  10000
+
+// *****************************************************************************
+/* Number of Read Ahead Sectors
+
+  Summary:
+    Enables the read ahead and defines the number of sectors that are read
+    ahead for each LUN.
+
+  Description:
+    Specifying this configuration constant enables the read ahead of each LUN.
+    When the host has read sectors from a LUN with a READ (10) command, the MSD
+    function driver starts reading the sectors that follow into a read ahead
+    buffer of that LUN. The Bulk-Only Transport processes one command at a
+    time, so the media read continues while the CSW is sent and while the host
+    accesses the other LUNs. If the next READ (10) command to the LUN starts at
+    the first of these sectors, they are sent from the read ahead buffer. This
+    hides the latency of slow media such as an SD card when the host
+    interleaves reads of several LUNs.
+
+    The per LUN statistics, which can be obtained with the
+    USB_DEVICE_MSD_LUNStatisticsGet function, are also enabled by this
+    constant.
+
+  Remarks:
+    This constant is optional. The read ahead is disabled if this constant is
+    not specified. The read ahead requires
+    USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER * 512 bytes of RAM per LUN.
+*/
+
+#define USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER  8
+
 #endif
 
 
@@ -141,6 +141,29 @@
 */
 #define USB_HOST_AUDIO_V1_STREAMING_INTERFACE_ALTERNATE_SETTINGS_NUMBER /*DOM-IGNORE-BEGIN*/1 /*DOM-IGNORE-END*/
 
+// *****************************************************************************
+/* USB Host Audio v1.0 Conversion Channels Number 
+ 
+  Summary: 
+    Enables the stream conversion functions and defines the maximum number of
+    channels of a converted stream.
+
+  Description:
+    This configuration constant enables the
+    USB_HOST_AUDIO_V1_StreamConversionSet(),
+    USB_HOST_AUDIO_V1_StreamConvertWrite() and
+    USB_HOST_AUDIO_V1_StreamConvertRead() functions. These convert between
+    application buffers of 32 bit integer or floating point samples and the PCM
+    format of the audio stream, with gain and rate adaptation. The value is the
+    maximum number of channels of a stream that can be converted.
+
+  Remarks:
+    This constant is optional. The conversion functions are not available if it
+    is not defined. Each streaming interface keeps one audio frame of 32 bit
+    samples for the rate adaptation.
+*/
+#define USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER /*DOM-IGNORE-BEGIN*/2 /*DOM-IGNORE-END*/
+
 
 #endif // #ifndef _USB_HOST_AUDIO_V1_CONFIG_TEMPLATE_H_
 
@@ -92,6 +92,70 @@
 
 #define USB_HOST_CDC_ATTACH_LISTENERS_NUMBER  /*DOM-IGNORE-BEGIN*/1 /*DOM-IGNORE-END*/
 
+// *****************************************************************************
+/* USB Host CDC Stream Buffer Size
+ 
+  Summary: 
+    Enables the CDC streaming mode and specifies the size of its rings.
+
+  Description:
+    Specifying this macro enables the USB_HOST_CDC_Stream* functions. Each CDC
+    instance then owns a receive ring and a transmit ring of this size in
+    bytes. In streaming mode the client driver keeps bulk IN transfers queued
+    on the device at all times and copies the received data to the receive
+    ring. Data written by the application is coalesced in the transmit ring
+    and sent in multiples of the bulk OUT maximum packet size.
+
+  Remarks:
+    This macro is optional. The streaming mode requires
+    2 * USB_HOST_CDC_STREAM_BUFFER_SIZE + USB_HOST_CDC_STREAM_IRPS_NUMBER *
+    USB_HOST_CDC_STREAM_TRANSFER_SIZE bytes of RAM per CDC instance.
+*/
+
+#define USB_HOST_CDC_STREAM_BUFFER_SIZE  /*DOM-IGNORE-BEGIN*/4096 /*DOM-IGNORE-END*/
+
+// *****************************************************************************
+/* USB Host CDC Stream IRPs Number
+ 
+  Summary: 
+    Specifies the number of bulk IN transfers that a CDC stream keeps queued.
+
+  Description:
+    This macro defines the number of bulk IN transfers that are kept queued on
+    the bulk IN pipe, and the maximum number of bulk OUT transfers in flight,
+    per CDC instance. With a value of 2 or more the device is polled again
+    while the last received data is being copied, so fast devices are not
+    throttled between transfers.
+
+  Remarks:
+    This macro is optional. A value of 2 is used if it is not specified and
+    USB_HOST_CDC_STREAM_BUFFER_SIZE is specified. USB_HOST_TRANSFERS_NUMBER
+    should include 2 * USB_HOST_CDC_STREAM_IRPS_NUMBER transfers per CDC
+    instance.
+*/
+
+#define USB_HOST_CDC_STREAM_IRPS_NUMBER  /*DOM-IGNORE-BEGIN*/2 /*DOM-IGNORE-END*/
+
+// *****************************************************************************
+/* USB Host CDC Stream Transfer Size
+ 
+  Summary: 
+    Specifies the size of each stream bulk IN transfer.
+
+  Description:
+    This macro defines the size in bytes of each bulk IN transfer that a CDC
+    stream queues. A transfer completes when it is full or when the device
+    sends a short packet. The value must be a multiple of the bulk IN maximum
+    packet size of the device, that is 64 for a full speed device and 512 for
+    a high speed device.
+
+  Remarks:
+    This macro is optional. A value of 512 is used if it is not specified and
+    USB_HOST_CDC_STREAM_BUFFER_SIZE is specified.
+*/
+
+#define USB_HOST_CDC_STREAM_TRANSFER_SIZE  /*DOM-IGNORE-BEGIN*/512 /*DOM-IGNORE-END*/
+
 #endif // #ifndef _USB_HOST_CDC_CONFIG_TEMPLATE_H_
 
 /*******************************************************************************
@@ -226,6 +226,162 @@
 
 #define USB_HOST_HUB_TIER_LEVEL  /*DOM-IGNORE-BEGIN*/1 /*DOM-IGNORE-END*/
 
+// *****************************************************************************
+/* USB Host Layer Trace Records Number
+ 
+  Summary: 
+    Enables the host layer trace and defines the number of records it holds.
+
+  Description:
+    Specifying this constant enables a trace of all IRPs that the host layer
+    submits to the host controller drivers. This includes the control
+    transfers of the enumeration and the transfers of all client drivers. A
+    record is added when an IRP is submitted and when it completes. Each
+    record contains a SYS_TIME time stamp, the bus, device address, endpoint,
+    transfer type, length and status of the IRP and the setup packet of
+    control transfers.
+
+    The application reads the records with USB_HOST_TraceRead and can convert
+    them to a pcap file with USB_HOST_TracePcapHeaderGet and
+    USB_HOST_TracePcapRecordGet. The file uses the Linux usbmon format and can
+    be opened with Wireshark. Events that occur while the trace is full are
+    counted and not recorded.
+
+  Remarks:
+    This constant is optional. The trace is disabled if it is not specified.
+    Each record requires 32 bytes of data memory.
+*/
+
+#define USB_HOST_TRACE_RECORDS_NUMBER  /*DOM-IGNORE-BEGIN*/64 /*DOM-IGNORE-END*/
+
+// *****************************************************************************
+/* USB Host Layer Memory Pool Enable
+ 
+  Summary: 
+    Enables the static memory pool of the host layer.
+
+  Description:
+    Specifying this constant makes the host layer and the HID client driver
+    allocate their descriptor buffers (configuration descriptors and report
+    descriptors) from a static memory pool instead of USB_HOST_MALLOC and
+    USB_HOST_FREE. The pool has a small, a medium and a large size class of
+    fixed size blocks. An allocation takes a block from the smallest class
+    that fits the request and has a free block. Because blocks are never split
+    or merged, repeated attach and detach of devices cannot fragment the pool
+    and the time of an allocation is bounded by the number of blocks.
+
+    The use of the pool by each bus and its high water marks are returned by
+    USB_HOST_MemoryPoolStatusGet. USB_HOST_MemoryPoolFailureInjectionSet makes
+    allocations fail periodically to test the handling of allocation
+    failures.
+
+  Remarks:
+    This constant is optional. USB_HOST_MALLOC and USB_HOST_FREE are used if
+    it is not specified. A device whose configuration descriptor is larger
+    than USB_HOST_MEMORY_POOL_LARGE_BLOCK_SIZE - 7 bytes is not supported.
+*/
+
+#define USB_HOST_MEMORY_POOL_ENABLE
+
+// *****************************************************************************
+/* USB Host Layer Memory Pool Size Classes
+ 
+  Summary: 
+    Define the block size and number of blocks of each memory pool size class.
+
+  Description:
+    These constants define the size in bytes and the number of blocks of the
+    small, medium and large memory pool size classes. The block sizes must be
+    in increasing order. A device needs one block for its configuration
+    descriptor while it is attached, one more while it is being enumerated and
+    one block for the report descriptor of each HID interface.
+
+  Remarks:
+    These constants are optional. If they are not specified, the small, medium
+    and large blocks are 64, 256 and 1024 bytes and there are 2, 2 and 1
+    blocks of each class for each device in USB_HOST_DEVICES_NUMBER.
+*/
+
+#define USB_HOST_MEMORY_POOL_SMALL_BLOCK_SIZE       /*DOM-IGNORE-BEGIN*/64 /*DOM-IGNORE-END*/
+#define USB_HOST_MEMORY_POOL_SMALL_BLOCKS_NUMBER    /*DOM-IGNORE-BEGIN*/4 /*DOM-IGNORE-END*/
+#define USB_HOST_MEMORY_POOL_MEDIUM_BLOCK_SIZE      /*DOM-IGNORE-BEGIN*/256 /*DOM-IGNORE-END*/
+#define USB_HOST_MEMORY_POOL_MEDIUM_BLOCKS_NUMBER   /*DOM-IGNORE-BEGIN*/4 /*DOM-IGNORE-END*/
+#define USB_HOST_MEMORY_POOL_LARGE_BLOCK_SIZE       /*DOM-IGNORE-BEGIN*/1024 /*DOM-IGNORE-END*/
+#define USB_HOST_MEMORY_POOL_LARGE_BLOCKS_NUMBER    /*DOM-IGNORE-BEGIN*/2 /*DOM-IGNORE-END*/
+
+// *****************************************************************************
+/* USB Host Layer Descriptor Cache Entries Number
+ 
+  Summary: 
+    Enables the descriptor cache and defines the number of devices it holds.
+
+  Description:
+    Specifying this constant enables a cache of the descriptors of devices
+    that were enumerated before. The host layer stores the device descriptor,
+    the speed and the configuration descriptor of the first configuration of
+    each device after it has set the first configuration. When a device
+    attaches with the same device descriptor (and so the same vendor ID,
+    product ID, device release number and serial number string index) at the
+    same speed, and the header of its first configuration descriptor matches
+    the cached header, the host layer does not request the full configuration
+    descriptors of the device again. A checksum protects each entry. The least
+    recently used entry is replaced when the cache is full.
+
+    This saves three control transfers for a device with one configuration
+    and more for devices with several configurations.
+
+  Remarks:
+    This constant is optional. The cache is disabled if it is not specified.
+    Each entry requires USB_HOST_DESCRIPTOR_CACHE_CONFIGURATION_SIZE + 36 bytes
+    of data memory. The serial number string itself is not requested and is
+    not part of the cache key.
+*/
+
+#define USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER  /*DOM-IGNORE-BEGIN*/4 /*DOM-IGNORE-END*/
+
+// *****************************************************************************
+/* USB Host Layer Descriptor Cache Configuration Size
+ 
+  Summary: 
+    Defines the largest configuration descriptor that can be cached.
+
+  Description:
+    This constant defines the size of the configuration descriptor storage of
+    each descriptor cache entry. Devices with a larger configuration descriptor
+    are not cached.
+
+  Remarks:
+    This constant is optional. A default value of 256 is used if it is not
+    specified.
+*/
+
+#define USB_HOST_DESCRIPTOR_CACHE_CONFIGURATION_SIZE  /*DOM-IGNORE-BEGIN*/256 /*DOM-IGNORE-END*/
+
+// *****************************************************************************
+/* USB Host Layer TPL Index Entries Number
+ 
+  Summary: 
+    Enables the TPL index and defines the largest TPL that it can index.
+
+  Description:
+    Specifying this constant enables an index of the Target Peripheral List
+    (TPL). The host layer builds the index when it is initialized. The index
+    keeps the class subclass protocol entries ordered by class code and the VID
+    PID entries ordered by vendor ID. When a driver is searched for a device or
+    an interface, the host layer finds the candidate entries with a binary
+    search and does not walk the whole TPL. Entries that ignore the class or
+    the VID and PID are always candidates. The TPL order, and so the priority
+    of the entries, is kept. This reduces the attach time of systems with a
+    large TPL.
+
+  Remarks:
+    This constant is optional. The index is disabled if it is not specified.
+    The index requires 4 bytes of data memory per entry. The index is not used
+    if the TPL has more entries than this value.
+*/
+
+#define USB_HOST_TPL_INDEX_ENTRIES_NUMBER  /*DOM-IGNORE-BEGIN*/64 /*DOM-IGNORE-END*/
+
 #endif // #ifndef __USB_HOST_CONFIG_TEMPLATE_H_
 
 /*******************************************************************************
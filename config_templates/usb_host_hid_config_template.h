@@ -122,6 +122,65 @@
 
 #define USB_HID_GLOBAL_PUSH_POP_STACK_SIZE       /*DOM-IGNORE-BEGIN*/ 1 /*DOM-IGNORE-END*/
 
+// *****************************************************************************
+/* USB Host HID Main Item Index Size
+
+  Summary:
+    Enables the main item index and specifies the number of main items that
+    it can hold.
+
+  Description:
+    Specifying this macro enables an index of the main items in the Report
+    Descriptor. The index is built once when the Report Descriptor has been
+    obtained from the device. Field queries from the usage drivers, such as
+    USB_HOST_HID_MainItemGet() and USB_HOST_HID_UsageGet(), then resume
+    parsing from the main item that precedes the queried one instead of
+    parsing the Report Descriptor from the start. This reduces the time taken
+    to query all the fields of a large Report Descriptor.
+
+    The value should be set to the number of main items in the largest
+    Report Descriptor that is expected. Main items past this number are
+    reached by parsing from the last indexed main item. The value must not
+    exceed 255.
+
+  Remarks:
+    This macro is optional. Each HID driver instance needs about 44 bytes of
+    RAM per index entry.
+*/
+
+#define USB_HOST_HID_MAIN_ITEM_INDEX_SIZE       /*DOM-IGNORE-BEGIN*/ 32 /*DOM-IGNORE-END*/
+
+// *****************************************************************************
+/* USB Host HID Report Buffers Number
+
+  Summary:
+    Enables the batched report engine and specifies the number of report
+    buffers per HID instance.
+
+  Description:
+    Specifying this macro enables the batched report engine. INTERRUPT IN
+    reports are received into report buffers owned by the HID client driver
+    and added to a ready queue that is shared by all HID instances. The queue
+    is drained in one pass from the HID client driver task routine. The usage
+    drivers get a pointer to the report buffer instead of a copy, and their
+    task routines run once per pass instead of once per HID instance.
+
+    A report that is equal to the previous report of the same HID instance
+    is dropped, unless the Report Descriptor of the device has relative INPUT
+    items (for example mouse movement). Keyboards will therefore not report
+    the keys again at every idle period.
+
+    One buffer holds the last report of the instance and one buffer is
+    filled by each INTERRUPT IN endpoint. The remaining buffers hold reports
+    waiting to be processed. The value must be between 2 and 32.
+
+  Remarks:
+    This macro is optional. Each HID driver instance needs 64 bytes of RAM per
+    report buffer.
+*/
+
+#define USB_HOST_HID_REPORT_BUFFERS_NUMBER       /*DOM-IGNORE-BEGIN*/ 3 /*DOM-IGNORE-END*/
+
 // *****************************************************************************
 /* USB Host HID number of Mouse buttons supported
 
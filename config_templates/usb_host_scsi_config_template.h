@@ -81,6 +81,30 @@
 
 #define USB_HOST_SCSI_CLIENTS_NUMBER  /*DOM-IGNORE-BEGIN*/1 /*DOM-IGNORE-END*/
 
+// *****************************************************************************
+/* USB Host SCSI Block Driver Command Queue Depth
+  
+  Summary:
+    Defines the number of block read and write requests that can be queued per
+    logical unit.
+
+  Description:
+    This constant defines the number of block read and write requests that a
+    client of the SCSI Block Driver, such as the MPLAB Harmony File System, can
+    queue per logical unit. While one request is in progress, the CBW of the
+    next request is prepared and is sent as soon as the CSW of the current
+    request has been received. Queued requests whose sectors and buffers are
+    contiguous and that have the same direction are merged into one READ10 or
+    WRITE10 command.
+
+  Remarks:
+    This constant is optional. A value of 1 is used if it is not specified. In
+    this case the SCSI Block Driver accepts one request per logical unit at a
+    time.
+*/
+
+#define USB_HOST_SCSI_COMMAND_QUEUE_DEPTH  /*DOM-IGNORE-BEGIN*/4 /*DOM-IGNORE-END*/
+
 #endif
 
 
@@ -221,6 +221,33 @@ typedef void (*DRV_USB_EVENT_CALLBACK)
 );
 
 
+// *****************************************************************************
+/* USB Driver Capabilities
+
+  Summary:
+    Identifies optional features supported by a USB Driver.
+
+  Description:
+    This enumeration identifies optional features that a USB Driver may
+    support. A driver reports the features that it supports in the
+    capabilities member of its interface. A client must not use a feature that
+    the driver does not report.
+
+  Remarks:
+    The values are bit masks and can be combined.
+*/
+
+typedef enum
+{
+    /* The driver does not support any optional feature */
+    DRV_USB_CAPABILITY_NONE = 0x0,
+
+    /* The driver supports IRPs whose data is described by an array of
+     * USB_IRP_DATA_SEGMENT elements */
+    DRV_USB_CAPABILITY_IRP_DATA_SEGMENTS = 0x1
+
+} DRV_USB_CAPABILITY;
+
 // *****************************************************************************
 /* USB Root Hub API Interface
 
@@ -404,6 +431,10 @@ typedef struct
     /* This is a pointer to the device Test mode enter function */
     USB_ERROR (*deviceTestModeEnter)(DRV_HANDLE handle, USB_TEST_MODE_SELECTORS testMode);
 
+    /* Bit map of the DRV_USB_CAPABILITY features that the driver supports. A
+     * driver that does not set this member supports no optional feature. */
+    uint32_t capabilities;
+
 } DRV_USB_DEVICE_INTERFACE;
 
 // *****************************************************************************
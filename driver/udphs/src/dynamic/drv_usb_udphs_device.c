@@ -508,13 +508,25 @@ void DRV_USB_UDPHS_DEVICE_Detach(DRV_HANDLE handle)
 
 uint16_t DRV_USB_UDPHS_DEVICE_SOFNumberGet(DRV_HANDLE handle)
 {
+    DRV_USB_UDPHS_OBJ * hDriver;
+    udphs_registers_t * usbID;
+    uint16_t retVal = 0;
+
     if(DRV_HANDLE_INVALID == handle)
     {
         SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB UDPHS Driver: Invalid Handle in DRV_USB_UDPHS_DEVICE_SOFNumberGet().");
     }
+    else
+    {
+        hDriver = (DRV_USB_UDPHS_OBJ *) handle;
+        usbID = hDriver->usbID;
 
+        /* Get the Frame count. In high speed, this is the number of the frame
+         * and not of the micro frame. */
+        retVal = (uint16_t)((usbID->UDPHS_FNUM & UDPHS_FNUM_FRAME_NUMBER_Msk) >> UDPHS_FNUM_FRAME_NUMBER_Pos);
+    }
 
-    return (0);
+    return (retVal);
 
 }/* end of DRV_USB_UDPHS_DEVICE_SOFNumberGet() */
 
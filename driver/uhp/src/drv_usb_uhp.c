@@ -646,7 +646,8 @@ void DRV_USB_UHP_HOST_IRPCancel(USB_HOST_IRP *inputIRP)
         }
     }
 
-    if (irp->status == USB_HOST_IRP_STATUS_IN_PROGRESS)
+    if ((irp->status == USB_HOST_IRP_STATUS_IN_PROGRESS)
+     && ((pipe->pipeType != USB_TRANSFER_TYPE_INTERRUPT) || (hDriver->deviceSpeed != USB_SPEED_HIGH)))
     {
         /* If the irp is already in progress then
          * we set the temporary state. This will get
@@ -656,6 +657,13 @@ void DRV_USB_UHP_HOST_IRPCancel(USB_HOST_IRP *inputIRP)
 
         irp->tempState = DRV_USB_UHP_HOST_IRP_STATE_ABORTED;
     }
+    else if ((irp->status == USB_HOST_IRP_STATUS_IN_PROGRESS)
+          && _DRV_USB_UHP_HOST_EhciInterruptIRPCancel(hDriver, pipe, irp))
+    {
+        /* An interrupt IRP in the EHCI periodic schedule is
+         * aborted once the host controller has left its
+         * queue head */
+    }
     else
     {
         irp->status = USB_HOST_IRP_STATUS_ABORTED;
@@ -745,6 +753,12 @@ void DRV_USB_UHP_HOST_PipeClose
     endpointObj->endpoint.inUse = false;
     endpointObj->endpoint.pipe  = NULL;
 
+    /* Take an interrupt or isochronous pipe out of the periodic schedule */
+    _DRV_USB_UHP_HOST_EhciPeriodicPipeClose(hDriver, pipe);
+
+    /* Return the qTD chain of a transfer in progress to the pool */
+    (void)_DRV_USB_UHP_HOST_EhciQtdChainRelease(hDriver, pipe);
+
     /* Now we invoke the call back for each IRP in this pipe and say that it is
      * aborted.  If the IRP is in progress, then that IRP will be actually
      * aborted on the next SOF This will allow the USB module to complete any
@@ -902,7 +916,10 @@ DRV_USB_UHP_HOST_PIPE_HANDLE DRV_USB_UHP_HOST_PipeSetup
         /* Pipe allocation for non-control transfer */
         for (pipeIter = 1; pipeIter < DRV_USB_UHP_PIPES_NUMBER; pipeIter++)
         {
-            if (false == gDrvUSBHostPipeObj[pipeIter].inUse)
+            /* The queue head of a closed periodic pipe is not used again
+             * until the host controller has left it */
+            if ((false == gDrvUSBHostPipeObj[pipeIter].inUse)
+             && _DRV_USB_UHP_HOST_EhciQueueHeadIsFree(pipeIter))
             {
                 /* This means we have found a free pipe object */
                 epFound = true;
@@ -942,6 +959,21 @@ DRV_USB_UHP_HOST_PIPE_HANDLE DRV_USB_UHP_HOST_PipeSetup
     pipe->intervalCounter      = bInterval;
     pipe->hostEndpoint         = pipeIter;
     pipe->endpointAndDirection = endpointAndDirection;
+    pipe->qtdChainHead         = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    pipe->qtdChainTail         = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+
+    if ((hDriver->deviceSpeed == USB_SPEED_HIGH)
+     && ((pipeType == USB_TRANSFER_TYPE_INTERRUPT) || (pipeType == USB_TRANSFER_TYPE_ISOCHRONOUS)))
+    {
+        /* Reserve bus time in the periodic schedule */
+        if (_DRV_USB_UHP_HOST_EhciPeriodicPipeOpen(hDriver, pipe) == false)
+        {
+            pipe->inUse = false;
+            hDriver->hostEndpointTable[pipeIter].endpoint.inUse = false;
+            hDriver->hostEndpointTable[pipeIter].endpoint.pipe  = NULL;
+            pipe = (DRV_USB_UHP_HOST_PIPE_OBJ *)DRV_USB_UHP_HOST_PIPE_HANDLE_INVALID;
+        }
+    }
 
     /* OSAL: Release Mutex */
     if (OSAL_MUTEX_Unlock(&hDriver->mutexID) != OSAL_RESULT_TRUE)
@@ -1642,6 +1674,7 @@ static void DRV_USB_UHP_HOST_NonControlTransferProcess
     DRV_USB_UHP_HOST_ENDPOINT_OBJ * endpointTable;
     USB_HOST_IRP_LOCAL                *irp;
     DRV_USB_UHP_HOST_PIPE_OBJ       *pipe;
+    uint32_t transferred;
     bool     endIRP = false;
     bool endIRPOut = false;
 
@@ -1707,6 +1740,17 @@ static void DRV_USB_UHP_HOST_NonControlTransferProcess
 
     if (endIRP)
     {
+        if (pipe->qtdChainHead != DRV_USB_UHP_EHCI_QTD_INDEX_NONE)
+        {
+            /* Bulk transfer on the EHCI: return the qTD chain to the pool */
+            transferred = _DRV_USB_UHP_HOST_EhciQtdChainRelease(hDriver, pipe);
+            if ((pipe->endpointAndDirection & 0x80) != 0)
+            {
+                /* A short packet ends an IN transfer */
+                irp->size = transferred;
+            }
+        }
+
         DCACHE_INVALIDATE_BY_ADDR((uint32_t *)irp->data, irp->size);
 
         /* This means we need to end the IRP */
@@ -1854,6 +1898,9 @@ void DRV_USB_UHP_Tasks(SYS_MODULE_OBJ object)
                  * task routines can be called here */
                 _DRV_USB_UHP_HOST_AttachDetachStateMachine(hDriver);
 
+                /* Periodic pipes that have left the EHCI schedule */
+                _DRV_USB_UHP_HOST_EhciPeriodicTasks(hDriver);
+
                 /* Polled mode driver tasks routines are really the same as the
                  * the ISR task routines called in the driver task routine */
                 _DRV_USB_UHP_Tasks_ISR(object);
@@ -122,6 +122,145 @@ typedef struct
 __ALIGNED(32) NOT_CACHED EHCIQueueHeadDescriptor EHCI_QueueHead[DRV_USB_UHP_PIPES_NUMBER]; /* Queue Head: 0x30=48 length */
 __ALIGNED(32) NOT_CACHED EHCIQueueTDDescriptor EHCI_QueueTD[DRV_USB_UHP_PIPES_NUMBER][DRV_USB_UHP_MAX_TRANSACTION];  /* Queue Element Transfer Descriptor: 1 qTD is 0x20=32 */
 __ALIGNED(4096) NOT_CACHED uint32_t PeriodicFrameList[1024];
+__ALIGNED(32) NOT_CACHED EHCIQueueTDDescriptor EHCI_QtdPool[DRV_USB_UHP_EHCI_QTD_NUMBER];  /* qTDs shared by the bulk pipes */
+
+/* A qTD has five buffer page pointers. A qTD transfers at most 20 KB, less
+ * the offset of the buffer in its first page. */
+#define DRV_USB_UHP_EHCI_QTD_PAGE_SIZE   4096u
+#define DRV_USB_UHP_EHCI_QTD_PAGES       5u
+
+/* Software state of the qTD pool. The qTDs are linked by pool index. A chain
+ * that has ended may still be cached by the host controller. It is retired
+ * and returned to the free list once the host controller has advanced the
+ * asynchronous schedule. */
+typedef struct
+{
+    /* Next qTD in the free list, in a chain or in a retired list */
+    uint16_t next[DRV_USB_UHP_EHCI_QTD_NUMBER];
+
+    /* Number of bytes requested in each qTD */
+    uint32_t length[DRV_USB_UHP_EHCI_QTD_NUMBER];
+
+    /* Free qTDs */
+    uint16_t freeHead;
+    uint16_t freeCount;
+
+    /* Chains retired before the doorbell was rung */
+    uint16_t doorbellHead;
+
+    /* Chains retired while the doorbell was pending */
+    uint16_t retiredHead;
+
+    /* True if the Interrupt on Async Advance Doorbell has been rung */
+    bool doorbellPending;
+
+    /* Chains taken off the periodic schedule, and the frame in which the last
+     * of them was retired. The doorbell does not cover the periodic schedule,
+     * so these chains are freed once the frame has passed. */
+    uint16_t periodicHead;
+    uint16_t periodicFrame;
+}
+EHCI_QTD_POOL;
+
+static EHCI_QTD_POOL gEhciQtdPool;
+
+/* Periodic schedule. The frame list repeats a tree of
+ * DRV_USB_UHP_EHCI_PERIODIC_FRAMES branches. Interrupt queue heads are
+ * nodes of the tree. iTDs are linked in the frame list ahead of the tree. */
+#define DRV_USB_UHP_EHCI_FRAME_LIST_SIZE    1024u
+#define DRV_USB_UHP_EHCI_PERIODIC_UFRAMES   (DRV_USB_UHP_EHCI_PERIODIC_FRAMES * 8u)
+
+/* USB 2.0 5.7.4: periodic transfers may use 80% of a microframe, that is
+ * 6000 of its 7500 byte times */
+#define DRV_USB_UHP_EHCI_UFRAME_BUDGET      6000u
+
+/* Frames between the current frame and the first iTD of a stream */
+#define DRV_USB_UHP_EHCI_ITD_LEAD_FRAMES    2u
+
+/* Frames to wait after a queue head or an iTD has left the periodic schedule
+ * before its qTDs are freed or it is used again. The complete-split of a
+ * split transaction can end in the frame that follows the start-split. */
+#define DRV_USB_UHP_EHCI_UNLINK_FRAMES      2u
+
+/* Link pointer types (Table 3-2. Typ Field Value Definitions) */
+#define DRV_USB_UHP_EHCI_LINK_TERMINATE     0x1u
+#define DRV_USB_UHP_EHCI_LINK_ITD           (0u << 1)
+#define DRV_USB_UHP_EHCI_LINK_QH            (1u << 1)
+
+/* 3.3 Isochronous (High-Speed) Transfer Descriptor (iTD) */
+typedef struct
+{
+    volatile uint32_t Next_Link_Pointer;            /* DWord 0 */
+    volatile uint32_t Transaction[8];               /* DWord 1 to 8: Transaction Status and Control */
+    volatile uint32_t Buffer_Page_Pointer[7];       /* DWord 9 to 15 */
+} EHCIIsoTDDescriptor;
+
+__ALIGNED(32) NOT_CACHED EHCIIsoTDDescriptor EHCI_IsoTD[DRV_USB_UHP_PIPES_NUMBER][DRV_USB_UHP_EHCI_ITD_NUMBER];  /* iTD ring of each isochronous pipe */
+
+/* Software state of an iTD */
+typedef struct
+{
+    /* IRP transferred by the iTD. NULL if the iTD is free. */
+    USB_HOST_IRP_LOCAL *irp;
+
+    /* Frame list index of the iTD */
+    uint16_t frame;
+}
+EHCI_ITD_STATE;
+
+/* Periodic schedule state of a pipe */
+typedef struct
+{
+    /* Microframes between two service opportunities. 0 if the pipe is not in
+     * the periodic schedule. */
+    uint16_t interval;
+
+    /* First microframe of the pipe in the tree */
+    uint16_t phase;
+
+    /* Bus time of a service opportunity in byte times */
+    uint16_t load;
+
+    /* True for an isochronous pipe */
+    bool isochronous;
+
+    /* Oldest queued iTD and number of queued iTDs */
+    uint8_t itdHead;
+    uint8_t itdCount;
+
+    /* Frame list index of the next iTD of the stream */
+    uint16_t nextFrame;
+
+    /* Inactive qTD at the end of the queue of an interrupt queue head. The
+     * host controller fetches it at each service opportunity. */
+    uint16_t dummy;
+
+    /* True while the pipe is out of the schedule and the host controller may
+     * still reference its queue head or iTDs */
+    bool unlinked;
+
+    /* True if the queue head restarts with DATA0 */
+    bool halted;
+
+    /* Frame in which the pipe was taken out of the schedule */
+    uint16_t unlinkFrame;
+
+    /* IRP cancelled while in progress. It is aborted once the host
+     * controller has left the queue head. */
+    USB_HOST_IRP_LOCAL *cancelled;
+
+    /* iTD state */
+    EHCI_ITD_STATE itd[DRV_USB_UHP_EHCI_ITD_NUMBER];
+}
+EHCI_PERIODIC_PIPE;
+
+static EHCI_PERIODIC_PIPE gEhciPeriodicPipe[DRV_USB_UHP_PIPES_NUMBER];
+
+/* Bus time reserved in each microframe of the tree, in byte times */
+static uint16_t gEhciUframeLoad[DRV_USB_UHP_EHCI_PERIODIC_UFRAMES];
+
+/* Link to the first queue head of each branch of the tree */
+static uint32_t gEhciPeriodicBranch[DRV_USB_UHP_EHCI_PERIODIC_FRAMES];
 extern __ALIGNED(4096) NOT_CACHED uint8_t USBBufferAligned[USB_HOST_TRANSFERS_NUMBER*64]; /* 4K page aligned */
 extern __ALIGNED(4096) NOT_CACHED volatile uint8_t setupPacket[8];
 
@@ -276,150 +415,2012 @@ static void _DRV_USB_UHP_HOST_EHCITESTTD(void)
 }
 
 /* Function:
-    static void ehci_create_queue_head(EHCIQueueHeadDescriptor *qh_base_addr,
-                                       EHCIQueueHeadDescriptor *qh_link_pointer,
-                                       uint32_t              terminate,
-                                       uint32_t              EP_number,
-                                       uint32_t              DeviceAddr,
-                                       EHCIQueueTDDescriptor *next_qTD_pointer,
-                                       uint32_t              mul,
-                                       uint32_t              smask,
-                                       uint32_t              dtc,
-                                       uint32_t              typ,
-                                       uint32_t              hubAddress,
-                                       uint32_t              hubPortAddress)
+    static void ehci_create_queue_head(EHCIQueueHeadDescriptor *qh_base_addr,
+                                       EHCIQueueHeadDescriptor *qh_link_pointer,
+                                       uint32_t              terminate,
+                                       uint32_t              EP_number,
+                                       uint32_t              DeviceAddr,
+                                       EHCIQueueTDDescriptor *next_qTD_pointer,
+                                       uint32_t              mul,
+                                       uint32_t              smask,
+                                       uint32_t              dtc,
+                                       uint32_t              typ,
+                                       uint32_t              hubAddress,
+                                       uint32_t              hubPortAddress)
+   Summary:
+    Create Queue Head
+
+   Description:
+    Fill Queue Head
+
+   Remarks:
+    Refer to .h for usage information.
+ */
+static void ehci_create_queue_head(EHCIQueueHeadDescriptor *qh_base_addr,
+                                   EHCIQueueHeadDescriptor *qh_link_pointer,
+                                   uint32_t              terminate,
+                                   uint32_t              EP_number,
+                                   uint32_t              DeviceAddr,
+                                   EHCIQueueTDDescriptor *next_qTD_pointer,
+                                   uint32_t              mult,
+                                   uint32_t              smask,
+                                   uint32_t              dtc,
+                                   uint32_t              typ,
+                                   uint32_t              hubAddress,
+                                   uint32_t              hubPortAddress)
+{
+    EHCIQueueHeadDescriptor *QueueHead = (EHCIQueueHeadDescriptor *)qh_base_addr;
+
+    /* Queue Head Horizontal Link Pointer
+     * see: 3.6 Queue Head
+     * Table 3-18. Queue Head DWord 0 */
+    QueueHead->Horizontal_Link_Pointer =
+        (uint32_t)qh_link_pointer |        /* QHLP: Queue Head Horizontal Link Pointer: bit[31:5] */
+        (typ << 1) |                       /* Typ: QH/(s)iTD/FSTN: Data structure type = 01b QH (queue head) */
+        (terminate << 0);                  /* T: Terminate = 1 : last transfer */
+
+    /* Table 3-19. Endpoint Characteristics: Queue Head DWord 1 */
+    QueueHead->Endpoint_Characteristics =
+        (0 << 28) |                      /* RL: Nak Count Reload */
+        (0 << 27) |                      /* C: Control Endpoint Flag */
+        (512 << 16) |                    /* Maximum Packet Length   1024 or 512 */
+        (1 << 15) |                      /* H: Head of Reclamation List Flag */  // This bit is set to mark the QH as the head of the asynchronous schedule.
+         //   This bit is cleared since this bit is not used for the periodic schedule.
+        (dtc << 14) |                    /* DTC: Data Toggle Control: 1: from qTD, 0: from QH (automatic) */
+        (2 << 12) |                      /* EPS: Endpoint Speed = 10b High-Speed (480 Mb/s) */
+        (EP_number <<  8) |              /* Endpt: Endpoint Number */
+        (0 << 7) |                       /* I: Inactivate on Next Transaction (Periodic Schedule Full or Low-speed)*/ 
+        (DeviceAddr <<  0);              /* Device Address */
+
+    /* Table 3-20. Endpoint Capabilities: Queue Head DWord 2 */
+    QueueHead->Endpoint_Capabilities =
+        (mult << 30) |                     /* Mult: High-Bandwidth Pipe Multiplier = 3 transactions to
+                                            * be issued for this endpoint per micro-frame */
+        (hubPortAddress << 23) |           /* Port Number */
+        (hubAddress << 16) |               /* Hub Addr (full or low-speed device) */
+        (0 <<  8) |                        /* Frame C-Mask: Split Completion Mask (low- or full-speed device) */
+        (smask <<  0);                     /* Frame S-mask: Interrupt Schedule Mask */
+
+    /* 3.6.3 Transfer Overlay */
+    QueueHead->Transfer_Overlay[0] = (uint32_t)next_qTD_pointer; /* Next qTD Pointer: DWord 4 */
+    // nothing   QueueHead->Transfer_Overlay[1] = 0x01; 
+}
+
+/* Function:
+    void ehci_received_size( uint32_t * BuffSize )
+
+   Summary:
+    Change the received size if needed
+
+   Description:
+    Change the received size if the requesting data number have not been sent
+
+   Remarks:
+    Refer to .h for usage information.
+ */
+void ehci_received_size( uint32_t * BuffSize )
+{
+    /* If Total Bytes to Transfer == 0, all data has been receive */
+    if( EHCI_QueueTD[0][1].qTD_Token.TotalBytesTF != 0 )
+    {
+        *BuffSize -= EHCI_QueueTD[0][1].qTD_Token.TotalBytesTF;
+    }
+}
+
+/* Function:
+    static void ehci_create_qTD(EHCIQueueTDDescriptor *qTD_base_addr,
+                                EHCIQueueTDDescriptor *next_qTD_base_addr,
+                                uint32_t terminate, 
+                                uint32_t PID,
+                                uint32_t data_toggle,
+                                uint32_t nb_bytes,
+                                uint32_t int_on_complete,
+                                uint32_t *buffer_base_addr)
+
+   Summary:
+    Create Transfer Descriptor
+
+   Description:
+    Fill Transfer Descriptor
+
+   Remarks:
+    Refer to .h for usage information.
+ */
+static void ehci_create_qTD(EHCIQueueTDDescriptor *qTD_base_addr,
+                            EHCIQueueTDDescriptor *next_qTD_base_addr,
+                            uint32_t terminate, 
+                            uint32_t PID,
+                            uint32_t data_toggle,
+                            uint32_t nb_bytes,
+                            uint32_t int_on_complete,
+                            uint32_t *buffer_base_addr)
+{
+    EHCIQueueTDDescriptor *qTD = (EHCIQueueTDDescriptor *)qTD_base_addr;
+
+    /* 3.5.1 Next qTD Pointer */
+    /* Table 3-14. qTD Next Element Transfer Pointer (DWord 0) */
+    qTD->Next_qTD_Pointer = (uint32_t)next_qTD_base_addr |  /* Next qTD Pointer */
+                            terminate;                      /* Terminate */
+
+    /* 3.5.2 Alternate Next qTD Pointer */
+    /* Table 3-15. qTD Alternate Next Element Transfer Pointer (DWord 1) */
+    qTD->Alternate_Next_qTD_Pointer = 0x1; /* No Alternate, Terminate */
+
+    /* 3.5.3 qTD Token */
+    /* Table 3-16. qTD Token (DWord 2) */
+    qTD->qTD_Token.qtdtoken = (data_toggle << 31) |     /* Data Toggle */
+                              (nb_bytes << 16) |        /* Total Bytes to Transfer */
+                              (int_on_complete << 15) | /* Interrupt On Complete (IOC) */
+                              (0 << 12) |               /* Current Page (C_Page) */
+                              (3 << 10) |               /* Error Counter (CERR)   Allow 3 retry */
+                              (PID <<  8) |             /* PID Code (0: OUT, 1: IN 2: SETUP) */
+                              (1 << 7);                 /* Status Field Description: Active. */
+
+    /* 3.5.4 qTD Buffer Page Pointer List */
+    /* Table 3-17. qTD Buffer Pointer(s) (DWords 3-7) */
+    qTD->qTD_Buffer_Page_Pointer_List = (uint32_t)buffer_base_addr;    /* Buffer Pointer List : 4k page aligned (Bit 31:12) */
+}
+
+/* Function:
+    static void ehci_qtd_pool_init(void)
+
+   Summary:
+    Initialize the qTD pool
+
+   Description:
+    Puts all qTDs of the pool in the free list.
+
+   Remarks:
+    None.
+ */
+static void ehci_qtd_pool_init(void)
+{
+    uint16_t i;
+
+    memset(EHCI_QtdPool, 0, sizeof(EHCI_QtdPool));
+
+    for (i = 0; i < DRV_USB_UHP_EHCI_QTD_NUMBER; i++)
+    {
+        gEhciQtdPool.next[i] = i + 1;
+        gEhciQtdPool.length[i] = 0;
+    }
+    gEhciQtdPool.next[DRV_USB_UHP_EHCI_QTD_NUMBER - 1] = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+
+    gEhciQtdPool.freeHead = 0;
+    gEhciQtdPool.freeCount = DRV_USB_UHP_EHCI_QTD_NUMBER;
+    gEhciQtdPool.doorbellHead = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    gEhciQtdPool.retiredHead = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    gEhciQtdPool.doorbellPending = false;
+    gEhciQtdPool.periodicHead = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    gEhciQtdPool.periodicFrame = 0;
+}
+
+/* Function:
+    static uint16_t ehci_qtd_dummy_get(void)
+
+   Summary:
+    Take an inactive qTD from the pool
+
+   Description:
+    Returns the pool index of an inactive qTD whose next and alternate next
+    pointers terminate, or DRV_USB_UHP_EHCI_QTD_INDEX_NONE if the pool is
+    empty.
+
+   Remarks:
+    None.
+ */
+static uint16_t ehci_qtd_dummy_get(void)
+{
+    EHCIQueueTDDescriptor *qTD;
+    uint16_t index = gEhciQtdPool.freeHead;
+
+    if (gEhciQtdPool.freeCount == 0)
+    {
+        return DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    }
+
+    gEhciQtdPool.freeHead = gEhciQtdPool.next[index];
+    gEhciQtdPool.freeCount--;
+    gEhciQtdPool.next[index] = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    gEhciQtdPool.length[index] = 0;
+
+    qTD = &EHCI_QtdPool[index];
+    qTD->Next_qTD_Pointer = 0x1;
+    qTD->Alternate_Next_qTD_Pointer = 0x1;
+    qTD->qTD_Token.qtdtoken = 0;
+
+    return index;
+}
+
+/* Function:
+    static void ehci_qtd_list_free(uint16_t head)
+
+   Summary:
+    Return a list of qTDs to the pool
+
+   Description:
+    Moves all qTDs of a chain or of a retired list to the free list.
+
+   Remarks:
+    The host controller must not reference the qTDs any more.
+ */
+static void ehci_qtd_list_free(uint16_t head)
+{
+    uint16_t index;
+
+    while (head != DRV_USB_UHP_EHCI_QTD_INDEX_NONE)
+    {
+        index = head;
+        head = gEhciQtdPool.next[index];
+
+        gEhciQtdPool.next[index] = gEhciQtdPool.freeHead;
+        gEhciQtdPool.freeHead = index;
+        gEhciQtdPool.freeCount++;
+    }
+}
+
+/* Function:
+    static void ehci_qtd_reclaim(volatile uhphs_registers_t *usbIDEHCI)
+
+   Summary:
+    Free the retired qTDs if the asynchronous schedule is idle
+
+   Description:
+    The host controller does not reference any qTD once the asynchronous
+    schedule is disabled, so all retired chains can be freed without waiting
+    for the async advance doorbell.
+
+   Remarks:
+    None.
+ */
+static void ehci_qtd_reclaim(volatile uhphs_registers_t *usbIDEHCI)
+{
+    if ((usbIDEHCI->UHPHS_USBSTS & UHPHS_USBSTS_ASS_Msk) == 0)
+    {
+        ehci_qtd_list_free(gEhciQtdPool.doorbellHead);
+        ehci_qtd_list_free(gEhciQtdPool.retiredHead);
+        gEhciQtdPool.doorbellHead = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+        gEhciQtdPool.retiredHead = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    }
+}
+
+/* Function:
+    static void ehci_qtd_doorbell(volatile uhphs_registers_t *usbIDEHCI)
+
+   Summary:
+    Ring the async advance doorbell for the retired qTDs
+
+   Description:
+    Moves the retired chains to the doorbell list and asks the host controller
+    to interrupt once it has advanced the asynchronous schedule. The doorbell
+    is only rung if the asynchronous schedule is enabled. The retired chains
+    are otherwise freed by ehci_qtd_reclaim().
+
+   Remarks:
+    None.
+ */
+static void ehci_qtd_doorbell(volatile uhphs_registers_t *usbIDEHCI)
+{
+    if ((gEhciQtdPool.doorbellPending == false)
+     && (gEhciQtdPool.retiredHead != DRV_USB_UHP_EHCI_QTD_INDEX_NONE)
+     && ((usbIDEHCI->UHPHS_USBCMD & UHPHS_USBCMD_ASE_Msk) != 0))
+    {
+        gEhciQtdPool.doorbellHead = gEhciQtdPool.retiredHead;
+        gEhciQtdPool.retiredHead = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+        gEhciQtdPool.doorbellPending = true;
+
+        /* Interrupt on Async Advance Doorbell */
+        usbIDEHCI->UHPHS_USBCMD |= UHPHS_USBCMD_IAAD_Msk;
+    }
+}
+
+/* Function:
+    static uint32_t ehci_qtd_chain_count(uint32_t address,
+                                         uint32_t length,
+                                         uint32_t maxPacketSize,
+                                         uint32_t PID)
+
+   Summary:
+    Number of qTDs needed for a transfer
+
+   Description:
+    Returns the number of pool qTDs that ehci_qtd_chain_build() uses for the
+    transfer.
+
+   Remarks:
+    None.
+ */
+static uint32_t ehci_qtd_chain_count(uint32_t address,
+                                     uint32_t length,
+                                     uint32_t maxPacketSize,
+                                     uint32_t PID)
+{
+    uint32_t count = 0;
+    uint32_t bytes;
+
+    do
+    {
+        bytes = (DRV_USB_UHP_EHCI_QTD_PAGES * DRV_USB_UHP_EHCI_QTD_PAGE_SIZE) - (address & (DRV_USB_UHP_EHCI_QTD_PAGE_SIZE - 1));
+        if (bytes >= length)
+        {
+            bytes = length;
+        }
+        else
+        {
+            /* Only the last qTD can end with a short packet */
+            bytes -= bytes % maxPacketSize;
+        }
+        address += bytes;
+        length -= bytes;
+        count++;
+    } while (length != 0);
+
+    /* An IN transfer ends with an inactive qTD. A short packet makes the host
+     * controller skip to this qTD. */
+    if (PID == 1)
+    {
+        count++;
+    }
+
+    return count;
+}
+
+/* Function:
+    static uint16_t ehci_qtd_chain_build(uint32_t address,
+                                         uint32_t length,
+                                         uint32_t maxPacketSize,
+                                         uint32_t PID,
+                                         uint8_t *dataToggle,
+                                         uint16_t *chainTail)
+
+   Summary:
+    Build a qTD chain for a transfer
+
+   Description:
+    Takes qTDs from the pool and fills them for the transfer of length bytes
+    from or to address. Each qTD uses all five buffer pages, so it transfers up
+    to 20 KB. All qTDs except the last transfer a whole number of packets.
+    The data toggle of each qTD follows from the number of packets of the
+    qTDs before it. On return, dataToggle contains the data toggle of the
+    packet that follows the transfer. An IN chain ends with an inactive qTD
+    that is the alternate next qTD of all qTDs, so a short packet ends the
+    transfer. The last qTD that transfers data interrupts on completion.
+
+    Returns the pool index of the first qTD. The caller must have checked with
+    ehci_qtd_chain_count() that the pool has enough free qTDs.
+
+   Remarks:
+    None.
+ */
+static uint16_t ehci_qtd_chain_build(uint32_t address,
+                                     uint32_t length,
+                                     uint32_t maxPacketSize,
+                                     uint32_t PID,
+                                     uint8_t *dataToggle,
+                                     uint16_t *chainTail)
+{
+    EHCIQueueTDDescriptor *qTD;
+    EHCIQueueTDDescriptor *qTDPrevious = NULL;
+    EHCIQueueTDDescriptor *qTDEnd = NULL;
+    uint16_t chainHead = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    uint16_t index = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    uint16_t previous = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    uint16_t endIndex = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    uint32_t alternateNext = 0x1;  /* Terminate */
+    uint32_t bytes;
+    uint32_t packets;
+    uint32_t page;
+    uint32_t last;
+
+    if (PID == 1)
+    {
+        /* Inactive qTD at the end of an IN chain */
+        endIndex = ehci_qtd_dummy_get();
+        qTDEnd = &EHCI_QtdPool[endIndex];
+        alternateNext = (uint32_t)qTDEnd;
+    }
+
+    do
+    {
+        bytes = (DRV_USB_UHP_EHCI_QTD_PAGES * DRV_USB_UHP_EHCI_QTD_PAGE_SIZE) - (address & (DRV_USB_UHP_EHCI_QTD_PAGE_SIZE - 1));
+        if (bytes >= length)
+        {
+            bytes = length;
+            last = 1;
+        }
+        else
+        {
+            /* Only the last qTD can end with a short packet */
+            bytes -= bytes % maxPacketSize;
+            last = 0;
+        }
+
+        index = gEhciQtdPool.freeHead;
+        gEhciQtdPool.freeHead = gEhciQtdPool.next[index];
+        gEhciQtdPool.freeCount--;
+        gEhciQtdPool.next[index] = endIndex;
+        gEhciQtdPool.length[index] = bytes;
+
+        qTD = &EHCI_QtdPool[index];
+        ehci_create_qTD(qTD,
+                        qTDEnd,              /* next qTD address base */
+                        (PID == 1) ? 0 : 1,  /* Terminate */
+                        PID,                 /* PID: OUT = 0, IN = 1 */
+                        *dataToggle,         /* data toggle */
+                        bytes,               /* Total Bytes to transfer */
+                        last,                /* Interrupt on Complete */
+                        (uint32_t *)address);
+        qTD->Alternate_Next_qTD_Pointer = alternateNext;
+
+        /* Table 3-17. qTD Buffer Pointer(s): pages 1 to 4 follow the 4K page
+         * of the first buffer pointer */
+        for (page = 1; page < DRV_USB_UHP_EHCI_QTD_PAGES; page++)
+        {
+            qTD->qTD_Buffer[page - 1] = (address & ~(DRV_USB_UHP_EHCI_QTD_PAGE_SIZE - 1)) + (page * DRV_USB_UHP_EHCI_QTD_PAGE_SIZE);
+        }
+
+        if (qTDPrevious == NULL)
+        {
+            chainHead = index;
+        }
+        else
+        {
+            qTDPrevious->Next_qTD_Pointer = (uint32_t)qTD;
+            gEhciQtdPool.next[previous] = index;
+        }
+        qTDPrevious = qTD;
+        previous = index;
+
+        /* A zero length qTD is one packet */
+        packets = (bytes == 0) ? 1 : ((bytes + maxPacketSize - 1) / maxPacketSize);
+        *dataToggle ^= (packets & 0x1);
+
+        address += bytes;
+        length -= bytes;
+    } while (length != 0);
+
+    *chainTail = (PID == 1) ? endIndex : index;
+
+    return chainHead;
+}
+
+/* Function:
+    uint32_t _DRV_USB_UHP_HOST_EhciQtdChainRelease(DRV_USB_UHP_OBJ *hDriver,
+                                                   DRV_USB_UHP_HOST_PIPE_OBJ *pipe)
+
+   Summary:
+    Release the qTD chain of a bulk pipe
+
+   Description:
+    Returns the number of bytes that the qTD chain of the pipe has transferred
+    and updates the data toggle of the driver with the toggle that the host
+    controller has written back. The chain is then retired. It is returned to
+    the pool on the next async advance interrupt, or at once if the
+    asynchronous schedule is idle.
+
+   Remarks:
+    Refer to .h for usage information.
+ */
+uint32_t _DRV_USB_UHP_HOST_EhciQtdChainRelease(DRV_USB_UHP_OBJ *hDriver,
+                                               DRV_USB_UHP_HOST_PIPE_OBJ *pipe)
+{
+    EHCIQueueTDDescriptor *qTD;
+    uint32_t transferred = 0;
+    uint16_t index;
+
+    if (pipe->qtdChainHead == DRV_USB_UHP_EHCI_QTD_INDEX_NONE)
+    {
+        return 0;
+    }
+
+    for (index = pipe->qtdChainHead; index != DRV_USB_UHP_EHCI_QTD_INDEX_NONE; index = gEhciQtdPool.next[index])
+    {
+        qTD = &EHCI_QtdPool[index];
+        if ((gEhciQtdPool.length[index] != 0) && (qTD->qTD_Token.Status & 0x80) == 0)
+        {
+            /* The host controller has retired this qTD */
+            transferred += gEhciQtdPool.length[index] - qTD->qTD_Token.TotalBytesTF;
+
+            if (pipe->pipeType != USB_TRANSFER_TYPE_BULK)
+            {
+                /* The queue head of an interrupt pipe keeps the data toggle */
+            }
+            else if ((pipe->endpointAndDirection & 0x80) == 0)
+            {
+                hDriver->staticDToggleOut = qTD->qTD_Token.DataToggle;
+            }
+            else
+            {
+                hDriver->staticDToggleIn = qTD->qTD_Token.DataToggle;
+            }
+        }
+    }
+
+    /* Add the chain to the retired list */
+    gEhciQtdPool.next[pipe->qtdChainTail] = gEhciQtdPool.retiredHead;
+    gEhciQtdPool.retiredHead = pipe->qtdChainHead;
+    pipe->qtdChainHead = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    pipe->qtdChainTail = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+
+    ehci_qtd_reclaim(hDriver->usbIDEHCI);
+    ehci_qtd_doorbell(hDriver->usbIDEHCI);
+
+    return transferred;
+}
+
+/* ***************************************************************************** */
+/* ***************************************************************************** */
+/* Periodic Schedule Routines */
+/* ***************************************************************************** */
+/* ***************************************************************************** */
+
+/* Function:
+    static uint32_t ehci_periodic_interval(USB_SPEED speed,
+                                           USB_TRANSFER_TYPE pipeType,
+                                           uint8_t bInterval)
+
+   Summary:
+    Service interval of a periodic endpoint in microframes
+
+   Description:
+    Converts bInterval of the endpoint descriptor to a power of two number of
+    microframes. Intervals that are longer than the tree are shortened to the
+    tree, which polls the endpoint more often than requested.
+
+   Remarks:
+    None.
+ */
+static uint32_t ehci_periodic_interval(USB_SPEED speed,
+                                       USB_TRANSFER_TYPE pipeType,
+                                       uint8_t bInterval)
+{
+    uint32_t interval = 1;
+
+    if (bInterval == 0)
+    {
+        bInterval = 1;
+    }
+
+    if ((speed == USB_SPEED_HIGH) || (pipeType == USB_TRANSFER_TYPE_ISOCHRONOUS))
+    {
+        /* 2^(bInterval-1) microframes, or frames for a full-speed isochronous endpoint */
+        while ((bInterval > 1) && (interval < DRV_USB_UHP_EHCI_PERIODIC_UFRAMES))
+        {
+            interval <<= 1;
+            bInterval--;
+        }
+        if (speed != USB_SPEED_HIGH)
+        {
+            interval *= 8;
+        }
+    }
+    else
+    {
+        /* bInterval frames, rounded down to a power of two */
+        while ((interval * 2) <= bInterval)
+        {
+            interval <<= 1;
+        }
+        interval *= 8;
+    }
+
+    if (interval > DRV_USB_UHP_EHCI_PERIODIC_UFRAMES)
+    {
+        interval = DRV_USB_UHP_EHCI_PERIODIC_UFRAMES;
+    }
+
+    return interval;
+}
+
+/* Function:
+    static uint32_t ehci_periodic_load(uint16_t wMaxPacketSize, bool isochronous)
+
+   Summary:
+    Bus time of a high-speed service opportunity in byte times
+
+   Description:
+    Bits 12:11 of wMaxPacketSize give the number of additional transactions
+    per microframe. Each transaction costs its payload with worst case bit
+    stuffing and the protocol overhead of USB 2.0 5.11.3.
+
+   Remarks:
+    None.
+ */
+static uint32_t ehci_periodic_load(uint16_t wMaxPacketSize, bool isochronous)
+{
+    uint32_t payload = wMaxPacketSize & 0x7FFu;
+    uint32_t mult = ((wMaxPacketSize >> 11) & 0x3u) + 1;
+
+    return mult * (((payload * 7) / 6) + (isochronous ? 38 : 55));
+}
+
+/* Function:
+    static bool ehci_periodic_reserve(EHCI_PERIODIC_PIPE *periodic,
+                                      uint32_t interval,
+                                      uint32_t load)
+
+   Summary:
+    Reserve periodic bus time for a pipe
+
+   Description:
+    Tries every phase of the interval and keeps the one whose busiest
+    microframe has the least load. The reservation fails if that microframe
+    would exceed the periodic budget.
+
+   Remarks:
+    None.
+ */
+static bool ehci_periodic_reserve(EHCI_PERIODIC_PIPE *periodic,
+                                  uint32_t interval,
+                                  uint32_t load)
+{
+    uint32_t phase;
+    uint32_t uframe;
+    uint32_t worst;
+    uint32_t bestPhase = 0;
+    uint32_t bestLoad = 0xFFFFFFFFu;
+
+    for (phase = 0; phase < interval; phase++)
+    {
+        worst = 0;
+        for (uframe = phase; uframe < DRV_USB_UHP_EHCI_PERIODIC_UFRAMES; uframe += interval)
+        {
+            if (gEhciUframeLoad[uframe] > worst)
+            {
+                worst = gEhciUframeLoad[uframe];
+            }
+        }
+        if (worst < bestLoad)
+        {
+            bestLoad = worst;
+            bestPhase = phase;
+        }
+    }
+
+    if ((bestLoad + load) > DRV_USB_UHP_EHCI_UFRAME_BUDGET)
+    {
+        return false;
+    }
+
+    for (uframe = bestPhase; uframe < DRV_USB_UHP_EHCI_PERIODIC_UFRAMES; uframe += interval)
+    {
+        gEhciUframeLoad[uframe] += load;
+    }
+
+    periodic->interval = interval;
+    periodic->phase = bestPhase;
+    periodic->load = load;
+
+    return true;
+}
+
+/* Function:
+    static void ehci_periodic_release(EHCI_PERIODIC_PIPE *periodic)
+
+   Summary:
+    Release the periodic bus time of a pipe
+
+   Description:
+    Returns the bus time reserved by ehci_periodic_reserve().
+
+   Remarks:
+    None.
+ */
+static void ehci_periodic_release(EHCI_PERIODIC_PIPE *periodic)
+{
+    uint32_t uframe;
+
+    if (periodic->interval != 0)
+    {
+        for (uframe = periodic->phase; uframe < DRV_USB_UHP_EHCI_PERIODIC_UFRAMES; uframe += periodic->interval)
+        {
+            gEhciUframeLoad[uframe] -= periodic->load;
+        }
+        periodic->interval = 0;
+    }
+}
+
+/* Function:
+    static uint32_t ehci_periodic_smask(const EHCI_PERIODIC_PIPE *periodic)
+
+   Summary:
+    Microframe S-mask of a pipe
+
+   Description:
+    An interval of a frame or more has one microframe per frame. A shorter
+    interval has a microframe every interval in each frame.
+
+   Remarks:
+    None.
+ */
+static uint32_t ehci_periodic_smask(const EHCI_PERIODIC_PIPE *periodic)
+{
+    uint32_t smask = 0;
+    uint32_t uframe;
+
+    if (periodic->interval >= 8)
+    {
+        smask = 1u << (periodic->phase & 0x7u);
+    }
+    else
+    {
+        for (uframe = periodic->phase; uframe < 8; uframe += periodic->interval)
+        {
+            smask |= 1u << uframe;
+        }
+    }
+
+    return smask;
+}
+
+/* Function:
+    static uint32_t ehci_periodic_frame_interval(const EHCI_PERIODIC_PIPE *periodic)
+
+   Summary:
+    Frames between two frames that service a pipe
+
+   Description:
+    Returns the number of frames between two frames that contain the pipe.
+
+   Remarks:
+    None.
+ */
+static uint32_t ehci_periodic_frame_interval(const EHCI_PERIODIC_PIPE *periodic)
+{
+    return (periodic->interval >= 8) ? (periodic->interval / 8u) : 1u;
+}
+
+/* Function:
+    static void ehci_periodic_frame_update(uint32_t frame)
+
+   Summary:
+    Update an entry of the periodic frame list
+
+   Description:
+    Links the iTDs queued for the frame ahead of the tree branch of the frame.
+    The iTDs are always linked in the same order, so that each write leaves a
+    valid list for the host controller.
+
+   Remarks:
+    None.
+ */
+static void ehci_periodic_frame_update(uint32_t frame)
+{
+    EHCI_PERIODIC_PIPE *periodic;
+    uint32_t link = gEhciPeriodicBranch[frame % DRV_USB_UHP_EHCI_PERIODIC_FRAMES];
+    uint32_t pipeIndex;
+    uint32_t queued;
+    uint32_t index;
+
+    for (pipeIndex = 0; pipeIndex < DRV_USB_UHP_PIPES_NUMBER; pipeIndex++)
+    {
+        periodic = &gEhciPeriodicPipe[pipeIndex];
+        if ((periodic->interval == 0) || (periodic->isochronous == false))
+        {
+            continue;
+        }
+        for (queued = 0; queued < periodic->itdCount; queued++)
+        {
+            index = (periodic->itdHead + queued) % DRV_USB_UHP_EHCI_ITD_NUMBER;
+            if (periodic->itd[index].frame == frame)
+            {
+                EHCI_IsoTD[pipeIndex][index].Next_Link_Pointer = link;
+                link = (uint32_t)&EHCI_IsoTD[pipeIndex][index] | DRV_USB_UHP_EHCI_LINK_ITD;
+            }
+        }
+    }
+
+    PeriodicFrameList[frame] = link;
+}
+
+/* Function:
+    static void ehci_periodic_link(void)
+
+   Summary:
+    Link the interrupt queue heads in the periodic tree
+
+   Description:
+    The queue heads are ordered by decreasing frame interval. A branch holds
+    each queue head whose frame phase matches the branch. A queue head in a
+    branch is followed by the next queue head of the order that is in the same
+    branch. As the intervals are powers of two, this next queue head is the
+    same in all branches that hold the queue head, so a queue head needs a
+    single horizontal link.
+
+   Remarks:
+    None.
+ */
+static void ehci_periodic_link(void)
+{
+    uint8_t order[DRV_USB_UHP_PIPES_NUMBER];
+    uint32_t count = 0;
+    uint32_t pipeIndex;
+    uint32_t position;
+    uint32_t next;
+    uint32_t branch;
+    uint32_t frame;
+    uint32_t link;
+    uint32_t frameInterval;
+    EHCI_PERIODIC_PIPE *periodic;
+
+    /* Sort the queue heads by decreasing frame interval */
+    for (pipeIndex = 0; pipeIndex < DRV_USB_UHP_PIPES_NUMBER; pipeIndex++)
+    {
+        periodic = &gEhciPeriodicPipe[pipeIndex];
+        if ((periodic->interval == 0) || (periodic->isochronous == true) || periodic->unlinked)
+        {
+            continue;
+        }
+        position = count;
+        while ((position > 0)
+            && (ehci_periodic_frame_interval(&gEhciPeriodicPipe[order[position - 1]]) < ehci_periodic_frame_interval(periodic)))
+        {
+            order[position] = order[position - 1];
+            position--;
+        }
+        order[position] = pipeIndex;
+        count++;
+    }
+
+    /* Horizontal links, from the end of the order */
+    for (position = count; position > 0; position--)
+    {
+        periodic = &gEhciPeriodicPipe[order[position - 1]];
+        link = DRV_USB_UHP_EHCI_LINK_TERMINATE;
+        for (next = position; next < count; next++)
+        {
+            frameInterval = ehci_periodic_frame_interval(&gEhciPeriodicPipe[order[next]]);
+            if (((periodic->phase / 8u) % frameInterval) == (gEhciPeriodicPipe[order[next]].phase / 8u))
+            {
+                link = (uint32_t)&EHCI_QueueHead[order[next]] | DRV_USB_UHP_EHCI_LINK_QH;
+                break;
+            }
+        }
+        EHCI_QueueHead[order[position - 1]].Horizontal_Link_Pointer = link;
+    }
+
+    /* First queue head of each branch */
+    for (branch = 0; branch < DRV_USB_UHP_EHCI_PERIODIC_FRAMES; branch++)
+    {
+        link = DRV_USB_UHP_EHCI_LINK_TERMINATE;
+        for (position = 0; position < count; position++)
+        {
+            frameInterval = ehci_periodic_frame_interval(&gEhciPeriodicPipe[order[position]]);
+            if ((branch % frameInterval) == (gEhciPeriodicPipe[order[position]].phase / 8u))
+            {
+                link = (uint32_t)&EHCI_QueueHead[order[position]] | DRV_USB_UHP_EHCI_LINK_QH;
+                break;
+            }
+        }
+        gEhciPeriodicBranch[branch] = link;
+    }
+
+    for (frame = 0; frame < DRV_USB_UHP_EHCI_FRAME_LIST_SIZE; frame++)
+    {
+        ehci_periodic_frame_update(frame);
+    }
+}
+
+/* Function:
+    static void ehci_periodic_init(void)
+
+   Summary:
+    Initialize the periodic schedule
+
+   Description:
+    Empties the tree, the bus time reservations and the frame list.
+
+   Remarks:
+    None.
+ */
+static void ehci_periodic_init(void)
+{
+    uint32_t branch;
+
+    memset(gEhciPeriodicPipe, 0, sizeof(gEhciPeriodicPipe));
+    memset(gEhciUframeLoad, 0, sizeof(gEhciUframeLoad));
+    memset(EHCI_IsoTD, 0, sizeof(EHCI_IsoTD));
+
+    for (branch = 0; branch < DRV_USB_UHP_EHCI_PERIODIC_FRAMES; branch++)
+    {
+        gEhciPeriodicBranch[branch] = DRV_USB_UHP_EHCI_LINK_TERMINATE;
+    }
+}
+
+/* Function:
+    static uint32_t ehci_periodic_current_frame(volatile uhphs_registers_t *usbIDEHCI)
+
+   Summary:
+    Frame list index of the current frame
+
+   Description:
+    Returns the frame part of the FRINDEX register.
+
+   Remarks:
+    None.
+ */
+static uint32_t ehci_periodic_current_frame(volatile uhphs_registers_t *usbIDEHCI)
+{
+    return ((usbIDEHCI->UHPHS_FRINDEX & UHPHS_FRINDEX_FI_Msk) >> 3) & (DRV_USB_UHP_EHCI_FRAME_LIST_SIZE - 1);
+}
+
+/* Function:
+    static bool ehci_periodic_frame_passed(volatile uhphs_registers_t *usbIDEHCI,
+                                           uint32_t frame)
+
+   Summary:
+    Check if the host controller has left a frame
+
+   Description:
+    Returns true if DRV_USB_UHP_EHCI_UNLINK_FRAMES frames have started since
+    frame, or if the periodic schedule is not running. The host controller
+    then no longer references what was taken out of the periodic schedule
+    in frame.
+
+   Remarks:
+    None.
+ */
+static bool ehci_periodic_frame_passed(volatile uhphs_registers_t *usbIDEHCI,
+                                       uint32_t frame)
+{
+    if ((usbIDEHCI->UHPHS_USBSTS & UHPHS_USBSTS_PSS_Msk) == 0)
+    {
+        return true;
+    }
+
+    return (((ehci_periodic_current_frame(usbIDEHCI) - frame) & (DRV_USB_UHP_EHCI_FRAME_LIST_SIZE - 1))
+            >= DRV_USB_UHP_EHCI_UNLINK_FRAMES);
+}
+
+/* Function:
+    static void ehci_periodic_retire(volatile uhphs_registers_t *usbIDEHCI,
+                                     uint16_t head,
+                                     uint16_t tail)
+
+   Summary:
+    Retire qTDs that were used in the periodic schedule
+
+   Description:
+    Adds the qTDs from head to tail to the periodic retired list. The list is
+    freed by ehci_periodic_reclaim() once the current frame has passed.
+
+   Remarks:
+    None.
+ */
+static void ehci_periodic_retire(volatile uhphs_registers_t *usbIDEHCI,
+                                 uint16_t head,
+                                 uint16_t tail)
+{
+    gEhciQtdPool.next[tail] = gEhciQtdPool.periodicHead;
+    gEhciQtdPool.periodicHead = head;
+    gEhciQtdPool.periodicFrame = ehci_periodic_current_frame(usbIDEHCI);
+}
+
+/* Function:
+    static void ehci_periodic_unlink(volatile uhphs_registers_t *usbIDEHCI,
+                                     EHCI_PERIODIC_PIPE *periodic)
+
+   Summary:
+    Take a queue head out of the periodic tree
+
+   Description:
+    The queue head is left out of the tree until ehci_periodic_reclaim() finds
+    that the frame has passed. Its overlay and its qTDs must not be changed
+    before.
+
+   Remarks:
+    None.
+ */
+static void ehci_periodic_unlink(volatile uhphs_registers_t *usbIDEHCI,
+                                 EHCI_PERIODIC_PIPE *periodic)
+{
+    periodic->unlinked = true;
+    ehci_periodic_link();
+    periodic->unlinkFrame = ehci_periodic_current_frame(usbIDEHCI);
+}
+
+/* Function:
+    static USB_ERROR ehci_itd_submit(DRV_USB_UHP_OBJ *hDriver,
+                                     DRV_USB_UHP_HOST_PIPE_OBJ *pipe,
+                                     USB_HOST_IRP_LOCAL *irp)
+
+   Summary:
+    Queue an isochronous IRP
+
+   Description:
+    An IRP holds the data of one frame of the stream. It is transferred by one
+    iTD in the next frame of the pipe. A stream that has no iTD queued, or
+    that has fallen behind the host controller, restarts a few frames ahead of
+    the current frame. The data is spread over the microframes of the pipe,
+    each transferring up to wMaxPacketSize bytes times the number of
+    transactions per microframe.
+
+   Remarks:
+    None.
+ */
+static USB_ERROR ehci_itd_submit(DRV_USB_UHP_OBJ *hDriver,
+                                 DRV_USB_UHP_HOST_PIPE_OBJ *pipe,
+                                 USB_HOST_IRP_LOCAL *irp)
+{
+    EHCI_PERIODIC_PIPE *periodic = &gEhciPeriodicPipe[pipe->hostEndpoint];
+    EHCIIsoTDDescriptor *iTD;
+    uint32_t payload = pipe->endpointSize & 0x7FFu;
+    uint32_t mult = ((pipe->endpointSize >> 11) & 0x3u) + 1;
+    uint32_t uframeStep = (periodic->interval >= 8) ? 8u : periodic->interval;
+    uint32_t address = (uint32_t)irp->data;
+    uint32_t offset = address & (DRV_USB_UHP_EHCI_QTD_PAGE_SIZE - 1);
+    uint32_t remaining = irp->size;
+    uint32_t frameInterval;
+    uint32_t frame;
+    uint32_t length;
+    uint32_t uframe;
+    uint32_t last = 0;
+    uint32_t index;
+    uint32_t page;
+
+    if ((periodic->interval == 0)
+     || (irp->size > ((8u / uframeStep) * payload * mult))
+     || ((offset + irp->size) > (7u * DRV_USB_UHP_EHCI_QTD_PAGE_SIZE)))
+    {
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nDRV USB_UHP: Isochronous IRP does not fit in a frame");
+        return USB_ERROR_PARAMETER_INVALID;
+    }
+
+    if (periodic->itdCount >= DRV_USB_UHP_EHCI_ITD_NUMBER)
+    {
+        return USB_ERROR_IRP_QUEUE_FULL;
+    }
+
+    frameInterval = ehci_periodic_frame_interval(periodic);
+    frame = ehci_periodic_current_frame(hDriver->usbIDEHCI);
+    if ((periodic->itdCount == 0)
+     || (((periodic->nextFrame - frame) & (DRV_USB_UHP_EHCI_FRAME_LIST_SIZE - 1)) < DRV_USB_UHP_EHCI_ITD_LEAD_FRAMES)
+     || (((periodic->nextFrame - frame) & (DRV_USB_UHP_EHCI_FRAME_LIST_SIZE - 1)) >= (DRV_USB_UHP_EHCI_FRAME_LIST_SIZE / 2)))
+    {
+        /* Restart the stream in the first frame of the pipe after the lead */
+        frame += DRV_USB_UHP_EHCI_ITD_LEAD_FRAMES;
+        frame += ((periodic->phase / 8u) + frameInterval - (frame % frameInterval)) % frameInterval;
+    }
+    else
+    {
+        frame = periodic->nextFrame;
+    }
+    frame &= (DRV_USB_UHP_EHCI_FRAME_LIST_SIZE - 1);
+    periodic->nextFrame = (frame + frameInterval) & (DRV_USB_UHP_EHCI_FRAME_LIST_SIZE - 1);
+
+    index = (periodic->itdHead + periodic->itdCount) % DRV_USB_UHP_EHCI_ITD_NUMBER;
+    iTD = &EHCI_IsoTD[pipe->hostEndpoint][index];
+
+    /* Table 3-4. iTD Buffer Pointer Page 0 to 6 */
+    for (page = 0; page < 7; page++)
+    {
+        iTD->Buffer_Page_Pointer[page] = (address & ~(DRV_USB_UHP_EHCI_QTD_PAGE_SIZE - 1)) + (page * DRV_USB_UHP_EHCI_QTD_PAGE_SIZE);
+    }
+    iTD->Buffer_Page_Pointer[0] |= ((pipe->endpointAndDirection & 0xFu) << 8) | pipe->deviceAddress; /* EndPt, Device Address */
+    iTD->Buffer_Page_Pointer[1] |= (((pipe->endpointAndDirection & 0x80u) != 0) ? (1u << 11) : 0) | payload; /* I/O, Maximum Packet Size */
+    iTD->Buffer_Page_Pointer[2] |= mult; /* Mult */
+
+    /* Table 3-3. iTD Transaction Status and Control */
+    for (uframe = 0; uframe < 8; uframe++)
+    {
+        iTD->Transaction[uframe] = 0;
+    }
+    for (uframe = periodic->phase & 0x7u; uframe < 8; uframe += uframeStep)
+    {
+        length = (remaining > (payload * mult)) ? (payload * mult) : remaining;
+        iTD->Transaction[uframe] = (1u << 31) |        /* Status: Active */
+                                   (length << 16) |    /* Transaction Length */
+                                   (offset & ~(DRV_USB_UHP_EHCI_QTD_PAGE_SIZE - 1)) | /* PG: page select */
+                                   (offset & (DRV_USB_UHP_EHCI_QTD_PAGE_SIZE - 1));   /* Transaction Offset */
+        last = uframe;
+        offset += length;
+        remaining -= length;
+        if (remaining == 0)
+        {
+            break;
+        }
+    }
+    iTD->Transaction[last] |= (1u << 15); /* IOC */
+
+    DCACHE_CLEAN_BY_ADDR((uint32_t *)irp->data, irp->size); /* CLEAN should be called before writing */
+
+    periodic->itd[index].irp = irp;
+    periodic->itd[index].frame = frame;
+    periodic->itdCount++;
+    irp->completedBytes = irp->size;
+    irp->status = USB_HOST_IRP_STATUS_IN_PROGRESS;
+
+    ehci_periodic_frame_update(frame);
+
+    return USB_ERROR_NONE;
+}
+
+/* Function:
+    static bool ehci_itd_complete(DRV_USB_UHP_OBJ *hDriver,
+                                  DRV_USB_UHP_HOST_PIPE_OBJ *pipe,
+                                  bool abort)
+
+   Summary:
+    Complete the isochronous IRPs of a pipe
+
+   Description:
+    Completes the queued iTDs, oldest first, whose transactions are all
+    retired. An iTD whose frame has passed while it is still active was
+    queued too late. Its IRP ends with a data error. If abort is true, all
+    iTDs are removed from the schedule and their IRPs are aborted.
+
+    Returns true if an IRP was completed.
+
+   Remarks:
+    None.
+ */
+static bool ehci_itd_complete(DRV_USB_UHP_OBJ *hDriver,
+                              DRV_USB_UHP_HOST_PIPE_OBJ *pipe,
+                              bool abort)
+{
+    EHCI_PERIODIC_PIPE *periodic = &gEhciPeriodicPipe[pipe->hostEndpoint];
+    EHCIIsoTDDescriptor *iTD;
+    USB_HOST_IRP_LOCAL *irp;
+    uint32_t frame = ehci_periodic_current_frame(hDriver->usbIDEHCI);
+    uint32_t transferred;
+    uint32_t uframe;
+    uint32_t index;
+    uint32_t age;
+    bool active;
+    bool error;
+    bool completed = false;
+
+    while (periodic->itdCount != 0)
+    {
+        index = periodic->itdHead;
+        iTD = &EHCI_IsoTD[pipe->hostEndpoint][index];
+        irp = periodic->itd[index].irp;
+
+        active = false;
+        error = false;
+        transferred = 0;
+        for (uframe = 0; uframe < 8; uframe++)
+        {
+            if ((iTD->Transaction[uframe] & (1u << 31)) != 0)
+            {
+                active = true;
+            }
+            if ((iTD->Transaction[uframe] & (0x7u << 28)) != 0)
+            {
+                /* Data Buffer Error, Babble Detected or Transaction Error */
+                error = true;
+            }
+            transferred += (iTD->Transaction[uframe] >> 16) & 0xFFFu;
+        }
+
+        age = (frame - periodic->itd[index].frame) & (DRV_USB_UHP_EHCI_FRAME_LIST_SIZE - 1);
+        if (active && (abort == false))
+        {
+            if ((age == 0) || (age >= (DRV_USB_UHP_EHCI_FRAME_LIST_SIZE / 2)))
+            {
+                /* The frame of the iTD has not passed yet */
+                break;
+            }
+            /* The host controller has passed the frame without the iTD */
+            error = true;
+        }
+
+        /* Take the iTD out of the frame list before it is cleared */
+        periodic->itd[index].irp = NULL;
+        periodic->itdHead = (periodic->itdHead + 1) % DRV_USB_UHP_EHCI_ITD_NUMBER;
+        periodic->itdCount--;
+        ehci_periodic_frame_update(periodic->itd[index].frame);
+        for (uframe = 0; uframe < 8; uframe++)
+        {
+            iTD->Transaction[uframe] = 0;
+        }
+
+        if (abort)
+        {
+            irp->status = USB_HOST_IRP_STATUS_ABORTED;
+        }
+        else if (error || active)
+        {
+            irp->status = USB_HOST_IRP_STATUS_ERROR_DATA;
+        }
+        else
+        {
+            irp->status = USB_HOST_IRP_STATUS_COMPLETED;
+        }
+
+        if ((pipe->endpointAndDirection & 0x80) != 0)
+        {
+            /* The host controller writes the received length of IN transactions */
+            irp->size = transferred;
+        }
+        DCACHE_INVALIDATE_BY_ADDR((uint32_t *)irp->data, irp->size);
+
+        completed = true;
+        if (irp->callback != NULL)
+        {
+            irp->callback((USB_HOST_IRP *)(uint32_t)irp);
+        }
+    }
+
+    return completed;
+}
+
+/* Function:
+    static uint32_t ehci_interrupt_retire(DRV_USB_UHP_OBJ *hDriver,
+                                          DRV_USB_UHP_HOST_PIPE_OBJ *pipe)
+
+   Summary:
+    Retire the qTD chain of an interrupt pipe
+
+   Description:
+    Returns the number of bytes that the qTD chain of the pipe has transferred
+    and adds the chain to the periodic retired list. The inactive qTD at the
+    end of the queue is not part of the chain and stays with the queue head.
+
+   Remarks:
+    None.
+ */
+static uint32_t ehci_interrupt_retire(DRV_USB_UHP_OBJ *hDriver,
+                                      DRV_USB_UHP_HOST_PIPE_OBJ *pipe)
+{
+    EHCIQueueTDDescriptor *qTD;
+    uint32_t transferred = 0;
+    uint16_t index;
+
+    if (pipe->qtdChainHead == DRV_USB_UHP_EHCI_QTD_INDEX_NONE)
+    {
+        return 0;
+    }
+
+    for (index = pipe->qtdChainHead; ; index = gEhciQtdPool.next[index])
+    {
+        qTD = &EHCI_QtdPool[index];
+        if ((gEhciQtdPool.length[index] != 0) && (qTD->qTD_Token.Status & 0x80) == 0)
+        {
+            /* The host controller has retired this qTD */
+            transferred += gEhciQtdPool.length[index] - qTD->qTD_Token.TotalBytesTF;
+        }
+        if (index == pipe->qtdChainTail)
+        {
+            break;
+        }
+    }
+
+    ehci_periodic_retire(hDriver->usbIDEHCI, pipe->qtdChainHead, pipe->qtdChainTail);
+    pipe->qtdChainHead = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    pipe->qtdChainTail = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+
+    return transferred;
+}
+
+/* Function:
+    static void ehci_interrupt_unlink(DRV_USB_UHP_OBJ *hDriver,
+                                      EHCI_PERIODIC_PIPE *periodic)
+
+   Summary:
+    Take the queue head of an interrupt pipe out of the schedule
+
+   Description:
+    Unlinks the queue head and retires its inactive end qTD. The queue head is
+    put back in the schedule by ehci_periodic_reclaim().
+
+   Remarks:
+    None.
+ */
+static void ehci_interrupt_unlink(DRV_USB_UHP_OBJ *hDriver,
+                                  EHCI_PERIODIC_PIPE *periodic)
+{
+    ehci_periodic_unlink(hDriver->usbIDEHCI, periodic);
+
+    if (periodic->dummy != DRV_USB_UHP_EHCI_QTD_INDEX_NONE)
+    {
+        ehci_periodic_retire(hDriver->usbIDEHCI, periodic->dummy, periodic->dummy);
+        periodic->dummy = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    }
+}
+
+/* Function:
+    static bool ehci_interrupt_relink(uint32_t pipeIndex)
+
+   Summary:
+    Put the queue head of an interrupt pipe in the schedule
+
+   Description:
+    Resets the overlay of the queue head to an inactive end qTD and links the
+    queue head in the tree. The data toggle is kept unless the endpoint has
+    stalled. The queue head must not be in the schedule.
+
+    Returns false if the pool has no free qTD.
+
+   Remarks:
+    None.
+ */
+static bool ehci_interrupt_relink(uint32_t pipeIndex)
+{
+    EHCI_PERIODIC_PIPE *periodic = &gEhciPeriodicPipe[pipeIndex];
+    EHCIQueueHeadDescriptor *queueHead = &EHCI_QueueHead[pipeIndex];
+    uint16_t dummy = ehci_qtd_dummy_get();
+    uint32_t i;
+
+    if (dummy == DRV_USB_UHP_EHCI_QTD_INDEX_NONE)
+    {
+        return false;
+    }
+
+    queueHead->Current_qTD_Pointer = 0;
+    queueHead->Transfer_Overlay[0] = (uint32_t)&EHCI_QtdPool[dummy];
+    queueHead->Transfer_Overlay[1] = DRV_USB_UHP_EHCI_LINK_TERMINATE;
+    queueHead->Transfer_Overlay[2] &= periodic->halted ? 0 : 0x80000000u;
+    for (i = 3; i < 8; i++)
+    {
+        queueHead->Transfer_Overlay[i] = 0;
+    }
+
+    periodic->dummy = dummy;
+    periodic->halted = false;
+    periodic->unlinked = false;
+    ehci_periodic_link();
+
+    return true;
+}
+
+/* Function:
+    static bool ehci_interrupt_start(DRV_USB_UHP_OBJ *hDriver,
+                                     DRV_USB_UHP_HOST_PIPE_OBJ *pipe,
+                                     USB_HOST_IRP_LOCAL *irp)
+
+   Summary:
+    Start an IRP on an interrupt pipe
+
+   Description:
+    The queue head stays in the schedule and its overlay is not written. The
+    qTD chain of the IRP ends with a new inactive qTD. Its first qTD is copied
+    to the inactive qTD at the end of the queue, whose token is written last
+    and makes the chain active. The host controller keeps the data toggle in
+    the overlay, so the toggle of the qTDs is not used.
+
+    Returns false if the pool does not have enough free qTDs or if the queue
+    head is out of the schedule. The IRP is then not started.
+
+   Remarks:
+    None.
+ */
+static bool ehci_interrupt_start(DRV_USB_UHP_OBJ *hDriver,
+                                 DRV_USB_UHP_HOST_PIPE_OBJ *pipe,
+                                 USB_HOST_IRP_LOCAL *irp)
+{
+    EHCI_PERIODIC_PIPE *periodic = &gEhciPeriodicPipe[pipe->hostEndpoint];
+    EHCIQueueTDDescriptor *qTD;
+    EHCIQueueTDDescriptor *qTDDummy;
+    uint32_t PID = ((pipe->endpointAndDirection & 0x80) != 0) ? 1 : 0;
+    uint32_t page;
+    uint8_t DToggle = 0;
+    uint16_t first;
+    uint16_t last;
+    uint16_t end;
+
+    if (periodic->unlinked)
+    {
+        return false;
+    }
+
+    /* Free the retired qTDs if the host controller is idle */
+    ehci_qtd_reclaim(hDriver->usbIDEHCI);
+
+    /* An OUT chain needs an inactive qTD at its end. An IN chain has one. */
+    if ((ehci_qtd_chain_count((uint32_t)irp->data, irp->size, pipe->endpointSize & 0x7FFu, PID) + ((PID == 0) ? 1 : 0))
+        > gEhciQtdPool.freeCount)
+    {
+        return false;
+    }
+
+    DCACHE_CLEAN_BY_ADDR((uint32_t *)irp->data, irp->size); /* CLEAN should be called before writing */
+
+    first = ehci_qtd_chain_build((uint32_t)irp->data, irp->size, pipe->endpointSize & 0x7FFu,
+                                 PID, &DToggle, &end);
+    if (PID == 0)
+    {
+        last = end;
+        end = ehci_qtd_dummy_get();
+        EHCI_QtdPool[last].Next_qTD_Pointer = (uint32_t)&EHCI_QtdPool[end];
+        gEhciQtdPool.next[last] = end;
+    }
+    else
+    {
+        for (last = first; gEhciQtdPool.next[last] != end; last = gEhciQtdPool.next[last])
+        {
+        }
+    }
+
+    qTD = &EHCI_QtdPool[first];
+    qTDDummy = &EHCI_QtdPool[periodic->dummy];
+    qTDDummy->Next_qTD_Pointer = qTD->Next_qTD_Pointer;
+    qTDDummy->Alternate_Next_qTD_Pointer = qTD->Alternate_Next_qTD_Pointer;
+    qTDDummy->qTD_Buffer_Page_Pointer_List = qTD->qTD_Buffer_Page_Pointer_List;
+    for (page = 0; page < 4; page++)
+    {
+        qTDDummy->qTD_Buffer[page] = qTD->qTD_Buffer[page];
+    }
+    gEhciQtdPool.next[periodic->dummy] = gEhciQtdPool.next[first];
+    gEhciQtdPool.length[periodic->dummy] = gEhciQtdPool.length[first];
+    if (last == first)
+    {
+        last = periodic->dummy;
+    }
+
+    /* The token activates the qTD */
+    qTDDummy->qTD_Token.qtdtoken = qTD->qTD_Token.qtdtoken;
+
+    /* The host controller has never seen the first qTD */
+    gEhciQtdPool.next[first] = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    ehci_qtd_list_free(first);
+
+    pipe->qtdChainHead = periodic->dummy;
+    pipe->qtdChainTail = last;
+    periodic->dummy = end;
+
+    irp->completedBytes = irp->size;
+    irp->status = USB_HOST_IRP_STATUS_IN_PROGRESS;
+
+    return true;
+}
+
+/* Function:
+    static bool ehci_interrupt_complete(DRV_USB_UHP_OBJ *hDriver,
+                                        DRV_USB_UHP_HOST_PIPE_OBJ *pipe)
+
+   Summary:
+    Complete the IRP of an interrupt pipe
+
+   Description:
+    The IRP is complete when the last qTD of its chain is retired, when an IN
+    qTD is retired with a short packet or when a qTD is halted. The host
+    controller then waits on the inactive qTD at the end of the queue. The
+    chain is retired and the next queued IRP is started. An IRP that could
+    not be started because the pool was empty is started on a later call.
+
+    A halted qTD means that the endpoint has stalled. The queue head is then
+    taken out of the schedule, and the IRPs that are queued behind the
+    stalled IRP are aborted. ehci_periodic_reclaim() puts the queue head back
+    with DATA0, which the device uses once the client has cleared the halt.
+
+    Returns true if an IRP was completed.
+
+   Remarks:
+    None.
+ */
+static bool ehci_interrupt_complete(DRV_USB_UHP_OBJ *hDriver,
+                                    DRV_USB_UHP_HOST_PIPE_OBJ *pipe)
+{
+    EHCI_PERIODIC_PIPE *periodic = &gEhciPeriodicPipe[pipe->hostEndpoint];
+    USB_HOST_IRP_LOCAL *irp = pipe->irpQueueHead;
+    USB_HOST_IRP_LOCAL *flushed = NULL;
+    EHCIQueueTDDescriptor *qTD;
+    uint32_t transferred;
+    uint16_t index;
+    bool done = true;
+    bool halted = false;
+
+    if ((irp == NULL) || periodic->unlinked)
+    {
+        return false;
+    }
+
+    if (pipe->qtdChainHead == DRV_USB_UHP_EHCI_QTD_INDEX_NONE)
+    {
+        /* The IRP is waiting for free qTDs */
+        (void)ehci_interrupt_start(hDriver, pipe, irp);
+        return false;
+    }
+
+    for (index = pipe->qtdChainHead; index != periodic->dummy; index = gEhciQtdPool.next[index])
+    {
+        qTD = &EHCI_QtdPool[index];
+        if ((qTD->qTD_Token.Status & 0x40) != 0)
+        {
+            halted = true;
+            break;
+        }
+        if ((qTD->qTD_Token.Status & 0x80) != 0)
+        {
+            done = false;
+            break;
+        }
+        if (((pipe->endpointAndDirection & 0x80) != 0) && (qTD->qTD_Token.TotalBytesTF != 0))
+        {
+            /* Short packet */
+            break;
+        }
+    }
+
+    if ((done == false) && (halted == false))
+    {
+        return false;
+    }
+
+    if (halted)
+    {
+        /* The overlay is reset once the queue head is out of the schedule */
+        periodic->halted = true;
+        ehci_interrupt_unlink(hDriver, periodic);
+    }
+
+    transferred = ehci_interrupt_retire(hDriver, pipe);
+    if ((pipe->endpointAndDirection & 0x80) != 0)
+    {
+        irp->size = transferred;
+    }
+    irp->status = halted ? USB_HOST_IRP_STATUS_ERROR_STALL : USB_HOST_IRP_STATUS_COMPLETED;
+    DCACHE_INVALIDATE_BY_ADDR((uint32_t *)irp->data, irp->size);
+
+    pipe->irpQueueHead = irp->next;
+    if (halted)
+    {
+        /* The IRPs that are queued behind the stalled IRP are aborted. The
+         * client submits IRPs again once it has cleared the halt. */
+        flushed = pipe->irpQueueHead;
+        pipe->irpQueueHead = NULL;
+    }
+    else if (pipe->irpQueueHead != NULL)
+    {
+        /* Start the next IRP before the callback can queue another one */
+        pipe->irpQueueHead->previous = NULL;
+        (void)ehci_interrupt_start(hDriver, pipe, pipe->irpQueueHead);
+    }
+
+    if (irp->callback != NULL)
+    {
+        irp->callback((USB_HOST_IRP *)(uint32_t)irp);
+    }
+
+    while (flushed != NULL)
+    {
+        irp = flushed;
+        flushed = irp->next;
+        irp->status = USB_HOST_IRP_STATUS_ABORTED;
+        if (irp->callback != NULL)
+        {
+            irp->callback((USB_HOST_IRP *)(uint32_t)irp);
+        }
+    }
+
+    return true;
+}
+
+/* Function:
+    bool _DRV_USB_UHP_HOST_EhciInterruptIRPCancel(DRV_USB_UHP_OBJ *hDriver,
+                                                  DRV_USB_UHP_HOST_PIPE_OBJ *pipe,
+                                                  USB_HOST_IRP_LOCAL *irp)
+
+   Summary:
+    Stop the IRP in progress on an interrupt pipe
+
+   Description:
+    The host controller may be working on the qTD chain of the IRP. The queue
+    head is taken out of the schedule and the chain is retired. The IRP is
+    marked aborted at once, and its callback is called by
+    ehci_periodic_reclaim() once the host controller has left the queue head.
+    The queue head is then put back in the schedule and the IRP that is at
+    the head of the queue is started. The caller must already have removed
+    the IRP from the queue of the pipe.
+
+    Returns false if the pipe is not an interrupt pipe in the periodic
+    schedule or if the IRP has not been started. The caller then aborts the
+    IRP at once.
+
+   Remarks:
+    Refer to .h for usage information.
+ */
+bool _DRV_USB_UHP_HOST_EhciInterruptIRPCancel(DRV_USB_UHP_OBJ *hDriver,
+                                              DRV_USB_UHP_HOST_PIPE_OBJ *pipe,
+                                              USB_HOST_IRP_LOCAL *irp)
+{
+    EHCI_PERIODIC_PIPE *periodic = &gEhciPeriodicPipe[pipe->hostEndpoint];
+
+    if ((periodic->interval == 0) || periodic->isochronous || periodic->unlinked
+     || (pipe->qtdChainHead == DRV_USB_UHP_EHCI_QTD_INDEX_NONE))
+    {
+        return false;
+    }
+
+    ehci_interrupt_unlink(hDriver, periodic);
+    (void)ehci_interrupt_retire(hDriver, pipe);
+
+    irp->status = USB_HOST_IRP_STATUS_ABORTED;
+    periodic->cancelled = irp;
+
+    return true;
+}
+
+/* Function:
+    static void ehci_periodic_reclaim(DRV_USB_UHP_OBJ *hDriver)
+
+   Summary:
+    Free what the host controller has left in the periodic schedule
+
+   Description:
+    Frees the periodic retired list and puts the queue heads of the interrupt
+    pipes back in the schedule once their frame has passed. The callback of an
+    IRP that was cancelled in progress is then called, and the IRP at the head
+    of the queue is started. A queue head for which the pool has no inactive
+    qTD is put back on a later call.
+
+   Remarks:
+    None.
+ */
+static void ehci_periodic_reclaim(DRV_USB_UHP_OBJ *hDriver)
+{
+    volatile uhphs_registers_t *usbIDEHCI = hDriver->usbIDEHCI;
+    EHCI_PERIODIC_PIPE *periodic;
+    DRV_USB_UHP_HOST_PIPE_OBJ *pipe;
+    USB_HOST_IRP_LOCAL *irp;
+    uint32_t pipeIndex;
+
+    if ((gEhciQtdPool.periodicHead != DRV_USB_UHP_EHCI_QTD_INDEX_NONE)
+     && ehci_periodic_frame_passed(usbIDEHCI, gEhciQtdPool.periodicFrame))
+    {
+        ehci_qtd_list_free(gEhciQtdPool.periodicHead);
+        gEhciQtdPool.periodicHead = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    }
+
+    for (pipeIndex = 1; pipeIndex < DRV_USB_UHP_PIPES_NUMBER; pipeIndex++)
+    {
+        periodic = &gEhciPeriodicPipe[pipeIndex];
+        if ((periodic->unlinked == false)
+         || (ehci_periodic_frame_passed(usbIDEHCI, periodic->unlinkFrame) == false))
+        {
+            continue;
+        }
+
+        if ((periodic->interval == 0) || periodic->isochronous)
+        {
+            /* The pipe was closed */
+            periodic->unlinked = false;
+        }
+        else if (ehci_interrupt_relink(pipeIndex) == false)
+        {
+            continue;
+        }
+
+        irp = periodic->cancelled;
+        periodic->cancelled = NULL;
+        if ((irp != NULL) && (irp->callback != NULL))
+        {
+            irp->callback((USB_HOST_IRP *)(uint32_t)irp);
+        }
+
+        pipe = hDriver->hostEndpointTable[pipeIndex].endpoint.pipe;
+        if ((periodic->unlinked == false) && (periodic->interval != 0) && (periodic->isochronous == false)
+         && (pipe != NULL) && (pipe->irpQueueHead != NULL)
+         && (pipe->qtdChainHead == DRV_USB_UHP_EHCI_QTD_INDEX_NONE))
+        {
+            pipe->irpQueueHead->previous = NULL;
+            (void)ehci_interrupt_start(hDriver, pipe, pipe->irpQueueHead);
+        }
+    }
+}
+
+/* Function:
+    static void ehci_periodic_tasks(DRV_USB_UHP_OBJ *hDriver)
+
+   Summary:
+    Complete the periodic IRPs
+
+   Description:
+    Called on the USB interrupt and on the USB error interrupt. Completes the
+    IRPs of the periodic pipes and frees what the host controller has left in
+    the periodic schedule.
+
+   Remarks:
+    None.
+ */
+static void ehci_periodic_tasks(DRV_USB_UHP_OBJ *hDriver)
+{
+    DRV_USB_UHP_HOST_PIPE_OBJ *pipe;
+    uint32_t pipeIndex;
+
+    ehci_periodic_reclaim(hDriver);
+
+    for (pipeIndex = 1; pipeIndex < DRV_USB_UHP_PIPES_NUMBER; pipeIndex++)
+    {
+        pipe = hDriver->hostEndpointTable[pipeIndex].endpoint.pipe;
+        if ((gEhciPeriodicPipe[pipeIndex].interval == 0)
+         || (hDriver->hostEndpointTable[pipeIndex].endpoint.inUse == false)
+         || (pipe == NULL))
+        {
+            continue;
+        }
+
+        if (gEhciPeriodicPipe[pipeIndex].isochronous)
+        {
+            (void)ehci_itd_complete(hDriver, pipe, false);
+        }
+        else
+        {
+            (void)ehci_interrupt_complete(hDriver, pipe);
+        }
+    }
+}
+
+/* Function:
+    void _DRV_USB_UHP_HOST_EhciPeriodicTasks(DRV_USB_UHP_OBJ *hDriver)
+
    Summary:
-    Create Queue Head
+    Put back the periodic pipes that have left the schedule
 
    Description:
-    Fill Queue Head
+    Called from the driver tasks. The host controller does not interrupt when
+    a frame has passed, so a queue head that was taken out of the schedule
+    with no other transfer running is put back here.
 
    Remarks:
     Refer to .h for usage information.
  */
-static void ehci_create_queue_head(EHCIQueueHeadDescriptor *qh_base_addr,
-                                   EHCIQueueHeadDescriptor *qh_link_pointer,
-                                   uint32_t              terminate,
-                                   uint32_t              EP_number,
-                                   uint32_t              DeviceAddr,
-                                   EHCIQueueTDDescriptor *next_qTD_pointer,
-                                   uint32_t              mult,
-                                   uint32_t              smask,
-                                   uint32_t              dtc,
-                                   uint32_t              typ,
-                                   uint32_t              hubAddress,
-                                   uint32_t              hubPortAddress)
+void _DRV_USB_UHP_HOST_EhciPeriodicTasks(DRV_USB_UHP_OBJ *hDriver)
 {
-    EHCIQueueHeadDescriptor *QueueHead = (EHCIQueueHeadDescriptor *)qh_base_addr;
+    bool interruptWasEnabled;
+    bool pending = (gEhciQtdPool.periodicHead != DRV_USB_UHP_EHCI_QTD_INDEX_NONE);
+    uint32_t pipeIndex;
 
-    /* Queue Head Horizontal Link Pointer
-     * see: 3.6 Queue Head
-     * Table 3-18. Queue Head DWord 0 */
-    QueueHead->Horizontal_Link_Pointer =
-        (uint32_t)qh_link_pointer |        /* QHLP: Queue Head Horizontal Link Pointer: bit[31:5] */
-        (typ << 1) |                       /* Typ: QH/(s)iTD/FSTN: Data structure type = 01b QH (queue head) */
-        (terminate << 0);                  /* T: Terminate = 1 : last transfer */
+    for (pipeIndex = 1; pipeIndex < DRV_USB_UHP_PIPES_NUMBER; pipeIndex++)
+    {
+        pending |= gEhciPeriodicPipe[pipeIndex].unlinked;
+    }
 
-    /* Table 3-19. Endpoint Characteristics: Queue Head DWord 1 */
-    QueueHead->Endpoint_Characteristics =
-        (0 << 28) |                      /* RL: Nak Count Reload */
-        (0 << 27) |                      /* C: Control Endpoint Flag */
-        (512 << 16) |                    /* Maximum Packet Length   1024 or 512 */
-        (1 << 15) |                      /* H: Head of Reclamation List Flag */  // This bit is set to mark the QH as the head of the asynchronous schedule.
-         //   This bit is cleared since this bit is not used for the periodic schedule.
-        (dtc << 14) |                    /* DTC: Data Toggle Control: 1: from qTD, 0: from QH (automatic) */
-        (2 << 12) |                      /* EPS: Endpoint Speed = 10b High-Speed (480 Mb/s) */
-        (EP_number <<  8) |              /* Endpt: Endpoint Number */
-        (0 << 7) |                       /* I: Inactivate on Next Transaction (Periodic Schedule Full or Low-speed)*/ 
-        (DeviceAddr <<  0);              /* Device Address */
+    if (pending == false)
+    {
+        return;
+    }
 
-    /* Table 3-20. Endpoint Capabilities: Queue Head DWord 2 */
-    QueueHead->Endpoint_Capabilities =
-        (mult << 30) |                     /* Mult: High-Bandwidth Pipe Multiplier = 3 transactions to
-                                            * be issued for this endpoint per micro-frame */
-        (hubPortAddress << 23) |           /* Port Number */
-        (hubAddress << 16) |               /* Hub Addr (full or low-speed device) */
-        (0 <<  8) |                        /* Frame C-Mask: Split Completion Mask (low- or full-speed device) */
-        (smask <<  0);                     /* Frame S-mask: Interrupt Schedule Mask */
+    /* OSAL: Get Mutex */
+    if (OSAL_MUTEX_Lock(&hDriver->mutexID, OSAL_WAIT_FOREVER) != OSAL_RESULT_TRUE)
+    {
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nDRV USB_UHP: Mutex lock failed");
+        return;
+    }
+    interruptWasEnabled = _DRV_USB_UHP_InterruptSourceDisable(hDriver->interruptSource);
 
-    /* 3.6.3 Transfer Overlay */
-    QueueHead->Transfer_Overlay[0] = (uint32_t)next_qTD_pointer; /* Next qTD Pointer: DWord 4 */
-    // nothing   QueueHead->Transfer_Overlay[1] = 0x01; 
+    /* The IRP callbacks can submit IRPs. The driver is already locked, as it
+     * is in the interrupt context. */
+    hDriver->isInInterruptContext = true;
+    ehci_periodic_reclaim(hDriver);
+    hDriver->isInInterruptContext = false;
+
+    if (interruptWasEnabled)
+    {
+        _DRV_USB_UHP_InterruptSourceEnable(hDriver->interruptSource);
+    }
+    /* OSAL: Release Mutex */
+    if (OSAL_MUTEX_Unlock(&hDriver->mutexID) != OSAL_RESULT_TRUE)
+    {
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nDRV USB_UHP: Mutex unlock failed");
+    }
 }
 
 /* Function:
-    void ehci_received_size( uint32_t * BuffSize )
+    bool _DRV_USB_UHP_HOST_EhciQueueHeadIsFree(uint32_t hostEndpoint)
 
    Summary:
-    Change the received size if needed
+    Check if the queue head of a host endpoint can be used
 
    Description:
-    Change the received size if the requesting data number have not been sent
+    Returns false while the host controller may still reference the queue
+    head or the iTDs of a closed periodic pipe.
 
    Remarks:
     Refer to .h for usage information.
  */
-void ehci_received_size( uint32_t * BuffSize )
+bool _DRV_USB_UHP_HOST_EhciQueueHeadIsFree(uint32_t hostEndpoint)
 {
-    /* If Total Bytes to Transfer == 0, all data has been receive */
-    if( EHCI_QueueTD[0][1].qTD_Token.TotalBytesTF != 0 )
+    return (gEhciPeriodicPipe[hostEndpoint].unlinked == false);
+}
+
+/* Function:
+    static bool ehci_async_transfer_is_done(DRV_USB_UHP_OBJ *hDriver)
+
+   Summary:
+    Check if the transfer on the asynchronous schedule has ended
+
+   Description:
+    The transfer has ended when the queue head of the current pipe has no
+    active transaction and no active qTD to fetch.
+
+   Remarks:
+    None.
+ */
+static bool ehci_async_transfer_is_done(DRV_USB_UHP_OBJ *hDriver)
+{
+    EHCIQueueHeadDescriptor *queueHead = &EHCI_QueueHead[hDriver->hostPipeInUse];
+    EHCIQueueTDDescriptor *qTD;
+
+    if (hDriver->controlTransferGroup.currentIRP == NULL)
     {
-        *BuffSize -= EHCI_QueueTD[0][1].qTD_Token.TotalBytesTF;
+        return false;
+    }
+
+    if ((queueHead->Transfer_Overlay[2] & 0x80) != 0)
+    {
+        return false;
+    }
+
+    if ((queueHead->Transfer_Overlay[0] & DRV_USB_UHP_EHCI_LINK_TERMINATE) == 0)
+    {
+        qTD = (EHCIQueueTDDescriptor *)(queueHead->Transfer_Overlay[0] & ~0x1Fu);
+        if ((qTD->qTD_Token.Status & 0x80) != 0)
+        {
+            return false;
+        }
     }
+
+    return true;
 }
 
 /* Function:
-    static void ehci_create_qTD(EHCIQueueTDDescriptor *qTD_base_addr,
-                                EHCIQueueTDDescriptor *next_qTD_base_addr,
-                                uint32_t terminate, 
-                                uint32_t PID,
-                                uint32_t data_toggle,
-                                uint32_t nb_bytes,
-                                uint32_t int_on_complete,
-                                uint32_t *buffer_base_addr)
+    static bool ehci_async_transfer_is_halted(DRV_USB_UHP_OBJ *hDriver)
 
    Summary:
-    Create Transfer Descriptor
+    Check if the transfer on the asynchronous schedule has failed
 
    Description:
-    Fill Transfer Descriptor
+    The transfer has failed when the overlay of the queue head of the current
+    pipe has the Halted bit set.
+
+   Remarks:
+    None.
+ */
+static bool ehci_async_transfer_is_halted(DRV_USB_UHP_OBJ *hDriver)
+{
+    if (hDriver->controlTransferGroup.currentIRP == NULL)
+    {
+        return false;
+    }
+
+    return ((EHCI_QueueHead[hDriver->hostPipeInUse].Transfer_Overlay[2] & 0x40) != 0);
+}
+
+/* Function:
+    bool _DRV_USB_UHP_HOST_EhciPeriodicPipeOpen(DRV_USB_UHP_OBJ *hDriver,
+                                                DRV_USB_UHP_HOST_PIPE_OBJ *pipe)
+
+   Summary:
+    Add an interrupt or isochronous pipe to the periodic schedule
+
+   Description:
+    Reserves the bus time of the pipe. An interrupt pipe gets an idle queue
+    head in the tree with the S-mask of its microframes, which waits on an
+    inactive qTD. The host controller keeps the data toggle in the queue head.
+    An isochronous pipe gets an empty iTD ring. The periodic schedule is
+    enabled with the first pipe.
+
+    Returns false if the periodic bus time or the qTD pool is exhausted.
 
    Remarks:
     Refer to .h for usage information.
  */
-static void ehci_create_qTD(EHCIQueueTDDescriptor *qTD_base_addr,
-                            EHCIQueueTDDescriptor *next_qTD_base_addr,
-                            uint32_t terminate, 
-                            uint32_t PID,
-                            uint32_t data_toggle,
-                            uint32_t nb_bytes,
-                            uint32_t int_on_complete,
-                            uint32_t *buffer_base_addr)
+bool _DRV_USB_UHP_HOST_EhciPeriodicPipeOpen(DRV_USB_UHP_OBJ *hDriver,
+                                            DRV_USB_UHP_HOST_PIPE_OBJ *pipe)
 {
-    EHCIQueueTDDescriptor *qTD = (EHCIQueueTDDescriptor *)qTD_base_addr;
+    EHCI_PERIODIC_PIPE *periodic = &gEhciPeriodicPipe[pipe->hostEndpoint];
+    EHCIQueueHeadDescriptor *queueHead = &EHCI_QueueHead[pipe->hostEndpoint];
+    volatile uhphs_registers_t *usbIDEHCI = hDriver->usbIDEHCI;
+    bool isochronous = (pipe->pipeType == USB_TRANSFER_TYPE_ISOCHRONOUS);
+    uint32_t i;
 
-    /* 3.5.1 Next qTD Pointer */
-    /* Table 3-14. qTD Next Element Transfer Pointer (DWord 0) */
-    qTD->Next_qTD_Pointer = (uint32_t)next_qTD_base_addr |  /* Next qTD Pointer */
-                            terminate;                      /* Terminate */
+    ehci_periodic_release(periodic);
 
-    /* 3.5.2 Alternate Next qTD Pointer */
-    /* Table 3-15. qTD Alternate Next Element Transfer Pointer (DWord 1) */
-    qTD->Alternate_Next_qTD_Pointer = 0x1; /* No Alternate, Terminate */
+    if (ehci_periodic_reserve(periodic,
+                              ehci_periodic_interval(pipe->speed, pipe->pipeType, pipe->bInterval),
+                              ehci_periodic_load(pipe->endpointSize, isochronous)) == false)
+    {
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nDRV USB_UHP: Not enough periodic bandwidth");
+        return false;
+    }
 
-    /* 3.5.3 qTD Token */
-    /* Table 3-16. qTD Token (DWord 2) */
-    qTD->qTD_Token.qtdtoken = (data_toggle << 31) |     /* Data Toggle */
-                              (nb_bytes << 16) |        /* Total Bytes to Transfer */
-                              (int_on_complete << 15) | /* Interrupt On Complete (IOC) */
-                              (0 << 12) |               /* Current Page (C_Page) */
-                              (3 << 10) |               /* Error Counter (CERR)   Allow 3 retry */
-                              (PID <<  8) |             /* PID Code (0: OUT, 1: IN 2: SETUP) */
-                              (1 << 7);                 /* Status Field Description: Active. */
+    periodic->isochronous = isochronous;
+    periodic->itdHead = 0;
+    periodic->itdCount = 0;
+    periodic->nextFrame = 0;
+    periodic->dummy = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+    periodic->halted = true;
+    periodic->cancelled = NULL;
+    for (i = 0; i < DRV_USB_UHP_EHCI_ITD_NUMBER; i++)
+    {
+        periodic->itd[i].irp = NULL;
+    }
 
-    /* 3.5.4 qTD Buffer Page Pointer List */
-    /* Table 3-17. qTD Buffer Pointer(s) (DWords 3-7) */
-    qTD->qTD_Buffer_Page_Pointer_List = (uint32_t)buffer_base_addr;    /* Buffer Pointer List : 4k page aligned (Bit 31:12) */
+    if (isochronous == false)
+    {
+        ehci_create_queue_head(queueHead,                  /* Queue Head base address */
+                               NULL,                       /* Queue Head Link Pointer: set by ehci_periodic_link() */
+                               1,                          /* Terminate */
+                               pipe->endpointAndDirection & 0xF, /* EndPt: Endpoint number */
+                               pipe->deviceAddress,        /* Device Address */
+                               NULL,                       /* Next qTD Pointer: set on IRP submit */
+                               ((pipe->endpointSize >> 11) & 0x3u) + 1, /* Mult: transactions per microframe */
+                               ehci_periodic_smask(periodic), /* uFrame S-mask */
+                               0,                          /* DTC: data toggle kept in the queue head */
+                               1,                          /* Typ: 01b QH (queue head) */
+                               pipe->hubAddress,           /* Hub Addr */
+                               pipe->hubPort);             /* Port Number */
+
+        /* Maximum Packet Length of the endpoint. H is not used in the periodic schedule. */
+        queueHead->Endpoint_Characteristics = (queueHead->Endpoint_Characteristics & ~((0x7FFu << 16) | (1u << 15)))
+                                            | ((pipe->endpointSize & 0x7FFu) << 16);
+
+        /* Free the retired qTDs if the host controller is idle */
+        ehci_qtd_reclaim(usbIDEHCI);
+
+        if (ehci_interrupt_relink(pipe->hostEndpoint) == false)
+        {
+            SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nDRV USB_UHP: qTD pool is empty");
+            ehci_periodic_release(periodic);
+            return false;
+        }
+    }
+    else
+    {
+        ehci_periodic_link();
+    }
+
+    /* Periodic Frame List Base Address */
+    usbIDEHCI->UHPHS_PERIODICLISTBASE = (uint32_t)&PeriodicFrameList[0];
+
+    /* Periodic Schedule Enable: Use the PERIODICLISTBASE register to access the Periodic Schedule. */
+    usbIDEHCI->UHPHS_USBCMD |= UHPHS_USBCMD_PSE_Msk;
+
+    return true;
+}
+
+/* Function:
+    void _DRV_USB_UHP_HOST_EhciPeriodicPipeClose(DRV_USB_UHP_OBJ *hDriver,
+                                                 DRV_USB_UHP_HOST_PIPE_OBJ *pipe)
+
+   Summary:
+    Remove a pipe from the periodic schedule
+
+   Description:
+    Aborts the queued isochronous IRPs, takes the queue head of an interrupt
+    pipe out of the tree and releases the bus time of the pipe. The IRP in
+    progress on an interrupt pipe is taken off the queue and aborted once the
+    host controller has left the queue head. Until then, the queue head and
+    the iTDs of the pipe are not used again.
+
+   Remarks:
+    Refer to .h for usage information.
+ */
+void _DRV_USB_UHP_HOST_EhciPeriodicPipeClose(DRV_USB_UHP_OBJ *hDriver,
+                                             DRV_USB_UHP_HOST_PIPE_OBJ *pipe)
+{
+    EHCI_PERIODIC_PIPE *periodic = &gEhciPeriodicPipe[pipe->hostEndpoint];
+    USB_HOST_IRP_LOCAL *irp = pipe->irpQueueHead;
+
+    if (periodic->interval == 0)
+    {
+        return;
+    }
+
+    if (periodic->isochronous)
+    {
+        (void)ehci_itd_complete(hDriver, pipe, true);
+        ehci_periodic_release(periodic);
+        ehci_periodic_unlink(hDriver->usbIDEHCI, periodic);
+    }
+    else
+    {
+        ehci_periodic_release(periodic);
+        ehci_interrupt_unlink(hDriver, periodic);
+        if (pipe->qtdChainHead != DRV_USB_UHP_EHCI_QTD_INDEX_NONE)
+        {
+            (void)ehci_interrupt_retire(hDriver, pipe);
+            if (irp != NULL)
+            {
+                pipe->irpQueueHead = irp->next;
+                irp->pipe = DRV_USB_UHP_HOST_PIPE_HANDLE_INVALID;
+                irp->status = USB_HOST_IRP_STATUS_ABORTED;
+                periodic->cancelled = irp;
+            }
+        }
+    }
 }
 
 /* Function:
@@ -449,6 +2450,8 @@ void _DRV_USB_UHP_HOST_EhciInit(DRV_USB_UHP_OBJ *drvObj)
     
     memset(EHCI_QueueHead, 0, sizeof(EHCI_QueueHead));
     memset(EHCI_QueueTD, 0, sizeof(EHCI_QueueTD));
+    ehci_qtd_pool_init();
+    ehci_periodic_init();
 
     /* Host Controller Reset (HCRESET) */
     /* When software writes a one to this bit, the Host Controller resets its internal pipelines,
@@ -572,6 +2575,7 @@ USB_ERROR DRV_USB_UHP_HOST_IRPSubmitEhci
     uint8_t DToggle = 0;
     uint8_t OnComplete;
     uint8_t IntOnComplete;
+    uint32_t PID;
     USB_ERROR returnValue = USB_ERROR_PARAMETER_INVALID;
     uint32_t i;
     volatile uhphs_registers_t *usbIDEHCI;
@@ -616,7 +2620,12 @@ USB_ERROR DRV_USB_UHP_HOST_IRPSubmitEhci
             irp->completedBytes = 0;
             irp->status = USB_HOST_IRP_STATUS_PENDING;
 
-            if (pipe->irpQueueHead == NULL)
+            if (pipe->pipeType == USB_TRANSFER_TYPE_ISOCHRONOUS)
+            {
+                /* Isochronous IRPs are queued in the iTD ring of the pipe */
+                returnValue = ehci_itd_submit(hDriver, pipe, irp);
+            }
+            else if (pipe->irpQueueHead == NULL)
             {
                 /* This means that there are no IRPs on this pipe. We can add
                  * this IRP directly */
@@ -651,7 +2660,7 @@ USB_ERROR DRV_USB_UHP_HOST_IRPSubmitEhci
                     /* We need to check if the endpoint 0 is free and if so
                      * then start processing the IRP */
                 }
-                if (controlTransferGroup->currentIRP == NULL)
+                if ((controlTransferGroup->currentIRP == NULL) && (pipe->pipeType != USB_TRANSFER_TYPE_INTERRUPT))
                 {
                     /* This means that no IRPs are being processed
                      * So we should start the IRP processing. Else
@@ -809,6 +2818,97 @@ USB_ERROR DRV_USB_UHP_HOST_IRPSubmitEhci
                                            pipe->hubPort);      /* Port Number */
 
                 } /* End SETUP Transaction */
+                else if (pipe->pipeType == USB_TRANSFER_TYPE_INTERRUPT)
+                {
+                    /* The interrupt IRP is started in the periodic schedule.
+                     * The queued IRPs are started when it completes. */
+                    if (gEhciPeriodicPipe[pipe->hostEndpoint].unlinked)
+                    {
+                        /* The IRP is started when the queue head is back in
+                         * the schedule */
+                    }
+                    else if (ehci_interrupt_start(hDriver, pipe, irp) == false)
+                    {
+                        /* Not enough free qTDs. The IRP is not queued. */
+                        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nDRV USB_UHP: qTD pool is empty");
+                        pipe->irpQueueHead = NULL;
+                        irp->status = USB_HOST_IRP_STATUS_ERROR_UNKNOWN;
+                        returnValue = USB_ERROR_IRP_QUEUE_FULL;
+                    }
+                }
+                else if (pipe->pipeType == USB_TRANSFER_TYPE_BULK)
+                {
+                    /* Bulk transfers use a chain of qTDs from the shared pool.
+                     * Each qTD transfers up to 20 KB, so the IRP is not split
+                     * into more transfers. */
+                    if ((pipe->endpointAndDirection & 0x80) == 0)
+                    {
+                        /* Host to Device: OUT */
+                        PID = 0;
+                        DToggle = hDriver->staticDToggleOut & 0x1;
+                    }
+                    else
+                    {
+                        /* Device to Host: IN */
+                        PID = 1;
+                        DToggle = hDriver->staticDToggleIn & 0x1;
+                    }
+
+                    /* Free the retired qTDs if the host controller is idle */
+                    ehci_qtd_reclaim(hDriver->usbIDEHCI);
+
+                    if (ehci_qtd_chain_count((uint32_t)irp->data, irp->size, pipe->endpointSize & 0x7FFu, PID) > gEhciQtdPool.freeCount)
+                    {
+                        /* Not enough free qTDs. The IRP is not queued. */
+                        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nDRV USB_UHP: qTD pool is empty");
+                        pipe->irpQueueHead = NULL;
+                        if (controlTransferGroup->currentIRP == irp)
+                        {
+                            controlTransferGroup->currentIRP  = NULL;
+                            controlTransferGroup->currentPipe = NULL;
+                        }
+                        irp->status = USB_HOST_IRP_STATUS_ERROR_UNKNOWN;
+                        returnValue = USB_ERROR_IRP_QUEUE_FULL;
+                    }
+                    else
+                    {
+                        DCACHE_CLEAN_BY_ADDR((uint32_t *)irp->data, irp->size); /* CLEAN should be called before writing */
+
+                        pipe->qtdChainHead = ehci_qtd_chain_build((uint32_t)irp->data, irp->size, pipe->endpointSize & 0x7FFu,
+                                                                  PID, &DToggle, &pipe->qtdChainTail);
+                        irp->completedBytes = irp->size;
+
+                        /* Data toggle after the transfer. It is corrected
+                         * from the qTDs when the transfer ends short. */
+                        if (PID == 0)
+                        {
+                            hDriver->staticDToggleOut = DToggle;
+                        }
+                        else
+                        {
+                            hDriver->staticDToggleIn = DToggle;
+                        }
+
+                        /* Create Queue Head for the command: */
+                        ehci_create_queue_head(&EHCI_QueueHead[pipe->hostEndpoint],     /* Queue Head base address */
+                                               &EHCI_QueueHead[pipe->hostEndpoint],     /* Queue Head Link Pointer */
+                                               0,                      /* Terminate */
+                                       pipe->endpointAndDirection&0xF, /* EndPt: Endpoint number */
+                                               pipe->deviceAddress,    /* Device Address */
+                                               &EHCI_QtdPool[pipe->qtdChainHead], /* Next qTD Pointer */
+                                               1,                      /* Mult: High-Bandwidth Pipe Multiplier */
+                                               0,                      /* uFrame S-mask: not an interrupt endpoint */
+                                               1,                      /* DTC: Initial data toggle comes from incoming qTD DT bit */
+                                               1,                      /* Typ: 01b QH (queue head) */
+                                               pipe->hubAddress,       /* Hub Addr */
+                                               pipe->hubPort);         /* Port Number */
+
+                        /* The overlay of the previous transfer must not make
+                         * the host controller follow a retired qTD */
+                        EHCI_QueueHead[pipe->hostEndpoint].Transfer_Overlay[1] = 0x1; /* Alternate Next qTD Pointer: Terminate */
+                        EHCI_QueueHead[pipe->hostEndpoint].Transfer_Overlay[2] = 0;   /* qTD Token: not active, not halted */
+                    }
+                }
                 else
                 {
                     /* For non control transfers, if this is the first
@@ -976,34 +3076,15 @@ USB_ERROR DRV_USB_UHP_HOST_IRPSubmitEhci
 
                 usbIDEHCI = hDriver->usbIDEHCI;
 
-                if( pipe->pipeType == USB_TRANSFER_TYPE_INTERRUPT )
+                if (returnValue == USB_ERROR_IRP_QUEUE_FULL)
+                {
+                    /* The IRP could not be started */
+                }
+                else if( pipe->pipeType == USB_TRANSFER_TYPE_INTERRUPT )
                 {
+                    /* The queue head was linked in the periodic schedule
+                     * when the pipe was opened */
                     hDriver->hostPipeInterrupt = pipe->hostEndpoint;
-
-//                    printf("\n\r SUB hostPipeInterrupt = %d", hDriver->hostPipeInterrupt);
-                    
-//                    printf("\n\r sizeof(PeriodicFrameList) = %d", sizeof(PeriodicFrameList));
-//                    printf("\n\r HCCPARAMS = 0x%X", usbIDEHCI->UHPHS_HCCPARAMS);
-//                    for( uint32_t i=0; i<sizeof(PeriodicFrameList)/4; i++ )  //  4096 bytes, 1024 elements
-//                    for( uint32_t i=0; i<1024; i++ )
-//                    {
-//                        /* Frame list size is 1024 */
-//                        if( (pipe->endpointAndDirection & 0x80) == 0 )
-//                        {
-//                            /* Host to Device: OUT */
-//                            PeriodicFrameList[i] = (uint32_t)&EHCI_QueueHead[pipe->hostEndpoint];
-//                        }
-//                        else
-//                        {
-//                            /* Host to Device: IN */
-                            PeriodicFrameList[0] = (uint32_t)EHCI_QueueHead[pipe->hostEndpoint].Horizontal_Link_Pointer;
-//                        }
-//                    }
-                    /* Periodic Frame List Base Address */
-                    usbIDEHCI->UHPHS_PERIODICLISTBASE = (uint32_t)&PeriodicFrameList[0];
-
-                    /* Periodic Schedule Enable: Use the PERIODICLISTBASE register to access the Periodic Schedule. */
-                    usbIDEHCI->UHPHS_USBCMD |= UHPHS_USBCMD_PSE_Msk;
                 }
                 else if( pipe->pipeType == USB_TRANSFER_TYPE_ISOCHRONOUS )
                 {
@@ -1044,8 +3125,11 @@ USB_ERROR DRV_USB_UHP_HOST_IRPSubmitEhci
                     usbIDEHCI->UHPHS_USBCMD |= UHPHS_USBCMD_ASE_Msk;
                 }
 
-                irp->status = USB_HOST_IRP_STATUS_IN_PROGRESS;
-                returnValue = USB_ERROR_NONE;
+                if (returnValue != USB_ERROR_IRP_QUEUE_FULL)
+                {
+                    irp->status = USB_HOST_IRP_STATUS_IN_PROGRESS;
+                    returnValue = USB_ERROR_NONE;
+                }
             }
             else
             {
@@ -1151,6 +3235,13 @@ void _DRV_USB_UHP_HOST_Tasks_ISR_EHCI(DRV_USB_UHP_OBJ *hDriver)
             transferGroup->int_on_async_advance = 1;
             SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\n\rEHCI interrupt on async advance");
             usbIDEHCI->UHPHS_USBSTS = UHPHS_USBSTS_IAA_Msk;
+
+            /* The host controller no longer caches the qTDs that were
+             * retired before the doorbell was rung */
+            ehci_qtd_list_free(gEhciQtdPool.doorbellHead);
+            gEhciQtdPool.doorbellHead = DRV_USB_UHP_EHCI_QTD_INDEX_NONE;
+            gEhciQtdPool.doorbellPending = false;
+            ehci_qtd_doorbell(usbIDEHCI);
         }
 
         /* Host system error */
@@ -1243,7 +3334,15 @@ void _DRV_USB_UHP_HOST_Tasks_ISR_EHCI(DRV_USB_UHP_OBJ *hDriver)
         if ((isr_read_data & UHPHS_USBSTS_USBINT_Msk) == UHPHS_USBSTS_USBINT_Msk)
         {
             usbIDEHCI->UHPHS_USBSTS = UHPHS_USBSTS_USBINT_Msk; /* clear by writing "1" */
-            hDriver->intXfrQtdComplete = 1;
+
+            /* Periodic transfers are completed here. The transfer on the
+             * asynchronous schedule is completed by the transfer process
+             * once its queue head has no active qTD left. */
+            ehci_periodic_tasks(hDriver);
+            if (ehci_async_transfer_is_done(hDriver))
+            {
+                hDriver->intXfrQtdComplete = 1;
+            }
         }
         /* USB error */
         if ((isr_read_data & UHPHS_USBSTS_USBERRINT_Msk) == UHPHS_USBSTS_USBERRINT_Msk)
@@ -1251,9 +3350,16 @@ void _DRV_USB_UHP_HOST_Tasks_ISR_EHCI(DRV_USB_UHP_OBJ *hDriver)
             SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\033[31m\n\rEHCI IRQ : USB error interrupt\033[0m");
             /* Clear It */
             usbIDEHCI->UHPHS_USBSTS = UHPHS_USBSTS_USBERRINT_Msk;
-            _DRV_USB_UHP_HOST_EHCITESTTD();
-            usbIDEHCI->UHPHS_USBCMD &= ~UHPHS_USBCMD_ASE_Msk;
-            hDriver->intXfrQtdComplete = 0xFF;
+
+            /* The error can come from a periodic pipe. The transfer on the
+             * asynchronous schedule only fails if its queue head is halted. */
+            ehci_periodic_tasks(hDriver);
+            if (ehci_async_transfer_is_halted(hDriver))
+            {
+                _DRV_USB_UHP_HOST_EHCITESTTD();
+                usbIDEHCI->UHPHS_USBCMD &= ~UHPHS_USBCMD_ASE_Msk;
+                hDriver->intXfrQtdComplete = 0xFF;
+            }
         }
     }
 }/* end of _DRV_USB_UHP_HOST_Tasks_ISR_EHCI() */
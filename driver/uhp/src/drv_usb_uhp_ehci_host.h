@@ -53,6 +53,23 @@
 #define UHP_EHCI_RAM_ADDR                            0xA0100000u
 #endif
 
+/* Number of qTDs in the pool that is shared by the bulk pipes */
+#ifndef DRV_USB_UHP_EHCI_QTD_NUMBER
+#define DRV_USB_UHP_EHCI_QTD_NUMBER                  32
+#endif
+
+/* Pool index that terminates a qTD chain */
+#define DRV_USB_UHP_EHCI_QTD_INDEX_NONE              0xFFFFu
+
+/* Frames of the periodic schedule tree. Longer intervals are shortened to
+ * this number of frames. */
+#define DRV_USB_UHP_EHCI_PERIODIC_FRAMES             32
+
+/* Number of iTDs, that is frames that can be queued, per isochronous pipe */
+#ifndef DRV_USB_UHP_EHCI_ITD_NUMBER
+#define DRV_USB_UHP_EHCI_ITD_NUMBER                  8
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Data Type Definitions
@@ -65,5 +82,11 @@ extern void USB_UHP_ResetEnableEhci(DRV_USB_UHP_OBJ *hDriver);
 extern void _DRV_USB_UHP_HOST_EhciInit(DRV_USB_UHP_OBJ *drvObj);
 extern void _DRV_USB_UHP_HOST_DisableControlList_EHCI(DRV_USB_UHP_OBJ *hDriver);
 extern void ehci_received_size( uint32_t * BuffSize );
+extern uint32_t _DRV_USB_UHP_HOST_EhciQtdChainRelease(DRV_USB_UHP_OBJ *hDriver, DRV_USB_UHP_HOST_PIPE_OBJ *pipe);
+extern bool _DRV_USB_UHP_HOST_EhciPeriodicPipeOpen(DRV_USB_UHP_OBJ *hDriver, DRV_USB_UHP_HOST_PIPE_OBJ *pipe);
+extern void _DRV_USB_UHP_HOST_EhciPeriodicPipeClose(DRV_USB_UHP_OBJ *hDriver, DRV_USB_UHP_HOST_PIPE_OBJ *pipe);
+extern bool _DRV_USB_UHP_HOST_EhciInterruptIRPCancel(DRV_USB_UHP_OBJ *hDriver, DRV_USB_UHP_HOST_PIPE_OBJ *pipe, USB_HOST_IRP_LOCAL *irp);
+extern void _DRV_USB_UHP_HOST_EhciPeriodicTasks(DRV_USB_UHP_OBJ *hDriver);
+extern bool _DRV_USB_UHP_HOST_EhciQueueHeadIsFree(uint32_t hostEndpoint);
 
 #endif  // _DRV_USB_UHP_EHCI_H
@@ -175,6 +175,10 @@ typedef struct _DRV_USB_UHP_HOST_PIPE_OBJ
 
     /* Host endpoint */
     uint8_t hostEndpoint;
+
+    /* First and last EHCI qTD pool index of the bulk transfer in progress */
+    uint16_t qtdChainHead;
+    uint16_t qtdChainTail;
 }
 DRV_USB_UHP_HOST_PIPE_OBJ;
 
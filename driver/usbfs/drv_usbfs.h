@@ -2285,8 +2285,9 @@ USB_ERROR DRV_USBFS_HOST_IRPSubmit
   Description:
     This function opens a communication pipe between the Host and the device
     endpoint. The transfer type and other attributes are specified through the
-    function parameters. The driver does not check for available bus bandwidth,
-    which should be done by the application (the USB Host Layer in this case)
+    function parameters. Interrupt and isochronous pipes reserve the bus time
+    of one maximum size transaction in every frame. The function fails if this
+    reservation does not fit in the periodic part of the frame.
 	
   Precondition:
     The driver handle should be valid.
@@ -84,27 +84,6 @@ DRV_USB_HOST_INTERFACE gDrvUSBFSHostInterface =
  *****************************************************/
 DRV_USBFS_HOST_PIPE_OBJ gDrvUSBHostPipeObj[DRV_USBFS_HOST_PIPES_NUMBER];
 
-/******************************************************************************
- * This matrix provides a mapping of the amount of bandwidth left in a frame for
- * a given transfer size. The number in the matrix is the percentage of
- * bandwidth consumer and the index of each entry is the Log2(N) of data payload
- * size. The first entry is for payload size 1, the second for payload size of
- * 2, the third for payload size of 8 and so on.
- ******************************************************************************/
-const unsigned int gDrvUSBFSTableBW[4][11] =
-{
-    {3, 3, 3, 4, 4, 5, 7, 0, 0,  0,  0},    /* Control Transfers    */
-    {1, 1, 1, 1, 2, 3, 5, 0, 0,  0,  0},    /* Interrupt Transfers  */
-    {1, 1, 1, 1, 2, 3, 5, 0, 0,  0,  0},    /* Bulk Transfer        */
-    {1, 1, 1, 1, 2, 3, 5, 9, 18, 35, 69}    /* Isochronous Transfer */
-};      
-
-const unsigned int gDrvUSBLSTableBW[2][4] =
-{
-    {26, 27, 28,30},    /* Control Transfers    */
-    {11, 11, 12, 14}    /* Interrupt Transfers  */
-};   
-
 // *****************************************************************************
 /* Function:
     void _DRV_USBFS_SendTokenToAddress
@@ -177,8 +156,8 @@ void _DRV_USBFS_HOST_Initialize
 {
     uint8_t bdtEntryindex = 0;
 
-    /* Set the SOF threshold value in bit times */
-    PLIB_USB_SOFThresholdSet(pUSBDrvObj->usbID, 0x4A);
+    /* Set the SOF threshold value in byte times */
+    PLIB_USB_SOFThresholdSet(pUSBDrvObj->usbID, DRV_USBFS_HOST_SOF_THRESHOLD_BYTE_TIMES);
 
     /* Enable the VBUSON bit in the OTGCON register. Even if the actual VBUSON
      * pin is not under USB module control, this bit must be set for host
@@ -1164,6 +1143,19 @@ void DRV_USBFS_HOST_PipeClose
                         pTransferGroup->nPipes --;
                     }
 
+                    /* Give back the bus time reserved by a periodic pipe */
+                    if((pPipe->pipeType == USB_TRANSFER_TYPE_ISOCHRONOUS) || (pPipe->pipeType == USB_TRANSFER_TYPE_INTERRUPT))
+                    {
+                        if(pUSBDrvObj->periodicBWReserved > pPipe->bwPerTransaction)
+                        {
+                            pUSBDrvObj->periodicBWReserved -= pPipe->bwPerTransaction;
+                        }
+                        else
+                        {
+                            pUSBDrvObj->periodicBWReserved = 0;
+                        }
+                    }
+
                     /* Now we invoke the call back for each IRP in this pipe and
                      * say that it is aborted.  If the IRP is in progress, then
                      * that IRP will be actually aborted on the next SOF unless
@@ -1258,8 +1250,9 @@ void DRV_USBFS_HOST_PipeClose
   Description:
     This function opens a communication pipe between the Host and the device
     endpoint. The transfer type and other attributes are specified through the
-    function parameters. The driver does not check for available bus bandwidth,
-    which should be done by the application (the USB Host Layer in this case)
+    function parameters. Interrupt and isochronous pipes reserve the bus time
+    of one maximum size transaction in every frame. The function fails if this
+    reservation does not fit in the periodic part of the frame.
 
   Remarks:
     See drv_usbfs.h for usage information.
@@ -1283,9 +1276,7 @@ DRV_USBFS_HOST_PIPE_HANDLE DRV_USBFS_HOST_PipeSetup
     DRV_USBFS_OBJ * pUSBDrvObj = (DRV_USBFS_OBJ *)handle;
     DRV_USBFS_HOST_PIPE_HANDLE returnValue = DRV_USBFS_HOST_PIPE_HANDLE_INVALID;
     DRV_USBFS_HOST_TRANSFER_GROUP * pTransferGroup = (DRV_USBFS_HOST_TRANSFER_GROUP *)NULL;
-    unsigned int transferTypeLocal = 0;
     uint8_t pipeCount = 0;
-    uint8_t bitSetCount = 0;
     bool thereWasAnError = false;
 
     if((handle != DRV_HANDLE_INVALID) && (pUSBDrvObj != NULL) && (pUSBDrvObj->isOpened))
@@ -1319,84 +1310,47 @@ DRV_USBFS_HOST_PIPE_HANDLE DRV_USBFS_HOST_PipeSetup
 					pPipe->retryCount = 0;
                     pPipe->endpointAndDirection = endpointAndDirection;
 
-                    /* This pipe should now be added to the pipe bundle. The
-                     * mapping from the transfer type to the way the pipe
-                     * bundles are organized is not a one to one mapping. We
-                     * translate the pipe type to a local type. */
+                    /* The bus time of one max packet transaction is calculated
+                     * up front so that we dont have to calculate this in the
+                     * interrupt context when the transaction is in progress */
 
-                    switch(pPipe->pipeType)
+                    if(pipeType > USB_TRANSFER_TYPE_INTERRUPT)
                     {
-                        case USB_TRANSFER_TYPE_CONTROL:
-                            transferTypeLocal = USB_TRANSFER_TYPE_LOCAL_CONTROL;
-                            break;
-                        case USB_TRANSFER_TYPE_ISOCHRONOUS:
-                            transferTypeLocal = USB_TRANSFER_TYPE_LOCAL_ISOC;
-                            break;
-                        case USB_TRANSFER_TYPE_BULK:
-                            transferTypeLocal = USB_TRANSFER_TYPE_LOCAL_BULK;
-                            break;
-                        case USB_TRANSFER_TYPE_INTERRUPT:
-                            transferTypeLocal = USB_TRANSFER_TYPE_LOCAL_INTERRUPT;
-                            break;
-                        default:
-                            return returnValue;
+                        /* Unknown transfer type */
+                        thereWasAnError = true;
                     }
-
-                    /* In a case where the max packet size is a multiple of 2, find
-                     * calculate the log2n. */
-                    if((wMaxPacketSize <= 512) && (wMaxPacketSize != 0))
+                    else if((speed == USB_SPEED_LOW) && (pipeType != USB_TRANSFER_TYPE_INTERRUPT) && (pipeType != USB_TRANSFER_TYPE_CONTROL))
                     {
-                        for(bitSetCount = 0; bitSetCount < 10; bitSetCount++)
-                        {
-                            if((wMaxPacketSize & 0x00000001) == 0x00000001)
-                            {
-                                break;
-                            }
-                            wMaxPacketSize = wMaxPacketSize >> 1;
-                        }
+                        /* Only control and interrupt pipe can exist in low
+                         * speed */
+                        thereWasAnError = true;
                     }
-                    else if((wMaxPacketSize != 0))
+                    else if((wMaxPacketSize > 1023) || ((wMaxPacketSize > 512) && (pipeType != USB_TRANSFER_TYPE_ISOCHRONOUS)))
                     {
-                        /* This means the max packet size is greater than 512. This
-                         * is possible for Isochronous transfers */
-
-                        bitSetCount = 10;
+                        /* Only full speed isochronous endpoints can be larger
+                         * than 512 bytes */
+                        thereWasAnError = true;
                     }
-
-                    /* The bandwidth required per transaction is calculated
-                     * up front so that we dont have to calculate this in
-                     * the interrupt context when the transaction is in
-                     * progress */
-
-                    if(bitSetCount != 10)
+                    else
                     {
-                        if(pPipe->speed == USB_SPEED_LOW)
+                        pPipe->bwPerTransaction = _DRV_USBFS_HOST_TransactionByteTimes(speed, pipeType, wMaxPacketSize);
+
+                        if((pipeType == USB_TRANSFER_TYPE_ISOCHRONOUS) || (pipeType == USB_TRANSFER_TYPE_INTERRUPT))
                         {
-                            if((pPipe->pipeType == USB_TRANSFER_TYPE_INTERRUPT) || (pPipe->pipeType == USB_TRANSFER_TYPE_CONTROL))
+                            /* Periodic pipes are not phased against each other
+                             * and can all be due in the same frame. The pipe
+                             * is admitted only if one transaction of every
+                             * periodic pipe still fits in the periodic budget. */
+                            if((pUSBDrvObj->periodicBWReserved + pPipe->bwPerTransaction) > DRV_USBFS_HOST_PERIODIC_BUDGET_BYTE_TIMES)
                             {
-                                pPipe->bwPerTransaction = gDrvUSBLSTableBW[transferTypeLocal][bitSetCount];
+                                SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSBFS Driver: Not enough bus bandwidth for periodic pipe");
+                                thereWasAnError = true;
                             }
                             else
                             {
-                                /* Only control and interrupt pipe can exist in
-                                   low speed */
-                                thereWasAnError = true;
+                                pUSBDrvObj->periodicBWReserved += pPipe->bwPerTransaction;
                             }
                         }
-                        else
-                        {
-                            pPipe->bwPerTransaction = gDrvUSBFSTableBW[transferTypeLocal][bitSetCount];
-                        }
-                    }
-                    else if(bitSetCount == 10 && pPipe->pipeType == USB_TRANSFER_TYPE_ISOCHRONOUS && pPipe->speed == USB_SPEED_FULL)
-                    {
-                        /* Bandwidth for Isochronous transfers */
-                        pPipe->bwPerTransaction = gDrvUSBFSTableBW[transferTypeLocal][bitSetCount];
-                    }
-                    else
-                    {
-                        /* Error */
-                        thereWasAnError = true;
                     }
 
                     if(!thereWasAnError)
@@ -1819,7 +1773,10 @@ bool _DRV_USBFS_HOST_NonControlIRPProcess
                     case USB_TRANSACTION_NAK:
 
                         /* For non - control transfer we don't implement a 
-                         * NAK time out.Do not do anything here */
+                         * NAK time out. The IRP will be tried again in the
+                         * next frame. Give back the bus time of the
+                         * transactions that will not happen in this frame. */
+                        _DRV_USBFS_HOST_BandwidthRefund(pUSBDrvObj, pIRP);
                         endIRP = false;
                         break;
 
@@ -1836,6 +1793,10 @@ bool _DRV_USBFS_HOST_NonControlIRPProcess
 
                 ((DRV_USBFS_HOST_PIPE_OBJ *)(softwareEP->pIRP->pipe))->irpQueueHead = (softwareEP->pIRP)->next;
 
+                /* The IRP may have ended with a short packet before using
+                 * all the bus time it was given in this frame */
+                _DRV_USBFS_HOST_BandwidthRefund(pUSBDrvObj, pIRP);
+
                 /* Update the size field with actual size received\transmitted */
                 pIRP->size = pIRP->completedBytes;
 
@@ -1843,6 +1804,21 @@ bool _DRV_USBFS_HOST_NonControlIRPProcess
                 {
                     pIRP->callback((USB_HOST_IRP *)pIRP);
                 }
+
+                if((pipe->pipeType == USB_TRANSFER_TYPE_BULK) && (pipe->inUse) && (pipe->irpQueueHead != NULL))
+                {
+                    /* There is another IRP on this BULK pipe, possibly
+                     * submitted from the callback. Rather than leaving the
+                     * rest of the frame unused till the next SOF, pack it in
+                     * the same software endpoint with the bus time that is
+                     * left and continue. */
+                    if(_DRV_USBFS_HOST_Calculate_NonControl_BW(pUSBDrvObj, &pUSBDrvObj->transferGroup[USB_TRANSFER_TYPE_BULK],
+                                pipe->irpQueueHead, USB_TRANSFER_TYPE_BULK, pUSBDrvObj->numSWEpEntry))
+                    {
+                        _DRV_USBFS_HOST_NonControlSendToken(pipe->irpQueueHead, pUSBDrvObj, pipe, isLowSpeed);
+                        tokenSent = true;
+                    }
+                }
             }
         }
     }
@@ -1852,7 +1828,121 @@ bool _DRV_USBFS_HOST_NonControlIRPProcess
 
 // *****************************************************************************
 /* Function:
-    void _DRV_USBFS_HOST_CalculateControlBW
+    uint16_t _DRV_USBFS_HOST_TransactionByteTimes
+    (
+        USB_SPEED speed,
+        USB_TRANSFER_TYPE transferType,
+        unsigned int size
+    )
+
+  Summary:
+    This function returns the bus time of one transaction in full speed byte
+    times.
+
+  Description:
+    This is the dynamic implementation of _DRV_USBFS_HOST_TransactionByteTimes
+    function. The bus time is calculated with the formulas of USB 2.0 Section
+    5.11.3, including worst case bit stuffing of the data payload. BULK
+    transactions are charged without bit stuffing. These are best effort and a
+    BULK transaction which does not fit in the frame continues in the next
+    frame.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+uint16_t _DRV_USBFS_HOST_TransactionByteTimes
+(
+    USB_SPEED speed,
+    USB_TRANSFER_TYPE transferType,
+    unsigned int size
+)
+{
+    unsigned int bitTimes = 0;
+
+    if(speed == USB_SPEED_LOW)
+    {
+        /* A low speed bit is 8.125 full speed bit times */
+        bitTimes = DRV_USBFS_HOST_LS_OVERHEAD_BIT_TIMES + ((((56 * size) / 6) * 65) / 8);
+    }
+    else if(transferType == USB_TRANSFER_TYPE_ISOCHRONOUS)
+    {
+        bitTimes = DRV_USBFS_HOST_FS_ISOC_OVERHEAD_BIT_TIMES + ((56 * size) / 6);
+    }
+    else if(transferType == USB_TRANSFER_TYPE_BULK)
+    {
+        bitTimes = DRV_USBFS_HOST_FS_OVERHEAD_BIT_TIMES + (8 * size);
+    }
+    else
+    {
+        bitTimes = DRV_USBFS_HOST_FS_OVERHEAD_BIT_TIMES + ((56 * size) / 6);
+    }
+
+    bitTimes += DRV_USBFS_HOST_DELAY_BIT_TIMES;
+
+    return ((uint16_t)((bitTimes + 7) / 8));
+}
+
+// *****************************************************************************
+/* Function:
+    void _DRV_USBFS_HOST_BandwidthRefund
+    (
+        DRV_USBFS_OBJ * pUSBDrvObj,
+        USB_HOST_IRP_LOCAL * pIRP
+    )
+
+  Summary:
+    This function gives back the bus time of transactions which were packed
+    in this frame but will not be done.
+
+  Description:
+    This is the dynamic implementation of _DRV_USBFS_HOST_BandwidthRefund
+    function. An IRP is charged for all the transactions it was packed with
+    at the start of the frame. If the IRP ends with a short packet or the
+    device NAKs, the remaining transactions do not take place and their bus
+    time can be used by other IRPs in this frame.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+void _DRV_USBFS_HOST_BandwidthRefund
+(
+    DRV_USBFS_OBJ * pUSBDrvObj,
+    USB_HOST_IRP_LOCAL * pIRP
+)
+{
+    DRV_USBFS_HOST_PIPE_OBJ * pPipe = (DRV_USBFS_HOST_PIPE_OBJ *)pIRP->pipe;
+    unsigned int plannedTransactions = 0;
+    unsigned int doneTransactions = 0;
+    unsigned int refund = 0;
+
+    if(pPipe->endpointSize != 0)
+    {
+        plannedTransactions = (pIRP->tempSize + pPipe->endpointSize - 1) / pPipe->endpointSize;
+        doneTransactions = (pIRP->completedBytesInThisFrame + pPipe->endpointSize - 1) / pPipe->endpointSize;
+
+        if(plannedTransactions > doneTransactions)
+        {
+            refund = (plannedTransactions - doneTransactions) * pPipe->bwPerTransaction;
+
+            if(pUSBDrvObj->globalBWConsumed > refund)
+            {
+                pUSBDrvObj->globalBWConsumed -= refund;
+            }
+            else
+            {
+                pUSBDrvObj->globalBWConsumed = 0;
+            }
+        }
+    }
+}
+
+// *****************************************************************************
+/* Function:
+    void _DRV_USBFS_HOST_Calculate_Control_BW
     (
         DRV_USBFS_OBJ * pUSBDrvObj,
         DRV_USBFS_HOST_TRANSFER_GROUP * pTransferGroup,
@@ -1864,7 +1954,7 @@ bool _DRV_USBFS_HOST_NonControlIRPProcess
     be sent in one frame.
 
   Description:
-    This is the dynamic implementation of _DRV_USBFS_HOST_CalculateControlBW
+    This is the dynamic implementation of _DRV_USBFS_HOST_Calculate_Control_BW
     function. Function performs the following task:
     - Obtains the bandwidth requirement for the transfer based on pipe
       and IRP size
@@ -1878,27 +1968,40 @@ bool _DRV_USBFS_HOST_NonControlIRPProcess
 
 */
 
-void _DRV_USBFS_HOST_CalculateControlBW
+void _DRV_USBFS_HOST_Calculate_Control_BW
 (
     DRV_USBFS_OBJ * pUSBDrvObj,
     DRV_USBFS_HOST_TRANSFER_GROUP * pTransferGroup,
     USB_HOST_IRP_LOCAL * pControlIRP
 )
 {
-    uint8_t bwAvailable = 0;
-    uint8_t bwPerTransaction = 0;
-    uint8_t nTransactions = 0;
-    uint8_t nPossibleTransactions = 0;
+    unsigned int bwLimit = 0;
+    unsigned int bwAvailable = 0;
+    unsigned int bwPerTransaction = 0;
+    unsigned int nTransactions = 0;
+    unsigned int nPossibleTransactions = 0;
     DRV_USBFS_HOST_PIPE_OBJ * pPipe = (DRV_USBFS_HOST_PIPE_OBJ *)pControlIRP->pipe;
 
-    /* Checks the BW available out of the max possible for CONTROL transfer */
+    /* Checks the BW available out of the max possible for CONTROL transfer.
+     * The bus time reserved by the periodic pipes is not available to
+     * control. */
     if(pPipe->speed == USB_SPEED_LOW)
     {
-        bwAvailable = (DRV_USBFS_MAX_CONTROL_BANDWIDTH_LOW_SPEED - pUSBDrvObj->globalBWConsumed);
+        bwLimit = DRV_USBFS_HOST_CONTROL_BYTE_TIMES_LOW_SPEED;
     }
     else
     {
-        bwAvailable = (DRV_USBFS_MAX_CONTROL_BANDWIDTH_FULL_SPEED - pUSBDrvObj->globalBWConsumed);
+        bwLimit = DRV_USBFS_HOST_CONTROL_BYTE_TIMES_FULL_SPEED;
+    }
+
+    if(bwLimit > (DRV_USBFS_HOST_FRAME_BUDGET_BYTE_TIMES - pUSBDrvObj->periodicBWReserved))
+    {
+        bwLimit = DRV_USBFS_HOST_FRAME_BUDGET_BYTE_TIMES - pUSBDrvObj->periodicBWReserved;
+    }
+
+    if(bwLimit > pUSBDrvObj->globalBWConsumed)
+    {
+        bwAvailable = bwLimit - pUSBDrvObj->globalBWConsumed;
     }
 
     /* Obtain the per bandwidth transaction required from pipe data structure.
@@ -1907,6 +2010,14 @@ void _DRV_USBFS_HOST_CalculateControlBW
 
     bwPerTransaction = pPipe->bwPerTransaction;
 
+    if((bwAvailable < bwPerTransaction) && (pUSBDrvObj->globalBWConsumed == 0))
+    {
+        /* A low speed control transaction can be longer than what is left
+         * after the periodic reservations. Control is packed first in the
+         * frame, so one transaction is always allowed. */
+        bwAvailable = bwPerTransaction;
+    }
+
     /* Check if atleast 1 transaction is possible */
     if(bwPerTransaction <= bwAvailable)
     {
@@ -1969,7 +2080,7 @@ void _DRV_USBFS_HOST_CalculateControlBW
 
 // *****************************************************************************
 /* Function:
-    bool _DRV_USBFS_HOST_CalculateNonControlBW
+    bool _DRV_USBFS_HOST_Calculate_NonControl_BW
     (
         DRV_USBFS_OBJ * pUSBDrvObj,
         DRV_USBFS_HOST_TRANSFER_GROUP * pTransferGroup,
@@ -1983,7 +2094,7 @@ void _DRV_USBFS_HOST_CalculateControlBW
     transaction in the frame.
 
   Description:
-    This is the dynamic implementation of _DRV_USBFS_HOST_CalculateNonControlBW
+    This is the dynamic implementation of _DRV_USBFS_HOST_Calculate_NonControl_BW
     function. Function performs the following task:
     - Obtains the bandwidth requirement for the transfer based on pipe
       and IRP size
@@ -1996,7 +2107,7 @@ void _DRV_USBFS_HOST_CalculateControlBW
     application.
 */
 
-bool _DRV_USBFS_HOST_CalculateNonControlBW
+bool _DRV_USBFS_HOST_Calculate_NonControl_BW
 (
     DRV_USBFS_OBJ * pUSBDrvObj,
     DRV_USBFS_HOST_TRANSFER_GROUP * pTransferGroup,
@@ -2013,7 +2124,10 @@ bool _DRV_USBFS_HOST_CalculateNonControlBW
     bool irpPacked = false;
 
     /* Calculate the BW available in this frame */
-    bwAvailable = (DRV_USBFS_MAX_BANDWIDTH_PER_FRAME - pUSBDrvObj->globalBWConsumed);
+    if(DRV_USBFS_HOST_FRAME_BUDGET_BYTE_TIMES > pUSBDrvObj->globalBWConsumed)
+    {
+        bwAvailable = DRV_USBFS_HOST_FRAME_BUDGET_BYTE_TIMES - pUSBDrvObj->globalBWConsumed;
+    }
     bwPerTransaction = pPipe->bwPerTransaction;
 
     /* Check if at least 1 transaction is possible */
@@ -2031,7 +2145,19 @@ bool _DRV_USBFS_HOST_CalculateNonControlBW
             nTransactions++;
         }
 
-        nPossibleTransactions = bwAvailable/bwPerTransaction;
+        if(transferType != USB_TRANSFER_TYPE_BULK)
+        {
+            /* A periodic endpoint gets one transaction per service interval.
+             * This is what was reserved for it when the pipe was opened. */
+            nPossibleTransactions = 1;
+        }
+        else
+        {
+            /* Bulk gets as many transactions as fit in what is left of the
+             * frame */
+            nPossibleTransactions = bwAvailable/bwPerTransaction;
+        }
+
         if(nPossibleTransactions < nTransactions)
         {
             nTransactions = nPossibleTransactions;
@@ -2120,7 +2246,7 @@ void _DRV_USBFS_HOST_TransferPack (DRV_USBFS_OBJ * pUSBDrvObj)
              * the tobeDone field. Because this is being called at the start of
              * the frame, we know that bandwidth will always get allocated. */
 
-            _DRV_USBFS_HOST_CalculateControlBW(pUSBDrvObj, pTransferGroup, pControlIRP);
+            _DRV_USBFS_HOST_Calculate_Control_BW(pUSBDrvObj, pTransferGroup, pControlIRP);
             numIRPProcess = 1;
         }
         else
@@ -2155,11 +2281,11 @@ void _DRV_USBFS_HOST_TransferPack (DRV_USBFS_OBJ * pUSBDrvObj)
                     /* So the PIPE has valid CONTROL IRP.  Analyze the bandwidth
                      * requirements for this IRP and calculate the amount of
                      * data to be processed in this USB frame.  The
-                     * _DRV_USBFS_HOST_CalculateControlBW function will set the
+                     * _DRV_USBFS_HOST_Calculate_Control_BW function will set the
                      * tobeDone flag true if the transaction could be scheduled
                      * in this frame.  */
 
-                    _DRV_USBFS_HOST_CalculateControlBW(pUSBDrvObj, pTransferGroup, pControlIRP);
+                    _DRV_USBFS_HOST_Calculate_Control_BW(pUSBDrvObj, pTransferGroup, pControlIRP);
                     if(pUSBDrvObj->drvUSBHostSWEp[0].tobeDone == true)
                     {
                         /* We have successfully packed a CONTROL IRP.  The
@@ -2242,7 +2368,7 @@ void _DRV_USBFS_HOST_TransferPack (DRV_USBFS_OBJ * pUSBDrvObj)
                 piteratorPipe->intervalCounter = piteratorPipe->bInterval;
                 
                 /* Check BW and pack IRP */
-                irpPacked = _DRV_USBFS_HOST_CalculateNonControlBW ( pUSBDrvObj, pTransferGroup, pisochronousIRP, USB_TRANSFER_TYPE_ISOCHRONOUS, numSWEpEntry);
+                irpPacked = _DRV_USBFS_HOST_Calculate_NonControl_BW ( pUSBDrvObj, pTransferGroup, pisochronousIRP, USB_TRANSFER_TYPE_ISOCHRONOUS, numSWEpEntry);
 
                 if(irpPacked == true)
                 {
@@ -2320,7 +2446,7 @@ void _DRV_USBFS_HOST_TransferPack (DRV_USBFS_OBJ * pUSBDrvObj)
 
                 piteratorPipe->intervalCounter = piteratorPipe->bInterval;
                 /* Check BW and pack IRP */
-                irpPacked = _DRV_USBFS_HOST_CalculateNonControlBW ( pUSBDrvObj, pTransferGroup, pinterruptIRP, USB_TRANSFER_TYPE_INTERRUPT, numSWEpEntry);
+                irpPacked = _DRV_USBFS_HOST_Calculate_NonControl_BW ( pUSBDrvObj, pTransferGroup, pinterruptIRP, USB_TRANSFER_TYPE_INTERRUPT, numSWEpEntry);
 
                 if(irpPacked == true)
                 {
@@ -2380,7 +2506,7 @@ void _DRV_USBFS_HOST_TransferPack (DRV_USBFS_OBJ * pUSBDrvObj)
             if(pbulkIRP != NULL)
             {
                 /* So the PIPE has valid BULK IRP */
-                irpPacked = _DRV_USBFS_HOST_CalculateNonControlBW ( pUSBDrvObj, pTransferGroup, pbulkIRP, USB_TRANSFER_TYPE_BULK, numSWEpEntry);
+                irpPacked = _DRV_USBFS_HOST_Calculate_NonControl_BW ( pUSBDrvObj, pTransferGroup, pbulkIRP, USB_TRANSFER_TYPE_BULK, numSWEpEntry);
 
                 if(irpPacked == true)
                 {
@@ -66,9 +66,33 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 #define _DRV_USBFS_HOST_IRP_PER_FRAME_NUMBER        5
 #define _DRV_USBFS_SW_EP_NUMBER _DRV_USBFS_HOST_IRP_PER_FRAME_NUMBER
 
-#define DRV_USBFS_MAX_CONTROL_BANDWIDTH_FULL_SPEED      20
-#define DRV_USBFS_MAX_CONTROL_BANDWIDTH_LOW_SPEED       30
-#define DRV_USBFS_MAX_BANDWIDTH_PER_FRAME    70
+/* Bus time is accounted in full speed byte times (8 bit times, 666.67 ns). A
+ * 1 millisecond frame is 1500 byte times. The SOF threshold is the window
+ * before the next SOF in which the module does not start a new token. The
+ * frame budget is what is left after the SOF packet and this window. */
+#define DRV_USBFS_HOST_FRAME_BYTE_TIMES                 1500
+#define DRV_USBFS_HOST_SOF_BYTE_TIMES                   6
+#define DRV_USBFS_HOST_SOF_THRESHOLD_BYTE_TIMES         0x4A
+#define DRV_USBFS_HOST_FRAME_BUDGET_BYTE_TIMES          (DRV_USBFS_HOST_FRAME_BYTE_TIMES - DRV_USBFS_HOST_SOF_BYTE_TIMES - DRV_USBFS_HOST_SOF_THRESHOLD_BYTE_TIMES)
+
+/* 10 percent of the frame is kept free of periodic reservations so that
+ * control transfers always make progress (USB 2.0 Section 5.5.4). Periodic
+ * pipes are admitted against the rest of the budget. */
+#define DRV_USBFS_HOST_CONTROL_RESERVE_BYTE_TIMES       (DRV_USBFS_HOST_FRAME_BYTE_TIMES / 10)
+#define DRV_USBFS_HOST_PERIODIC_BUDGET_BYTE_TIMES       (DRV_USBFS_HOST_FRAME_BUDGET_BYTE_TIMES - DRV_USBFS_HOST_CONTROL_RESERVE_BYTE_TIMES)
+
+/* Maximum bus time a control transfer may use in one frame */
+#define DRV_USBFS_HOST_CONTROL_BYTE_TIMES_FULL_SPEED    300
+#define DRV_USBFS_HOST_CONTROL_BYTE_TIMES_LOW_SPEED     450
+
+/* Transaction overheads in full speed bit times, from the bus time formulas of
+ * USB 2.0 Section 5.11.3. The low speed overhead includes the PRE and hub
+ * setup time. The host delay covers the module turnaround between two
+ * transactions. */
+#define DRV_USBFS_HOST_FS_OVERHEAD_BIT_TIMES            113
+#define DRV_USBFS_HOST_FS_ISOC_OVERHEAD_BIT_TIMES       91
+#define DRV_USBFS_HOST_LS_OVERHEAD_BIT_TIMES            803
+#define DRV_USBFS_HOST_DELAY_BIT_TIMES                  16
 
 #define USB_TRANSFER_TYPE_LOCAL_CONTROL          0
 #define USB_TRANSFER_TYPE_LOCAL_INTERRUPT        1
@@ -307,8 +331,8 @@ typedef struct _DRV_USBFS_HOST_PIPE_OBJ
 
     uint8_t intervalCounter;
 
-    /* Bandwidth */
-    uint8_t bwPerTransaction;
+    /* Bus time of one max packet transaction in byte times */
+    uint16_t bwPerTransaction;
 
     /* Pipe Speed */
     USB_SPEED speed;
@@ -496,7 +520,10 @@ typedef struct _DRV_USBFS_OBJ_STRUCT
     _DRV_USBFS_FOR_HOST(USB_BUFFER_PING_PONG, ep0RxPingPong);
 
     /* Placeholder for bandwidth consumed in frame */
-    _DRV_USBFS_FOR_HOST(uint8_t, globalBWConsumed);
+    _DRV_USBFS_FOR_HOST(uint16_t, globalBWConsumed);
+
+    /* Per frame bus time reserved by the open periodic pipes */
+    _DRV_USBFS_FOR_HOST(uint16_t, periodicBWReserved);
 
     /* Variable used SW Endpoint objects that is used by this HW instances for
      * USB transfer scheduling */
@@ -622,6 +649,19 @@ void _DRV_USBFS_HOST_NonControl_Send_Token
     bool isLowSpeed
 );
 
+uint16_t _DRV_USBFS_HOST_TransactionByteTimes
+(
+    USB_SPEED speed,
+    USB_TRANSFER_TYPE transferType,
+    unsigned int size
+);
+
+void _DRV_USBFS_HOST_BandwidthRefund
+(
+    DRV_USBFS_OBJ * pusbdrvObj,
+    USB_HOST_IRP_LOCAL * pirp
+);
+
 void _DRV_USBFS_HOST_ControlSendToken
 (
     USB_HOST_IRP_LOCAL * pirp,
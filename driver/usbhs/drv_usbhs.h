@@ -244,6 +244,82 @@ typedef enum
 
 } DRV_USBHS_OPMODES;
 
+// *****************************************************************************
+/* USB Device Endpoint DMA Weight Enumeration.
+
+  Summary:
+    Identifies the priority of a device mode endpoint for DMA channels.
+
+  Description:
+    This enumeration identifies the priority of a device mode endpoint for the
+    DMA channels of the Hi-Speed USB Driver. An endpoint can only use a DMA
+    channel if more channels are free than are reserved for the endpoints of
+    higher weight. Each weight level above an endpoint reserves
+    DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED channels.
+
+  Remarks:
+    This enumeration is only available if
+    DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED is defined.
+*/
+
+typedef enum
+{
+    /* The weight depends on the endpoint type. Isochronous endpoints have a
+     * high weight, bulk endpoints a medium weight and interrupt endpoints a
+     * low weight. */
+    DRV_USBHS_DEVICE_DMA_WEIGHT_DEFAULT = 0,
+
+    /* The endpoint never uses DMA */
+    DRV_USBHS_DEVICE_DMA_WEIGHT_NONE,
+
+    /* The endpoint has a low priority */
+    DRV_USBHS_DEVICE_DMA_WEIGHT_LOW,
+
+    /* The endpoint has a medium priority */
+    DRV_USBHS_DEVICE_DMA_WEIGHT_MEDIUM,
+
+    /* The endpoint has a high priority */
+    DRV_USBHS_DEVICE_DMA_WEIGHT_HIGH
+
+} DRV_USBHS_DEVICE_DMA_WEIGHT;
+
+// *****************************************************************************
+/* USB Device Endpoint DMA Statistics.
+
+  Summary:
+    Contains the DMA and PIO counters of a device mode endpoint.
+
+  Description:
+    This structure contains the number of packets of a device mode endpoint
+    that the Hi-Speed USB Driver moved with DMA and the number of packets that
+    it had to move with PIO because of the DMA scheduler. Packets that the
+    driver always moves with PIO, such as a packet that is already in the FIFO
+    when the IRP is submitted, are not counted.
+
+  Remarks:
+    This structure is only available if DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED
+    is defined.
+*/
+
+typedef struct
+{
+    /* Packets that were moved with DMA from or to the IRP data */
+    uint32_t dmaPackets;
+
+    /* Packets that were moved with DMA through a bounce buffer because the
+     * IRP data was not 4 byte aligned */
+    uint32_t bouncePackets;
+
+    /* Packets that were moved with PIO because no DMA channel was available
+     * to the weight of the endpoint */
+    uint32_t pioNoChannelPackets;
+
+    /* Packets that were moved with PIO because the IRP data was not aligned
+     * and no bounce buffer was available */
+    uint32_t pioUnalignedPackets;
+
+} DRV_USBHS_DEVICE_DMA_STATISTICS;
+
 // *****************************************************************************
 /* Type of the Hi-Speed USB Driver Event Callback Function.
 
@@ -2212,6 +2288,125 @@ USB_ERROR DRV_USBHS_DEVICE_TestModeExit
     USB_TEST_MODE_SELECTORS testMode
 );
 
+// ****************************************************************************
+/* Function:
+    USB_ERROR DRV_USBHS_DEVICE_EndpointDMAWeightSet
+    (
+        SYS_MODULE_OBJ object,
+        USB_ENDPOINT endpointAndDirection,
+        DRV_USBHS_DEVICE_DMA_WEIGHT weight
+    );
+  
+  Summary:
+    This function sets the DMA weight of a device mode endpoint.
+	
+  Description:
+    This function sets the priority of the specified endpoint for the DMA
+    channels of the driver. By default, the weight of an endpoint depends on
+    its type. An application can lower the weight of an endpoint with a low
+    data rate, such as the data endpoints of a CDC console, so that these do
+    not take the DMA channels from an endpoint with a high data rate, such as
+    the endpoints of a mass storage device. The weight is kept when the
+    endpoint is disabled and enabled again.
+
+  Precondition:
+    The driver must have been initialized.
+	
+  Parameters:
+    object - Driver object (returned from DRV_USBHS_Initialize).
+	
+    endpointAndDirection - Endpoint and direction. Endpoint 0 does not use
+    DMA and cannot be specified.
+
+    weight - The DMA weight of the endpoint.
+
+  Returns:
+    * USB_ERROR_NONE - The weight was set.
+    * USB_ERROR_PARAMETER_INVALID - The driver object is not valid.
+    * USB_ERROR_DEVICE_ENDPOINT_INVALID - The endpoint is not valid.
+	
+  Example:
+    <code>
+    // This code lowers the DMA weight of the CDC data endpoints so that the
+    // MSD endpoints are preferred.
+
+    DRV_USBHS_DEVICE_EndpointDMAWeightSet(sysObj.drvUSBHSObject,
+            USB_ENDPOINT_AND_DIRECTION(USB_DATA_DIRECTION_DEVICE_TO_HOST, 3),
+            DRV_USBHS_DEVICE_DMA_WEIGHT_LOW);
+    DRV_USBHS_DEVICE_EndpointDMAWeightSet(sysObj.drvUSBHSObject,
+            USB_ENDPOINT_AND_DIRECTION(USB_DATA_DIRECTION_HOST_TO_DEVICE, 3),
+            DRV_USBHS_DEVICE_DMA_WEIGHT_LOW);
+    </code>
+	
+  Remarks:
+    This function is only available if DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED
+    is defined.
+*/
+
+USB_ERROR DRV_USBHS_DEVICE_EndpointDMAWeightSet
+(
+    SYS_MODULE_OBJ object,
+    USB_ENDPOINT endpointAndDirection,
+    DRV_USBHS_DEVICE_DMA_WEIGHT weight
+);
+
+// ****************************************************************************
+/* Function:
+    USB_ERROR DRV_USBHS_DEVICE_EndpointDMAStatisticsGet
+    (
+        SYS_MODULE_OBJ object,
+        USB_ENDPOINT endpointAndDirection,
+        DRV_USBHS_DEVICE_DMA_STATISTICS * statistics
+    );
+  
+  Summary:
+    This function returns the DMA and PIO counters of a device mode endpoint.
+	
+  Description:
+    This function copies the DMA and PIO counters of the specified endpoint to
+    statistics. The counters are counted from the initialization of the
+    driver.
+
+  Precondition:
+    The driver must have been initialized.
+	
+  Parameters:
+    object - Driver object (returned from DRV_USBHS_Initialize).
+	
+    endpointAndDirection - Endpoint and direction.
+
+    statistics - Destination of the counters.
+
+  Returns:
+    * USB_ERROR_NONE - The counters were returned.
+    * USB_ERROR_PARAMETER_INVALID - The driver object or statistics is not
+      valid.
+    * USB_ERROR_DEVICE_ENDPOINT_INVALID - The endpoint is not valid.
+	
+  Example:
+    <code>
+    DRV_USBHS_DEVICE_DMA_STATISTICS statistics;
+
+    if(DRV_USBHS_DEVICE_EndpointDMAStatisticsGet(sysObj.drvUSBHSObject,
+            USB_ENDPOINT_AND_DIRECTION(USB_DATA_DIRECTION_DEVICE_TO_HOST, 1),
+            &statistics) == USB_ERROR_NONE)
+    {
+        // Check statistics.pioNoChannelPackets
+    }
+    </code>
+	
+  Remarks:
+    This function is only available if DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED
+    is defined.
+*/
+
+USB_ERROR DRV_USBHS_DEVICE_EndpointDMAStatisticsGet
+(
+    SYS_MODULE_OBJ object,
+    USB_ENDPOINT endpointAndDirection,
+    DRV_USBHS_DEVICE_DMA_STATISTICS * statistics
+);
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Interface Routines - Host Mode Operation
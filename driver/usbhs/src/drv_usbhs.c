@@ -64,6 +64,16 @@ DRV_USBHS_OBJ gDrvUSBObj[DRV_USBHS_INSTANCES_NUMBER];
 
 DRV_USBHS_DEVICE_ENDPOINT_OBJ gDrvUSBEndpoints [DRV_USBHS_INSTANCES_NUMBER] [DRV_USBHS_ENDPOINTS_NUMBER * 2];
 
+#if defined(DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED)
+/***********************************
+ * DMA bounce buffers for device
+ * mode transfers from and to
+ * unaligned buffers.
+ ***********************************/
+
+uint8_t gDrvUSBDMABounceBuffers [DRV_USBHS_INSTANCES_NUMBER] [DRV_USBHS_DEVICE_DMA_BOUNCE_BUFFERS_NUMBER] [DRV_USBHS_DEVICE_DMA_BOUNCE_BUFFER_SIZE] __attribute__((coherent, aligned(16)));
+#endif
+
 // *****************************************************************************
 /* Function:
     SYS_MODULE_OBJ DRV_USBHS_Initialize
@@ -137,6 +147,10 @@ SYS_MODULE_OBJ DRV_USBHS_Initialize
 
                 /* Assign the endpoint table */
                 drvObj->usbDrvCommonObj.endpointTable = &gDrvUSBEndpoints[drvIndex][0];
+#if defined(DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED)
+                drvObj->usbDrvCommonObj.dmaBounceBuffers = &gDrvUSBDMABounceBuffers[drvIndex][0];
+                drvObj->usbDrvCommonObj.dmaBounceBuffersInUse = 0;
+#endif
                 drvObj->usbDrvCommonObj.interruptSource = usbInit->interruptSource;
 
                 drvObj->usbDrvCommonObj.interruptSourceUSBDma = usbInit->interruptSourceUSBDma;
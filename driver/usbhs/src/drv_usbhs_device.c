@@ -48,6 +48,11 @@
 #include "driver/usb/usbhs/src/drv_usbhs_local.h"
 #include "driver/usb/usbhs/drv_usbhs.h"
 
+/******************************************************************************
+ * The USB driver object. Has already been defined in drv_usbhs.c file.
+ *****************************************************************************/
+extern DRV_USBHS_OBJ gDrvUSBObj[];
+
 
 /*****************************************************
  * This structure is a pointer to a set of USB Driver
@@ -76,7 +81,8 @@ DRV_USB_DEVICE_INTERFACE gDrvUSBHSDeviceInterface =
     .deviceIRPCancelAll = DRV_USBHS_DEVICE_IRPCancelAll,
     .deviceRemoteWakeupStop = DRV_USBHS_DEVICE_RemoteWakeupStop,
     .deviceRemoteWakeupStart = DRV_USBHS_DEVICE_RemoteWakeupStart,
-    .deviceTestModeEnter = DRV_USBHS_DEVICE_TestModeEnter
+    .deviceTestModeEnter = DRV_USBHS_DEVICE_TestModeEnter,
+    .capabilities = DRV_USB_CAPABILITY_IRP_DATA_SEGMENTS
 };
 
 // *****************************************************************************
@@ -342,6 +348,211 @@ void _DRV_USBHS_DEVICE_FIFOFreeAll
     }
 }
 
+#if defined(DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED)
+
+// *****************************************************************************
+/* Function:
+    uint8_t _DRV_USBHS_DEVICE_DMAChannelSchedule
+    (
+        DRV_USBHS_OBJ * hDriver,
+        DRV_USBHS_DEVICE_ENDPOINT_OBJ * endpointObj,
+        uint8_t endpoint,
+        uint8_t direction,
+        uint8_t * data,
+        uint32_t count,
+        uint8_t ** dmaAddress
+    )
+
+  Summary:
+    Decides if a packet is moved with DMA and grabs the DMA channel.
+
+  Description:
+    This function returns a DMA channel for the packet or 0 if the packet must
+    be moved with PIO. An endpoint only gets a channel if more channels are
+    free than are reserved for endpoints of higher weight. If data is not 4
+    byte aligned, the packet is moved through a bounce buffer. In this case
+    the function copies the data to be sent to the bounce buffer. The address
+    that the DMA channel must use is returned in dmaAddress. The DMA counters
+    of the endpoint are updated.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application. It must be called with the USB and USB DMA interrupts
+    disabled or from the USB interrupt.
+*/
+
+static uint8_t _DRV_USBHS_DEVICE_DMAChannelSchedule
+(
+    DRV_USBHS_OBJ * hDriver,
+    DRV_USBHS_DEVICE_ENDPOINT_OBJ * endpointObj,
+    uint8_t endpoint,
+    uint8_t direction,
+    uint8_t * data,
+    uint32_t count,
+    uint8_t ** dmaAddress
+)
+{
+    DRV_USBHS_DMA_POOL * dmaPool = &hDriver->usbDrvCommonObj.gDrvUSBDMAPool[0];
+    DRV_USBHS_DEVICE_DMA_WEIGHT weight;
+    uint8_t dmaChannel = 0;
+    uint8_t channelCount = 0;
+    uint8_t freeChannels = 0;
+    uint8_t bufferIndex = 0;
+
+    *dmaAddress = data;
+
+    weight = endpointObj->dmaWeight;
+    if(weight == DRV_USBHS_DEVICE_DMA_WEIGHT_DEFAULT)
+    {
+        /* The weight depends on the endpoint type */
+        if(endpointObj->endpointType == USB_TRANSFER_TYPE_ISOCHRONOUS)
+        {
+            weight = DRV_USBHS_DEVICE_DMA_WEIGHT_HIGH;
+        }
+        else if(endpointObj->endpointType == USB_TRANSFER_TYPE_BULK)
+        {
+            weight = DRV_USBHS_DEVICE_DMA_WEIGHT_MEDIUM;
+        }
+        else
+        {
+            weight = DRV_USBHS_DEVICE_DMA_WEIGHT_LOW;
+        }
+    }
+
+    for(channelCount = 1; channelCount <= DRV_USBHS_MAX_DMA_CHANNELS; channelCount++)
+    {
+        if(dmaPool[channelCount].inUse == false)
+        {
+            freeChannels ++;
+        }
+    }
+
+    if((weight == DRV_USBHS_DEVICE_DMA_WEIGHT_NONE) ||
+            (freeChannels <= ((DRV_USBHS_DEVICE_DMA_WEIGHT_HIGH - weight) * DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED)))
+    {
+        /* The free channels are reserved for endpoints of higher weight */
+        endpointObj->dmaStatistics.pioNoChannelPackets ++;
+    }
+    else if(((uintptr_t)data & 0x3) == 0)
+    {
+        /* The DMA channel can access the IRP data */
+        dmaChannel = _DRV_USBHS_DEVICE_Get_FreeDMAChannel(hDriver, direction, endpoint);
+        endpointObj->dmaStatistics.dmaPackets ++;
+    }
+    else
+    {
+        /* The IRP data is not aligned. Look for a free bounce buffer. */
+        while((bufferIndex < DRV_USBHS_DEVICE_DMA_BOUNCE_BUFFERS_NUMBER) &&
+                (((hDriver->usbDrvCommonObj.dmaBounceBuffersInUse >> bufferIndex) & 0x1) != 0))
+        {
+            bufferIndex ++;
+        }
+
+        if((bufferIndex == DRV_USBHS_DEVICE_DMA_BOUNCE_BUFFERS_NUMBER) ||
+                (count > DRV_USBHS_DEVICE_DMA_BOUNCE_BUFFER_SIZE))
+        {
+            endpointObj->dmaStatistics.pioUnalignedPackets ++;
+        }
+        else
+        {
+            dmaChannel = _DRV_USBHS_DEVICE_Get_FreeDMAChannel(hDriver, direction, endpoint);
+
+            hDriver->usbDrvCommonObj.dmaBounceBuffersInUse |= (1 << bufferIndex);
+            dmaPool[dmaChannel].bounceBufferUsed = true;
+            dmaPool[dmaChannel].bounceBufferIndex = bufferIndex;
+            dmaPool[dmaChannel].bounceDestination = data;
+
+            *dmaAddress = hDriver->usbDrvCommonObj.dmaBounceBuffers[bufferIndex];
+
+            if(direction == USB_DATA_DIRECTION_DEVICE_TO_HOST)
+            {
+                memcpy(*dmaAddress, data, count);
+            }
+
+            endpointObj->dmaStatistics.bouncePackets ++;
+        }
+    }
+
+    return dmaChannel;
+}
+
+#endif
+
+// *****************************************************************************
+/* Function:
+    void _DRV_USBHS_DEVICE_IRPDataSegmentsFIFOAccess
+    (
+        USBHS_MODULE_ID usbID,
+        uint8_t endpoint,
+        USB_DEVICE_IRP_LOCAL * irp,
+        unsigned int offset,
+        unsigned int count,
+        bool toFifo
+    )
+
+  Summary:
+    Moves data between the segments of an IRP and the endpoint FIFO.
+
+  Description:
+    This function moves count bytes between the endpoint FIFO and the data of
+    an IRP that was submitted with the USB_DEVICE_IRP_FLAG_DATA_SEGMENTS flag,
+    starting at offset in the IRP data. The transfer continues across segment
+    boundaries. The data is loaded to the FIFO if toFifo is true and unloaded
+    from the FIFO otherwise. The function does not set the TX Packet Ready or
+    clear the RX Packet Ready bit.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application. offset + count must not be larger than the IRP size.
+*/
+
+static void _DRV_USBHS_DEVICE_IRPDataSegmentsFIFOAccess
+(
+    USBHS_MODULE_ID usbID,
+    uint8_t endpoint,
+    USB_DEVICE_IRP_LOCAL * irp,
+    unsigned int offset,
+    unsigned int count,
+    bool toFifo
+)
+{
+    USB_IRP_DATA_SEGMENT * segment = (USB_IRP_DATA_SEGMENT *)irp->data;
+    unsigned int fifoOffset = 0;
+    unsigned int chunk;
+
+    /* Find the segment that contains the offset */
+    while((count > 0) && (offset >= segment->size))
+    {
+        offset -= segment->size;
+        segment ++;
+    }
+
+    while(count > 0)
+    {
+        chunk = segment->size - offset;
+        if(chunk > count)
+        {
+            chunk = count;
+        }
+
+        if(toFifo)
+        {
+            PLIB_USBHS_DeviceEPFIFOLoad(usbID, endpoint, (uint8_t *)segment->data + offset, chunk);
+        }
+        else
+        {
+            PLIB_USBHS_DeviceEPFIFOPartialUnload(usbID, endpoint, (uint8_t *)segment->data + offset, fifoOffset, chunk);
+        }
+
+        fifoOffset += chunk;
+        count -= chunk;
+
+        /* Continue at the start of the next segment */
+        offset = 0;
+        segment ++;
+    }
+}
+
 uint16_t _DRV_USBHS_ProcessIRPFIFO
 (
     DRV_USBHS_OBJ * hDriver,
@@ -362,10 +573,18 @@ uint16_t _DRV_USBHS_ProcessIRPFIFO
     uint8_t dmaChannelGrabbed = 0;
     USBHS_MODULE_ID usbID = USBHS_NUMBER_OF_MODULES;
     uint8_t * data;
+    uint8_t * dmaAddress;
 
     data = (uint8_t *)irp->data;
     usbID = hDriver->usbDrvCommonObj.usbID;
 
+    if((irp->flags & USB_DEVICE_IRP_FLAG_DATA_SEGMENTS) != 0)
+    {
+        /* The DMA needs one contiguous buffer. The data of an IRP with data
+         * segments is always moved with FIFO access. */
+        tryDma = false;
+    }
+
     if(USB_DATA_DIRECTION_DEVICE_TO_HOST == direction)
     {
         /* This means data has to move from device
@@ -389,7 +608,12 @@ uint16_t _DRV_USBHS_ProcessIRPFIFO
                  * If no channel was found, then we process with manual FIFO
                  * access. */
 
+#if defined(DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED)
+                dmaChannelGrabbed = _DRV_USBHS_DEVICE_DMAChannelSchedule(hDriver, endpointObj, endpoint, USB_DATA_DIRECTION_DEVICE_TO_HOST, &data[offset], count, &dmaAddress);
+#else
                 dmaChannelGrabbed = _DRV_USBHS_DEVICE_Get_FreeDMAChannel(hDriver, USB_DATA_DIRECTION_DEVICE_TO_HOST, endpoint);
+                dmaAddress = &data[offset];
+#endif
                 if((0 == dmaChannelGrabbed))
                 {
                     /* NO DMA channel available. So do normal FIFO load */
@@ -406,13 +630,20 @@ uint16_t _DRV_USBHS_ProcessIRPFIFO
                      hDriver->usbDrvCommonObj.gDrvUSBDMAPool[dmaChannelGrabbed].count = count;
                      irp->nPendingBytes -= count;
                      *pisDMAUsed = true;
-                     PLIB_USBHS_DMAOperationEnable(usbID, endpoint, dmaChannelGrabbed,(void *)&data[offset], count, 0);
+                     PLIB_USBHS_DMAOperationEnable(usbID, endpoint, dmaChannelGrabbed, (void *)dmaAddress, count, 0);
                 }
             }
             else
             {
                 /* Do a manual FIFO access as tryDma flag is false */
-                PLIB_USBHS_DeviceEPFIFOLoad(usbID, endpoint, &data[offset], count);
+                if((irp->flags & USB_DEVICE_IRP_FLAG_DATA_SEGMENTS) != 0)
+                {
+                    _DRV_USBHS_DEVICE_IRPDataSegmentsFIFOAccess(usbID, endpoint, irp, offset, count, true);
+                }
+                else
+                {
+                    PLIB_USBHS_DeviceEPFIFOLoad(usbID, endpoint, &data[offset], count);
+                }
                 *pisDMAUsed = false;
                 irp->nPendingBytes -= count;
             }
@@ -426,7 +657,15 @@ uint16_t _DRV_USBHS_ProcessIRPFIFO
         {
             if(true == tryDma)
             {
+#if defined(DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED)
+                /* The scheduler needs the received data count to choose a
+                 * bounce buffer */
+                count = (uint32_t) PLIB_USBHS_GetReceiveDataCount(usbID, endpoint);
+                dmaChannelGrabbed = _DRV_USBHS_DEVICE_DMAChannelSchedule(hDriver, endpointObj, endpoint, USB_DATA_DIRECTION_HOST_TO_DEVICE, &data[irp->nPendingBytes], count, &dmaAddress);
+#else
                 dmaChannelGrabbed = _DRV_USBHS_DEVICE_Get_FreeDMAChannel(hDriver, USB_DATA_DIRECTION_HOST_TO_DEVICE, endpoint);
+                dmaAddress = &data[irp->nPendingBytes];
+#endif
 
                 if((0 == dmaChannelGrabbed))
                 {
@@ -445,17 +684,27 @@ uint16_t _DRV_USBHS_ProcessIRPFIFO
                       * Received data count in bytes */
                      count = (uint32_t) PLIB_USBHS_GetReceiveDataCount(usbID, endpoint);
                      hDriver->usbDrvCommonObj.gDrvUSBDMAPool[dmaChannelGrabbed].count = count;
-                     offset = irp->nPendingBytes;
                      irp->nPendingBytes += count;
                      *pisDMAUsed = true;
                      
-                     PLIB_USBHS_DMAOperationEnable(usbID, endpoint, dmaChannelGrabbed, (void *)((uint8_t *)(irp->data) + offset),count, 1);
+                     PLIB_USBHS_DMAOperationEnable(usbID, endpoint, dmaChannelGrabbed, (void *)dmaAddress, count, 1);
                 }
             }
             else
             {
                 /* tryDma flag is false. So we perform manual FIFO access */
-                count = PLIB_USBHS_DeviceEPFIFOUnload(usbID, endpoint, &data[irp->nPendingBytes]);
+                if((irp->flags & USB_DEVICE_IRP_FLAG_DATA_SEGMENTS) != 0)
+                {
+                    /* Bytes beyond the IRP size are left in the FIFO. These
+                     * are discarded when the RX Packet Ready bit is cleared. */
+                    count = (uint32_t) PLIB_USBHS_GetReceiveDataCount(usbID, endpoint);
+                    _DRV_USBHS_DEVICE_IRPDataSegmentsFIFOAccess(usbID, endpoint, irp, irp->nPendingBytes,
+                            ((irp->nPendingBytes + count) > irp->size) ? (irp->size - irp->nPendingBytes) : count, false);
+                }
+                else
+                {
+                    count = PLIB_USBHS_DeviceEPFIFOUnload(usbID, endpoint, &data[irp->nPendingBytes]);
+                }
                 *pisDMAUsed = false;
                 irp->nPendingBytes += count;
             }
@@ -867,7 +1116,7 @@ void DRV_USBHS_DEVICE_Detach
                     if(true == (hDriver->usbDrvCommonObj.gDrvUSBDMAPool[channelCount]).inUse)
                     {
                         /* Found Used DMA Channel - Release this channel */
-                        hDriver->usbDrvCommonObj.gDrvUSBDMAPool[channelCount].inUse = false;
+                        _DRV_USBHS_DEVICE_DMAChannelRelease(hDriver, channelCount);
                     }
                     /* Clear if any USB DMA error */
                     PLIB_USBHS_DMAErrorGet(usbID, channelCount);
@@ -1653,6 +1902,12 @@ USB_ERROR DRV_USBHS_DEVICE_IRPSubmit
                 /* This means the endpoint is not enabled */
                 returnValue = USB_ERROR_ENDPOINT_NOT_CONFIGURED;
             }
+            else if((endpoint == 0) && ((irp->flags & USB_DEVICE_IRP_FLAG_DATA_SEGMENTS) != 0))
+            {
+                /* Data segments are not supported on endpoint 0 */
+                SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSBHS Driver: Data segments are not supported on endpoint 0 in DRV_USBHS_DEVICE_IRPSubmit()");
+                returnValue = USB_ERROR_PARAMETER_INVALID;
+            }
             else
             {
                 /* Check the size of the IRP. If the endpoint receives data from the
@@ -3495,6 +3750,155 @@ uint8_t _DRV_USBHS_DEVICE_Get_FreeDMAChannel
      return dmaChannel;
 }
 
+// *****************************************************************************
+/* Function:
+    void _DRV_USBHS_DEVICE_DMAChannelRelease
+    (
+        DRV_USBHS_OBJ * hDriver,
+        uint8_t dmaChannel
+    )
+
+  Summary:
+    Returns a DMA channel to the pool.
+
+  Description:
+    This function returns a DMA channel and its bounce buffer, if any, to the
+    pool.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+void _DRV_USBHS_DEVICE_DMAChannelRelease
+(
+    DRV_USBHS_OBJ * hDriver,
+    uint8_t dmaChannel
+)
+{
+    DRV_USBHS_DMA_POOL * dmaPool = &hDriver->usbDrvCommonObj.gDrvUSBDMAPool[dmaChannel];
+
+#if defined(DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED)
+    if(dmaPool->bounceBufferUsed)
+    {
+        hDriver->usbDrvCommonObj.dmaBounceBuffersInUse &= ~(1 << dmaPool->bounceBufferIndex);
+        dmaPool->bounceBufferUsed = false;
+    }
+#endif
+
+    dmaPool->inUse = false;
+}
+
+#if defined(DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED)
+
+// *****************************************************************************
+/* Function:
+    USB_ERROR DRV_USBHS_DEVICE_EndpointDMAWeightSet
+    (
+        SYS_MODULE_OBJ object,
+        USB_ENDPOINT endpointAndDirection,
+        DRV_USBHS_DEVICE_DMA_WEIGHT weight
+    )
+
+  Summary:
+    This function sets the DMA weight of a device mode endpoint.
+
+  Description:
+    This function sets the DMA weight of a device mode endpoint.
+
+  Remarks:
+    See drv_usbhs.h for usage information.
+*/
+
+USB_ERROR DRV_USBHS_DEVICE_EndpointDMAWeightSet
+(
+    SYS_MODULE_OBJ object,
+    USB_ENDPOINT endpointAndDirection,
+    DRV_USBHS_DEVICE_DMA_WEIGHT weight
+)
+{
+    DRV_USBHS_DEVICE_ENDPOINT_OBJ * endpointObject = NULL;
+    USB_ERROR returnValue = USB_ERROR_PARAMETER_INVALID;
+    uint8_t endpoint = endpointAndDirection & 0xF;
+    int direction = ((endpointAndDirection & 0x80) != 0);
+
+    if((object >= DRV_USBHS_INSTANCES_NUMBER) || (gDrvUSBObj[object].usbDrvCommonObj.inUse == false))
+    {
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSBHS Driver: Invalid object in DRV_USBHS_DEVICE_EndpointDMAWeightSet()");
+    }
+    else if((endpoint == 0) || (endpoint >= DRV_USBHS_ENDPOINTS_NUMBER))
+    {
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSBHS Driver: Invalid endpoint in DRV_USBHS_DEVICE_EndpointDMAWeightSet()");
+        returnValue = USB_ERROR_DEVICE_ENDPOINT_INVALID;
+    }
+    else
+    {
+        endpointObject = gDrvUSBObj[object].usbDrvCommonObj.endpointTable + (2 * endpoint) + direction;
+        endpointObject->dmaWeight = weight;
+        returnValue = USB_ERROR_NONE;
+    }
+
+    return (returnValue);
+}
+
+// *****************************************************************************
+/* Function:
+    USB_ERROR DRV_USBHS_DEVICE_EndpointDMAStatisticsGet
+    (
+        SYS_MODULE_OBJ object,
+        USB_ENDPOINT endpointAndDirection,
+        DRV_USBHS_DEVICE_DMA_STATISTICS * statistics
+    )
+
+  Summary:
+    This function returns the DMA and PIO counters of a device mode endpoint.
+
+  Description:
+    This function returns the DMA and PIO counters of a device mode endpoint.
+
+  Remarks:
+    See drv_usbhs.h for usage information.
+*/
+
+USB_ERROR DRV_USBHS_DEVICE_EndpointDMAStatisticsGet
+(
+    SYS_MODULE_OBJ object,
+    USB_ENDPOINT endpointAndDirection,
+    DRV_USBHS_DEVICE_DMA_STATISTICS * statistics
+)
+{
+    DRV_USBHS_DEVICE_ENDPOINT_OBJ * endpointObject = NULL;
+    USB_ERROR returnValue = USB_ERROR_PARAMETER_INVALID;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    uint8_t endpoint = endpointAndDirection & 0xF;
+    int direction = ((endpointAndDirection & 0x80) != 0);
+
+    if((object >= DRV_USBHS_INSTANCES_NUMBER) || (gDrvUSBObj[object].usbDrvCommonObj.inUse == false) || (statistics == NULL))
+    {
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSBHS Driver: Invalid parameter in DRV_USBHS_DEVICE_EndpointDMAStatisticsGet()");
+    }
+    else if(endpoint >= DRV_USBHS_ENDPOINTS_NUMBER)
+    {
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSBHS Driver: Invalid endpoint in DRV_USBHS_DEVICE_EndpointDMAStatisticsGet()");
+        returnValue = USB_ERROR_DEVICE_ENDPOINT_INVALID;
+    }
+    else
+    {
+        endpointObject = gDrvUSBObj[object].usbDrvCommonObj.endpointTable + (2 * endpoint) + direction;
+
+        /* The counters are updated in the USB interrupt */
+        IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+        *statistics = endpointObject->dmaStatistics;
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+        returnValue = USB_ERROR_NONE;
+    }
+
+    return (returnValue);
+}
+
+#endif
+
 // ****************************************************************************
 /* Function:
     USB_ERROR DRV_USBHS_DEVICE_TestModeEnter
@@ -3697,7 +4101,7 @@ void _DRV_USBHS_DEVICE_Tasks_ISR_USBDMA
                     PLIB_USBHS_DeviceTxEndpointPacketReady(usbID, iEndpoint);
                 }
 
-                hDriver->usbDrvCommonObj.gDrvUSBDMAPool[usbDMAChannel].inUse = false;
+                _DRV_USBHS_DEVICE_DMAChannelRelease(hDriver, usbDMAChannel);
             }
 
             /* Check if the irp is completed */
@@ -3719,6 +4123,16 @@ void _DRV_USBHS_DEVICE_Tasks_ISR_USBDMA
                 if(irp != NULL && (irp->status != USB_DEVICE_IRP_STATUS_ABORTED))
                 {
                     /* RX PATH */
+#if defined(DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED)
+                    if(hDriver->usbDrvCommonObj.gDrvUSBDMAPool[usbDMAChannel].bounceBufferUsed)
+                    {
+                        /* The data was received in a bounce buffer. Copy it
+                         * to the IRP data. */
+                        memcpy(hDriver->usbDrvCommonObj.gDrvUSBDMAPool[usbDMAChannel].bounceDestination,
+                                hDriver->usbDrvCommonObj.dmaBounceBuffers[hDriver->usbDrvCommonObj.gDrvUSBDMAPool[usbDMAChannel].bounceBufferIndex],
+                                hDriver->usbDrvCommonObj.gDrvUSBDMAPool[usbDMAChannel].count);
+                    }
+#endif
                     if(((hDriver->usbDrvCommonObj.gDrvUSBDMAPool[usbDMAChannel].count) < (endpointObjReceive->maxPacketSize)) || (irp->nPendingBytes >= irp->size))
                     {
                         /* This means we received a short packet or the amount
@@ -3739,7 +4153,7 @@ void _DRV_USBHS_DEVICE_Tasks_ISR_USBDMA
                         endpointObjReceive->irpQueue = irp->next;
 
                         /* Return DMA channel back to the pool.*/
-                        hDriver->usbDrvCommonObj.gDrvUSBDMAPool[usbDMAChannel].inUse = false;
+                        _DRV_USBHS_DEVICE_DMAChannelRelease(hDriver, usbDMAChannel);
 
                         /* Clear RXPktRDY bit in the corresponding register.
                          * Doing this will ensure that if IRP submit is called
@@ -3758,7 +4172,7 @@ void _DRV_USBHS_DEVICE_Tasks_ISR_USBDMA
                          * but the transfer is not yet complete. So we clear the
                          * RX ready flag and release the DMA channel to receive
                          * the next packet */
-                        hDriver->usbDrvCommonObj.gDrvUSBDMAPool[usbDMAChannel].inUse = false;
+                        _DRV_USBHS_DEVICE_DMAChannelRelease(hDriver, usbDMAChannel);
 
                         /* Clear RXPktRDY bit in the corresponding register */
                         PLIB_USBHS_RxEPStatusClear(usbID, iEndpoint, USBHS_RXEP_PKTRDY);
@@ -3768,7 +4182,7 @@ void _DRV_USBHS_DEVICE_Tasks_ISR_USBDMA
                 if(irp!= NULL && (irp->status == USB_DEVICE_IRP_STATUS_ABORTED))
                 {
                     /* Release the DMA channel */
-                    hDriver->usbDrvCommonObj.gDrvUSBDMAPool[usbDMAChannel].inUse = false;
+                    _DRV_USBHS_DEVICE_DMAChannelRelease(hDriver, usbDMAChannel);
 
                     /* Move IRP queue HEAD */
                     endpointObjReceive->irpQueue = irp->next;
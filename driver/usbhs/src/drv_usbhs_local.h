@@ -106,6 +106,22 @@
 
 #define DRV_USBHS_FIFO_PAGES 36
 
+#if defined(DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED)
+
+/* Number of bounce buffers that the DMA scheduler uses for transfers from and
+ * to buffers that are not 4 byte aligned */
+#if !defined(DRV_USBHS_DEVICE_DMA_BOUNCE_BUFFERS_NUMBER)
+#define DRV_USBHS_DEVICE_DMA_BOUNCE_BUFFERS_NUMBER 2
+#endif
+
+/* Size of a bounce buffer. A packet that is larger than this is transferred
+ * with PIO if its buffer is not aligned. */
+#if !defined(DRV_USBHS_DEVICE_DMA_BOUNCE_BUFFER_SIZE)
+#define DRV_USBHS_DEVICE_DMA_BOUNCE_BUFFER_SIZE 512
+#endif
+
+#endif
+
 #if ((DRV_USBHS_DEVICE_SUPPORT == true) && (DRV_USBHS_HOST_SUPPORT == true))
 #define DRV_USBHS_CLIENTS_NUMBER 2
 #else
@@ -193,6 +209,14 @@ typedef struct
     /* FIFO Start Address */
     uint16_t fifoStartAddress;
 
+#if defined(DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED)
+    /* DMA weight that was set by the application */
+    DRV_USBHS_DEVICE_DMA_WEIGHT dmaWeight;
+
+    /* DMA and PIO counters of the endpoint */
+    DRV_USBHS_DEVICE_DMA_STATISTICS dmaStatistics;
+#endif
+
 } DRV_USBHS_DEVICE_ENDPOINT_OBJ;
 
 /*********************************************
@@ -415,6 +439,17 @@ typedef struct _DRV_USBHS_DMA_POOL_STRUCT
     uint8_t iEndpoint;
     unsigned int count;
 
+#if defined(DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED)
+    /* True if the transfer uses a bounce buffer */
+    bool bounceBufferUsed;
+
+    /* Index of the bounce buffer */
+    uint8_t bounceBufferIndex;
+
+    /* IRP data to which received data is copied from the bounce buffer */
+    uint8_t * bounceDestination;
+#endif
+
 } DRV_USBHS_DMA_POOL;
 
 /*********************************************
@@ -579,6 +614,14 @@ typedef struct _DRV_USBHS_COMMON_OBJ_STRUCT
     /* Array for FIFO Allocation function */
     uint32_t fifoAllocationTable[DRV_USBHS_FIFO_PAGES];
 
+#if defined(DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED)
+    /* Pointer to the DMA bounce buffers of this instance */
+    uint8_t (* dmaBounceBuffers)[DRV_USBHS_DEVICE_DMA_BOUNCE_BUFFER_SIZE];
+
+    /* Bit map of the bounce buffers in use */
+    uint32_t dmaBounceBuffersInUse;
+#endif
+
     /* This client is operating the driver in device mode */
     DRV_USBHS_CLIENT_OBJ * deviceModeClient;
 
@@ -686,6 +729,11 @@ uint8_t _DRV_USBHS_DEVICE_Get_FreeDMAChannel
     bool endpointDir,
     uint8_t iEndpoint
 );
+void _DRV_USBHS_DEVICE_DMAChannelRelease
+(
+    DRV_USBHS_OBJ * hDriver,
+    uint8_t dmaChannel
+);
 uint8_t _DRV_USBHS_HOST_GetFreeDMAChannel
 (
     DRV_USBHS_OBJ * hDriver,
@@ -2168,6 +2168,7 @@ void PLIB_USBHS_ResetEnable (USBHS_MODULE_ID index);
 void PLIB_USBHS_ResetDisable (USBHS_MODULE_ID index);
 void PLIB_USBHS_DeviceEPFIFOLoad            (USBHS_MODULE_ID index, uint8_t endpoint, void * source, size_t nBytes);
 int  PLIB_USBHS_DeviceEPFIFOUnload          (USBHS_MODULE_ID index, uint8_t endpoint, void * dest);
+void PLIB_USBHS_DeviceEPFIFOPartialUnload   (USBHS_MODULE_ID index, uint8_t endpoint, void * dest, size_t fifoOffset, size_t nBytes);
 void PLIB_USBHS_EndpointRxRequestEnable     (USBHS_MODULE_ID index, uint8_t endpoint);
 bool PLIB_USBHS_FullOrHighSpeedIsConnected  (USBHS_MODULE_ID index);
 bool PLIB_USBHS_DMAErrorGet (USBHS_MODULE_ID index, uint8_t dmaChannel);
@@ -225,6 +225,11 @@ PLIB_INLINE_API int PLIB_USBHS_DeviceEPFIFOUnload(USBHS_MODULE_ID index, uint8_t
      return USBHS_DeviceEPFIFOUnload_Default(index, endpoint, dest);
 }
 
+PLIB_INLINE_API void PLIB_USBHS_DeviceEPFIFOPartialUnload(USBHS_MODULE_ID index, uint8_t endpoint, void* dest, size_t fifoOffset, size_t nBytes)
+{
+     USBHS_DeviceEPFIFOPartialUnload_Default(index, endpoint, dest, fifoOffset, nBytes);
+}
+
 PLIB_INLINE_API bool PLIB_USBHS_ExistsEndpointFIFO(USBHS_MODULE_ID index)
 {
      return USBHS_ExistsEndpointFIFO_Default(index);
@@ -14,6 +14,7 @@
     For following APIs :
         PLIB_USBHS_EndpointFIFOLoad
         PLIB_USBHS_EndpointFIFOUnload
+        PLIB_USBHS_DeviceEPFIFOPartialUnload
         PLIB_USBHS_Endpoint0SetupPacketLoad
         PLIB_USBHS_ExistsEndpointFIFO
 
@@ -236,6 +237,43 @@ int PLIB_TEMPLATE USBHS_DeviceEPFIFOUnload_Default
     return(count);
 }
 
+//******************************************************************************
+/* Function :  USBHS_DeviceEPFIFOPartialUnload_Default
+
+  Summary:
+    Implements Default variant of PLIB_USBHS_DeviceEPFIFOPartialUnload 
+
+  Description:
+    This template implements the Default variant of the
+    PLIB_USBHS_DeviceEPFIFOPartialUnload function.
+*/
+
+void PLIB_TEMPLATE USBHS_DeviceEPFIFOPartialUnload_Default
+( 
+    USBHS_MODULE_ID index, 
+    uint8_t endpoint, 
+    void * dest,
+    size_t fifoOffset,
+    size_t nBytes
+)
+{
+    /* This function unloads nBytes from the FIFO. fifoOffset is the number of
+     * bytes of the packet that were already unloaded. */
+
+    volatile usbhs_registers_t * usbhs = (usbhs_registers_t *)(index);
+    volatile uint8_t * fifo;
+    uint8_t * data;
+    size_t i;
+
+    fifo = (uint8_t *)(&usbhs->FIFO[endpoint]);
+    data = (uint8_t *) dest;
+
+    for(i = 0; i < nBytes; i ++)
+    {
+        data[i] = *(fifo + ((fifoOffset + i) & 3));
+    }
+}
+
 //******************************************************************************
 /* Function :  USBHS_Endpoint0SetupPacketLoad_Default
 
@@ -697,6 +697,14 @@ void _DRV_USBHSV1_HOST_ResetStateMachine(DRV_USBHSV1_OBJ * hDriver);
 void _DRV_USBHSV1_DEVICE_Initialize(DRV_USBHSV1_OBJ * drvObj, SYS_MODULE_INDEX index);
 void _DRV_USBHSV1_DEVICE_Tasks_ISR(DRV_USBHSV1_OBJ * hDriver);
 void _DRV_USBHSV1_DEVICE_Tasks_ISR_USBDMA(DRV_USBHSV1_OBJ * hDriver);
+void _DRV_USBHSV1_DEVICE_IRPDataCopy
+(
+    USB_DEVICE_IRP_LOCAL * irp,
+    unsigned int offset,
+    uint8_t * fifo,
+    unsigned int count,
+    bool toFifo
+);
 void _DRV_USBHSV1_HOST_Initialize(DRV_USBHSV1_OBJ * drvObj, SYS_MODULE_INDEX index);
 void _DRV_USBHSV1_HOST_Tasks_ISR(DRV_USBHSV1_OBJ * hDriver);
 uint8_t _DRV_USBHSV1_DEVICE_Get_FreeDMAChannel
@@ -102,7 +102,8 @@ DRV_USB_DEVICE_INTERFACE gDrvUSBHSV1DeviceInterface =
     .deviceIRPCancelAll = DRV_USBHSV1_DEVICE_IRPCancelAll,
     .deviceRemoteWakeupStop = DRV_USBHSV1_DEVICE_RemoteWakeupStop,
     .deviceRemoteWakeupStart = DRV_USBHSV1_DEVICE_RemoteWakeupStart,
-    .deviceTestModeEnter = DRV_USBHSV1_DEVICE_TestModeEnter
+    .deviceTestModeEnter = DRV_USBHSV1_DEVICE_TestModeEnter,
+    .capabilities = DRV_USB_CAPABILITY_IRP_DATA_SEGMENTS
 
 };
 
@@ -523,12 +524,25 @@ void DRV_USBHSV1_DEVICE_Detach(DRV_HANDLE handle)
 
 uint16_t DRV_USBHSV1_DEVICE_SOFNumberGet(DRV_HANDLE handle)
 {
+    DRV_USBHSV1_OBJ * hDriver;
+    usbhs_registers_t * usbID;
+    uint16_t retVal = 0;
+
     if(DRV_HANDLE_INVALID == handle)
     {
         SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB USBHSV1 Device Driver: Invalid Handle in DRV_USBHSV1_DEVICE_SOFNumberGet().");
     }
+    else
+    {
+        hDriver = (DRV_USBHSV1_OBJ *) handle;
+        usbID = hDriver->usbID;
+
+        /* Get the Frame count. In high speed, this is the number of the frame
+         * and not of the micro frame. */
+        retVal = (uint16_t)((usbID->USBHS_DEVFNUM & USBHS_DEVFNUM_FNUM_Msk) >> USBHS_DEVFNUM_FNUM_Pos);
+    }
 
-    return (0);
+    return (retVal);
 
 }/* end of DRV_USBHSV1_DEVICE_SOFNumberGet() */
 
@@ -637,6 +651,99 @@ void _DRV_USBHSV1_DEVICE_EndpointObjectEnable
 
 // *****************************************************************************
 
+/* Function:
+    void _DRV_USBHSV1_DEVICE_IRPDataCopy
+    (
+        USB_DEVICE_IRP_LOCAL * irp,
+        unsigned int offset,
+        uint8_t * fifo,
+        unsigned int count,
+        bool toFifo
+    )
+
+  Summary:
+    Copies data between the IRP data and the endpoint FIFO.
+
+  Description:
+    This function copies count bytes between the endpoint FIFO and the IRP data,
+    starting at offset in the IRP data. If the IRP was submitted with the
+    USB_DEVICE_IRP_FLAG_DATA_SEGMENTS flag, the IRP data is an array of
+    segments and the copy continues across segment boundaries. The data is
+    copied to the FIFO if toFifo is true and from the FIFO otherwise.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+ */
+
+void _DRV_USBHSV1_DEVICE_IRPDataCopy
+(
+    USB_DEVICE_IRP_LOCAL * irp,
+    unsigned int offset,
+    uint8_t * fifo,
+    unsigned int count,
+    bool toFifo
+)
+{
+    USB_IRP_DATA_SEGMENT * segment = NULL;  /* Segment being copied */
+    uint8_t * data = NULL;                  /* Pointer in the segment data */
+    unsigned int chunk = 0;                 /* Bytes left in the segment */
+    unsigned int index;                     /* Loop Counter */
+
+    if((irp->flags & USB_DEVICE_IRP_FLAG_DATA_SEGMENTS) == 0)
+    {
+        /* The IRP data is one contiguous buffer */
+        data = (uint8_t *)irp->data + offset;
+        chunk = count;
+    }
+    else if(count > 0)
+    {
+        /* Find the segment that contains the offset */
+        segment = (USB_IRP_DATA_SEGMENT *)irp->data;
+        while(offset >= segment->size)
+        {
+            offset -= segment->size;
+            segment ++;
+        }
+
+        data = (uint8_t *)segment->data + offset;
+        chunk = segment->size - offset;
+    }
+
+    while(count > 0)
+    {
+        if(chunk > count)
+        {
+            chunk = count;
+        }
+
+        for(index = 0; index < chunk; index++)
+        {
+            if(toFifo)
+            {
+                *fifo++ = *data++;
+            }
+            else
+            {
+                *data++ = *fifo++;
+            }
+        }
+
+        count -= chunk;
+
+        if((count > 0) && (segment != NULL))
+        {
+            /* Continue with the next segment */
+            segment ++;
+            data = (uint8_t *)segment->data;
+            chunk = segment->size;
+        }
+    }
+
+}/* end of _DRV_USBHSV1_DEVICE_IRPDataCopy() */
+
+// *****************************************************************************
+
 /* Function:
     USB_ERROR DRV_USBHSV1_DEVICE_EndpointEnable
     (
@@ -1479,6 +1586,13 @@ USB_ERROR DRV_USBHSV1_DEVICE_IRPSubmit
             /* This means the endpoint is not enabled */
             retVal = USB_ERROR_ENDPOINT_NOT_CONFIGURED;
         }
+        else if((endpoint == 0) && ((irp->flags & USB_DEVICE_IRP_FLAG_DATA_SEGMENTS) != 0))
+        {
+            /* Data segments are not supported on endpoint 0 */
+            SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB USBHSV1 Device Driver: Data segments are not supported on endpoint 0 in DRV_USBHSV1_DEVICE_IRPSubmit().");
+
+            retVal = USB_ERROR_PARAMETER_INVALID;
+        }
         else
         {
             /* Check the size of the IRP. If the endpoint receives data from
@@ -1877,14 +1991,7 @@ USB_ERROR DRV_USBHSV1_DEVICE_IRPSubmit
                         /* Copy data to the FIFO */
                         ptr = (uint8_t *) & ((volatile uint8_t (*)[0x8000])USBHSV1_RAM_ADDR)[endpoint];
 
-                        data = (uint8_t *)irp->data;
-
-                        for(count = 0; count < byteCount; count++)
-                        {
-                            *ptr++ = *((uint8_t *)(data + count));
-                        }
-
-                        ptr = (uint8_t *) & ((volatile uint8_t (*)[0x8000])USBHSV1_RAM_ADDR)[endpoint];
+                        _DRV_USBHSV1_DEVICE_IRPDataCopy(irp, 0, ptr, byteCount, true);
 
                         SCB_CleanDCache_by_Addr((uint32_t *) ptr, byteCount);
 
@@ -1916,14 +2023,9 @@ USB_ERROR DRV_USBHSV1_DEVICE_IRPSubmit
                                 byteCount = irp->size - irp->nPendingBytes;
                             }
 
-                            data = (uint8_t *)irp->data;
-
                             SCB_InvalidateDCache_by_Addr((uint32_t *) ptr, byteCount);
 
-                            for(count = 0; count < byteCount; count++)
-                            {
-                                *((uint8_t *)(data + count)) = *ptr++;
-                            }
+                            _DRV_USBHSV1_DEVICE_IRPDataCopy(irp, irp->nPendingBytes, ptr, byteCount, false);
 
                             /* Update the pending byte count */
                             irp->nPendingBytes += byteCount;
@@ -2745,13 +2847,9 @@ void _DRV_USBHSV1_DEVICE_Tasks_ISR(DRV_USBHSV1_OBJ * hDriver)
 
                     byteCount = (usbID->USBHS_DEVEPTISR[endpointIndex] & USBHS_DEVEPTISR_BYCT_Msk) >> USBHS_DEVEPTISR_BYCT_Pos;
 
-                    data = (uint8_t *) irp->data;
-
                     /* Get 8-bit access to endpoint 0 FIFO from USB RAM address */
                     ptr = (uint8_t *) & ((volatile uint8_t (*)[0x8000])USBHSV1_RAM_ADDR)[endpointIndex];
 
-                    data = (uint8_t *)&data[irp->nPendingBytes];
-
                     if((irp->nPendingBytes + byteCount) > irp->size)
                     {
                         byteCount = irp->size - irp->nPendingBytes;
@@ -2759,10 +2857,7 @@ void _DRV_USBHSV1_DEVICE_Tasks_ISR(DRV_USBHSV1_OBJ * hDriver)
 
                     SCB_InvalidateDCache_by_Addr((uint32_t *) ptr, byteCount);
 
-                    for(count = 0; count < byteCount; count++)
-                    {
-                        *((uint8_t *)(data + count)) = *ptr++;
-                    }
+                    _DRV_USBHSV1_DEVICE_IRPDataCopy(irp, irp->nPendingBytes, ptr, byteCount, false);
 
                     irp->nPendingBytes += byteCount;
 
@@ -2829,20 +2924,11 @@ void _DRV_USBHSV1_DEVICE_Tasks_ISR(DRV_USBHSV1_OBJ * hDriver)
                             byteCount = irp->nPendingBytes;
                         }
 
-                        data = (uint8_t *) irp->data;
-
                         offset = irp->size - irp->nPendingBytes;
 
                         ptr = (uint8_t *) & ((volatile uint8_t (*)[0x8000])USBHSV1_RAM_ADDR)[endpointIndex];
 
-                        data = (uint8_t *)&data[offset];
-
-                        for(count = 0; count < byteCount; count++)
-                        {
-                            *ptr++ = *((uint8_t *)(data + count));
-                        }
-
-                        ptr = (uint8_t *) & ((volatile uint8_t (*)[0x8000])USBHSV1_RAM_ADDR)[endpointIndex];
+                        _DRV_USBHSV1_DEVICE_IRPDataCopy(irp, offset, ptr, byteCount, true);
 
                         SCB_CleanDCache_by_Addr((uint32_t *) ptr, byteCount);
 
@@ -2885,20 +2971,11 @@ void _DRV_USBHSV1_DEVICE_Tasks_ISR(DRV_USBHSV1_OBJ * hDriver)
                                     byteCount = endpointObjNonZero->maxPacketSize;
                                 }
 
-                                data = (uint8_t *) irp->data;
-
                                 offset = irp->size - irp->nPendingBytes;
 
                                 ptr = (uint8_t *) & ((volatile uint8_t (*)[0x8000])USBHSV1_RAM_ADDR)[endpointIndex];
 
-                                data = (uint8_t *)&data[offset];
-
-                                for(count = 0; count < byteCount; count++)
-                                {
-                                    *ptr++ = *((uint8_t *)(data + count));
-                                }
-
-                                ptr = (uint8_t *) & ((volatile uint8_t (*)[0x8000])USBHSV1_RAM_ADDR)[endpointIndex];
+                                _DRV_USBHSV1_DEVICE_IRPDataCopy(irp, offset, ptr, byteCount, true);
 
                                 SCB_CleanDCache_by_Addr((uint32_t *) ptr, byteCount);
 
@@ -93,10 +93,35 @@ typedef enum
     SCSI_READ_10        = 0x28,
     SCSI_WRITE_10       = 0x2A,
     SCSI_STOP_START     = 0x1B,
-    SCSI_VERIFY         = 0x2F
+    SCSI_VERIFY         = 0x2F,
+    SCSI_SYNCHRONIZE_CACHE = 0x35,
+    SCSI_READ_16        = 0x88,
+    SCSI_WRITE_16       = 0x8A,
+    SCSI_SERVICE_ACTION_IN_16 = 0x9E
 
 } SCSI_BLOCK_COMMAND;
 
+// *****************************************************************************
+/* SCSI Service Action In (16) Service Actions
+
+  Summary:
+    Identifies the supported service actions of the SERVICE ACTION IN (16)
+    command.
+
+  Description:
+    Identifies the supported service actions of the SERVICE ACTION IN (16)
+    command.
+
+  Remarks:
+    None.
+*/
+
+typedef enum
+{
+    SCSI_SERVICE_ACTION_READ_CAPACITY_16 = 0x10
+
+} SCSI_SERVICE_ACTION_IN_16_ACTION;
+
 // *****************************************************************************
 /* Supported SCSI Multimedia Commands
 
@@ -143,7 +168,8 @@ typedef enum
     SCSI_ASC_LUN_NOT_READY_INTERVENTION_REQD       = 0x04,
     SCSI_ASC_LUN_NOT_READY_FORMATTING              = 0x04,
     SCSI_ASC_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE    = 0x21,
-    SCSI_ASC_WRITE_PROTECTED                       = 0x27
+    SCSI_ASC_WRITE_PROTECTED                       = 0x27,
+    SCSI_ASC_WRITE_ERROR                           = 0x0C
 
 } SCSI_ASC;
 
@@ -174,7 +200,8 @@ typedef enum
     SCSI_ASCQ_LUN_NOT_READY_INTERVENTION_REQD      = 0x03,
     SCSI_ASCQ_LUN_NOT_READY_FORMATTING             = 0x04,
     SCSI_ASCQ_LOGICAL_BLOCK_ADDRESS_OUT_OF_RANGE   = 0x00,
-    SCSI_ASCQ_WRITE_PROTECTED                      = 0x00
+    SCSI_ASCQ_WRITE_PROTECTED                      = 0x00,
+    SCSI_ASCQ_WRITE_ERROR                          = 0x00
 
 } SCSI_ASCQ;
 
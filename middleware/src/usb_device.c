@@ -186,10 +186,39 @@ SYS_MODULE_OBJ USB_DEVICE_Initialize
     usbDeviceThisInstance->driverIndex = deviceInit->driverIndex;
 
     /* Initialize Endpoint Q size */ 
-    _USB_DEVICE_Initialize_Endpoint_Q(index, deviceInit->queueSizeEndpointRead, deviceInit->queueSizeEndpointWrite);
+    if(!_USB_DEVICE_Initialize_Endpoint_Q(index, deviceInit->queueSizeEndpointRead, deviceInit->queueSizeEndpointWrite))
+    {
+        /* The endpoint queue sizes of all instances must fit in
+         * USB_DEVICE_ENDPOINT_QUEUE_DEPTH_COMBINED */
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: Endpoint queue sizes are not valid");
+        usbDeviceThisInstance->usbDeviceInstanceState = SYS_STATUS_ERROR;
+        return (SYS_MODULE_OBJ_INVALID);
+    }
 
-    /* Create Mutex for Endpoint Read Write */
-    _USB_DEVICE_EndpointMutexCreate (usbDeviceThisInstance);
+#if defined(USB_DEVICE_IRP_POOL_SIZE)
+    /* Initialize the IRP pool that is shared by all function drivers of this
+     * instance. This must be done before the function drivers are
+     * initialized. */
+    _USB_DEVICE_IRPPoolInitialize(&usbDeviceThisInstance->functionDriverIRPPool,
+            usbDeviceThisInstance->functionDriverIRP,
+            usbDeviceThisInstance->functionDriverIRPFreeStack,
+            usbDeviceThisInstance->functionDriverIRPIsFree,
+            USB_DEVICE_IRP_POOL_SIZE, (uint16_t)(index * USB_DEVICE_IRP_POOL_SIZE));
+#endif
+
+#if defined(USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER)
+    /* Clear the endpoint statistics and the IRP tracking table */
+    memset(usbDeviceThisInstance->endpointStatistics, 0, sizeof(usbDeviceThisInstance->endpointStatistics));
+    memset(usbDeviceThisInstance->statisticsIRP, 0, sizeof(usbDeviceThisInstance->statisticsIRP));
+#endif
+
+#if defined(USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER)
+    /* Free all the bounce buffers */
+    for(count = 0; count < USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER; count ++)
+    {
+        usbDeviceThisInstance->irpBounce[count].irp = NULL;
+    }
+#endif
 
     funcRegTable    = usbDeviceThisInstance->registeredFuncDrivers;
 
@@ -503,6 +532,13 @@ void USB_DEVICE_EndpointStall
     {
         /* Stall the endpoint */
         usbClientHandle->driverInterface->deviceEndpointStall(usbClientHandle->usbCDHandle, endpoint); 
+
+#if defined(USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER)
+        if((endpoint & 0x0F) < USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER)
+        {
+            usbClientHandle->endpointStatistics[endpoint & 0x0F][(endpoint >> 7) & 0x1].stalls ++;
+        }
+#endif
     }
 }
 
@@ -1393,203 +1429,1100 @@ void USB_DEVICE_RemoteWakeupStop( USB_DEVICE_HANDLE handle )
 
 // *****************************************************************************
 /* Function:
-    void USB_DEVICE_RemoteWakeupStart( USB_DEVICE_HANDLE usbDeviceHandle )
+    void USB_DEVICE_RemoteWakeupStart( USB_DEVICE_HANDLE usbDeviceHandle )
+
+  Summary:
+    This function will start the resume signalling.
+
+  Description:
+    This function will start the resume signalling on the bus. The client calls
+    this function after it has detected a idle bus (through the
+    USB_DEVICE_EVENT_SUSPENDED event). The remote wakeup feature should have
+    been enabled by the host, before the client can call this function. The
+    client can use the USB_DEVICE_RemoteWakeupStatusGet() function to check if
+    the host has enabled the remote wakeup feature.
+
+  Remarks:
+    Refer to usb_device.h for usage information.
+*/
+
+void USB_DEVICE_RemoteWakeupStart( USB_DEVICE_HANDLE usbDeviceHandle )
+{
+    USB_DEVICE_OBJ * usbDeviceThisInstance;
+
+    /* Validate the device handle */
+    usbDeviceThisInstance = _USB_DEVICE_ClientHandleValidate(usbDeviceHandle);
+    if(NULL == usbDeviceThisInstance)
+    {
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer Client Handle is invalid");
+        return;
+    }
+
+    /* Call the driver remote wake up function here */
+    usbDeviceThisInstance->driverInterface->deviceRemoteWakeupStart(usbDeviceThisInstance->usbCDHandle);
+}
+// *****************************************************************************
+// *****************************************************************************
+// Section: USB Device Layer System Interface functions.
+// *****************************************************************************
+// *****************************************************************************
+
+// *****************************************************************************
+/* Function:
+    USB_ERROR USB_DEVICE_IRPSubmit
+    (
+        USB_DEVICE_HANDLE usbDeviceHandle, 
+        USB_ENDPOINT endpointAndDirection, 
+        USB_DEVICE_IRP * irp
+    );
+    
+  Summary:
+    This function submits an I/O Request Packet (IRP) for processing to the
+    Hi-Speed USB Driver.
+	
+  Description:
+    This function submits an I/O Request Packet (IRP) for processing to the USB
+    Driver. The IRP allows a client to send and receive data from the USB Host.
+    The data will be sent or received through the specified endpoint. The direction
+    of the data transfer is indicated by the direction flag in the
+    endpointAndDirection parameter. Submitting an IRP arms the endpoint to
+    either send data to or receive data from the Host.  If an IRP is already
+    being processed on the endpoint, the subsequent IRP submit operation
+    will be queued. The contents of the IRP (including the application buffers)
+    should not be changed until the IRP has been processed.
+	
+  Remarks:
+    Refer to usb_device_function_driver.h for usage information.                                                                          
+*/
+
+USB_ERROR USB_DEVICE_IRPSubmit
+(
+    USB_DEVICE_HANDLE usbDeviceHandle, 
+    USB_ENDPOINT endpointAndDirection, 
+    USB_DEVICE_IRP * irp
+)
+{
+    USB_DEVICE_OBJ* usbClientHandle;
+    USB_ERROR result;
+#if defined(USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER)
+    USB_DEVICE_ENDPOINT_STATISTICS * statistics = NULL;
+    USB_DEVICE_STATISTICS_IRP_ENTRY * entry = NULL;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    unsigned int count;
+#endif
+    
+    /* Validate the handle */
+    usbClientHandle = _USB_DEVICE_ClientHandleValidate(usbDeviceHandle );
+
+    if(usbClientHandle == NULL)
+    {
+       /* Handle is not valid */
+       SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: Invalid handle");
+       result = USB_ERROR_PARAMETER_INVALID; 
+    }
+    else if(((irp->flags & USB_DEVICE_IRP_FLAG_DATA_SEGMENTS) != 0) &&
+            ((usbClientHandle->driverInterface->capabilities & DRV_USB_CAPABILITY_IRP_DATA_SEGMENTS) == 0))
+    {
+#if defined(USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER)
+        /* The driver cannot process data segments. The data is copied through
+         * a bounce buffer. */
+        result = _USB_DEVICE_IRPBounceSubmit(usbClientHandle, usbDeviceHandle, endpointAndDirection, irp);
+#else
+        /* The driver cannot process data segments */
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: Data segments are not supported by the driver");
+        result = USB_ERROR_PARAMETER_INVALID;
+#endif
+    }
+    else
+    {
+#if defined(USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER)
+        if((endpointAndDirection & 0x0F) < USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER)
+        {
+            statistics = &usbClientHandle->endpointStatistics[endpointAndDirection & 0x0F][(endpointAndDirection >> 7) & 0x1];
+
+            /* The IRP may complete in the USB interrupt before the driver
+             * submit function returns. The IRP must therefore be tracked
+             * before it is submitted. */
+            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+            for(count = 0; count < USB_DEVICE_STATISTICS_IRPS_NUMBER; count ++)
+            {
+                if(usbClientHandle->statisticsIRP[count].irp == NULL)
+                {
+                    entry = &usbClientHandle->statisticsIRP[count];
+                    entry->irp = irp;
+                    entry->callback = irp->callback;
+                    entry->layerData = irp->layerData;
+                    entry->instanceIndex = (unsigned int)(usbClientHandle - usbDeviceInstance);
+                    entry->endpoint = endpointAndDirection;
+                    entry->timeStamp = _USB_DEVICE_StatisticsTimeStampGet(usbClientHandle);
+                    irp->callback = &_USB_DEVICE_StatisticsIRPCallback;
+                    irp->layerData = entry;
+
+                    statistics->pending ++;
+                    if(statistics->pending > statistics->pendingHighWaterMark)
+                    {
+                        statistics->pendingHighWaterMark = statistics->pending;
+                    }
+                    break;
+                }
+            }
+
+            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+        }
+#endif
+
+         /* Submit IRP */
+        result = usbClientHandle->driverInterface->deviceIRPSubmit(usbClientHandle->usbCDHandle,endpointAndDirection, irp ); 
+
+#if defined(USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER)
+        if(statistics != NULL)
+        {
+            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+            if(result == USB_ERROR_NONE)
+            {
+                statistics->irps ++;
+
+                if(entry == NULL)
+                {
+                    /* The tracking table was full */
+                    statistics->untracked ++;
+                }
+            }
+            else if(entry != NULL)
+            {
+                /* The IRP was not accepted. Stop tracking it and give the
+                 * client its callback back. */
+                irp->callback = entry->callback;
+                irp->layerData = entry->layerData;
+                entry->irp = NULL;
+                statistics->pending --;
+            }
+
+            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+        }
+#endif
+    }
+    
+    return result; 
+}
+
+// *****************************************************************************
+/* Function:
+    bool USB_DEVICE_IRPDataSegmentsIsSupported
+    (
+        USB_DEVICE_HANDLE usbDeviceHandle
+    );
+    
+  Summary:
+    This function returns true if the driver supports IRPs with data segments.
+	
+  Description:
+    This function returns true if the driver supports IRPs with data segments.
+	
+  Remarks:
+    Refer to usb_device_function_driver.h for usage information.
+*/
+
+bool USB_DEVICE_IRPDataSegmentsIsSupported
+(
+    USB_DEVICE_HANDLE usbDeviceHandle
+)
+{
+    USB_DEVICE_OBJ* usbClientHandle;
+    bool result = false;
+
+    /* Validate the handle */
+    usbClientHandle = _USB_DEVICE_ClientHandleValidate(usbDeviceHandle );
+
+    if(usbClientHandle == NULL)
+    {
+       /* Handle is not valid */
+       SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: Invalid handle");
+    }
+    else if((usbClientHandle->driverInterface->capabilities & DRV_USB_CAPABILITY_IRP_DATA_SEGMENTS) != 0)
+    {
+        result = true;
+    }
+
+    return result;
+}
+
+#if defined(USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER)
+
+// *****************************************************************************
+/* Function:
+    void _USB_DEVICE_IRPBounceCopy
+    (
+        USB_IRP_DATA_SEGMENT * segment,
+        uint8_t * buffer,
+        unsigned int size,
+        bool toBuffer
+    )
+
+  Summary:
+    Copies data between the segments of an IRP and a bounce buffer.
+
+  Description:
+    This function copies size bytes between the segment array and the bounce
+    buffer. The segments are used in array order. The data is copied to the
+    bounce buffer if toBuffer is true and to the segments otherwise.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static void _USB_DEVICE_IRPBounceCopy
+(
+    USB_IRP_DATA_SEGMENT * segment,
+    uint8_t * buffer,
+    unsigned int size,
+    bool toBuffer
+)
+{
+    unsigned int chunk;
+
+    while(size > 0)
+    {
+        chunk = (segment->size < size) ? segment->size : size;
+
+        if(toBuffer)
+        {
+            memcpy(buffer, segment->data, chunk);
+        }
+        else
+        {
+            memcpy(segment->data, buffer, chunk);
+        }
+
+        buffer += chunk;
+        size -= chunk;
+        segment ++;
+    }
+}
+
+// *****************************************************************************
+/* Function:
+    USB_ERROR _USB_DEVICE_IRPBounceSubmit
+    (
+        USB_DEVICE_OBJ * usbDeviceThisInstance,
+        USB_DEVICE_HANDLE usbDeviceHandle,
+        USB_ENDPOINT endpointAndDirection,
+        USB_DEVICE_IRP * irp
+    )
+
+  Summary:
+    Submits an IRP with data segments through a bounce buffer.
+
+  Description:
+    This function is called when an IRP with data segments is submitted and
+    the USB controller driver does not support data segments. It assigns a
+    free bounce buffer to the IRP, copies the data to be sent to the bounce
+    buffer and submits the IRP with the bounce buffer as its data. The IRP
+    callback is replaced with _USB_DEVICE_IRPBounceCallback, which copies the
+    received data to the segments and gives the IRP back to the client.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+USB_ERROR _USB_DEVICE_IRPBounceSubmit
+(
+    USB_DEVICE_OBJ * usbDeviceThisInstance,
+    USB_DEVICE_HANDLE usbDeviceHandle,
+    USB_ENDPOINT endpointAndDirection,
+    USB_DEVICE_IRP * irp
+)
+{
+    USB_DEVICE_IRP_BOUNCE_ENTRY * entry = NULL;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    USB_ERROR result;
+    unsigned int count;
+
+    if(irp->size > USB_DEVICE_IRP_BOUNCE_BUFFER_SIZE)
+    {
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: IRP with data segments is larger than the bounce buffer");
+        return USB_ERROR_IRP_SIZE_INVALID;
+    }
+
+    /* Grab a free bounce buffer */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+    for(count = 0; count < USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER; count ++)
+    {
+        if(usbDeviceThisInstance->irpBounce[count].irp == NULL)
+        {
+            entry = &usbDeviceThisInstance->irpBounce[count];
+            entry->irp = irp;
+            break;
+        }
+    }
+
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+    if(entry == NULL)
+    {
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: No bounce buffer is free for the IRP with data segments");
+        return USB_ERROR_IRP_OBJECTS_UNAVAILABLE;
+    }
+
+    entry->callback = irp->callback;
+    entry->segments = (USB_IRP_DATA_SEGMENT *)irp->data;
+    entry->flags = irp->flags;
+    entry->layerData = irp->layerData;
+    entry->endpoint = endpointAndDirection;
+
+    if((endpointAndDirection & 0x80) != 0)
+    {
+        /* Data is sent to the host. Gather the segments. */
+        _USB_DEVICE_IRPBounceCopy(entry->segments, entry->buffer, irp->size, true);
+    }
+
+    irp->data = entry->buffer;
+    irp->flags = (USB_DEVICE_IRP_FLAG)(irp->flags & ~USB_DEVICE_IRP_FLAG_DATA_SEGMENTS);
+    irp->callback = &_USB_DEVICE_IRPBounceCallback;
+    irp->layerData = entry;
+
+    /* The IRP no longer has data segments and is submitted as usual */
+    result = USB_DEVICE_IRPSubmit(usbDeviceHandle, endpointAndDirection, irp);
+
+    if(result != USB_ERROR_NONE)
+    {
+        /* Give the client its IRP back */
+        irp->data = entry->segments;
+        irp->flags = entry->flags;
+        irp->callback = entry->callback;
+        irp->layerData = entry->layerData;
+        entry->irp = NULL;
+    }
+
+    return result;
+}
+
+// ******************************************************************************
+/* Function:
+    void _USB_DEVICE_IRPBounceCallback( USB_DEVICE_IRP * irp )
+
+  Summary:
+    IRP callback that releases the bounce buffer of an IRP.
+
+  Description:
+    This callback replaces the client callback of every IRP that is submitted
+    through a bounce buffer. It finds the bounce buffer through the layerData
+    member of the IRP, copies the received data to the segments, restores the
+    client members of the IRP, releases the bounce buffer and then calls the
+    client callback. The client callback can therefore submit
+    the IRP again.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application. This function is called in the USB interrupt context.
+*/
+
+void _USB_DEVICE_IRPBounceCallback( USB_DEVICE_IRP * irp )
+{
+    USB_DEVICE_IRP_BOUNCE_ENTRY * entry;
+    void (*callback)(USB_DEVICE_IRP * irp) = NULL;
+
+    /* The IRP points to its bounce buffer */
+    entry = (USB_DEVICE_IRP_BOUNCE_ENTRY *)(irp->layerData);
+
+    if((entry != NULL) && (entry->irp == irp))
+    {
+        if(((entry->endpoint & 0x80) == 0) &&
+                ((irp->status == USB_DEVICE_IRP_STATUS_COMPLETED) ||
+                (irp->status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT)))
+        {
+            /* Data was received from the host. Scatter it to the segments. */
+            _USB_DEVICE_IRPBounceCopy(entry->segments, entry->buffer, irp->size, false);
+        }
+
+        /* Give the IRP back to the client */
+        irp->data = entry->segments;
+        irp->flags = entry->flags;
+        irp->layerData = entry->layerData;
+        callback = entry->callback;
+        irp->callback = callback;
+        entry->irp = NULL;
+    }
+
+    if(callback != NULL)
+    {
+        callback(irp);
+    }
+}
+
+#endif
+
+// *****************************************************************************
+/* Function:
+    uint16_t USB_DEVICE_SOFNumberGet
+    (
+        USB_DEVICE_HANDLE usbDeviceHandle
+    );
+    
+  Summary:
+    This function returns the current SOF frame number.
+	
+  Description:
+    This function returns the frame number of the last SOF received by the
+    USB controller driver of the device layer.
+	
+  Remarks:
+    Refer to usb_device_function_driver.h for usage information.
+*/
+
+uint16_t USB_DEVICE_SOFNumberGet
+(
+    USB_DEVICE_HANDLE usbDeviceHandle
+)
+{
+    USB_DEVICE_OBJ* usbClientHandle;
+    uint16_t result = 0;
+
+    /* Validate the handle */
+    usbClientHandle = _USB_DEVICE_ClientHandleValidate(usbDeviceHandle );
+
+    if(usbClientHandle == NULL)
+    {
+       /* Handle is not valid */
+       SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: Invalid handle");
+    }
+    else
+    {
+        result = usbClientHandle->driverInterface->deviceSOFNumberGet(usbClientHandle->usbCDHandle);
+    }
+
+    return result;
+}
+
+// **************************************************************************
+/* Function:
+    USB_ERROR USB_DEVICE_IRPCancelAll 
+    (
+        USB_DEVICE_HANDLE usbDeviceHandle,
+        USB_ENDPOINT endpointAndDirection
+    );
+    
+  Summary:
+    This function cancels all IRPs that are queued and in progress at the
+    specified endpoint.
+	
+  Description:
+    This function cancels all IRPs that are queued and in progress at the
+    specified endpoint.
+	
+  Remarks:
+    Refer to usb_device_function_driver.h for usage information.                                                               
+*/
+
+USB_ERROR USB_DEVICE_IRPCancelAll 
+(
+    USB_DEVICE_HANDLE usbDeviceHandle,
+    USB_ENDPOINT endpointAndDirection
+)
+{
+    USB_DEVICE_OBJ* usbClientHandle;
+    USB_ERROR result; 
+
+    /* Validate the handle */
+    usbClientHandle = _USB_DEVICE_ClientHandleValidate(usbDeviceHandle );
+
+    if(usbClientHandle == NULL)
+    {
+       /* Handle is not valid */
+       SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: Invalid handle");
+       result = USB_ERROR_PARAMETER_INVALID; 
+    }
+    else
+    {
+        /* Cancel all IRPs pending on the Endpoint */
+        result = usbClientHandle->driverInterface->deviceIRPCancelAll(usbClientHandle->usbCDHandle,endpointAndDirection); 
+    }
+    
+    return result;  
+}
+
+// **************************************************************************
+/* Function:
+    USB_ERROR USB_DEVICE_IRPCancel
+	(
+		USB_DEVICE_HANDLE usbDeviceHandle,
+		USB_DEVICE_IRP * irp
+	)
+    
+  Summary:
+    This function cancels the specific IRP that are queued and in progress at the
+    specified endpoint.
+	
+  Description:
+    This function attempts to cancel the processing of a queued IRP. An IRP that
+    was in the queue but yet to be processed will be cancelled successfully and
+    the IRP callback function will be called from this function with the
+    USB_DEVICE_IRP_STATUS_ABORTED status. The application can release the data
+    buffer memory used by the IRP when this callback occurs.  If the IRP was in
+    progress (a transaction in on the bus) when the cancel function was called,
+    the IRP will be canceled only when an ongoing or the next transaction has
+    completed. The IRP callback function will then be called in an interrupt
+    context. The application should not release the related data buffer unless
+    the IRP callback has occurred.
+	
+  Remarks:
+    Refer to usb_device_function_driver.h for usage information.
+                                                                  
+*/
+
+USB_ERROR USB_DEVICE_IRPCancel
+(
+    USB_DEVICE_HANDLE usbDeviceHandle, 
+    USB_DEVICE_IRP * irp
+)
+{
+    USB_DEVICE_OBJ* usbClientHandle;
+    USB_ERROR result;
+
+    /* Validate the handle */
+    usbClientHandle = _USB_DEVICE_ClientHandleValidate(usbDeviceHandle );
+
+    if(usbClientHandle == NULL)
+    {
+       /* Handle is not valid */
+       SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: Invalid handle");
+       result = USB_ERROR_PARAMETER_INVALID; 
+    }
+    else
+    {
+        /* Cancel IRP */
+        result = usbClientHandle->driverInterface->deviceIRPCancel(usbClientHandle->usbCDHandle,irp); 
+        
+    }
+  
+    return result; 
+}
+// *****************************************************************************
+// *****************************************************************************
+// Section: USB Device IRP Pool Functions
+// *****************************************************************************
+// *****************************************************************************
+
+// ******************************************************************************
+/* Function:
+    void _USB_DEVICE_IRPPoolInitialize
+    (
+        USB_DEVICE_IRP_POOL * irpPool,
+        USB_DEVICE_IRP * irp,
+        uint16_t * freeStack,
+        bool * isFree,
+        uint16_t size,
+        uint16_t indexOffset
+    )
+
+  Summary:
+    Initializes an IRP pool.
+
+  Description:
+    This function initializes the IRP pool and places all IRPs of the pool on
+    the free stack.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+void _USB_DEVICE_IRPPoolInitialize
+(
+    USB_DEVICE_IRP_POOL * irpPool,
+    USB_DEVICE_IRP * irp,
+    uint16_t * freeStack,
+    bool * isFree,
+    uint16_t size,
+    uint16_t indexOffset
+)
+{
+    uint16_t count;
+
+    irpPool->irp = irp;
+    irpPool->freeStack = freeStack;
+    irpPool->isFree = isFree;
+    irpPool->size = size;
+    irpPool->indexOffset = indexOffset;
+
+    for(count = 0; count < size; count ++)
+    {
+        irp[count].status = USB_DEVICE_IRP_STATUS_COMPLETED;
+        freeStack[count] = count;
+        isFree[count] = true;
+    }
+
+    irpPool->freeCount = size;
+    irpPool->freeCountLowWaterMark = size;
+}
+
+// ******************************************************************************
+/* Function:
+    USB_DEVICE_IRP * _USB_DEVICE_IRPPoolAllocate
+    (
+        USB_DEVICE_IRP_POOL * irpPool,
+        volatile unsigned int * currentQueueSize,
+        unsigned int queueSize
+    )
+
+  Summary:
+    Allocates an IRP from an IRP pool.
+
+  Description:
+    This function pops a free IRP from the pool. The queue size of the caller
+    is checked and updated in the same critical section, so that the queue
+    size acts as the quota of the caller in the pool. The function returns
+    NULL if the quota is used up or if the pool is empty.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+USB_DEVICE_IRP * _USB_DEVICE_IRPPoolAllocate
+(
+    USB_DEVICE_IRP_POOL * irpPool,
+    volatile unsigned int * currentQueueSize,
+    unsigned int queueSize
+)
+{
+    USB_DEVICE_IRP * irp = NULL;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+
+    /* Prevent other tasks and the IRP callbacks pre-empting this sequence of
+     * code */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+    if((*currentQueueSize < queueSize) && (irpPool->freeCount > 0))
+    {
+        irpPool->freeCount --;
+        irp = &irpPool->irp[irpPool->freeStack[irpPool->freeCount]];
+        irpPool->isFree[irpPool->freeStack[irpPool->freeCount]] = false;
+        (*currentQueueSize) ++;
+
+        if(irpPool->freeCount < irpPool->freeCountLowWaterMark)
+        {
+            irpPool->freeCountLowWaterMark = irpPool->freeCount;
+        }
+    }
+
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+    return(irp);
+}
+
+// ******************************************************************************
+/* Function:
+    void _USB_DEVICE_IRPPoolRelease
+    (
+        USB_DEVICE_IRP_POOL * irpPool,
+        USB_DEVICE_IRP * irp,
+        volatile unsigned int * currentQueueSize
+    )
+
+  Summary:
+    Returns an IRP to an IRP pool.
+
+  Description:
+    This function pushes the IRP back on the free stack of the pool and
+    reduces the queue size of the caller. This function is called from the IRP
+    callback or when an IRP could not be submitted. An IRP that is already
+    free is not pushed again, as this would hand out the same IRP twice to the
+    function drivers that share the pool.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+void _USB_DEVICE_IRPPoolRelease
+(
+    USB_DEVICE_IRP_POOL * irpPool,
+    USB_DEVICE_IRP * irp,
+    volatile unsigned int * currentQueueSize
+)
+{
+    uint16_t irpIndex;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+
+    irpIndex = (uint16_t)(irp - irpPool->irp);
+
+    /* Prevent other tasks pre-empting this sequence of code */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+    if(irpPool->isFree[irpIndex])
+    {
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+        SYS_ASSERT(false, "USB Device Layer: IRP released twice");
+        return;
+    }
+
+    if(irpPool->freeCount < irpPool->size)
+    {
+        irpPool->isFree[irpIndex] = true;
+        irpPool->freeStack[irpPool->freeCount] = irpIndex;
+        irpPool->freeCount ++;
+    }
+
+    if(*currentQueueSize > 0)
+    {
+        (*currentQueueSize) --;
+    }
+
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+}
+
+// ******************************************************************************
+/* Function:
+    bool _USB_DEVICE_IRPPoolContains
+    (
+        USB_DEVICE_IRP_POOL * irpPool,
+        USB_DEVICE_IRP * irp
+    )
+
+  Summary:
+    Checks if an IRP belongs to an IRP pool.
+
+  Description:
+    This function returns true if the IRP is a member of the IRP pool. This
+    is used to validate transfer handles.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+bool _USB_DEVICE_IRPPoolContains
+(
+    USB_DEVICE_IRP_POOL * irpPool,
+    USB_DEVICE_IRP * irp
+)
+{
+    return((irp >= irpPool->irp) && (irp < &irpPool->irp[irpPool->size]));
+}
+
+// ******************************************************************************
+/* Function:
+    uint16_t _USB_DEVICE_IRPPoolIndexGet
+    (
+        USB_DEVICE_IRP_POOL * irpPool,
+        USB_DEVICE_IRP * irp
+    )
+
+  Summary:
+    Returns the index of the IRP.
+
+  Description:
+    This function returns the index of the IRP in the pool plus the index
+    offset of the pool. Function drivers use this index to access data that
+    they maintain per IRP.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+uint16_t _USB_DEVICE_IRPPoolIndexGet
+(
+    USB_DEVICE_IRP_POOL * irpPool,
+    USB_DEVICE_IRP * irp
+)
+{
+    return((uint16_t)(irpPool->indexOffset + (irp - irpPool->irp)));
+}
+
+// ******************************************************************************
+/* Function:
+    USB_DEVICE_IRP_POOL * _USB_DEVICE_IRPPoolGet
+    (
+        USB_DEVICE_HANDLE usbDeviceHandle
+    )
+
+  Summary:
+    Returns the function driver IRP pool of a device layer instance.
+
+  Description:
+    This function returns the IRP pool that is shared by all function drivers
+    of the device layer instance. The function returns NULL if
+    USB_DEVICE_IRP_POOL_SIZE is not defined.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+USB_DEVICE_IRP_POOL * _USB_DEVICE_IRPPoolGet
+(
+    USB_DEVICE_HANDLE usbDeviceHandle
+)
+{
+#if defined(USB_DEVICE_IRP_POOL_SIZE)
+    return(&((USB_DEVICE_OBJ *)usbDeviceHandle)->functionDriverIRPPool);
+#else
+    return(NULL);
+#endif
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: USB Device Layer Endpoint Statistics Functions
+// *****************************************************************************
+// *****************************************************************************
+
+#if defined(USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER)
+
+// ******************************************************************************
+/* Function:
+    void _USB_DEVICE_StatisticsIRPCallback( USB_DEVICE_IRP * irp )
 
   Summary:
-    This function will start the resume signalling.
+    IRP callback that updates the endpoint statistics.
 
   Description:
-    This function will start the resume signalling on the bus. The client calls
-    this function after it has detected a idle bus (through the
-    USB_DEVICE_EVENT_SUSPENDED event). The remote wakeup feature should have
-    been enabled by the host, before the client can call this function. The
-    client can use the USB_DEVICE_RemoteWakeupStatusGet() function to check if
-    the host has enabled the remote wakeup feature.
+    This callback replaces the client callback of every IRP that is tracked
+    for the endpoint statistics. It finds the tracking entry through the
+    layerData member of the IRP, updates the statistics of the endpoint on
+    which the IRP was submitted, restores the client callback in the IRP and
+    then calls the client callback. The client callback can therefore submit
+    the IRP again.
 
   Remarks:
-    Refer to usb_device.h for usage information.
+    This is a local function and should not be called directly by the
+    application. This function is called in the USB interrupt context.
 */
 
-void USB_DEVICE_RemoteWakeupStart( USB_DEVICE_HANDLE usbDeviceHandle )
+void _USB_DEVICE_StatisticsIRPCallback( USB_DEVICE_IRP * irp )
 {
     USB_DEVICE_OBJ * usbDeviceThisInstance;
+    USB_DEVICE_STATISTICS_IRP_ENTRY * entry = NULL;
+    USB_DEVICE_ENDPOINT_STATISTICS * statistics;
+    void (*callback)(USB_DEVICE_IRP * irp) = NULL;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    uint32_t latency;
+    unsigned int bucket;
 
-    /* Validate the device handle */
-    usbDeviceThisInstance = _USB_DEVICE_ClientHandleValidate(usbDeviceHandle);
-    if(NULL == usbDeviceThisInstance)
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+    /* The IRP points to its tracking entry */
+    entry = (USB_DEVICE_STATISTICS_IRP_ENTRY *)(irp->layerData);
+
+    if((entry != NULL) && (entry->irp == irp))
     {
-        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer Client Handle is invalid");
-        return;
+        usbDeviceThisInstance = &usbDeviceInstance[entry->instanceIndex];
+        statistics = &usbDeviceThisInstance->endpointStatistics[entry->endpoint & 0x0F][(entry->endpoint >> 7) & 0x1];
+
+        switch(irp->status)
+        {
+            case USB_DEVICE_IRP_STATUS_COMPLETED:
+            case USB_DEVICE_IRP_STATUS_COMPLETED_SHORT:
+                statistics->bytes += irp->size;
+                break;
+
+            case USB_DEVICE_IRP_STATUS_ERROR:
+                statistics->errors ++;
+                break;
+
+            default:
+                statistics->aborts ++;
+                break;
+        }
+
+        /* Find the log2 bucket of the latency */
+        latency = (_USB_DEVICE_StatisticsTimeStampGet(usbDeviceThisInstance) - entry->timeStamp) & _USB_DEVICE_STATISTICS_TIMESTAMP_MASK;
+        bucket = 0;
+        while((latency != 0) && (bucket < (USB_DEVICE_ENDPOINT_STATISTICS_LATENCY_BUCKETS - 1)))
+        {
+            latency >>= 1;
+            bucket ++;
+        }
+        statistics->latency[bucket] ++;
+
+        if(statistics->pending > 0)
+        {
+            statistics->pending --;
+        }
+
+        /* Give the IRP back to the client */
+        callback = entry->callback;
+        irp->callback = callback;
+        irp->layerData = entry->layerData;
+        entry->irp = NULL;
     }
 
-    /* Call the driver remote wake up function here */
-    usbDeviceThisInstance->driverInterface->deviceRemoteWakeupStart(usbDeviceThisInstance->usbCDHandle);
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+    if(callback != NULL)
+    {
+        callback(irp);
+    }
 }
-// *****************************************************************************
-// *****************************************************************************
-// Section: USB Device Layer System Interface functions.
-// *****************************************************************************
-// *****************************************************************************
 
 // *****************************************************************************
 /* Function:
-    USB_ERROR USB_DEVICE_IRPSubmit
+    USB_ERROR USB_DEVICE_EndpointStatisticsGet
     (
-        USB_DEVICE_HANDLE usbDeviceHandle, 
-        USB_ENDPOINT endpointAndDirection, 
-        USB_DEVICE_IRP * irp
-    );
-    
+        USB_DEVICE_HANDLE usbDeviceHandle,
+        USB_ENDPOINT_ADDRESS endpoint,
+        USB_DEVICE_ENDPOINT_STATISTICS * statistics
+    )
+
   Summary:
-    This function submits an I/O Request Packet (IRP) for processing to the
-    Hi-Speed USB Driver.
-	
+    This function returns the transfer statistics of an endpoint.
+
   Description:
-    This function submits an I/O Request Packet (IRP) for processing to the USB
-    Driver. The IRP allows a client to send and receive data from the USB Host.
-    The data will be sent or received through the specified endpoint. The direction
-    of the data transfer is indicated by the direction flag in the
-    endpointAndDirection parameter. Submitting an IRP arms the endpoint to
-    either send data to or receive data from the Host.  If an IRP is already
-    being processed on the endpoint, the subsequent IRP submit operation
-    will be queued. The contents of the IRP (including the application buffers)
-    should not be changed until the IRP has been processed.
-	
+    This function returns the transfer statistics of an endpoint.
+
   Remarks:
-    Refer to usb_device_function_driver.h for usage information.                                                                          
+    Refer to usb_device.h for usage information.
 */
 
-USB_ERROR USB_DEVICE_IRPSubmit
+USB_ERROR USB_DEVICE_EndpointStatisticsGet
 (
-    USB_DEVICE_HANDLE usbDeviceHandle, 
-    USB_ENDPOINT endpointAndDirection, 
-    USB_DEVICE_IRP * irp
+    USB_DEVICE_HANDLE usbDeviceHandle,
+    USB_ENDPOINT_ADDRESS endpoint,
+    USB_DEVICE_ENDPOINT_STATISTICS * statistics
 )
 {
-    USB_DEVICE_OBJ* usbClientHandle;
-    USB_ERROR result;
-    
+    USB_DEVICE_OBJ * usbClientHandle;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+
     /* Validate the handle */
-    usbClientHandle = _USB_DEVICE_ClientHandleValidate(usbDeviceHandle );
+    usbClientHandle = _USB_DEVICE_ClientHandleValidate(usbDeviceHandle);
 
-    if(usbClientHandle == NULL)
-    {
-       /* Handle is not valid */
-       SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: Invalid handle");
-       result = USB_ERROR_PARAMETER_INVALID; 
-    }
-    else
+    if((usbClientHandle == NULL) || (statistics == NULL)
+            || ((endpoint & 0x0F) >= USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER))
     {
-         /* Submit IRP */
-        result = usbClientHandle->driverInterface->deviceIRPSubmit(usbClientHandle->usbCDHandle,endpointAndDirection, irp ); 
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: Invalid parameter in USB_DEVICE_EndpointStatisticsGet()");
+        return(USB_ERROR_PARAMETER_INVALID);
     }
-    
-    return result; 
+
+    /* The IRP callbacks update the statistics in the interrupt context */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    *statistics = usbClientHandle->endpointStatistics[endpoint & 0x0F][(endpoint >> 7) & 0x1];
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+    return(USB_ERROR_NONE);
 }
 
-// **************************************************************************
+// *****************************************************************************
 /* Function:
-    USB_ERROR USB_DEVICE_IRPCancelAll 
+    USB_ERROR USB_DEVICE_EndpointStatisticsClear
     (
         USB_DEVICE_HANDLE usbDeviceHandle,
-        USB_ENDPOINT endpointAndDirection
-    );
-    
+        USB_ENDPOINT_ADDRESS endpoint
+    )
+
   Summary:
-    This function cancels all IRPs that are queued and in progress at the
-    specified endpoint.
-	
+    This function clears the transfer statistics of an endpoint.
+
   Description:
-    This function cancels all IRPs that are queued and in progress at the
-    specified endpoint.
-	
+    This function clears the transfer statistics of an endpoint.
+
   Remarks:
-    Refer to usb_device_function_driver.h for usage information.                                                               
+    Refer to usb_device.h for usage information.
 */
 
-USB_ERROR USB_DEVICE_IRPCancelAll 
+USB_ERROR USB_DEVICE_EndpointStatisticsClear
 (
     USB_DEVICE_HANDLE usbDeviceHandle,
-    USB_ENDPOINT endpointAndDirection
+    USB_ENDPOINT_ADDRESS endpoint
 )
 {
-    USB_DEVICE_OBJ* usbClientHandle;
-    USB_ERROR result; 
+    USB_DEVICE_OBJ * usbClientHandle;
+    USB_DEVICE_ENDPOINT_STATISTICS * statistics;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    uint16_t pending;
 
     /* Validate the handle */
-    usbClientHandle = _USB_DEVICE_ClientHandleValidate(usbDeviceHandle );
+    usbClientHandle = _USB_DEVICE_ClientHandleValidate(usbDeviceHandle);
 
-    if(usbClientHandle == NULL)
-    {
-       /* Handle is not valid */
-       SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: Invalid handle");
-       result = USB_ERROR_PARAMETER_INVALID; 
-    }
-    else
+    if((usbClientHandle == NULL) || ((endpoint & 0x0F) >= USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER))
     {
-        /* Cancel all IRPs pending on the Endpoint */
-        result = usbClientHandle->driverInterface->deviceIRPCancelAll(usbClientHandle->usbCDHandle,endpointAndDirection); 
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: Invalid parameter in USB_DEVICE_EndpointStatisticsClear()");
+        return(USB_ERROR_PARAMETER_INVALID);
     }
-    
-    return result;  
+
+    statistics = &usbClientHandle->endpointStatistics[endpoint & 0x0F][(endpoint >> 7) & 0x1];
+
+    /* The pending IRPs are still tracked and will decrement the pending
+     * count when they complete. */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    pending = statistics->pending;
+    memset(statistics, 0, sizeof(USB_DEVICE_ENDPOINT_STATISTICS));
+    statistics->pending = pending;
+    statistics->pendingHighWaterMark = pending;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+    return(USB_ERROR_NONE);
 }
 
-// **************************************************************************
+#if defined(USB_DEVICE_STATISTICS_VENDOR_REQUEST)
+
+// ******************************************************************************
 /* Function:
-    USB_ERROR USB_DEVICE_IRPCancel
-	(
-		USB_DEVICE_HANDLE usbDeviceHandle,
-		USB_DEVICE_IRP * irp
-	)
-    
+    void _USB_DEVICE_StatisticsRequestProcess
+    (
+        USB_DEVICE_OBJ * usbDeviceThisInstance,
+        USB_SETUP_PACKET * setupPkt
+    )
+
   Summary:
-    This function cancels the specific IRP that are queued and in progress at the
-    specified endpoint.
-	
+    Processes the endpoint statistics vendor request.
+
   Description:
-    This function attempts to cancel the processing of a queued IRP. An IRP that
-    was in the queue but yet to be processed will be cancelled successfully and
-    the IRP callback function will be called from this function with the
-    USB_DEVICE_IRP_STATUS_ABORTED status. The application can release the data
-    buffer memory used by the IRP when this callback occurs.  If the IRP was in
-    progress (a transaction in on the bus) when the cancel function was called,
-    the IRP will be canceled only when an ongoing or the next transaction has
-    completed. The IRP callback function will then be called in an interrupt
-    context. The application should not release the related data buffer unless
-    the IRP callback has occurred.
-	
+    This function processes a vendor device request whose bRequest field
+    matches USB_DEVICE_STATISTICS_VENDOR_REQUEST. The low byte of the wIndex
+    field is the endpoint address. The statistics of the endpoint are sent to
+    the host in the data stage as a USB_DEVICE_ENDPOINT_STATISTICS object. If
+    bit 0 of the wValue field is set, the statistics are cleared after they
+    have been copied. The request is stalled if the direction is not device to
+    host or the endpoint is not valid.
+
   Remarks:
-    Refer to usb_device_function_driver.h for usage information.
-                                                                  
+    This is a local function and should not be called directly by the
+    application.
 */
 
-USB_ERROR USB_DEVICE_IRPCancel
+void _USB_DEVICE_StatisticsRequestProcess
 (
-    USB_DEVICE_HANDLE usbDeviceHandle, 
-    USB_DEVICE_IRP * irp
+    USB_DEVICE_OBJ * usbDeviceThisInstance,
+    USB_SETUP_PACKET * setupPkt
 )
 {
-    USB_DEVICE_OBJ* usbClientHandle;
-    USB_ERROR result;
+    USB_DEVICE_HANDLE usbDeviceHandle = (USB_DEVICE_HANDLE)usbDeviceThisInstance;
+    USB_ENDPOINT_ADDRESS endpoint = (USB_ENDPOINT_ADDRESS)(setupPkt->wIndex & 0xFF);
+    uint16_t size;
 
-    /* Validate the handle */
-    usbClientHandle = _USB_DEVICE_ClientHandleValidate(usbDeviceHandle );
+    if((setupPkt->DataDir != USB_SETUP_REQUEST_DIRECTION_DEVICE_TO_HOST) ||
+            (USB_DEVICE_EndpointStatisticsGet(usbDeviceHandle, endpoint,
+            &usbDeviceThisInstance->statisticsResponse) != USB_ERROR_NONE))
+    {
+        USB_DEVICE_ControlStatus(usbDeviceHandle, USB_DEVICE_CONTROL_STATUS_ERROR);
+        return;
+    }
 
-    if(usbClientHandle == NULL)
+    if(setupPkt->wValue & 0x0001)
     {
-       /* Handle is not valid */
-       SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: Invalid handle");
-       result = USB_ERROR_PARAMETER_INVALID; 
+        (void)USB_DEVICE_EndpointStatisticsClear(usbDeviceHandle, endpoint);
     }
-    else
+
+    size = sizeof(USB_DEVICE_ENDPOINT_STATISTICS);
+    if(setupPkt->wLength < size)
     {
-        /* Cancel IRP */
-        result = usbClientHandle->driverInterface->deviceIRPCancel(usbClientHandle->usbCDHandle,irp); 
-        
+        size = setupPkt->wLength;
     }
-  
-    return result; 
+
+    USB_DEVICE_ControlSend(usbDeviceHandle, &usbDeviceThisInstance->statisticsResponse, size);
 }
+
+#endif
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: USB Device Layer Local Functions
@@ -2076,6 +3009,15 @@ void  _USB_DEVICE_ControlTransferHandler
                         _USB_DEVICE_ProcessStandardDeviceGetRequests ( usbDeviceThisInstance, setupPkt );
                     }
                 }
+#if defined(USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER) && defined(USB_DEVICE_STATISTICS_VENDOR_REQUEST)
+                else if ((setupPkt->RequestType == USB_SETUP_REQUEST_TYPE_VENDOR)
+                        && (setupPkt->bRequest == USB_DEVICE_STATISTICS_VENDOR_REQUEST))
+                {
+                    /* This is the endpoint statistics request. This is
+                     * handled by the device layer. */
+                    _USB_DEVICE_StatisticsRequestProcess(usbDeviceThisInstance, setupPkt);
+                }
+#endif
                 else if (setupPkt->RequestType == USB_SETUP_REQUEST_TYPE_VENDOR)
                 {
                     /* This is a SETUP request of Vendor type  to recipient
@@ -2971,85 +3913,6 @@ USB_DEVICE_OBJ* _USB_DEVICE_ClientHandleValidate(USB_DEVICE_HANDLE deviceHandle)
     return(client);
 }
 
-// ******************************************************************************
-/* Function:
-    void _USB_DEVICE_EndpointMutexCreateFunction
-    (
-        USB_DEVICE_OBJ* usbDeviceThisInstance
-    )
-
-  Summary:
-    Creats mutex which is required for Endpoint read write functions.
-
-  Description:
-    Creats mutex which is required for Endpoint read write functions.
-
-  Remarks:
-    This is a local function and should not be called directly by the client.
-*/
-
-void _USB_DEVICE_EndpointMutexCreateFunction(USB_DEVICE_OBJ* usbDeviceThisInstance)
-{
-    
-    OSAL_RESULT osalResult;
-    
-    if (usbDeviceThisInstance->isMutexEndpointIrpInitialized == false)
-    {
-        /* Use the OSAL to create Mutex */
-        osalResult = OSAL_MUTEX_Create(&(usbDeviceThisInstance->mutexEndpointIRP));
-    
-    
-        if(osalResult != OSAL_RESULT_TRUE)
-        {
-            /* Mutex creation failed*/
-            usbDeviceThisInstance->isMutexEndpointIrpInitialized = false;
-            SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: Mutex Create Failed");
-        }
-        else
-        {
-            /* Update the flag indicating that the Mutex has been created */
-            usbDeviceThisInstance->isMutexEndpointIrpInitialized = true;
-        }
-    }
-}
-
-// ******************************************************************************
-/* Function:
-    void _USB_DEVICE_EndpointMutexDeleteFunction
-    (
-        USB_DEVICE_OBJ* usbDeviceThisInstance
-    )
-
-  Summary:
-    Deletes mutex which is required for Endpoint read write functions.
-
-  Description:
-    Deletes mutex which is required for Endpoint read write functions.
-
-  Remarks:
-    This is a local function and should not be called directly by the client.
-*/
-
-void _USB_DEVICE_EndpointMutexDeleteFunction(USB_DEVICE_OBJ* usbDeviceThisInstance)
-{
-    OSAL_RESULT osalResult;
-
-    /* Use the OSAL to delete the Mutex */
-    osalResult = OSAL_MUTEX_Delete(&(usbDeviceThisInstance->mutexEndpointIRP));
-
-    if(osalResult != OSAL_RESULT_TRUE)
-    {
-        /* Mutex delete failed */
-        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Device Layer: Mutex Delete Failed");
-    }
-    else
-    {
-        /* Update the flag indicating that the mutex needs to be created again
-         * */
-        usbDeviceThisInstance->isMutexEndpointIrpInitialized = false;
-    }
-}
-
 // ******************************************************************************
 /* Function:
     uint16_t _USB_DEVICE_GetStringDescriptorRequestProcess
@@ -310,6 +310,9 @@ typedef struct
     /* Current Queue Size Status Send */ 
     volatile unsigned int currentQSizeStatusSend; 
 
+    /* IRP pool from which this instance allocates IRPs */
+    USB_DEVICE_IRP_POOL * irpPool;
+
 }USB_DEVICE_AUDIO_INSTANCE;
 
 
@@ -339,6 +342,27 @@ typedef struct
     
 } USB_DEVICE_AUDIO_IRP_DATA;
 
+// *****************************************************************************
+/* Audio IRP Data array size
+
+  Summary:
+    Number of entries in the Audio IRP data array.
+
+  Description:
+    There is one Audio IRP data entry per IRP that the Audio function driver
+    can allocate. The entry is located by the pool index of the IRP. When the
+    device layer provides a shared IRP pool, this is the combined size of the
+    pools of all device layer instances.
+
+  Remarks:
+    This macro is internal to the Audio function driver.
+*/
+#if defined(USB_DEVICE_IRP_POOL_SIZE)
+#define USB_DEVICE_AUDIO_IRP_DATA_SIZE (USB_DEVICE_INSTANCES_NUMBER * USB_DEVICE_IRP_POOL_SIZE)
+#else
+#define USB_DEVICE_AUDIO_IRP_DATA_SIZE USB_DEVICE_AUDIO_QUEUE_DEPTH_COMBINED
+#endif
+
 // *****************************************************************************
 /* Audio Common data object
 
@@ -357,10 +381,12 @@ typedef struct
 {
     /* Set to true if all members of this structure
        have been initialized once */
-    bool isMutexAudioIrpInitialized;
+    bool isIrpPoolInitialized;
 
-    /* Mutex to protect client object pool */
-    OSAL_MUTEX_DECLARE(mutexAUDIOIRP);
+#if !defined(USB_DEVICE_IRP_POOL_SIZE)
+    /* Pool of IRPs shared by all Audio instances */
+    USB_DEVICE_IRP_POOL irpPool;
+#endif
 
 } USB_DEVICE_AUDIO_COMMON_DATA_OBJ;
 
@@ -369,8 +395,12 @@ typedef struct
 // Section: Extern Data
 // *****************************************************************************
 // *****************************************************************************
+#if !defined(USB_DEVICE_IRP_POOL_SIZE)
 extern USB_DEVICE_IRP gUSBDeviceAudioIRP[USB_DEVICE_AUDIO_QUEUE_DEPTH_COMBINED];
-extern USB_DEVICE_AUDIO_IRP_DATA gUSBDeviceAudioIrpData [USB_DEVICE_AUDIO_QUEUE_DEPTH_COMBINED];
+extern uint16_t gUSBDeviceAudioIRPFreeStack[USB_DEVICE_AUDIO_QUEUE_DEPTH_COMBINED];
+extern bool gUSBDeviceAudioIRPIsFree[USB_DEVICE_AUDIO_QUEUE_DEPTH_COMBINED];
+#endif
+extern USB_DEVICE_AUDIO_IRP_DATA gUSBDeviceAudioIrpData [USB_DEVICE_AUDIO_IRP_DATA_SIZE];
 extern USB_DEVICE_AUDIO_INSTANCE gUsbDeviceAudioInstance[USB_DEVICE_AUDIO_INSTANCES_NUMBER];
 extern USB_DEVICE_AUDIO_COMMON_DATA_OBJ gUSBDeviceAudioCommonDataObj;
 
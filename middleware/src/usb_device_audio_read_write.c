@@ -84,9 +84,17 @@ USB_DEVICE_AUDIO_INSTANCE gUsbDeviceAudioInstance[USB_DEVICE_AUDIO_INSTANCES_NUM
     This array is private to the USB stack.
  */
 
+#if !defined(USB_DEVICE_IRP_POOL_SIZE)
 USB_DEVICE_IRP gUSBDeviceAudioIRP[USB_DEVICE_AUDIO_QUEUE_DEPTH_COMBINED];
 
-/* Create a variable for holding Audio IRP mutex Handle and status */
+/* Free index stack for the Audio IRPs */
+uint16_t gUSBDeviceAudioIRPFreeStack[USB_DEVICE_AUDIO_QUEUE_DEPTH_COMBINED];
+
+/* Free flags of the Audio IRPs */
+bool gUSBDeviceAudioIRPIsFree[USB_DEVICE_AUDIO_QUEUE_DEPTH_COMBINED];
+#endif
+
+/* Create a variable for holding Audio IRP pool */
 USB_DEVICE_AUDIO_COMMON_DATA_OBJ gUSBDeviceAudioCommonDataObj;
 // *****************************************************************************
 /* AUDIO Device IRP Data
@@ -101,7 +109,7 @@ USB_DEVICE_AUDIO_COMMON_DATA_OBJ gUSBDeviceAudioCommonDataObj;
   Remarks:
     This array is private to the USB stack.
  */
-USB_DEVICE_AUDIO_IRP_DATA gUSBDeviceAudioIrpData [USB_DEVICE_AUDIO_QUEUE_DEPTH_COMBINED];
+USB_DEVICE_AUDIO_IRP_DATA gUSBDeviceAudioIrpData [USB_DEVICE_AUDIO_IRP_DATA_SIZE];
 
 // *****************************************************************************
 /* AUDIO Device IRP Unique Identifier
@@ -304,15 +312,12 @@ USB_DEVICE_AUDIO_RESULT USB_DEVICE_AUDIO_StatusSend
     USB_AUDIO_INTERRUPT_STATUS_WORD* data
 )
 {
-    int cnt;
+    uint16_t cnt;
     USB_DEVICE_IRP *irp;
     USB_DEVICE_AUDIO_IRP_DATA *audioIrpData;
     USB_DEVICE_AUDIO_INSTANCE *thisAudioInstance = NULL; 
     USB_ENDPOINT epStruct;
-    OSAL_RESULT osalError;
     USB_ERROR irpErr;
-    bool irpFound = false; 
-    OSAL_CRITSECT_DATA_TYPE IntState;
     USB_DEVICE_AUDIO_EP_INSTANCE * endpoint = NULL;
     USB_DEVICE_AUDIO_RESULT audioResult = USB_DEVICE_AUDIO_RESULT_OK;
     
@@ -341,13 +346,6 @@ USB_DEVICE_AUDIO_RESULT USB_DEVICE_AUDIO_StatusSend
             audioResult = USB_DEVICE_AUDIO_RESULT_ERROR_INSTANCE_NOT_CONFIGURED; 
         }
         
-        /* Make sure that we are with in the queue size for this instance */
-        else if(thisAudioInstance->currentQSizeStatusSend >= thisAudioInstance->queueSizeStatusSend)
-        {
-            SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Device Audio v1.0 : Instance %d: Queue Full", instanceIndex);
-            audioResult = USB_DEVICE_AUDIO_RESULT_ERROR_TRANSFER_QUEUE_FULL; 
-        }
-    
         /* Check if user passed valid buffer */
         else if ( data == NULL )
         {
@@ -359,127 +357,73 @@ USB_DEVICE_AUDIO_RESULT USB_DEVICE_AUDIO_StatusSend
     }
     if (audioResult == USB_DEVICE_AUDIO_RESULT_OK)
     {  
-        /*Obtain mutex to get access to a shared resource, check return value*/
-        osalError = OSAL_MUTEX_Lock(&gUSBDeviceAudioCommonDataObj.mutexAUDIOIRP, OSAL_WAIT_FOREVER);
-        if(osalError == OSAL_RESULT_TRUE)
+        /* Get a free IRP. This fails if the status send queue of this
+           instance is full */
+        irp = _USB_DEVICE_IRPPoolAllocate(thisAudioInstance->irpPool,
+                &thisAudioInstance->currentQSizeStatusSend,
+                thisAudioInstance->queueSizeStatusSend);
+        if (irp == NULL)
         {
-            /* Loop and find a free IRP in the Q */
-            for ( cnt = 0; cnt < USB_DEVICE_AUDIO_QUEUE_DEPTH_COMBINED; cnt++ )
-            {
-                /* get the IRP status */
-                if(gUSBDeviceAudioIRP[cnt].status <
-                        (USB_DEVICE_IRP_STATUS)USB_DEVICE_IRP_FLAG_DATA_PENDING)
-                {
-                    irpFound = true; 
-                    
-                    irp = &gUSBDeviceAudioIRP[cnt];
-                    audioIrpData =&gUSBDeviceAudioIrpData[cnt];
-
-                    /* Increment the Unique Buffer ID for the request. If the ID reaches
-                    0xFFFF, we let it roll over. This avoid confusing the generated
-                    unique buffer handle with a invalid buffer handle. */
-
-                    gUSBDeviceAudioUniqueBufferID ++;
-                    gUSBDeviceAudioUniqueBufferID = (gUSBDeviceAudioUniqueBufferID == 0xFFFF) ? 0 : gUSBDeviceAudioUniqueBufferID ;
-
-                    /* Retrieve endpoint address */ 
-                    epStruct = endpoint->epAddr;
-
-                    /* Fill IRP object with the pointer to the data that is to 
-                       be transferred to the Host*/
-                    irp->data = data;
-
-                    /* Fill IRP object with size of the data that is to be 
-                       transferred to the USB host*/
-                    irp->size = 2;
-                    
-                    /* Save Audio function driver instance */
-                    audioIrpData->iAudio = instanceIndex; 
-
-                    /* Provide function address to call back when IRP is 
-                       complete */
-                    irp->callback = _USB_DEVICE_AUDIO_StatusSendIRPCallBack;
-                    
-                    /* Request driver to complete the transfer */
-                    irp->flags = USB_DEVICE_IRP_FLAG_DATA_PENDING; 
-
-                    /* Save Audio Instance Number. We will need this to retrieve
-                       data when we get IRP call back */
-                    irp->userData = (gUSBDeviceAudioUniqueBufferID << 16) | instanceIndex;
-
-                    /* Save transfer handle */
-                    *transferHandle = (USB_DEVICE_AUDIO_TRANSFER_HANDLE) ((gUSBDeviceAudioUniqueBufferID << 16) | cnt);
-
-                    /* Prevent other tasks pre-empting this sequence of code */
-                    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-                    
-                    /* Update the read queue size */
-                    thisAudioInstance->currentQSizeStatusSend++;
-                    
-                    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+            SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Device Audio v1.0 : Instance %d: Queue Full", instanceIndex);
+            audioResult = USB_DEVICE_AUDIO_RESULT_ERROR_TRANSFER_QUEUE_FULL; 
+        }
+        else
+        {
+            cnt = _USB_DEVICE_IRPPoolIndexGet(thisAudioInstance->irpPool, irp);
+            audioIrpData = &gUSBDeviceAudioIrpData[cnt];
+
+            /* Increment the Unique Buffer ID for the request. If the ID reaches
+            0xFFFF, we let it roll over. This avoid confusing the generated
+            unique buffer handle with a invalid buffer handle. */
+
+            gUSBDeviceAudioUniqueBufferID ++;
+            gUSBDeviceAudioUniqueBufferID = (gUSBDeviceAudioUniqueBufferID == 0xFFFF) ? 0 : gUSBDeviceAudioUniqueBufferID ;
+
+            /* Retrieve endpoint address */ 
+            epStruct = endpoint->epAddr;
+
+            /* Fill IRP object with the pointer to the data that is to 
+               be transferred to the Host*/
+            irp->data = data;
+
+            /* Fill IRP object with size of the data that is to be 
+               transferred to the USB host*/
+            irp->size = 2;
             
-        
-                    /* Submit IRP */ 
-                    irpErr = USB_DEVICE_IRPSubmit ( thisAudioInstance->devLayerHandle ,
-                                            epStruct , irp);
-                                            
-                    /* Check if IRP submit is failed */
-                    if ( USB_ERROR_NONE != irpErr )
-                    {
-                        /* Prevent other tasks pre-empting this sequence of code */
-                        IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-                
-                        /* Update the read queue size */
-                        thisAudioInstance->currentQSizeStatusSend--;
-                        
-                        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState); 
-                        
-                        /* Invalidate the Transfer handle.  */
-                        *transferHandle = USB_DEVICE_AUDIO_TRANSFER_HANDLE_INVALID;
-                    }
-                
-                    /*Release mutex, done with shared resource*/
-                    osalError = OSAL_MUTEX_Unlock(&gUSBDeviceAudioCommonDataObj.mutexAUDIOIRP);
-                    if(osalError == OSAL_RESULT_TRUE)
-                    {
-                        audioResult = irpErr; 
-                    }
-                    else
-                    {
-                        /*Do not proceed lock was not obtained, or error occurred, let user know about error*/
-                        SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Device Audio v1.0 : Instance %d: Mutex Release failed", instanceIndex);
-                        audioResult = USB_DEVICE_AUDIO_RESULT_ERROR;
-                    }
-                    /* We have finished processing the IRP. Now exit from the 
-                       for loop */ 
-                    break; 
-                }
-            }
-            if (irpFound == false)
+            /* Save Audio function driver instance */
+            audioIrpData->iAudio = instanceIndex; 
+
+            /* Provide function address to call back when IRP is 
+               complete */
+            irp->callback = _USB_DEVICE_AUDIO_StatusSendIRPCallBack;
+            
+            /* Request driver to complete the transfer */
+            irp->flags = USB_DEVICE_IRP_FLAG_DATA_PENDING; 
+
+            /* Save Audio Instance Number. We will need this to retrieve
+               data when we get IRP call back */
+            irp->userData = (gUSBDeviceAudioUniqueBufferID << 16) | instanceIndex;
+
+            /* Save transfer handle */
+            *transferHandle = (USB_DEVICE_AUDIO_TRANSFER_HANDLE) ((gUSBDeviceAudioUniqueBufferID << 16) | cnt);
+
+            /* Submit IRP */ 
+            irpErr = USB_DEVICE_IRPSubmit ( thisAudioInstance->devLayerHandle ,
+                                    epStruct , irp);
+                                    
+            /* Check if IRP submit is failed */
+            if ( USB_ERROR_NONE != irpErr )
             {
-                /*Release mutex here as above loop does not release the mutex if 
-                  no free IRP was found */
-                osalError = OSAL_MUTEX_Unlock(&gUSBDeviceAudioCommonDataObj.mutexAUDIOIRP);
-                if(osalError == OSAL_RESULT_TRUE)
-                {
-                   /* There was no free IRP. Queue was full  */
-                  SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Device Audio v1.0 : Instance %d: Queue was full", instanceIndex);
-                  audioResult = USB_DEVICE_AUDIO_RESULT_ERROR_TRANSFER_QUEUE_FULL; 
-                }  
-                else
-                {
-                    /* Do not proceed, unlock was not complete, or error occurred, let 
-                       user know about error */
-                    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Device Audio v1.0 : Instance %d: Mutex Release failed", instanceIndex);
-                    audioResult = USB_DEVICE_AUDIO_RESULT_ERROR; 
-                }
+                /* Return the IRP to the pool */
+                _USB_DEVICE_IRPPoolRelease(thisAudioInstance->irpPool, irp,
+                        &thisAudioInstance->currentQSizeStatusSend);
+                
+                /* Invalidate the Transfer handle.  */
+                *transferHandle = USB_DEVICE_AUDIO_TRANSFER_HANDLE_INVALID;
             }
+
+            audioResult = irpErr; 
         }
-        else
-        {
-            SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Device Audio v1.0 : Instance %d: Mutex Lock failed", instanceIndex);
-            audioResult = USB_DEVICE_AUDIO_RESULT_ERROR; 
-        }     
     }
     
     /* Return result */ 
@@ -529,17 +473,13 @@ USB_DEVICE_AUDIO_RESULT _USB_DEVICE_AUDIO_Transfer
     
     uint8_t syncEndpoint;
 
-    uint8_t cnt;
+    uint16_t cnt;
 
     USB_ENDPOINT epStruct;
 
-    OSAL_CRITSECT_DATA_TYPE IntState;
-
     USB_ERROR irpErr;
 
     USB_DEVICE_AUDIO_EP_INSTANCE* tempEndpointInstance=NULL;
-    
-    OSAL_RESULT osalError;
 
     USB_DEVICE_IRP * irp;
 
@@ -625,127 +565,87 @@ USB_DEVICE_AUDIO_RESULT _USB_DEVICE_AUDIO_Transfer
         }
     }
 
-    /*Obtain mutex to get access to a shared resource, check return value*/
-    osalError = OSAL_MUTEX_Lock(&gUSBDeviceAudioCommonDataObj.mutexAUDIOIRP, OSAL_WAIT_FOREVER);
-    if(osalError != OSAL_RESULT_TRUE)
+    /* Get a free IRP. This fails if the read or write queue of this
+     * instance is full */
+    if (direction == USB_DEVICE_AUDIO_READ )
     {
-      /*Do not proceed lock was not obtained, or error occurred, let user know about error*/
-      return (USB_DEVICE_AUDIO_RESULT_ERROR);
+        irp = _USB_DEVICE_IRPPoolAllocate(thisAudioInstance->irpPool,
+                &thisAudioInstance->currentQSizeRead,
+                thisAudioInstance->queueSizeRead);
+    }
+    else
+    {
+        irp = _USB_DEVICE_IRPPoolAllocate(thisAudioInstance->irpPool,
+                &thisAudioInstance->currentQSizeWrite,
+                thisAudioInstance->queueSizeWrite);
     }
 
-    /* Loop and find a free IRP in the Q */
-    for ( cnt = 0; cnt < USB_DEVICE_AUDIO_QUEUE_DEPTH_COMBINED; cnt ++ )
+    if (irp == NULL)
     {
-        /* get the IRP status */
-        if(gUSBDeviceAudioIRP[cnt].status <
-                (USB_DEVICE_IRP_STATUS)USB_DEVICE_IRP_FLAG_DATA_PENDING)
-        {
-            irp = &gUSBDeviceAudioIRP[cnt];
-            audioIrpData =&gUSBDeviceAudioIrpData[cnt];
+        /* If here means we could not find a spare IRP */
+        return(USB_DEVICE_AUDIO_RESULT_ERROR_TRANSFER_QUEUE_FULL);   
+    }
 
-            /* Increment the Unique Buffer ID for the request. If the ID reaches
-            0xFFFF, we let it roll over. This avoid confusing the generated
-            unique buffer handle with a invalid buffer handle. */
+    cnt = _USB_DEVICE_IRPPoolIndexGet(thisAudioInstance->irpPool, irp);
+    audioIrpData = &gUSBDeviceAudioIrpData[cnt];
 
-            gUSBDeviceAudioUniqueBufferID ++;
-            gUSBDeviceAudioUniqueBufferID = (gUSBDeviceAudioUniqueBufferID == 0xFFFF) ? 0 : gUSBDeviceAudioUniqueBufferID ;
+    /* Increment the Unique Buffer ID for the request. If the ID reaches
+    0xFFFF, we let it roll over. This avoid confusing the generated
+    unique buffer handle with a invalid buffer handle. */
 
-        
-        /* Retrieve endpoint address */ 
-        epStruct = tempEndpointInstance->epAddr;
+    gUSBDeviceAudioUniqueBufferID ++;
+    gUSBDeviceAudioUniqueBufferID = (gUSBDeviceAudioUniqueBufferID == 0xFFFF) ? 0 : gUSBDeviceAudioUniqueBufferID ;
+
+    /* Retrieve endpoint address */ 
+    epStruct = tempEndpointInstance->epAddr;
 
-        /* Fill IRP object with the pointer to the data that is to be transferred to the Host*/
-        irp->data = data;
+    /* Fill IRP object with the pointer to the data that is to be transferred to the Host*/
+    irp->data = data;
 
-        /* Fill IRP object with size of the data that is to be transferred to the USB host*/
-        irp->size = size;
+    /* Fill IRP object with size of the data that is to be transferred to the USB host*/
+    irp->size = size;
 
-        /* Save Interface ID */
-        audioIrpData->interfaceNum = interfaceNum;
+    /* Save Interface ID */
+    audioIrpData->interfaceNum = interfaceNum;
 
-        /* Save Data direction */
-        audioIrpData->direction = direction;
+    /* Save Data direction */
+    audioIrpData->direction = direction;
 
-        /* Save Audio Function driver instance */
-        audioIrpData->iAudio = iAudio;
+    /* Save Audio Function driver instance */
+    audioIrpData->iAudio = iAudio;
 
-        /* Provide function address to call back when IRP is complete */
-        irp->callback = _USB_DEVICE_AUDIO_TransferIRPCallBack;
+    /* Provide function address to call back when IRP is complete */
+    irp->callback = _USB_DEVICE_AUDIO_TransferIRPCallBack;
 
-        /* Save array index. We will need this to retrieve data when we get IRP call back */
-        irp->userData = (gUSBDeviceAudioUniqueBufferID << 16) | cnt;
+    /* Save array index. We will need this to retrieve data when we get IRP call back */
+    irp->userData = (gUSBDeviceAudioUniqueBufferID << 16) | cnt;
 
-        /* Save transfer handle */
-        *transferHandle = (USB_DEVICE_AUDIO_TRANSFER_HANDLE) ((gUSBDeviceAudioUniqueBufferID << 16) | cnt);
+    /* Save transfer handle */
+    *transferHandle = (USB_DEVICE_AUDIO_TRANSFER_HANDLE) ((gUSBDeviceAudioUniqueBufferID << 16) | cnt);
 
+    /* Submit IRP */ 
+    irpErr = USB_DEVICE_IRPSubmit ( thisAudioInstance->devLayerHandle ,
+                                        epStruct , irp);
+    /* check if IRP submit is success */
+    if ( USB_ERROR_NONE != irpErr )
+    {
+        /* Return the IRP to the pool */
         if (direction == USB_DEVICE_AUDIO_READ )
         {
-            /* Prevent other tasks pre-empting this sequence of code */
-            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-            /* Update the read queue size */
-            thisAudioInstance->currentQSizeRead++;
-            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-            
+            _USB_DEVICE_IRPPoolRelease(thisAudioInstance->irpPool, irp,
+                    &thisAudioInstance->currentQSizeRead);
         }
         else
         {
-            /* Prevent other tasks pre-empting this sequence of code */
-            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-            /* Update the Write queue size */
-            thisAudioInstance->currentQSizeWrite++;
-            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-            
+            _USB_DEVICE_IRPPoolRelease(thisAudioInstance->irpPool, irp,
+                    &thisAudioInstance->currentQSizeWrite);
         }
-        /* Submit IRP */ 
-        irpErr = USB_DEVICE_IRPSubmit ( thisAudioInstance->devLayerHandle ,
-                                            epStruct , irp);
-        /* check if IRP submit is success */
-        if ( USB_ERROR_NONE != irpErr )
-        {
-            if (direction == USB_DEVICE_AUDIO_READ )
-            {
-                /* Prevent other tasks pre-empting this sequence of code */
-                IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-                /* Update the read queue size */
-                thisAudioInstance->currentQSizeRead--;
-                OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-            }
-            else
-            {
-                /* Prevent other tasks pre-empting this sequence of code */
-                IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-                /* Update the Write queue size */
-                thisAudioInstance->currentQSizeWrite--;
-                OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-                
-            }
-                /* Invalidate the Transfer handle.  */
-                *transferHandle = USB_DEVICE_AUDIO_TRANSFER_HANDLE_INVALID;
-        }
-
-            /*Release mutex, done with shared resource*/
-            osalError = OSAL_MUTEX_Unlock(&gUSBDeviceAudioCommonDataObj.mutexAUDIOIRP);
-            if(osalError != OSAL_RESULT_TRUE)
-            {
-                /*Do not proceed lock was not obtained, or error occurred, let user know about error*/
-                return (USB_DEVICE_AUDIO_RESULT_ERROR);
-            }
 
-            return(irpErr);
-        }
+        /* Invalidate the Transfer handle.  */
+        *transferHandle = USB_DEVICE_AUDIO_TRANSFER_HANDLE_INVALID;
     }
 
-/*Release mutex, done with shared resource*/
-    osalError = OSAL_MUTEX_Unlock(&gUSBDeviceAudioCommonDataObj.mutexAUDIOIRP);
-    if(osalError != OSAL_RESULT_TRUE)
-    {
-    /*Do not proceed, unlock was not complete, or error occurred, 
-     * let user know about error*/
-        return (USB_DEVICE_AUDIO_RESULT_ERROR);
-    }
-    
-    /* If here means we could not find a spare IRP */
-    return(USB_DEVICE_AUDIO_RESULT_ERROR_TRANSFER_QUEUE_FULL);   
+    return(irpErr);
 }
 
 /*******************************************************************************
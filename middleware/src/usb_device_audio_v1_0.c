@@ -470,23 +470,19 @@ void _USB_DEVICE_AUDIO_SetupPacketHandler
 */
 void _USB_DEVICE_AUDIO_GlobalInitialize (void)
 {
-    OSAL_RESULT osal_err;
-
-    /* Create Mutex for CDC IRP objects if not created already */
-    if (gUSBDeviceAudioCommonDataObj.isMutexAudioIrpInitialized == false)
+#if !defined(USB_DEVICE_IRP_POOL_SIZE)
+    /* Initialize the Audio IRP pool if not initialized already */
+    if (gUSBDeviceAudioCommonDataObj.isIrpPoolInitialized == false)
     {
-        /* This means that mutexes where not created. Create them. */
-        osal_err = OSAL_MUTEX_Create(&gUSBDeviceAudioCommonDataObj.mutexAUDIOIRP);
-
-        if(osal_err != OSAL_RESULT_TRUE)
-        {
-            /*do not proceed lock was not created, let user know about error*/
-            return;
-        }
+        _USB_DEVICE_IRPPoolInitialize(&gUSBDeviceAudioCommonDataObj.irpPool,
+                gUSBDeviceAudioIRP, gUSBDeviceAudioIRPFreeStack,
+                gUSBDeviceAudioIRPIsFree,
+                USB_DEVICE_AUDIO_QUEUE_DEPTH_COMBINED, 0);
 
-         /* Set this flag so that global mutexes get allocated only once */
-         gUSBDeviceAudioCommonDataObj.isMutexAudioIrpInitialized = true;
+         /* Set this flag so that the pool gets initialized only once */
+         gUSBDeviceAudioCommonDataObj.isIrpPoolInitialized = true;
     }
+#endif
 }
 
 // ******************************************************************************
@@ -555,6 +551,13 @@ void _USB_DEVICE_AUDIO_Initialize
     audioInstance->currentQSizeWrite = 0;
     audioInstance->currentQSizeStatusSend = 0; 
 
+    /* Get the pool from which the IRPs of this instance are allocated */
+#if defined(USB_DEVICE_IRP_POOL_SIZE)
+    audioInstance->irpPool = _USB_DEVICE_IRPPoolGet((USB_DEVICE_HANDLE)usbDeviceHandle);
+#else
+    audioInstance->irpPool = &gUSBDeviceAudioCommonDataObj.irpPool;
+#endif
+
      /* Check the type of descriptor passed by device layer */
     switch ( descriptorType )
     { 
@@ -795,7 +798,7 @@ void _USB_DEVICE_AUDIO_TransferAbortPrevent(USB_DEVICE_IRP * irp)
     USB_DEVICE_AUDIO_EVENT_DATA_READ_COMPLETE readEventData;
     USB_DEVICE_AUDIO_INSTANCE *thisAudioInstance;
     USB_DEVICE_AUDIO_INDEX iAudio;
-    uint8_t cnt;
+    uint16_t cnt;
     USB_DEVICE_AUDIO_IRP_DATA *audioIrpData;
     USB_DEVICE_AUDIO_EVENT event;
 
@@ -806,7 +809,7 @@ void _USB_DEVICE_AUDIO_TransferAbortPrevent(USB_DEVICE_IRP * irp)
      * in the lower 16 bits and the and the unique Identifier in the upper 16 bits.
      * Mask the upper 16 bits to the Audio IRP index associated with this IRP */
 
-    cnt = (uint8_t)(irp->userData & 0xFFFF);
+    cnt = (uint16_t)(irp->userData & 0xFFFF);
 
     /* Get a pointer to the Audio IRP data */
     audioIrpData = &gUSBDeviceAudioIrpData[cnt];
@@ -836,16 +839,19 @@ void _USB_DEVICE_AUDIO_TransferAbortPrevent(USB_DEVICE_IRP * irp)
     /* Update Interface Number */ 
     readEventData.interfaceNum = audioIrpData->interfaceNum;
 
+    /* Return the IRP to the pool and update the queue size. The
+     * application may submit the next request from the event handler. */
     if (audioIrpData->direction == USB_DEVICE_AUDIO_READ)
     {
         event = USB_DEVICE_AUDIO_EVENT_READ_COMPLETE;
-        thisAudioInstance->currentQSizeRead--;
-
+        _USB_DEVICE_IRPPoolRelease(thisAudioInstance->irpPool, irp,
+                &thisAudioInstance->currentQSizeRead);
     }
     else
     {
         event = USB_DEVICE_AUDIO_EVENT_WRITE_COMPLETE;
-        thisAudioInstance->currentQSizeWrite--; 
+        _USB_DEVICE_IRPPoolRelease(thisAudioInstance->irpPool, irp,
+                &thisAudioInstance->currentQSizeWrite);
     }
 
     /* Send an event to the application */ 
@@ -863,7 +869,7 @@ void _USB_DEVICE_AUDIO_TransferAbortAllow(USB_DEVICE_IRP * irp)
     USB_DEVICE_AUDIO_EVENT_DATA_READ_COMPLETE readEventData;
     USB_DEVICE_AUDIO_INSTANCE *thisAudioInstance;
     USB_DEVICE_AUDIO_INDEX iAudio;
-    uint8_t cnt;
+    uint16_t cnt;
     USB_DEVICE_AUDIO_IRP_DATA *audioIrpData;
     USB_DEVICE_AUDIO_EVENT event;
 
@@ -874,7 +880,7 @@ void _USB_DEVICE_AUDIO_TransferAbortAllow(USB_DEVICE_IRP * irp)
      * in the lower 16 bits and the and the unique Identifier in the upper 16 bits.
      * Mask the upper 16 bits to the Audio IRP index associated with this IRP */
 
-    cnt = (uint8_t)(irp->userData & 0xFFFF);
+    cnt = (uint16_t)(irp->userData & 0xFFFF);
 
     /* Get a pointer to the Audio IRP data */
     audioIrpData = &gUSBDeviceAudioIrpData[cnt];
@@ -919,16 +925,19 @@ void _USB_DEVICE_AUDIO_TransferAbortAllow(USB_DEVICE_IRP * irp)
     /* Update Interface Number */ 
     readEventData.interfaceNum = audioIrpData->interfaceNum;
 
+    /* Return the IRP to the pool and update the queue size. The
+     * application may submit the next request from the event handler. */
     if (audioIrpData->direction == USB_DEVICE_AUDIO_READ)
     {
         event = USB_DEVICE_AUDIO_EVENT_READ_COMPLETE;
-        thisAudioInstance->currentQSizeRead--;
-
+        _USB_DEVICE_IRPPoolRelease(thisAudioInstance->irpPool, irp,
+                &thisAudioInstance->currentQSizeRead);
     }
     else
     {
         event = USB_DEVICE_AUDIO_EVENT_WRITE_COMPLETE;
-        thisAudioInstance->currentQSizeWrite--; 
+        _USB_DEVICE_IRPPoolRelease(thisAudioInstance->irpPool, irp,
+                &thisAudioInstance->currentQSizeWrite);
     }
 
     /* Send an event to the application */ 
@@ -1024,7 +1033,10 @@ void _USB_DEVICE_AUDIO_StatusSendAbortAllow(USB_DEVICE_IRP * irp)
     }
     
     event = USB_DEVICE_AUDIO_EVENT_STATUS_SEND_COMPLETE;
-    thisAudioInstance->currentQSizeStatusSend--;
+
+    /* Return the IRP to the pool and update the queue size */
+    _USB_DEVICE_IRPPoolRelease(thisAudioInstance->irpPool, irp,
+            &thisAudioInstance->currentQSizeStatusSend);
     
     /* Send an event to the application */ 
     if (thisAudioInstance->appEventCallBack)
@@ -1058,6 +1070,7 @@ void _USB_DEVICE_AUDIO_StatusSendAbortPrevent(USB_DEVICE_IRP * irp)
     USB_DEVICE_AUDIO_INSTANCE *thisAudioInstance;
     USB_DEVICE_AUDIO_INDEX iAudio;
     USB_DEVICE_AUDIO_EVENT event;
+    USB_DEVICE_IRP_STATUS irpStatus;
     
     /* Initialize Status */
     statusSendEventData.status = USB_DEVICE_AUDIO_RESULT_ERROR;
@@ -1075,15 +1088,19 @@ void _USB_DEVICE_AUDIO_StatusSendAbortPrevent(USB_DEVICE_IRP * irp)
       * userData field of the IRP when the IRP was submitted. */
     statusSendEventData.handle = ( USB_DEVICE_AUDIO_TRANSFER_HANDLE ) irp->userData;
     
-      /* Get transfer status */
-    if ((irp->status == USB_DEVICE_IRP_STATUS_COMPLETED) 
-        || (irp->status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
+    /* Get transfer status. The IRP is returned to the pool whether or not
+     * the event is reported to the application. */
+    irpStatus = irp->status;
+    _USB_DEVICE_IRPPoolRelease(thisAudioInstance->irpPool, irp,
+            &thisAudioInstance->currentQSizeStatusSend);
+
+    if ((irpStatus == USB_DEVICE_IRP_STATUS_COMPLETED) 
+        || (irpStatus == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
     {
         /* Transfer completed successfully */
         statusSendEventData.status = USB_DEVICE_AUDIO_RESULT_OK; 
         
         event = USB_DEVICE_AUDIO_EVENT_STATUS_SEND_COMPLETE;
-        thisAudioInstance->currentQSizeStatusSend--;
     
         /* Send an event to the application */ 
         if (thisAudioInstance->appEventCallBack)
@@ -276,6 +276,12 @@ void _USB_DEVICE_AUDIO_V2_SetupPacketHandler
                     /* Get pointer to the current audio streaming interface */
                     pStreamingInterface = 
                                &(curInfCollection->streamInf[streamIntfcIndex]);
+
+#if defined(USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER)
+                    /* The stream belongs to the previous alternate setting.
+                     * The application starts it again on the new one. */
+                    _USB_DEVICE_AUDIO_V2_StreamStop(iAudio, streamIntfcIndex);
+#endif
                     
                     /* Get pointer to the Interface Alternate setting. */
                     pCurAlternateStng = 
@@ -719,6 +725,12 @@ void _USB_DEVICE_AUDIO_V2_Initialize
                     /* Save max packet size to the data interface */
                     audioInstance->infCollection.streamInf[strmIntrfcIndex].alterntSetting[alternateSetting].isoDataEp.epMaxPacketSize 
                             = maxPacketSize;
+
+#if defined(USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER)
+                    /* Save the polling interval for the stream packet rate */
+                    audioInstance->infCollection.streamInf[strmIntrfcIndex].alterntSetting[alternateSetting].isoDataEp.epInterval 
+                            = pEPDesc->bInterval;
+#endif
                 }
                 else if (pEPDesc->usageType == USB_USAGE_FEEDBACK_ENDPOINT)
                 {
@@ -729,6 +741,11 @@ void _USB_DEVICE_AUDIO_V2_Initialize
                     /* Save max packet size to the Sync interface */
                     audioInstance->infCollection.streamInf[strmIntrfcIndex].alterntSetting[alternateSetting].isoSyncEp.epMaxPacketSize 
                             = maxPacketSize;
+
+#if defined(USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER)
+                    audioInstance->infCollection.streamInf[strmIntrfcIndex].alterntSetting[alternateSetting].isoSyncEp.epInterval 
+                            = pEPDesc->bInterval;
+#endif
                 }
             }
             break;
@@ -751,6 +768,17 @@ void _USB_DEVICE_AUDIO_V2_Deinitialize ( SYS_MODULE_INDEX iAudio )
         SYS_ASSERT(false," Invalid instance");
         return;
     }
+
+#if defined(USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER)
+    {
+        uint8_t streamIndex;
+
+        for (streamIndex = 0; streamIndex < USB_DEVICE_AUDIO_V2_MAX_STREAMING_INTERFACES; streamIndex ++)
+        {
+            _USB_DEVICE_AUDIO_V2_StreamStop(iAudio, streamIndex);
+        }
+    }
+#endif
    _USB_DEVICE_AUDIO_V2_IRPCancelAll(iAudio);
 }
 
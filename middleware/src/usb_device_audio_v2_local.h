@@ -53,6 +53,18 @@
 #include "usb/src/usb_device_local.h"
 #include "usb/usb_device_audio_v2_0.h"
 
+#if defined(USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER)
+
+/* Number of bus frames over which a stream measures the rate at which the
+ * application consumes audio frames */
+#define USB_DEVICE_AUDIO_V2_STREAM_RATE_WINDOW      128
+
+/* Divider of the ring level error that is added to the measured rate. A
+ * level error of this many audio frames changes the feedback value by one
+ * audio frame per bus frame. */
+#define USB_DEVICE_AUDIO_V2_STREAM_LEVEL_DIVIDER    128
+
+#endif
 
 // *****************************************************************************
 /* Audio flags.
@@ -163,6 +175,11 @@ typedef struct
 
     /* Indicates if the endpoint is Enabled or not */ 
     bool status;
+
+#if defined(USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER)
+    /* bInterval of the endpoint descriptor */
+    uint8_t epInterval;
+#endif
 }USB_DEVICE_AUDIO_V2_EP_INSTANCE;
 
 // *****************************************************************************
@@ -191,6 +208,125 @@ typedef struct
 
 }USB_DEVICE_AUDIO_V2_STREAMING_INTERFACE_ALTERNATE_SETTING;
 
+#if defined(USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER)
+
+// *****************************************************************************
+/* Audio stream object.
+
+  Summary:
+    Holds the state of an isochronous stream of an audio streaming interface.
+
+  Description:
+    The stream moves audio data between the isochronous data endpoint and a
+    ring owned by the application. It has USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER
+    IRPs of one packet each.
+
+    On an OUT data endpoint, the ring is split into one slot per IRP. The IRP
+    of a free slot is kept armed, and a slot is armed again once the
+    application has consumed its data. The stream computes the value of the
+    explicit feedback endpoint from the rate at which the application
+    consumes audio frames and from the ring level.
+
+    On an IN data endpoint, the ring is a byte ring. The IRPs send the data
+    committed by the application in packets that follow the nominal sample
+    rate and are corrected by one audio frame to keep the ring level at its
+    target.
+
+  Remarks:
+    This structure is internal to the Audio function driver.
+*/
+typedef struct
+{
+    /* True if the stream has been started and no transfer was aborted */
+    volatile bool isStarted;
+
+    /* True if the ring level has reached its target since the stream was
+     * started or since the last underrun */
+    volatile bool isPrimed;
+
+    /* True if the data endpoint is an IN endpoint */
+    bool isWrite;
+
+    /* True if the driver supports IRPs with data segments */
+    bool segmentsSupported;
+
+    /* Device layer handle and endpoints of the stream. The feedback endpoint
+     * is 0 if the stream has none. */
+    USB_DEVICE_HANDLE deviceHandle;
+    USB_ENDPOINT dataEndpoint;
+    USB_ENDPOINT feedbackEndpoint;
+
+    /* Application ring */
+    uint8_t * buffer;
+    size_t bufferSize;
+
+    /* Size of an audio frame in bytes */
+    size_t frameSize;
+
+    /* Nominal audio frames per packet in 16.16 format */
+    uint32_t packetNominal;
+
+    /* Nominal audio frames per 1 millisecond bus frame in 16.16 format */
+    uint32_t rateNominal;
+
+    /* Ring level in bytes. This is the received data that the application
+     * has not consumed, or the committed data that is not submitted. */
+    volatile size_t level;
+
+    /* Ring level that the stream keeps */
+    size_t levelTarget;
+
+    /* Packet IRPs and the data segments of the IN IRPs */
+    USB_DEVICE_IRP irp[USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER];
+    USB_IRP_DATA_SEGMENT segment[USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER][2];
+
+    /* Number of packet IRPs in flight */
+    volatile unsigned int irpsPending;
+
+    /* Largest packet of the sample rate in bytes. This is the size of the
+     * OUT packet IRPs. */
+    size_t packetSize;
+
+    /* OUT: Size of a ring slot, slot that the application reads from and
+     * bytes of that slot consumed */
+    size_t slotSize;
+    unsigned int readSlot;
+    size_t readOffset;
+
+    /* IN: Next IRP to be submitted, ring offset at which the application
+     * writes next, ring offset of the first byte that is not submitted,
+     * bytes that are not sent and fraction of an audio frame carried to the
+     * next packet in 16.16 format */
+    unsigned int irpSubmit;
+    size_t write;
+    size_t send;
+    volatile size_t used;
+    uint32_t packetRemainder;
+
+    /* Feedback IRP, its data and the size of the data. The size is 4 bytes
+     * at high speed and 3 bytes at full speed. */
+    USB_DEVICE_IRP feedbackIRP;
+    uint8_t feedbackData[4];
+    size_t feedbackSize;
+    volatile bool feedbackPending;
+
+    /* Measured consumption rate in audio frames per bus frame in 16.16
+     * format, and the frame number and consumed byte count at the start of
+     * the measurement window */
+    uint32_t rate;
+    uint16_t rateFrameNumber;
+    uint32_t rateBytes;
+
+    /* Bytes consumed by the application since the stream was started */
+    volatile uint32_t bytesConsumed;
+
+    /* Stream statistics */
+    USB_DEVICE_AUDIO_V2_STREAM_STATISTICS statistics;
+
+} USB_DEVICE_AUDIO_V2_STREAM;
+
+#endif
+
 // *****************************************************************************
 /* USB Device Audio Streaming Interface structure
 
@@ -218,6 +354,11 @@ typedef struct
     /* Array of Alternate settings for a Streaming Interface*/
     USB_DEVICE_AUDIO_V2_STREAMING_INTERFACE_ALTERNATE_SETTING  alterntSetting[USB_DEVICE_AUDIO_V2_MAX_ALTERNATE_SETTING];
 
+#if defined(USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER)
+    /* Isochronous stream of this interface */
+    USB_DEVICE_AUDIO_V2_STREAM stream;
+#endif
+
 }USB_DEVICE_AUDIO_V2_STREAMING_INTERFACE;
 
 
@@ -413,6 +554,14 @@ void _USB_DEVICE_AUDIO_V2_SetupPacketHandler
     USB_SETUP_PACKET* controlEventData
 );
 void _USB_DEVICE_AUDIO_V2_GlobalInitialize (void);
+
+#if defined(USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER)
+void _USB_DEVICE_AUDIO_V2_StreamStop
+(
+    USB_DEVICE_AUDIO_V2_INDEX iAudio,
+    uint8_t streamIndex
+);
+#endif
 #endif
 
  /************ End of file *************************************/
@@ -529,6 +529,1116 @@ USB_DEVICE_AUDIO_V2_RESULT _USB_DEVICE_AUDIO_V2_Transfer
     return(USB_DEVICE_AUDIO_V2_RESULT_ERROR_TRANSFER_QUEUE_FULL);
 }
 
+#if defined(USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER)
+static void _USB_DEVICE_AUDIO_V2_StreamFeedbackIRPCallback ( USB_DEVICE_IRP * irp );
+static void _USB_DEVICE_AUDIO_V2_StreamWriteIRPCallback ( USB_DEVICE_IRP * irp );
+
+/*******************************************************************************
+  Function:
+    USB_DEVICE_AUDIO_V2_RESULT _USB_DEVICE_AUDIO_V2_StreamIndexGet
+    (
+        USB_DEVICE_AUDIO_V2_INDEX iAudio,
+        uint8_t interfaceNum,
+        uint8_t * streamIndex
+    )
+
+  Summary:
+    Returns the streaming interface array index of an interface number.
+
+  Description:
+    This function validates the instance and the interface number and
+    returns the array index of the audio streaming interface.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static USB_DEVICE_AUDIO_V2_RESULT _USB_DEVICE_AUDIO_V2_StreamIndexGet
+(
+    USB_DEVICE_AUDIO_V2_INDEX iAudio,
+    uint8_t interfaceNum,
+    uint8_t * streamIndex
+)
+{
+    USB_DEVICE_AUDIO_V2_INTERFACE_COLLECTION * infCollection;
+    uint8_t index;
+
+    /* check the validity of the function driver index */
+    if ( USB_DEVICE_AUDIO_V2_INSTANCES_NUMBER <= iAudio )
+    {
+        SYS_ASSERT ( false , "Invalid Audio Index" );
+        return USB_DEVICE_AUDIO_V2_RESULT_ERROR_INSTANCE_INVALID;
+    }
+
+    infCollection = &gUsbDeviceAudioV2Instance[iAudio].infCollection;
+    index = interfaceNum - infCollection->bControlInterfaceNum - 1;
+
+    if ((index >= USB_DEVICE_AUDIO_V2_MAX_STREAMING_INTERFACES) ||
+            (interfaceNum != infCollection->streamInf[index].interfaceNum))
+    {
+        SYS_ASSERT ( false , "Invalid interface number " );
+        return USB_DEVICE_AUDIO_V2_RESULT_ERROR_INVALID_INTERFACE_ID;
+    }
+
+    *streamIndex = index;
+    return USB_DEVICE_AUDIO_V2_RESULT_OK;
+}
+
+/*******************************************************************************
+  Function:
+    void _USB_DEVICE_AUDIO_V2_StreamReadIRPCallback ( USB_DEVICE_IRP * irp )
+
+  Summary:
+    IRP call back for stream packets received on an OUT data endpoint.
+
+  Description:
+    This function adds a received packet to the ring level. The stream is
+    primed once the level reaches its target. An overrun is counted if no
+    slot is left armed, because the host packets are then lost until the
+    application consumes data.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static void _USB_DEVICE_AUDIO_V2_StreamReadIRPCallback ( USB_DEVICE_IRP * irp )
+{
+    USB_DEVICE_AUDIO_V2_STREAM * stream = (USB_DEVICE_AUDIO_V2_STREAM *)(irp->userData);
+
+    stream->irpsPending --;
+
+    if ((irp->status == USB_DEVICE_IRP_STATUS_COMPLETED)
+        || (irp->status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
+    {
+        stream->statistics.packets ++;
+        stream->level += irp->size;
+
+        if (stream->level >= stream->levelTarget)
+        {
+            stream->isPrimed = true;
+        }
+
+        if ((stream->irpsPending == 0) && (stream->isStarted))
+        {
+            stream->statistics.overruns ++;
+        }
+    }
+}
+
+/*******************************************************************************
+  Function:
+    USB_ERROR _USB_DEVICE_AUDIO_V2_StreamReadSubmit
+    (
+        USB_DEVICE_AUDIO_V2_STREAM * stream,
+        unsigned int slot
+    )
+
+  Summary:
+    Arms the IRP of a ring slot.
+
+  Description:
+    This function submits the IRP of the specified ring slot on the OUT data
+    endpoint so that the slot receives the next packet sent by the host.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static USB_ERROR _USB_DEVICE_AUDIO_V2_StreamReadSubmit
+(
+    USB_DEVICE_AUDIO_V2_STREAM * stream,
+    unsigned int slot
+)
+{
+    USB_DEVICE_IRP * irp = &stream->irp[slot];
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    USB_ERROR irpErr;
+
+    irp->data = stream->buffer + (slot * stream->slotSize);
+    irp->size = stream->packetSize;
+    irp->userData = (uintptr_t) stream;
+    irp->callback = _USB_DEVICE_AUDIO_V2_StreamReadIRPCallback;
+    irp->flags = USB_DEVICE_IRP_FLAG_NONE;
+
+    /* The IRP callback also updates the count */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    stream->irpsPending ++;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+    irpErr = USB_DEVICE_IRPSubmit(stream->deviceHandle, stream->dataEndpoint, irp);
+    if (irpErr != USB_ERROR_NONE)
+    {
+        IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+        stream->irpsPending --;
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+    }
+
+    return irpErr;
+}
+
+/*******************************************************************************
+  Function:
+    USB_DEVICE_IRP * _USB_DEVICE_AUDIO_V2_StreamReadSlotGet
+    (
+        USB_DEVICE_AUDIO_V2_STREAM * stream
+    )
+
+  Summary:
+    Returns the IRP of the ring slot that the application reads from.
+
+  Description:
+    This function returns the IRP of the oldest ring slot that contains data
+    that the application has not consumed. Slots that have been consumed,
+    that contain no data or whose packet was lost on the bus are armed again
+    and skipped. The function returns NULL if no data is available. The
+    stream is stopped if an IRP was aborted.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static USB_DEVICE_IRP * _USB_DEVICE_AUDIO_V2_StreamReadSlotGet
+(
+    USB_DEVICE_AUDIO_V2_STREAM * stream
+)
+{
+    USB_DEVICE_IRP * irp;
+    USB_DEVICE_IRP_STATUS status;
+
+    while (stream->isStarted)
+    {
+        irp = &stream->irp[stream->readSlot];
+        status = irp->status;
+
+        if ((status == USB_DEVICE_IRP_STATUS_COMPLETED)
+            || (status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
+        {
+            if (stream->readOffset < irp->size)
+            {
+                /* This slot still has data */
+                return irp;
+            }
+        }
+        else if ((status == USB_DEVICE_IRP_STATUS_PENDING)
+            || (status == USB_DEVICE_IRP_STATUS_IN_PROGRESS))
+        {
+            /* No data received yet */
+            break;
+        }
+        else if (status != USB_DEVICE_IRP_STATUS_ERROR)
+        {
+            /* The IRP was aborted. The stream must be started again. */
+            stream->isStarted = false;
+            break;
+        }
+
+        /* The slot is empty. Arm it again and move to the next slot. */
+        stream->readOffset = 0;
+        if (_USB_DEVICE_AUDIO_V2_StreamReadSubmit(stream, stream->readSlot) != USB_ERROR_NONE)
+        {
+            stream->isStarted = false;
+            break;
+        }
+        stream->readSlot = (stream->readSlot + 1) % USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER;
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+  Function:
+    void _USB_DEVICE_AUDIO_V2_StreamFeedbackSubmit
+    (
+        USB_DEVICE_AUDIO_V2_STREAM * stream
+    )
+
+  Summary:
+    Computes the feedback value and submits it on the feedback endpoint.
+
+  Description:
+    This function measures the rate at which the application consumes audio
+    frames over USB_DEVICE_AUDIO_V2_STREAM_RATE_WINDOW bus frames, using the
+    SOF frame number, and filters it. The feedback value is the filtered rate
+    plus a correction that is proportional to the difference between the
+    ring level and its target. It is limited to 1/32 around the nominal rate,
+    so that a packet always fits in a ring slot. The measurement restarts
+    while the stream is not primed, because the application does not consume
+    data then.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application. It is called from the application context when the stream
+    starts and from the feedback IRP callback.
+*/
+
+static void _USB_DEVICE_AUDIO_V2_StreamFeedbackSubmit
+(
+    USB_DEVICE_AUDIO_V2_STREAM * stream
+)
+{
+    USB_DEVICE_IRP * irp = &stream->feedbackIRP;
+    uint16_t frameNumber;
+    uint16_t frames;
+    uint32_t consumed;
+    uint32_t measured;
+    int32_t error;
+    int32_t value;
+    int32_t limit;
+
+    frameNumber = USB_DEVICE_SOFNumberGet(stream->deviceHandle);
+    frames = (uint16_t)((frameNumber - stream->rateFrameNumber) & 0x7FF);
+
+    if (!(stream->isPrimed))
+    {
+        /* The application does not consume data. Restart the measurement. */
+        stream->rateFrameNumber = frameNumber;
+        stream->rateBytes = stream->bytesConsumed;
+    }
+    else if (frames >= USB_DEVICE_AUDIO_V2_STREAM_RATE_WINDOW)
+    {
+        /* Audio frames consumed per bus frame in the window, filtered with a
+         * time constant of 8 windows */
+        consumed = (stream->bytesConsumed - stream->rateBytes) / stream->frameSize;
+        measured = (uint32_t)((((uint64_t)consumed) << 16) / frames);
+        stream->rate = (uint32_t)((int32_t)stream->rate + (((int32_t)measured - (int32_t)stream->rate) / 8));
+
+        stream->rateFrameNumber = frameNumber;
+        stream->rateBytes += consumed * stream->frameSize;
+    }
+
+    /* Move the level towards its target */
+    error = ((int32_t)stream->levelTarget - (int32_t)stream->level) / (int32_t)stream->frameSize;
+    value = (int32_t)stream->rate + (error * (65536 / USB_DEVICE_AUDIO_V2_STREAM_LEVEL_DIVIDER));
+
+    limit = (int32_t)(stream->rateNominal / 32);
+    if (value > ((int32_t)stream->rateNominal + limit))
+    {
+        value = (int32_t)stream->rateNominal + limit;
+    }
+    else if (value < ((int32_t)stream->rateNominal - limit))
+    {
+        value = (int32_t)stream->rateNominal - limit;
+    }
+
+    if (stream->feedbackSize == 4)
+    {
+        /* 16.16 format, audio frames per micro frame */
+        value = value / 8;
+    }
+    else
+    {
+        /* 10.14 format, audio frames per frame */
+        value = value / 4;
+    }
+
+    stream->statistics.feedback = (uint32_t)value;
+    stream->feedbackData[0] = (uint8_t)(value);
+    stream->feedbackData[1] = (uint8_t)(value >> 8);
+    stream->feedbackData[2] = (uint8_t)(value >> 16);
+    stream->feedbackData[3] = (uint8_t)(value >> 24);
+
+    irp->data = stream->feedbackData;
+    irp->size = stream->feedbackSize;
+    irp->userData = (uintptr_t) stream;
+    irp->callback = _USB_DEVICE_AUDIO_V2_StreamFeedbackIRPCallback;
+    irp->flags = USB_DEVICE_IRP_FLAG_DATA_COMPLETE;
+
+    /* The IRP may complete before the submit returns */
+    stream->feedbackPending = true;
+    if (USB_DEVICE_IRPSubmit(stream->deviceHandle, stream->feedbackEndpoint, irp)
+            != USB_ERROR_NONE)
+    {
+        /* The data stream continues without feedback */
+        stream->feedbackPending = false;
+    }
+}
+
+/*******************************************************************************
+  Function:
+    void _USB_DEVICE_AUDIO_V2_StreamFeedbackIRPCallback ( USB_DEVICE_IRP * irp )
+
+  Summary:
+    IRP call back for the stream feedback IRP.
+
+  Description:
+    This function submits the next feedback value when the host has read the
+    last one.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static void _USB_DEVICE_AUDIO_V2_StreamFeedbackIRPCallback ( USB_DEVICE_IRP * irp )
+{
+    USB_DEVICE_AUDIO_V2_STREAM * stream = (USB_DEVICE_AUDIO_V2_STREAM *)(irp->userData);
+
+    stream->feedbackPending = false;
+
+    if ((stream->isStarted) &&
+            ((irp->status == USB_DEVICE_IRP_STATUS_COMPLETED)
+            || (irp->status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT)
+            || (irp->status == USB_DEVICE_IRP_STATUS_ERROR)))
+    {
+        _USB_DEVICE_AUDIO_V2_StreamFeedbackSubmit(stream);
+    }
+}
+
+/*******************************************************************************
+  Function:
+    void _USB_DEVICE_AUDIO_V2_StreamWriteSubmit
+    (
+        USB_DEVICE_AUDIO_V2_STREAM * stream
+    )
+
+  Summary:
+    Submits committed ring data on the IN data endpoint.
+
+  Description:
+    This function submits one packet per free IRP while the stream is primed.
+    The number of audio frames per packet follows the nominal sample rate,
+    with the fraction carried to the next packet. One audio frame is added or
+    removed when the ring level is more than a packet away from its target.
+
+    A packet that wraps around the end of the ring is sent with two data
+    segments if the driver supports them. Otherwise it ends at the end of
+    the ring and the remaining audio frames are sent with the next packet.
+
+    If the committed data is shorter than the packet, the data is sent, an
+    underrun is counted and the stream waits for the ring to be half full
+    again.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application. It is called from the application context and from the
+    IRP callback.
+*/
+
+static void _USB_DEVICE_AUDIO_V2_StreamWriteSubmit
+(
+    USB_DEVICE_AUDIO_V2_STREAM * stream
+)
+{
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    USB_DEVICE_IRP * irp;
+    USB_IRP_DATA_SEGMENT * segment;
+    uint32_t frames;
+    size_t length;
+    size_t contiguous;
+
+    /* The IRP callback also calls this function */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+    while ((stream->isStarted) && (stream->isPrimed)
+            && (stream->irpsPending < USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER))
+    {
+        stream->packetRemainder += stream->packetNominal;
+        frames = stream->packetRemainder >> 16;
+        stream->packetRemainder &= 0xFFFF;
+
+        if (stream->level > (stream->levelTarget + stream->packetSize))
+        {
+            frames ++;
+        }
+        else if (((stream->level + stream->packetSize) < stream->levelTarget) && (frames > 0))
+        {
+            frames --;
+        }
+
+        length = frames * stream->frameSize;
+        if (length > stream->level)
+        {
+            /* Send what is left and wait until the ring is half full again */
+            length = stream->level;
+            stream->packetRemainder = 0;
+            stream->isPrimed = false;
+            stream->statistics.underruns ++;
+
+            if (length == 0)
+            {
+                break;
+            }
+        }
+
+        irp = &stream->irp[stream->irpSubmit];
+        irp->flags = USB_DEVICE_IRP_FLAG_DATA_COMPLETE;
+        irp->data = stream->buffer + stream->send;
+
+        contiguous = stream->bufferSize - stream->send;
+        if (length > contiguous)
+        {
+            if (stream->segmentsSupported)
+            {
+                segment = stream->segment[stream->irpSubmit];
+                segment[0].data = stream->buffer + stream->send;
+                segment[0].size = contiguous;
+                segment[1].data = stream->buffer;
+                segment[1].size = length - contiguous;
+
+                irp->data = segment;
+                irp->flags |= USB_DEVICE_IRP_FLAG_DATA_SEGMENTS;
+            }
+            else
+            {
+                stream->packetRemainder += ((length - contiguous) / stream->frameSize) << 16;
+                length = contiguous;
+            }
+        }
+
+        irp->size = length;
+        irp->userData = (uintptr_t) stream;
+        irp->callback = _USB_DEVICE_AUDIO_V2_StreamWriteIRPCallback;
+
+        /* Update the ring before the submit. The IRP may complete before
+         * USB_DEVICE_IRPSubmit() returns. */
+        stream->irpsPending ++;
+        stream->irpSubmit = (stream->irpSubmit + 1) % USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER;
+        stream->send = (stream->send + length) % stream->bufferSize;
+        stream->level -= length;
+
+        if (USB_DEVICE_IRPSubmit(stream->deviceHandle, stream->dataEndpoint, irp)
+                != USB_ERROR_NONE)
+        {
+            /* The endpoint does not accept IRPs. The stream must be started
+             * again. */
+            stream->irpsPending --;
+            stream->isStarted = false;
+            break;
+        }
+    }
+
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+}
+
+/*******************************************************************************
+  Function:
+    void _USB_DEVICE_AUDIO_V2_StreamWriteIRPCallback ( USB_DEVICE_IRP * irp )
+
+  Summary:
+    IRP call back for stream packets sent on an IN data endpoint.
+
+  Description:
+    This function releases the ring space of a sent packet and submits the
+    next packet. A packet that was not sent because of a bus error is
+    released as well.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static void _USB_DEVICE_AUDIO_V2_StreamWriteIRPCallback ( USB_DEVICE_IRP * irp )
+{
+    USB_DEVICE_AUDIO_V2_STREAM * stream = (USB_DEVICE_AUDIO_V2_STREAM *)(irp->userData);
+
+    stream->irpsPending --;
+
+    if ((irp->status == USB_DEVICE_IRP_STATUS_COMPLETED)
+        || (irp->status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT)
+        || (irp->status == USB_DEVICE_IRP_STATUS_ERROR))
+    {
+        if (irp->status != USB_DEVICE_IRP_STATUS_ERROR)
+        {
+            stream->statistics.packets ++;
+        }
+
+        stream->used -= irp->size;
+        _USB_DEVICE_AUDIO_V2_StreamWriteSubmit(stream);
+    }
+    else
+    {
+        /* The transfer was aborted. The stream must be started again. */
+        stream->isStarted = false;
+    }
+}
+
+/*******************************************************************************
+  Function:
+    void _USB_DEVICE_AUDIO_V2_StreamStop
+    (
+        USB_DEVICE_AUDIO_V2_INDEX iAudio,
+        uint8_t streamIndex
+    )
+
+  Summary:
+    Stops the stream of an audio streaming interface.
+
+  Description:
+    This function stops the stream of the specified streaming interface and
+    cancels its IRPs. It is called when the alternate setting of the
+    interface changes and when the function driver is deinitialized.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+void _USB_DEVICE_AUDIO_V2_StreamStop
+(
+    USB_DEVICE_AUDIO_V2_INDEX iAudio,
+    uint8_t streamIndex
+)
+{
+    USB_DEVICE_AUDIO_V2_STREAM * stream =
+            &gUsbDeviceAudioV2Instance[iAudio].infCollection.streamInf[streamIndex].stream;
+
+    stream->isStarted = false;
+
+    if (stream->irpsPending > 0)
+    {
+        USB_DEVICE_IRPCancelAll(stream->deviceHandle, stream->dataEndpoint);
+    }
+
+    if (stream->feedbackPending)
+    {
+        USB_DEVICE_IRPCancelAll(stream->deviceHandle, stream->feedbackEndpoint);
+    }
+}
+
+/*******************************************************************************
+  Function:
+    USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamStart
+    (
+        USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+        uint8_t interfaceNumber,
+        const USB_DEVICE_AUDIO_V2_STREAM_CONFIG * config
+    );
+
+  Summary:
+    Starts the isochronous stream of an audio streaming interface.
+
+  Description:
+    This function derives the packet size and the ring level target from the
+    sample rate and the data endpoint of the active alternate setting. For an
+    OUT data endpoint, it arms the IRPs of all ring slots and submits the
+    first feedback value.
+
+  Remarks:
+    Refer to usb_device_audio_v2_0.h for usage information.
+*/
+
+USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamStart
+(
+    USB_DEVICE_AUDIO_V2_INDEX iAudio,
+    uint8_t interfaceNum,
+    const USB_DEVICE_AUDIO_V2_STREAM_CONFIG * config
+)
+{
+    USB_DEVICE_AUDIO_V2_RESULT audioResult;
+    USB_DEVICE_AUDIO_V2_STREAMING_INTERFACE * streamingInterface;
+    USB_DEVICE_AUDIO_V2_STREAMING_INTERFACE_ALTERNATE_SETTING * alternateSetting;
+    USB_DEVICE_AUDIO_V2_STREAM * stream;
+    uint8_t streamIndex;
+    uint8_t interval;
+    uint16_t maxPacketSize;
+    uint32_t packetsPerSecond;
+    unsigned int slot;
+
+    audioResult = _USB_DEVICE_AUDIO_V2_StreamIndexGet(iAudio, interfaceNum, &streamIndex);
+    if (audioResult != USB_DEVICE_AUDIO_V2_RESULT_OK)
+    {
+        return audioResult;
+    }
+
+    if ((config == NULL) || (config->buffer == NULL) || (config->frameSize == 0)
+            || (config->sampleRate == 0))
+    {
+        return USB_DEVICE_AUDIO_V2_RESULT_ERROR_PARAMETER_INVALID;
+    }
+
+    streamingInterface = &gUsbDeviceAudioV2Instance[iAudio].infCollection.streamInf[streamIndex];
+    stream = &streamingInterface->stream;
+
+    if ((streamingInterface->activeSetting == 0) ||
+            (streamingInterface->state != USB_DEVICE_AUDIO_V2_STRMNG_INTFC_INITIALIZED))
+    {
+        /* Alternate setting 0 has no data endpoint */
+        return USB_DEVICE_AUDIO_V2_RESULT_ERROR_INSTANCE_NOT_CONFIGURED;
+    }
+
+    if (stream->isStarted)
+    {
+        return USB_DEVICE_AUDIO_V2_RESULT_OK;
+    }
+
+    if ((stream->irpsPending != 0) || (stream->feedbackPending))
+    {
+        /* IRPs of the last stream have not been returned yet */
+        return USB_DEVICE_AUDIO_V2_RESULT_ERROR_TRANSFER_QUEUE_FULL;
+    }
+
+    alternateSetting = &streamingInterface->alterntSetting[streamingInterface->activeSetting];
+
+    /* A packet is sent every 2^(bInterval - 1) frames or micro frames */
+    interval = alternateSetting->isoDataEp.epInterval;
+    interval = (interval == 0) ? 1 : ((interval > 4) ? 4 : interval);
+
+    stream->deviceHandle = gUsbDeviceAudioV2Instance[iAudio].devLayerHandle;
+    if (USB_DEVICE_ActiveSpeedGet(stream->deviceHandle) == USB_SPEED_HIGH)
+    {
+        packetsPerSecond = 8000 >> (interval - 1);
+        stream->feedbackSize = 4;
+    }
+    else
+    {
+        packetsPerSecond = 1000 >> (interval - 1);
+        stream->feedbackSize = 3;
+    }
+
+    stream->packetNominal = (uint32_t)((((uint64_t)config->sampleRate) << 16) / packetsPerSecond);
+    stream->rateNominal = (uint32_t)((((uint64_t)config->sampleRate) << 16) / 1000);
+
+    /* The largest packet carries two audio frames more than the integer
+     * part of the nominal rate */
+    stream->packetSize = ((stream->packetNominal >> 16) + 2) * config->frameSize;
+
+    /* Bits 12:11 of the maximum packet size are the additional transactions
+     * per micro frame of a high bandwidth endpoint */
+    maxPacketSize = alternateSetting->isoDataEp.epMaxPacketSize;
+    if (stream->packetSize > ((maxPacketSize & 0x7FF) * (((maxPacketSize >> 11) & 0x3) + 1)))
+    {
+        SYS_ASSERT ( false , "Sample rate does not fit the data endpoint" );
+        return USB_DEVICE_AUDIO_V2_RESULT_ERROR_PARAMETER_INVALID;
+    }
+
+    stream->buffer = (uint8_t *) config->buffer;
+    stream->bufferSize = config->bufferSize;
+    stream->frameSize = config->frameSize;
+    stream->dataEndpoint = alternateSetting->isoDataEp.epAddr;
+    stream->isWrite = ((stream->dataEndpoint & 0x80) != 0);
+    stream->feedbackEndpoint = 0;
+
+    if (stream->isWrite)
+    {
+        /* The ring holds the level target plus the packets in flight */
+        if (((config->bufferSize % config->frameSize) != 0) ||
+                (config->bufferSize < (2 * (USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER + 1) * stream->packetSize)))
+        {
+            SYS_ASSERT ( false , "Stream ring is too small" );
+            return USB_DEVICE_AUDIO_V2_RESULT_ERROR_PARAMETER_INVALID;
+        }
+
+        stream->levelTarget = (config->bufferSize / 2) - ((config->bufferSize / 2) % config->frameSize);
+        stream->segmentsSupported = USB_DEVICE_IRPDataSegmentsIsSupported(stream->deviceHandle);
+    }
+    else
+    {
+        /* Slots are kept at a 16 byte boundary for the PIC32MZ DMA */
+        stream->slotSize = (config->bufferSize / USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER) & ~((size_t)0xF);
+        if (stream->slotSize < stream->packetSize)
+        {
+            SYS_ASSERT ( false , "Stream ring is too small" );
+            return USB_DEVICE_AUDIO_V2_RESULT_ERROR_PARAMETER_INVALID;
+        }
+
+        /* The level target is half of the slots with nominal packets */
+        stream->levelTarget = ((USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER * stream->packetNominal) >> 17) * config->frameSize;
+
+        if ((alternateSetting->numEndPoints == 2) && (alternateSetting->isoSyncEp.epAddr & 0x80))
+        {
+            /* Explicit feedback endpoint */
+            stream->feedbackEndpoint = alternateSetting->isoSyncEp.epAddr;
+        }
+    }
+
+    stream->isPrimed = false;
+    stream->level = 0;
+    stream->readSlot = 0;
+    stream->readOffset = 0;
+    stream->irpSubmit = 0;
+    stream->write = 0;
+    stream->send = 0;
+    stream->used = 0;
+    stream->packetRemainder = 0;
+    stream->rate = stream->rateNominal;
+    stream->bytesConsumed = 0;
+    stream->rateBytes = 0;
+    stream->statistics.packets = 0;
+    stream->statistics.underruns = 0;
+    stream->statistics.overruns = 0;
+    stream->statistics.feedback = 0;
+    stream->statistics.level = 0;
+
+    stream->isStarted = true;
+
+    if (!(stream->isWrite))
+    {
+        for (slot = 0; slot < USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER; slot ++)
+        {
+            if (_USB_DEVICE_AUDIO_V2_StreamReadSubmit(stream, slot) != USB_ERROR_NONE)
+            {
+                /* Return the IRPs that were armed */
+                _USB_DEVICE_AUDIO_V2_StreamStop(iAudio, streamIndex);
+                return USB_DEVICE_AUDIO_V2_RESULT_ERROR;
+            }
+        }
+
+        if (stream->feedbackEndpoint != 0)
+        {
+            _USB_DEVICE_AUDIO_V2_StreamFeedbackSubmit(stream);
+        }
+    }
+
+    return USB_DEVICE_AUDIO_V2_RESULT_OK;
+}
+
+/*******************************************************************************
+  Function:
+    USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamStop
+    (
+        USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+        uint8_t interfaceNumber
+    );
+
+  Summary:
+    Stops the isochronous stream of an audio streaming interface.
+
+  Description:
+    This function stops the stream and cancels its IRPs.
+
+  Remarks:
+    Refer to usb_device_audio_v2_0.h for usage information.
+*/
+
+USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamStop
+(
+    USB_DEVICE_AUDIO_V2_INDEX iAudio,
+    uint8_t interfaceNum
+)
+{
+    USB_DEVICE_AUDIO_V2_RESULT audioResult;
+    uint8_t streamIndex;
+
+    audioResult = _USB_DEVICE_AUDIO_V2_StreamIndexGet(iAudio, interfaceNum, &streamIndex);
+    if (audioResult == USB_DEVICE_AUDIO_V2_RESULT_OK)
+    {
+        _USB_DEVICE_AUDIO_V2_StreamStop(iAudio, streamIndex);
+    }
+
+    return audioResult;
+}
+
+/*******************************************************************************
+  Function:
+    size_t USB_DEVICE_AUDIO_V2_StreamReadAcquire
+    (
+        USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+        uint8_t interfaceNumber,
+        void ** data
+    );
+
+  Summary:
+    Returns received audio data that the application can read in place.
+
+  Description:
+    This function returns a pointer to the oldest received data and the
+    number of bytes available at that pointer. It counts an underrun if the
+    primed stream has no data.
+
+  Remarks:
+    Refer to usb_device_audio_v2_0.h for usage information.
+*/
+
+size_t USB_DEVICE_AUDIO_V2_StreamReadAcquire
+(
+    USB_DEVICE_AUDIO_V2_INDEX iAudio,
+    uint8_t interfaceNum,
+    void ** data
+)
+{
+    USB_DEVICE_AUDIO_V2_STREAM * stream;
+    USB_DEVICE_IRP * irp;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    uint8_t streamIndex;
+
+    if ((_USB_DEVICE_AUDIO_V2_StreamIndexGet(iAudio, interfaceNum, &streamIndex)
+                != USB_DEVICE_AUDIO_V2_RESULT_OK) || (data == NULL))
+    {
+        return 0;
+    }
+
+    stream = &gUsbDeviceAudioV2Instance[iAudio].infCollection.streamInf[streamIndex].stream;
+    if (!(stream->isPrimed))
+    {
+        /* The ring is filling up */
+        return 0;
+    }
+
+    irp = _USB_DEVICE_AUDIO_V2_StreamReadSlotGet(stream);
+    if (irp == NULL)
+    {
+        if (stream->isStarted)
+        {
+            /* Wait until the ring is half full again */
+            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+            stream->isPrimed = false;
+            stream->statistics.underruns ++;
+            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+        }
+
+        return 0;
+    }
+
+    *data = (uint8_t *)irp->data + stream->readOffset;
+    return (irp->size - stream->readOffset);
+}
+
+/*******************************************************************************
+  Function:
+    USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamReadCommit
+    (
+        USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+        uint8_t interfaceNumber,
+        size_t size
+    );
+
+  Summary:
+    Releases received audio data that the application has consumed.
+
+  Description:
+    This function releases size bytes of the data returned by
+    USB_DEVICE_AUDIO_V2_StreamReadAcquire() and counts them for the rate
+    measurement. A ring slot is armed again as soon as all of its data has
+    been released.
+
+  Remarks:
+    Refer to usb_device_audio_v2_0.h for usage information.
+*/
+
+USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamReadCommit
+(
+    USB_DEVICE_AUDIO_V2_INDEX iAudio,
+    uint8_t interfaceNum,
+    size_t size
+)
+{
+    USB_DEVICE_AUDIO_V2_RESULT audioResult;
+    USB_DEVICE_AUDIO_V2_STREAM * stream;
+    USB_DEVICE_IRP * irp;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    uint8_t streamIndex;
+
+    audioResult = _USB_DEVICE_AUDIO_V2_StreamIndexGet(iAudio, interfaceNum, &streamIndex);
+    if (audioResult != USB_DEVICE_AUDIO_V2_RESULT_OK)
+    {
+        return audioResult;
+    }
+
+    stream = &gUsbDeviceAudioV2Instance[iAudio].infCollection.streamInf[streamIndex].stream;
+    irp = _USB_DEVICE_AUDIO_V2_StreamReadSlotGet(stream);
+    if (irp == NULL)
+    {
+        return ((size == 0) ? USB_DEVICE_AUDIO_V2_RESULT_OK :
+                USB_DEVICE_AUDIO_V2_RESULT_ERROR_PARAMETER_INVALID);
+    }
+
+    if (size > (irp->size - stream->readOffset))
+    {
+        /* More data than was acquired */
+        return USB_DEVICE_AUDIO_V2_RESULT_ERROR_PARAMETER_INVALID;
+    }
+
+    stream->readOffset += size;
+    stream->bytesConsumed += size;
+
+    /* The IRP callback also updates the level */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    stream->level -= size;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+    /* The slot is armed again once all of its data has been consumed */
+    _USB_DEVICE_AUDIO_V2_StreamReadSlotGet(stream);
+
+    return USB_DEVICE_AUDIO_V2_RESULT_OK;
+}
+
+/*******************************************************************************
+  Function:
+    size_t USB_DEVICE_AUDIO_V2_StreamWriteAcquire
+    (
+        USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+        uint8_t interfaceNumber,
+        void ** data
+    );
+
+  Summary:
+    Returns free ring space that the application can write in place.
+
+  Description:
+    This function returns a pointer to the free ring space and the number of
+    contiguous bytes that can be written at that pointer. It counts an
+    overrun if the ring is full.
+
+  Remarks:
+    Refer to usb_device_audio_v2_0.h for usage information.
+*/
+
+size_t USB_DEVICE_AUDIO_V2_StreamWriteAcquire
+(
+    USB_DEVICE_AUDIO_V2_INDEX iAudio,
+    uint8_t interfaceNum,
+    void ** data
+)
+{
+    USB_DEVICE_AUDIO_V2_STREAM * stream;
+    uint8_t streamIndex;
+    size_t length;
+
+    if ((_USB_DEVICE_AUDIO_V2_StreamIndexGet(iAudio, interfaceNum, &streamIndex)
+                != USB_DEVICE_AUDIO_V2_RESULT_OK) || (data == NULL))
+    {
+        return 0;
+    }
+
+    stream = &gUsbDeviceAudioV2Instance[iAudio].infCollection.streamInf[streamIndex].stream;
+    if (!(stream->isStarted) || !(stream->isWrite))
+    {
+        return 0;
+    }
+
+    /* Free space up to the end of the ring */
+    length = stream->bufferSize - stream->used;
+    if (length > (stream->bufferSize - stream->write))
+    {
+        length = stream->bufferSize - stream->write;
+    }
+
+    if (length == 0)
+    {
+        stream->statistics.overruns ++;
+    }
+
+    *data = stream->buffer + stream->write;
+    return length;
+}
+
+/*******************************************************************************
+  Function:
+    USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamWriteCommit
+    (
+        USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+        uint8_t interfaceNumber,
+        size_t size
+    );
+
+  Summary:
+    Queues audio data written to the ring for transmission.
+
+  Description:
+    This function adds size bytes written at the pointer returned by
+    USB_DEVICE_AUDIO_V2_StreamWriteAcquire() to the ring level. The stream is
+    primed and starts sending once the level reaches its target.
+
+  Remarks:
+    Refer to usb_device_audio_v2_0.h for usage information.
+*/
+
+USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamWriteCommit
+(
+    USB_DEVICE_AUDIO_V2_INDEX iAudio,
+    uint8_t interfaceNum,
+    size_t size
+)
+{
+    USB_DEVICE_AUDIO_V2_RESULT audioResult;
+    USB_DEVICE_AUDIO_V2_STREAM * stream;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    uint8_t streamIndex;
+
+    audioResult = _USB_DEVICE_AUDIO_V2_StreamIndexGet(iAudio, interfaceNum, &streamIndex);
+    if (audioResult != USB_DEVICE_AUDIO_V2_RESULT_OK)
+    {
+        return audioResult;
+    }
+
+    stream = &gUsbDeviceAudioV2Instance[iAudio].infCollection.streamInf[streamIndex].stream;
+    if (!(stream->isStarted) || !(stream->isWrite))
+    {
+        return USB_DEVICE_AUDIO_V2_RESULT_ERROR_INSTANCE_NOT_CONFIGURED;
+    }
+
+    if ((size > (stream->bufferSize - stream->used)) ||
+            (size > (stream->bufferSize - stream->write)) ||
+            ((size % stream->frameSize) != 0))
+    {
+        /* More data than was acquired or a partial audio frame */
+        return USB_DEVICE_AUDIO_V2_RESULT_ERROR_PARAMETER_INVALID;
+    }
+
+    stream->write = (stream->write + size) % stream->bufferSize;
+
+    /* The IRP callback updates these counters */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    stream->used += size;
+    stream->level += size;
+    if (stream->level >= stream->levelTarget)
+    {
+        stream->isPrimed = true;
+    }
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+    _USB_DEVICE_AUDIO_V2_StreamWriteSubmit(stream);
+
+    return USB_DEVICE_AUDIO_V2_RESULT_OK;
+}
+
+/*******************************************************************************
+  Function:
+    USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamStatisticsGet
+    (
+        USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+        uint8_t interfaceNumber,
+        USB_DEVICE_AUDIO_V2_STREAM_STATISTICS * statistics
+    );
+
+  Summary:
+    Returns the statistics of the isochronous stream of an audio streaming
+    interface.
+
+  Description:
+    This function copies the stream statistics and the current ring level.
+
+  Remarks:
+    Refer to usb_device_audio_v2_0.h for usage information.
+*/
+
+USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamStatisticsGet
+(
+    USB_DEVICE_AUDIO_V2_INDEX iAudio,
+    uint8_t interfaceNum,
+    USB_DEVICE_AUDIO_V2_STREAM_STATISTICS * statistics
+)
+{
+    USB_DEVICE_AUDIO_V2_RESULT audioResult;
+    USB_DEVICE_AUDIO_V2_STREAM * stream;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    uint8_t streamIndex;
+
+    if (statistics == NULL)
+    {
+        return USB_DEVICE_AUDIO_V2_RESULT_ERROR_PARAMETER_INVALID;
+    }
+
+    audioResult = _USB_DEVICE_AUDIO_V2_StreamIndexGet(iAudio, interfaceNum, &streamIndex);
+    if (audioResult == USB_DEVICE_AUDIO_V2_RESULT_OK)
+    {
+        stream = &gUsbDeviceAudioV2Instance[iAudio].infCollection.streamInf[streamIndex].stream;
+
+        /* The IRP callbacks update the statistics */
+        IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+        *statistics = stream->statistics;
+        statistics->level = stream->level;
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+    }
+
+    return audioResult;
+}
+#endif
+
 /*******************************************************************************
  End of File
  */
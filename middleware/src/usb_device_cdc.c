@@ -102,10 +102,17 @@ const USB_DEVICE_FUNCTION_DRIVER cdcFunctionDriver =
     This array is private to the USB stack.
 */
 
+#if !defined(USB_DEVICE_IRP_POOL_SIZE)
 USB_DEVICE_IRP gUSBDeviceCDCIRP[USB_DEVICE_CDC_QUEUE_DEPTH_COMBINED];
 
+/* Free index stack for the CDC Device IRPs */
+uint16_t gUSBDeviceCDCIRPFreeStack[USB_DEVICE_CDC_QUEUE_DEPTH_COMBINED];
 
-/* Create a variable for holding CDC IRP mutex Handle and status */
+/* Free flags of the CDC Device IRPs */
+bool gUSBDeviceCDCIRPIsFree[USB_DEVICE_CDC_QUEUE_DEPTH_COMBINED];
+#endif
+
+/* Create a variable for holding CDC IRP pool */
 USB_DEVICE_CDC_COMMON_DATA_OBJ gUSBDeviceCdcCommonDataObj;
  
 
@@ -125,6 +132,25 @@ USB_DEVICE_CDC_COMMON_DATA_OBJ gUSBDeviceCdcCommonDataObj;
 
 USB_DEVICE_CDC_INSTANCE gUSBDeviceCDCInstance[USB_DEVICE_CDC_INSTANCES_NUMBER];
 
+#if defined(USB_DEVICE_CDC_STREAM_BUFFER_SIZE)
+// *****************************************************************************
+/* CDC Stream Rings
+
+  Summary:
+    Receive and transmit rings of the CDC streams.
+
+  Description:
+    These arrays hold the receive and transmit rings of every CDC instance.
+    The USB controller driver reads and writes these rings directly.
+
+  Remarks:
+    These arrays are private to the CDC.
+*/
+
+static uint8_t gUSBDeviceCDCStreamRxBuffer[USB_DEVICE_CDC_INSTANCES_NUMBER][USB_DEVICE_CDC_STREAM_BUFFER_SIZE] USB_ALIGN;
+static uint8_t gUSBDeviceCDCStreamTxBuffer[USB_DEVICE_CDC_INSTANCES_NUMBER][USB_DEVICE_CDC_STREAM_BUFFER_SIZE] USB_ALIGN;
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: File Scope Functions
@@ -147,23 +173,19 @@ USB_DEVICE_CDC_INSTANCE gUSBDeviceCDCInstance[USB_DEVICE_CDC_INSTANCES_NUMBER];
 */
 void _USB_DEVICE_CDC_GlobalInitialize (void)
 {
-    OSAL_RESULT osal_err;
-    
-    /* Create Mutex for CDC IRP objects if not created already */
-    if (gUSBDeviceCdcCommonDataObj.isMutexCdcIrpInitialized == false)
+#if !defined(USB_DEVICE_IRP_POOL_SIZE)
+    /* Initialize the CDC IRP pool if not initialized already */
+    if (gUSBDeviceCdcCommonDataObj.isIrpPoolInitialized == false)
     {
-        /* This means that mutexes where not created. Create them. */
-        osal_err = OSAL_MUTEX_Create(&gUSBDeviceCdcCommonDataObj.mutexCDCIRP);
+        _USB_DEVICE_IRPPoolInitialize(&gUSBDeviceCdcCommonDataObj.irpPool,
+                gUSBDeviceCDCIRP, gUSBDeviceCDCIRPFreeStack,
+                gUSBDeviceCDCIRPIsFree,
+                USB_DEVICE_CDC_QUEUE_DEPTH_COMBINED, 0);
 
-        if(osal_err != OSAL_RESULT_TRUE)
-        {
-            /*do not proceed lock was not created, let user know about error*/
-            return;
-        }
-
-         /* Set this flag so that global mutexes get allocated only once */
-         gUSBDeviceCdcCommonDataObj.isMutexCdcIrpInitialized = true;
+         /* Set this flag so that the pool gets initialized only once */
+         gUSBDeviceCdcCommonDataObj.isIrpPoolInitialized = true;
     }
+#endif
 }
 // ******************************************************************************
 /* Function:
@@ -236,6 +258,13 @@ void _USB_DEVICE_CDC_Initialization
     thisCDCInstance->currentQSizeRead = 0;
     thisCDCInstance->currentQSizeSerialStateNotification = 0;
 
+    /* Get the pool from which the IRPs of this instance are allocated */
+#if defined(USB_DEVICE_IRP_POOL_SIZE)
+    thisCDCInstance->irpPool = _USB_DEVICE_IRPPoolGet(deviceHandle);
+#else
+    thisCDCInstance->irpPool = &gUSBDeviceCdcCommonDataObj.irpPool;
+#endif
+
     
     /* check the type of descriptor passed by device layer */
     switch ( descType )
@@ -396,6 +425,12 @@ void _USB_DEVICE_CDC_Deinitialization ( SYS_MODULE_INDEX iCDC )
 
     deviceHandle = gUSBDeviceCDCInstance[iCDC].deviceHandle;
 
+#if defined(USB_DEVICE_CDC_STREAM_BUFFER_SIZE)
+    /* The stream IRPs are cancelled below. The application must start the
+     * stream again once the device is configured. */
+    gUSBDeviceCDCInstance[iCDC].stream.isStarted = false;
+#endif
+
     deviceCDCEndpoint = &gUSBDeviceCDCInstance[iCDC].dataInterface.endpoint[0];
     _USB_DEVICE_CDC_EndpointDisable(deviceHandle, deviceCDCEndpoint);
     
@@ -547,6 +582,7 @@ void _USB_DEVICE_CDC_ControlTransferHandler
 void _USB_DEVICE_CDC_SerialStateSendIRPCallback (USB_DEVICE_IRP * irp )
 {
     USB_DEVICE_CDC_INSTANCE * thisCDCDevice;
+    USB_DEVICE_CDC_INDEX iCDC;
 
     /* This function is called when a CDC Write IRP has
      * terminated */
@@ -555,7 +591,8 @@ void _USB_DEVICE_CDC_SerialStateSendIRPCallback (USB_DEVICE_IRP * irp )
 
     /* The user data field of the IRP contains the CDC instance
      * that submitted this IRP */
-    thisCDCDevice = &gUSBDeviceCDCInstance[irp->userData];
+    iCDC = (USB_DEVICE_CDC_INDEX)(irp->userData);
+    thisCDCDevice = &gUSBDeviceCDCInstance[iCDC];
 
     /* populate the event handler for this transfer */
     serialStateEventData.handle = ( USB_DEVICE_CDC_TRANSFER_HANDLE ) irp;
@@ -586,15 +623,14 @@ void _USB_DEVICE_CDC_SerialStateSendIRPCallback (USB_DEVICE_IRP * irp )
         serialStateEventData.status = USB_DEVICE_CDC_RESULT_ERROR; 
     }
 
-    /* Reduce the queue size */
-
-    thisCDCDevice->currentQSizeSerialStateNotification --;
+    /* Return the IRP to the pool and update the queue size */
+    _USB_DEVICE_IRPPoolRelease(thisCDCDevice->irpPool, irp, &thisCDCDevice->currentQSizeSerialStateNotification);
 
     /* valid application event handler present? */
     if ( thisCDCDevice->appEventCallBack )
     {
         /* inform the application */
-        thisCDCDevice->appEventCallBack ( (USB_DEVICE_CDC_INDEX)(irp->userData) , 
+        thisCDCDevice->appEventCallBack ( iCDC , 
                    USB_DEVICE_CDC_EVENT_SERIAL_STATE_NOTIFICATION_COMPLETE ,
                    &serialStateEventData, thisCDCDevice->userData);
     }
@@ -619,6 +655,7 @@ void _USB_DEVICE_CDC_SerialStateSendIRPCallback (USB_DEVICE_IRP * irp )
 void _USB_DEVICE_CDC_ReadIRPCallback (USB_DEVICE_IRP * irp )
 {
     USB_DEVICE_CDC_INSTANCE * thisCDCDevice;
+    USB_DEVICE_CDC_INDEX iCDC;
 
     /* This function is called when a CDC Write IRP has
      * terminated */
@@ -627,7 +664,8 @@ void _USB_DEVICE_CDC_ReadIRPCallback (USB_DEVICE_IRP * irp )
 
     /* The user data field of the IRP contains the CDC instance
      * that submitted this IRP */
-    thisCDCDevice = &gUSBDeviceCDCInstance[irp->userData];
+    iCDC = (USB_DEVICE_CDC_INDEX)(irp->userData);
+    thisCDCDevice = &gUSBDeviceCDCInstance[iCDC];
 
     /* populate the event handler for this transfer */
     readEventData.handle = ( USB_DEVICE_CDC_TRANSFER_HANDLE ) irp;
@@ -658,14 +696,14 @@ void _USB_DEVICE_CDC_ReadIRPCallback (USB_DEVICE_IRP * irp )
         readEventData.status = USB_DEVICE_CDC_RESULT_ERROR; 
     }
 
-    /* update the queue size */
-    thisCDCDevice->currentQSizeRead --;
+    /* Return the IRP to the pool and update the queue size */
+    _USB_DEVICE_IRPPoolRelease(thisCDCDevice->irpPool, irp, &thisCDCDevice->currentQSizeRead);
 
     /* valid application event handler present? */
     if ( thisCDCDevice->appEventCallBack )
     {
         /* inform the application */
-        thisCDCDevice->appEventCallBack ( (USB_DEVICE_CDC_INDEX)(irp->userData) , 
+        thisCDCDevice->appEventCallBack ( iCDC , 
                    USB_DEVICE_CDC_EVENT_READ_COMPLETE , 
                    &readEventData, thisCDCDevice->userData);
     }
@@ -690,6 +728,7 @@ void _USB_DEVICE_CDC_ReadIRPCallback (USB_DEVICE_IRP * irp )
 void _USB_DEVICE_CDC_WriteIRPCallback (USB_DEVICE_IRP * irp )
 {
     USB_DEVICE_CDC_INSTANCE * thisCDCDevice;
+    USB_DEVICE_CDC_INDEX iCDC;
 
     /* This function is called when a CDC Write IRP has
      * terminated */
@@ -698,7 +737,8 @@ void _USB_DEVICE_CDC_WriteIRPCallback (USB_DEVICE_IRP * irp )
 
     /* The user data field of the IRP contains the CDC instance
      * that submitted this IRP */
-    thisCDCDevice = &gUSBDeviceCDCInstance[irp->userData];
+    iCDC = (USB_DEVICE_CDC_INDEX)(irp->userData);
+    thisCDCDevice = &gUSBDeviceCDCInstance[iCDC];
 
     /* populate the event handler for this transfer */
     writeEventData.handle = ( USB_DEVICE_CDC_TRANSFER_HANDLE ) irp;
@@ -729,14 +769,14 @@ void _USB_DEVICE_CDC_WriteIRPCallback (USB_DEVICE_IRP * irp )
         writeEventData.status = USB_DEVICE_CDC_RESULT_ERROR; 
     }
 
-    /* Update the queue size*/
-    thisCDCDevice->currentQSizeWrite --;
+    /* Return the IRP to the pool and update the queue size */
+    _USB_DEVICE_IRPPoolRelease(thisCDCDevice->irpPool, irp, &thisCDCDevice->currentQSizeWrite);
 
     /* valid application event handler present? */
     if ( thisCDCDevice->appEventCallBack )
     {
         /* inform the application */
-        thisCDCDevice->appEventCallBack ( (USB_DEVICE_CDC_INDEX)(irp->userData) , 
+        thisCDCDevice->appEventCallBack ( iCDC , 
                    USB_DEVICE_CDC_EVENT_WRITE_COMPLETE , 
                    &writeEventData, thisCDCDevice->userData);
     }
@@ -799,14 +839,11 @@ USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_Read
     void * data , size_t size
 )
 {
-    unsigned int cnt;
     unsigned int remainder;
     USB_DEVICE_IRP * irp;
     USB_DEVICE_CDC_ENDPOINT * endpoint;
     USB_DEVICE_CDC_INSTANCE * thisCDCDevice;
-    OSAL_RESULT osalError;
     USB_ERROR irpError;
-    OSAL_CRITSECT_DATA_TYPE IntState;
 
     /* Check the validity of the function driver index */
     
@@ -839,79 +876,36 @@ USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_Read
         return(USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_SIZE_INVALID);
     }
 
-    /* Make sure that we are with in the queue size for this instance */
-    if(thisCDCDevice->currentQSizeRead >= thisCDCDevice->queueSizeRead)
+    /* Get a free IRP. This fails if the read queue of this instance is
+     * full. */
+    irp = _USB_DEVICE_IRPPoolAllocate(thisCDCDevice->irpPool,
+            &thisCDCDevice->currentQSizeRead, thisCDCDevice->queueSizeRead);
+    if(irp == NULL)
     {
         SYS_ASSERT(false, "Read Queue is full");
         return(USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_QUEUE_FULL);
     }
 
-    /*Obtain mutex to get access to a shared resource, check return value*/
-    osalError = OSAL_MUTEX_Lock(&gUSBDeviceCdcCommonDataObj.mutexCDCIRP, OSAL_WAIT_FOREVER);
-    if(osalError != OSAL_RESULT_TRUE)
-    {
-      /*Do not proceed lock was not obtained, or error occurred, let user know about error*/
-      return (USB_DEVICE_CDC_RESULT_ERROR);
-    }
+    /* Configure the IRP and then submit */
+    irp->data = data;
+    irp->size = size;
+    irp->userData = (uintptr_t) iCDC;
+    irp->callback = _USB_DEVICE_CDC_ReadIRPCallback;
 
-    /* Loop and find a free IRP in the Q */
-    for ( cnt = 0; cnt < USB_DEVICE_CDC_QUEUE_DEPTH_COMBINED; cnt ++ )
-    {
-        if(gUSBDeviceCDCIRP[cnt].status <
-                (USB_DEVICE_IRP_STATUS)USB_DEVICE_IRP_FLAG_DATA_PENDING)
-        {
-            /* This means the IRP is free. Configure the IRP
-             * update the current queue size and then submit */
-
-            irp = &gUSBDeviceCDCIRP[cnt];
-            irp->data = data;
-            irp->size = size;
-            irp->userData = (uintptr_t) iCDC;
-            irp->callback = _USB_DEVICE_CDC_ReadIRPCallback;
-            
-            /* Prevent other tasks pre-empting this sequence of code */ 
-            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-            /* Update the read queue size */ 
-            thisCDCDevice->currentQSizeRead++;
-            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-            
-            *transferHandle = (USB_DEVICE_CDC_TRANSFER_HANDLE)irp;
-            irpError = USB_DEVICE_IRPSubmit(thisCDCDevice->deviceHandle,
-                    endpoint->address, irp);
+    *transferHandle = (USB_DEVICE_CDC_TRANSFER_HANDLE)irp;
+    irpError = USB_DEVICE_IRPSubmit(thisCDCDevice->deviceHandle,
+            endpoint->address, irp);
 
-            /* If IRP Submit function returned any error, then invalidate the
-               Transfer handle.  */
-            if (irpError != USB_ERROR_NONE )
-            {
-                /* Prevent other tasks pre-empting this sequence of code */ 
-                IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-                /* Update the read queue size */ 
-                thisCDCDevice->currentQSizeRead--;
-                OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-                *transferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
-            }
-            
-            /*Release mutex, done with shared resource*/
-            osalError = OSAL_MUTEX_Unlock(&gUSBDeviceCdcCommonDataObj.mutexCDCIRP);
-            if(osalError != OSAL_RESULT_TRUE)
-            {
-                /*Do not proceed unlock was not complete, or error occurred, let user know about error*/
-                return (USB_DEVICE_CDC_RESULT_ERROR);
-            }
-            
-            return((USB_DEVICE_CDC_RESULT)irpError);
-        }
-    }
-    
-    /*Release mutex, done with shared resource*/
-    osalError = OSAL_MUTEX_Unlock(&gUSBDeviceCdcCommonDataObj.mutexCDCIRP);
-    if(osalError != OSAL_RESULT_TRUE)
+    /* If IRP Submit function returned any error, then invalidate the
+       Transfer handle and return the IRP to the pool. */
+    if (irpError != USB_ERROR_NONE )
     {
-        /*Do not proceed unlock was not complete, or error occurred, let user know about error*/
-        return (USB_DEVICE_CDC_RESULT_ERROR);
+        _USB_DEVICE_IRPPoolRelease(thisCDCDevice->irpPool, irp,
+                &thisCDCDevice->currentQSizeRead);
+        *transferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
     }
-    /* If here means we could not find a spare IRP */
-    return(USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_QUEUE_FULL);
+
+    return((USB_DEVICE_CDC_RESULT)irpError);
 }
 
 // *****************************************************************************
@@ -954,15 +948,12 @@ USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_Write
     USB_DEVICE_CDC_TRANSFER_FLAGS flags 
 )
 {
-    unsigned int cnt;
     unsigned int remainder;
     USB_DEVICE_IRP * irp;
     USB_DEVICE_IRP_FLAG irpFlag = USB_DEVICE_IRP_FLAG_NONE;
     USB_DEVICE_CDC_INSTANCE * thisCDCDevice;
     USB_DEVICE_CDC_ENDPOINT * endpoint;
-    OSAL_RESULT osalError;
     USB_ERROR irpError; 
-    OSAL_CRITSECT_DATA_TYPE IntState;
 
     /* Check the validity of the function driver index */
     
@@ -1019,79 +1010,38 @@ USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_Write
         irpFlag = USB_DEVICE_IRP_FLAG_DATA_COMPLETE;
     }
 
-    if(thisCDCDevice->currentQSizeWrite >= thisCDCDevice->queueSizeWrite)
+    /* Get a free IRP. This fails if the write queue of this instance is
+     * full. */
+    irp = _USB_DEVICE_IRPPoolAllocate(thisCDCDevice->irpPool,
+            &thisCDCDevice->currentQSizeWrite, thisCDCDevice->queueSizeWrite);
+    if(irp == NULL)
     {
         SYS_ASSERT(false, "Write Queue is full");
         return(USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_QUEUE_FULL);
     }
 
-    /*Obtain mutex to get access to a shared resource, check return value*/
-    osalError = OSAL_MUTEX_Lock(&gUSBDeviceCdcCommonDataObj.mutexCDCIRP, OSAL_WAIT_FOREVER);
-    if(osalError != OSAL_RESULT_TRUE)
-    {
-      /*Do not proceed lock was not obtained, or error occurred, let user know about error*/
-      return (USB_DEVICE_CDC_RESULT_ERROR);
-    }
+    /* Configure the IRP and then submit */
+    irp->data   = (void *)data;
+    irp->size   = size;
+    irp->userData   = (uintptr_t) iCDC;
+    irp->callback   = _USB_DEVICE_CDC_WriteIRPCallback;
+    irp->flags      = irpFlag;
 
-    /* loop and find a free IRP in the Q */
-    for ( cnt = 0; cnt < USB_DEVICE_CDC_QUEUE_DEPTH_COMBINED; cnt ++ )
-    {
-        if(gUSBDeviceCDCIRP[cnt].status <
-                (USB_DEVICE_IRP_STATUS)USB_DEVICE_IRP_FLAG_DATA_PENDING)
-        {
-            /* This means the IRP is free */
+    *transferHandle = (USB_DEVICE_CDC_TRANSFER_HANDLE)irp;
 
-            irp         = &gUSBDeviceCDCIRP[cnt];
-            irp->data   = (void *)data;
-            irp->size   = size;
+    irpError = USB_DEVICE_IRPSubmit(thisCDCDevice->deviceHandle,
+            endpoint->address, irp);
 
-            irp->userData   = (uintptr_t) iCDC;
-            irp->callback   = _USB_DEVICE_CDC_WriteIRPCallback;
-            irp->flags      = irpFlag;
-
-            /* Prevent other tasks pre-empting this sequence of code */ 
-            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-            /* Update the Write queue size */ 
-            thisCDCDevice->currentQSizeWrite++;
-            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-            
-            *transferHandle = (USB_DEVICE_CDC_TRANSFER_HANDLE)irp;
-
-            irpError = USB_DEVICE_IRPSubmit(thisCDCDevice->deviceHandle,
-                    endpoint->address, irp);
-
-            /* If IRP Submit function returned any error, then invalidate the
-               Transfer handle.  */
-            if (irpError != USB_ERROR_NONE )
-            {
-                /* Prevent other tasks pre-empting this sequence of code */ 
-                IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-                /* Update the Write queue size */ 
-                thisCDCDevice->currentQSizeWrite--;
-                OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-                *transferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
-            }
-            /*Release mutex, done with shared resource*/
-            osalError = OSAL_MUTEX_Unlock(&gUSBDeviceCdcCommonDataObj.mutexCDCIRP);
-            if(osalError != OSAL_RESULT_TRUE)
-            {
-                /*Do not proceed unlock was not complete, or error occurred, let user know about error*/
-                return (USB_DEVICE_CDC_RESULT_ERROR);
-            }
-
-            return((USB_DEVICE_CDC_RESULT)irpError);
-        }
-    }
-    
-    /*Release mutex, done with shared resource*/
-    osalError = OSAL_MUTEX_Unlock(&gUSBDeviceCdcCommonDataObj.mutexCDCIRP);
-    if(osalError != OSAL_RESULT_TRUE)
+    /* If IRP Submit function returned any error, then invalidate the
+       Transfer handle and return the IRP to the pool. */
+    if (irpError != USB_ERROR_NONE )
     {
-        /*Do not proceed unlock was not complete, or error occurred, let user know about error*/
-        return (USB_DEVICE_CDC_RESULT_ERROR);
+        _USB_DEVICE_IRPPoolRelease(thisCDCDevice->irpPool, irp,
+                &thisCDCDevice->currentQSizeWrite);
+        *transferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
     }
-    /* If here means we could not find a spare IRP */
-    return(USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_QUEUE_FULL);
+
+    return((USB_DEVICE_CDC_RESULT)irpError);
 }
 
 USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_EventHandlerSet 
@@ -1223,13 +1173,10 @@ USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_SerialStateNotificationSend
     USB_CDC_SERIAL_STATE * notificationData 
 )
 {
-    unsigned int cnt;
     USB_DEVICE_IRP * irp;
     USB_DEVICE_CDC_ENDPOINT * endpoint;
     USB_DEVICE_CDC_INSTANCE * thisCDCDevice;
-    OSAL_RESULT osalError;
     USB_ERROR irpError;
-    OSAL_CRITSECT_DATA_TYPE IntState;
 
     *transferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
 
@@ -1252,78 +1199,613 @@ USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_SerialStateNotificationSend
         return (USB_DEVICE_CDC_RESULT_ERROR_INSTANCE_NOT_CONFIGURED);
     }
 
-    if(thisCDCDevice->currentQSizeSerialStateNotification >=
-            thisCDCDevice->queueSizeSerialStateNotification)
+    /* Get a free IRP. This fails if the serial state notification queue of
+     * this instance is full. */
+    irp = _USB_DEVICE_IRPPoolAllocate(thisCDCDevice->irpPool,
+            &thisCDCDevice->currentQSizeSerialStateNotification,
+            thisCDCDevice->queueSizeSerialStateNotification);
+    if(irp == NULL)
     {
         SYS_ASSERT(false, "Serial State Notification Send Queue is full");
         return(USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_QUEUE_FULL);
     }
 
-    /*Obtain mutex to get access to a shared resource, check return value*/
-    osalError = OSAL_MUTEX_Lock(&gUSBDeviceCdcCommonDataObj.mutexCDCIRP, OSAL_WAIT_FOREVER);
-    if(osalError != OSAL_RESULT_TRUE)
+    /* Configure the IRP and then submit */
+    irp->data = notificationData;
+    irp->size = sizeof(USB_CDC_SERIAL_STATE);
+    irp->userData = (uintptr_t) iCDC;
+    irp->callback = _USB_DEVICE_CDC_SerialStateSendIRPCallback;
+    irp->flags = USB_DEVICE_IRP_FLAG_DATA_COMPLETE;
+
+    *transferHandle = (USB_DEVICE_CDC_TRANSFER_HANDLE) irp;
+    irpError = USB_DEVICE_IRPSubmit(thisCDCDevice->deviceHandle, endpoint->address, irp);
+
+    /* If IRP Submit function returned any error, then invalidate the
+       Transfer handle and return the IRP to the pool. */
+    if (irpError != USB_ERROR_NONE )
+    {
+        _USB_DEVICE_IRPPoolRelease(thisCDCDevice->irpPool, irp,
+                &thisCDCDevice->currentQSizeSerialStateNotification);
+        *transferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
+    }
+
+    return((USB_DEVICE_CDC_RESULT)irpError);
+}
+
+#if defined(USB_DEVICE_CDC_STREAM_BUFFER_SIZE)
+// ******************************************************************************
+/* Function:
+    USB_ERROR _USB_DEVICE_CDC_StreamReadSubmit
+    (
+        USB_DEVICE_CDC_INDEX iCDC,
+        unsigned int slot
+    )
+
+  Summary:
+    Arms the IRP of a receive ring slot.
+
+  Description:
+    This function submits the IRP of the specified receive ring slot on the
+    bulk OUT endpoint so that the slot is filled with the next data sent by the
+    host.
+
+  Remarks:
+    This is local function and should not be called directly by the application.
+*/
+
+static USB_ERROR _USB_DEVICE_CDC_StreamReadSubmit
+(
+    USB_DEVICE_CDC_INDEX iCDC,
+    unsigned int slot
+)
+{
+    USB_DEVICE_CDC_INSTANCE * thisCDCDevice = &gUSBDeviceCDCInstance[iCDC];
+    USB_DEVICE_CDC_STREAM * stream = &thisCDCDevice->stream;
+    USB_DEVICE_IRP * irp = &stream->rxIRP[slot];
+
+    /* The IRP has no callback. The application finds completed slots
+     * through the IRP status. */
+    irp->data = stream->rxBuffer + (slot * stream->rxSlotSize);
+    irp->size = stream->rxSlotSize;
+    irp->userData = (uintptr_t) iCDC;
+    irp->callback = NULL;
+    irp->flags = USB_DEVICE_IRP_FLAG_NONE;
+
+    return (USB_DEVICE_IRPSubmit(thisCDCDevice->deviceHandle,
+            thisCDCDevice->dataInterface.endpoint[USB_DEVICE_CDC_ENDPOINT_RX].address,
+            irp));
+}
+
+// ******************************************************************************
+/* Function:
+    USB_DEVICE_IRP * _USB_DEVICE_CDC_StreamReadSlotGet
+    (
+        USB_DEVICE_CDC_INDEX iCDC
+    )
+
+  Summary:
+    Returns the IRP of the receive ring slot that the application reads from.
+
+  Description:
+    This function returns the IRP of the oldest receive ring slot that contains
+    data that the application has not consumed. Slots that contain no data
+    (zero length packets) are armed again and skipped. The function returns
+    NULL if no data is available. The stream is stopped if a receive IRP was
+    aborted.
+
+  Remarks:
+    This is local function and should not be called directly by the application.
+*/
+
+static USB_DEVICE_IRP * _USB_DEVICE_CDC_StreamReadSlotGet
+(
+    USB_DEVICE_CDC_INDEX iCDC
+)
+{
+    USB_DEVICE_CDC_STREAM * stream = &gUSBDeviceCDCInstance[iCDC].stream;
+    USB_DEVICE_IRP * irp;
+    USB_DEVICE_IRP_STATUS status;
+
+    while(stream->isStarted)
+    {
+        irp = &stream->rxIRP[stream->rxSlot];
+        status = irp->status;
+
+        if((status == USB_DEVICE_IRP_STATUS_COMPLETED) 
+            || (status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
+        {
+            if(stream->rxOffset < irp->size)
+            {
+                /* This slot still has data */
+                return irp;
+            }
+
+            /* The slot is empty. Arm it again and move to the next slot. */
+            stream->rxOffset = 0;
+            if(_USB_DEVICE_CDC_StreamReadSubmit(iCDC, stream->rxSlot) != USB_ERROR_NONE)
+            {
+                stream->isStarted = false;
+                break;
+            }
+            stream->rxSlot = (stream->rxSlot + 1) % USB_DEVICE_CDC_STREAM_IRPS_NUMBER;
+        }
+        else if((status == USB_DEVICE_IRP_STATUS_PENDING) 
+            || (status == USB_DEVICE_IRP_STATUS_IN_PROGRESS))
+        {
+            /* No data received yet */
+            break;
+        }
+        else
+        {
+            /* The IRP was aborted or terminated. The stream must be started
+             * again. */
+            stream->isStarted = false;
+        }
+    }
+
+    return NULL;
+}
+
+// ******************************************************************************
+/* Function:
+    void _USB_DEVICE_CDC_StreamWriteSubmit ( USB_DEVICE_CDC_INDEX iCDC )
+
+  Summary:
+    Submits committed transmit ring data.
+
+  Description:
+    This function submits committed transmit ring data on the bulk IN endpoint
+    while there are free transmit IRPs. An IRP that is followed by more
+    committed data carries a multiple of the maximum packet size and the
+    data pending flag so that the transfer continues without a short packet.
+    The IRP that carries the last committed byte is sent with the data
+    complete flag, so the transfer ends with a short or zero length packet.
+    The IRP and the ring range are claimed in a critical section and the IRP
+    is submitted outside it.
+
+  Remarks:
+    This is local function and should not be called directly by the
+    application. It is called from the application context and from the
+    transmit IRP callback.
+*/
+
+static void _USB_DEVICE_CDC_StreamWriteSubmit ( USB_DEVICE_CDC_INDEX iCDC )
+{
+    USB_DEVICE_CDC_INSTANCE * thisCDCDevice = &gUSBDeviceCDCInstance[iCDC];
+    USB_DEVICE_CDC_STREAM * stream = &thisCDCDevice->stream;
+    USB_DEVICE_CDC_ENDPOINT * endpoint = &thisCDCDevice->dataInterface.endpoint[USB_DEVICE_CDC_ENDPOINT_TX];
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    USB_DEVICE_IRP * irp;
+    unsigned int irpIndex;
+    size_t length;
+
+    /* The transmit IRP callback also calls this function. Only one context
+     * submits at a time, else IRPs could be submitted out of ring order. */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    if(stream->txSubmitting)
     {
-      /*Do not proceed lock was not obtained, or error occurred, let user know about error*/
-      return (USB_DEVICE_CDC_RESULT_ERROR);
+        /* The submitting context checks the ring again after each IRP */
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+        return;
     }
+    stream->txSubmitting = true;
 
-    /* Loop and find a free IRP in the Q */
-    for ( cnt = 0; cnt < USB_DEVICE_CDC_QUEUE_DEPTH_COMBINED; cnt ++ )
+    while((stream->isStarted) && (stream->txCommitted > 0)
+            && (stream->txIRPsPending < USB_DEVICE_CDC_STREAM_IRPS_NUMBER))
     {
-        if(gUSBDeviceCDCIRP[cnt].status < (USB_DEVICE_IRP_STATUS)USB_DEVICE_IRP_FLAG_DATA_PENDING)
+        /* An IRP covers contiguous ring data only */
+        length = USB_DEVICE_CDC_STREAM_BUFFER_SIZE - stream->txSend;
+        if(length > stream->txCommitted)
         {
-            /* This means the IRP is free */
+            length = stream->txCommitted;
+        }
 
-            irp = &gUSBDeviceCDCIRP[cnt];
-            irp->data = notificationData;
-            irp->size = sizeof(USB_CDC_SERIAL_STATE);
-            irp->userData = (uintptr_t) iCDC;
-            irp->callback = _USB_DEVICE_CDC_SerialStateSendIRPCallback;
+        irpIndex = stream->txIRPSubmit;
+        irp = &stream->txIRP[irpIndex];
+        if((stream->txCommitted > length) && (length >= endpoint->maxPacketSize))
+        {
+            /* More data follows this IRP. Send full packets only. */
+            length -= length % endpoint->maxPacketSize;
+            irp->flags = USB_DEVICE_IRP_FLAG_DATA_PENDING;
+        }
+        else
+        {
+            /* This is the end of the committed data. The driver ends the
+             * transfer with a short or zero length packet. */
             irp->flags = USB_DEVICE_IRP_FLAG_DATA_COMPLETE;
-            /* Prevent other tasks pre-empting this sequence of code */ 
+        }
+
+        irp->data = stream->txBuffer + stream->txSend;
+        irp->size = length;
+        irp->userData = (uintptr_t) iCDC;
+        irp->callback = _USB_DEVICE_CDC_StreamWriteIRPCallback;
+
+        /* Claim the IRP and the ring range. The IRP may complete before
+         * USB_DEVICE_IRPSubmit() returns. */
+        stream->txIRPsPending ++;
+        stream->txIRPSubmit = (stream->txIRPSubmit + 1) % USB_DEVICE_CDC_STREAM_IRPS_NUMBER;
+        stream->txSend = (stream->txSend + length) % USB_DEVICE_CDC_STREAM_BUFFER_SIZE;
+        stream->txCommitted -= length;
+
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+        if(USB_DEVICE_IRPSubmit(thisCDCDevice->deviceHandle, endpoint->address, irp)
+                != USB_ERROR_NONE)
+        {
+            /* No other context has claimed since, so the claim can be
+             * returned. The endpoint does not accept IRPs. The stream must be
+             * started again. */
             IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-            /* Update Serial State Notification Queue Size */ 
-            thisCDCDevice->currentQSizeSerialStateNotification ++;
-            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-            
-            *transferHandle = (USB_DEVICE_CDC_TRANSFER_HANDLE) irp;
-            irpError = USB_DEVICE_IRPSubmit(thisCDCDevice->deviceHandle, endpoint->address, irp);
-            
-            /* If IRP Submit function returned any error, then invalidate the
-               Transfer handle.  */
-            if (irpError != USB_ERROR_NONE )
-            {
-                /* Prevent other tasks pre-empting this sequence of code */ 
-                IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-                /* Update Serial State Notification Queue Size */ 
-                thisCDCDevice->currentQSizeSerialStateNotification --;
-                OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-                
-                *transferHandle = USB_DEVICE_CDC_TRANSFER_HANDLE_INVALID;
-            }
+            stream->txIRPsPending --;
+            stream->txIRPSubmit = irpIndex;
+            stream->txSend = (size_t)((uint8_t *)irp->data - stream->txBuffer);
+            stream->txCommitted += length;
+            stream->isStarted = false;
+            break;
+        }
+
+        IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    }
+
+    stream->txSubmitting = false;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+}
+
+// ******************************************************************************
+/* Function:
+    void _USB_DEVICE_CDC_StreamWriteIRPCallback (USB_DEVICE_IRP * irp )
+ 
+  Summary:
+    IRP call back for stream transmit IRPs.
+  
+  Description:
+    This is IRP call back for IRPs submitted by the CDC stream. It releases the
+    transmit ring space of the IRP and submits the next committed data.
+
+  Remarks:
+    This is local function and should not be called directly by the application.
+*/
+
+void _USB_DEVICE_CDC_StreamWriteIRPCallback (USB_DEVICE_IRP * irp )
+{
+    USB_DEVICE_CDC_INDEX iCDC = (USB_DEVICE_CDC_INDEX)(irp->userData);
+    USB_DEVICE_CDC_STREAM * stream = &gUSBDeviceCDCInstance[iCDC].stream;
+
+    stream->txIRPsPending --;
+
+    if ((irp->status == USB_DEVICE_IRP_STATUS_COMPLETED) 
+        || (irp->status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
+    {
+        /* Release the ring space and keep the endpoint busy */
+        stream->txUsed -= irp->size;
+        _USB_DEVICE_CDC_StreamWriteSubmit(iCDC);
+    }
+    else
+    {
+        /* The transfer was aborted. The stream must be started again. */
+        stream->isStarted = false;
+    }
+}
+
+// *****************************************************************************
+/* Function:
+    USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_StreamStart
+    (
+        USB_DEVICE_CDC_INDEX instanceIndex
+    );
+
+  Summary:
+    Starts the streaming mode of a CDC instance.
+
+  Description:
+    This function empties the receive and transmit rings of the CDC instance
+    and arms all receive IRPs on the bulk OUT endpoint.
+
+  Remarks:
+    Refer to usb_device_cdc.h for usage information.
+*/
+
+USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_StreamStart
+(
+    USB_DEVICE_CDC_INDEX iCDC
+)
+{
+    USB_DEVICE_CDC_INSTANCE * thisCDCDevice;
+    USB_DEVICE_CDC_STREAM * stream;
+    USB_DEVICE_CDC_ENDPOINT * rxEndpoint;
+    USB_ERROR irpError = USB_ERROR_NONE;
+    unsigned int slot;
+
+    /* Check the validity of the function driver index */
+    if (  iCDC >= USB_DEVICE_CDC_INSTANCES_NUMBER  )
+    {
+        /* Invalid CDC index */
+        SYS_ASSERT(false, "Invalid CDC Device Index");
+        return USB_DEVICE_CDC_RESULT_ERROR_INSTANCE_INVALID;
+    }
 
-            /*Release mutex, done with shared resource*/
-            osalError = OSAL_MUTEX_Unlock(&gUSBDeviceCdcCommonDataObj.mutexCDCIRP);
-            if(osalError != OSAL_RESULT_TRUE)
+    thisCDCDevice = &gUSBDeviceCDCInstance[iCDC];
+    stream = &thisCDCDevice->stream;
+    rxEndpoint = &thisCDCDevice->dataInterface.endpoint[USB_DEVICE_CDC_ENDPOINT_RX];
+
+    if(!(rxEndpoint->isConfigured) || 
+            !(thisCDCDevice->dataInterface.endpoint[USB_DEVICE_CDC_ENDPOINT_TX].isConfigured))
+    {
+        /* This means that the endpoints are not configured yet */
+        SYS_ASSERT(false, "Endpoint not configured");
+        return (USB_DEVICE_CDC_RESULT_ERROR_INSTANCE_NOT_CONFIGURED);
+    }
+
+    if(stream->isStarted)
+    {
+        /* The receive IRPs are already armed */
+        return USB_DEVICE_CDC_RESULT_OK;
+    }
+
+    /* A receive slot must hold whole packets */
+    if(((USB_DEVICE_CDC_STREAM_BUFFER_SIZE / USB_DEVICE_CDC_STREAM_IRPS_NUMBER)
+                % rxEndpoint->maxPacketSize) != 0)
+    {
+        SYS_ASSERT(false, "Stream slot size is not a multiple of packet size");
+        return(USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_SIZE_INVALID);
+    }
+
+    if(stream->txIRPsPending != 0)
+    {
+        /* Transmit IRPs of the last stream have not been returned yet */
+        return(USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_QUEUE_FULL);
+    }
+
+    stream->rxBuffer = gUSBDeviceCDCStreamRxBuffer[iCDC];
+    stream->rxSlotSize = USB_DEVICE_CDC_STREAM_BUFFER_SIZE / USB_DEVICE_CDC_STREAM_IRPS_NUMBER;
+    stream->rxSlot = 0;
+    stream->rxOffset = 0;
+
+    stream->txBuffer = gUSBDeviceCDCStreamTxBuffer[iCDC];
+    stream->txIRPSubmit = 0;
+    stream->txWrite = 0;
+    stream->txSend = 0;
+    stream->txCommitted = 0;
+    stream->txUsed = 0;
+    stream->txSubmitting = false;
+
+    stream->isStarted = true;
+
+    for(slot = 0; slot < USB_DEVICE_CDC_STREAM_IRPS_NUMBER; slot ++)
+    {
+        irpError = _USB_DEVICE_CDC_StreamReadSubmit(iCDC, slot);
+        if(irpError != USB_ERROR_NONE)
+        {
+            /* Return the IRPs that were armed. Read IRPs that the
+             * application queued on the endpoint are not affected. */
+            stream->isStarted = false;
+            while(slot > 0)
             {
-                /*Do not proceed unlock was not complete, or error occurred, let user know about error*/
-                return (USB_DEVICE_CDC_RESULT_ERROR);
+                slot --;
+                USB_DEVICE_IRPCancel(thisCDCDevice->deviceHandle, &stream->rxIRP[slot]);
             }
-            
-            return((USB_DEVICE_CDC_RESULT)irpError);
+            break;
         }
     }
-    
-    /*Release mutex, done with shared resource*/
-    osalError = OSAL_MUTEX_Unlock(&gUSBDeviceCdcCommonDataObj.mutexCDCIRP);
-    if(osalError != OSAL_RESULT_TRUE)
+
+    return((USB_DEVICE_CDC_RESULT)irpError);
+}
+
+// *****************************************************************************
+/* Function:
+    size_t USB_DEVICE_CDC_StreamReadAcquire
+    (
+        USB_DEVICE_CDC_INDEX instanceIndex,
+        void ** data
+    );
+
+  Summary:
+    Returns the received data that the application can read in place.
+
+  Description:
+    This function returns a pointer to the oldest received data in the receive
+    ring and the number of contiguous bytes available at that pointer.
+
+  Remarks:
+    Refer to usb_device_cdc.h for usage information.
+*/
+
+size_t USB_DEVICE_CDC_StreamReadAcquire
+(
+    USB_DEVICE_CDC_INDEX iCDC,
+    void ** data
+)
+{
+    USB_DEVICE_CDC_STREAM * stream;
+    USB_DEVICE_IRP * irp;
+
+    if ((iCDC >= USB_DEVICE_CDC_INSTANCES_NUMBER) || (data == NULL))
+    {
+        SYS_ASSERT(false, "Invalid parameter");
+        return 0;
+    }
+
+    stream = &gUSBDeviceCDCInstance[iCDC].stream;
+    irp = _USB_DEVICE_CDC_StreamReadSlotGet(iCDC);
+    if(irp == NULL)
+    {
+        /* No data available */
+        return 0;
+    }
+
+    *data = (uint8_t *)irp->data + stream->rxOffset;
+    return (irp->size - stream->rxOffset);
+}
+
+// *****************************************************************************
+/* Function:
+    USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_StreamReadCommit
+    (
+        USB_DEVICE_CDC_INDEX instanceIndex,
+        size_t size
+    );
+
+  Summary:
+    Releases received data that the application has consumed.
+
+  Description:
+    This function releases size bytes of the data returned by
+    USB_DEVICE_CDC_StreamReadAcquire(). A receive ring slot is armed again as
+    soon as all of its data has been released.
+
+  Remarks:
+    Refer to usb_device_cdc.h for usage information.
+*/
+
+USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_StreamReadCommit
+(
+    USB_DEVICE_CDC_INDEX iCDC,
+    size_t size
+)
+{
+    USB_DEVICE_CDC_STREAM * stream;
+    USB_DEVICE_IRP * irp;
+
+    if (  iCDC >= USB_DEVICE_CDC_INSTANCES_NUMBER  )
+    {
+        /* Invalid CDC index */
+        SYS_ASSERT(false, "Invalid CDC Device Index");
+        return USB_DEVICE_CDC_RESULT_ERROR_INSTANCE_INVALID;
+    }
+
+    stream = &gUSBDeviceCDCInstance[iCDC].stream;
+    irp = _USB_DEVICE_CDC_StreamReadSlotGet(iCDC);
+    if(irp == NULL)
+    {
+        return ((size == 0) ? USB_DEVICE_CDC_RESULT_OK : 
+                USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_SIZE_INVALID);
+    }
+
+    if(size > (irp->size - stream->rxOffset))
+    {
+        /* More data than was acquired */
+        return(USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_SIZE_INVALID);
+    }
+
+    /* The slot is armed again once all of its data has been consumed */
+    stream->rxOffset += size;
+    _USB_DEVICE_CDC_StreamReadSlotGet(iCDC);
+
+    return USB_DEVICE_CDC_RESULT_OK;
+}
+
+// *****************************************************************************
+/* Function:
+    size_t USB_DEVICE_CDC_StreamWriteAcquire
+    (
+        USB_DEVICE_CDC_INDEX instanceIndex,
+        void ** data
+    );
+
+  Summary:
+    Returns free transmit ring space that the application can write in place.
+
+  Description:
+    This function returns a pointer to the free space in the transmit ring
+    and the number of contiguous bytes that can be written at that pointer.
+
+  Remarks:
+    Refer to usb_device_cdc.h for usage information.
+*/
+
+size_t USB_DEVICE_CDC_StreamWriteAcquire
+(
+    USB_DEVICE_CDC_INDEX iCDC,
+    void ** data
+)
+{
+    USB_DEVICE_CDC_STREAM * stream;
+    size_t length;
+
+    if ((iCDC >= USB_DEVICE_CDC_INSTANCES_NUMBER) || (data == NULL))
     {
-        /*Do not proceed unlock was not complete, or error occurred, let user know about error*/
-        return (USB_DEVICE_CDC_RESULT_ERROR);
+        SYS_ASSERT(false, "Invalid parameter");
+        return 0;
     }
-    /* If here means we could not find a spare IRP */
-    return(USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_QUEUE_FULL);
+
+    stream = &gUSBDeviceCDCInstance[iCDC].stream;
+    if(!(stream->isStarted))
+    {
+        return 0;
+    }
+
+    /* Free space up to the end of the ring */
+    length = USB_DEVICE_CDC_STREAM_BUFFER_SIZE - stream->txUsed;
+    if(length > (USB_DEVICE_CDC_STREAM_BUFFER_SIZE - stream->txWrite))
+    {
+        length = USB_DEVICE_CDC_STREAM_BUFFER_SIZE - stream->txWrite;
+    }
+
+    *data = stream->txBuffer + stream->txWrite;
+    return length;
+}
+
+// *****************************************************************************
+/* Function:
+    USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_StreamWriteCommit
+    (
+        USB_DEVICE_CDC_INDEX instanceIndex,
+        size_t size
+    );
+
+  Summary:
+    Queues data written to the transmit ring for transmission.
+
+  Description:
+    This function queues size bytes written at the pointer returned by
+    USB_DEVICE_CDC_StreamWriteAcquire() for transmission to the host.
+
+  Remarks:
+    Refer to usb_device_cdc.h for usage information.
+*/
+
+USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_StreamWriteCommit
+(
+    USB_DEVICE_CDC_INDEX iCDC,
+    size_t size
+)
+{
+    USB_DEVICE_CDC_STREAM * stream;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+
+    if (  iCDC >= USB_DEVICE_CDC_INSTANCES_NUMBER  )
+    {
+        /* Invalid CDC index */
+        SYS_ASSERT(false, "Invalid CDC Device Index");
+        return USB_DEVICE_CDC_RESULT_ERROR_INSTANCE_INVALID;
+    }
+
+    stream = &gUSBDeviceCDCInstance[iCDC].stream;
+    if(!(stream->isStarted))
+    {
+        return (USB_DEVICE_CDC_RESULT_ERROR_INSTANCE_NOT_CONFIGURED);
+    }
+
+    if((size > (USB_DEVICE_CDC_STREAM_BUFFER_SIZE - stream->txUsed)) ||
+            (size > (USB_DEVICE_CDC_STREAM_BUFFER_SIZE - stream->txWrite)))
+    {
+        /* More data than was acquired */
+        return(USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_SIZE_INVALID);
+    }
+
+    stream->txWrite = (stream->txWrite + size) % USB_DEVICE_CDC_STREAM_BUFFER_SIZE;
+
+    /* The transmit IRP callback updates these counters */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    stream->txUsed += size;
+    stream->txCommitted += size;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+    _USB_DEVICE_CDC_StreamWriteSubmit(iCDC);
+
+    return USB_DEVICE_CDC_RESULT_OK;
 }
+#endif
 
 /*******************************************************************************
  End of File
@@ -57,6 +57,7 @@
 #include "usb/usb_common.h"
 #include "usb/usb_chapter_9.h"
 #include "usb/usb_device.h"
+#include "usb/src/usb_device_function_driver.h"
 #include "osal/osal.h"
 
 
@@ -69,6 +70,11 @@
 #define USB_DEVICE_CDC_ENDPOINT_RX          USB_DATA_DIRECTION_HOST_TO_DEVICE 
 #define USB_DEVICE_CDC_ENDPOINT_TX          USB_DATA_DIRECTION_DEVICE_TO_HOST
 
+/* Number of IRPs that a CDC stream keeps on each bulk endpoint */
+#if defined(USB_DEVICE_CDC_STREAM_BUFFER_SIZE) && !defined(USB_DEVICE_CDC_STREAM_IRPS_NUMBER)
+#define USB_DEVICE_CDC_STREAM_IRPS_NUMBER   2
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Data Types
@@ -125,6 +131,74 @@ typedef struct
 
 }USB_DEVICE_CDC_INTERFACE;
 
+#if defined(USB_DEVICE_CDC_STREAM_BUFFER_SIZE)
+
+// *****************************************************************************
+/* CDC stream object.
+
+  Summary:
+    Holds the state of the receive and transmit rings of a CDC stream.
+
+  Description:
+    The receive ring is split into USB_DEVICE_CDC_STREAM_IRPS_NUMBER slots.
+    Each slot has its own IRP that is kept armed on the bulk OUT endpoint.
+    A slot is armed again once the application has consumed all of its data.
+
+    The transmit ring is a byte ring. Data that the application commits is
+    sent with up to USB_DEVICE_CDC_STREAM_IRPS_NUMBER IRPs on the bulk IN
+    endpoint. The ring space is released when an IRP completes.
+
+  Remarks:
+    This structure is internal to the CDC function driver.
+*/
+typedef struct
+{
+    /* True if the stream has been started and no transfer was aborted */
+    volatile bool isStarted;
+
+    /* Receive ring and the IRPs armed on its slots */
+    uint8_t * rxBuffer;
+    USB_DEVICE_IRP rxIRP[USB_DEVICE_CDC_STREAM_IRPS_NUMBER];
+
+    /* Size of a receive ring slot */
+    size_t rxSlotSize;
+
+    /* Slot that the application reads from */
+    unsigned int rxSlot;
+
+    /* Number of bytes of the current slot consumed by the application */
+    size_t rxOffset;
+
+    /* Transmit ring and the IRPs that send it */
+    uint8_t * txBuffer;
+    USB_DEVICE_IRP txIRP[USB_DEVICE_CDC_STREAM_IRPS_NUMBER];
+
+    /* Next transmit IRP to be submitted */
+    unsigned int txIRPSubmit;
+
+    /* Number of transmit IRPs in flight */
+    volatile unsigned int txIRPsPending;
+
+    /* Ring offset at which the application writes next */
+    size_t txWrite;
+
+    /* Ring offset of the first committed byte that is not submitted */
+    size_t txSend;
+
+    /* Committed bytes that are not submitted yet */
+    volatile size_t txCommitted;
+
+    /* Committed bytes that are not sent yet. The rest of the ring is free. */
+    volatile size_t txUsed;
+
+    /* True while a context submits transmit IRPs. Other contexts leave the
+     * submit to it, so that IRPs are submitted in ring order. */
+    volatile bool txSubmitting;
+
+} USB_DEVICE_CDC_STREAM;
+
+#endif
+
 // *****************************************************************************
 /* CDC instance structure.
 
@@ -168,6 +242,14 @@ typedef struct
     volatile unsigned int currentQSizeRead;
     volatile unsigned int currentQSizeSerialStateNotification;
 
+    /* IRP pool from which this instance allocates IRPs */
+    USB_DEVICE_IRP_POOL * irpPool;
+
+#if defined(USB_DEVICE_CDC_STREAM_BUFFER_SIZE)
+    /* Streaming mode rings */
+    USB_DEVICE_CDC_STREAM stream;
+#endif
+
 } USB_DEVICE_CDC_INSTANCE;
 
 // *****************************************************************************
@@ -188,10 +270,12 @@ typedef struct
 {
     /* Set to true if all members of this structure
        have been initialized once */
-    bool isMutexCdcIrpInitialized;
+    bool isIrpPoolInitialized;
 
-    /* Mutex to protect client object pool */
-    OSAL_MUTEX_DECLARE(mutexCDCIRP);
+#if !defined(USB_DEVICE_IRP_POOL_SIZE)
+    /* Pool of IRPs shared by all CDC instances */
+    USB_DEVICE_IRP_POOL irpPool;
+#endif
 
 } USB_DEVICE_CDC_COMMON_DATA_OBJ;
 
@@ -385,6 +469,25 @@ void _USB_DEVICE_CDC_WriteIRPCallback (USB_DEVICE_IRP * irp );
 
 void _USB_DEVICE_CDC_ReadIRPCallback (USB_DEVICE_IRP * irp );
 
+#if defined(USB_DEVICE_CDC_STREAM_BUFFER_SIZE)
+//******************************************************************************
+/* Function:
+    void _USB_DEVICE_CDC_StreamWriteIRPCallback (USB_DEVICE_IRP * irp )
+
+  Summary:
+    Stream TX data callback.
+
+  Description:
+    This function releases transmit ring space when a stream IRP completes and
+    submits the next committed data.
+
+  Remarks:
+    Called by the controller driver
+ */
+
+void _USB_DEVICE_CDC_StreamWriteIRPCallback (USB_DEVICE_IRP * irp );
+#endif
+
 extern USB_DEVICE_FUNCTION_DRIVER cdcFuncDriver;
 
 #ifdef __cplusplus  // Provide C++ Compatibility
@@ -58,9 +58,165 @@
 /* USB Device Endpoint IRP array. */
 USB_DEVICE_IRP gUSBDeviceEndpointIRP[USB_DEVICE_ENDPOINT_QUEUE_DEPTH_COMBINED];
 
+/* Free IRP index stack. Every USB Device instance owns the range of this
+   array that matches its partition of gUSBDeviceEndpointIRP. */
+uint16_t gUSBDeviceEndpointIRPFreeStack[USB_DEVICE_ENDPOINT_QUEUE_DEPTH_COMBINED];
+
+/* Tracks if an IRP index is currently on the free stack. This protects the
+   free stack against an IRP being returned twice. */
+bool gUSBDeviceEndpointIRPIsFree[USB_DEVICE_ENDPOINT_QUEUE_DEPTH_COMBINED];
+
+/* Index of the first IRP that has not been assigned to any instance */
+uint16_t gUSBDeviceEndpointIRPPartitionNext = 0;
+
 /* Array for tracking Read/Write Queue size for each USB Device instance */
 USB_DEVICE_Q_SIZE_ENDPOINT qSizeEndpoint[USB_DEVICE_INSTANCES_NUMBER];
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: USB Device Layer Endpoint IRP allocation functions.
+// *****************************************************************************
+// *****************************************************************************
+// ******************************************************************************
+/* Function:
+    USB_DEVICE_IRP * _USB_DEVICE_EndpointIRPAllocate
+    (
+        USB_DEVICE_Q_SIZE_ENDPOINT * thisEndpointQueueSize,
+        bool isRead
+    )
+
+  Summary:
+    Gets a free IRP from the partition of this instance.
+
+  Description:
+    This function pops an IRP from the free IRP index stack of the instance and
+    updates the read or write queue size. The pop and the queue size check are
+    done in one critical section so that the function can be called from
+    multiple threads and from the IRP callbacks without a mutex. Returns NULL
+    if the queue is full.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static USB_DEVICE_IRP * _USB_DEVICE_EndpointIRPAllocate
+(
+    USB_DEVICE_Q_SIZE_ENDPOINT * thisEndpointQueueSize,
+    bool isRead
+)
+{
+    USB_DEVICE_IRP * irp = NULL;
+    uint16_t irpIndex;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+
+    /* Prevent other tasks and the IRP callbacks pre-empting this sequence of
+     * code */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+    if(isRead)
+    {
+        if(thisEndpointQueueSize->qSizeCurrentEpRead < thisEndpointQueueSize->qSizeMaxEpRead)
+        {
+            if(thisEndpointQueueSize->irpFreeCount > 0)
+            {
+                (thisEndpointQueueSize->qSizeCurrentEpRead)++;
+                (thisEndpointQueueSize->irpFreeCount)--;
+                irpIndex = gUSBDeviceEndpointIRPFreeStack[thisEndpointQueueSize->irpPartitionStart +
+                        thisEndpointQueueSize->irpFreeCount];
+                gUSBDeviceEndpointIRPIsFree[irpIndex] = false;
+                irp = &gUSBDeviceEndpointIRP[irpIndex];
+            }
+        }
+    }
+    else
+    {
+        if(thisEndpointQueueSize->qSizeCurrentEpWrite < thisEndpointQueueSize->qSizeMaxEpWrite)
+        {
+            if(thisEndpointQueueSize->irpFreeCount > 0)
+            {
+                (thisEndpointQueueSize->qSizeCurrentEpWrite)++;
+                (thisEndpointQueueSize->irpFreeCount)--;
+                irpIndex = gUSBDeviceEndpointIRPFreeStack[thisEndpointQueueSize->irpPartitionStart +
+                        thisEndpointQueueSize->irpFreeCount];
+                gUSBDeviceEndpointIRPIsFree[irpIndex] = false;
+                irp = &gUSBDeviceEndpointIRP[irpIndex];
+            }
+        }
+    }
+
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+    return(irp);
+}
+
+// ******************************************************************************
+/* Function:
+    void _USB_DEVICE_EndpointIRPRelease
+    (
+        USB_DEVICE_Q_SIZE_ENDPOINT * thisEndpointQueueSize,
+        USB_DEVICE_IRP * irp,
+        bool isRead
+    )
+
+  Summary:
+    Returns an IRP to the partition of this instance.
+
+  Description:
+    This function pushes the IRP back on the free IRP index stack of the
+    instance and updates the read or write queue size. An IRP that is already
+    on the free stack (this can happen if the queue was reset while the IRP was
+    pending) is ignored.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static void _USB_DEVICE_EndpointIRPRelease
+(
+    USB_DEVICE_Q_SIZE_ENDPOINT * thisEndpointQueueSize,
+    USB_DEVICE_IRP * irp,
+    bool isRead
+)
+{
+    uint16_t irpIndex;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+
+    irpIndex = (uint16_t)(irp - gUSBDeviceEndpointIRP);
+
+    /* Prevent other tasks pre-empting this sequence of code */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+    if((gUSBDeviceEndpointIRPIsFree[irpIndex] == false) &&
+            (thisEndpointQueueSize->irpFreeCount < thisEndpointQueueSize->irpPartitionSize))
+    {
+        gUSBDeviceEndpointIRPIsFree[irpIndex] = true;
+        gUSBDeviceEndpointIRPFreeStack[thisEndpointQueueSize->irpPartitionStart +
+                thisEndpointQueueSize->irpFreeCount] = irpIndex;
+        (thisEndpointQueueSize->irpFreeCount)++;
+
+        /* Update the queue size. We have freed one queue element as we have
+         * completed a transfer */
+        if(isRead)
+        {
+            if(thisEndpointQueueSize->qSizeCurrentEpRead > 0)
+            {
+                (thisEndpointQueueSize->qSizeCurrentEpRead)--;
+            }
+        }
+        else
+        {
+            if(thisEndpointQueueSize->qSizeCurrentEpWrite > 0)
+            {
+                (thisEndpointQueueSize->qSizeCurrentEpWrite)--;
+            }
+        }
+    }
+
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+}
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: USB Device Layer System Interface functions.
@@ -98,15 +254,12 @@ USB_DEVICE_RESULT USB_DEVICE_EndpointWrite
     USB_DEVICE_TRANSFER_FLAGS flags
 )
 {
-    int count = 0;
     USB_DEVICE_OBJ* devClientHandle;
     USB_ERROR irpSubmitError;
     SYS_MODULE_INDEX deviceInstanceNumber;
     USB_DEVICE_Q_SIZE_ENDPOINT* thisEndpointQueueSize;
     USB_DEVICE_IRP * irp ;
-    OSAL_RESULT osalError;
     *transferHandle = USB_DEVICE_TRANSFER_HANDLE_INVALID;
-    OSAL_CRITSECT_DATA_TYPE IntState;
 
 
     /* Validate the handle */
@@ -123,77 +276,34 @@ USB_DEVICE_RESULT USB_DEVICE_EndpointWrite
     /* Get Handle to the Endpoint Queue Size structure */
     thisEndpointQueueSize  = &qSizeEndpoint[deviceInstanceNumber];
 
-    /* Make sure that we are with in the queue size for this instance */
-    if(thisEndpointQueueSize->qSizeCurrentEpWrite >= thisEndpointQueueSize->qSizeMaxEpWrite)
+    /* Get a free IRP. This will fail if the write queue of this instance is
+     * full. */
+    irp = _USB_DEVICE_EndpointIRPAllocate(thisEndpointQueueSize, false);
+    if(irp == NULL)
     {
-        SYS_DEBUG(0, "Write Queue is full");
+        SYS_DEBUG(0, "USB Device Endpoint Write: Transfer queue is full");
         return(USB_DEVICE_RESULT_ERROR_TRANSFER_QUEUE_FULL);
     }
 
-    /*Obtain mutex to get access to a shared resource, check return value*/
-    osalError = OSAL_MUTEX_Lock(&(devClientHandle->mutexEndpointIRP), OSAL_WAIT_FOREVER);
-    if(osalError != OSAL_RESULT_TRUE)
-    {
-      /*Do not proceed lock was not obtained, or error occurred, let user know about error*/
-      return (USB_DEVICE_RESULT_ERROR);
-    }
+    /* Configure the IRP and then submit */
+    irp->data = (void *)data;
+    irp->size = size;
+    irp->flags = flags;
+    irp->callback = &_USB_DEVICE_EndpointWriteCallBack;
+    irp->userData = (uintptr_t)devClientHandle;
+    (* transferHandle) = ( USB_DEVICE_TRANSFER_HANDLE )irp;
 
-    /* Check if the if there is free slot available in queue */
-    for(count = 0; count < (USB_DEVICE_ENDPOINT_QUEUE_DEPTH_COMBINED) ; count ++ )
-    {
-        if(gUSBDeviceEndpointIRP[count].status <
-                (USB_DEVICE_IRP_STATUS)USB_DEVICE_IRP_FLAG_DATA_PENDING)
-        {
-            /* This means the IRP is free. Configure the IRP
-             * update the current queue size and then submit */
-            irp = &gUSBDeviceEndpointIRP[count]; 
-            irp->data = (void *)data;
-            irp->size = size;
-            irp->flags = flags;
-            irp->callback = &_USB_DEVICE_EndpointWriteCallBack;
-            irp->userData = (uintptr_t)devClientHandle;
-            (* transferHandle) = ( USB_DEVICE_TRANSFER_HANDLE )irp;
-            
-            /* Prevent other tasks pre-empting this sequence of code */ 
-            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-            (thisEndpointQueueSize->qSizeCurrentEpWrite)++;
-            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-            
-            irpSubmitError = USB_DEVICE_IRPSubmit( (USB_DEVICE_HANDLE)devClientHandle, endpoint, irp);
-            
-            /* If IRP Submit function returned any error, then invalidate the
-               Transfer handle.  */
-            if (irpSubmitError != USB_ERROR_NONE )
-            {
-                /* Prevent other tasks pre-empting this sequence of code */ 
-                IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-                /* Update the read queue size */ 
-                (thisEndpointQueueSize->qSizeCurrentEpWrite)--;
-                OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-                *transferHandle = USB_DEVICE_TRANSFER_HANDLE_INVALID;
-            }
-            
-            /*Release mutex, done with shared resource*/
-            osalError = OSAL_MUTEX_Unlock(&(devClientHandle->mutexEndpointIRP));
-            if(osalError != OSAL_RESULT_TRUE)
-            {
-                /*Do not proceed lock was not obtained, or error occurred, let user know about error*/
-                return (USB_DEVICE_RESULT_ERROR);
-            }
-            return(irpSubmitError);
-        }
-    }
-    
-    /*Release mutex, done with shared resource*/
-    osalError = OSAL_MUTEX_Unlock(&(devClientHandle->mutexEndpointIRP));
-    if(osalError != OSAL_RESULT_TRUE)
+    irpSubmitError = USB_DEVICE_IRPSubmit( (USB_DEVICE_HANDLE)devClientHandle, endpoint, irp);
+
+    /* If IRP Submit function returned any error, then invalidate the
+       Transfer handle and return the IRP. */
+    if (irpSubmitError != USB_ERROR_NONE )
     {
-        /*Do not proceed, unlock was not completed, or error occurred, let user know about error*/
-        return (USB_DEVICE_RESULT_ERROR);
+        _USB_DEVICE_EndpointIRPRelease(thisEndpointQueueSize, irp, false);
+        *transferHandle = USB_DEVICE_TRANSFER_HANDLE_INVALID;
     }
-    /* We could not find a spare IRP */
-    SYS_DEBUG(0, "USB Device Endpoint Write: Transfer queue is full");
-    return USB_DEVICE_RESULT_ERROR_TRANSFER_QUEUE_FULL;
+
+    return(irpSubmitError);
 }
 
 
@@ -228,15 +338,12 @@ USB_DEVICE_RESULT USB_DEVICE_EndpointRead
     size_t bufferSize
 )
 {
-    int count = 0;
     USB_DEVICE_OBJ* devClientHandle;
     USB_ERROR irpSubmitError;
     SYS_MODULE_INDEX deviceInstanceNumber;
     USB_DEVICE_Q_SIZE_ENDPOINT* thisEndpointQueueSize;
-    USB_DEVICE_IRP * irp = gUSBDeviceEndpointIRP;
-    OSAL_RESULT osalError;
+    USB_DEVICE_IRP * irp;
     *transferHandle = USB_DEVICE_TRANSFER_HANDLE_INVALID;
-    OSAL_CRITSECT_DATA_TYPE IntState;
     
     /* Validate the handle */
     devClientHandle = _USB_DEVICE_ClientHandleValidate(usbDeviceHandle);
@@ -252,76 +359,33 @@ USB_DEVICE_RESULT USB_DEVICE_EndpointRead
     /* Get Handle to the Endpoint Queue Size structure */
     thisEndpointQueueSize  = &qSizeEndpoint[deviceInstanceNumber];
     
-    /* Make sure that we are with in the queue size for this instance */
-    if(thisEndpointQueueSize->qSizeCurrentEpRead >= thisEndpointQueueSize->qSizeMaxEpRead)
+    /* Get a free IRP. This will fail if the read queue of this instance is
+     * full. */
+    irp = _USB_DEVICE_EndpointIRPAllocate(thisEndpointQueueSize, true);
+    if(irp == NULL)
     {
         SYS_ASSERT(false, "Read Queue is full");
         return(USB_DEVICE_RESULT_ERROR_TRANSFER_QUEUE_FULL);
     }
-    
-    /*Obtain mutex to get access to a shared resource, check return value*/
-    osalError = OSAL_MUTEX_Lock(&(devClientHandle->mutexEndpointIRP), OSAL_WAIT_FOREVER);
-    if(osalError != OSAL_RESULT_TRUE)
-    {
-      /*Do not proceed lock was not obtained, or error occurred, let user know about error*/
-      return (USB_DEVICE_RESULT_ERROR);
-    }
 
-    /* Check if the if there is free slot available in queue */
-    for(count = 0; count < (USB_DEVICE_ENDPOINT_QUEUE_DEPTH_COMBINED) ; count ++ )
-    {
-        if(gUSBDeviceEndpointIRP[count].status <
-                (USB_DEVICE_IRP_STATUS)USB_DEVICE_IRP_FLAG_DATA_PENDING)
-        {
-            /* This means the IRP is free. Configure the IRP
-             * update the current queue size and then submit */
-            irp = &gUSBDeviceEndpointIRP[count]; 
-            irp->data = buffer;
-            irp->size = bufferSize;
-            irp->callback = &_USB_DEVICE_EndpointReadCallBack;
-            irp->userData = (uintptr_t)devClientHandle;
-            (*transferHandle) = (USB_DEVICE_TRANSFER_HANDLE ) irp;
-            
-            /* Prevent other tasks pre-empting this sequence of code */ 
-            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-            (thisEndpointQueueSize->qSizeCurrentEpRead)++;
-            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-            
-            irpSubmitError = USB_DEVICE_IRPSubmit((USB_DEVICE_HANDLE)devClientHandle, endpoint, irp);
-            
-            /* If IRP Submit function returned any error, then invalidate the
-               Transfer handle.  */
-            if (irpSubmitError != USB_ERROR_NONE )
-            {
-                /* Prevent other tasks pre-empting this sequence of code */ 
-                IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-                /* Update the read queue size */ 
-                (thisEndpointQueueSize->qSizeCurrentEpRead)--;
-                OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-                *transferHandle = USB_DEVICE_TRANSFER_HANDLE_INVALID;
-            }
-            
-            /*Release mutex, done with shared resource*/
-            osalError = OSAL_MUTEX_Unlock(&(devClientHandle->mutexEndpointIRP));
-            if(osalError != OSAL_RESULT_TRUE)
-            {
-                /*Do not proceed lock was not obtained, or error occurred, let user know about error*/
-                return (USB_DEVICE_RESULT_ERROR);
-            }
+    /* Configure the IRP and then submit */
+    irp->data = buffer;
+    irp->size = bufferSize;
+    irp->callback = &_USB_DEVICE_EndpointReadCallBack;
+    irp->userData = (uintptr_t)devClientHandle;
+    (*transferHandle) = (USB_DEVICE_TRANSFER_HANDLE ) irp;
 
-            return(irpSubmitError);
-        }
-    }
-    /*Release mutex, done with shared resource*/
-    osalError = OSAL_MUTEX_Unlock(&(devClientHandle->mutexEndpointIRP));
-    if(osalError != OSAL_RESULT_TRUE)
+    irpSubmitError = USB_DEVICE_IRPSubmit((USB_DEVICE_HANDLE)devClientHandle, endpoint, irp);
+
+    /* If IRP Submit function returned any error, then invalidate the
+       Transfer handle and return the IRP. */
+    if (irpSubmitError != USB_ERROR_NONE )
     {
-        /*Do not proceed, unlock was not complete, or error occurred, let user know about error*/
-        return (USB_DEVICE_RESULT_ERROR);
+        _USB_DEVICE_EndpointIRPRelease(thisEndpointQueueSize, irp, true);
+        *transferHandle = USB_DEVICE_TRANSFER_HANDLE_INVALID;
     }
-    /* Could not find a free IRP. */
-    SYS_DEBUG(0, "USB Device Endpoint Read: Transfer queue is full");
-    return USB_DEVICE_RESULT_ERROR_TRANSFER_QUEUE_FULL;
+
+    return(irpSubmitError);
 }
 
 /******************************************************************************
@@ -409,41 +473,41 @@ void _USB_DEVICE_EndpointWriteCallBack( USB_DEVICE_IRP * irp )
     /* Get Handle to the Endpoint Queue Size */
     thisEndpointQueueSize = &qSizeEndpoint[deviceInstanceNumber];
 
-    /* Update Queue Size. We have freed one read queue element as we have
-     completed a Transfer */
-    thisEndpointQueueSize->qSizeCurrentEpWrite --;
-       
-    if( devClientHandle->callBackFunc != NULL )
+    /* Get data size received from Host */
+    eventData.length = irp->size;
+
+    /* Get Transfer Handle */
+    eventData.transferHandle = ( USB_DEVICE_TRANSFER_HANDLE )irp;
+
+    /* Get transfer status */
+    if ((irp->status == USB_DEVICE_IRP_STATUS_COMPLETED) 
+        || (irp->status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
+    {
+        /* Transfer completed successfully */
+        eventData.status = USB_DEVICE_RESULT_OK; 
+    }
+    else if (irp->status == USB_DEVICE_IRP_STATUS_ABORTED_ENDPOINT_HALT)
+    {
+        /* Transfer canceled due to Endpoint Halt */
+        eventData.status = USB_DEVICE_RESULT_ERROR_ENDPOINT_HALTED; 
+    }
+    else if (irp->status == USB_DEVICE_IRP_STATUS_TERMINATED_BY_HOST)
     {
-        /* Get data size received from Host */
-        eventData.length = irp->size;
+        /* Transfer Canceled by Host (Host sent a Clear feature )*/
+        eventData.status = USB_DEVICE_RESULT_ERROR_TERMINATED_BY_HOST; 
+    }
+    else
+    {
+        /* Transfer was not completed successfully */
+        eventData.status = USB_DEVICE_RESULT_ERROR; 
+    }
 
-        /* Get Transfer Handle */
-        eventData.transferHandle = ( USB_DEVICE_TRANSFER_HANDLE )irp;
+    /* The IRP is returned before the application is notified so that the
+     * application can submit the next transfer from the event handler. */
+    _USB_DEVICE_EndpointIRPRelease(thisEndpointQueueSize, irp, false);
 
-        /* Get transfer status */
-        if ((irp->status == USB_DEVICE_IRP_STATUS_COMPLETED) 
-            || (irp->status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
-        {
-            /* Transfer completed successfully */
-            eventData.status = USB_DEVICE_RESULT_OK; 
-        }
-        else if (irp->status == USB_DEVICE_IRP_STATUS_ABORTED_ENDPOINT_HALT)
-        {
-            /* Transfer canceled due to Endpoint Halt */
-            eventData.status = USB_DEVICE_RESULT_ERROR_ENDPOINT_HALTED; 
-        }
-        else if (irp->status == USB_DEVICE_IRP_STATUS_TERMINATED_BY_HOST)
-        {
-            /* Transfer Canceled by Host (Host sent a Clear feature )*/
-            eventData.status = USB_DEVICE_RESULT_ERROR_TERMINATED_BY_HOST; 
-        }
-        else
-        {
-            /* Transfer was not completed successfully */
-            eventData.status = USB_DEVICE_RESULT_ERROR; 
-        }
-        
+    if( devClientHandle->callBackFunc != NULL )
+    {
         /* Send an event to application letting it know that a endpoint write
          * has completed */
         devClientHandle->callBackFunc(
@@ -482,41 +546,41 @@ void _USB_DEVICE_EndpointReadCallBack( USB_DEVICE_IRP * irp )
     /* Get Handle to the Endpoint Queue Size */
     thisEndpointQueueSize = &qSizeEndpoint[deviceInstanceNumber];
 
-    /* Update Queue Size. We have freed one read queue element as we have
-    completed a Transfer */
-    thisEndpointQueueSize->qSizeCurrentEpRead --;
+    /* Get data size received from Host */
+    eventData.length = irp->size;
 
-    if( devClientHandle->callBackFunc != NULL )
+    /* Get Transfer Handle */
+    eventData.transferHandle = ( USB_DEVICE_TRANSFER_HANDLE )irp;
+
+    /* Get transfer status */
+    if ((irp->status == USB_DEVICE_IRP_STATUS_COMPLETED) 
+        || (irp->status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
     {
-        /* Get data size received from Host */
-        eventData.length = irp->size;
-
-        /* Get Transfer Handle */
-        eventData.transferHandle = ( USB_DEVICE_TRANSFER_HANDLE )irp;
-        
-        /* Get transfer status */
-        if ((irp->status == USB_DEVICE_IRP_STATUS_COMPLETED) 
-            || (irp->status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
-        {
-            /* Transfer completed successfully */
-            eventData.status = USB_DEVICE_RESULT_OK; 
-        }
-        else if (irp->status == USB_DEVICE_IRP_STATUS_ABORTED_ENDPOINT_HALT)
-        {
-            /* Transfer canceled due to Endpoint Halt */
-            eventData.status = USB_DEVICE_RESULT_ERROR_ENDPOINT_HALTED; 
-        }
-        else if (irp->status == USB_DEVICE_IRP_STATUS_TERMINATED_BY_HOST)
-        {
-            /* Transfer Canceled by Host (Host sent a Clear feature )*/
-            eventData.status = USB_DEVICE_RESULT_ERROR_TERMINATED_BY_HOST; 
-        }
-        else
-        {
-            /* Transfer was not completed successfully */
-            eventData.status = USB_DEVICE_RESULT_ERROR; 
-        }
+        /* Transfer completed successfully */
+        eventData.status = USB_DEVICE_RESULT_OK; 
+    }
+    else if (irp->status == USB_DEVICE_IRP_STATUS_ABORTED_ENDPOINT_HALT)
+    {
+        /* Transfer canceled due to Endpoint Halt */
+        eventData.status = USB_DEVICE_RESULT_ERROR_ENDPOINT_HALTED; 
+    }
+    else if (irp->status == USB_DEVICE_IRP_STATUS_TERMINATED_BY_HOST)
+    {
+        /* Transfer Canceled by Host (Host sent a Clear feature )*/
+        eventData.status = USB_DEVICE_RESULT_ERROR_TERMINATED_BY_HOST; 
+    }
+    else
+    {
+        /* Transfer was not completed successfully */
+        eventData.status = USB_DEVICE_RESULT_ERROR; 
+    }
+
+    /* The IRP is returned before the application is notified so that the
+     * application can submit the next transfer from the event handler. */
+    _USB_DEVICE_EndpointIRPRelease(thisEndpointQueueSize, irp, true);
 
+    if( devClientHandle->callBackFunc != NULL )
+    {
         /* Send an event to application letting it know that a endpoint read
          * has completed */
         devClientHandle->callBackFunc(
@@ -526,29 +590,69 @@ void _USB_DEVICE_EndpointReadCallBack( USB_DEVICE_IRP * irp )
     }
 }
 
-void _USB_DEVICE_Initialize_Endpoint_Q_Size(SYS_MODULE_INDEX index, uint16_t qSizeRead, uint16_t qSizeWrite )
+bool _USB_DEVICE_Initialize_Endpoint_Q_Size(SYS_MODULE_INDEX index, uint16_t qSizeRead, uint16_t qSizeWrite )
 {
+    uint16_t partitionSize;
     USB_DEVICE_Q_SIZE_ENDPOINT* thisEndpointQueue = &qSizeEndpoint[index];
     thisEndpointQueue->qSizeMaxEpRead = qSizeRead;
     thisEndpointQueue->qSizeMaxEpWrite = qSizeWrite;
-    thisEndpointQueue->qSizeCurrentEpRead = 0;
-    thisEndpointQueue->qSizeCurrentEpWrite = 0; 
+
+    if(thisEndpointQueue->irpPartitionSize == 0)
+    {
+        /* This instance does not own any IRPs yet. Assign the next free range
+         * of the IRP array to this instance. The partition is kept if the
+         * instance is initialized again. */
+        partitionSize = qSizeRead + qSizeWrite;
+        if(partitionSize > (USB_DEVICE_ENDPOINT_QUEUE_DEPTH_COMBINED - gUSBDeviceEndpointIRPPartitionNext))
+        {
+            /* The instance would get fewer IRPs than its queue sizes allow.
+             * The configuration must be fixed. */
+            SYS_ASSERT(false, "USB Device Layer: Endpoint queue sizes exceed USB_DEVICE_ENDPOINT_QUEUE_DEPTH_COMBINED");
+            return false;
+        }
+
+        thisEndpointQueue->irpPartitionStart = gUSBDeviceEndpointIRPPartitionNext;
+        thisEndpointQueue->irpPartitionSize = partitionSize;
+        gUSBDeviceEndpointIRPPartitionNext += partitionSize;
+    }
+    else if((qSizeRead + qSizeWrite) > thisEndpointQueue->irpPartitionSize)
+    {
+        /* The instance is initialized again with larger queue sizes */
+        SYS_ASSERT(false, "USB Device Layer: Endpoint queue sizes exceed the IRPs of this instance");
+        return false;
+    }
+
+    _USB_DEVICE_EndpointQueueSizeReset(index);
+
+    return true;
 }
 
 void _USB_DEVICE_EndpointQueueSizeReset(SYS_MODULE_INDEX index)
 {
-    int iEntry;
+    uint16_t iEntry;
+    uint16_t irpIndex;
+    OSAL_CRITSECT_DATA_TYPE IntState;
 
     /* This function is called when the device layer receives
      * a Set Configuration request */
     USB_DEVICE_Q_SIZE_ENDPOINT* thisEndpointQueue = &qSizeEndpoint[index];
+
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
     thisEndpointQueue->qSizeCurrentEpRead = 0;
     thisEndpointQueue->qSizeCurrentEpWrite = 0;
 
-    for(iEntry = 0; iEntry < USB_DEVICE_ENDPOINT_QUEUE_DEPTH_COMBINED; iEntry ++)
+    for(iEntry = 0; iEntry < thisEndpointQueue->irpPartitionSize; iEntry ++)
     {
-        /* Get back all the IRPs */
-        gUSBDeviceEndpointIRP[iEntry].status = USB_DEVICE_IRP_STATUS_COMPLETED;
+        /* Get back all the IRPs of this instance and rebuild the free stack */
+        irpIndex = thisEndpointQueue->irpPartitionStart + iEntry;
+        gUSBDeviceEndpointIRP[irpIndex].status = USB_DEVICE_IRP_STATUS_COMPLETED;
+        gUSBDeviceEndpointIRPFreeStack[irpIndex] = irpIndex;
+        gUSBDeviceEndpointIRPIsFree[irpIndex] = true;
     }
+
+    thisEndpointQueue->irpFreeCount = thisEndpointQueue->irpPartitionSize;
+
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
 }
 /********************End of file********************************/
@@ -151,6 +151,103 @@ typedef struct
 
 } USB_DEVICE_FUNC_DRIVER_DATA;
 
+// *****************************************************************************
+/* USB Device IRP Pool
+
+  Summary:
+    Pool of IRPs used by the function drivers.
+
+  Description:
+    This structure tracks a pool of IRPs. The free IRPs are kept on an index
+    stack, so that an IRP can be allocated and released in constant time. The
+    stack is protected by a short critical section, which allows the pool to be
+    used from the application threads and from the IRP callbacks without a
+    mutex.
+    
+    If USB_DEVICE_IRP_POOL_SIZE is defined, every device layer instance owns
+    one pool of this size that is shared by all function drivers registered
+    with the instance. Otherwise, every function driver owns a pool sized by
+    its own queue depth configuration.
+
+  Remarks:
+    This structure is private to the USB stack.
+*/
+
+typedef struct
+{
+    /* Array of IRPs that are managed by this pool */
+    USB_DEVICE_IRP * irp;
+
+    /* Stack of indexes of the free IRPs in the irp array */
+    uint16_t * freeStack;
+
+    /* Tracks if an IRP is currently on the free stack. This protects the
+       free stack against an IRP being released twice. */
+    bool * isFree;
+
+    /* Number of IRPs in the irp array */
+    uint16_t size;
+
+    /* Number of IRP indexes on the free stack */
+    volatile uint16_t freeCount;
+
+    /* Lowest number of free IRPs since the pool was initialized. This can
+       be used to size the pool. */
+    uint16_t freeCountLowWaterMark;
+
+    /* Offset added to the index of an IRP in this pool to get a number that
+       is unique across all pools of the same type. */
+    uint16_t indexOffset;
+
+} USB_DEVICE_IRP_POOL;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: USB Device IRP Pool Routines
+// *****************************************************************************
+// *****************************************************************************
+
+void _USB_DEVICE_IRPPoolInitialize
+(
+    USB_DEVICE_IRP_POOL * irpPool,
+    USB_DEVICE_IRP * irp,
+    uint16_t * freeStack,
+    bool * isFree,
+    uint16_t size,
+    uint16_t indexOffset
+);
+
+USB_DEVICE_IRP * _USB_DEVICE_IRPPoolAllocate
+(
+    USB_DEVICE_IRP_POOL * irpPool,
+    volatile unsigned int * currentQueueSize,
+    unsigned int queueSize
+);
+
+void _USB_DEVICE_IRPPoolRelease
+(
+    USB_DEVICE_IRP_POOL * irpPool,
+    USB_DEVICE_IRP * irp,
+    volatile unsigned int * currentQueueSize
+);
+
+bool _USB_DEVICE_IRPPoolContains
+(
+    USB_DEVICE_IRP_POOL * irpPool,
+    USB_DEVICE_IRP * irp
+);
+
+uint16_t _USB_DEVICE_IRPPoolIndexGet
+(
+    USB_DEVICE_IRP_POOL * irpPool,
+    USB_DEVICE_IRP * irp
+);
+
+USB_DEVICE_IRP_POOL * _USB_DEVICE_IRPPoolGet
+(
+    USB_DEVICE_HANDLE usbDeviceHandle
+);
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: USB Device IRP Routines
@@ -221,6 +318,14 @@ typedef struct
         will send multiple of endpoint size number of bytes. For example, if the
         IRP size is 130 and the endpoint size if 64, the number of bytes sent
         will 128.
+      * If the flag parameter includes USB_DEVICE_IRP_FLAG_DATA_SEGMENTS, the
+        data parameter points to an array of USB_IRP_DATA_SEGMENT and the
+        size parameter is the total size of the segments. If the driver does
+        not support data segments (see USB_DEVICE_IRPDataSegmentsIsSupported),
+        the Device Layer copies the data through a bounce buffer when
+        USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER is specified. The data and flags
+        members of the IRP are restored before the IRP callback is called.
+        Data segments are not supported on endpoint 0.
 		
   Precondition:
     The Device Layer handle should be valid.
@@ -234,8 +339,14 @@ typedef struct
   Returns:
     * USB_ERROR_NONE - if the IRP was submitted successful.
     * USB_ERROR_IRP_SIZE_INVALID - if the size parameter of the IRP is not
-      correct. 
-    * USB_ERROR_PARAMETER_INVALID - If the client handle is not valid.
+      correct or if the IRP has data segments and is larger than the Device
+      Layer bounce buffer. 
+    * USB_ERROR_PARAMETER_INVALID - If the client handle is not valid or if
+      the IRP has data segments, the driver does not support these and the
+      Device Layer bounce buffers are not enabled.
+    * USB_ERROR_IRP_OBJECTS_UNAVAILABLE - If the IRP has data segments, the
+      driver does not support these and no Device Layer bounce buffer is
+      free.
     * USB_ERROR_ENDPOINT_NOT_CONFIGURED - If the endpoint is not enabled.
     * USB_ERROR_DEVICE_ENDPOINT_INVALID - The specified endpoint is not valid.
     * USB_ERROR_OSAL_FUNCTION - An OSAL call in the function did not complete
@@ -309,6 +420,119 @@ USB_ERROR USB_DEVICE_IRPSubmit
     USB_DEVICE_IRP * irp
 );
 
+// *****************************************************************************
+/* Function:
+    bool USB_DEVICE_IRPDataSegmentsIsSupported
+    (
+        USB_DEVICE_HANDLE usbDeviceHandle
+    );
+    
+  Summary:
+    This function returns true if the driver supports IRPs with data segments.
+	
+  Description:
+    This function returns true if the USB controller driver of the device
+    layer supports IRPs that are submitted with the
+    USB_DEVICE_IRP_FLAG_DATA_SEGMENTS flag. Such an IRP lets the driver copy
+    the data from or to several application buffers without the client first
+    copying these to one buffer. A function driver can use this function to
+    decide between submitting segments and a single buffer. If this function
+    returns false, IRPs with data segments are only accepted when the Device
+    Layer bounce buffers are enabled with USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER.
+    The Device Layer then copies the data, which the driver support avoids.
+		
+  Precondition:
+    The Device Layer handle should be valid.
+	
+  Parameters:
+    usbDeviceHandle - Pointer to the device layer handle that is returned from 
+                      USB_DEVICE_Open() function.
+	
+  Returns:
+    * true - The driver supports data segments.
+    * false - The driver does not support data segments or the handle is not
+      valid.
+	
+  Example:
+    <code>
+    // The following code sends a header and a payload in one IRP if the
+    // driver supports data segments.
+    
+    USB_IRP_DATA_SEGMENT segments[2];
+    
+    if(USB_DEVICE_IRPDataSegmentsIsSupported(handle))
+    {
+        segments[0].data = myHeader;
+        segments[0].size = sizeof(myHeader);
+        segments[1].data = myPayload;
+        segments[1].size = myPayloadSize;
+    
+        irp.data = segments;
+        irp.size = sizeof(myHeader) + myPayloadSize;
+        irp.flags = USB_DEVICE_IRP_FLAG_DATA_COMPLETE | USB_DEVICE_IRP_FLAG_DATA_SEGMENTS;
+        irp.callback = MyIRPCompletionCallback;
+    
+        USB_DEVICE_IRPSubmit(handle, ep, &irp);
+    }
+    </code>
+	
+  Remarks:
+    None.
+*/
+
+bool USB_DEVICE_IRPDataSegmentsIsSupported
+(
+    USB_DEVICE_HANDLE usbDeviceHandle
+);
+
+// *****************************************************************************
+/* Function:
+    uint16_t USB_DEVICE_SOFNumberGet
+    (
+        USB_DEVICE_HANDLE usbDeviceHandle
+    );
+    
+  Summary:
+    This function returns the current SOF frame number.
+	
+  Description:
+    This function returns the frame number of the last SOF received by the
+    USB controller driver of the device layer. The frame number is the 11 bit
+    frame counter of the bus. It counts 1 millisecond frames at full speed and
+    at high speed. A function driver can use it to measure time in frames, for
+    example to compute the value of an isochronous feedback endpoint.
+		
+  Precondition:
+    The Device Layer handle should be valid.
+	
+  Parameters:
+    usbDeviceHandle - Pointer to the device layer handle that is returned from 
+                      USB_DEVICE_Open() function.
+	
+  Returns:
+    The current frame number. 0 if the handle is not valid.
+	
+  Example:
+    <code>
+    // The following code measures the number of frames since the last call.
+    
+    uint16_t frameNumber;
+    uint16_t frames;
+    
+    frameNumber = USB_DEVICE_SOFNumberGet(handle);
+    frames = (frameNumber - lastFrameNumber) & 0x7FF;
+    lastFrameNumber = frameNumber;
+    </code>
+	
+  Remarks:
+    This function can be called from the IRP callback.
+*/
+
+uint16_t USB_DEVICE_SOFNumberGet
+(
+    USB_DEVICE_HANDLE usbDeviceHandle
+);
+
 // **************************************************************************
 /* Function:
     USB_ERROR USB_DEVICE_IRPCancelAll 
@@ -58,9 +58,17 @@
 /**************************************
  * Allocate a global pool of IRPs
  **************************************/
+#if !defined(USB_DEVICE_IRP_POOL_SIZE)
 USB_DEVICE_IRP gUSBDeviceHIDIRP[USB_DEVICE_HID_QUEUE_DEPTH_COMBINED];
 
-/* Create a variable for holding HID IRP mutex Handle and status */
+/* Free index stack for the HID IRPs */
+uint16_t gUSBDeviceHIDIRPFreeStack[USB_DEVICE_HID_QUEUE_DEPTH_COMBINED];
+
+/* Free flags of the HID IRPs */
+bool gUSBDeviceHIDIRPIsFree[USB_DEVICE_HID_QUEUE_DEPTH_COMBINED];
+#endif
+
+/* Create a variable for holding HID IRP pool */
 USB_DEVICE_HID_COMMON_DATA_OBJ gUSBDeviceHidCommonDataObj;
 // *****************************************************************************
 /* HID Device function driver function structure
@@ -122,23 +130,19 @@ USB_DEVICE_HID_INSTANCE gUsbDeviceHidInstance[USB_DEVICE_HID_INSTANCES_NUMBER];
 */
 void _USB_DEVICE_HID_GlobalInitialize (void)
 {
-    OSAL_RESULT osal_err;
-    
-    /* Create Mutex for CDC IRP objects if not created already */
-    if (gUSBDeviceHidCommonDataObj.isMutexHidIrpInitialized == false)
+#if !defined(USB_DEVICE_IRP_POOL_SIZE)
+    /* Initialize the HID IRP pool if not initialized already */
+    if (gUSBDeviceHidCommonDataObj.isIrpPoolInitialized == false)
     {
-        /* This means that mutexes where not created. Create them. */
-        osal_err = OSAL_MUTEX_Create(&gUSBDeviceHidCommonDataObj.mutexHIDIRP);
-
-        if(osal_err != OSAL_RESULT_TRUE)
-        {
-            /*do not proceed lock was not created, let user know about error*/
-            return;
-        }
+        _USB_DEVICE_IRPPoolInitialize(&gUSBDeviceHidCommonDataObj.irpPool,
+                gUSBDeviceHIDIRP, gUSBDeviceHIDIRPFreeStack,
+                gUSBDeviceHIDIRPIsFree,
+                USB_DEVICE_HID_QUEUE_DEPTH_COMBINED, 0);
 
-         /* Set this flag so that global mutexes get allocated only once */
-         gUSBDeviceHidCommonDataObj.isMutexHidIrpInitialized = true;
+         /* Set this flag so that the pool gets initialized only once */
+         gUSBDeviceHidCommonDataObj.isIrpPoolInitialized = true;
     }
+#endif
 }
 // ******************************************************************************
 /* Function:
@@ -243,6 +247,14 @@ void _USB_DEVICE_HID_InitializeByDescriptorType
             hidInstance->hidFuncInit = funcDriverInit;
             hidInstance->hidDescriptor = pDescriptor +9 ;
 
+            /* Get the pool from which the IRPs of this instance are
+             * allocated */
+#if defined(USB_DEVICE_IRP_POOL_SIZE)
+            hidInstance->irpPool = _USB_DEVICE_IRPPoolGet(usbDeviceHandle);
+#else
+            hidInstance->irpPool = &gUSBDeviceHidCommonDataObj.irpPool;
+#endif
+
             break;
 
         default:
@@ -274,39 +286,41 @@ void _USB_DEVICE_HID_ReportSendCallBack(USB_DEVICE_IRP * irpTx)
     USB_DEVICE_HID_EVENT_DATA_REPORT_SENT reportSentData;
     USB_DEVICE_HID_INSTANCE * thisHIDInstance = &gUsbDeviceHidInstance[iHID];
 
-    /* Update the current transmit queue size */
-    thisHIDInstance->currentTxQueueSize --;
+    reportSentData.length = irpTx->size;
+    reportSentData.handle = ( USB_DEVICE_HID_TRANSFER_HANDLE )irpTx;
 
-    /* Check if a event handler callback is registered and
-     * send the event*/
-    if(thisHIDInstance->appCallBack != NULL)
+    /* Get transfer status */
+    if ((irpTx->status == USB_DEVICE_IRP_STATUS_COMPLETED) 
+        || (irpTx->status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
     {
-        reportSentData.length = irpTx->size;
-        reportSentData.handle = ( USB_DEVICE_HID_TRANSFER_HANDLE )irpTx;
-        
-        /* Get transfer status */
-        if ((irpTx->status == USB_DEVICE_IRP_STATUS_COMPLETED) 
-            || (irpTx->status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
-        {
-            /* Transfer completed successfully */
-            reportSentData.status = USB_DEVICE_HID_RESULT_OK; 
-        }
-        else if (irpTx->status == USB_DEVICE_IRP_STATUS_ABORTED_ENDPOINT_HALT)
-        {
-            /* Transfer cancelled due to Endpoint Halt */
-            reportSentData.status = USB_DEVICE_HID_RESULT_ERROR_ENDPOINT_HALTED; 
-        }
-        else if (irpTx->status == USB_DEVICE_IRP_STATUS_TERMINATED_BY_HOST)
-        {
-            /* Transfer Cancelled by Host (Host sent a Clear feature )*/
-            reportSentData.status = USB_DEVICE_HID_RESULT_ERROR_TERMINATED_BY_HOST; 
-        }
-        else
-        {
-            /* Transfer was not completed successfully */
-            reportSentData.status = USB_DEVICE_HID_RESULT_ERROR; 
-        }
+        /* Transfer completed successfully */
+        reportSentData.status = USB_DEVICE_HID_RESULT_OK; 
+    }
+    else if (irpTx->status == USB_DEVICE_IRP_STATUS_ABORTED_ENDPOINT_HALT)
+    {
+        /* Transfer cancelled due to Endpoint Halt */
+        reportSentData.status = USB_DEVICE_HID_RESULT_ERROR_ENDPOINT_HALTED; 
+    }
+    else if (irpTx->status == USB_DEVICE_IRP_STATUS_TERMINATED_BY_HOST)
+    {
+        /* Transfer Cancelled by Host (Host sent a Clear feature )*/
+        reportSentData.status = USB_DEVICE_HID_RESULT_ERROR_TERMINATED_BY_HOST; 
+    }
+    else
+    {
+        /* Transfer was not completed successfully */
+        reportSentData.status = USB_DEVICE_HID_RESULT_ERROR; 
+    }
+
+    /* Return the IRP to the pool and update the queue size. This is done
+     * before the event is sent so that the application can submit the next
+     * transfer from the event handler. */
+    _USB_DEVICE_IRPPoolRelease(thisHIDInstance->irpPool, irpTx, &thisHIDInstance->currentTxQueueSize);
 
+    /* Check if an application event handler callback is
+     * avaialable and then send the event to the application. */
+    if(thisHIDInstance->appCallBack != NULL)
+    {
         thisHIDInstance->appCallBack
         (
             iHID,
@@ -347,12 +361,9 @@ USB_DEVICE_HID_RESULT USB_DEVICE_HID_ReportSend
     size_t size
 )
 {
-    size_t count;
     USB_DEVICE_IRP * irp = NULL;
     USB_DEVICE_HID_INSTANCE * thisHIDInstance;
     USB_ERROR hidSendError;
-    OSAL_RESULT osalError;
-	OSAL_CRITSECT_DATA_TYPE status;
     
     /* Set the transfer handle to invalid */
     *transferHandle = USB_DEVICE_HID_TRANSFER_HANDLE_INVALID;
@@ -374,77 +385,39 @@ USB_DEVICE_HID_RESULT USB_DEVICE_HID_ReportSend
         return USB_DEVICE_HID_RESULT_ERROR_INSTANCE_NOT_CONFIGURED;
     }
 
-    /* Check if the Transmit queue is full */
-    if(thisHIDInstance->currentTxQueueSize >= 
-            thisHIDInstance->hidFuncInit->queueSizeReportSend)
+    /* Get a free IRP. This fails if the transmit queue of this instance is
+     * full. */
+    irp = _USB_DEVICE_IRPPoolAllocate(thisHIDInstance->irpPool,
+            &thisHIDInstance->currentTxQueueSize,
+            thisHIDInstance->hidFuncInit->queueSizeReportSend);
+    if(irp == NULL)
     {
         SYS_ASSERT(false,"Transmit Queue is full");
         return USB_DEVICE_HID_RESULT_ERROR_TRANSFER_QUEUE_FULL;
     }
 
-    /*Obtain mutex to get access to a shared resource, check return value*/
-    osalError = OSAL_MUTEX_Lock(&gUSBDeviceHidCommonDataObj.mutexHIDIRP, OSAL_WAIT_FOREVER);
-    if(osalError != OSAL_RESULT_TRUE)
+    /* Populate the IRP */
+    irp->size = size;
+    irp->data = buffer;
+    irp->callback = &_USB_DEVICE_HID_ReportSendCallBack;
+    irp->userData = iHID;
+    (*transferHandle) = ( USB_DEVICE_HID_TRANSFER_HANDLE )irp;
+
+    /* Submit the IRP and return */
+    hidSendError = USB_DEVICE_IRPSubmit( thisHIDInstance->devLayerHandle,
+                         thisHIDInstance->endpointTx,
+                         irp);
+
+    /* If IRP Submit function returned any error, then invalidate the
+      Transfer handle and return the IRP to the pool. */
+    if (hidSendError != USB_ERROR_NONE )
     {
-      /*Do not proceed lock was not obtained, or error occurred, let user know about error*/
-      return (USB_DEVICE_HID_RESULT_ERROR);
+        _USB_DEVICE_IRPPoolRelease(thisHIDInstance->irpPool, irp,
+                &thisHIDInstance->currentTxQueueSize);
+        *transferHandle = USB_DEVICE_HID_TRANSFER_HANDLE_INVALID;
     }
 
-    // Check which IRP is free
-    for(count = 0; count < USB_DEVICE_HID_QUEUE_DEPTH_COMBINED; count++)
-    {
-         if(gUSBDeviceHIDIRP[count].status
-                 <= USB_DEVICE_IRP_STATUS_COMPLETED_SHORT)
-         {
-             /* This means we have free IRP. Populate
-              * the IRP */
-        
-             irp =&gUSBDeviceHIDIRP[count];
-             irp->size = size;
-             irp->data = buffer;
-             irp->callback = &_USB_DEVICE_HID_ReportSendCallBack;
-             irp->userData = iHID;
-             (*transferHandle) = ( USB_DEVICE_HID_TRANSFER_HANDLE )irp;
-			 status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-             thisHIDInstance->currentTxQueueSize ++;
-			 OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, status);
-
-             /* Submit the IRP and return */
-             hidSendError = USB_DEVICE_IRPSubmit( thisHIDInstance->devLayerHandle,
-                                  thisHIDInstance->endpointTx,
-                                  irp);
-
-             /* If IRP Submit function returned any error, then invalidate the
-               Transfer handle.  */
-            if (hidSendError != USB_ERROR_NONE )
-            {
-				status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-                thisHIDInstance->currentTxQueueSize --;
-				OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, status);
-                *transferHandle = USB_DEVICE_HID_TRANSFER_HANDLE_INVALID;
-            }
-
-             /*Release mutex, done with shared resource*/
-            osalError = OSAL_MUTEX_Unlock(&gUSBDeviceHidCommonDataObj.mutexHIDIRP);
-            if(osalError != OSAL_RESULT_TRUE)
-            {
-                /*Do not proceed, unlock was not complete, or error occurred, let user know about error*/
-                return (USB_DEVICE_HID_RESULT_ERROR);
-            }
-            return (USB_DEVICE_HID_RESULT)hidSendError;
-
-         }
-    }
-    /*Release mutex, done with shared resource*/
-    osalError = OSAL_MUTEX_Unlock(&gUSBDeviceHidCommonDataObj.mutexHIDIRP);
-    if(osalError != OSAL_RESULT_TRUE)
-    {
-	/*Do not proceed, unlock was not complete, or error occurred, let user know about error*/
-	return (USB_DEVICE_HID_RESULT_ERROR);
-    }
-    /* We could not find a free IRP */
-    SYS_ASSERT(false,"Transmit Queue is full");
-    return USB_DEVICE_HID_RESULT_ERROR_TRANSFER_QUEUE_FULL;
+    return (USB_DEVICE_HID_RESULT)hidSendError;
 }
 
 // ******************************************************************************
@@ -472,7 +445,6 @@ USB_DEVICE_HID_RESULT USB_DEVICE_HID_TransferCancel
 )
 {
     /* Start of local variables */
-    size_t count = 0;
     USB_DEVICE_HID_RESULT returnValue = USB_DEVICE_HID_RESULT_ERROR;
     USB_DEVICE_HID_INSTANCE * hidInstance = NULL;
     USB_ERROR irpCancelResult = USB_ERROR_NONE;
@@ -488,26 +460,21 @@ USB_DEVICE_HID_RESULT USB_DEVICE_HID_TransferCancel
     {
         hidInstance = &gUsbDeviceHidInstance[iHID];
         
-        for(count = 0; count < USB_DEVICE_HID_QUEUE_DEPTH_COMBINED; count++)
+        if((hidInstance->irpPool != NULL) &&
+                (_USB_DEVICE_IRPPoolContains(hidInstance->irpPool, (USB_DEVICE_IRP *)transferHandle)))
         {
-            if((transferHandle) ==
-                    (USB_DEVICE_HID_TRANSFER_HANDLE)&gUSBDeviceHIDIRP[count])
-            {
-                /* Found the transfer to cancel */
-                returnValue = USB_DEVICE_HID_RESULT_OK;
+            /* Found the transfer to cancel */
+            returnValue = USB_DEVICE_HID_RESULT_OK;
 
-                irpCancelResult = USB_DEVICE_IRPCancel(hidInstance->devLayerHandle,
-                        (USB_DEVICE_IRP *)&gUSBDeviceHIDIRP[count]);
+            irpCancelResult = USB_DEVICE_IRPCancel(hidInstance->devLayerHandle,
+                    (USB_DEVICE_IRP *)transferHandle);
 
-                if (irpCancelResult != USB_ERROR_NONE )
-                {
-                    returnValue = USB_DEVICE_HID_RESULT_ERROR;
-                }
-                break;
+            if (irpCancelResult != USB_ERROR_NONE )
+            {
+                returnValue = USB_DEVICE_HID_RESULT_ERROR;
             }
         }
-
-        if(count == USB_DEVICE_HID_QUEUE_DEPTH_COMBINED)
+        else
         {
             /* HID function driver does not own this Transfer Handle.
              * The input parameter was invalid */
@@ -546,40 +513,42 @@ void _USB_DEVICE_HID_ReportReceiveCallBack(USB_DEVICE_IRP * irpRx)
     USB_DEVICE_HID_INSTANCE * thisHIDInstance = &gUsbDeviceHidInstance[iHID];
     USB_DEVICE_HID_EVENT_DATA_REPORT_RECEIVED reportReceivedData;
 
-    /* Update the receive queue size */
-    thisHIDInstance->currentRxQueueSize --;
+    reportReceivedData.length = irpRx->size;
+    reportReceivedData.handle =
+            (USB_DEVICE_HID_TRANSFER_HANDLE)irpRx;
+
+    /* Get transfer status */
+    if ((irpRx->status == USB_DEVICE_IRP_STATUS_COMPLETED) 
+        || (irpRx->status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
+    {
+        /* Transfer completed successfully */
+        reportReceivedData.status = USB_DEVICE_HID_RESULT_OK; 
+    }
+    else if (irpRx->status == USB_DEVICE_IRP_STATUS_ABORTED_ENDPOINT_HALT)
+    {
+        /* Transfer cancelled due to Endpoint Halt */
+        reportReceivedData.status = USB_DEVICE_HID_RESULT_ERROR_ENDPOINT_HALTED; 
+    }
+    else if (irpRx->status == USB_DEVICE_IRP_STATUS_TERMINATED_BY_HOST)
+    {
+        /* Transfer Cancelled by Host (Host sent a Clear feature )*/
+        reportReceivedData.status = USB_DEVICE_HID_RESULT_ERROR_TERMINATED_BY_HOST; 
+    }
+    else
+    {
+        /* Transfer was not completed successfully */
+        reportReceivedData.status = USB_DEVICE_HID_RESULT_ERROR; 
+    }
+
+    /* Return the IRP to the pool and update the queue size. This is done
+     * before the event is sent so that the application can submit the next
+     * transfer from the event handler. */
+    _USB_DEVICE_IRPPoolRelease(thisHIDInstance->irpPool, irpRx, &thisHIDInstance->currentRxQueueSize);
 
     /* Check if an application event handler callback is
      * avaialable and then send the event to the application. */
-    if(thisHIDInstance->appCallBack)
+    if(thisHIDInstance->appCallBack != NULL)
     {
-        reportReceivedData.length = irpRx->size;
-        reportReceivedData.handle =
-                (USB_DEVICE_HID_TRANSFER_HANDLE)irpRx;
-                
-        /* Get transfer status */
-        if ((irpRx->status == USB_DEVICE_IRP_STATUS_COMPLETED) 
-            || (irpRx->status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
-        {
-            /* Transfer completed successfully */
-            reportReceivedData.status = USB_DEVICE_HID_RESULT_OK; 
-        }
-        else if (irpRx->status == USB_DEVICE_IRP_STATUS_ABORTED_ENDPOINT_HALT)
-        {
-            /* Transfer cancelled due to Endpoint Halt */
-            reportReceivedData.status = USB_DEVICE_HID_RESULT_ERROR_ENDPOINT_HALTED; 
-        }
-        else if (irpRx->status == USB_DEVICE_IRP_STATUS_TERMINATED_BY_HOST)
-        {
-            /* Transfer Cancelled by Host (Host sent a Clear feature )*/
-            reportReceivedData.status = USB_DEVICE_HID_RESULT_ERROR_TERMINATED_BY_HOST; 
-        }
-        else
-        {
-            /* Transfer was not completed successfully */
-            reportReceivedData.status = USB_DEVICE_HID_RESULT_ERROR; 
-        }
-
         thisHIDInstance->appCallBack
         (
             iHID,
@@ -620,13 +589,9 @@ USB_DEVICE_HID_RESULT USB_DEVICE_HID_ReportReceive
     size_t size
 )
 {
-
-    size_t count = 0;
     USB_DEVICE_IRP * irp;
     USB_DEVICE_HID_INSTANCE * thisHIDInstance;
     USB_ERROR hidReceiveError;
-    OSAL_RESULT osalError; 
-	OSAL_CRITSECT_DATA_TYPE status;
 
     /* Set the transfer handle to invalid */
     *transferHandle = USB_DEVICE_HID_TRANSFER_HANDLE_INVALID;
@@ -648,74 +613,37 @@ USB_DEVICE_HID_RESULT USB_DEVICE_HID_ReportReceive
         return USB_DEVICE_HID_RESULT_ERROR_INSTANCE_NOT_CONFIGURED;
     }
 
-    /* Check if the Receive queue is full */
-    if(thisHIDInstance->currentRxQueueSize >=
-            thisHIDInstance->hidFuncInit->queueSizeReportReceive)
+    /* Get a free IRP. This fails if the receive queue of this instance is
+     * full. */
+    irp = _USB_DEVICE_IRPPoolAllocate(thisHIDInstance->irpPool,
+            &thisHIDInstance->currentRxQueueSize,
+            thisHIDInstance->hidFuncInit->queueSizeReportReceive);
+    if(irp == NULL)
     {
         SYS_ASSERT(false,"Receive Queue is full");
         return USB_DEVICE_HID_RESULT_ERROR_TRANSFER_QUEUE_FULL;
     }
 
-    /*Obtain mutex to get access to a shared resource, check return value*/
-    osalError = OSAL_MUTEX_Lock(&gUSBDeviceHidCommonDataObj.mutexHIDIRP, OSAL_WAIT_FOREVER);
-    if(osalError != OSAL_RESULT_TRUE)
-    {
-      /*Do not proceed lock was not obtained, or error occurred, let user know about error*/
-      return (USB_DEVICE_HID_RESULT_ERROR);
-    }
+    /* Populate the IRP and then submit it */
+    irp->size = size;
+    irp->callback = &_USB_DEVICE_HID_ReportReceiveCallBack;
+    irp->data = buffer;
+    irp->userData = iHID;
+    (* transferHandle) = ( USB_DEVICE_HID_TRANSFER_HANDLE )irp;
+    hidReceiveError = USB_DEVICE_IRPSubmit( thisHIDInstance->devLayerHandle,
+                                  thisHIDInstance->endpointRx,
+                                  irp);
 
-    /* Search for a free IRP*/
-    for(count = 0; count < USB_DEVICE_HID_QUEUE_DEPTH_COMBINED; count++)
+    /* If IRP Submit function returned any error, then invalidate the
+      Transfer handle and return the IRP to the pool. */
+    if (hidReceiveError != USB_ERROR_NONE )
     {
-         if( gUSBDeviceHIDIRP[count].status <=
-                 USB_DEVICE_IRP_STATUS_COMPLETED_SHORT)
-         {
-             /* We have found a free IRP. Populate the IRP
-              * and then submit it*/
-             irp = &gUSBDeviceHIDIRP[count];
-             irp->size = size;
-             irp->callback = &_USB_DEVICE_HID_ReportReceiveCallBack;
-             irp->data = buffer;
-             irp->userData = iHID;
-			 status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-             thisHIDInstance->currentRxQueueSize ++;
-			 OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, status);
-             (* transferHandle) = ( USB_DEVICE_HID_TRANSFER_HANDLE )irp;
-             hidReceiveError = USB_DEVICE_IRPSubmit( thisHIDInstance->devLayerHandle,
-                                           thisHIDInstance->endpointRx,
-                                           irp);
-
-             /* If IRP Submit function returned any error, then invalidate the
-               Transfer handle.  */
-            if (hidReceiveError != USB_ERROR_NONE )
-            {
-				status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-                thisHIDInstance->currentRxQueueSize --;
-				OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, status);
-                *transferHandle = USB_DEVICE_HID_TRANSFER_HANDLE_INVALID;
-            }
-
-            /*Release mutex, done with shared resource*/
-            osalError = OSAL_MUTEX_Unlock(&gUSBDeviceHidCommonDataObj.mutexHIDIRP);
-            if(osalError != OSAL_RESULT_TRUE)
-            {
-                /*Do not proceed, unlock was not complete, or error occurred, let user know about error*/
-                return (USB_DEVICE_HID_RESULT_ERROR);
-            }
-             return (USB_DEVICE_HID_RESULT)hidReceiveError;
-         }
+        _USB_DEVICE_IRPPoolRelease(thisHIDInstance->irpPool, irp,
+                &thisHIDInstance->currentRxQueueSize);
+        *transferHandle = USB_DEVICE_HID_TRANSFER_HANDLE_INVALID;
     }
 
-    /*Release mutex, done with shared resource*/
-    osalError = OSAL_MUTEX_Unlock(&gUSBDeviceHidCommonDataObj.mutexHIDIRP);
-    if(osalError != OSAL_RESULT_TRUE)
-    {
-	/*Do not proceed, unlock was not complete, or error occurred, let user know about error*/
-	return (USB_DEVICE_HID_RESULT_ERROR);
-    }
-    /* We could not find a free IRP */
-    SYS_ASSERT(false,"Receive Queue is full");
-    return USB_DEVICE_HID_RESULT_ERROR_TRANSFER_QUEUE_FULL;
+    return (USB_DEVICE_HID_RESULT)hidReceiveError;
 }
 
 
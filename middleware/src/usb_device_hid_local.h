@@ -47,6 +47,7 @@
 // Section: Included Files
 // *****************************************************************************
 // *****************************************************************************
+#include "usb/src/usb_device_function_driver.h"
 #include "osal/osal.h"
 
 
@@ -107,9 +108,10 @@ typedef struct
     uint16_t endpointTxSize;
     USB_ENDPOINT endpointRx;
     uint16_t endpointRxSize;
-    size_t currentTxQueueSize;
-    size_t currentRxQueueSize;
+    volatile unsigned int currentTxQueueSize;
+    volatile unsigned int currentRxQueueSize;
     uint8_t *hidDescriptor;
+    USB_DEVICE_IRP_POOL * irpPool;
 
 } USB_DEVICE_HID_INSTANCE;
 
@@ -131,10 +133,12 @@ typedef struct
 {
     /* Set to true if all members of this structure
        have been initialized once */
-    bool isMutexHidIrpInitialized;
+    bool isIrpPoolInitialized;
 
-    /* Mutex to protect client object pool */
-    OSAL_MUTEX_DECLARE(mutexHIDIRP);
+#if !defined(USB_DEVICE_IRP_POOL_SIZE)
+    /* Pool of IRPs shared by all HID instances */
+    USB_DEVICE_IRP_POOL irpPool;
+#endif
 
 } USB_DEVICE_HID_COMMON_DATA_OBJ;
 // *****************************************************************************
@@ -52,6 +52,7 @@
 
 
 #include "usb/usb_device.h"
+#include "usb/src/usb_device_function_driver.h"
 #include "osal/osal.h"
 
 // *****************************************************************************
@@ -218,8 +219,132 @@ typedef struct
        all vendor Endpoints  */
     uint16_t qSizeCurrentEpWrite;
 
+    /* Index of the first entry of gUSBDeviceEndpointIRP that is owned by this
+       instance. The same range of the free IRP index stack is used by this
+       instance. */
+    uint16_t irpPartitionStart;
+
+    /* Number of IRPs owned by this instance. This is zero until the
+       partition has been assigned. */
+    uint16_t irpPartitionSize;
+
+    /* Number of IRP indexes currently on the free stack of this instance */
+    uint16_t irpFreeCount;
+
 } USB_DEVICE_Q_SIZE_ENDPOINT;
 
+#if defined(USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER)
+
+/* Default size of the table that tracks the IRPs for the endpoint statistics */
+#if !defined(USB_DEVICE_STATISTICS_IRPS_NUMBER)
+#define USB_DEVICE_STATISTICS_IRPS_NUMBER 16
+#endif
+
+/* The statistics time stamp is the SOF frame number unless the application
+ * provides a time stamp function. The mask limits the difference of two time
+ * stamps to the range of the time stamp. */
+#if defined(USB_DEVICE_STATISTICS_TIMESTAMP_GET)
+#define _USB_DEVICE_StatisticsTimeStampGet(obj)  ((uint32_t)USB_DEVICE_STATISTICS_TIMESTAMP_GET())
+#define _USB_DEVICE_STATISTICS_TIMESTAMP_MASK    0xFFFFFFFFu
+#else
+#define _USB_DEVICE_StatisticsTimeStampGet(obj)  ((uint32_t)(obj)->driverInterface->deviceSOFNumberGet((obj)->usbCDHandle))
+#define _USB_DEVICE_STATISTICS_TIMESTAMP_MASK    0x7FFu
+#endif
+
+// *****************************************************************************
+/* USB Device Layer Statistics IRP Entry
+
+  Summary:
+    Tracks one IRP that is pending on an endpoint.
+
+  Description:
+    The Device Layer replaces the callback of a submitted IRP with its own
+    callback and stores the original callback here. The original callback is
+    restored and called when the IRP completes. The layerData member of the
+    IRP points to the entry while the IRP is pending, so that the callback
+    does not have to search for it.
+
+  Remarks:
+    None.
+*/
+
+typedef struct
+{
+    /* The IRP that is tracked. NULL if the entry is free. */
+    USB_DEVICE_IRP * irp;
+
+    /* The callback that the client set in the IRP */
+    void (*callback)(USB_DEVICE_IRP * irp);
+
+    /* Time stamp at which the IRP was submitted */
+    uint32_t timeStamp;
+
+    /* The layerData that the IRP had when it was submitted */
+    void * layerData;
+
+    /* Index of the Device Layer instance that owns the entry */
+    unsigned int instanceIndex;
+
+    /* Endpoint and direction on which the IRP was submitted */
+    USB_ENDPOINT endpoint;
+
+} USB_DEVICE_STATISTICS_IRP_ENTRY;
+
+#endif
+
+#if defined(USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER)
+
+/* Default size of the bounce buffers for IRPs with data segments */
+#if !defined(USB_DEVICE_IRP_BOUNCE_BUFFER_SIZE)
+#define USB_DEVICE_IRP_BOUNCE_BUFFER_SIZE 512
+#endif
+
+// *****************************************************************************
+/* USB Device Layer IRP Bounce Buffer Entry
+
+  Summary:
+    Holds the data of an IRP with data segments while the IRP is pending.
+
+  Description:
+    If the USB controller driver does not support data segments, the Device
+    Layer copies the data of an IRP that was submitted with the
+    USB_DEVICE_IRP_FLAG_DATA_SEGMENTS flag to or from a bounce buffer. The
+    IRP is submitted to the driver with the bounce buffer as its data. The
+    client members of the IRP that the Device Layer replaces are stored here
+    and restored when the IRP completes. The layerData member of the IRP
+    points to the entry while the IRP is pending.
+
+  Remarks:
+    None.
+*/
+
+typedef struct
+{
+    /* The IRP that uses the bounce buffer. NULL if the entry is free. */
+    USB_DEVICE_IRP * irp;
+
+    /* The callback that the client set in the IRP */
+    void (*callback)(USB_DEVICE_IRP * irp);
+
+    /* The segment array that the client set in the IRP */
+    USB_IRP_DATA_SEGMENT * segments;
+
+    /* The flags that the client set in the IRP */
+    USB_DEVICE_IRP_FLAG flags;
+
+    /* The layerData that the IRP had when it was submitted */
+    void * layerData;
+
+    /* Endpoint and direction on which the IRP was submitted */
+    USB_ENDPOINT endpoint;
+
+    /* The bounce buffer */
+    uint8_t buffer[USB_DEVICE_IRP_BOUNCE_BUFFER_SIZE];
+
+} USB_DEVICE_IRP_BOUNCE_ENTRY;
+
+#endif
+
 // *****************************************************************************
 /* USB Device Layer Instance Structure
 
@@ -313,13 +438,6 @@ typedef struct
 	
     /* This points to the size of the current control transfer */
     uint16_t controlTransferDataStageSize;
-    
-    /* Set to true if all members of this structure
-       have been initialized once */
-    bool isMutexEndpointIrpInitialized;
-
-    /* Mutex to protect Endpoint IRP array */
-    OSAL_MUTEX_DECLARE(mutexEndpointIRP);
 
     /* A pointer to the driver interface */
     DRV_USB_DEVICE_INTERFACE * driverInterface;
@@ -333,6 +451,39 @@ typedef struct
     /* Tx IRP for handling Other Speed request */ 
     _USB_DEVICE_DECLARE_IRP(irpEp0TxOtherSpeedDescriptor);
 
+#if defined(USB_DEVICE_IRP_POOL_SIZE)
+    /* IRPs shared by all function drivers of this instance */
+    USB_DEVICE_IRP functionDriverIRP[USB_DEVICE_IRP_POOL_SIZE];
+
+    /* Free index stack for the function driver IRPs */
+    uint16_t functionDriverIRPFreeStack[USB_DEVICE_IRP_POOL_SIZE];
+
+    /* Free flags of the function driver IRPs */
+    bool functionDriverIRPIsFree[USB_DEVICE_IRP_POOL_SIZE];
+
+    /* Pool object that manages the function driver IRPs */
+    USB_DEVICE_IRP_POOL functionDriverIRPPool;
+#endif
+
+#if defined(USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER)
+    /* Transfer statistics of each endpoint, indexed by endpoint number and
+     * direction */
+    USB_DEVICE_ENDPOINT_STATISTICS endpointStatistics[USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER][2];
+
+    /* IRPs that are pending and tracked for the statistics */
+    USB_DEVICE_STATISTICS_IRP_ENTRY statisticsIRP[USB_DEVICE_STATISTICS_IRPS_NUMBER];
+
+#if defined(USB_DEVICE_STATISTICS_VENDOR_REQUEST)
+    /* Copy of the statistics that is sent in the statistics vendor request */
+    USB_DEVICE_ENDPOINT_STATISTICS statisticsResponse;
+#endif
+#endif
+
+#if defined(USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER)
+    /* Bounce buffers for IRPs with data segments */
+    USB_DEVICE_IRP_BOUNCE_ENTRY irpBounce[USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER];
+#endif
+
 } USB_DEVICE_OBJ;
 
 // *****************************************************************************
@@ -428,9 +579,7 @@ void _USB_DEVICE_Ep0TransmitCompleteCallback(USB_DEVICE_IRP * handle);
 void _USB_DEVICE_EndpointWriteCallBack( USB_DEVICE_IRP * irp );
 void _USB_DEVICE_EndpointReadCallBack( USB_DEVICE_IRP * irp );
 void _USB_DEVICE_RemotewakeupTimerCallback(uintptr_t context, uint32_t currTick);
-void _USB_DEVICE_Initialize_Endpoint_Q_Size(SYS_MODULE_INDEX index, uint16_t qSizeRead, uint16_t qSizeWrite );
-void _USB_DEVICE_EndpointMutexCreateFunction(USB_DEVICE_OBJ* usbDeviceThisInstance);
-void _USB_DEVICE_EndpointMutexDeleteFunction(USB_DEVICE_OBJ* usbDeviceThisInstance);
+bool _USB_DEVICE_Initialize_Endpoint_Q_Size(SYS_MODULE_INDEX index, uint16_t qSizeRead, uint16_t qSizeWrite );
 void _USB_DEVICE_EndpointQueueSizeReset(SYS_MODULE_INDEX index);
 uint16_t _USB_DEVICE_GetStringDescriptorRequestProcess
 (
@@ -453,4 +602,24 @@ void _USB_DEVICE_DeInitializeAllFunctionDrivers
 (
     USB_DEVICE_OBJ * usbDeviceThisInstance
 );
+#if defined(USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER)
+USB_ERROR _USB_DEVICE_IRPBounceSubmit
+(
+    USB_DEVICE_OBJ * usbDeviceThisInstance,
+    USB_DEVICE_HANDLE usbDeviceHandle,
+    USB_ENDPOINT endpointAndDirection,
+    USB_DEVICE_IRP * irp
+);
+void _USB_DEVICE_IRPBounceCallback( USB_DEVICE_IRP * irp );
+#endif
+#if defined(USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER)
+void _USB_DEVICE_StatisticsIRPCallback( USB_DEVICE_IRP * irp );
+#if defined(USB_DEVICE_STATISTICS_VENDOR_REQUEST)
+void _USB_DEVICE_StatisticsRequestProcess
+(
+    USB_DEVICE_OBJ * usbDeviceThisInstance,
+    USB_SETUP_PACKET * setupPkt
+);
+#endif
+#endif
 #endif
@@ -85,15 +85,11 @@
      * functions to be included in the code. */
     #define _USB_DEVICE_Initialize_Endpoint_Q(x,y,z) _USB_DEVICE_Initialize_Endpoint_Q_Size(x,y,z)
     #define _USB_DEVICE_EndpointCurrentQueueSizeReset(x)  _USB_DEVICE_EndpointQueueSizeReset(x)
-    #define _USB_DEVICE_EndpointMutexCreate(x)       _USB_DEVICE_EndpointMutexCreateFunction(x)
-    #define _USB_DEVICE_EndpointMutexDelete(x)       _USB_DEVICE_EndpointMutexDeleteFunction(x)
 #else
     /* If the endpoint functions are not called in the code, then the following
      * function are not needed and map to nothing */
-    #define _USB_DEVICE_Initialize_Endpoint_Q(x,y,z)
-    #define _USB_DEVICE_EndpointMutexCreate(x)
+    #define _USB_DEVICE_Initialize_Endpoint_Q(x,y,z) (true)
     #define _USB_DEVICE_EndpointCurrentQueueSizeReset(x)
-    #define _USB_DEVICE_EndpointMutexDelete(x)
     #define _USB_DEVICE_EndpointDeclareOsalResult(x)
 #endif 
 
@@ -56,6 +56,20 @@ static USB_DEVICE_MSD_INSTANCE gUSBDeviceMSDInstance [USB_DEVICE_INSTANCES_NUMBE
 
 static SCSI_SENSE_DATA gUSBDeviceMSDSenseData[USB_DEVICE_MSD_LUNS_NUMBER] USB_ALIGN;
 
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+/*************************************
+ * USB device MSD write cache blocks.
+ *************************************/
+static uint8_t gUSBDeviceMSDWriteCacheData[USB_DEVICE_MSD_INSTANCES_NUMBER][USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER][USB_DEVICE_MSD_WRITE_CACHE_BLOCK_SIZE] USB_ALIGN;
+#endif
+
+#if defined(USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER)
+/*************************************
+ * USB device MSD read ahead buffers.
+ *************************************/
+static uint8_t gUSBDeviceMSDReadAheadData[USB_DEVICE_MSD_INSTANCES_NUMBER][USB_DEVICE_MSD_LUNS_NUMBER][_DRV_MSD_READ_AHEAD_BUFFER_SIZE] USB_ALIGN;
+#endif
+
 /***************************************
  * USB device MSD init objects.
  ***************************************/
@@ -282,6 +296,12 @@ void _USB_DEVICE_MSD_InitializeByDescriptorType
             /* Device Layer came across an MSD interface. Initialize the
              * interface */
             _USB_DEVICE_MSD_InitializeInterface(msdDeviceObj, usbDeviceHandle, funcDriverInit, (USB_INTERFACE_DESCRIPTOR *)pDescriptor);
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+            _USB_DEVICE_MSD_WriteCacheInitialize(iMSD);
+#endif
+#if defined(USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER)
+            _USB_DEVICE_MSD_ReadAheadInitialize(iMSD);
+#endif
             break;
 
         default:
@@ -583,6 +603,21 @@ void _USB_DEVICE_MSD_Tasks
       
           case USB_DEVICE_MSD_STATE_CBW:
             {
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+                if ((msdObj->writeCacheOperation == USB_DEVICE_MSD_WRITE_CACHE_OPERATION_WRITE_BACK)
+                        || (msdObj->writeCacheIdleCount >= USB_DEVICE_MSD_WRITE_CACHE_IDLE_FLUSH_COUNT))
+                {
+                    /* The host has been idle for a while or a cache block is
+                     * being written back. The cache must be flushed before the
+                     * next command is processed. */
+                    if (!_USB_DEVICE_MSD_WriteCacheFlush(msdObj))
+                    {
+                        break;
+                    }
+
+                    msdObj->writeCacheIdleCount = 0;
+                }
+#endif
                 if (( (msdObj->irpRx.status == USB_DEVICE_IRP_STATUS_COMPLETED) || (msdObj->irpRx.status == USB_DEVICE_IRP_STATUS_COMPLETED_SHORT))
                         && (!USB_DEVICE_EndpointIsStalled(msdObj->hUsbDevHandle, msdObj->bulkEndpointRx)))
                 {
@@ -612,6 +647,13 @@ void _USB_DEVICE_MSD_Tasks
 
                     msdObj->msdMainState = USB_DEVICE_MSD_STATE_WAIT_FOR_CBW;
                 }
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+                else
+                {
+                    /* Still waiting for the CBW */
+                    msdObj->writeCacheIdleCount++;
+                }
+#endif
                 break;
             }
 
@@ -647,6 +689,12 @@ void _USB_DEVICE_MSD_Tasks
             {
                 if (msdObj->irpTx.status <= USB_DEVICE_IRP_STATUS_COMPLETED_SHORT)
                 {
+#if defined(USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER)
+                    /* The data stage has ended. Read the sectors that follow
+                     * a READ (10) command while the CSW is sent and while the
+                     * host accesses the other LUNs. */
+                    _USB_DEVICE_MSD_ReadAheadStart(msdObj);
+#endif
                     _USB_DEVICE_MSD_PostDataStageRoutine(iMSD);
                     msdObj->msdMainState = USB_DEVICE_MSD_STATE_SEND_CSW;
                 }
@@ -672,6 +720,31 @@ void _USB_DEVICE_MSD_Tasks
                 break;
             }
 
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+            case USB_DEVICE_MSD_STATE_FLUSH_CACHE:
+            {
+                /* Write all modified cache blocks back to the media before the
+                 * CSW is sent. */
+                if (_USB_DEVICE_MSD_WriteCacheFlush(msdObj))
+                {
+                    if (msdObj->writeCacheWriteBackError)
+                    {
+                        /* Some blocks could not be written to the media. */
+                        SCSI_SENSE_DATA * senseData = msdObj->mediaDynamicData[msdObj->msdCBW->bCBWLUN].senseData;
+
+                        msdObj->writeCacheWriteBackError = false;
+                        senseData->SenseKey = SCSI_SENSE_MEDIUM_ERROR;
+                        senseData->ASC = SCSI_ASC_WRITE_ERROR;
+                        senseData->ASCQ = SCSI_ASCQ_WRITE_ERROR;
+                        msdObj->msdCSW->bCSWStatus = USB_MSD_CSW_COMMAND_FAILED;
+                    }
+
+                    msdObj->msdMainState = USB_DEVICE_MSD_STATE_CSW;
+                }
+                break;
+            }
+#endif
+
             case USB_DEVICE_MSD_STATE_IDLE:
             default:
                 break;
@@ -708,6 +781,27 @@ void _USB_DEVICE_MSD_BlockEventHandler
 )
 {
     USB_DEVICE_MSD_MEDIA_DYNAMIC_DATA * mediaDynamicData = (USB_DEVICE_MSD_MEDIA_DYNAMIC_DATA *)context;
+
+#if defined(USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER)
+    /* The read ahead is not started while another media operation of this LUN
+     * is in progress. The command handle is still invalid if the media
+     * completes the read ahead before the read function returns. */
+    if ((mediaDynamicData->readAheadState == USB_DEVICE_MSD_MEDIA_OPERATION_PENDING)
+            && ((commandHandle == mediaDynamicData->readAheadHandle)
+                || (mediaDynamicData->readAheadHandle == SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID)))
+    {
+        if (event == SYS_MEDIA_EVENT_BLOCK_COMMAND_COMPLETE)
+        {
+            mediaDynamicData->readAheadState = USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE;
+        }
+        else
+        {
+            mediaDynamicData->readAheadState = USB_DEVICE_MSD_MEDIA_OPERATION_ERROR;
+        }
+        return;
+    }
+#endif
+
     switch(event)
     {
         case SYS_MEDIA_EVENT_BLOCK_COMMAND_COMPLETE:
@@ -865,10 +959,23 @@ USB_DEVICE_MSD_STATE _USB_DEVICE_MSD_VerifyCommand
 
     /* Reset the counters. */
     msdInstance->rxTxTotalDataByteCount = 0;
-    msdInstance->bufferOffset = 0;
-    msdInstance->numPendingIrps = 0;
-    msdInstance->numUsbSectors = 0;
-    msdInstance->numSectorsToWrite = 0;
+    msdInstance->mediaBank = 0;
+    msdInstance->mediaSectors = 0;
+    msdInstance->mediaBlockReadPending = false;
+    msdInstance->usbBank = 0;
+    msdInstance->usbSectors = 0;
+    msdInstance->readyBank = 0;
+    msdInstance->readySectors = 0;
+
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+    /* A cache block read that was interrupted by a reset is not resumed. The
+     * cache block stays invalid. */
+    msdInstance->writeCacheIdleCount = 0;
+    if (msdInstance->writeCacheOperation == USB_DEVICE_MSD_WRITE_CACHE_OPERATION_FILL)
+    {
+        msdInstance->writeCacheOperation = USB_DEVICE_MSD_WRITE_CACHE_OPERATION_NONE;
+    }
+#endif
 
     /* Make sure we have received an integral CBW with the 
      * right size and signature */
@@ -895,6 +1002,14 @@ USB_DEVICE_MSD_STATE _USB_DEVICE_MSD_VerifyCommand
     mediaDynamicData = &msdInstance->mediaDynamicData[logicalUnit];
     mediaFunctions = &msdInstance->mediaData[logicalUnit].mediaFunctions;
 
+#if defined(USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER)
+    if (mediaDynamicData->mediaPresent == false)
+    {
+        /* The media may have been replaced */
+        mediaDynamicData->readAheadSectors = 0;
+    }
+#endif
+
     /* Find the number of bytes to be transferred. */
     length = ((lCBW->CBWCB[7] << 8) | lCBW->CBWCB[8]);
     length <<= 9;
@@ -930,6 +1045,18 @@ USB_DEVICE_MSD_STATE _USB_DEVICE_MSD_VerifyCommand
                 *commandStatus = USB_MSD_CSW_COMMAND_FAILED; 
                 return USB_DEVICE_MSD_STATE_CSW;
             }
+#if defined(USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER)
+            mediaDynamicData->statistics.readCommands++;
+            mediaDynamicData->statistics.sectorsRead += ((lCBW->CBWCB[7] << 8) | lCBW->CBWCB[8]);
+
+            if ((mediaDynamicData->readAheadSectors != 0) && (mediaDynamicData->readAheadAddress != 
+                        (((uint32_t)lCBW->CBWCB[2] << 24) | ((uint32_t)lCBW->CBWCB[3] << 16)
+                         | ((uint32_t)lCBW->CBWCB[4] << 8) | (uint32_t)lCBW->CBWCB[5])))
+            {
+                /* The host is not reading this LUN sequentially */
+                mediaDynamicData->statistics.readAheadMisses++;
+            }
+#endif
             return USB_DEVICE_MSD_STATE_DATA_IN;
         }
         else
@@ -953,6 +1080,21 @@ USB_DEVICE_MSD_STATE _USB_DEVICE_MSD_VerifyCommand
                 return USB_DEVICE_MSD_STATE_CSW;
             }
 
+            /* The sectors are received from the host ahead of the media
+             * write. Start at the first sector of the command. */
+            msdInstance->usbBlockAddress = ((uint32_t)lCBW->CBWCB[2] << 24) | ((uint32_t)lCBW->CBWCB[3] << 16)
+                    | ((uint32_t)lCBW->CBWCB[4] << 8) | (uint32_t)lCBW->CBWCB[5];
+            msdInstance->usbBlockLength = ((lCBW->CBWCB[7] << 8) | lCBW->CBWCB[8]);
+
+#if defined(USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER)
+            mediaDynamicData->statistics.writeCommands++;
+            mediaDynamicData->statistics.sectorsWritten += msdInstance->usbBlockLength;
+
+            /* The sectors that were read ahead may be modified by this
+             * command. */
+            mediaDynamicData->readAheadSectors = 0;
+#endif
+
             return USB_DEVICE_MSD_STATE_DATA_OUT;
         }
     }
@@ -1061,6 +1203,9 @@ USB_DEVICE_MSD_STATE _USB_DEVICE_MSD_ProcessRead
     USB_DEVICE_MSD_DWORD_VAL logicalBlockAddress;
 
     DRV_HANDLE drvHandle;
+#if defined(USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER)
+    USB_DEVICE_MSD_MEDIA_OPERATION readAheadResult;
+#endif
 
     /* Pointer to the CBW */ 
     lCBW = (USB_MSD_CBW *)msdInstance->msdCBW; // Pointer to CBW
@@ -1084,82 +1229,127 @@ USB_DEVICE_MSD_STATE _USB_DEVICE_MSD_ProcessRead
 
     _USB_DEVICE_MSD_GetBlockAddressAndLength(lCBW, &logicalBlockAddress, &logicalBlockLength);
 
-    if (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE)
+#if defined(USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER)
+    if ((msdInstance->rxTxTotalDataByteCount == 0)
+            && (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_IDLE))
     {
-        /* Keep queuing IRPs as long as there is buffered data available with the MSD. */
-        if (msdInstance->numPendingIrps != msdInstance->bufferOffset)
-        {
-            msdInstance->rxTxTotalDataByteCount += mediaDynamicData->sectorSize;
-            msdInstance->irpTx.size = mediaDynamicData->sectorSize;
-            msdInstance->irpTx.data = (void *)&msdBuffer[msdInstance->numPendingIrps * 512];
-            msdInstance->irpTx.flags = USB_DEVICE_IRP_FLAG_DATA_PENDING;
-
-            /* Submit the endpoint */
-            USB_DEVICE_IRPSubmit( msdInstance->hUsbDevHandle, msdInstance->bulkEndpointTx, &msdInstance->irpTx);
-            msdInstance->numPendingIrps ++;
+        /* The first sectors of this command may have been read ahead after
+         * the previous command to this LUN. */
+        readAheadResult = _USB_DEVICE_MSD_ReadAheadRead(msdInstance, logicalUnit, &logicalBlockAddress, &logicalBlockLength);
 
-            /* There is still data to be transferred. Continue to be in the IN state. */
+        if (readAheadResult == USB_DEVICE_MSD_MEDIA_OPERATION_PENDING)
+        {
+            /* Wait for the read ahead to complete */
             return USB_DEVICE_MSD_STATE_DATA_IN;
         }
 
-        /* Reset the counters */
-        msdInstance->numPendingIrps = 0;
-        msdInstance->bufferOffset = 0;
-
-        mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
-        if (logicalBlockLength.Val == 0)
+        if (readAheadResult == USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE)
         {
-            /* End the data stage and move to CSW state */
-            return USB_DEVICE_MSD_STATE_CSW;
+            _USB_DEVICE_MSD_SaveBlockAddressAndLength(lCBW, &logicalBlockAddress, &logicalBlockLength);
+
+            if (logicalBlockLength.Val == 0)
+            {
+                return USB_DEVICE_MSD_STATE_DATA_IN;
+            }
+
+            /* The remaining sectors are read from the media while the read
+             * ahead buffer is sent to the host. */
         }
     }
+#endif
 
-    if (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_IDLE)
+    /* This function is called when the bulk IN endpoint is free. The media
+     * reads sectors into one bank of the sector buffer while the other bank
+     * is being sent to the host. */
+    if (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_ERROR)
     {
-        mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_PENDING;
-
-        /* Find the amount of buffering available with the MSD driver. */
-        if (logicalBlockLength.Val > _DRV_MSD_NUM_SECTORS_BUFFERING)
-        {
-            msdInstance->bufferOffset = _DRV_MSD_NUM_SECTORS_BUFFERING;
-        }
-        else
-        {
-            msdInstance->bufferOffset = logicalBlockLength.Val;
-        }
+        /* Media Read Failed. */
+        *commandStatus = USB_MSD_CSW_COMMAND_FAILED;
+        return USB_DEVICE_MSD_STATE_CSW;
+    }
 
-        /* Find the media read block size */
-        mediaReadBlockSize = mediaDynamicData->mediaGeometry->geometryTable[0].blockSize;
+    if (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_PENDING)
+    {
+        /* Wait for the media to complete the read */
+        return USB_DEVICE_MSD_STATE_DATA_IN;
+    }
 
-        /* Read bufferOffset number of sectors data from the media. */
-        mediaFunctions->blockRead (drvHandle, 
-                        &mediaReadWriteHandle, 
-                        (uint8_t*)&msdBuffer[0],
-                        (logicalBlockAddress.Val * (mediaDynamicData->sectorSize/mediaReadBlockSize)),
-                        msdInstance->bufferOffset * (mediaDynamicData->sectorSize/mediaReadBlockSize));
+    if (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE)
+    {
+        /* The media has filled a bank. Send the whole bank to the host with
+         * one IRP. */
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+        /* Sectors that are modified in the write cache are newer than the
+         * sectors read from the media. */
+        _USB_DEVICE_MSD_WriteCacheReadUpdate(msdInstance, logicalUnit,
+                (logicalBlockAddress.Val - msdInstance->mediaSectors), msdInstance->mediaSectors,
+                &msdBuffer[msdInstance->mediaBank * _DRV_MSD_NUM_SECTORS_PER_BANK * mediaDynamicData->sectorSize]);
+#endif
+        msdInstance->rxTxTotalDataByteCount += (msdInstance->mediaSectors * mediaDynamicData->sectorSize);
+        msdInstance->irpTx.size = msdInstance->mediaSectors * mediaDynamicData->sectorSize;
+        msdInstance->irpTx.data = (void *)&msdBuffer[msdInstance->mediaBank * _DRV_MSD_NUM_SECTORS_PER_BANK * mediaDynamicData->sectorSize];
+        msdInstance->irpTx.flags = USB_DEVICE_IRP_FLAG_DATA_PENDING;
+
+        /* Submit the endpoint */
+        USB_DEVICE_IRPSubmit( msdInstance->hUsbDevHandle, msdInstance->bulkEndpointTx, &msdInstance->irpTx);
+
+        /* The next media read goes to the other bank */
+        msdInstance->mediaBank = (msdInstance->mediaBank + 1) % _DRV_MSD_NUM_SECTOR_BANKS;
+        msdInstance->mediaSectors = 0;
+        mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
 
-        if (mediaReadWriteHandle == SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID)
+        if ((_DRV_MSD_NUM_SECTOR_BANKS == 1) || (logicalBlockLength.Val == 0))
         {
-            /* Media Read Failed. */
-            *commandStatus = USB_MSD_CSW_COMMAND_FAILED;
-            return USB_DEVICE_MSD_STATE_CSW;
+            /* The bank that was just submitted must be sent before it can be
+             * filled again, or there is nothing more to read. */
+            return USB_DEVICE_MSD_STATE_DATA_IN;
         }
+    }
+    else if (logicalBlockLength.Val == 0)
+    {
+        /* All the data has been read and sent. End the data stage and move
+         * to CSW state */
+        return USB_DEVICE_MSD_STATE_CSW;
+    }
 
-        /* Update the amount of data read and the sector address
-         * read. */
-        logicalBlockLength.Val -= msdInstance->bufferOffset;
-        logicalBlockAddress.Val += msdInstance->bufferOffset;
-
-        _USB_DEVICE_MSD_SaveBlockAddressAndLength(lCBW, &logicalBlockAddress, &logicalBlockLength);
+    /* Media operation state is idle. Start reading the next set of sectors. */
+    mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_PENDING;
 
-        msdInstance->numPendingIrps = 0;
+    /* Find the amount of buffering available in a bank. */
+    if (logicalBlockLength.Val > _DRV_MSD_NUM_SECTORS_PER_BANK)
+    {
+        msdInstance->mediaSectors = _DRV_MSD_NUM_SECTORS_PER_BANK;
     }
-    else if (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_ERROR)
+    else
+    {
+        msdInstance->mediaSectors = logicalBlockLength.Val;
+    }
+
+    /* Find the media read block size */
+    mediaReadBlockSize = mediaDynamicData->mediaGeometry->geometryTable[0].blockSize;
+
+    /* Read mediaSectors number of sectors data from the media. */
+    mediaFunctions->blockRead (drvHandle, 
+                    &mediaReadWriteHandle, 
+                    (uint8_t*)&msdBuffer[msdInstance->mediaBank * _DRV_MSD_NUM_SECTORS_PER_BANK * mediaDynamicData->sectorSize],
+                    (logicalBlockAddress.Val * (mediaDynamicData->sectorSize/mediaReadBlockSize)),
+                    msdInstance->mediaSectors * (mediaDynamicData->sectorSize/mediaReadBlockSize));
+
+    if (mediaReadWriteHandle == SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID)
     {
+        /* Media Read Failed. The bank that may have been submitted above is
+         * allowed to complete before the CSW is sent. */
         *commandStatus = USB_MSD_CSW_COMMAND_FAILED;
         return USB_DEVICE_MSD_STATE_CSW;
     }
 
+    /* Update the amount of data read and the sector address
+     * read. */
+    logicalBlockLength.Val -= msdInstance->mediaSectors;
+    logicalBlockAddress.Val += msdInstance->mediaSectors;
+
+    _USB_DEVICE_MSD_SaveBlockAddressAndLength(lCBW, &logicalBlockAddress, &logicalBlockLength);
+
     return USB_DEVICE_MSD_STATE_DATA_IN;
 }
 
@@ -1188,6 +1378,9 @@ USB_DEVICE_MSD_STATE _USB_DEVICE_MSD_ProcessWrite
     USB_DEVICE_MSD_DWORD_VAL logicalBlockAddress;
 
     DRV_HANDLE              drvHandle;
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+    USB_DEVICE_MSD_MEDIA_OPERATION writeCacheResult = USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
+#endif
 
     /* Pointer to the CBW */ 
     lCBW = (USB_MSD_CBW *)msdInstance->msdCBW; // Pointer to CBW
@@ -1234,209 +1427,240 @@ USB_DEVICE_MSD_STATE _USB_DEVICE_MSD_ProcessWrite
 
     memoryBlock = logicalBlockAddress.Val/sectorsPerBlock;
 
-    if (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE)
+    /* This function is called when the bulk OUT endpoint is free. The host
+     * fills one bank of the sector buffer while the media writes the other
+     * bank. The logical block address and length in the CBW track the
+     * sectors written to the media. */
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+    writeCacheResult = _USB_DEVICE_MSD_WriteCacheWriteBackTasks(msdInstance);
+    if (writeCacheResult == USB_DEVICE_MSD_MEDIA_OPERATION_PENDING)
     {
-        if (logicalBlockLength.Val == 0)
-        {
-            /* Done writing all the blocks. Move on to the CSW Stage. */
-            return USB_DEVICE_MSD_STATE_CSW;
-        }
-
-        if (msdInstance->numSectorsToWrite == 0)
-        {
-            /* The amount of data as computed in the previous iteration is transferred.
-               There is still data to be transferred. Compute the next set of data to be transferred.
-             */
-            mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
-        }
+        /* A cache block is being written back to make room for the next
+         * block. Wait for it to complete. */
+        return USB_DEVICE_MSD_STATE_DATA_OUT;
+    }
+    else if (writeCacheResult == USB_DEVICE_MSD_MEDIA_OPERATION_ERROR)
+    {
+        /* The cache block could not be written back. */
+        (*commandStatus) = USB_MSD_CSW_COMMAND_FAILED;
+        return USB_DEVICE_MSD_STATE_CSW;
     }
-    else if (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_ERROR)
+#endif
+
+    if (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_ERROR)
     {
         /* There was an error while writing the data. */
         (*commandStatus) = USB_MSD_CSW_COMMAND_FAILED;
         return USB_DEVICE_MSD_STATE_CSW;
     }
 
-    /* operation state is idle */
-    if (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_IDLE)
+    if (msdInstance->usbSectors != 0)
+    {
+        /* The data stage IRP has completed. The bank is now ready to be
+         * written to the media. */
+        msdInstance->readyBank = msdInstance->usbBank;
+        msdInstance->readySectors = msdInstance->usbSectors;
+        msdInstance->usbSectors = 0;
+    }
+
+    if (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE)
     {
-        /* This is the initial condition. Number of sectors to be written in this block is zero. */
-        if (msdInstance->numSectorsToWrite == 0)
+        if (msdInstance->mediaBlockReadPending)
         {
-            /* Find the number of sectors to be written in this block */
-            if (sectorsPerBlock == 1)
+            /* The block read of a read-modify-write cycle has completed.
+             * Update the sectors in the block and write the block. */
+            uint16_t i = 0;
+            uint16_t sectorOffsetWithinBlock = (logicalBlockAddress.Val - (memoryBlock * sectorsPerBlock)) * mediaDynamicData->sectorSize;
+            uint8_t * data = &msdBuffer[msdInstance->mediaBank * _DRV_MSD_NUM_SECTORS_PER_BANK * mediaDynamicData->sectorSize];
+
+            msdInstance->mediaBlockReadPending = false;
+
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+            if (msdInstance->writeCacheOperation == USB_DEVICE_MSD_WRITE_CACHE_OPERATION_FILL)
             {
-                /* Media sector size and the USB MSD Sector size are the same. */
-                if (logicalBlockLength.Val > _DRV_MSD_NUM_SECTORS_BUFFERING)
-                {
-                    /* The number of blocks to be transferred is more than the buffer size
-                       available at the MSD. Read buffer size worth of data from the USB Host.
-                       Mark this as the number of blocks to be written to the media. */
-                    msdInstance->numUsbSectors = _DRV_MSD_NUM_SECTORS_BUFFERING;
-                }
-                else
-                {
-                    /* The number of blocks to be transferred is less than the buffer size available
-                       at the MSD. Read all requested number of blocks from the USB Host.
-                       Mark this as the number of blocks to be written to the media. */
-                    msdInstance->numUsbSectors = logicalBlockLength.Val;
-                }
+                /* The block was read into the write cache. Update the sectors
+                 * in the cached block. The block is written to the media when
+                 * it is evicted or when the cache is flushed. */
+                _USB_DEVICE_MSD_WriteCacheFillComplete(msdInstance, sectorOffsetWithinBlock, data,
+                        (mediaDynamicData->sectorSize * msdInstance->mediaSectors));
             }
             else
+#endif
             {
-                /* Media sector and the USB MSD Sector size is not the same. Use the 
-                   the read-modify-write concept if a partial media sector is to be 
-                   updated. */
-                uint8_t sectorOffsetInBlock = (logicalBlockAddress.Val - (memoryBlock * sectorsPerBlock));
-                uint8_t numRemainingSectorsInBlock = sectorsPerBlock - sectorOffsetInBlock;
-
-                if (logicalBlockLength.Val > numRemainingSectorsInBlock)
+                for (i = 0; i < (mediaDynamicData->sectorSize * msdInstance->mediaSectors); i ++)
                 {
-                    /* Number of sectors to be written > numRemainingSectorsInBlock
-                       number of sectors to read from usb = numRemainingSectorsInBlock
-                       number of sectors to be written in this block = numRemainingSectorsInBlock */
-                    if (numRemainingSectorsInBlock > _DRV_MSD_NUM_SECTORS_BUFFERING)
-                    {
-                        msdInstance->numUsbSectors = _DRV_MSD_NUM_SECTORS_BUFFERING;
-                    }
-                    else
-                    {
-                        msdInstance->numUsbSectors = numRemainingSectorsInBlock;
-                    }
+                    writeBlockBackupBuffer[sectorOffsetWithinBlock + i] = data[i];
                 }
-                else
-                {
-                    /* Number of sectors to write is less than that of the available buffer
-                       capacity.
-                       Read all the sectors from the USB.
-                       Update the number of sectors to be written to the media. */
 
-                    if (logicalBlockLength.Val > _DRV_MSD_NUM_SECTORS_BUFFERING)
-                    {
-                        msdInstance->numUsbSectors = _DRV_MSD_NUM_SECTORS_BUFFERING;
-                    }
-                    else
-                    {
-                        msdInstance->numUsbSectors = logicalBlockLength.Val;
-                    }
+                mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_PENDING;
+
+                mediaFunctions->blockWrite (drvHandle, &mediaReadWriteHandle, 
+                        writeBlockBackupBuffer, memoryBlock, 1);
+
+                if (mediaReadWriteHandle == SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID)
+                {
+                    /* Media write failed. */
+                    *commandStatus = USB_MSD_CSW_COMMAND_FAILED;
+                    return USB_DEVICE_MSD_STATE_CSW;
                 }
             }
+        }
+
+        if (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE)
+        {
+            /* The media write has completed. Update the total byte count and
+             * the block address and the length values */
+            msdInstance->rxTxTotalDataByteCount += (msdInstance->mediaSectors * mediaDynamicData->sectorSize);
+            logicalBlockAddress.Val += msdInstance->mediaSectors;
+            logicalBlockLength.Val -= msdInstance->mediaSectors;
+
+            /* Save back the updated address and logical block */
+            _USB_DEVICE_MSD_SaveBlockAddressAndLength(lCBW, &logicalBlockAddress, &logicalBlockLength);
+
+            msdInstance->mediaSectors = 0;
+            mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
+            memoryBlock = logicalBlockAddress.Val/sectorsPerBlock;
+        }
+    }
+
+    if ((mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_IDLE)
+            && (msdInstance->readySectors != 0))
+    {
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+        writeCacheResult = USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
+        if ((sectorsPerBlock > 1) && (mediaWriteBlockSize <= USB_DEVICE_MSD_WRITE_CACHE_BLOCK_SIZE))
+        {
+            /* Pass the ready bank to the write cache */
+            writeCacheResult = _USB_DEVICE_MSD_WriteCacheWrite(msdInstance, logicalUnit, memoryBlock,
+                    ((logicalBlockAddress.Val - (memoryBlock * sectorsPerBlock)) * mediaDynamicData->sectorSize),
+                    &msdBuffer[msdInstance->readyBank * _DRV_MSD_NUM_SECTORS_PER_BANK * mediaDynamicData->sectorSize],
+                    (msdInstance->readySectors * mediaDynamicData->sectorSize));
+
+            if (writeCacheResult == USB_DEVICE_MSD_MEDIA_OPERATION_ERROR)
+            {
+                /* Media access failed. */
+                *commandStatus = USB_MSD_CSW_COMMAND_FAILED;
+                return USB_DEVICE_MSD_STATE_CSW;
+            }
 
-            msdInstance->numSectorsToWrite = msdInstance->numUsbSectors;
-            msdInstance->bufferOffset = 0;
+            if (msdInstance->writeCacheOperation == USB_DEVICE_MSD_WRITE_CACHE_OPERATION_WRITE_BACK)
+            {
+                /* The least recently used cache block is being written back to
+                 * make room. The ready bank is passed to the cache again when
+                 * this completes. */
+                return USB_DEVICE_MSD_STATE_DATA_OUT;
+            }
         }
+#endif
+
+        /* Pass the ready bank to the media */
+        msdInstance->mediaBank = msdInstance->readyBank;
+        msdInstance->mediaSectors = msdInstance->readySectors;
+        msdInstance->readySectors = 0;
 
-        if (msdInstance->numUsbSectors > 0)
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+        if (writeCacheResult == USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE)
         {
-            /* There is still data that needs to be read from the USB. 
-               Find the correct offset in the buffer for the new data.
-             */
-            msdInstance->irpRx.data = (void *)&msdBuffer[msdInstance->bufferOffset * 512];
-            msdInstance->irpRx.size = mediaDynamicData->sectorSize;
-            msdInstance->irpRx.flags = USB_DEVICE_IRP_FLAG_DATA_PENDING;
-
-            /* Submit IRP to receive more data */
-            USB_DEVICE_IRPSubmit (msdInstance->hUsbDevHandle, msdInstance->bulkEndpointRx, &msdInstance->irpRx);
-
-            /* Increment the data buffer offset */
-            msdInstance->bufferOffset++;
-            /* Decrement the number of sectors to read from usb */
-            msdInstance->numUsbSectors--;
+            /* The sectors were merged into a cached block. The write is
+             * completed on the next call. */
+            mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE;
+        }
+        else if (writeCacheResult == USB_DEVICE_MSD_MEDIA_OPERATION_PENDING)
+        {
+            /* The block is being read into the cache */
+            msdInstance->mediaBlockReadPending = true;
         }
         else
+#endif
         {
-            /* There is no need to use the read-modify-write cycle if the media sector size
-               and the usb msd sector size are the same or if the whole of the media sector is being programmed. */
-            if ((sectorsPerBlock == 1) || (sectorsPerBlock == msdInstance->numSectorsToWrite))
+            mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_PENDING;
+
+            /* There is no need to use the read-modify-write cycle if the media
+             * sector size and the usb msd sector size are the same or if the
+             * whole of the media sector is being programmed. */
+            if ((sectorsPerBlock == 1) || (sectorsPerBlock == msdInstance->mediaSectors))
             {
-                /* set the operation status to complete */
-                mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE;
+                uint32_t blockAddress = memoryBlock;
+                uint32_t numBlocks = msdInstance->mediaSectors / sectorsPerBlock;
+
+                if (mediaDynamicData->sectorSize > mediaWriteBlockSize)
+                {
+                    uint32_t numBlocksInSector = 0;
+                    numBlocksInSector = (mediaDynamicData->sectorSize / mediaWriteBlockSize);
+                    numBlocks *= numBlocksInSector;
+                    blockAddress = logicalBlockAddress.Val * numBlocksInSector;
+                }
+
+                /* Write data to the media */
+                mediaFunctions->blockWrite (drvHandle, &mediaReadWriteHandle, 
+                        &msdBuffer[msdInstance->mediaBank * _DRV_MSD_NUM_SECTORS_PER_BANK * mediaDynamicData->sectorSize],
+                        blockAddress, numBlocks);
             }
             else
             {
-                /* set the operation status to pending */
-                mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_PENDING;
-
                 /* Read one media sector worth of data. */
+                msdInstance->mediaBlockReadPending = true;
                 mediaFunctions->blockRead(drvHandle, &mediaReadWriteHandle,
                         writeBlockBackupBuffer, (memoryBlock * (mediaWriteBlockSize/mediaReadBlockSize)),
                         (mediaWriteBlockSize/mediaReadBlockSize));
+            }
 
-                if (mediaReadWriteHandle == SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID)
-                {
-                    /* Media read failed. */
-                    *commandStatus = USB_MSD_CSW_COMMAND_FAILED;
-                    return USB_DEVICE_MSD_STATE_CSW;
-                }
+            if (mediaReadWriteHandle == SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID)
+            {
+                /* Media access failed. */
+                *commandStatus = USB_MSD_CSW_COMMAND_FAILED;
+                return USB_DEVICE_MSD_STATE_CSW;
             }
         }
     }
 
-    if (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE)
+    if ((msdInstance->readySectors == 0) && (msdInstance->usbBlockLength != 0)
+            && ((_DRV_MSD_NUM_SECTOR_BANKS > 1) || (msdInstance->mediaSectors == 0)))
     {
-        uint8_t *data;
-        uint32_t blockAddress;
-        uint32_t numBlocks;
+        /* A bank is free. Receive the next set of sectors from the host. A
+         * set never spans more than one media write block, so that it can be
+         * written with one read-modify-write cycle. */
+        uint16_t numSectors = _DRV_MSD_NUM_SECTORS_PER_BANK;
 
-        if ((sectorsPerBlock == 1) || (sectorsPerBlock == msdInstance->numSectorsToWrite))
-        {
-            data = msdBuffer;
-            numBlocks = msdInstance->numSectorsToWrite / sectorsPerBlock;
-        }
-        else
+        if (sectorsPerBlock > 1)
         {
-            uint16_t i = 0;
-            uint16_t sectorOffsetWithinBlock = (logicalBlockAddress.Val - (memoryBlock * sectorsPerBlock)) * mediaDynamicData->sectorSize;
-            /*
-               find the offset in the write block buffer
-               update with the data from the usb
-             */
+            uint32_t numRemainingSectorsInBlock = sectorsPerBlock - (msdInstance->usbBlockAddress % sectorsPerBlock);
 
-            /* Update the sector in the write block */
-            for (i = 0; i < (mediaDynamicData->sectorSize * msdInstance->numSectorsToWrite); i ++)
+            if (numSectors > numRemainingSectorsInBlock)
             {
-                writeBlockBackupBuffer[sectorOffsetWithinBlock + i] = msdBuffer[i];
+                numSectors = numRemainingSectorsInBlock;
             }
-
-            data = writeBlockBackupBuffer;
-            numBlocks = 1;
         }
 
-        blockAddress = logicalBlockAddress.Val / sectorsPerBlock;
-
-        if (mediaDynamicData->sectorSize > mediaWriteBlockSize)
+        if (numSectors > msdInstance->usbBlockLength)
         {
-            uint32_t numBlocksInSector = 0;
-            numBlocksInSector = (mediaDynamicData->sectorSize / mediaWriteBlockSize);
-            numBlocks *= numBlocksInSector;
-            blockAddress = logicalBlockAddress.Val * numBlocksInSector;
+            numSectors = msdInstance->usbBlockLength;
         }
 
-        mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_PENDING;
-
-        /* number of sectors to be written in this block != 0 */
-        /* Write data to the media */
-        mediaFunctions->blockWrite (drvHandle, &mediaReadWriteHandle, 
-                (uint8_t*)data, blockAddress, numBlocks);
-
-        if (mediaReadWriteHandle == SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID)
+        if (msdInstance->mediaSectors != 0)
         {
-            /* Media write failed. */
-            *commandStatus = USB_MSD_CSW_COMMAND_FAILED;
-            return USB_DEVICE_MSD_STATE_CSW;
+            msdInstance->usbBank = (msdInstance->mediaBank + 1) % _DRV_MSD_NUM_SECTOR_BANKS;
+        }
+        else
+        {
+            msdInstance->usbBank = 0;
         }
 
-        /* Update the total byte count */
-        msdInstance->rxTxTotalDataByteCount += (msdInstance->numSectorsToWrite * 512);
-
-        /* Updated the block address and the length values */
-        logicalBlockAddress.Val += msdInstance->numSectorsToWrite;
-        logicalBlockLength.Val -= msdInstance->numSectorsToWrite;
+        msdInstance->usbSectors = numSectors;
+        msdInstance->usbBlockAddress += numSectors;
+        msdInstance->usbBlockLength -= numSectors;
 
-        /* Save back the updated address and logical block */
-        _USB_DEVICE_MSD_SaveBlockAddressAndLength(lCBW, &logicalBlockAddress, &logicalBlockLength);
+        msdInstance->irpRx.data = (void *)&msdBuffer[msdInstance->usbBank * _DRV_MSD_NUM_SECTORS_PER_BANK * mediaDynamicData->sectorSize];
+        msdInstance->irpRx.size = numSectors * mediaDynamicData->sectorSize;
+        msdInstance->irpRx.flags = USB_DEVICE_IRP_FLAG_DATA_PENDING;
 
-        msdInstance->numSectorsToWrite = 0;
+        /* Submit IRP to receive more data */
+        USB_DEVICE_IRPSubmit (msdInstance->hUsbDevHandle, msdInstance->bulkEndpointRx, &msdInstance->irpRx);
+    }
+    else if ((logicalBlockLength.Val == 0) && (msdInstance->mediaSectors == 0))
+    {
+        /* Done writing all the blocks. Move on to the CSW Stage. */
+        return USB_DEVICE_MSD_STATE_CSW;
     }
 
     return USB_DEVICE_MSD_STATE_DATA_OUT;
@@ -1759,7 +1983,30 @@ USB_DEVICE_MSD_STATE _USB_DEVICE_MSD_ProcessNonRWCommand
             }
             break;
 
+        case SCSI_SYNCHRONIZE_CACHE:
+            if(mediaDynamicData->mediaPresent == false)
+            {
+                (*commandStatus) = USB_MSD_CSW_COMMAND_FAILED;
+                break;
+            }
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+            /* Write the modified cache blocks to the media */
+            msdNextState = USB_DEVICE_MSD_STATE_FLUSH_CACHE;
+#endif
+            break;
+
         case SCSI_PREVENT_ALLOW_MEDIUM_REMOVAL:
+            if ((lCBW->CBWCB[4] & 0x01) == 0)
+            {
+                /* The host allows the medium to be removed. */
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+                /* Write the modified cache blocks to the media */
+                msdNextState = USB_DEVICE_MSD_STATE_FLUSH_CACHE;
+#endif
+                break;
+            }
+
+            /* Medium removal cannot be prevented. */
             mediaDynamicData->senseData->SenseKey = SCSI_SENSE_ILLEGAL_REQUEST;
             mediaDynamicData->senseData->ASC = SCSI_ASC_INVALID_COMMAND_OPCODE;
             mediaDynamicData->senseData->ASCQ = SCSI_ASCQ_INVALID_COMMAND_OPCODE;
@@ -1804,6 +2051,11 @@ void _USB_DEVICE_MSD_Deinitialization ( SYS_MODULE_INDEX iMSD )
 
     msdInstance = &gUSBDeviceMSDInstance[ iMSD ] ;
     
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+    /* Queue the modified cache blocks to the media before the media is
+     * closed */
+    _USB_DEVICE_MSD_WriteCacheDeinitialize(msdInstance);
+#endif
 
     // close all open logical units..
     for(count = 0; count < msdInstance->numberOfLogicalUnits; count++)
@@ -1864,3 +2116,790 @@ void _USB_DEVICE_MSD_ResetSenseData( SCSI_SENSE_DATA * senseData )
 	senseData->SenseKeySpecific[2] = 0x0;
 }
 
+
+
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+// *****************************************************************************
+// *****************************************************************************
+// Section: MSD Write Cache Routines
+// *****************************************************************************
+// *****************************************************************************
+
+// ******************************************************************************
+/* Function:
+    void _USB_DEVICE_MSD_WriteCacheInitialize ( SYS_MODULE_INDEX iMSD )
+
+  Summary:
+    Initializes the write cache of an MSD function driver instance.
+
+  Description:
+    This function invalidates all cache blocks and resets the cache statistics.
+    It is called when the function driver is initialized by the Device Layer.
+
+  Remarks:
+    This is a local function and should not be called directly by an
+    application.
+*/
+
+void _USB_DEVICE_MSD_WriteCacheInitialize ( SYS_MODULE_INDEX iMSD )
+{
+    USB_DEVICE_MSD_INSTANCE * msdInstance = &gUSBDeviceMSDInstance[iMSD];
+    uint8_t count;
+
+    for (count = 0; count < USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER; count++)
+    {
+        msdInstance->writeCache[count].data = gUSBDeviceMSDWriteCacheData[iMSD][count];
+        msdInstance->writeCache[count].valid = false;
+        msdInstance->writeCache[count].dirty = false;
+        msdInstance->writeCache[count].lastAccess = 0;
+    }
+
+    msdInstance->writeCacheAccessCount = 0;
+    msdInstance->writeCacheOperation = USB_DEVICE_MSD_WRITE_CACHE_OPERATION_NONE;
+    msdInstance->writeCacheIdleCount = 0;
+    msdInstance->writeCacheWriteBackError = false;
+    memset(&msdInstance->writeCacheStatistics, 0, sizeof(USB_DEVICE_MSD_WRITE_CACHE_STATISTICS));
+}
+
+// ******************************************************************************
+/* Function:
+    void _USB_DEVICE_MSD_WriteCacheDeinitialize
+    (
+        USB_DEVICE_MSD_INSTANCE * msdInstance
+    )
+
+  Summary:
+    Queues all modified cache blocks to the media.
+
+  Description:
+    This function is called when the function driver is deinitialized. The MSD
+    tasks routine is not called after this, so the modified cache blocks are
+    queued to the media without waiting for the writes to complete. All cache
+    blocks are then invalidated.
+
+  Remarks:
+    This is a local function and should not be called directly by an
+    application. The media driver processes its requests in order, so the
+    cache blocks are written before they can be reused by a later request.
+*/
+
+void _USB_DEVICE_MSD_WriteCacheDeinitialize
+(
+    USB_DEVICE_MSD_INSTANCE * msdInstance
+)
+{
+    SYS_MEDIA_BLOCK_COMMAND_HANDLE mediaWriteHandle;
+    USB_DEVICE_MSD_WRITE_CACHE_BLOCK * cacheBlock;
+    USB_DEVICE_MSD_MEDIA_DYNAMIC_DATA * mediaDynamicData;
+    uint8_t count;
+
+    for (count = 0; count < USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER; count++)
+    {
+        cacheBlock = &msdInstance->writeCache[count];
+        mediaDynamicData = &msdInstance->mediaDynamicData[cacheBlock->logicalUnit];
+
+        /* A block that is already being written back is not queued again */
+        if ((cacheBlock->valid) && (cacheBlock->dirty) && 
+                ((msdInstance->writeCacheOperation != USB_DEVICE_MSD_WRITE_CACHE_OPERATION_WRITE_BACK)
+                 || (msdInstance->writeCacheOperationBlock != count)))
+        {
+            mediaWriteHandle = SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID;
+
+            if (mediaDynamicData->mediaHandle != DRV_HANDLE_INVALID)
+            {
+                msdInstance->mediaData[cacheBlock->logicalUnit].mediaFunctions.blockWrite(mediaDynamicData->mediaHandle,
+                        &mediaWriteHandle, cacheBlock->data, cacheBlock->memoryBlock, 1);
+            }
+
+            if (mediaWriteHandle != SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID)
+            {
+                msdInstance->writeCacheStatistics.flushes++;
+            }
+        }
+
+        cacheBlock->valid = false;
+        cacheBlock->dirty = false;
+    }
+
+    msdInstance->writeCacheOperation = USB_DEVICE_MSD_WRITE_CACHE_OPERATION_NONE;
+}
+
+// ******************************************************************************
+/* Function:
+    bool _USB_DEVICE_MSD_WriteCacheWriteBack
+    (
+        USB_DEVICE_MSD_INSTANCE * msdInstance,
+        uint8_t block
+    )
+
+  Summary:
+    Starts writing a modified cache block back to the media.
+
+  Description:
+    This function starts writing the specified cache block to the media. The
+    function returns true if the write was started. The block is lost if the
+    write could not be started.
+
+  Remarks:
+    This is a local function and should not be called directly by an
+    application.
+*/
+
+bool _USB_DEVICE_MSD_WriteCacheWriteBack
+(
+    USB_DEVICE_MSD_INSTANCE * msdInstance,
+    uint8_t block
+)
+{
+    SYS_MEDIA_BLOCK_COMMAND_HANDLE mediaWriteHandle = SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID;
+    USB_DEVICE_MSD_WRITE_CACHE_BLOCK * cacheBlock = &msdInstance->writeCache[block];
+    USB_DEVICE_MSD_MEDIA_DYNAMIC_DATA * mediaDynamicData = &msdInstance->mediaDynamicData[cacheBlock->logicalUnit];
+
+    msdInstance->writeCacheOperation = USB_DEVICE_MSD_WRITE_CACHE_OPERATION_WRITE_BACK;
+    msdInstance->writeCacheOperationBlock = block;
+    mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_PENDING;
+
+    msdInstance->mediaData[cacheBlock->logicalUnit].mediaFunctions.blockWrite(mediaDynamicData->mediaHandle,
+            &mediaWriteHandle, cacheBlock->data, cacheBlock->memoryBlock, 1);
+
+    if (mediaWriteHandle == SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID)
+    {
+        cacheBlock->valid = false;
+        cacheBlock->dirty = false;
+        msdInstance->writeCacheWriteBackError = true;
+        msdInstance->writeCacheOperation = USB_DEVICE_MSD_WRITE_CACHE_OPERATION_NONE;
+        mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
+        return false;
+    }
+
+    return true;
+}
+
+// ******************************************************************************
+/* Function:
+    USB_DEVICE_MSD_MEDIA_OPERATION _USB_DEVICE_MSD_WriteCacheWriteBackTasks
+    (
+        USB_DEVICE_MSD_INSTANCE * msdInstance
+    )
+
+  Summary:
+    Tracks the write back of a cache block.
+
+  Description:
+    This function returns USB_DEVICE_MSD_MEDIA_OPERATION_PENDING while a cache
+    block is being written back to the media. It returns
+    USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE or
+    USB_DEVICE_MSD_MEDIA_OPERATION_ERROR once, when the write back has
+    completed. A block that could not be written is lost. The function returns
+    USB_DEVICE_MSD_MEDIA_OPERATION_IDLE if no block is being written back.
+
+  Remarks:
+    This is a local function and should not be called directly by an
+    application.
+*/
+
+USB_DEVICE_MSD_MEDIA_OPERATION _USB_DEVICE_MSD_WriteCacheWriteBackTasks
+(
+    USB_DEVICE_MSD_INSTANCE * msdInstance
+)
+{
+    USB_DEVICE_MSD_MEDIA_OPERATION result;
+    USB_DEVICE_MSD_WRITE_CACHE_BLOCK * cacheBlock;
+    USB_DEVICE_MSD_MEDIA_DYNAMIC_DATA * mediaDynamicData;
+
+    if (msdInstance->writeCacheOperation != USB_DEVICE_MSD_WRITE_CACHE_OPERATION_WRITE_BACK)
+    {
+        return USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
+    }
+
+    cacheBlock = &msdInstance->writeCache[msdInstance->writeCacheOperationBlock];
+    mediaDynamicData = &msdInstance->mediaDynamicData[cacheBlock->logicalUnit];
+    result = mediaDynamicData->mediaState;
+
+    switch (result)
+    {
+        case USB_DEVICE_MSD_MEDIA_OPERATION_PENDING:
+            return result;
+
+        case USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE:
+            cacheBlock->dirty = false;
+            break;
+
+        case USB_DEVICE_MSD_MEDIA_OPERATION_ERROR:
+            cacheBlock->valid = false;
+            cacheBlock->dirty = false;
+            msdInstance->writeCacheWriteBackError = true;
+            break;
+
+        default:
+            /* The media state was reset before the write back completed. The
+             * block is still modified and will be written again. */
+            break;
+    }
+
+    mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
+    msdInstance->writeCacheOperation = USB_DEVICE_MSD_WRITE_CACHE_OPERATION_NONE;
+
+    return result;
+}
+
+// ******************************************************************************
+/* Function:
+    bool _USB_DEVICE_MSD_WriteCacheFlush ( USB_DEVICE_MSD_INSTANCE * msdInstance )
+
+  Summary:
+    Writes the modified cache blocks back to the media.
+
+  Description:
+    This function writes the modified cache blocks back to the media, one block
+    at a time. It must be called repeatedly until it returns true, which
+    indicates that there are no more modified blocks in the cache.
+
+  Remarks:
+    This is a local function and should not be called directly by an
+    application.
+*/
+
+bool _USB_DEVICE_MSD_WriteCacheFlush ( USB_DEVICE_MSD_INSTANCE * msdInstance )
+{
+    uint8_t count;
+
+    if (_USB_DEVICE_MSD_WriteCacheWriteBackTasks(msdInstance) == USB_DEVICE_MSD_MEDIA_OPERATION_PENDING)
+    {
+        return false;
+    }
+
+    for (count = 0; count < USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER; count++)
+    {
+        if ((msdInstance->writeCache[count].valid) && (msdInstance->writeCache[count].dirty))
+        {
+            if (_USB_DEVICE_MSD_WriteCacheWriteBack(msdInstance, count))
+            {
+                msdInstance->writeCacheStatistics.flushes++;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// ******************************************************************************
+/* Function:
+    USB_DEVICE_MSD_MEDIA_OPERATION _USB_DEVICE_MSD_WriteCacheWrite
+    (
+        USB_DEVICE_MSD_INSTANCE * msdInstance,
+        uint8_t logicalUnit,
+        uint32_t memoryBlock,
+        uint32_t offset,
+        uint8_t * data,
+        uint32_t size
+    )
+
+  Summary:
+    Writes sectors received from the host to the write cache.
+
+  Description:
+    This function writes size bytes of sector data at the byte offset within
+    the specified media write block. The function returns:
+    - USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE if the block is in the cache and
+      the data has been merged into the block.
+    - USB_DEVICE_MSD_MEDIA_OPERATION_IDLE if the data covers a whole block that
+      is not in the cache. The data should be written to the media directly.
+    - USB_DEVICE_MSD_MEDIA_OPERATION_PENDING if a media operation was started.
+      If the least recently used block is being written back to make room, the
+      function should be called again when the write back has completed.
+      Otherwise the block is being read into the cache and
+      _USB_DEVICE_MSD_WriteCacheFillComplete should be called when the read has
+      completed.
+    - USB_DEVICE_MSD_MEDIA_OPERATION_ERROR if the media operation could not be
+      started.
+
+  Remarks:
+    This is a local function and should not be called directly by an
+    application.
+*/
+
+USB_DEVICE_MSD_MEDIA_OPERATION _USB_DEVICE_MSD_WriteCacheWrite
+(
+    USB_DEVICE_MSD_INSTANCE * msdInstance,
+    uint8_t logicalUnit,
+    uint32_t memoryBlock,
+    uint32_t offset,
+    uint8_t * data,
+    uint32_t size
+)
+{
+    SYS_MEDIA_BLOCK_COMMAND_HANDLE mediaReadHandle = SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID;
+    USB_DEVICE_MSD_MEDIA_DYNAMIC_DATA * mediaDynamicData = &msdInstance->mediaDynamicData[logicalUnit];
+    USB_DEVICE_MSD_WRITE_CACHE_BLOCK * cacheBlock = NULL;
+    USB_DEVICE_MSD_WRITE_CACHE_BLOCK * victim = NULL;
+    size_t mediaWriteBlockSize = mediaDynamicData->mediaGeometry->geometryTable[1].blockSize;
+    size_t mediaReadBlockSize = mediaDynamicData->mediaGeometry->geometryTable[0].blockSize;
+    uint8_t victimIndex = 0;
+    uint8_t count;
+
+    /* Look for the block in the cache. Also find the block to be replaced if
+     * it is not. An invalid block is preferred to the least recently used
+     * block. */
+    for (count = 0; count < USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER; count++)
+    {
+        cacheBlock = &msdInstance->writeCache[count];
+
+        if ((cacheBlock->valid) && (cacheBlock->logicalUnit == logicalUnit)
+                && (cacheBlock->memoryBlock == memoryBlock))
+        {
+            /* The block is in the cache. Merge the sectors. */
+            memcpy(&cacheBlock->data[offset], data, size);
+            cacheBlock->dirty = true;
+            cacheBlock->lastAccess = ++msdInstance->writeCacheAccessCount;
+            msdInstance->writeCacheStatistics.hits++;
+            return USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE;
+        }
+
+        if ((victim == NULL) || ((victim->valid) && 
+                ((!cacheBlock->valid) || (cacheBlock->lastAccess < victim->lastAccess))))
+        {
+            victim = cacheBlock;
+            victimIndex = count;
+        }
+    }
+
+    if (size == mediaWriteBlockSize)
+    {
+        /* The whole block is being written. There is no need to read it. */
+        return USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
+    }
+
+    if ((victim->valid) && (victim->dirty))
+    {
+        /* Write back the least recently used block to make room */
+        msdInstance->writeCacheStatistics.evictions++;
+
+        if (!_USB_DEVICE_MSD_WriteCacheWriteBack(msdInstance, victimIndex))
+        {
+            return USB_DEVICE_MSD_MEDIA_OPERATION_ERROR;
+        }
+
+        return USB_DEVICE_MSD_MEDIA_OPERATION_PENDING;
+    }
+
+    /* Read the block into the cache */
+    msdInstance->writeCacheStatistics.misses++;
+    victim->valid = false;
+    victim->dirty = false;
+    victim->logicalUnit = logicalUnit;
+    victim->memoryBlock = memoryBlock;
+    msdInstance->writeCacheOperation = USB_DEVICE_MSD_WRITE_CACHE_OPERATION_FILL;
+    msdInstance->writeCacheOperationBlock = victimIndex;
+    mediaDynamicData->mediaState = USB_DEVICE_MSD_MEDIA_OPERATION_PENDING;
+
+    msdInstance->mediaData[logicalUnit].mediaFunctions.blockRead(mediaDynamicData->mediaHandle,
+            &mediaReadHandle, victim->data, (memoryBlock * (mediaWriteBlockSize/mediaReadBlockSize)),
+            (mediaWriteBlockSize/mediaReadBlockSize));
+
+    if (mediaReadHandle == SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID)
+    {
+        msdInstance->writeCacheOperation = USB_DEVICE_MSD_WRITE_CACHE_OPERATION_NONE;
+        return USB_DEVICE_MSD_MEDIA_OPERATION_ERROR;
+    }
+
+    return USB_DEVICE_MSD_MEDIA_OPERATION_PENDING;
+}
+
+// ******************************************************************************
+/* Function:
+    void _USB_DEVICE_MSD_WriteCacheFillComplete
+    (
+        USB_DEVICE_MSD_INSTANCE * msdInstance,
+        uint32_t offset,
+        uint8_t * data,
+        uint32_t size
+    )
+
+  Summary:
+    Completes a write to a block that was read into the cache.
+
+  Description:
+    This function is called when the block read started by
+    _USB_DEVICE_MSD_WriteCacheWrite has completed. It merges the sectors into
+    the block and marks the block as valid and modified.
+
+  Remarks:
+    This is a local function and should not be called directly by an
+    application.
+*/
+
+void _USB_DEVICE_MSD_WriteCacheFillComplete
+(
+    USB_DEVICE_MSD_INSTANCE * msdInstance,
+    uint32_t offset,
+    uint8_t * data,
+    uint32_t size
+)
+{
+    USB_DEVICE_MSD_WRITE_CACHE_BLOCK * cacheBlock = &msdInstance->writeCache[msdInstance->writeCacheOperationBlock];
+
+    memcpy(&cacheBlock->data[offset], data, size);
+    cacheBlock->valid = true;
+    cacheBlock->dirty = true;
+    cacheBlock->lastAccess = ++msdInstance->writeCacheAccessCount;
+    msdInstance->writeCacheOperation = USB_DEVICE_MSD_WRITE_CACHE_OPERATION_NONE;
+}
+
+// ******************************************************************************
+/* Function:
+    void _USB_DEVICE_MSD_WriteCacheReadUpdate
+    (
+        USB_DEVICE_MSD_INSTANCE * msdInstance,
+        uint8_t logicalUnit,
+        uint32_t sectorAddress,
+        uint32_t numSectors,
+        uint8_t * data
+    )
+
+  Summary:
+    Updates sectors read from the media with modified sectors in the cache.
+
+  Description:
+    This function copies the sectors of modified cache blocks that overlap
+    the numSectors sectors starting at sectorAddress into the data buffer. It
+    is called after sectors are read from the media and before they are sent
+    to the host.
+
+  Remarks:
+    This is a local function and should not be called directly by an
+    application.
+*/
+
+void _USB_DEVICE_MSD_WriteCacheReadUpdate
+(
+    USB_DEVICE_MSD_INSTANCE * msdInstance,
+    uint8_t logicalUnit,
+    uint32_t sectorAddress,
+    uint32_t numSectors,
+    uint8_t * data
+)
+{
+    USB_DEVICE_MSD_MEDIA_DYNAMIC_DATA * mediaDynamicData = &msdInstance->mediaDynamicData[logicalUnit];
+    USB_DEVICE_MSD_WRITE_CACHE_BLOCK * cacheBlock;
+    size_t mediaWriteBlockSize = mediaDynamicData->mediaGeometry->geometryTable[1].blockSize;
+    uint32_t sectorsPerBlock;
+    uint32_t blockStart;
+    uint32_t start;
+    uint32_t end;
+    uint8_t count;
+
+    if (mediaDynamicData->sectorSize >= mediaWriteBlockSize)
+    {
+        /* This media does not use the cache */
+        return;
+    }
+
+    sectorsPerBlock = mediaWriteBlockSize / mediaDynamicData->sectorSize;
+
+    for (count = 0; count < USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER; count++)
+    {
+        cacheBlock = &msdInstance->writeCache[count];
+
+        if ((!cacheBlock->valid) || (!cacheBlock->dirty) || (cacheBlock->logicalUnit != logicalUnit))
+        {
+            continue;
+        }
+
+        /* Find the sectors of this block that were read */
+        blockStart = cacheBlock->memoryBlock * sectorsPerBlock;
+        start = (blockStart > sectorAddress) ? blockStart : sectorAddress;
+        end = ((blockStart + sectorsPerBlock) < (sectorAddress + numSectors)) ? 
+            (blockStart + sectorsPerBlock) : (sectorAddress + numSectors);
+
+        if (start < end)
+        {
+            memcpy(&data[(start - sectorAddress) * mediaDynamicData->sectorSize],
+                    &cacheBlock->data[(start - blockStart) * mediaDynamicData->sectorSize],
+                    (end - start) * mediaDynamicData->sectorSize);
+        }
+    }
+}
+
+// ******************************************************************************
+/* Function:
+    void USB_DEVICE_MSD_WriteCacheStatisticsGet
+    (
+        SYS_MODULE_INDEX iMSD,
+        USB_DEVICE_MSD_WRITE_CACHE_STATISTICS * statistics
+    )
+
+  Summary:
+    Returns the write cache statistics of an MSD function driver instance.
+
+  Description:
+    Returns the write cache statistics of an MSD function driver instance.
+
+  Remarks:
+    Refer to usb_device_msd.h for usage information.
+*/
+
+void USB_DEVICE_MSD_WriteCacheStatisticsGet
+(
+    SYS_MODULE_INDEX iMSD,
+    USB_DEVICE_MSD_WRITE_CACHE_STATISTICS * statistics
+)
+{
+    SYS_ASSERT(statistics != NULL, "USB Device MSD: statistics cannot be NULL");
+
+    *statistics = gUSBDeviceMSDInstance[iMSD].writeCacheStatistics;
+}
+#endif
+
+#if defined(USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER)
+// *****************************************************************************
+// *****************************************************************************
+// Section: MSD Read Ahead Routines
+// *****************************************************************************
+// *****************************************************************************
+
+// ******************************************************************************
+/* Function:
+    void _USB_DEVICE_MSD_ReadAheadInitialize ( SYS_MODULE_INDEX iMSD )
+
+  Summary:
+    Initializes the read ahead of all LUNs of an MSD function driver instance.
+
+  Description:
+    This function assigns a read ahead buffer to each LUN, discards the
+    sectors that were read ahead and resets the LUN statistics. It is called
+    when the function driver is initialized by the Device Layer.
+
+  Remarks:
+    This is a local function and should not be called directly by an
+    application.
+*/
+
+void _USB_DEVICE_MSD_ReadAheadInitialize ( SYS_MODULE_INDEX iMSD )
+{
+    USB_DEVICE_MSD_INSTANCE * msdInstance = &gUSBDeviceMSDInstance[iMSD];
+    USB_DEVICE_MSD_MEDIA_DYNAMIC_DATA * mediaDynamicData;
+    uint8_t count;
+
+    for (count = 0; count < msdInstance->numberOfLogicalUnits; count++)
+    {
+        mediaDynamicData = &msdInstance->mediaDynamicData[count];
+        mediaDynamicData->readAheadBuffer = gUSBDeviceMSDReadAheadData[iMSD][count];
+        mediaDynamicData->readAheadState = USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
+        mediaDynamicData->readAheadHandle = SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID;
+        mediaDynamicData->readAheadAddress = 0;
+        mediaDynamicData->readAheadSectors = 0;
+        memset(&mediaDynamicData->statistics, 0, sizeof(USB_DEVICE_MSD_LUN_STATISTICS));
+    }
+}
+
+// ******************************************************************************
+/* Function:
+    void _USB_DEVICE_MSD_ReadAheadStart ( USB_DEVICE_MSD_INSTANCE * msdInstance )
+
+  Summary:
+    Starts reading the sectors that follow a READ (10) command.
+
+  Description:
+    This function is called when the data stage of a command has ended. If the
+    command was a READ (10) command that passed, the function starts reading
+    the sectors that follow it into the read ahead buffer of the LUN. The media
+    read then continues while the CSW is sent and while the host accesses the
+    other LUNs. The sectors are sent from the read ahead buffer if the next
+    READ (10) command to this LUN starts at the first of these sectors.
+
+  Remarks:
+    This is a local function and should not be called directly by an
+    application.
+*/
+
+void _USB_DEVICE_MSD_ReadAheadStart ( USB_DEVICE_MSD_INSTANCE * msdInstance )
+{
+    USB_MSD_CBW * lCBW = (USB_MSD_CBW *)msdInstance->msdCBW;
+    uint8_t logicalUnit = lCBW->bCBWLUN;
+    USB_DEVICE_MSD_MEDIA_DYNAMIC_DATA * mediaDynamicData = &msdInstance->mediaDynamicData[logicalUnit];
+    USB_DEVICE_MSD_DWORD_VAL logicalBlockAddress;
+    USB_DEVICE_MSD_DWORD_VAL logicalBlockLength;
+    size_t mediaReadBlockSize;
+    uint32_t blocksPerSector;
+    uint32_t mediaSectorsNumber;
+    uint32_t numSectors;
+
+    /* The completion of the read ahead cannot be told apart from the
+     * completion of another media operation that was started before it. The
+     * read ahead is therefore started only if the LUN media is idle. */
+    if ((lCBW->CBWCB[0] != SCSI_READ_10)
+            || (msdInstance->msdCSW->bCSWStatus != USB_MSD_CSW_COMMAND_PASSED)
+            || (mediaDynamicData->mediaPresent == false)
+            || (mediaDynamicData->mediaState == USB_DEVICE_MSD_MEDIA_OPERATION_PENDING)
+            || (mediaDynamicData->readAheadState == USB_DEVICE_MSD_MEDIA_OPERATION_PENDING)
+            || (mediaDynamicData->sectorSize == 0)
+            || (mediaDynamicData->sectorSize > _DRV_MSD_READ_AHEAD_BUFFER_SIZE))
+    {
+        return;
+    }
+
+    /* The CBW holds the sector that follows the last sector sent to the
+     * host. */
+    _USB_DEVICE_MSD_GetBlockAddressAndLength(lCBW, &logicalBlockAddress, &logicalBlockLength);
+
+    mediaReadBlockSize = mediaDynamicData->mediaGeometry->geometryTable[0].blockSize;
+    blocksPerSector = mediaDynamicData->sectorSize / mediaReadBlockSize;
+    mediaSectorsNumber = mediaDynamicData->mediaGeometry->geometryTable[0].numBlocks / blocksPerSector;
+
+    if (logicalBlockAddress.Val >= mediaSectorsNumber)
+    {
+        /* The host has read the last sector of the media */
+        return;
+    }
+
+    numSectors = _DRV_MSD_READ_AHEAD_BUFFER_SIZE / mediaDynamicData->sectorSize;
+    if (numSectors > (mediaSectorsNumber - logicalBlockAddress.Val))
+    {
+        numSectors = mediaSectorsNumber - logicalBlockAddress.Val;
+    }
+
+    mediaDynamicData->readAheadAddress = logicalBlockAddress.Val;
+    mediaDynamicData->readAheadSectors = numSectors;
+    mediaDynamicData->readAheadHandle = SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID;
+    mediaDynamicData->readAheadState = USB_DEVICE_MSD_MEDIA_OPERATION_PENDING;
+
+    msdInstance->mediaData[logicalUnit].mediaFunctions.blockRead(mediaDynamicData->mediaHandle,
+            &mediaDynamicData->readAheadHandle, mediaDynamicData->readAheadBuffer,
+            (logicalBlockAddress.Val * blocksPerSector), (numSectors * blocksPerSector));
+
+    if ((mediaDynamicData->readAheadHandle == SYS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID)
+            && (mediaDynamicData->readAheadState == USB_DEVICE_MSD_MEDIA_OPERATION_PENDING))
+    {
+        /* The media could not start the read */
+        mediaDynamicData->readAheadSectors = 0;
+        mediaDynamicData->readAheadState = USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
+    }
+}
+
+// ******************************************************************************
+/* Function:
+    USB_DEVICE_MSD_MEDIA_OPERATION _USB_DEVICE_MSD_ReadAheadRead
+    (
+        USB_DEVICE_MSD_INSTANCE * msdInstance,
+        uint8_t logicalUnit,
+        USB_DEVICE_MSD_DWORD_VAL * logicalBlockAddress,
+        USB_DEVICE_MSD_DWORD_VAL * logicalBlockLength
+    )
+
+  Summary:
+    Sends the first sectors of a READ (10) command from the read ahead buffer.
+
+  Description:
+    This function is called at the start of the data stage of a READ (10)
+    command. If the command starts at the first sector that was read ahead,
+    the function submits the read ahead buffer to the bulk IN endpoint,
+    advances the logical block address and length past the submitted sectors
+    and returns USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE. It returns
+    USB_DEVICE_MSD_MEDIA_OPERATION_PENDING if these sectors are still being
+    read from the media. Otherwise the function returns
+    USB_DEVICE_MSD_MEDIA_OPERATION_IDLE and the sectors must be read from the
+    media.
+
+  Remarks:
+    This is a local function and should not be called directly by an
+    application. The read ahead buffer is not filled again before the data
+    stage of the command has ended.
+*/
+
+USB_DEVICE_MSD_MEDIA_OPERATION _USB_DEVICE_MSD_ReadAheadRead
+(
+    USB_DEVICE_MSD_INSTANCE * msdInstance,
+    uint8_t logicalUnit,
+    USB_DEVICE_MSD_DWORD_VAL * logicalBlockAddress,
+    USB_DEVICE_MSD_DWORD_VAL * logicalBlockLength
+)
+{
+    USB_DEVICE_MSD_MEDIA_DYNAMIC_DATA * mediaDynamicData = &msdInstance->mediaDynamicData[logicalUnit];
+    uint32_t numSectors;
+
+    if ((mediaDynamicData->readAheadSectors == 0)
+            || (mediaDynamicData->readAheadAddress != logicalBlockAddress->Val))
+    {
+        return USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
+    }
+
+    if (mediaDynamicData->readAheadState == USB_DEVICE_MSD_MEDIA_OPERATION_PENDING)
+    {
+        return USB_DEVICE_MSD_MEDIA_OPERATION_PENDING;
+    }
+
+    if (mediaDynamicData->readAheadState != USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE)
+    {
+        /* The read ahead failed. The sectors are read again so that the
+         * error is reported for this command. */
+        mediaDynamicData->readAheadSectors = 0;
+        mediaDynamicData->readAheadState = USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
+        return USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
+    }
+
+    numSectors = mediaDynamicData->readAheadSectors;
+    if (numSectors > logicalBlockLength->Val)
+    {
+        numSectors = logicalBlockLength->Val;
+    }
+
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+    /* Sectors that are modified in the write cache are newer than the
+     * sectors read from the media. */
+    _USB_DEVICE_MSD_WriteCacheReadUpdate(msdInstance, logicalUnit, logicalBlockAddress->Val,
+            numSectors, mediaDynamicData->readAheadBuffer);
+#endif
+
+    msdInstance->rxTxTotalDataByteCount += (numSectors * mediaDynamicData->sectorSize);
+    msdInstance->irpTx.size = numSectors * mediaDynamicData->sectorSize;
+    msdInstance->irpTx.data = (void *)mediaDynamicData->readAheadBuffer;
+    msdInstance->irpTx.flags = USB_DEVICE_IRP_FLAG_DATA_PENDING;
+    USB_DEVICE_IRPSubmit(msdInstance->hUsbDevHandle, msdInstance->bulkEndpointTx, &msdInstance->irpTx);
+
+    logicalBlockAddress->Val += numSectors;
+    logicalBlockLength->Val -= numSectors;
+
+    /* The buffer is being sent to the host */
+    mediaDynamicData->readAheadSectors = 0;
+    mediaDynamicData->readAheadState = USB_DEVICE_MSD_MEDIA_OPERATION_IDLE;
+    mediaDynamicData->statistics.readAheadHits++;
+
+    return USB_DEVICE_MSD_MEDIA_OPERATION_COMPLETE;
+}
+
+// ******************************************************************************
+/* Function:
+    void USB_DEVICE_MSD_LUNStatisticsGet
+    (
+        SYS_MODULE_INDEX iMSD,
+        uint8_t logicalUnit,
+        USB_DEVICE_MSD_LUN_STATISTICS * statistics
+    )
+
+  Summary:
+    Returns the statistics of a logical unit of an MSD function driver
+    instance.
+
+  Description:
+    Returns the statistics of a logical unit of an MSD function driver
+    instance.
+
+  Remarks:
+    Refer to usb_device_msd.h for usage information.
+*/
+
+void USB_DEVICE_MSD_LUNStatisticsGet
+(
+    SYS_MODULE_INDEX iMSD,
+    uint8_t logicalUnit,
+    USB_DEVICE_MSD_LUN_STATISTICS * statistics
+)
+{
+    SYS_ASSERT(statistics != NULL, "USB Device MSD: statistics cannot be NULL");
+    SYS_ASSERT(logicalUnit < gUSBDeviceMSDInstance[iMSD].numberOfLogicalUnits, "USB Device MSD: Invalid logical unit");
+
+    *statistics = gUSBDeviceMSDInstance[iMSD].mediaDynamicData[logicalUnit].statistics;
+}
+#endif
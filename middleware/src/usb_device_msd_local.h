@@ -52,6 +52,27 @@
 
 #define _DRV_MSD_NUM_SECTORS_BUFFERING (USB_DEVICE_MSD_NUM_SECTOR_BUFFERS)
 
+/* The sector buffer is split into two banks if it can hold at least two
+ * sectors. The media transfer of one bank is then overlapped with the USB
+ * transfer of the other bank. */
+#if (USB_DEVICE_MSD_NUM_SECTOR_BUFFERS > 1)
+#define _DRV_MSD_NUM_SECTOR_BANKS 2
+#else
+#define _DRV_MSD_NUM_SECTOR_BANKS 1
+#endif
+
+#define _DRV_MSD_NUM_SECTORS_PER_BANK (_DRV_MSD_NUM_SECTORS_BUFFERING / _DRV_MSD_NUM_SECTOR_BANKS)
+
+/* Number of idle MSD task calls after which the write cache is flushed */
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER) && !defined(USB_DEVICE_MSD_WRITE_CACHE_IDLE_FLUSH_COUNT)
+#define USB_DEVICE_MSD_WRITE_CACHE_IDLE_FLUSH_COUNT 10000
+#endif
+
+/* Size of the read ahead buffer of a LUN in bytes */
+#if defined(USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER)
+#define _DRV_MSD_READ_AHEAD_BUFFER_SIZE (USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER * 512)
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Local data types.
@@ -81,6 +102,9 @@ typedef enum
     USB_DEVICE_MSD_STATE_DATA_OUT,
     USB_DEVICE_MSD_STATE_CSW,
     USB_DEVICE_MSD_STATE_SEND_CSW,
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+    USB_DEVICE_MSD_STATE_FLUSH_CACHE,
+#endif
     USB_DEVICE_MSD_STATE_IDLE
 	
 } USB_DEVICE_MSD_STATE;
@@ -108,6 +132,73 @@ typedef enum
 	
 } USB_DEVICE_MSD_MEDIA_OPERATION;  
 
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+
+// *****************************************************************************
+/* USB device MSD write cache operation.
+
+  Summary:
+    Identifies the media operation that the write cache is waiting for.
+
+  Description:
+    This enumeration identifies the media operation that the write cache has
+    started on a cache block.
+
+  Remarks:
+    None.
+ */
+
+typedef enum
+{
+    /* No media operation is in progress on a cache block */
+    USB_DEVICE_MSD_WRITE_CACHE_OPERATION_NONE,
+
+    /* A media write block is being read into a cache block */
+    USB_DEVICE_MSD_WRITE_CACHE_OPERATION_FILL,
+
+    /* A modified cache block is being written back to the media */
+    USB_DEVICE_MSD_WRITE_CACHE_OPERATION_WRITE_BACK
+
+} USB_DEVICE_MSD_WRITE_CACHE_OPERATION;
+
+// *****************************************************************************
+/* USB device MSD write cache block.
+
+  Summary:
+    Holds one media write block in the write cache.
+
+  Description:
+    This structure holds the state of one block of the write cache. The block
+    is identified by the logical unit and the media write block number.
+
+  Remarks:
+    None.
+ */
+
+typedef struct
+{
+    /* Pointer to the block data */
+    uint8_t * data;
+
+    /* Media write block that is held in this cache block */
+    uint32_t memoryBlock;
+
+    /* Value of the cache access counter when this block was last used */
+    uint32_t lastAccess;
+
+    /* Logical unit of the media write block */
+    uint8_t logicalUnit;
+
+    /* True if the block data is valid */
+    bool valid;
+
+    /* True if the block data has not yet been written to the media */
+    bool dirty;
+
+} USB_DEVICE_MSD_WRITE_CACHE_BLOCK;
+
+#endif
+
 // *****************************************************************************
 /* Structure that carries all media info.
 
@@ -145,6 +236,26 @@ typedef struct
     /* Pointer to the media geometry */
     SYS_MEDIA_GEOMETRY * mediaGeometry;
 
+#if defined(USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER)
+    /* Buffer that holds the sectors read ahead of the host */
+    uint8_t * readAheadBuffer;
+
+    /* State of the read ahead media operation */
+    USB_DEVICE_MSD_MEDIA_OPERATION readAheadState;
+
+    /* Media command handle of the read ahead */
+    SYS_MEDIA_BLOCK_COMMAND_HANDLE readAheadHandle;
+
+    /* First sector in the read ahead buffer */
+    uint32_t readAheadAddress;
+
+    /* Number of sectors in the read ahead buffer. This is zero if the buffer
+     * does not hold sectors that can be sent to the host. */
+    uint32_t readAheadSectors;
+
+    /* Statistics of this LUN */
+    USB_DEVICE_MSD_LUN_STATISTICS statistics;
+#endif
     	
 } USB_DEVICE_MSD_MEDIA_DYNAMIC_DATA;
 
@@ -181,10 +292,36 @@ typedef struct
     /* Receive/Transmit data byte count */
     uint32_t rxTxTotalDataByteCount;                    
 
-    uint8_t bufferOffset;
-    uint8_t numUsbSectors;
-    uint8_t numSectorsToWrite;
-    uint8_t numPendingIrps;
+    /* Sector buffer bank used by the current media operation */
+    uint8_t mediaBank;
+
+    /* Number of sectors in the current media operation. Zero if there is no
+     * media operation in progress. */
+    uint16_t mediaSectors;
+
+    /* True if the current media operation is the block read of a
+     * read-modify-write cycle */
+    bool mediaBlockReadPending;
+
+    /* Sector buffer bank used by the data stage bulk OUT IRP */
+    uint8_t usbBank;
+
+    /* Number of sectors requested by the data stage bulk OUT IRP. Zero if
+     * there is no such IRP pending. */
+    uint16_t usbSectors;
+
+    /* Sector buffer bank holding data received from the host that is not
+     * yet passed to the media */
+    uint8_t readyBank;
+
+    /* Number of sectors in the ready bank */
+    uint16_t readySectors;
+
+    /* Address of the next sector to be received from the host */
+    uint32_t usbBlockAddress;
+
+    /* Number of sectors still to be received from the host */
+    uint32_t usbBlockLength;
 
     /* Dynamic media information */
     USB_DEVICE_MSD_MEDIA_DYNAMIC_DATA mediaDynamicData[USB_DEVICE_MSD_LUNS_NUMBER]; 
@@ -219,6 +356,30 @@ typedef struct
      * MSD instance */
     uint8_t alternateSetting;
 
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+    /* Write cache blocks */
+    USB_DEVICE_MSD_WRITE_CACHE_BLOCK writeCache[USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER];
+
+    /* Counter used to find the least recently used cache block */
+    uint32_t writeCacheAccessCount;
+
+    /* Media operation in progress on a cache block */
+    USB_DEVICE_MSD_WRITE_CACHE_OPERATION writeCacheOperation;
+
+    /* Cache block of the media operation in progress */
+    uint8_t writeCacheOperationBlock;
+
+    /* Number of MSD task calls spent waiting for a CBW */
+    uint32_t writeCacheIdleCount;
+
+    /* True if a cache block could not be written back since the last
+     * SYNCHRONIZE CACHE command */
+    bool writeCacheWriteBackError;
+
+    /* Write cache statistics */
+    USB_DEVICE_MSD_WRITE_CACHE_STATISTICS writeCacheStatistics;
+#endif
+
 }USB_DEVICE_MSD_INSTANCE;
 
 
@@ -615,6 +776,89 @@ void _USB_DEVICE_MSD_Tasks ( SYS_MODULE_INDEX iMSD );
 
 void _USB_DEVICE_MSD_CallBackBulkTxTransfer( USB_DEVICE_IRP *  handle );
 
+#if defined(USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER)
+// *****************************************************************************
+/* Write cache routines.
+
+  Summary:
+    Local routines that implement the MSD write-back cache.
+
+  Description:
+    These routines are defined in usb_device_msd.c. Refer to the function
+    definitions for details.
+
+  Remarks:
+    These are local functions and should not be called directly by the
+    application.
+*/
+
+void _USB_DEVICE_MSD_WriteCacheInitialize ( SYS_MODULE_INDEX iMSD );
+
+void _USB_DEVICE_MSD_WriteCacheDeinitialize ( USB_DEVICE_MSD_INSTANCE * msdInstance );
+
+bool _USB_DEVICE_MSD_WriteCacheWriteBack ( USB_DEVICE_MSD_INSTANCE * msdInstance, uint8_t block );
+
+USB_DEVICE_MSD_MEDIA_OPERATION _USB_DEVICE_MSD_WriteCacheWriteBackTasks ( USB_DEVICE_MSD_INSTANCE * msdInstance );
+
+bool _USB_DEVICE_MSD_WriteCacheFlush ( USB_DEVICE_MSD_INSTANCE * msdInstance );
+
+USB_DEVICE_MSD_MEDIA_OPERATION _USB_DEVICE_MSD_WriteCacheWrite
+(
+    USB_DEVICE_MSD_INSTANCE * msdInstance,
+    uint8_t logicalUnit,
+    uint32_t memoryBlock,
+    uint32_t offset,
+    uint8_t * data,
+    uint32_t size
+);
+
+void _USB_DEVICE_MSD_WriteCacheFillComplete
+(
+    USB_DEVICE_MSD_INSTANCE * msdInstance,
+    uint32_t offset,
+    uint8_t * data,
+    uint32_t size
+);
+
+void _USB_DEVICE_MSD_WriteCacheReadUpdate
+(
+    USB_DEVICE_MSD_INSTANCE * msdInstance,
+    uint8_t logicalUnit,
+    uint32_t sectorAddress,
+    uint32_t numSectors,
+    uint8_t * data
+);
+#endif
+
+#if defined(USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER)
+// *****************************************************************************
+/* Read ahead routines.
+
+  Summary:
+    Local routines that implement the per LUN read ahead.
+
+  Description:
+    These routines are defined in usb_device_msd.c. Refer to the function
+    definitions for details.
+
+  Remarks:
+    These are local functions and should not be called directly by the
+    application.
+*/
+
+void _USB_DEVICE_MSD_ReadAheadInitialize ( SYS_MODULE_INDEX iMSD );
+
+void _USB_DEVICE_MSD_ReadAheadStart ( USB_DEVICE_MSD_INSTANCE * msdInstance );
+
+USB_DEVICE_MSD_MEDIA_OPERATION _USB_DEVICE_MSD_ReadAheadRead
+(
+    USB_DEVICE_MSD_INSTANCE * msdInstance,
+    uint8_t logicalUnit,
+    USB_DEVICE_MSD_DWORD_VAL * logicalBlockAddress,
+    USB_DEVICE_MSD_DWORD_VAL * logicalBlockLength
+);
+#endif
+
 
 #endif
 
@@ -102,9 +102,17 @@ const USB_DEVICE_FUNCTION_DRIVER printerFunctionDriver =
     This array is private to the USB stack.
 */
 
+#if !defined(USB_DEVICE_IRP_POOL_SIZE)
 USB_DEVICE_IRP gUSBDevicePrinterIRP[USB_DEVICE_PRINTER_QUEUE_DEPTH_COMBINED];
 
-/* Create a variable for holding Printer IRP mutex Handle and status */
+/* Free index stack for the Printer IRPs */
+uint16_t gUSBDevicePrinterIRPFreeStack[USB_DEVICE_PRINTER_QUEUE_DEPTH_COMBINED];
+
+/* Free flags of the Printer IRPs */
+bool gUSBDevicePrinterIRPIsFree[USB_DEVICE_PRINTER_QUEUE_DEPTH_COMBINED];
+#endif
+
+/* Create a variable for holding Printer IRP pool */
 USB_DEVICE_PRINTER_COMMON_DATA_OBJ gUSBDevicePrinterCommonDataObj;
  
 
@@ -151,23 +159,19 @@ USB_DEVICE_PRINTER_INSTANCE gUSBDevicePRINTERInstance[USB_DEVICE_PRINTER_INSTANC
 */
 void _USB_DEVICE_PRINTER_GlobalInitialize (void)
 {
-    OSAL_RESULT osal_err;
-    
-    /* Create Mutex for Printer IRP objects if not created already */
-    if (gUSBDevicePrinterCommonDataObj.isMutexPrinterIrpInitialized == false)
+#if !defined(USB_DEVICE_IRP_POOL_SIZE)
+    /* Initialize the Printer IRP pool if not initialized already */
+    if (gUSBDevicePrinterCommonDataObj.isIrpPoolInitialized == false)
     {
-        /* This means that mutex where not created. Create them. */
-        osal_err = OSAL_MUTEX_Create(&gUSBDevicePrinterCommonDataObj.mutexPrinterIRP);
+        _USB_DEVICE_IRPPoolInitialize(&gUSBDevicePrinterCommonDataObj.irpPool,
+                gUSBDevicePrinterIRP, gUSBDevicePrinterIRPFreeStack,
+                gUSBDevicePrinterIRPIsFree,
+                USB_DEVICE_PRINTER_QUEUE_DEPTH_COMBINED, 0);
 
-        if(osal_err != OSAL_RESULT_TRUE)
-        {
-            /*do not proceed lock was not created, let user know about error*/
-            return;
-        }
-
-         /* Set this flag so that global mutex get allocated only once */
-         gUSBDevicePrinterCommonDataObj.isMutexPrinterIrpInitialized = true;
+         /* Set this flag so that the pool gets initialized only once */
+         gUSBDevicePrinterCommonDataObj.isIrpPoolInitialized = true;
     }
+#endif
 }
 
 // ******************************************************************************
@@ -218,6 +222,13 @@ void _USB_DEVICE_PRINTER_Initialization
     prnInstance->currentQSizeWrite = 0;
     prnInstance->currentQSizeRead = 0;   
 
+    /* Get the pool from which the IRPs of this instance are allocated */
+#if defined(USB_DEVICE_IRP_POOL_SIZE)
+    prnInstance->irpPool = _USB_DEVICE_IRPPoolGet(deviceHandle);
+#else
+    prnInstance->irpPool = &gUSBDevicePrinterCommonDataObj.irpPool;
+#endif
+
     switch(descType)
     {
         case USB_DESCRIPTOR_ENDPOINT:
@@ -531,6 +542,7 @@ void _USB_DEVICE_PRINTER_ControlTransferHandler
 void _USB_DEVICE_PRINTER_ReadIRPCallback (USB_DEVICE_IRP * irp )
 {
     USB_DEVICE_PRINTER_INSTANCE * prnInstance;
+    USB_DEVICE_PRINTER_INDEX iPRN = (USB_DEVICE_PRINTER_INDEX)(irp->userData);
 
     /* This function is called when an IRP has
      * terminated */
@@ -539,7 +551,7 @@ void _USB_DEVICE_PRINTER_ReadIRPCallback (USB_DEVICE_IRP * irp )
 
     /* The user data field of the IRP contains the Printer instance
      * that submitted this IRP */
-    prnInstance = &gUSBDevicePRINTERInstance[irp->userData];
+    prnInstance = &gUSBDevicePRINTERInstance[iPRN];
 
     /* populate the event handler for this transfer */
     readEventData.handle = ( USB_DEVICE_PRINTER_TRANSFER_HANDLE ) irp;
@@ -570,14 +582,15 @@ void _USB_DEVICE_PRINTER_ReadIRPCallback (USB_DEVICE_IRP * irp )
         readEventData.status = USB_DEVICE_PRINTER_RESULT_ERROR; 
     }
 
-    /* update the queue size */
-    prnInstance->currentQSizeRead --;
+    /* Return the IRP to the pool and update the queue size. The
+     * application may submit the next request from the event handler. */
+    _USB_DEVICE_IRPPoolRelease(prnInstance->irpPool, irp, &prnInstance->currentQSizeRead);
 
     /* valid application event handler present? */
     if ( prnInstance->appEventCallBack )
     {
         /* inform the application */
-        prnInstance->appEventCallBack ( (USB_DEVICE_PRINTER_INDEX)(irp->userData) , 
+        prnInstance->appEventCallBack ( iPRN , 
                    USB_DEVICE_PRINTER_EVENT_READ_COMPLETE , 
                    &readEventData, prnInstance->userData);
     }
@@ -601,6 +614,7 @@ void _USB_DEVICE_PRINTER_ReadIRPCallback (USB_DEVICE_IRP * irp )
 void _USB_DEVICE_PRINTER_WriteIRPCallback (USB_DEVICE_IRP * irp )
 {
     USB_DEVICE_PRINTER_INSTANCE * prnInstance;
+    USB_DEVICE_PRINTER_INDEX iPRN = (USB_DEVICE_PRINTER_INDEX)(irp->userData);
 
     /* This function is called when a Printer Write IRP has
      * terminated */
@@ -609,7 +623,7 @@ void _USB_DEVICE_PRINTER_WriteIRPCallback (USB_DEVICE_IRP * irp )
 
     /* The user data field of the IRP contains the Printer instance
      * that submitted this IRP */
-    prnInstance = &gUSBDevicePRINTERInstance[irp->userData];
+    prnInstance = &gUSBDevicePRINTERInstance[iPRN];
 
     /* populate the event handler for this transfer */
     writeEventData.handle = ( USB_DEVICE_PRINTER_TRANSFER_HANDLE ) irp;
@@ -640,14 +654,15 @@ void _USB_DEVICE_PRINTER_WriteIRPCallback (USB_DEVICE_IRP * irp )
         writeEventData.status = USB_DEVICE_PRINTER_RESULT_ERROR; 
     }
 
-    /* Update the queue size*/
-    prnInstance->currentQSizeWrite --;
+    /* Return the IRP to the pool and update the queue size. The
+     * application may submit the next request from the event handler. */
+    _USB_DEVICE_IRPPoolRelease(prnInstance->irpPool, irp, &prnInstance->currentQSizeWrite);
 
     /* valid application event handler present? */
     if ( prnInstance->appEventCallBack )
     {
         /* inform the application */
-        prnInstance->appEventCallBack ( (USB_DEVICE_PRINTER_INDEX)(irp->userData) , 
+        prnInstance->appEventCallBack ( iPRN , 
                    USB_DEVICE_PRINTER_EVENT_WRITE_COMPLETE , 
                    &writeEventData, prnInstance->userData);
     }
@@ -703,14 +718,11 @@ USB_DEVICE_PRINTER_RESULT USB_DEVICE_PRINTER_Read
     void * data , size_t size
 )
 {
-    unsigned int cnt;
     unsigned int remainder;
     USB_DEVICE_IRP * irp;
     USB_DEVICE_PRINTER_ENDPOINT * endpoint;
     USB_DEVICE_PRINTER_INSTANCE * prnInstance;
-    OSAL_RESULT osalError;
     USB_ERROR irpError;
-    OSAL_CRITSECT_DATA_TYPE IntState;
 
     /* Check the validity of the function driver index */
     
@@ -743,79 +755,36 @@ USB_DEVICE_PRINTER_RESULT USB_DEVICE_PRINTER_Read
         return(USB_DEVICE_PRINTER_RESULT_ERROR_TRANSFER_SIZE_INVALID);
     }
 
-    /* Make sure that we are with in the queue size for this instance */
-    if(prnInstance->currentQSizeRead >= prnInstance->queueSizeRead)
+    /* Get a free IRP. This fails if the read queue of this instance is
+     * full */
+    irp = _USB_DEVICE_IRPPoolAllocate(prnInstance->irpPool,
+            &prnInstance->currentQSizeRead, prnInstance->queueSizeRead);
+    if(irp == NULL)
     {
         SYS_ASSERT(false, "Read Queue is full");
         return(USB_DEVICE_PRINTER_RESULT_ERROR_TRANSFER_QUEUE_FULL);
     }
 
-    /*Obtain mutex to get access to a shared resource, check return value*/
-    osalError = OSAL_MUTEX_Lock(&gUSBDevicePrinterCommonDataObj.mutexPrinterIRP, OSAL_WAIT_FOREVER);
-    if(osalError != OSAL_RESULT_TRUE)
-    {
-      /*Do not proceed lock was not obtained, or error occurred, let user know about error*/
-      return (USB_DEVICE_PRINTER_RESULT_ERROR);
-    }
+    /* Configure the IRP and then submit */
+    irp->data = data;
+    irp->size = size;
+    irp->userData = (uintptr_t) iPRN;
+    irp->callback = _USB_DEVICE_PRINTER_ReadIRPCallback;
 
-    /* Loop and find a free IRP in the Q */
-    for ( cnt = 0; cnt < USB_DEVICE_PRINTER_QUEUE_DEPTH_COMBINED; cnt ++ )
-    {
-        if(gUSBDevicePrinterIRP[cnt].status <
-                (USB_DEVICE_IRP_STATUS)USB_DEVICE_IRP_FLAG_DATA_PENDING)
-        {
-            /* This means the IRP is free. Configure the IRP
-             * update the current queue size and then submit */
-
-            irp = &gUSBDevicePrinterIRP[cnt];
-            irp->data = data;
-            irp->size = size;
-            irp->userData = (uintptr_t) iPRN;
-            irp->callback = _USB_DEVICE_PRINTER_ReadIRPCallback;
-            
-            /* Prevent other tasks pre-empting this sequence of code */ 
-            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-            /* Update the read queue size */ 
-            prnInstance->currentQSizeRead++;
-            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-            
-            *transferHandle = (USB_DEVICE_PRINTER_TRANSFER_HANDLE)irp;
-            irpError = USB_DEVICE_IRPSubmit(prnInstance->deviceHandle,
-                    endpoint->address, irp);
-
-            /* If IRP Submit function returned any error, then invalidate the
-               Transfer handle.  */
-            if (irpError != USB_ERROR_NONE )
-            {
-                /* Prevent other tasks pre-empting this sequence of code */ 
-                IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-                /* Update the read queue size */ 
-                prnInstance->currentQSizeRead--;
-                OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-                *transferHandle = USB_DEVICE_PRINTER_TRANSFER_HANDLE_INVALID;
-            }
-            
-            /*Release mutex, done with shared resource*/
-            osalError = OSAL_MUTEX_Unlock(&gUSBDevicePrinterCommonDataObj.mutexPrinterIRP);
-            if(osalError != OSAL_RESULT_TRUE)
-            {
-                /*Do not proceed unlock was not complete, or error occurred, let user know about error*/
-                return (USB_DEVICE_PRINTER_RESULT_ERROR);
-            }
-            
-            return(irpError);
-        }
-    }
-    
-    /*Release mutex, done with shared resource*/
-    osalError = OSAL_MUTEX_Unlock(&gUSBDevicePrinterCommonDataObj.mutexPrinterIRP);
-    if(osalError != OSAL_RESULT_TRUE)
+    *transferHandle = (USB_DEVICE_PRINTER_TRANSFER_HANDLE)irp;
+    irpError = USB_DEVICE_IRPSubmit(prnInstance->deviceHandle,
+            endpoint->address, irp);
+
+    /* If IRP Submit function returned any error, then invalidate the
+       Transfer handle and return the IRP to the pool. */
+    if (irpError != USB_ERROR_NONE )
     {
-        /*Do not proceed unlock was not complete, or error occurred, let user know about error*/
-        return (USB_DEVICE_PRINTER_RESULT_ERROR);
+        _USB_DEVICE_IRPPoolRelease(prnInstance->irpPool, irp,
+                &prnInstance->currentQSizeRead);
+        *transferHandle = USB_DEVICE_PRINTER_TRANSFER_HANDLE_INVALID;
     }
-    /* If here means we could not find a spare IRP */
-    return(USB_DEVICE_PRINTER_RESULT_ERROR_TRANSFER_QUEUE_FULL);
+
+    return(irpError);
 }
 
 // *****************************************************************************
@@ -851,15 +820,12 @@ USB_DEVICE_PRINTER_RESULT USB_DEVICE_PRINTER_Write
     USB_DEVICE_PRINTER_TRANSFER_FLAGS flags 
 )
 {
-    unsigned int cnt;
     unsigned int remainder;
     USB_DEVICE_IRP * irp;
     USB_DEVICE_IRP_FLAG irpFlag = 0;
     USB_DEVICE_PRINTER_INSTANCE * prnInstance;
     USB_DEVICE_PRINTER_ENDPOINT * endpoint;
-    OSAL_RESULT osalError;
     USB_ERROR irpError; 
-    OSAL_CRITSECT_DATA_TYPE IntState;
 
     /* Check the validity of the function driver index */
     
@@ -916,79 +882,38 @@ USB_DEVICE_PRINTER_RESULT USB_DEVICE_PRINTER_Write
         irpFlag = USB_DEVICE_IRP_FLAG_DATA_COMPLETE;
     }
 
-    if(prnInstance->currentQSizeWrite >= prnInstance->queueSizeWrite)
+    /* Get a free IRP. This fails if the write queue of this instance is
+     * full */
+    irp = _USB_DEVICE_IRPPoolAllocate(prnInstance->irpPool,
+            &prnInstance->currentQSizeWrite, prnInstance->queueSizeWrite);
+    if(irp == NULL)
     {
         SYS_ASSERT(false, "Write Queue is full");
         return(USB_DEVICE_PRINTER_RESULT_ERROR_TRANSFER_QUEUE_FULL);
     }
 
-    /*Obtain mutex to get access to a shared resource, check return value*/
-    osalError = OSAL_MUTEX_Lock(&gUSBDevicePrinterCommonDataObj.mutexPrinterIRP, OSAL_WAIT_FOREVER);
-    if(osalError != OSAL_RESULT_TRUE)
-    {
-      /*Do not proceed lock was not obtained, or error occurred, let user know about error*/
-      return (USB_DEVICE_PRINTER_RESULT_ERROR);
-    }
+    irp->data   = (void *)data;
+    irp->size   = size;
 
-    /* loop and find a free IRP in the Q */
-    for ( cnt = 0; cnt < USB_DEVICE_PRINTER_QUEUE_DEPTH_COMBINED; cnt ++ )
-    {
-        if(gUSBDevicePrinterIRP[cnt].status <
-                (USB_DEVICE_IRP_STATUS)USB_DEVICE_IRP_FLAG_DATA_PENDING)
-        {
-            /* This means the IRP is free */
-
-            irp         = &gUSBDevicePrinterIRP[cnt];
-            irp->data   = (void *)data;
-            irp->size   = size;
-
-            irp->userData   = (uintptr_t) iPRN;
-            irp->callback   = _USB_DEVICE_PRINTER_WriteIRPCallback;
-            irp->flags      = irpFlag;
-
-            /* Prevent other tasks pre-empting this sequence of code */ 
-            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-            /* Update the Write queue size */ 
-            prnInstance->currentQSizeWrite++;
-            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-            
-            *transferHandle = (USB_DEVICE_PRINTER_TRANSFER_HANDLE)irp;
-
-            irpError = USB_DEVICE_IRPSubmit(prnInstance->deviceHandle,
-                    endpoint->address, irp);
-
-            /* If IRP Submit function returned any error, then invalidate the
-               Transfer handle.  */
-            if (irpError != USB_ERROR_NONE )
-            {
-                /* Prevent other tasks pre-empting this sequence of code */ 
-                IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
-                /* Update the Write queue size */ 
-                prnInstance->currentQSizeWrite--;
-                OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
-                *transferHandle = USB_DEVICE_PRINTER_TRANSFER_HANDLE_INVALID;
-            }
-            /*Release mutex, done with shared resource*/
-            osalError = OSAL_MUTEX_Unlock(&gUSBDevicePrinterCommonDataObj.mutexPrinterIRP);
-            if(osalError != OSAL_RESULT_TRUE)
-            {
-                /*Do not proceed unlock was not complete, or error occurred, let user know about error*/
-                return (USB_DEVICE_PRINTER_RESULT_ERROR);
-            }
+    irp->userData   = (uintptr_t) iPRN;
+    irp->callback   = _USB_DEVICE_PRINTER_WriteIRPCallback;
+    irp->flags      = irpFlag;
 
-            return(irpError);
-        }
-    }
-    
-    /*Release mutex, done with shared resource*/
-    osalError = OSAL_MUTEX_Unlock(&gUSBDevicePrinterCommonDataObj.mutexPrinterIRP);
-    if(osalError != OSAL_RESULT_TRUE)
+    *transferHandle = (USB_DEVICE_PRINTER_TRANSFER_HANDLE)irp;
+
+    irpError = USB_DEVICE_IRPSubmit(prnInstance->deviceHandle,
+            endpoint->address, irp);
+
+    /* If IRP Submit function returned any error, then invalidate the
+       Transfer handle and return the IRP to the pool. */
+    if (irpError != USB_ERROR_NONE )
     {
-        /*Do not proceed unlock was not complete, or error occurred, let user know about error*/
-        return (USB_DEVICE_PRINTER_RESULT_ERROR);
+        _USB_DEVICE_IRPPoolRelease(prnInstance->irpPool, irp,
+                &prnInstance->currentQSizeWrite);
+        *transferHandle = USB_DEVICE_PRINTER_TRANSFER_HANDLE_INVALID;
     }
-    /* If here means we could not find a spare IRP */
-    return(USB_DEVICE_PRINTER_RESULT_ERROR_TRANSFER_QUEUE_FULL);
+
+    return(irpError);
 }
 
 USB_DEVICE_PRINTER_RESULT USB_DEVICE_PRINTER_EventHandlerSet 
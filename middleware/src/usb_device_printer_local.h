@@ -57,6 +57,7 @@
 #include "usb/usb_common.h"
 #include "usb/usb_chapter_9.h"
 #include "usb/usb_device.h"
+#include "usb/src/usb_device_function_driver.h"
 #include "osal/osal.h"
 
 
@@ -205,6 +206,9 @@ typedef struct
     volatile unsigned int currentQSizeWrite;
     volatile unsigned int currentQSizeRead;
 
+    /* IRP pool from which this instance allocates IRPs */
+    USB_DEVICE_IRP_POOL * irpPool;
+
 } USB_DEVICE_PRINTER_INSTANCE;
 
 // *****************************************************************************
@@ -225,10 +229,12 @@ typedef struct
 {
     /* Set to true if all members of this structure
        have been initialized once */
-    bool isMutexPrinterIrpInitialized;
+    bool isIrpPoolInitialized;
 
-    /* Mutex to protect client object pool */
-    OSAL_MUTEX_DECLARE(mutexPrinterIRP);
+#if !defined(USB_DEVICE_IRP_POOL_SIZE)
+    /* Pool of IRPs shared by all Printer instances */
+    USB_DEVICE_IRP_POOL irpPool;
+#endif
 
 } USB_DEVICE_PRINTER_COMMON_DATA_OBJ;
 
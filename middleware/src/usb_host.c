@@ -104,6 +104,63 @@ static USB_HOST_PIPE_OBJ  gUSBHostPipeObj[ USB_HOST_PIPES_NUMBER ];
  ************************************************************/
 static USB_HOST_TRANSFER_OBJ gUSBHostTransferObj[ USB_HOST_TRANSFERS_NUMBER ];
 
+#if defined(USB_HOST_TRACE_RECORDS_NUMBER)
+/************************************************************
+ * Host layer trace. Records the IRPs that are submitted to
+ * the HCD and their completion.
+ ************************************************************/
+static USB_HOST_TRACE_OBJ gUSBHostTraceObj;
+#endif
+
+#if defined(USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER)
+/************************************************************
+ * Descriptor cache. Stores the descriptors of devices that
+ * were enumerated before.
+ ************************************************************/
+static USB_HOST_DESCRIPTOR_CACHE_OBJ gUSBHostDescriptorCacheObj;
+#endif
+
+#if defined(USB_HOST_TPL_INDEX_ENTRIES_NUMBER)
+/************************************************************
+ * TPL index. Ordered lists of the TPL entries that are used
+ * to find a matching driver without walking the TPL.
+ ************************************************************/
+static USB_HOST_TPL_INDEX gUSBHostTPLIndex;
+#endif
+
+#if defined(USB_HOST_MEMORY_POOL_ENABLE)
+/************************************************************
+ * Host layer memory pool. Descriptor buffers of the host
+ * layer and the client drivers are allocated from this pool.
+ ************************************************************/
+static USB_HOST_MEMORY_POOL_OBJ gUSBHostMemoryPoolObj;
+
+/************************************************************
+ * Memory pool size classes ordered by block size.
+ ************************************************************/
+static const USB_HOST_MEMORY_POOL_CLASS_INFO gUSBHostMemoryPoolClass[USB_HOST_MEMORY_POOL_CLASSES_NUMBER] =
+{
+    {
+        (uint8_t *)gUSBHostMemoryPoolObj.smallBlock,
+        sizeof(gUSBHostMemoryPoolObj.smallBlock[0]),
+        USB_HOST_MEMORY_POOL_SMALL_BLOCKS_NUMBER,
+        0
+    },
+    {
+        (uint8_t *)gUSBHostMemoryPoolObj.mediumBlock,
+        sizeof(gUSBHostMemoryPoolObj.mediumBlock[0]),
+        USB_HOST_MEMORY_POOL_MEDIUM_BLOCKS_NUMBER,
+        USB_HOST_MEMORY_POOL_SMALL_BLOCKS_NUMBER
+    },
+    {
+        (uint8_t *)gUSBHostMemoryPoolObj.largeBlock,
+        sizeof(gUSBHostMemoryPoolObj.largeBlock[0]),
+        USB_HOST_MEMORY_POOL_LARGE_BLOCKS_NUMBER,
+        USB_HOST_MEMORY_POOL_SMALL_BLOCKS_NUMBER + USB_HOST_MEMORY_POOL_MEDIUM_BLOCKS_NUMBER
+    }
+};
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: USB HOST Layer Local Functions
@@ -136,6 +193,36 @@ void _USB_HOST_TimerCallback(uintptr_t context)
 	busObj->busOperationsTimerHandle = SYS_TIME_HANDLE_INVALID;
 }
 
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_DeviceTimerCallback
+    (
+       uintptr_t context
+    )
+
+  Summary:
+    Function is called when the device timer started with
+    SYS_TMR_CallbackSingle expires.
+
+  Description:
+    Function is called when the device timer started with
+    SYS_TMR_CallbackSingle expires. The device timer is used for enumeration
+    delays that are required after the device has been addressed. These can
+    overlap with the reset of another device on the same bus.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/    
+
+void _USB_HOST_DeviceTimerCallback(uintptr_t context)
+{
+    USB_HOST_DEVICE_OBJ * deviceObj = ((USB_HOST_DEVICE_OBJ *)(context));
+    deviceObj->timerExpired = true;
+    SYS_TIME_TimerDestroy (deviceObj->deviceOperationsTimerHandle);
+    deviceObj->deviceOperationsTimerHandle = SYS_TIME_HANDLE_INVALID;
+}
+
 // *****************************************************************************
 /* Function:
     void * _USB_HOST_FindEndOfDescriptor(void * descriptor) 
@@ -729,243 +816,913 @@ bool _USB_HOST_ConfigurationDescriptorParse
 
 // *****************************************************************************
 /* Function:
-    int _USB_HOST_FindClassSubClassProtocolDriver
+    bool _USB_HOST_TPLClassEntryMatches
     (
-        uint8_t bDeviceClass,
-        uint8_t bDeviceSubClass,
-        uint8_t bDeviceProtocol,
-        int startPoint
-    );
+        USB_HOST_TPL_ENTRY * tpl,
+        uint8_t bClass,
+        uint8_t bSubClass,
+        uint8_t bProtocol
+    )
 
   Summary:
-    This function will search for matching class subclass protocol driver in the
-    TPL table.
+    Checks if a TPL entry matches a class, subclass and protocol.
 
   Description:
-    This function will search for matching class subclass protocol driver in the
-    TPL table. If a driver was not found, the function will return the last
-    index of the TPL table + 1. The function will start searching from (and
-    including) startPoint.
+    This function returns true if the TPL entry is a class subclass protocol
+    entry and all the fields that the entry does not ignore match.
 
   Remarks:
     This is a local function and should not be called directly by the
     application.
-*/    
+*/
 
-int _USB_HOST_FindClassSubClassProtocolDriver
+static bool _USB_HOST_TPLClassEntryMatches
 (
-    uint8_t bDeviceClass,
-    uint8_t bDeviceSubClass,
-    uint8_t bDeviceProtocol,
-    int startPoint
+    USB_HOST_TPL_ENTRY * tpl,
+    uint8_t bClass,
+    uint8_t bSubClass,
+    uint8_t bProtocol
 )
 {
-    USB_HOST_TPL_ENTRY * tpl;
-    int iterator;
-    USB_HOST_OBJ * hostObj = &gUSBHostObj;
+    bool result = false;
     unsigned int matched = 0;
     unsigned int tplFlags;
 
-    for(iterator = startPoint; iterator < hostObj->nTPLEntries; iterator ++)
+    /* Check if this entry is a class subclass protocol entry */
+    if(tpl->tplFlags.driverType == TPL_FLAG_CLASS_SUBCLASS_PROTOCOL)
     {
-        tpl = &hostObj->tpl[iterator];
+        /* First we check if which field match */
 
-        /* Check if this entry is a class subclass protocol entry */
-        if(tpl->tplFlags.driverType == TPL_FLAG_CLASS_SUBCLASS_PROTOCOL)
+        if(bClass == tpl->id.cl_sc_p.classCode)
         {
-            /* First we check if which field match */
-
-            if(bDeviceClass == tpl->id.cl_sc_p.classCode)
-            {
-                /* Class matched */
-                matched |= 0x2;
-            }
+            /* Class matched */
+            matched |= 0x2;
+        }
 
-            if(bDeviceSubClass == tpl->id.cl_sc_p.subClassCode)
-            {
-                /* Subclass matched */
-                matched |= 0x4;
-            }
+        if(bSubClass == tpl->id.cl_sc_p.subClassCode)
+        {
+            /* Subclass matched */
+            matched |= 0x4;
+        }
 
-            if(bDeviceProtocol == tpl->id.cl_sc_p.protocolCode)
-            {
-                /* Protocol matched */
-                matched |= 0x8;
-            }
+        if(bProtocol == tpl->id.cl_sc_p.protocolCode)
+        {
+            /* Protocol matched */
+            matched |= 0x8;
+        }
 
-            tplFlags = (tpl->tplFlags.ignoreClass << 1) | (tpl->tplFlags.ignoreSubClass << 2) | (tpl->tplFlags.ignoreProtocol << 3);
-            matched = matched & (~(tplFlags & 0xE));
+        tplFlags = (tpl->tplFlags.ignoreClass << 1) | (tpl->tplFlags.ignoreSubClass << 2) | (tpl->tplFlags.ignoreProtocol << 3);
+        matched = matched & (~(tplFlags & 0xE));
 
-            /* Now check if the criteria matches */
-            if((tplFlags & 0xE) == ((~matched) & 0xE))
-            {
-                /* We found a match */
-                break;
-            }
+        /* Now check if the criteria matches */
+        if((tplFlags & 0xE) == ((~matched) & 0xE))
+        {
+            /* We found a match */
+            result = true;
         }
     }
 
-    return(iterator);
+    return(result);
 }
 
 // *****************************************************************************
 /* Function:
-    void _USB_HOST_UpdateConfigurationState
+    bool _USB_HOST_TPLVIDPIDEntryMatches
     (
-        USB_HOST_DEVICE_OBJ * deviceObj,
-        int busIndex
-    );
+        USB_HOST_TPL_ENTRY * tpl,
+        uint16_t idVendor,
+        uint16_t idProduct
+    )
 
   Summary:
-    This function will update the configuration state of the device.
+    Checks if a TPL entry matches a VID and PID.
 
   Description:
-    This function will check if the device configuration needs to be changed. If
-    so then it gets the configuration, parses the configuration, sets up the
-    interface tables and then sets the configuration.
+    This function returns true if the TPL entry is a VID PID entry that ignores
+    the VID and PID, or whose VID and (masked) PID match.
 
   Remarks:
     This is a local function and should not be called directly by the
     application.
-*/    
+*/
 
-void _USB_HOST_UpdateConfigurationState
+static bool _USB_HOST_TPLVIDPIDEntryMatches
 (
-    USB_HOST_DEVICE_OBJ * deviceObj,
-    int busIndex
+    USB_HOST_TPL_ENTRY * tpl,
+    uint16_t idVendor,
+    uint16_t idProduct
 )
 {
-    USB_HOST_BUS_OBJ * busObj;
-    USB_CONFIGURATION_DESCRIPTOR * configurationDescriptor;
-    USB_HOST_DEVICE_EVENT_CONFIGURATION_SET_DATA eventData;
-    int iterator;
-    uint8_t isSelfPowered;
+    bool result = false;
 
-    busObj = &(gUSBHostBusList[busIndex]);
-    
-    /* This redundant statement is added to avoid warning in a case where the
-     * debug messages are disabled. */
-    busObj = busObj;
-    
-    /* Only proceed if the device is in a ready state */
-    if(deviceObj->deviceState == USB_HOST_DEVICE_STATE_READY)
+    if(tpl->tplFlags.driverType == TPL_FLAG_VID_PID)
     {
-        switch(deviceObj->configurationState)
+        if(tpl->tplFlags.ignoreVIDPID)
         {
-            case USB_HOST_DEVICE_CONFIG_STATE_READY_FOR_CONFIG:
+            /* The entry says that ignore the VID PID and match */
+            result = true;
+        }
+        else if(tpl->tplFlags.pidMasked)
+        {
+            /* Apply the specified mask to the PID field and then compare. */
+            result = ((idVendor == tpl->id.vid_pid.vid) && ((idProduct & tpl->pidMask) == tpl->id.vid_pid.pid));
+        }
+        else
+        {
+            result = ((idVendor == tpl->id.vid_pid.vid) && (idProduct == tpl->id.vid_pid.pid));
+        }
+    }
 
-                /* We don't have to do anything here. The state indicates that
-                 * the device is ready for configuration, but somebody has to
-                 * set it */
+    return(result);
+}
 
-                break;
+#if defined(USB_HOST_TPL_INDEX_ENTRIES_NUMBER)
 
-            case USB_HOST_DEVICE_CONFIG_STATE_START:
+// *****************************************************************************
+/* Function:
+    unsigned int _USB_HOST_TPLIndexLowerBound
+    (
+        USB_HOST_TPL_INDEX_LIST_TYPE list,
+        uint16_t key,
+        unsigned int tplIndex
+    )
 
-                /* Start the process of setting the configuration. We first get
-                 * the configuration header. The requestedConfigurationNumber
-                 * member of deviceObj contains the index of the configuration to be
-                 * set */
+  Summary:
+    Finds the first index entry of a list that is not smaller than the key and
+    TPL position.
 
-                _USB_HOST_FillSetupPacket(
-                        &(deviceObj->setupPacket),
-                        ( USB_SETUP_DIRN_DEVICE_TO_HOST |
-                          USB_SETUP_TYPE_STANDARD |
-                          USB_SETUP_RECIPIENT_DEVICE ),
-                        USB_REQUEST_GET_DESCRIPTOR,
-                        ( USB_DESCRIPTOR_CONFIGURATION << 8 )+ deviceObj->requestedConfigurationNumber , 0 , 9 ) ;
+  Description:
+    This function performs a binary search in the TPL index list and returns
+    the position in the index of the first entry whose key and TPL position is
+    greater than or equal to the specified key and TPL position. The function
+    returns the end of the list if there is no such entry.
 
-                /* Fill IRP */
-                deviceObj->controlTransferObj.controlIRP.data = ( void * )deviceObj->buffer;
-                deviceObj->controlTransferObj.controlIRP.setup = &(deviceObj->setupPacket);
-                deviceObj->controlTransferObj.controlIRP.size = 9;
-                deviceObj->controlTransferObj.controlIRP.callback = NULL;
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
 
-                /* Set the next state */
-                deviceObj->configurationState = USB_HOST_DEVICE_CONFIG_STATE_WAIT_FOR_CONFIG_DESCRIPTOR_HEADER_GET;
+static unsigned int _USB_HOST_TPLIndexLowerBound
+(
+    USB_HOST_TPL_INDEX_LIST_TYPE list,
+    uint16_t key,
+    unsigned int tplIndex
+)
+{
+    USB_HOST_TPL_INDEX_ENTRY * entry;
+    unsigned int low;
+    unsigned int high;
+    unsigned int middle;
+    uint32_t value;
 
-                /* Submit the IRP */
-                if(USB_ERROR_NONE != deviceObj->hcdInterface->hostIRPSubmit( deviceObj->controlPipeHandle, 
-                            &(deviceObj->controlTransferObj.controlIRP)))
-                {
-                    /* We need to be able to send the IRP. We move the
-                     * device to an error state. Close the pipe and send
-                     * an event to the application. */
-                    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host Layer: Bus %d Device %d Configuration Descriptor IRP failed. Device not supported.", 
-                            busIndex, deviceObj->deviceAddress);
-                    deviceObj->deviceState = USB_HOST_DEVICE_STATE_ERROR;
-                    deviceObj->hcdInterface->hostPipeClose(deviceObj->controlPipeHandle);
-                    if(gUSBHostObj.hostEventHandler != NULL)
-                    {
-                        /* Send an event to the application */
-                        gUSBHostObj.hostEventHandler( USB_HOST_EVENT_DEVICE_UNSUPPORTED, NULL, gUSBHostObj.context );
-                    }
-                }
+    value = ((uint32_t)key << 16) | tplIndex;
+    low = gUSBHostTPLIndex.listStart[list];
+    high = low + gUSBHostTPLIndex.listSize[list];
 
-                break;
+    while(low < high)
+    {
+        middle = low + ((high - low) >> 1);
+        entry = &gUSBHostTPLIndex.entry[middle];
+        if((((uint32_t)entry->key << 16) | entry->tplIndex) < value)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
 
-            case USB_HOST_DEVICE_CONFIG_STATE_WAIT_FOR_CONFIG_DESCRIPTOR_HEADER_GET:
+    return(low);
+}
 
-                /* Here we are waiting for Get Short Configuration header to
-                 * complete */
-                if (deviceObj->controlTransferObj.controlIRP.status == USB_HOST_IRP_STATUS_COMPLETED)
-                {
-                    if (deviceObj->hubAddress == 0x00 )
-                    {
-                        /* Check if the device is a self powered or bus powered    */
-                        configurationDescriptor = (USB_CONFIGURATION_DESCRIPTOR *)(deviceObj->buffer);
-                        isSelfPowered =  ( ( configurationDescriptor->bmAttributes ) & USB_ATTRIBUTE_SELF_POWERED );
+// *****************************************************************************
+/* Function:
+    int _USB_HOST_TPLIndexNext
+    (
+        USB_HOST_TPL_INDEX_LIST_TYPE keyList,
+        USB_HOST_TPL_INDEX_LIST_TYPE anyList,
+        uint16_t key,
+        int startPoint
+    )
 
-                        if (isSelfPowered != USB_ATTRIBUTE_SELF_POWERED )
-                        {
-                            /* This means the device is bus powered. We should check
-                             * if this configuration requires more current than what
-                             * the root hub can provide. */
+  Summary:
+    Finds the next TPL entry that can match the key.
 
-                            if ( 2 * ( configurationDescriptor->bMaxPower ) > busObj->rootHubInfo.power )
-                            {
-                                /* This means the device needs more power than what
-                                 * the root hub can provide. We cannot set this
-                                 * configuration. */
+  Description:
+    This function returns the TPL position of the first entry at or after
+    startPoint that either has the specified key in keyList or is in anyList.
+    The function returns the number of entries in the TPL if there is no such
+    entry. The caller must still check the other fields of the entry.
 
-                                if(deviceObj->deviceClientDriver != NULL)
-                                {
-                                    /* This means this device has device level
-                                     * driver and it is this driver that had
-                                     * requested for the configuration chanage.
-                                     * We let the driver know that the
-                                     * configuration cannot be set and then move
-                                     * the device to a ready but un-configured
-                                     * state.  This will allow the driver level
-                                     * driver to try setting another
-                                     * configuration. */
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
 
-                                    eventData.result = USB_HOST_RESULT_FAILURE;
-                                    deviceObj->deviceState = USB_HOST_DEVICE_STATE_READY;
-                                    deviceObj->configurationState = USB_HOST_DEVICE_CONFIG_STATE_READY_FOR_CONFIG;
+static int _USB_HOST_TPLIndexNext
+(
+    USB_HOST_TPL_INDEX_LIST_TYPE keyList,
+    USB_HOST_TPL_INDEX_LIST_TYPE anyList,
+    uint16_t key,
+    int startPoint
+)
+{
+    USB_HOST_TPL_INDEX_ENTRY * entry;
+    unsigned int position;
+    int result = gUSBHostObj.nTPLEntries;
 
-                                    /* We should send an event to the client
-                                     * driver result is failure  */
-                                    deviceObj->deviceClientDriver->deviceEventHandler(deviceObj->deviceClientHandle,
-                                            USB_HOST_DEVICE_EVENT_CONFIGURATION_SET, &eventData, deviceObj->controlTransferObj.context);
-                                }
-                                else
-                                {
-                                    /* The device does not have a devel lever
-                                     * client driver. This means the host layer
-                                     * owns the device. The host layer at this
-                                     * time cannot try any other configuration.
-                                     * The device must be moved to an
-                                     * in-operational state because of an
-                                     * over-current request. */
+    /* The first entry with this key at or after the start point */
+    position = _USB_HOST_TPLIndexLowerBound(keyList, key, (unsigned int)startPoint);
+    if(position < (unsigned int)(gUSBHostTPLIndex.listStart[keyList] + gUSBHostTPLIndex.listSize[keyList]))
+    {
+        entry = &gUSBHostTPLIndex.entry[position];
+        if(entry->key == key)
+        {
+            result = entry->tplIndex;
+        }
+    }
 
-                                    deviceObj->deviceState = USB_HOST_DEVICE_STATE_ERROR;
-                                }
+    /* The first entry that matches any key at or after the start point. The
+     * keys in this list are all 0. */
+    position = _USB_HOST_TPLIndexLowerBound(anyList, 0, (unsigned int)startPoint);
+    if(position < (unsigned int)(gUSBHostTPLIndex.listStart[anyList] + gUSBHostTPLIndex.listSize[anyList]))
+    {
+        entry = &gUSBHostTPLIndex.entry[position];
+        if(entry->tplIndex < result)
+        {
+            result = entry->tplIndex;
+        }
+    }
 
-                                /* We should send an event to the application */
-                                if(gUSBHostObj.hostEventHandler != NULL)
-                                {
-                                    gUSBHostObj.hostEventHandler( USB_HOST_EVENT_DEVICE_REJECTED_INSUFFICIENT_POWER, NULL, gUSBHostObj.context );
+    return(result);
+}
+
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_TPLIndexBuild(void)
+
+  Summary:
+    Builds the TPL index.
+
+  Description:
+    This function places every TPL entry in its TPL index list. Entries with
+    the same key stay in TPL order so that the index returns the same match as
+    a walk through the TPL. The index is not used if the TPL has more entries
+    than the index can hold.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application. The function is called once when the host layer is
+    initialized.
+*/
+
+static void _USB_HOST_TPLIndexBuild(void)
+{
+    USB_HOST_TPL_ENTRY * tpl;
+    USB_HOST_TPL_INDEX_LIST_TYPE list;
+    unsigned int tplIndex;
+    unsigned int position;
+    unsigned int last;
+    uint16_t key;
+
+    gUSBHostTPLIndex.valid = false;
+
+    if(gUSBHostObj.nTPLEntries > USB_HOST_TPL_INDEX_ENTRIES_NUMBER)
+    {
+        SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Host Layer: TPL is larger than the TPL index. TPL index not used.");
+    }
+    else
+    {
+        /* Count the entries of each list to find where the lists start */
+        for(list = 0; list < USB_HOST_TPL_INDEX_LISTS_NUMBER; list ++)
+        {
+            gUSBHostTPLIndex.listSize[list] = 0;
+        }
+
+        for(tplIndex = 0; tplIndex < gUSBHostObj.nTPLEntries; tplIndex ++)
+        {
+            tpl = &gUSBHostObj.tpl[tplIndex];
+            if(tpl->tplFlags.driverType == TPL_FLAG_VID_PID)
+            {
+                list = (tpl->tplFlags.ignoreVIDPID) ? USB_HOST_TPL_INDEX_LIST_ANY_VID : USB_HOST_TPL_INDEX_LIST_VID;
+            }
+            else
+            {
+                list = (tpl->tplFlags.ignoreClass) ? USB_HOST_TPL_INDEX_LIST_ANY_CLASS : USB_HOST_TPL_INDEX_LIST_CLASS;
+            }
+
+            gUSBHostTPLIndex.listSize[list] ++;
+        }
+
+        position = 0;
+        for(list = 0; list < USB_HOST_TPL_INDEX_LISTS_NUMBER; list ++)
+        {
+            gUSBHostTPLIndex.listStart[list] = position;
+            position += gUSBHostTPLIndex.listSize[list];
+            gUSBHostTPLIndex.listSize[list] = 0;
+        }
+
+        /* Now insert the entries. The entries are visited in TPL order, so an
+         * entry is inserted after all entries with the same key. */
+        for(tplIndex = 0; tplIndex < gUSBHostObj.nTPLEntries; tplIndex ++)
+        {
+            tpl = &gUSBHostObj.tpl[tplIndex];
+            key = 0;
+            if(tpl->tplFlags.driverType == TPL_FLAG_VID_PID)
+            {
+                list = USB_HOST_TPL_INDEX_LIST_ANY_VID;
+                if(!tpl->tplFlags.ignoreVIDPID)
+                {
+                    list = USB_HOST_TPL_INDEX_LIST_VID;
+                    key = tpl->id.vid_pid.vid;
+                }
+            }
+            else
+            {
+                list = USB_HOST_TPL_INDEX_LIST_ANY_CLASS;
+                if(!tpl->tplFlags.ignoreClass)
+                {
+                    list = USB_HOST_TPL_INDEX_LIST_CLASS;
+                    key = tpl->id.cl_sc_p.classCode;
+                }
+            }
+
+            last = gUSBHostTPLIndex.listStart[list] + gUSBHostTPLIndex.listSize[list];
+            position = last;
+            while((position > gUSBHostTPLIndex.listStart[list]) && (gUSBHostTPLIndex.entry[position - 1].key > key))
+            {
+                gUSBHostTPLIndex.entry[position] = gUSBHostTPLIndex.entry[position - 1];
+                position --;
+            }
+
+            gUSBHostTPLIndex.entry[position].key = key;
+            gUSBHostTPLIndex.entry[position].tplIndex = tplIndex;
+            gUSBHostTPLIndex.listSize[list] ++;
+        }
+
+        gUSBHostTPLIndex.valid = true;
+    }
+}
+
+#endif
+
+// *****************************************************************************
+/* Function:
+    int _USB_HOST_FindClassSubClassProtocolDriver
+    (
+        uint8_t bDeviceClass,
+        uint8_t bDeviceSubClass,
+        uint8_t bDeviceProtocol,
+        int startPoint
+    );
+
+  Summary:
+    This function will search for matching class subclass protocol driver in the
+    TPL table.
+
+  Description:
+    This function will search for matching class subclass protocol driver in the
+    TPL table. If a driver was not found, the function will return the last
+    index of the TPL table + 1. The function will start searching from (and
+    including) startPoint. If the TPL index is available, entries that cannot
+    match the class are skipped with the index.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+int _USB_HOST_FindClassSubClassProtocolDriver
+(
+    uint8_t bDeviceClass,
+    uint8_t bDeviceSubClass,
+    uint8_t bDeviceProtocol,
+    int startPoint
+)
+{
+    int iterator;
+    USB_HOST_OBJ * hostObj = &gUSBHostObj;
+
+    iterator = startPoint;
+    while(iterator < hostObj->nTPLEntries)
+    {
+#if defined(USB_HOST_TPL_INDEX_ENTRIES_NUMBER)
+        if(gUSBHostTPLIndex.valid)
+        {
+            /* Skip to the next entry that can match this class */
+            iterator = _USB_HOST_TPLIndexNext(USB_HOST_TPL_INDEX_LIST_CLASS,
+                    USB_HOST_TPL_INDEX_LIST_ANY_CLASS, bDeviceClass, iterator);
+            if(iterator >= hostObj->nTPLEntries)
+            {
+                break;
+            }
+        }
+#endif
+        if(_USB_HOST_TPLClassEntryMatches(&hostObj->tpl[iterator], bDeviceClass, bDeviceSubClass, bDeviceProtocol))
+        {
+            /* We found a match */
+            break;
+        }
+
+        iterator ++;
+    }
+
+    return(iterator);
+}
+
+// *****************************************************************************
+/* Function:
+    int _USB_HOST_FindVIDPIDDriver
+    (
+        uint16_t idVendor,
+        uint16_t idProduct,
+        int startPoint
+    );
+
+  Summary:
+    This function will search for a matching VID PID driver in the TPL table.
+
+  Description:
+    This function will search for a matching VID PID driver in the TPL table.
+    If a driver was not found, the function will return the number of entries
+    in the TPL table. The function will start searching from (and including)
+    startPoint. If the TPL index is available, entries that cannot match the
+    VID are skipped with the index.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+int _USB_HOST_FindVIDPIDDriver
+(
+    uint16_t idVendor,
+    uint16_t idProduct,
+    int startPoint
+)
+{
+    int iterator;
+    USB_HOST_OBJ * hostObj = &gUSBHostObj;
+
+    iterator = startPoint;
+    while(iterator < hostObj->nTPLEntries)
+    {
+#if defined(USB_HOST_TPL_INDEX_ENTRIES_NUMBER)
+        if(gUSBHostTPLIndex.valid)
+        {
+            /* Skip to the next entry that can match this VID */
+            iterator = _USB_HOST_TPLIndexNext(USB_HOST_TPL_INDEX_LIST_VID,
+                    USB_HOST_TPL_INDEX_LIST_ANY_VID, idVendor, iterator);
+            if(iterator >= hostObj->nTPLEntries)
+            {
+                break;
+            }
+        }
+#endif
+        if(_USB_HOST_TPLVIDPIDEntryMatches(&hostObj->tpl[iterator], idVendor, idProduct))
+        {
+            /* We found a match */
+            break;
+        }
+
+        iterator ++;
+    }
+
+    return(iterator);
+}
+
+#if defined(USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER)
+
+// *****************************************************************************
+/* Function:
+    uint32_t _USB_HOST_DescriptorCacheChecksum
+    (
+        USB_HOST_DESCRIPTOR_CACHE_ENTRY * entry
+    )
+
+  Summary:
+    Calculates the checksum of a descriptor cache entry.
+
+  Description:
+    This function calculates a Fletcher checksum over the device descriptor
+    and the configuration descriptor of the entry.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static uint32_t _USB_HOST_DescriptorCacheChecksum
+(
+    USB_HOST_DESCRIPTOR_CACHE_ENTRY * entry
+)
+{
+    const uint8_t * data;
+    uint32_t sum1 = 0;
+    uint32_t sum2 = 0;
+    uint32_t size;
+    uint32_t index;
+
+    data = (const uint8_t *)(&entry->deviceDescriptor);
+    for(index = 0; index < sizeof(USB_DEVICE_DESCRIPTOR); index ++)
+    {
+        sum1 = (sum1 + data[index]) % 65535;
+        sum2 = (sum2 + sum1) % 65535;
+    }
+
+    data = (const uint8_t *)(entry->configurationDescriptor);
+    size = ((USB_CONFIGURATION_DESCRIPTOR *)(entry->configurationDescriptor))->wTotalLength;
+    if(size > USB_HOST_DESCRIPTOR_CACHE_CONFIGURATION_SIZE)
+    {
+        /* The entry is corrupted. Limit the check to the entry. */
+        size = USB_HOST_DESCRIPTOR_CACHE_CONFIGURATION_SIZE;
+    }
+
+    for(index = 0; index < size; index ++)
+    {
+        sum1 = (sum1 + data[index]) % 65535;
+        sum2 = (sum2 + sum1) % 65535;
+    }
+
+    return((sum2 << 16) | sum1);
+}
+
+// *****************************************************************************
+/* Function:
+    bool _USB_HOST_DescriptorCacheEntryMatches
+    (
+        USB_HOST_DESCRIPTOR_CACHE_ENTRY * entry,
+        USB_HOST_DEVICE_OBJ * deviceObj
+    )
+
+  Summary:
+    Checks if a descriptor cache entry belongs to the device.
+
+  Description:
+    This function returns true if the entry is in use, has the device
+    descriptor and speed of the device and its checksum is valid. An entry
+    with an invalid checksum is discarded.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static bool _USB_HOST_DescriptorCacheEntryMatches
+(
+    USB_HOST_DESCRIPTOR_CACHE_ENTRY * entry,
+    USB_HOST_DEVICE_OBJ * deviceObj
+)
+{
+    bool result = false;
+
+    if((entry->inUse) && (entry->speed == deviceObj->speed) &&
+            (memcmp(&entry->deviceDescriptor, &deviceObj->deviceDescriptor, sizeof(USB_DEVICE_DESCRIPTOR)) == 0))
+    {
+        if(entry->checksum == _USB_HOST_DescriptorCacheChecksum(entry))
+        {
+            result = true;
+        }
+        else
+        {
+            /* The entry was corrupted. It cannot be used anymore. */
+            SYS_DEBUG_MESSAGE(SYS_ERROR_DEBUG, "\r\nUSB Host Layer: Descriptor cache entry checksum error. Entry discarded.");
+            entry->inUse = false;
+        }
+    }
+
+    return(result);
+}
+
+// *****************************************************************************
+/* Function:
+    USB_HOST_DESCRIPTOR_CACHE_ENTRY * _USB_HOST_DescriptorCacheFind
+    (
+        USB_HOST_DEVICE_OBJ * deviceObj
+    )
+
+  Summary:
+    Searches the descriptor cache for the device.
+
+  Description:
+    This function searches the descriptor cache for an entry that matches the
+    device descriptor and speed of the device and whose configuration
+    descriptor header matches the header of the first configuration that the
+    device returned. The header is expected in the buffer member of the device
+    object.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static USB_HOST_DESCRIPTOR_CACHE_ENTRY * _USB_HOST_DescriptorCacheFind
+(
+    USB_HOST_DEVICE_OBJ * deviceObj
+)
+{
+    USB_HOST_DESCRIPTOR_CACHE_ENTRY * result = NULL;
+    USB_HOST_DESCRIPTOR_CACHE_ENTRY * entry;
+    int iterator;
+
+    for(iterator = 0; iterator < USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER; iterator ++)
+    {
+        entry = &gUSBHostDescriptorCacheObj.entry[iterator];
+        if(_USB_HOST_DescriptorCacheEntryMatches(entry, deviceObj) &&
+                (memcmp(entry->configurationDescriptor, deviceObj->buffer, 9) == 0))
+        {
+            gUSBHostDescriptorCacheObj.useCount ++;
+            entry->lastUse = gUSBHostDescriptorCacheObj.useCount;
+            result = entry;
+            break;
+        }
+    }
+
+    return(result);
+}
+
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_DescriptorCacheAdd
+    (
+        USB_HOST_DEVICE_OBJ * deviceObj
+    )
+
+  Summary:
+    Adds the descriptors of the device to the descriptor cache.
+
+  Description:
+    This function stores the device descriptor, the speed and the
+    configuration descriptor of the device in the descriptor cache. An
+    existing entry of the device is replaced. Otherwise a free entry or the
+    least recently used entry is used. A configuration descriptor that is
+    larger than USB_HOST_DESCRIPTOR_CACHE_CONFIGURATION_SIZE is not cached.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static void _USB_HOST_DescriptorCacheAdd
+(
+    USB_HOST_DEVICE_OBJ * deviceObj
+)
+{
+    USB_HOST_DESCRIPTOR_CACHE_ENTRY * entry = NULL;
+    USB_HOST_DESCRIPTOR_CACHE_ENTRY * candidate;
+    uint16_t size;
+    int iterator;
+
+    size = deviceObj->configDescriptorInfo.configurationDescriptor->wTotalLength;
+
+    if(size <= USB_HOST_DESCRIPTOR_CACHE_CONFIGURATION_SIZE)
+    {
+        for(iterator = 0; iterator < USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER; iterator ++)
+        {
+            candidate = &gUSBHostDescriptorCacheObj.entry[iterator];
+            if(_USB_HOST_DescriptorCacheEntryMatches(candidate, deviceObj))
+            {
+                /* Replace the existing entry of this device */
+                entry = candidate;
+                break;
+            }
+            else if((entry == NULL) || (entry->inUse && ((!candidate->inUse) || (candidate->lastUse < entry->lastUse))))
+            {
+                /* Prefer a free entry, then the least recently used one */
+                entry = candidate;
+            }
+        }
+
+        memcpy(entry->configurationDescriptor, deviceObj->configDescriptorInfo.configurationDescriptor, size);
+        memcpy(&entry->deviceDescriptor, &deviceObj->deviceDescriptor, sizeof(USB_DEVICE_DESCRIPTOR));
+        entry->speed = deviceObj->speed;
+        entry->checksum = _USB_HOST_DescriptorCacheChecksum(entry);
+        gUSBHostDescriptorCacheObj.useCount ++;
+        entry->lastUse = gUSBHostDescriptorCacheObj.useCount;
+        entry->inUse = true;
+
+        deviceObj->descriptorCacheEntry = entry;
+    }
+}
+
+// *****************************************************************************
+/* Function:
+    bool _USB_HOST_DescriptorCacheUsable
+    (
+        USB_HOST_DEVICE_OBJ * deviceObj
+    )
+
+  Summary:
+    Checks if the configuration being set can be taken from the descriptor
+    cache.
+
+  Description:
+    This function returns true if the device was found in the descriptor cache
+    at attach, the first configuration is being set and the cache entry still
+    belongs to the device. The entry can have been replaced by another device
+    since the attach.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static bool _USB_HOST_DescriptorCacheUsable
+(
+    USB_HOST_DEVICE_OBJ * deviceObj
+)
+{
+    bool result = false;
+
+    if((deviceObj->descriptorCacheEntry != NULL) && (deviceObj->requestedConfigurationNumber == 0))
+    {
+        if(_USB_HOST_DescriptorCacheEntryMatches(deviceObj->descriptorCacheEntry, deviceObj))
+        {
+            result = true;
+        }
+        else
+        {
+            deviceObj->descriptorCacheEntry = NULL;
+        }
+    }
+
+    return(result);
+}
+
+#endif
+
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_UpdateConfigurationState
+    (
+        USB_HOST_DEVICE_OBJ * deviceObj,
+        int busIndex
+    );
+
+  Summary:
+    This function will update the configuration state of the device.
+
+  Description:
+    This function will check if the device configuration needs to be changed. If
+    so then it gets the configuration, parses the configuration, sets up the
+    interface tables and then sets the configuration.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/    
+
+void _USB_HOST_UpdateConfigurationState
+(
+    USB_HOST_DEVICE_OBJ * deviceObj,
+    int busIndex
+)
+{
+    USB_HOST_BUS_OBJ * busObj;
+    USB_CONFIGURATION_DESCRIPTOR * configurationDescriptor;
+    USB_HOST_DEVICE_EVENT_CONFIGURATION_SET_DATA eventData;
+    int iterator;
+    uint8_t isSelfPowered;
+
+    busObj = &(gUSBHostBusList[busIndex]);
+    
+    /* This redundant statement is added to avoid warning in a case where the
+     * debug messages are disabled. */
+    busObj = busObj;
+    
+    /* Only proceed if the device is in a ready state */
+    if(deviceObj->deviceState == USB_HOST_DEVICE_STATE_READY)
+    {
+        switch(deviceObj->configurationState)
+        {
+            case USB_HOST_DEVICE_CONFIG_STATE_READY_FOR_CONFIG:
+
+                /* We don't have to do anything here. The state indicates that
+                 * the device is ready for configuration, but somebody has to
+                 * set it */
+
+                break;
+
+            case USB_HOST_DEVICE_CONFIG_STATE_START:
+
+                /* Start the process of setting the configuration. We first get
+                 * the configuration header. The requestedConfigurationNumber
+                 * member of deviceObj contains the index of the configuration to be
+                 * set */
+
+#if defined(USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER)
+                if(_USB_HOST_DescriptorCacheUsable(deviceObj))
+                {
+                    /* The configuration header is taken from the descriptor
+                     * cache. It was checked against the device at attach.
+                     * Complete the header request without a transfer. */
+                    memcpy(deviceObj->buffer, deviceObj->descriptorCacheEntry->configurationDescriptor, 9);
+                    deviceObj->controlTransferObj.controlIRP.status = USB_HOST_IRP_STATUS_COMPLETED;
+                    deviceObj->configurationState = USB_HOST_DEVICE_CONFIG_STATE_WAIT_FOR_CONFIG_DESCRIPTOR_HEADER_GET;
+                    break;
+                }
+#endif
+
+                _USB_HOST_FillSetupPacket(
+                        &(deviceObj->setupPacket),
+                        ( USB_SETUP_DIRN_DEVICE_TO_HOST |
+                          USB_SETUP_TYPE_STANDARD |
+                          USB_SETUP_RECIPIENT_DEVICE ),
+                        USB_REQUEST_GET_DESCRIPTOR,
+                        ( USB_DESCRIPTOR_CONFIGURATION << 8 )+ deviceObj->requestedConfigurationNumber , 0 , 9 ) ;
+
+                /* Fill IRP */
+                deviceObj->controlTransferObj.controlIRP.data = ( void * )deviceObj->buffer;
+                deviceObj->controlTransferObj.controlIRP.setup = &(deviceObj->setupPacket);
+                deviceObj->controlTransferObj.controlIRP.size = 9;
+                deviceObj->controlTransferObj.controlIRP.callback = NULL;
+
+                /* Set the next state */
+                deviceObj->configurationState = USB_HOST_DEVICE_CONFIG_STATE_WAIT_FOR_CONFIG_DESCRIPTOR_HEADER_GET;
+
+                /* Submit the IRP */
+                if(USB_ERROR_NONE != _USB_HOST_HCDIRPSubmit(deviceObj, deviceObj->controlPipeHandle, 
+                            &(deviceObj->controlTransferObj.controlIRP), 0, USB_TRANSFER_TYPE_CONTROL))
+                {
+                    /* We need to be able to send the IRP. We move the
+                     * device to an error state. Close the pipe and send
+                     * an event to the application. */
+                    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host Layer: Bus %d Device %d Configuration Descriptor IRP failed. Device not supported.", 
+                            busIndex, deviceObj->deviceAddress);
+                    deviceObj->deviceState = USB_HOST_DEVICE_STATE_ERROR;
+                    deviceObj->hcdInterface->hostPipeClose(deviceObj->controlPipeHandle);
+                    if(gUSBHostObj.hostEventHandler != NULL)
+                    {
+                        /* Send an event to the application */
+                        gUSBHostObj.hostEventHandler( USB_HOST_EVENT_DEVICE_UNSUPPORTED, NULL, gUSBHostObj.context );
+                    }
+                }
+
+                break;
+
+            case USB_HOST_DEVICE_CONFIG_STATE_WAIT_FOR_CONFIG_DESCRIPTOR_HEADER_GET:
+
+                /* Here we are waiting for Get Short Configuration header to
+                 * complete */
+                if (deviceObj->controlTransferObj.controlIRP.status == USB_HOST_IRP_STATUS_COMPLETED)
+                {
+                    if (deviceObj->hubAddress == 0x00 )
+                    {
+                        /* Check if the device is a self powered or bus powered    */
+                        configurationDescriptor = (USB_CONFIGURATION_DESCRIPTOR *)(deviceObj->buffer);
+                        isSelfPowered =  ( ( configurationDescriptor->bmAttributes ) & USB_ATTRIBUTE_SELF_POWERED );
+
+                        if (isSelfPowered != USB_ATTRIBUTE_SELF_POWERED )
+                        {
+                            /* This means the device is bus powered. We should check
+                             * if this configuration requires more current than what
+                             * the root hub can provide. */
+
+                            if ( 2 * ( configurationDescriptor->bMaxPower ) > busObj->rootHubInfo.power )
+                            {
+                                /* This means the device needs more power than what
+                                 * the root hub can provide. We cannot set this
+                                 * configuration. */
+
+                                if(deviceObj->deviceClientDriver != NULL)
+                                {
+                                    /* This means this device has device level
+                                     * driver and it is this driver that had
+                                     * requested for the configuration chanage.
+                                     * We let the driver know that the
+                                     * configuration cannot be set and then move
+                                     * the device to a ready but un-configured
+                                     * state.  This will allow the driver level
+                                     * driver to try setting another
+                                     * configuration. */
+
+                                    eventData.result = USB_HOST_RESULT_FAILURE;
+                                    deviceObj->deviceState = USB_HOST_DEVICE_STATE_READY;
+                                    deviceObj->configurationState = USB_HOST_DEVICE_CONFIG_STATE_READY_FOR_CONFIG;
+
+                                    /* We should send an event to the client
+                                     * driver result is failure  */
+                                    deviceObj->deviceClientDriver->deviceEventHandler(deviceObj->deviceClientHandle,
+                                            USB_HOST_DEVICE_EVENT_CONFIGURATION_SET, &eventData, deviceObj->controlTransferObj.context);
+                                }
+                                else
+                                {
+                                    /* The device does not have a devel lever
+                                     * client driver. This means the host layer
+                                     * owns the device. The host layer at this
+                                     * time cannot try any other configuration.
+                                     * The device must be moved to an
+                                     * in-operational state because of an
+                                     * over-current request. */
+
+                                    deviceObj->deviceState = USB_HOST_DEVICE_STATE_ERROR;
+                                }
+
+                                /* We should send an event to the application */
+                                if(gUSBHostObj.hostEventHandler != NULL)
+                                {
+                                    gUSBHostObj.hostEventHandler( USB_HOST_EVENT_DEVICE_REJECTED_INSUFFICIENT_POWER, NULL, gUSBHostObj.context );
 
                                 }
 
@@ -1007,7 +1764,7 @@ void _USB_HOST_UpdateConfigurationState
                  * descriptor */
                 if(deviceObj->configDescriptorInfo.configurationDescriptor != NULL)
                 {
-                    USB_HOST_FREE(deviceObj->configDescriptorInfo.configurationDescriptor);
+                    _USB_HOST_BufferFree(deviceObj->configDescriptorInfo.configurationDescriptor);
                 }
 
                 /* Now allocate memory. While allocating the memory, we allocate
@@ -1017,7 +1774,7 @@ void _USB_HOST_UpdateConfigurationState
                  * configuration descriptor */
 
                 configurationDescriptor = (USB_CONFIGURATION_DESCRIPTOR *)(deviceObj->buffer);
-                deviceObj->configDescriptorInfo.configurationDescriptor = USB_HOST_MALLOC(configurationDescriptor->wTotalLength + 7);
+                deviceObj->configDescriptorInfo.configurationDescriptor = _USB_HOST_BufferAllocate(USB_HOST_BUS_NUMBER(deviceObj->deviceIdentifier), configurationDescriptor->wTotalLength + 7);
 
                 if(deviceObj->configDescriptorInfo.configurationDescriptor == NULL)
                 {
@@ -1031,6 +1788,17 @@ void _USB_HOST_UpdateConfigurationState
                         gUSBHostObj.hostEventHandler( USB_HOST_EVENT_DEVICE_UNSUPPORTED, NULL, gUSBHostObj.context );
                     }
                 }
+#if defined(USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER)
+                else if(_USB_HOST_DescriptorCacheUsable(deviceObj))
+                {
+                    /* Take the configuration descriptor from the descriptor
+                     * cache and set the configuration */
+                    memcpy(deviceObj->configDescriptorInfo.configurationDescriptor, 
+                            deviceObj->descriptorCacheEntry->configurationDescriptor, configurationDescriptor->wTotalLength);
+                    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host Layer: Bus %d Device %d Configuration Descriptor taken from cache.", busIndex, deviceObj->deviceAddress);
+                    deviceObj->configurationState = USB_HOST_DEVICE_CONFIG_STATE_CONFIGURATION_SET;
+                }
+#endif
                 else
                 {
                     /* Place a request for the full configuration descriptor */
@@ -1047,8 +1815,8 @@ void _USB_HOST_UpdateConfigurationState
                     deviceObj->configurationState = USB_HOST_DEVICE_CONFIG_STATE_WAIT_FOR_CONFIG_DESCRIPTOR_GET;
 
                     /* Submit the IRP */
-                    if(USB_ERROR_NONE != deviceObj->hcdInterface->hostIRPSubmit( deviceObj->controlPipeHandle, 
-                                &(deviceObj->controlTransferObj.controlIRP)))
+                    if(USB_ERROR_NONE != _USB_HOST_HCDIRPSubmit(deviceObj, deviceObj->controlPipeHandle, 
+                                &(deviceObj->controlTransferObj.controlIRP), 0, USB_TRANSFER_TYPE_CONTROL))
                     {
                         /* We need to be able to send the IRP. We move the
                          * device to an error state. Close the pipe and send
@@ -1115,8 +1883,8 @@ void _USB_HOST_UpdateConfigurationState
                 deviceObj->configurationState = USB_HOST_DEVICE_CONFIG_STATE_WAIT_FOR_CONFIGURATION_SET;
 
                 /* Submit the IRP */
-                if(USB_ERROR_NONE != deviceObj->hcdInterface->hostIRPSubmit( deviceObj->controlPipeHandle, 
-                            &(deviceObj->controlTransferObj.controlIRP)))
+                if(USB_ERROR_NONE != _USB_HOST_HCDIRPSubmit(deviceObj, deviceObj->controlPipeHandle, 
+                            &(deviceObj->controlTransferObj.controlIRP), 0, USB_TRANSFER_TYPE_CONTROL))
                 {
                     /* We need to be able to send the IRP. We move the
                      * device to an error state. Close the pipe and send
@@ -1168,6 +1936,15 @@ void _USB_HOST_UpdateConfigurationState
 
                         deviceObj->configDescriptorInfo.configurationNumber = deviceObj->configDescriptorInfo.configurationDescriptor->bConfigurationValue;
                         eventData.result = USB_HOST_RESULT_SUCCESS;
+
+#if defined(USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER)
+                        if((deviceObj->requestedConfigurationNumber == 0) && (deviceObj->descriptorCacheEntry == NULL))
+                        {
+                            /* The first configuration was read from the
+                             * device. Cache it for the next attach. */
+                            _USB_HOST_DescriptorCacheAdd(deviceObj);
+                        }
+#endif
                     }
 
                     /* If there is device level client driver, then we let it
@@ -1248,7 +2025,6 @@ void _USB_HOST_UpdateDeviceOwnership
 )
 {
     int tplSearch;
-    USB_HOST_TPL_ENTRY * tpl;
     USB_DEVICE_DESCRIPTOR * deviceDescriptor;
     USB_HOST_BUS_OBJ * busObj;
 
@@ -1280,51 +2056,13 @@ void _USB_HOST_UpdateDeviceOwnership
              * TPL table */
 
             SYS_DEBUG_PRINT(SYS_ERROR_INFO,"\r\nUSB Host Layer: Bus %d Device %d Looking for Device Level Driver.", busIndex, deviceObj->deviceAddress);
-            for (tplSearch = (deviceObj->tplEntryTried + 1); tplSearch < gUSBHostObj.nTPLEntries; tplSearch ++)
+            tplSearch = _USB_HOST_FindVIDPIDDriver(deviceDescriptor->idVendor, deviceDescriptor->idProduct, (deviceObj->tplEntryTried + 1));
+            if(tplSearch < gUSBHostObj.nTPLEntries)
             {
-                tpl = &gUSBHostObj.tpl[tplSearch];
-
-                if(tpl->tplFlags.driverType == TPL_FLAG_VID_PID)
-                {
-                    /* This entry is a VID PID Entry */
-
-                    if(tpl->tplFlags.ignoreVIDPID)
-                    {
-                        /* This means we should attach this driver as the entry says
-                         * that ignore the VID PID and match */
-
-                        SYS_DEBUG_PRINT(SYS_ERROR_INFO,"\r\nUSB Host Layer: Bus %d Device %d matched entry %d in TPL table", 
-                                busIndex, deviceObj->deviceAddress, tplSearch);
-
-                        deviceObj->deviceClientDriver = (USB_HOST_CLIENT_DRIVER *)(tpl->hostClientDriver);
-                        break;
-                    }
-                    else if(tpl->tplFlags.pidMasked)
-                    {
-                        /* This means we should apply the specified mask to the PID
-                         * field and then compare. */
-
-                        if((deviceDescriptor->idVendor == tpl->id.vid_pid.vid) && 
-                                ((deviceDescriptor->idProduct & tpl->pidMask) == tpl->id.vid_pid.pid))
-                        {
-                            /* Criteria matched */
-                            SYS_DEBUG_PRINT(SYS_ERROR_INFO,"\r\nUSB Host Layer: Bus %d Device %d matched entry %d in TPL table", 
-                                    busIndex, deviceObj->deviceAddress, tplSearch);
-
-                            deviceObj->deviceClientDriver = (USB_HOST_CLIENT_DRIVER *)(tpl->hostClientDriver);
-                            break;
-                        }
-                    }
-                    else if((deviceDescriptor->idVendor == tpl->id.vid_pid.vid) && 
-                            (deviceDescriptor->idProduct == tpl->id.vid_pid.pid))
-                    {
-                        /* Criteria matched */
-                        SYS_DEBUG_PRINT(SYS_ERROR_INFO,"\r\nUSB Host Layer: Bus %d Device %d matched entry %d in TPL table", 
-                                busIndex, deviceObj->deviceAddress, tplSearch);
-                        deviceObj->deviceClientDriver = (USB_HOST_CLIENT_DRIVER *)(tpl->hostClientDriver);
-                        break;
-                    }
-                }
+                /* Criteria matched */
+                SYS_DEBUG_PRINT(SYS_ERROR_INFO,"\r\nUSB Host Layer: Bus %d Device %d matched entry %d in TPL table", 
+                        busIndex, deviceObj->deviceAddress, tplSearch);
+                deviceObj->deviceClientDriver = (USB_HOST_CLIENT_DRIVER *)(gUSBHostObj.tpl[tplSearch].hostClientDriver);
             }
 
             if(deviceObj->deviceClientDriver != NULL)
@@ -1546,7 +2284,7 @@ USB_HOST_RESULT USB_HOST_DeviceControlTransfer
                 deviceObj->controlTransferObj.context = context;
                 deviceObj->controlTransferObj.callback = (void*)callback;
 
-                if(USB_ERROR_NONE != deviceObj->hcdInterface->hostIRPSubmit( deviceObj->controlPipeHandle, &(deviceObj->controlTransferObj.controlIRP)))
+                if(USB_ERROR_NONE != _USB_HOST_HCDIRPSubmit(deviceObj, deviceObj->controlPipeHandle, &(deviceObj->controlTransferObj.controlIRP), 0, USB_TRANSFER_TYPE_CONTROL))
                 {
                     /* There was a problem while submitting the IRP. Update the result and
                      * the transfer handle. Return the control transfer object back to the
@@ -1921,7 +2659,7 @@ void _USB_HOST_MakeDeviceReady
                      * configuration descriptor. */
                     if(deviceObj->configDescriptorInfo.configurationDescriptor != NULL)
                     {
-                        USB_HOST_FREE(deviceObj->configDescriptorInfo.configurationDescriptor);
+                        _USB_HOST_BufferFree(deviceObj->configDescriptorInfo.configurationDescriptor);
                         deviceObj->configDescriptorInfo.configurationDescriptor = NULL;
                     }
 
@@ -1929,7 +2667,7 @@ void _USB_HOST_MakeDeviceReady
                      * but we double check this here just to be safe. */
                     if(deviceObj->holdingConfigurationDescriptor != NULL)
                     {
-                        USB_HOST_FREE(deviceObj->holdingConfigurationDescriptor);
+                        _USB_HOST_BufferFree(deviceObj->holdingConfigurationDescriptor);
                         deviceObj->holdingConfigurationDescriptor = NULL;
                     }
 
@@ -2021,8 +2759,8 @@ void _USB_HOST_MakeDeviceReady
                         SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host Layer: Bus %d Requesting Device Descriptor.", busIndex);
 
                         /* Submit the IRP */
-                        if(USB_ERROR_NONE != deviceObj->hcdInterface->hostIRPSubmit(deviceObj->controlPipeHandle, 
-                                    &(deviceObj->controlTransferObj.controlIRP)))
+                        if(USB_ERROR_NONE != _USB_HOST_HCDIRPSubmit(deviceObj, deviceObj->controlPipeHandle, 
+                                    &(deviceObj->controlTransferObj.controlIRP), 0, USB_TRANSFER_TYPE_CONTROL))
                         {
                             /* We need to be able to send the IRP. We move the
                              * device to an error state. Close the pipe and send
@@ -2121,7 +2859,7 @@ void _USB_HOST_MakeDeviceReady
                 SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host Layer: Bus %d Setting Device Address to %d.", busIndex, deviceObj->deviceAddress);
 
                 /* Submit the IRP */
-                if(USB_ERROR_NONE != deviceObj->hcdInterface->hostIRPSubmit( deviceObj->controlPipeHandle, & (deviceObj->controlTransferObj.controlIRP)))
+                if(USB_ERROR_NONE != _USB_HOST_HCDIRPSubmit(deviceObj, deviceObj->controlPipeHandle, & (deviceObj->controlTransferObj.controlIRP), 0, USB_TRANSFER_TYPE_CONTROL))
                 {
                     /* We need to be able to send the IRP. We move the device to
                      * an error state. Close the pipe and send an event to the
@@ -2194,6 +2932,13 @@ void _USB_HOST_MakeDeviceReady
                         /* The pipe was opened and we can continue with the
                          * rest of the enumeration */
                         deviceObj->deviceState = USB_HOST_DEVICE_STATE_POST_SET_ADDRESS_DELAY;
+
+                        /* The device does not respond at the default address
+                         * anymore. Release the device is enumerating flag so
+                         * that another device can be reset and addressed
+                         * while this device completes the rest of its
+                         * enumeration on its own address. */
+                        busObj->deviceIsEnumerating = false;
                     }
                 }
                 else
@@ -2248,11 +2993,12 @@ void _USB_HOST_MakeDeviceReady
             case USB_HOST_DEVICE_STATE_POST_SET_ADDRESS_DELAY:
 
                 /* After the address has been set, we provide a delay of 50
-                 * milliseconds */
-                busObj->timerExpired = false;
-                busObj->busOperationsTimerHandle = SYS_TMR_CallbackSingle( 50, (uintptr_t ) busObj, _USB_HOST_TimerCallback);;
+                 * milliseconds. The bus timer is used by the device that is
+                 * being reset and so this delay uses the device timer. */
+                deviceObj->timerExpired = false;
+                deviceObj->deviceOperationsTimerHandle = SYS_TMR_CallbackSingle( 50, (uintptr_t ) deviceObj, _USB_HOST_DeviceTimerCallback);
 
-                if(SYS_TMR_HANDLE_INVALID != busObj->busOperationsTimerHandle)
+                if(SYS_TMR_HANDLE_INVALID != deviceObj->deviceOperationsTimerHandle)
                 {
                     deviceObj->deviceState = USB_HOST_DEVICE_STATE_WAITING_POST_SET_ADDRESS_DELAY;
                 }
@@ -2262,9 +3008,9 @@ void _USB_HOST_MakeDeviceReady
 
                 /* Here we check if the post device set address delay has
                  * completed */
-                if(busObj->timerExpired)
+                if(deviceObj->timerExpired)
                 {
-                    busObj->busOperationsTimerHandle = SYS_TMR_HANDLE_INVALID ;
+                    deviceObj->deviceOperationsTimerHandle = SYS_TMR_HANDLE_INVALID ;
                     SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host Layer: Bus %d Post Set Address Delay completed.", busIndex);
                     SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host Layer: Bus %d Device %d Requesting Full Device Descriptor.", busIndex, deviceObj->deviceAddress);
                     deviceObj->deviceState = USB_HOST_DEVICE_STATE_GET_DEVICE_DESCRIPTOR_FULL;
@@ -2287,7 +3033,7 @@ void _USB_HOST_MakeDeviceReady
                 deviceObj->deviceState = USB_HOST_DEVICE_STATE_WAITING_FOR_GET_DEVICE_DESCRIPTOR_FULL;
 
                 /* Submit the IRP */
-                if(USB_ERROR_NONE != deviceObj->hcdInterface->hostIRPSubmit( deviceObj->controlPipeHandle, &(deviceObj->controlTransferObj.controlIRP)))
+                if(USB_ERROR_NONE != _USB_HOST_HCDIRPSubmit(deviceObj, deviceObj->controlPipeHandle, &(deviceObj->controlTransferObj.controlIRP), 0, USB_TRANSFER_TYPE_CONTROL))
                 {
                     /* We need to be able to send the IRP. We move the device to
                      * an error state. Close the pipe and send an event to the
@@ -2301,10 +3047,6 @@ void _USB_HOST_MakeDeviceReady
                         /* Send an event to the application */
                         gUSBHostObj.hostEventHandler( USB_HOST_EVENT_DEVICE_UNSUPPORTED, NULL, gUSBHostObj.context );
                     }
-
-                    /* Release the device is enumerating flag. Another device
-                     * can start enumerating. */
-                    busObj->deviceIsEnumerating = false;
                 }
                 break;
 
@@ -2339,12 +3081,6 @@ void _USB_HOST_MakeDeviceReady
                         /* Close the pipe */
                         deviceObj->hcdInterface->hostPipeClose(deviceObj->controlPipeHandle);
 
-                        /* Release the device is enumerating flag. This will give
-                         * another device the chance to start enumerating. The
-                         * enumeration of this device will be re-attempted after
-                         * the possible enumeration of the other device. */
-                        busObj->deviceIsEnumerating = false;
-
                         /* Should we retry */
                         if (deviceObj->enumerationFailCount < USB_HOST_ENUMERATION_RETRY_COUNT )
                         {
@@ -2395,8 +3131,8 @@ void _USB_HOST_MakeDeviceReady
                 deviceObj->deviceState = USB_HOST_DEVICE_STATE_WAITING_FOR_GET_CONFIGURATION_DESCRIPTOR_SHORT;
 
                 /* Submit the IRP */
-                if(USB_ERROR_NONE != deviceObj->hcdInterface->hostIRPSubmit( deviceObj->controlPipeHandle, 
-                            &(deviceObj->controlTransferObj.controlIRP)))
+                if(USB_ERROR_NONE != _USB_HOST_HCDIRPSubmit(deviceObj, deviceObj->controlPipeHandle, 
+                            &(deviceObj->controlTransferObj.controlIRP), 0, USB_TRANSFER_TYPE_CONTROL))
                 {
                     /* We need to be able to send the IRP. We move the device to
                      * an error state. Close the pipe and send an event to the
@@ -2410,10 +3146,6 @@ void _USB_HOST_MakeDeviceReady
                         /* Send an event to the application */
                         gUSBHostObj.hostEventHandler( USB_HOST_EVENT_DEVICE_UNSUPPORTED, NULL, gUSBHostObj.context );
                     }
-
-                    /* Release the device is enumerating flag. Another
-                     * device can start enumerating. */
-                    busObj->deviceIsEnumerating = false;
                 }
 
                 break;
@@ -2424,6 +3156,29 @@ void _USB_HOST_MakeDeviceReady
                 if (deviceObj->controlTransferObj.controlIRP.status == USB_HOST_IRP_STATUS_COMPLETED)
                 {
                     SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host Layer: Bus %d Device %d Short Configuration Descriptor Request passed.", busIndex, deviceObj->deviceAddress);
+
+#if defined(USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER)
+                    if(deviceObj->configurationCheckCount == 0)
+                    {
+                        /* Check if this device was enumerated before. The
+                         * device descriptor, speed and header of the first
+                         * configuration must match the cache entry. */
+                        deviceObj->descriptorCacheEntry = _USB_HOST_DescriptorCacheFind(deviceObj);
+                        if(deviceObj->descriptorCacheEntry != NULL)
+                        {
+                            /* The configurations were checked when the entry
+                             * was created. The device is ready. */
+                            SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host Layer: Bus %d Device %d found in descriptor cache.", busIndex, deviceObj->deviceAddress);
+                            deviceObj->enumerationFailCount = 0x00;
+                            deviceObj->deviceState = USB_HOST_DEVICE_STATE_READY;
+
+                            /* Release the control transfer object */
+                            deviceObj->controlTransferObj.inUse = false;
+                            break;
+                        }
+                    }
+#endif
+
                     SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host Layer: Bus %d Device %d Getting Full Configuration Descriptor.", busIndex, deviceObj->deviceAddress);
 
                     /* IRP was successful. Go to the next state */
@@ -2440,12 +3195,6 @@ void _USB_HOST_MakeDeviceReady
                         /* Close the pipe */
                         deviceObj->hcdInterface->hostPipeClose(deviceObj->controlPipeHandle);
 
-                        /* Release the device is enumerating flag. This will give
-                         * another device the chance to start enumerating. The
-                         * enumeration of this device will be re-attempted after
-                         * the possible enumeration of the other device. */
-                        busObj->deviceIsEnumerating = false;
-
                         /* Should we retry */
                         if (deviceObj->enumerationFailCount < USB_HOST_ENUMERATION_RETRY_COUNT )
                         {
@@ -2484,7 +3233,7 @@ void _USB_HOST_MakeDeviceReady
                  * descriptor. */  
 
                 configurationDescriptor = (USB_CONFIGURATION_DESCRIPTOR *)(deviceObj->buffer);
-                deviceObj->holdingConfigurationDescriptor = USB_HOST_MALLOC(configurationDescriptor->wTotalLength);
+                deviceObj->holdingConfigurationDescriptor = _USB_HOST_BufferAllocate(USB_HOST_BUS_NUMBER(deviceObj->deviceIdentifier), configurationDescriptor->wTotalLength);
 
                 if(deviceObj->holdingConfigurationDescriptor == NULL)
                 {
@@ -2497,10 +3246,6 @@ void _USB_HOST_MakeDeviceReady
                         SYS_DEBUG_PRINT(SYS_ERROR_DEBUG, "\r\nUSB Host Layer: Bus %d Device %d. Insufficient memory for Configuration Descriptor", busIndex, deviceObj->deviceAddress);
                         gUSBHostObj.hostEventHandler( USB_HOST_EVENT_DEVICE_UNSUPPORTED , NULL, gUSBHostObj.context );
                     }
-
-                    /* Release the device is enumerating flag. Another
-                     * device can start enumerating. */
-                    busObj->deviceIsEnumerating = false;
                 }
                 else
                 {
@@ -2522,8 +3267,8 @@ void _USB_HOST_MakeDeviceReady
                     deviceObj->deviceState = USB_HOST_DEVICE_STATE_WAITING_FOR_GET_CONFIGURATION_DESCRIPTOR_FULL;
 
                     /* Submit the IRP */
-                    if(USB_ERROR_NONE != deviceObj->hcdInterface->hostIRPSubmit( deviceObj->controlPipeHandle, 
-                                &(deviceObj->controlTransferObj.controlIRP)))
+                    if(USB_ERROR_NONE != _USB_HOST_HCDIRPSubmit(deviceObj, deviceObj->controlPipeHandle, 
+                                &(deviceObj->controlTransferObj.controlIRP), 0, USB_TRANSFER_TYPE_CONTROL))
                     {
                         /* We need to be able to send the IRP. We move the
                          * device to an error state. Close the pipe and send an
@@ -2531,7 +3276,7 @@ void _USB_HOST_MakeDeviceReady
                         SYS_DEBUG_PRINT(SYS_ERROR_DEBUG, "\r\nUSB Host Layer: Bus %d Device %d Configuration Request IRP failed. Device not supported.", busIndex, deviceObj->deviceAddress);
                         deviceObj->deviceState = USB_HOST_DEVICE_STATE_ERROR;
                         deviceObj->hcdInterface->hostPipeClose(deviceObj->controlPipeHandle);
-                        USB_HOST_FREE(deviceObj->holdingConfigurationDescriptor);
+                        _USB_HOST_BufferFree(deviceObj->holdingConfigurationDescriptor);
                         deviceObj->holdingConfigurationDescriptor = NULL;
 
                         if(gUSBHostObj.hostEventHandler != NULL)
@@ -2539,10 +3284,6 @@ void _USB_HOST_MakeDeviceReady
                             /* Send an event to the application */
                             gUSBHostObj.hostEventHandler( USB_HOST_EVENT_DEVICE_UNSUPPORTED, NULL, gUSBHostObj.context );
                         }
-
-                        /* Release the device is enumerating flag. Another
-                         * device can start enumerating. */
-                        busObj->deviceIsEnumerating = false;
                     }
                 }
 
@@ -2586,10 +3327,6 @@ void _USB_HOST_MakeDeviceReady
 
                             /* Release the control transfer object */
                             deviceObj->controlTransferObj.inUse = false;
-
-                            /* Release the device is enumerating flag. Another
-                             * device can start enumerating. */
-                            busObj->deviceIsEnumerating = false;
                         }
                         else
                         {
@@ -2600,7 +3337,7 @@ void _USB_HOST_MakeDeviceReady
                         }
 
                         /* Free up the allocated memory */
-                        USB_HOST_FREE(deviceObj->holdingConfigurationDescriptor);
+                        _USB_HOST_BufferFree(deviceObj->holdingConfigurationDescriptor);
                         deviceObj->holdingConfigurationDescriptor = NULL;
                     }
                     else
@@ -2612,18 +3349,14 @@ void _USB_HOST_MakeDeviceReady
 
                         deviceObj->deviceState = USB_HOST_DEVICE_STATE_ERROR;
                         deviceObj->hcdInterface->hostPipeClose(deviceObj->controlPipeHandle);
-                        USB_HOST_FREE(deviceObj->holdingConfigurationDescriptor);
+                        _USB_HOST_BufferFree(deviceObj->holdingConfigurationDescriptor);
                         deviceObj->holdingConfigurationDescriptor = NULL;
                         if(gUSBHostObj.hostEventHandler != NULL)
                         {
                             SYS_DEBUG_PRINT(SYS_ERROR_DEBUG, "\r\nUSB Host Layer: Bus %d Device %d Errors detected in Configuration Descriptor %d. Device not supported", busIndex, deviceObj->deviceAddress, deviceObj->configurationCheckCount);
 
                             gUSBHostObj.hostEventHandler(USB_HOST_EVENT_DEVICE_UNSUPPORTED, NULL, gUSBHostObj.context);
-                        }
-
-                        /* Release the device is enumerating flag. Another
-                         * device can start enumerating. */
-                        busObj->deviceIsEnumerating = false;
+                        }
                     }
                 }
                 else
@@ -2632,12 +3365,7 @@ void _USB_HOST_MakeDeviceReady
                     {
                         deviceObj->hcdInterface->hostPipeClose(deviceObj->controlPipeHandle);
 
-                        /* Release the device is enumerating flag. This will give
-                         * another device the chance to start enumerating. The
-                         * enumeration of this device will be re-attempted after
-                         * the possible enumeration of the other device. */
-                        busObj->deviceIsEnumerating = false;
-                        USB_HOST_FREE(deviceObj->holdingConfigurationDescriptor);
+                        _USB_HOST_BufferFree(deviceObj->holdingConfigurationDescriptor);
                         deviceObj->holdingConfigurationDescriptor = NULL;
 
                         if (deviceObj->enumerationFailCount < USB_HOST_ENUMERATION_RETRY_COUNT )
@@ -3025,57 +3753,496 @@ void  _USB_HOST_DeviceControlTransferCallback( USB_HOST_IRP * irp )
 
             break;
 
-        case USB_HOST_CONTROL_REQUEST_TYPE_STRING_DESCRIPTOR:
+        case USB_HOST_CONTROL_REQUEST_TYPE_STRING_DESCRIPTOR:
+
+            /* This request originated from the application. The context and the
+             * callback field of the control transfer object contain callback
+             * and context specified by the application. */
+
+            if(controlTransferObj->callback != NULL)
+            {
+                /* This means we have a callback that we can call */
+                if(result == USB_HOST_RESULT_SUCCESS)
+                {
+                    ((USB_HOST_STRING_REQUEST_COMPLETE_CALLBACK)(controlTransferObj->callback))
+                        ((USB_HOST_REQUEST_HANDLE)controlTransferObj, irp->size, controlTransferObj->context);
+
+                }
+                else
+                {
+                    /* The string descriptor request failed. Invoke the callback
+                     * with string size as 0 */
+                    ((USB_HOST_STRING_REQUEST_COMPLETE_CALLBACK)(controlTransferObj->callback))
+                        ((USB_HOST_REQUEST_HANDLE)controlTransferObj, irp->size, controlTransferObj->context);
+                }
+            }
+
+            break;
+
+        case USB_HOST_CONTROL_REQUEST_TYPE_CONFIGURATION_DESCRIPTOR_GET:
+
+            /* This request originated from the client driver. An event should
+             * be sent to the device level event handler. Populate the event
+             * data. */
+
+            configurationGetCompleteData.requestHandle = (USB_HOST_REQUEST_HANDLE)(&deviceObj->controlTransferObj);
+            configurationGetCompleteData.result = result; 
+            
+            if(deviceObj->deviceClientDriver != NULL)
+            {
+                deviceObj->deviceClientDriver->deviceEventHandler(deviceObj->deviceClientHandle,
+                        USB_HOST_DEVICE_EVENT_CONFIGURATION_DESCRIPTOR_GET_COMPLETE, &configurationGetCompleteData, 
+                        deviceObj->controlTransferObj.context);
+            }
+
+
+        default:
+            break;
+    }
+
+    /* Release the control transfer object back */
+    controlTransferObj->inUse = false;
+}
+
+#if defined(USB_HOST_TRACE_RECORDS_NUMBER)
+
+// *****************************************************************************
+/* Function:
+    USB_HOST_TRACE_IRP_INFO * _USB_HOST_TraceIRPInfoGet( USB_HOST_IRP * irp )
+
+  Summary:
+    Returns the trace information object of an IRP.
+
+  Description:
+    The host layer submits only the control IRPs of the device objects and the
+    IRPs of the transfer objects. The trace information object is found from
+    the position of the IRP in these arrays.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static USB_HOST_TRACE_IRP_INFO * _USB_HOST_TraceIRPInfoGet( USB_HOST_IRP * irp )
+{
+    uintptr_t address = (uintptr_t)irp;
+    uintptr_t base;
+    USB_HOST_TRACE_IRP_INFO * result = NULL;
+
+    base = (uintptr_t)(&gUSBHostDeviceList[0].controlTransferObj.controlIRP);
+    if((address >= base) && (address < (base + sizeof(gUSBHostDeviceList))))
+    {
+        result = &gUSBHostTraceObj.irpInfo[(address - base) / sizeof(USB_HOST_DEVICE_OBJ)];
+    }
+    else
+    {
+        base = (uintptr_t)(&gUSBHostTransferObj[0].irp);
+        if((address >= base) && (address < (base + sizeof(gUSBHostTransferObj))))
+        {
+            result = &gUSBHostTraceObj.irpInfo[(USB_HOST_CONTROLLERS_NUMBER + USB_HOST_DEVICES_NUMBER) 
+                + ((address - base) / sizeof(USB_HOST_TRANSFER_OBJ))];
+        }
+    }
+
+    return(result);
+}
+
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_TraceRecordAdd
+    (
+        USB_HOST_TRACE_EVENT event,
+        USB_HOST_IRP * irp,
+        USB_HOST_TRACE_IRP_INFO * irpInfo
+    )
+
+  Summary:
+    Adds a record to the trace.
+
+  Description:
+    This function adds a record for the IRP to the trace ring. The event is
+    counted as lost if the ring is full.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application. This function is called from the host layer tasks and from
+    the IRP callbacks.
+*/
+
+static void _USB_HOST_TraceRecordAdd
+(
+    USB_HOST_TRACE_EVENT event,
+    USB_HOST_IRP * irp,
+    USB_HOST_TRACE_IRP_INFO * irpInfo
+)
+{
+    USB_HOST_TRACE_RECORD * record;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    uint64_t timeStamp;
+
+    timeStamp = SYS_TIME_Counter64Get();
+
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+    if(gUSBHostTraceObj.count >= USB_HOST_TRACE_RECORDS_NUMBER)
+    {
+        gUSBHostTraceObj.lostCount ++;
+    }
+    else
+    {
+        record = &gUSBHostTraceObj.record[gUSBHostTraceObj.writeIndex];
+
+        record->timeStamp = timeStamp;
+        record->id = (uint32_t)((uintptr_t)irp);
+        record->length = irp->size;
+        record->status = (int8_t)((event == USB_HOST_TRACE_EVENT_SUBMIT) ? USB_HOST_IRP_STATUS_IN_PROGRESS : irp->status);
+        record->event = (uint8_t)event;
+        record->transferType = irpInfo->transferType;
+        record->bus = irpInfo->bus;
+        record->deviceAddress = irpInfo->deviceAddress;
+        record->endpoint = irpInfo->endpoint;
+        record->setupValid = ((event == USB_HOST_TRACE_EVENT_SUBMIT) && (irp->setup != NULL));
+
+        if(record->setupValid)
+        {
+            memcpy(record->setup, irp->setup, sizeof(record->setup));
+        }
+
+        gUSBHostTraceObj.writeIndex = (gUSBHostTraceObj.writeIndex + 1) % USB_HOST_TRACE_RECORDS_NUMBER;
+        gUSBHostTraceObj.count ++;
+    }
+
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+}
+
+// *****************************************************************************
+/* Function:
+    USB_ERROR _USB_HOST_TraceIRPSubmit
+    (
+        USB_HOST_DEVICE_OBJ * deviceObj,
+        DRV_USB_HOST_PIPE_HANDLE drvPipeHandle,
+        USB_HOST_IRP * irp,
+        USB_ENDPOINT_ADDRESS endpoint,
+        USB_TRANSFER_TYPE transferType
+    )
+
+  Summary:
+    Submits an IRP to the HCD and adds it to the trace.
+
+  Description:
+    Submits an IRP to the HCD and adds it to the trace.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+USB_ERROR _USB_HOST_TraceIRPSubmit
+(
+    USB_HOST_DEVICE_OBJ * deviceObj,
+    DRV_USB_HOST_PIPE_HANDLE drvPipeHandle,
+    USB_HOST_IRP * irp,
+    USB_ENDPOINT_ADDRESS endpoint,
+    USB_TRANSFER_TYPE transferType
+)
+{
+    USB_HOST_TRACE_IRP_INFO * irpInfo;
+    USB_SETUP_PACKET * setupPacket;
+    USB_ERROR result;
+
+    irpInfo = _USB_HOST_TraceIRPInfoGet(irp);
+
+    if(irpInfo == NULL)
+    {
+        /* This IRP cannot be traced */
+        return(deviceObj->hcdInterface->hostIRPSubmit(drvPipeHandle, irp));
+    }
+
+    irpInfo->bus = (uint8_t)USB_HOST_BUS_NUMBER(deviceObj->deviceIdentifier);
+    irpInfo->deviceAddress = deviceObj->deviceAddress;
+    irpInfo->endpoint = endpoint;
+    irpInfo->transferType = (uint8_t)transferType;
+
+    if((transferType == USB_TRANSFER_TYPE_CONTROL) && (irp->setup != NULL))
+    {
+        setupPacket = (USB_SETUP_PACKET *)(irp->setup);
+
+        /* The direction of a control transfer is given by the setup packet */
+        irpInfo->endpoint |= (setupPacket->bmRequestType & USB_SETUP_DIRN_DEVICE_TO_HOST);
+
+        if((setupPacket->bmRequestType == 0) && (setupPacket->bRequest == USB_REQUEST_SET_ADDRESS))
+        {
+            /* The device address is updated before the Set Address request
+             * is sent. The request goes to the default address. */
+            irpInfo->deviceAddress = USB_HOST_DEFAULT_ADDRESS;
+        }
+    }
+
+    /* The IRP callback is replaced before the IRP is submitted, because the
+     * IRP can complete before the submit function returns. */
+    irpInfo->callback = irp->callback;
+    irp->callback = _USB_HOST_TraceIRPCallback;
+
+    _USB_HOST_TraceRecordAdd(USB_HOST_TRACE_EVENT_SUBMIT, irp, irpInfo);
+
+    result = deviceObj->hcdInterface->hostIRPSubmit(drvPipeHandle, irp);
+
+    if(result != USB_ERROR_NONE)
+    {
+        /* The HCD did not accept the IRP */
+        irp->callback = irpInfo->callback;
+        _USB_HOST_TraceRecordAdd(USB_HOST_TRACE_EVENT_SUBMIT_ERROR, irp, irpInfo);
+    }
+
+    return(result);
+}
+
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_TraceIRPCallback( USB_HOST_IRP * irp )
+
+  Summary:
+    IRP callback that adds the completion record to the trace.
+
+  Description:
+    IRP callback that adds the completion record to the trace.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+void _USB_HOST_TraceIRPCallback( USB_HOST_IRP * irp )
+{
+    USB_HOST_TRACE_IRP_INFO * irpInfo;
+
+    irpInfo = _USB_HOST_TraceIRPInfoGet(irp);
+
+    if(irpInfo != NULL)
+    {
+        _USB_HOST_TraceRecordAdd(USB_HOST_TRACE_EVENT_COMPLETE, irp, irpInfo);
+
+        /* Restore the callback before calling it, so that the IRP can be
+         * submitted again from the callback. IRPs without a callback are
+         * polled by the host layer tasks. */
+        irp->callback = irpInfo->callback;
+
+        if(irp->callback != NULL)
+        {
+            irp->callback(irp);
+        }
+    }
+}
+
+#endif
+
+#if defined(USB_HOST_MEMORY_POOL_ENABLE)
+
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_MemoryPoolAccount
+    (
+        uint8_t bus,
+        int classIndex,
+        uint32_t size,
+        bool allocate
+    )
+
+  Summary:
+    Updates the memory pool accounting of a bus and of all buses.
+
+  Description:
+    This function updates the blocks and bytes in use and their high water
+    marks when a block is allocated or freed. It must be called with
+    interrupts disabled.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static void _USB_HOST_MemoryPoolAccount
+(
+    uint8_t bus,
+    int classIndex,
+    uint32_t size,
+    bool allocate
+)
+{
+    USB_HOST_MEMORY_POOL_STATUS * status;
+    int iterator;
+
+    for(iterator = 0; iterator < 2; iterator ++)
+    {
+        /* The bus entry is updated first, then the entry of all buses */
+        status = &gUSBHostMemoryPoolObj.status[(iterator == 0) ? bus : USB_HOST_CONTROLLERS_NUMBER];
+
+        if(allocate)
+        {
+            status->allocations ++;
+            status->blocksInUse[classIndex] ++;
+            status->bytesInUse += size;
+
+            if(status->blocksInUse[classIndex] > status->blocksHighWaterMark[classIndex])
+            {
+                status->blocksHighWaterMark[classIndex] = status->blocksInUse[classIndex];
+            }
+
+            if(status->bytesInUse > status->bytesHighWaterMark)
+            {
+                status->bytesHighWaterMark = status->bytesInUse;
+            }
+        }
+        else
+        {
+            status->blocksInUse[classIndex] --;
+            status->bytesInUse -= size;
+        }
+    }
+}
+
+// *****************************************************************************
+/* Function:
+    void * _USB_HOST_MemoryPoolAllocate
+    (
+        uint8_t bus,
+        size_t size
+    )
+
+  Summary:
+    Allocates a buffer from the host layer memory pool.
+
+  Description:
+    Allocates a buffer from the host layer memory pool.
+
+  Remarks:
+    Refer to usb_host_local.h for usage information.
+*/
+
+void * _USB_HOST_MemoryPoolAllocate
+(
+    uint8_t bus,
+    size_t size
+)
+{
+    void * result = NULL;
+    const USB_HOST_MEMORY_POOL_CLASS_INFO * classInfo;
+    USB_HOST_MEMORY_POOL_BLOCK_INFO * blockInfo;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    bool injectFailure = false;
+    int classIndex;
+    uint32_t blockIndex;
+
+    if((bus >= USB_HOST_CONTROLLERS_NUMBER) || (size == 0))
+    {
+        /* Not a valid request */
+        SYS_DEBUG_PRINT(SYS_ERROR_DEBUG, "\r\nUSB Host Layer: Invalid memory pool request of %d bytes on bus %d.", (int)size, bus);
+    }
+    else
+    {
+        IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+        if(gUSBHostMemoryPoolObj.failureInterval != 0)
+        {
+            /* Failure injection is active. Check if this allocation should
+             * fail. */
+            gUSBHostMemoryPoolObj.failureCount ++;
+            if(gUSBHostMemoryPoolObj.failureCount >= gUSBHostMemoryPoolObj.failureInterval)
+            {
+                gUSBHostMemoryPoolObj.failureCount = 0;
+                injectFailure = true;
+            }
+        }
+
+        /* Take the first free block of the smallest class that fits. If
+         * the class is exhausted, the next larger class is tried. */
+        for(classIndex = 0; (!injectFailure) && (result == NULL) && (classIndex < USB_HOST_MEMORY_POOL_CLASSES_NUMBER); classIndex ++)
+        {
+            classInfo = &gUSBHostMemoryPoolClass[classIndex];
+            if(size <= classInfo->blockSize)
+            {
+                for(blockIndex = 0; blockIndex < classInfo->blocksNumber; blockIndex ++)
+                {
+                    blockInfo = &gUSBHostMemoryPoolObj.blockInfo[classInfo->firstBlock + blockIndex];
+                    if(blockInfo->size == 0)
+                    {
+                        blockInfo->size = (uint32_t)size;
+                        blockInfo->bus = bus;
+                        result = (void *)(classInfo->memory + (blockIndex * classInfo->blockSize));
+                        _USB_HOST_MemoryPoolAccount(bus, classIndex, (uint32_t)size, true);
+                        break;
+                    }
+                }
+            }
+        }
+
+        if(result == NULL)
+        {
+            gUSBHostMemoryPoolObj.status[bus].failures ++;
+            gUSBHostMemoryPoolObj.status[USB_HOST_CONTROLLERS_NUMBER].failures ++;
+        }
+
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+        if(result == NULL)
+        {
+            SYS_DEBUG_PRINT(SYS_ERROR_DEBUG, "\r\nUSB Host Layer: Bus %d memory pool allocation of %d bytes failed.", bus, (int)size);
+        }
+    }
+
+    return(result);
+}
 
-            /* This request originated from the application. The context and the
-             * callback field of the control transfer object contain callback
-             * and context specified by the application. */
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_MemoryPoolFree( void * buffer )
 
-            if(controlTransferObj->callback != NULL)
-            {
-                /* This means we have a callback that we can call */
-                if(result == USB_HOST_RESULT_SUCCESS)
-                {
-                    ((USB_HOST_STRING_REQUEST_COMPLETE_CALLBACK)(controlTransferObj->callback))
-                        ((USB_HOST_REQUEST_HANDLE)controlTransferObj, irp->size, controlTransferObj->context);
+  Summary:
+    Returns a buffer to the host layer memory pool.
 
-                }
-                else
-                {
-                    /* The string descriptor request failed. Invoke the callback
-                     * with string size as 0 */
-                    ((USB_HOST_STRING_REQUEST_COMPLETE_CALLBACK)(controlTransferObj->callback))
-                        ((USB_HOST_REQUEST_HANDLE)controlTransferObj, irp->size, controlTransferObj->context);
-                }
-            }
+  Description:
+    Returns a buffer to the host layer memory pool.
 
-            break;
+  Remarks:
+    Refer to usb_host_local.h for usage information.
+*/
 
-        case USB_HOST_CONTROL_REQUEST_TYPE_CONFIGURATION_DESCRIPTOR_GET:
+void _USB_HOST_MemoryPoolFree( void * buffer )
+{
+    const USB_HOST_MEMORY_POOL_CLASS_INFO * classInfo;
+    USB_HOST_MEMORY_POOL_BLOCK_INFO * blockInfo;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    uintptr_t offset;
+    int classIndex;
 
-            /* This request originated from the client driver. An event should
-             * be sent to the device level event handler. Populate the event
-             * data. */
+    for(classIndex = 0; (buffer != NULL) && (classIndex < USB_HOST_MEMORY_POOL_CLASSES_NUMBER); classIndex ++)
+    {
+        classInfo = &gUSBHostMemoryPoolClass[classIndex];
 
-            configurationGetCompleteData.requestHandle = (USB_HOST_REQUEST_HANDLE)(&deviceObj->controlTransferObj);
-            configurationGetCompleteData.result = result; 
-            
-            if(deviceObj->deviceClientDriver != NULL)
+        /* Find the class from the address of the buffer */
+        if(((uint8_t *)buffer >= classInfo->memory) &&
+                ((uint8_t *)buffer < (classInfo->memory + (classInfo->blocksNumber * classInfo->blockSize))))
+        {
+            offset = (uintptr_t)((uint8_t *)buffer - classInfo->memory);
+            if((offset % classInfo->blockSize) == 0)
             {
-                deviceObj->deviceClientDriver->deviceEventHandler(deviceObj->deviceClientHandle,
-                        USB_HOST_DEVICE_EVENT_CONFIGURATION_DESCRIPTOR_GET_COMPLETE, &configurationGetCompleteData, 
-                        deviceObj->controlTransferObj.context);
-            }
+                blockInfo = &gUSBHostMemoryPoolObj.blockInfo[classInfo->firstBlock + (offset / classInfo->blockSize)];
 
-
-        default:
+                IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+                if(blockInfo->size != 0)
+                {
+                    _USB_HOST_MemoryPoolAccount(blockInfo->bus, classIndex, blockInfo->size, false);
+                    blockInfo->size = 0;
+                }
+                OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+            }
             break;
+        }
     }
-
-    /* Release the control transfer object back */
-    controlTransferObj->inUse = false;
 }
 
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: USB HOST Layer System Interface Implementations
@@ -3211,6 +4378,12 @@ SYS_MODULE_OBJ  USB_HOST_Initialize
                         (( USB_HOST_CLIENT_DRIVER *)tplEntry->hostClientDriver)->initialize( tplEntry->hostClientDriverInitData );
                     }
 
+#if defined(USB_HOST_TPL_INDEX_ENTRIES_NUMBER)
+                    /* Build the TPL index. The driver search functions walk
+                     * the TPL if the index could not be built. */
+                    _USB_HOST_TPLIndexBuild();
+#endif
+
                     SYS_DEBUG_MESSAGE(SYS_ERROR_INFO, "\r\nUSB Host Layer: Exiting USB_HOST_Initialize() successfully.");
                     result = ((SYS_MODULE_OBJ)hostObj);
                 }
@@ -4151,6 +5324,7 @@ USB_HOST_DEVICE_OBJ_HANDLE USB_HOST_DeviceEnumerate
         newDeviceObj->deviceState = USB_HOST_DEVICE_STATE_WAITING_FOR_ENUMERATION;
         newDeviceObj->tplEntryTried = -1;
         newDeviceObj->deviceClScPTried = -1;
+        newDeviceObj->deviceOperationsTimerHandle = SYS_TMR_HANDLE_INVALID;
         newDeviceObj->configDescriptorInfo.configurationNumber = USB_HOST_CONFIGURATION_NUMBER_INVALID;
 
         /* Note that this memory address that is being assigned here will be
@@ -4313,6 +5487,14 @@ void USB_HOST_DeviceDenumerate( USB_HOST_DEVICE_OBJ_HANDLE deviceObjHandle )
              * which could be called from an interrupt context is really a bad
              * place to free up memory. */
 
+            /* Stop the device timer if the device was detached while waiting
+             * for an enumeration delay */
+            if(deviceObj->deviceOperationsTimerHandle != SYS_TMR_HANDLE_INVALID)
+            {
+                SYS_TIME_TimerDestroy(deviceObj->deviceOperationsTimerHandle);
+                deviceObj->deviceOperationsTimerHandle = SYS_TMR_HANDLE_INVALID;
+            }
+
             /* If this device was enumerating then release the enumeration flag */
             if((busObj->deviceIsEnumerating) && (busObj->enumeratingDeviceIdentifier == deviceObjHandle))
             {
@@ -4472,6 +5654,7 @@ void USB_HOST_Tasks ( SYS_MODULE_OBJ usbHostObject )
                             rootHubDevice->parentDeviceIdentifier = rootHubUHD;
                             rootHubDevice->hcdHandle = busObj->hcdHandle ;
                             rootHubDevice->deviceAddress = USB_HOST_ROOT_HUB_ADDRESS ;
+                            rootHubDevice->deviceOperationsTimerHandle = SYS_TMR_HANDLE_INVALID;
                             rootHubDevice->deviceState = USB_HOST_DEVICE_STATE_READY ;
                             rootHubDevice->hcdInterface = busObj->hcdInterface;
                             rootHubDevice->hubInterface = (USB_HUB_INTERFACE *) & ( busObj->hcdInterface->rootHubInterface);
@@ -5259,7 +6442,7 @@ USB_HOST_RESULT USB_HOST_DeviceTransfer
                     transferObj->interfaceInfoObj = interfaceInfo;
 
                     /* Try submitting the IRP */
-                    if(USB_ERROR_NONE != deviceObj->hcdInterface->hostIRPSubmit( drvPipeHandle, & (transferObj->irp)))
+                    if(USB_ERROR_NONE != _USB_HOST_HCDIRPSubmit(deviceObj, drvPipeHandle, & (transferObj->irp), pipeObj->endpointAddress, pipeObj->transferType))
                     {
                         /* If the IRP submit was not successful, then return the
                          * transferObject to the pool and update the result. */
@@ -5446,6 +6629,9 @@ USB_HOST_PIPE_HANDLE USB_HOST_DevicePipeOpen
                             /* HCD pipe open function worked. Update the pipe object */
                             pipeObj->endpointAddress = endpointAddress;
                             pipeObj->interfaceHandle = deviceInterfaceHandle ;
+#if defined(USB_HOST_TRACE_RECORDS_NUMBER)
+                            pipeObj->transferType = transferType;
+#endif
 
                         }
                     }
@@ -5648,7 +6834,7 @@ USB_HOST_RESULT USB_HOST_DevicePipeHaltClear
                     controlTransferObj->context = context;
                     controlTransferObj->callback = NULL;
 
-                    if(USB_ERROR_NONE != deviceObj->hcdInterface->hostIRPSubmit( deviceObj->controlPipeHandle, &(controlTransferObj->controlIRP)))
+                    if(USB_ERROR_NONE != _USB_HOST_HCDIRPSubmit(deviceObj, deviceObj->controlPipeHandle, &(controlTransferObj->controlIRP), 0, USB_TRANSFER_TYPE_CONTROL))
                     {
                         /* There was a problem while submitting the IRP. Update the result and
                          * the transfer handle. Return the control transfer object back to the
@@ -6226,7 +7412,7 @@ USB_HOST_RESULT USB_HOST_DeviceInterfaceSet
                         controlTransferObj->context = context;
                         controlTransferObj->callback = NULL;
 
-                        if(USB_ERROR_NONE != deviceObj->hcdInterface->hostIRPSubmit( deviceObj->controlPipeHandle, &(controlTransferObj->controlIRP)))
+                        if(USB_ERROR_NONE != _USB_HOST_HCDIRPSubmit(deviceObj, deviceObj->controlPipeHandle, &(controlTransferObj->controlIRP), 0, USB_TRANSFER_TYPE_CONTROL))
                         {
                             /* There was a problem while submitting the IRP. Update the result and
                              * the transfer handle. Return the control transfer object back to the
@@ -6456,7 +7642,7 @@ USB_HOST_RESULT USB_HOST_DeviceStringDescriptorGet
                                 controlTransferObj->context = context;
                                 controlTransferObj->callback = (void*)callback;
 
-                                if(USB_ERROR_NONE != deviceObj->hcdInterface->hostIRPSubmit( deviceObj->controlPipeHandle, &(controlTransferObj->controlIRP)))
+                                if(USB_ERROR_NONE != _USB_HOST_HCDIRPSubmit(deviceObj, deviceObj->controlPipeHandle, &(controlTransferObj->controlIRP), 0, USB_TRANSFER_TYPE_CONTROL))
                                 {
                                     /* There was a problem while submitting the IRP. Update the result and
                                      * the transfer handle. Return the control transfer object back to the
@@ -6670,7 +7856,7 @@ USB_HOST_RESULT USB_HOST_DeviceConfigurationDescriptorGet
                             controlTransferObj->context = context;
                             controlTransferObj->callback = NULL;
 
-                            if(USB_ERROR_NONE != deviceObj->hcdInterface->hostIRPSubmit( deviceObj->controlPipeHandle, &(controlTransferObj->controlIRP)))
+                            if(USB_ERROR_NONE != _USB_HOST_HCDIRPSubmit(deviceObj, deviceObj->controlPipeHandle, &(controlTransferObj->controlIRP), 0, USB_TRANSFER_TYPE_CONTROL))
                             {
                                 /* There was a problem while submitting the IRP. Update the result and
                                  * the transfer handle. Return the control transfer object back to the
@@ -6696,3 +7882,359 @@ USB_HOST_RESULT USB_HOST_DeviceConfigurationDescriptorGet
     return result;
 }
 
+#if defined(USB_HOST_TRACE_RECORDS_NUMBER)
+
+// *****************************************************************************
+/* Function:
+    size_t USB_HOST_TraceRead
+    (
+        USB_HOST_TRACE_RECORD * records,
+        size_t count
+    )
+
+  Summary:
+    Reads records from the host layer trace.
+
+  Description:
+    Reads records from the host layer trace.
+
+  Remarks:
+    Refer to usb_host.h for usage information.
+*/
+
+size_t USB_HOST_TraceRead
+(
+    USB_HOST_TRACE_RECORD * records,
+    size_t count
+)
+{
+    size_t result = 0;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+
+    if(records != NULL)
+    {
+        /* Records are copied one at a time so that the critical section stays
+         * short */
+        while(result < count)
+        {
+            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+            if(gUSBHostTraceObj.count == 0)
+            {
+                OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+                break;
+            }
+
+            records[result] = gUSBHostTraceObj.record[gUSBHostTraceObj.readIndex];
+            gUSBHostTraceObj.readIndex = (gUSBHostTraceObj.readIndex + 1) % USB_HOST_TRACE_RECORDS_NUMBER;
+            gUSBHostTraceObj.count --;
+
+            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+            result ++;
+        }
+    }
+
+    return(result);
+}
+
+// *****************************************************************************
+/* Function:
+    uint32_t USB_HOST_TraceLostCountGet(void)
+
+  Summary:
+    Returns the number of events that were not recorded.
+
+  Description:
+    Returns the number of events that were not recorded.
+
+  Remarks:
+    Refer to usb_host.h for usage information.
+*/
+
+uint32_t USB_HOST_TraceLostCountGet(void)
+{
+    return(gUSBHostTraceObj.lostCount);
+}
+
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_TracePut
+    (
+        uint8_t * buffer,
+        uint64_t value,
+        unsigned int size
+    )
+
+  Summary:
+    Writes a little endian value to a buffer.
+
+  Description:
+    Writes the size least significant bytes of value to the buffer, least
+    significant byte first.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static void _USB_HOST_TracePut
+(
+    uint8_t * buffer,
+    uint64_t value,
+    unsigned int size
+)
+{
+    unsigned int count;
+
+    for(count = 0; count < size; count ++)
+    {
+        buffer[count] = (uint8_t)(value >> (8 * count));
+    }
+}
+
+// *****************************************************************************
+/* Function:
+    size_t USB_HOST_TracePcapHeaderGet
+    (
+        uint8_t * buffer,
+        size_t size
+    )
+
+  Summary:
+    Creates the header of a pcap file.
+
+  Description:
+    Creates the header of a pcap file.
+
+  Remarks:
+    Refer to usb_host.h for usage information.
+*/
+
+size_t USB_HOST_TracePcapHeaderGet
+(
+    uint8_t * buffer,
+    size_t size
+)
+{
+    if((buffer == NULL) || (size < USB_HOST_TRACE_PCAP_HEADER_SIZE))
+    {
+        return(0);
+    }
+
+    _USB_HOST_TracePut(&buffer[0], 0xA1B2C3D4, 4);      /* Magic number */
+    _USB_HOST_TracePut(&buffer[4], 2, 2);               /* Major version */
+    _USB_HOST_TracePut(&buffer[6], 4, 2);               /* Minor version */
+    _USB_HOST_TracePut(&buffer[8], 0, 4);               /* Time zone */
+    _USB_HOST_TracePut(&buffer[12], 0, 4);              /* Time stamp accuracy */
+    _USB_HOST_TracePut(&buffer[16], 65535, 4);          /* Snapshot length */
+    _USB_HOST_TracePut(&buffer[20], 220, 4);            /* LINKTYPE_USB_LINUX_MMAPPED */
+
+    return(USB_HOST_TRACE_PCAP_HEADER_SIZE);
+}
+
+// *****************************************************************************
+/* Function:
+    size_t USB_HOST_TracePcapRecordGet
+    (
+        const USB_HOST_TRACE_RECORD * record,
+        uint8_t * buffer,
+        size_t size
+    )
+
+  Summary:
+    Converts a trace record to a pcap packet.
+
+  Description:
+    Converts a trace record to a pcap packet.
+
+  Remarks:
+    Refer to usb_host.h for usage information.
+*/
+
+size_t USB_HOST_TracePcapRecordGet
+(
+    const USB_HOST_TRACE_RECORD * record,
+    uint8_t * buffer,
+    size_t size
+)
+{
+    uint8_t * usbmon;
+    uint32_t frequency;
+    uint32_t seconds;
+    uint32_t microseconds;
+    int32_t status;
+    uint8_t transferType;
+
+    if((record == NULL) || (buffer == NULL) || (size < USB_HOST_TRACE_PCAP_RECORD_SIZE))
+    {
+        return(0);
+    }
+
+    frequency = SYS_TIME_FrequencyGet();
+    if(frequency == 0)
+    {
+        frequency = 1;
+    }
+    seconds = (uint32_t)(record->timeStamp / frequency);
+    microseconds = (uint32_t)(((record->timeStamp % frequency) * 1000000) / frequency);
+
+    /* usbmon transfer types and Linux errno values */
+    switch(record->transferType)
+    {
+        case USB_TRANSFER_TYPE_ISOCHRONOUS: transferType = 0; break;
+        case USB_TRANSFER_TYPE_INTERRUPT: transferType = 1; break;
+        case USB_TRANSFER_TYPE_CONTROL: transferType = 2; break;
+        default: transferType = 3; break;
+    }
+
+    switch(record->status)
+    {
+        case USB_HOST_IRP_STATUS_COMPLETED:
+        case USB_HOST_IRP_STATUS_COMPLETED_SHORT: status = 0; break;
+        case USB_HOST_IRP_STATUS_PENDING:
+        case USB_HOST_IRP_STATUS_IN_PROGRESS: status = -115; break;   /* EINPROGRESS */
+        case USB_HOST_IRP_STATUS_ERROR_STALL: status = -32; break;    /* EPIPE */
+        case USB_HOST_IRP_STATUS_ERROR_NAK_TIMEOUT: status = -110; break; /* ETIMEDOUT */
+        case USB_HOST_IRP_STATUS_ABORTED: status = -2; break;         /* ENOENT */
+        case USB_HOST_IRP_STATUS_ERROR_BUS: status = -108; break;     /* ESHUTDOWN */
+        default: status = -71; break;                                 /* EPROTO */
+    }
+
+    if(record->event == USB_HOST_TRACE_EVENT_SUBMIT_ERROR)
+    {
+        status = -5;    /* EIO */
+    }
+
+    /* pcap packet header */
+    _USB_HOST_TracePut(&buffer[0], seconds, 4);
+    _USB_HOST_TracePut(&buffer[4], microseconds, 4);
+    _USB_HOST_TracePut(&buffer[8], 64, 4);
+    _USB_HOST_TracePut(&buffer[12], 64, 4);
+
+    /* usbmon packet header */
+    usbmon = &buffer[16];
+    memset(usbmon, 0, 64);
+    _USB_HOST_TracePut(&usbmon[0], record->id, 8);
+    usbmon[8] = record->event;
+    usbmon[9] = transferType;
+    usbmon[10] = record->endpoint;
+    usbmon[11] = record->deviceAddress;
+    _USB_HOST_TracePut(&usbmon[12], (uint32_t)record->bus + 1, 2);
+    usbmon[14] = record->setupValid ? 0 : '-';
+    usbmon[15] = (record->endpoint & USB_EP_DIRECTION_IN) ? '<' : '>';
+    _USB_HOST_TracePut(&usbmon[16], seconds, 8);
+    _USB_HOST_TracePut(&usbmon[24], microseconds, 4);
+    _USB_HOST_TracePut(&usbmon[28], (uint32_t)status, 4);
+    _USB_HOST_TracePut(&usbmon[32], record->length, 4);
+    if(record->setupValid)
+    {
+        memcpy(&usbmon[40], record->setup, 8);
+    }
+
+    return(USB_HOST_TRACE_PCAP_RECORD_SIZE);
+}
+
+#endif
+
+#if defined(USB_HOST_MEMORY_POOL_ENABLE)
+
+// *****************************************************************************
+/* Function:
+    USB_HOST_RESULT USB_HOST_MemoryPoolStatusGet
+    (
+        USB_HOST_BUS bus,
+        USB_HOST_MEMORY_POOL_STATUS * status
+    )
+
+  Summary:
+    Returns the use of the host layer memory pool.
+
+  Description:
+    Returns the use of the host layer memory pool.
+
+  Remarks:
+    Refer to usb_host.h for usage information.
+*/
+
+USB_HOST_RESULT USB_HOST_MemoryPoolStatusGet
+(
+    USB_HOST_BUS bus,
+    USB_HOST_MEMORY_POOL_STATUS * status
+)
+{
+    USB_HOST_RESULT result = USB_HOST_RESULT_SUCCESS;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+
+    if(status == NULL)
+    {
+        result = USB_HOST_RESULT_PARAMETER_INVALID;
+    }
+    else if((bus != USB_HOST_BUS_ALL) && (bus >= USB_HOST_CONTROLLERS_NUMBER))
+    {
+        result = USB_HOST_RESULT_BUS_UNKNOWN;
+    }
+    else
+    {
+        /* The totals of all buses are stored after the bus entries */
+        IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+        *status = gUSBHostMemoryPoolObj.status[(bus == USB_HOST_BUS_ALL) ? USB_HOST_CONTROLLERS_NUMBER : bus];
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+    }
+
+    return(result);
+}
+
+// *****************************************************************************
+/* Function:
+    void USB_HOST_MemoryPoolFailureInjectionSet(uint32_t interval)
+
+  Summary:
+    Makes allocations from the host layer memory pool fail periodically.
+
+  Description:
+    Makes allocations from the host layer memory pool fail periodically.
+
+  Remarks:
+    Refer to usb_host.h for usage information.
+*/
+
+void USB_HOST_MemoryPoolFailureInjectionSet(uint32_t interval)
+{
+    OSAL_CRITSECT_DATA_TYPE IntState;
+
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    gUSBHostMemoryPoolObj.failureInterval = interval;
+    gUSBHostMemoryPoolObj.failureCount = 0;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+}
+
+#endif
+
+#if defined(USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER)
+
+// *****************************************************************************
+/* Function:
+    void USB_HOST_DescriptorCacheClear(void)
+
+  Summary:
+    Removes all devices from the descriptor cache.
+
+  Description:
+    Removes all devices from the descriptor cache.
+
+  Remarks:
+    Refer to usb_host.h for usage information.
+*/
+
+void USB_HOST_DescriptorCacheClear(void)
+{
+    int iterator;
+
+    for(iterator = 0; iterator < USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER; iterator ++)
+    {
+        gUSBHostDescriptorCacheObj.entry[iterator].inUse = false;
+    }
+}
+
+#endif
@@ -240,6 +240,44 @@ typedef struct
 
 
 
+#if defined(USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER)
+// *****************************************************************************
+/* USB Host Audio Stream Conversion Object
+
+  Summary:
+    Conversion settings and rate adaptation state of an audio stream.
+
+  Description:
+    This structure holds the conversion set by
+    USB_HOST_AUDIO_V1_StreamConversionSet() and the state of the linear
+    interpolation. The interpolation position is relative to the last input
+    frame of the previous conversion, which is kept with the gain applied.
+
+  Remarks:
+    None.
+*/
+typedef struct
+{
+    /* True if a conversion has been set */
+    bool isSet;
+
+    /* Application side of the conversion */
+    USB_HOST_AUDIO_V1_CONVERSION conversion;
+
+    /* Input frames per output frame in 16.16 format of the last conversion.
+     * 0x10000 means no rate adaptation. */
+    uint32_t step;
+
+    /* Position of the next output frame in 16.16 format */
+    uint32_t phase;
+
+    /* Last input frame of the previous conversion */
+    int32_t previous[USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER];
+
+} USB_HOST_AUDIO_V1_CONVERSION_OBJ;
+
+#endif
+
 // *****************************************************************************
 
 /* USB Host Audio Streaming Interface data Structure
@@ -304,6 +342,11 @@ typedef struct
     /* Application defined context */
     uintptr_t context;
 
+#if defined(USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER)
+    /* Conversion of the converting read and write functions */
+    USB_HOST_AUDIO_V1_CONVERSION_OBJ conversionObj;
+#endif
+
 }USB_HOST_AUDIO_STREAMING_INTERFACE;
 
 
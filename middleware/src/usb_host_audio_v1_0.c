@@ -214,6 +214,11 @@ bool _USB_HOST_AUDIO_V1_ControlInterfaceInitialize (USB_HOST_AUDIO_V1_INSTANCE *
     
             /* Set Alternate setting to Zero */
             audioInstance->streamInf[strmIndex].activeInterfaceSetting = 0;
+
+#if defined(USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER)
+            /* The conversion of a previous device does not apply */
+            audioInstance->streamInf[strmIndex].conversionObj.isSet = false;
+#endif
         }  
     }
     else
@@ -5488,6 +5493,906 @@ USB_HOST_AUDIO_V1_0_STREAM_RESULT USB_HOST_AUDIO_V1_0_StreamSamplingRateSet
     return hostResult;
     
 }
+#if defined(USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER)
+// *****************************************************************************
+// *****************************************************************************
+// Audio v1.0 Host Client Driver Stream Conversion
+// *****************************************************************************
+// *****************************************************************************
+
+/* Unity gain and no rate adaptation in 16.16 format */
+#define USB_HOST_AUDIO_V1_CONVERSION_UNITY 0x10000
+
+/* Function:
+    int32_t _USB_HOST_AUDIO_V1_Saturate ( int64_t value )
+
+  Summary:
+    Limits a sample to the int32_t range.
+
+  Description:
+    This function limits a sample to the int32_t range.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static inline int32_t _USB_HOST_AUDIO_V1_Saturate ( int64_t value )
+{
+    if (value > INT32_MAX)
+    {
+        return INT32_MAX;
+    }
+    else if (value < INT32_MIN)
+    {
+        return INT32_MIN;
+    }
+
+    return (int32_t)value;
+}
+
+/* Function:
+    void _USB_HOST_AUDIO_V1_FrameLoad
+    (
+        const USB_HOST_AUDIO_V1_CONVERSION * conversion,
+        const void * source,
+        size_t index,
+        size_t blockLength,
+        uint8_t channels,
+        int32_t * frame
+    )
+
+  Summary:
+    Loads an application audio frame and applies the gain.
+
+  Description:
+    This function loads the audio frame at index from the application buffer
+    into 32 bit samples and applies the gain. In planar layout, blockLength
+    is the number of samples of a channel block.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static void _USB_HOST_AUDIO_V1_FrameLoad
+(
+    const USB_HOST_AUDIO_V1_CONVERSION * conversion,
+    const void * source,
+    size_t index,
+    size_t blockLength,
+    uint8_t channels,
+    int32_t * frame
+)
+{
+    size_t offset = index * channels;
+    size_t stride = 1;
+    const int32_t * intSamples;
+    const float * floatSamples;
+    float value;
+    uint8_t channel;
+
+    if (conversion->planar)
+    {
+        offset = index;
+        stride = blockLength;
+    }
+
+    if (conversion->format == USB_HOST_AUDIO_V1_SAMPLE_FORMAT_FLOAT)
+    {
+        floatSamples = (const float *)source + offset;
+        for (channel = 0; channel < channels; channel ++)
+        {
+            value = floatSamples[channel * stride] * 2147483648.0f;
+            if (value >= 2147483647.0f)
+            {
+                frame[channel] = INT32_MAX;
+            }
+            else if (value <= -2147483648.0f)
+            {
+                frame[channel] = INT32_MIN;
+            }
+            else
+            {
+                frame[channel] = (int32_t)value;
+            }
+        }
+    }
+    else
+    {
+        intSamples = (const int32_t *)source + offset;
+        for (channel = 0; channel < channels; channel ++)
+        {
+            frame[channel] = intSamples[channel * stride];
+        }
+    }
+
+    if (conversion->gain != USB_HOST_AUDIO_V1_CONVERSION_UNITY)
+    {
+        for (channel = 0; channel < channels; channel ++)
+        {
+            frame[channel] = _USB_HOST_AUDIO_V1_Saturate(((int64_t)frame[channel] * conversion->gain) >> 16);
+        }
+    }
+}
+
+/* Function:
+    void _USB_HOST_AUDIO_V1_FrameStore
+    (
+        const USB_HOST_AUDIO_V1_CONVERSION * conversion,
+        void * destination,
+        size_t index,
+        size_t blockLength,
+        uint8_t channels,
+        const int32_t * frame
+    )
+
+  Summary:
+    Applies the gain and stores an application audio frame.
+
+  Description:
+    This function applies the gain to a frame of 32 bit samples and stores or,
+    if mixing is enabled, adds it at index in the application buffer. In
+    planar layout, blockLength is the number of samples of a channel block.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static void _USB_HOST_AUDIO_V1_FrameStore
+(
+    const USB_HOST_AUDIO_V1_CONVERSION * conversion,
+    void * destination,
+    size_t index,
+    size_t blockLength,
+    uint8_t channels,
+    const int32_t * frame
+)
+{
+    size_t offset = index * channels;
+    size_t stride = 1;
+    int32_t * intSamples;
+    float * floatSamples;
+    int32_t sample;
+    uint8_t channel;
+
+    if (conversion->planar)
+    {
+        offset = index;
+        stride = blockLength;
+    }
+
+    intSamples = (int32_t *)destination + offset;
+    floatSamples = (float *)destination + offset;
+
+    for (channel = 0; channel < channels; channel ++)
+    {
+        sample = frame[channel];
+        if (conversion->gain != USB_HOST_AUDIO_V1_CONVERSION_UNITY)
+        {
+            sample = _USB_HOST_AUDIO_V1_Saturate(((int64_t)sample * conversion->gain) >> 16);
+        }
+
+        if (conversion->format == USB_HOST_AUDIO_V1_SAMPLE_FORMAT_FLOAT)
+        {
+            if (conversion->mix)
+            {
+                floatSamples[channel * stride] += (float)sample * (1.0f / 2147483648.0f);
+            }
+            else
+            {
+                floatSamples[channel * stride] = (float)sample * (1.0f / 2147483648.0f);
+            }
+        }
+        else
+        {
+            if (conversion->mix)
+            {
+                intSamples[channel * stride] = _USB_HOST_AUDIO_V1_Saturate((int64_t)intSamples[channel * stride] + sample);
+            }
+            else
+            {
+                intSamples[channel * stride] = sample;
+            }
+        }
+    }
+}
+
+/* Function:
+    void _USB_HOST_AUDIO_V1_FramePack
+    (
+        uint8_t * data,
+        const int32_t * frame,
+        uint8_t channels,
+        uint8_t subframeSize,
+        uint8_t signFlip
+    )
+
+  Summary:
+    Packs a frame of 32 bit samples into audio stream subframes.
+
+  Description:
+    This function stores the most significant bytes of each sample in a
+    little endian subframe. signFlip is 0x80 for the unsigned PCM8 format
+    and 0 otherwise.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static void _USB_HOST_AUDIO_V1_FramePack
+(
+    uint8_t * data,
+    const int32_t * frame,
+    uint8_t channels,
+    uint8_t subframeSize,
+    uint8_t signFlip
+)
+{
+    uint32_t sample;
+    uint8_t channel;
+
+    switch (subframeSize)
+    {
+        case 1:
+            for (channel = 0; channel < channels; channel ++)
+            {
+                data[channel] = (uint8_t)(((uint32_t)frame[channel] >> 24) ^ signFlip);
+            }
+            break;
+
+        case 2:
+            for (channel = 0; channel < channels; channel ++, data += 2)
+            {
+                sample = (uint32_t)frame[channel];
+                data[0] = (uint8_t)(sample >> 16);
+                data[1] = (uint8_t)(sample >> 24);
+            }
+            break;
+
+        case 3:
+            for (channel = 0; channel < channels; channel ++, data += 3)
+            {
+                sample = (uint32_t)frame[channel];
+                data[0] = (uint8_t)(sample >> 8);
+                data[1] = (uint8_t)(sample >> 16);
+                data[2] = (uint8_t)(sample >> 24);
+            }
+            break;
+
+        default:
+            for (channel = 0; channel < channels; channel ++, data += 4)
+            {
+                sample = (uint32_t)frame[channel];
+                data[0] = (uint8_t)(sample);
+                data[1] = (uint8_t)(sample >> 8);
+                data[2] = (uint8_t)(sample >> 16);
+                data[3] = (uint8_t)(sample >> 24);
+            }
+            break;
+    }
+}
+
+/* Function:
+    void _USB_HOST_AUDIO_V1_FrameUnpack
+    (
+        const uint8_t * data,
+        int32_t * frame,
+        uint8_t channels,
+        uint8_t subframeSize,
+        uint8_t signFlip
+    )
+
+  Summary:
+    Unpacks audio stream subframes into a frame of 32 bit samples.
+
+  Description:
+    This function places each little endian subframe in the most significant
+    bytes of a 32 bit sample. signFlip is 0x80 for the unsigned PCM8 format
+    and 0 otherwise.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static void _USB_HOST_AUDIO_V1_FrameUnpack
+(
+    const uint8_t * data,
+    int32_t * frame,
+    uint8_t channels,
+    uint8_t subframeSize,
+    uint8_t signFlip
+)
+{
+    uint8_t channel;
+
+    switch (subframeSize)
+    {
+        case 1:
+            for (channel = 0; channel < channels; channel ++)
+            {
+                frame[channel] = (int32_t)((uint32_t)(data[channel] ^ signFlip) << 24);
+            }
+            break;
+
+        case 2:
+            for (channel = 0; channel < channels; channel ++, data += 2)
+            {
+                frame[channel] = (int32_t)(((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 24));
+            }
+            break;
+
+        case 3:
+            for (channel = 0; channel < channels; channel ++, data += 3)
+            {
+                frame[channel] = (int32_t)(((uint32_t)data[0] << 8) | ((uint32_t)data[1] << 16)
+                        | ((uint32_t)data[2] << 24));
+            }
+            break;
+
+        default:
+            for (channel = 0; channel < channels; channel ++, data += 4)
+            {
+                frame[channel] = (int32_t)((uint32_t)data[0] | ((uint32_t)data[1] << 8)
+                        | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24));
+            }
+            break;
+    }
+}
+
+/* Function:
+    USB_HOST_AUDIO_V1_RESULT _USB_HOST_AUDIO_V1_ConversionStreamGet
+    (
+        USB_HOST_AUDIO_V1_STREAM_HANDLE streamHandle,
+        USB_HOST_AUDIO_STREAMING_INTERFACE ** asInterface,
+        USB_HOST_AUDIO_STREAM_SETTING ** audioStream
+    )
+
+  Summary:
+    Returns the streaming interface and the active setting of a converting
+    stream.
+
+  Description:
+    This function validates the stream handle and checks that a conversion
+    has been set and that the format of the active alternate setting is
+    supported by the conversion.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static USB_HOST_AUDIO_V1_RESULT _USB_HOST_AUDIO_V1_ConversionStreamGet
+(
+    USB_HOST_AUDIO_V1_STREAM_HANDLE streamHandle,
+    USB_HOST_AUDIO_STREAMING_INTERFACE ** asInterface,
+    USB_HOST_AUDIO_STREAM_SETTING ** audioStream
+)
+{
+    USB_HOST_AUDIO_STREAMING_INTERFACE * streamingInterface;
+    USB_HOST_AUDIO_STREAM_SETTING * streamSetting;
+    uint8_t audioInstanceIndex;
+    uint8_t asIntrefaceIndex;
+
+    if (streamHandle == USB_HOST_AUDIO_V1_STREAM_HANDLE_INVALID)
+    {
+        return USB_HOST_AUDIO_V1_RESULT_INVALID_PARAMETER;
+    }
+
+    audioInstanceIndex = (uint8_t)streamHandle;
+    asIntrefaceIndex = (uint8_t)(streamHandle>>8);
+    if ((audioInstanceIndex >= USB_HOST_AUDIO_V1_INSTANCES_NUMBER) ||
+            (asIntrefaceIndex >= USB_HOST_AUDIO_V1_STREAMING_INTERFACES_NUMBER))
+    {
+        return USB_HOST_AUDIO_V1_RESULT_INVALID_PARAMETER;
+    }
+
+    streamingInterface = &gUSBHostAudioInstance[audioInstanceIndex].streamInf[asIntrefaceIndex];
+    streamSetting = &streamingInterface->audioStreamSetting[streamingInterface->activeInterfaceSetting];
+
+    if ((streamingInterface->conversionObj.isSet == false) ||
+            (streamSetting->bNrChannels == 0) ||
+            (streamSetting->bNrChannels > USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER))
+    {
+        return USB_HOST_AUDIO_V1_RESULT_INVALID_PARAMETER;
+    }
+
+    if (!(((streamSetting->wFormatTag == USB_AUDIO_FORMAT_PCM) &&
+            (streamSetting->bSubframeSize >= 1) && (streamSetting->bSubframeSize <= 4)) ||
+            ((streamSetting->wFormatTag == USB_AUDIO_FORMAT_PCM8) && (streamSetting->bSubframeSize == 1))))
+    {
+        /* Not a PCM format */
+        return USB_HOST_AUDIO_V1_RESULT_INVALID_PARAMETER;
+    }
+
+    *asInterface = streamingInterface;
+    *audioStream = streamSetting;
+    return USB_HOST_AUDIO_V1_RESULT_SUCCESS;
+}
+
+/* Function:
+    size_t _USB_HOST_AUDIO_V1_ConversionFramesCount
+    (
+        USB_HOST_AUDIO_V1_CONVERSION_OBJ * conversionObj,
+        size_t inputFrames
+    )
+
+  Summary:
+    Returns the number of output frames of a conversion.
+
+  Description:
+    This function returns the number of output frames that the rate
+    adaptation produces from inputFrames input frames.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static size_t _USB_HOST_AUDIO_V1_ConversionFramesCount
+(
+    USB_HOST_AUDIO_V1_CONVERSION_OBJ * conversionObj,
+    size_t inputFrames
+)
+{
+    uint64_t end = ((uint64_t)inputFrames) << 16;
+
+    if ((inputFrames == 0) || (conversionObj->phase > end))
+    {
+        return 0;
+    }
+
+    return (size_t)(((end - conversionObj->phase) / conversionObj->step) + 1);
+}
+
+/* Function:
+    void _USB_HOST_AUDIO_V1_Convert
+    (
+        USB_HOST_AUDIO_V1_CONVERSION_OBJ * conversionObj,
+        USB_HOST_AUDIO_STREAM_SETTING * audioStream,
+        bool isWrite,
+        const void * input,
+        size_t inputFrames,
+        void * output,
+        size_t outputFrames,
+        size_t outputBlockLength
+    )
+
+  Summary:
+    Converts audio frames between the application and the audio stream.
+
+  Description:
+    This function converts inputFrames input frames into outputFrames output
+    frames. For a write, the input is the application buffer and the output
+    is the audio stream data. For a read, it is the reverse.
+
+    Output frame positions advance by the step through the input frames,
+    with the last input frame of the previous conversion at position 0. An
+    output frame is interpolated linearly between the two input frames around
+    its position. Without rate adaptation every output frame falls on an
+    input frame and the frames are converted one by one.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application. outputFrames must not exceed the count returned by
+    _USB_HOST_AUDIO_V1_ConversionFramesCount().
+*/
+
+static void _USB_HOST_AUDIO_V1_Convert
+(
+    USB_HOST_AUDIO_V1_CONVERSION_OBJ * conversionObj,
+    USB_HOST_AUDIO_STREAM_SETTING * audioStream,
+    bool isWrite,
+    const void * input,
+    size_t inputFrames,
+    void * output,
+    size_t outputFrames,
+    size_t outputBlockLength
+)
+{
+    const USB_HOST_AUDIO_V1_CONVERSION * conversion = &conversionObj->conversion;
+    int32_t current[USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER];
+    int32_t next[USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER];
+    int32_t interpolated[USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER];
+    int32_t * frame;
+    uint8_t channels = audioStream->bNrChannels;
+    uint8_t subframeSize = audioStream->bSubframeSize;
+    uint8_t signFlip = (audioStream->wFormatTag == USB_AUDIO_FORMAT_PCM8) ? 0x80 : 0;
+    size_t frameSize = (size_t)channels * subframeSize;
+    size_t outputIndex;
+    size_t inputIndex;
+    size_t nextIndex;
+    uint64_t position;
+    uint64_t end;
+    uint32_t fraction;
+    uint8_t channel;
+
+    if (inputFrames == 0)
+    {
+        return;
+    }
+
+    if ((conversionObj->step == USB_HOST_AUDIO_V1_CONVERSION_UNITY) &&
+            (conversionObj->phase == USB_HOST_AUDIO_V1_CONVERSION_UNITY))
+    {
+        /* Every output frame is an input frame */
+        for (outputIndex = 0; outputIndex < outputFrames; outputIndex ++)
+        {
+            if (isWrite)
+            {
+                _USB_HOST_AUDIO_V1_FrameLoad(conversion, input, outputIndex, inputFrames, channels, current);
+                _USB_HOST_AUDIO_V1_FramePack((uint8_t *)output + (outputIndex * frameSize), current, channels, subframeSize, signFlip);
+            }
+            else
+            {
+                _USB_HOST_AUDIO_V1_FrameUnpack((const uint8_t *)input + (outputIndex * frameSize), current, channels, subframeSize, signFlip);
+                _USB_HOST_AUDIO_V1_FrameStore(conversion, output, outputIndex, outputBlockLength, channels, current);
+            }
+        }
+    }
+    else
+    {
+        /* current holds input frame inputIndex, where input frame 0 is the
+         * last frame of the previous conversion. next holds input frame
+         * nextIndex. */
+        for (channel = 0; channel < channels; channel ++)
+        {
+            current[channel] = conversionObj->previous[channel];
+        }
+        inputIndex = 0;
+        nextIndex = 0;
+        position = conversionObj->phase;
+
+        for (outputIndex = 0; outputIndex < outputFrames; outputIndex ++)
+        {
+            while (inputIndex < (position >> 16))
+            {
+                inputIndex ++;
+                if (nextIndex == inputIndex)
+                {
+                    for (channel = 0; channel < channels; channel ++)
+                    {
+                        current[channel] = next[channel];
+                    }
+                }
+                else if (isWrite)
+                {
+                    _USB_HOST_AUDIO_V1_FrameLoad(conversion, input, inputIndex - 1, inputFrames, channels, current);
+                }
+                else
+                {
+                    _USB_HOST_AUDIO_V1_FrameUnpack((const uint8_t *)input + ((inputIndex - 1) * frameSize), current, channels, subframeSize, signFlip);
+                }
+            }
+
+            frame = current;
+            fraction = (uint32_t)(position & 0xFFFF);
+            if (fraction != 0)
+            {
+                if (nextIndex != (inputIndex + 1))
+                {
+                    nextIndex = inputIndex + 1;
+                    if (isWrite)
+                    {
+                        _USB_HOST_AUDIO_V1_FrameLoad(conversion, input, nextIndex - 1, inputFrames, channels, next);
+                    }
+                    else
+                    {
+                        _USB_HOST_AUDIO_V1_FrameUnpack((const uint8_t *)input + ((nextIndex - 1) * frameSize), next, channels, subframeSize, signFlip);
+                    }
+                }
+
+                frame = interpolated;
+                for (channel = 0; channel < channels; channel ++)
+                {
+                    frame[channel] = (int32_t)(current[channel] +
+                            ((((int64_t)next[channel] - current[channel]) * fraction) >> 16));
+                }
+            }
+
+            if (isWrite)
+            {
+                _USB_HOST_AUDIO_V1_FramePack((uint8_t *)output + (outputIndex * frameSize), frame, channels, subframeSize, signFlip);
+            }
+            else
+            {
+                _USB_HOST_AUDIO_V1_FrameStore(conversion, output, outputIndex, outputBlockLength, channels, frame);
+            }
+
+            position += conversionObj->step;
+        }
+
+        /* Positions of the next conversion are relative to the last input
+         * frame of this one. Frames that were dropped are skipped. */
+        end = ((uint64_t)inputFrames) << 16;
+        conversionObj->phase = (position > end) ? (uint32_t)(position - end) : USB_HOST_AUDIO_V1_CONVERSION_UNITY;
+    }
+
+    /* Keep the last input frame for the next conversion */
+    if (isWrite)
+    {
+        _USB_HOST_AUDIO_V1_FrameLoad(conversion, input, inputFrames - 1, inputFrames, channels, conversionObj->previous);
+    }
+    else
+    {
+        _USB_HOST_AUDIO_V1_FrameUnpack((const uint8_t *)input + ((inputFrames - 1) * frameSize), conversionObj->previous, channels, subframeSize, signFlip);
+    }
+}
+
+/* Function:
+    uint32_t _USB_HOST_AUDIO_V1_ConversionStepGet
+    (
+        const USB_HOST_AUDIO_V1_CONVERSION * conversion,
+        bool isWrite
+    )
+
+  Summary:
+    Returns the input frames per output frame of a conversion.
+
+  Description:
+    This function returns the number of input frames per output frame in 16.16
+    format. The input is the application for a write and the audio stream for
+    a read.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static uint32_t _USB_HOST_AUDIO_V1_ConversionStepGet
+(
+    const USB_HOST_AUDIO_V1_CONVERSION * conversion,
+    bool isWrite
+)
+{
+    if ((conversion->applicationRate == 0) || (conversion->streamRate == 0) ||
+            (conversion->applicationRate == conversion->streamRate))
+    {
+        return USB_HOST_AUDIO_V1_CONVERSION_UNITY;
+    }
+
+    if (isWrite)
+    {
+        return (uint32_t)((((uint64_t)conversion->applicationRate) << 16) / conversion->streamRate);
+    }
+
+    return (uint32_t)((((uint64_t)conversion->streamRate) << 16) / conversion->applicationRate);
+}
+
+// *****************************************************************************
+/* Function:
+    USB_HOST_AUDIO_V1_RESULT USB_HOST_AUDIO_V1_StreamConversionSet
+    (
+        USB_HOST_AUDIO_V1_STREAM_HANDLE streamHandle,
+        const USB_HOST_AUDIO_V1_CONVERSION * conversion
+    );
+
+  Summary:
+    Sets the conversion applied by the converting stream read and write
+    functions.
+
+  Description:
+    Refer to usb_host_audio_v1_0.h for a detailed description of this
+    function.
+
+  Remarks:
+    The sampling frequencies may differ by up to a factor of 8.
+*/
+
+USB_HOST_AUDIO_V1_RESULT USB_HOST_AUDIO_V1_StreamConversionSet
+(
+    USB_HOST_AUDIO_V1_STREAM_HANDLE streamHandle,
+    const USB_HOST_AUDIO_V1_CONVERSION * conversion
+)
+{
+    USB_HOST_AUDIO_V1_CONVERSION_OBJ * conversionObj;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    uint8_t audioInstanceIndex;
+    uint8_t asIntrefaceIndex;
+    uint8_t channel;
+
+    if ((streamHandle == USB_HOST_AUDIO_V1_STREAM_HANDLE_INVALID) || (conversion == NULL))
+    {
+        return USB_HOST_AUDIO_V1_RESULT_INVALID_PARAMETER;
+    }
+
+    audioInstanceIndex = (uint8_t)streamHandle;
+    asIntrefaceIndex = (uint8_t)(streamHandle>>8);
+    if ((audioInstanceIndex >= USB_HOST_AUDIO_V1_INSTANCES_NUMBER) ||
+            (asIntrefaceIndex >= USB_HOST_AUDIO_V1_STREAMING_INTERFACES_NUMBER))
+    {
+        return USB_HOST_AUDIO_V1_RESULT_INVALID_PARAMETER;
+    }
+
+    if ((conversion->format != USB_HOST_AUDIO_V1_SAMPLE_FORMAT_INT32) &&
+            (conversion->format != USB_HOST_AUDIO_V1_SAMPLE_FORMAT_FLOAT))
+    {
+        return USB_HOST_AUDIO_V1_RESULT_INVALID_PARAMETER;
+    }
+
+    if ((conversion->applicationRate != 0) && (conversion->streamRate != 0) &&
+            (((conversion->applicationRate / 8) > conversion->streamRate) ||
+            ((conversion->streamRate / 8) > conversion->applicationRate)))
+    {
+        /* Linear interpolation does not suit such rate differences */
+        return USB_HOST_AUDIO_V1_RESULT_INVALID_PARAMETER;
+    }
+
+    conversionObj = &gUSBHostAudioInstance[audioInstanceIndex].streamInf[asIntrefaceIndex].conversionObj;
+
+    /* Prevent a conversion in an event handler from seeing a partial update */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    conversionObj->conversion = *conversion;
+    conversionObj->step = USB_HOST_AUDIO_V1_CONVERSION_UNITY;
+    conversionObj->phase = USB_HOST_AUDIO_V1_CONVERSION_UNITY;
+    for (channel = 0; channel < USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER; channel ++)
+    {
+        conversionObj->previous[channel] = 0;
+    }
+    conversionObj->isSet = true;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+    return USB_HOST_AUDIO_V1_RESULT_SUCCESS;
+}
+
+// *****************************************************************************
+/* Function:
+    USB_HOST_AUDIO_V1_RESULT USB_HOST_AUDIO_V1_StreamConvertWrite
+    (
+        USB_HOST_AUDIO_V1_STREAM_HANDLE streamHandle,
+        USB_HOST_AUDIO_V1_STREAM_TRANSFER_HANDLE * transferHandle,
+        const void * source,
+        size_t frames,
+        void * buffer,
+        size_t bufferSize
+    );
+
+  Summary:
+    Converts application audio frames and schedules an audio stream write
+    request with the result.
+
+  Description:
+    Refer to usb_host_audio_v1_0.h for a detailed description of this
+    function.
+
+  Remarks:
+    The rate adaptation state is restored if the request could not be
+    scheduled, so that the application can retry with the same frames.
+*/
+
+USB_HOST_AUDIO_V1_RESULT USB_HOST_AUDIO_V1_StreamConvertWrite
+(
+    USB_HOST_AUDIO_V1_STREAM_HANDLE streamHandle,
+    USB_HOST_AUDIO_V1_STREAM_TRANSFER_HANDLE * transferHandle,
+    const void * source,
+    size_t frames,
+    void * buffer,
+    size_t bufferSize
+)
+{
+    USB_HOST_AUDIO_STREAMING_INTERFACE * asInterface;
+    USB_HOST_AUDIO_STREAM_SETTING * audioStream;
+    USB_HOST_AUDIO_V1_CONVERSION_OBJ * conversionObj;
+    USB_HOST_AUDIO_V1_RESULT audioResult;
+    int32_t previous[USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER];
+    uint32_t phase;
+    size_t outputFrames;
+    size_t length;
+    uint8_t channel;
+
+    audioResult = _USB_HOST_AUDIO_V1_ConversionStreamGet(streamHandle, &asInterface, &audioStream);
+    if (audioResult != USB_HOST_AUDIO_V1_RESULT_SUCCESS)
+    {
+        return audioResult;
+    }
+
+    if (((frames != 0) && (source == NULL)) || (buffer == NULL))
+    {
+        return USB_HOST_AUDIO_V1_RESULT_INVALID_PARAMETER;
+    }
+
+    conversionObj = &asInterface->conversionObj;
+    conversionObj->step = _USB_HOST_AUDIO_V1_ConversionStepGet(&conversionObj->conversion, true);
+
+    outputFrames = _USB_HOST_AUDIO_V1_ConversionFramesCount(conversionObj, frames);
+    length = outputFrames * audioStream->bNrChannels * audioStream->bSubframeSize;
+    if (length > bufferSize)
+    {
+        return USB_HOST_AUDIO_V1_RESULT_INVALID_PARAMETER;
+    }
+
+    phase = conversionObj->phase;
+    for (channel = 0; channel < audioStream->bNrChannels; channel ++)
+    {
+        previous[channel] = conversionObj->previous[channel];
+    }
+
+    _USB_HOST_AUDIO_V1_Convert(conversionObj, audioStream, true, source, frames, buffer, outputFrames, 0);
+
+    audioResult = _USB_HOST_AUDIO_V1_StreamWrite(streamHandle, transferHandle, buffer, length, USB_HOST_AUDIO_V1_API_VERSION_FLAG_V1);
+    if (audioResult != USB_HOST_AUDIO_V1_RESULT_SUCCESS)
+    {
+        /* The frames were not consumed */
+        conversionObj->phase = phase;
+        for (channel = 0; channel < audioStream->bNrChannels; channel ++)
+        {
+            conversionObj->previous[channel] = previous[channel];
+        }
+    }
+
+    return audioResult;
+}
+
+// *****************************************************************************
+/* Function:
+    USB_HOST_AUDIO_V1_RESULT USB_HOST_AUDIO_V1_StreamConvertRead
+    (
+        USB_HOST_AUDIO_V1_STREAM_HANDLE streamHandle,
+        const void * buffer,
+        size_t length,
+        void * destination,
+        size_t * frames
+    );
+
+  Summary:
+    Converts audio stream data received by a read request to application
+    audio frames.
+
+  Description:
+    Refer to usb_host_audio_v1_0.h for a detailed description of this
+    function.
+
+  Remarks:
+    A partial audio frame at the end of the data is ignored.
+*/
+
+USB_HOST_AUDIO_V1_RESULT USB_HOST_AUDIO_V1_StreamConvertRead
+(
+    USB_HOST_AUDIO_V1_STREAM_HANDLE streamHandle,
+    const void * buffer,
+    size_t length,
+    void * destination,
+    size_t * frames
+)
+{
+    USB_HOST_AUDIO_STREAMING_INTERFACE * asInterface;
+    USB_HOST_AUDIO_STREAM_SETTING * audioStream;
+    USB_HOST_AUDIO_V1_CONVERSION_OBJ * conversionObj;
+    USB_HOST_AUDIO_V1_RESULT audioResult;
+    size_t inputFrames;
+    size_t outputFrames;
+
+    audioResult = _USB_HOST_AUDIO_V1_ConversionStreamGet(streamHandle, &asInterface, &audioStream);
+    if (audioResult != USB_HOST_AUDIO_V1_RESULT_SUCCESS)
+    {
+        return audioResult;
+    }
+
+    if ((frames == NULL) || ((length != 0) && ((buffer == NULL) || (destination == NULL))))
+    {
+        return USB_HOST_AUDIO_V1_RESULT_INVALID_PARAMETER;
+    }
+
+    conversionObj = &asInterface->conversionObj;
+    conversionObj->step = _USB_HOST_AUDIO_V1_ConversionStepGet(&conversionObj->conversion, false);
+
+    inputFrames = length / ((size_t)audioStream->bNrChannels * audioStream->bSubframeSize);
+    outputFrames = _USB_HOST_AUDIO_V1_ConversionFramesCount(conversionObj, inputFrames);
+    if (outputFrames > *frames)
+    {
+        outputFrames = *frames;
+    }
+
+    _USB_HOST_AUDIO_V1_Convert(conversionObj, audioStream, false, buffer, inputFrames, destination, outputFrames, *frames);
+
+    *frames = outputFrames;
+    return USB_HOST_AUDIO_V1_RESULT_SUCCESS;
+}
+#endif
+
 /***************  End of  File ************************************/
 
 
@@ -45,6 +45,7 @@
 #include "usb/usb_host.h"
 #include "usb/usb_cdc.h"
 #include "usb/src/usb_host_cdc_local.h"
+#include <string.h>
 
 /************************************************
  * CDC Host Client Driver instance objects. One
@@ -57,6 +58,19 @@
  ***********************************************/
  USB_HOST_CDC_ATTACH_LISTENER_OBJ gUSBHostCDCAttachListener[USB_HOST_CDC_ATTACH_LISTENERS_NUMBER];
 
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+/************************************************
+ * CDC stream buffers. The bulk IN transfers of
+ * a stream complete into the transfer buffers,
+ * which are then copied to the receive ring.
+ * The bulk OUT transfers are sent from the
+ * transmit ring.
+ ************************************************/
+static uint8_t gUSBHostCDCStreamTransferBuffer[USB_HOST_CDC_INSTANCES_NUMBER][USB_HOST_CDC_STREAM_IRPS_NUMBER][USB_HOST_CDC_STREAM_TRANSFER_SIZE] USB_ALIGN;
+static uint8_t gUSBHostCDCStreamRxBuffer[USB_HOST_CDC_INSTANCES_NUMBER][USB_HOST_CDC_STREAM_BUFFER_SIZE];
+static uint8_t gUSBHostCDCStreamTxBuffer[USB_HOST_CDC_INSTANCES_NUMBER][USB_HOST_CDC_STREAM_BUFFER_SIZE] USB_ALIGN;
+#endif
+
 /************************************************
  * CDC Interface to the host layer
  ************************************************/
@@ -707,6 +721,9 @@ void _USB_HOST_CDC_InterfaceAssign
                 {
                     /* Yes we did. Open this pipe */
                     cdcInstance->bulkInPipeHandle = USB_HOST_DevicePipeOpen(cdcInstance->dataInterfaceHandle, endpointDescriptor->bEndpointAddress);
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+                    cdcInstance->bulkInMaxPacketSize = endpointDescriptor->wMaxPacketSize & 0x7FF;
+#endif
                 }
 
                 /* Bulk in pipe is opened. Now open the bulk out pipe */
@@ -722,6 +739,9 @@ void _USB_HOST_CDC_InterfaceAssign
                     /* Yes we did. Open this pipe */
                     cdcInstance->bulkOutPipeHandle = USB_HOST_DevicePipeOpen(cdcInstance->dataInterfaceHandle, 
                             endpointDescriptor->bEndpointAddress);
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+                    cdcInstance->bulkOutMaxPacketSize = endpointDescriptor->wMaxPacketSize & 0x7FF;
+#endif
                 }
             }
             else
@@ -833,6 +853,9 @@ void _USB_HOST_CDC_InterfaceAssign
                         {
                             cdcInstance->bulkInPipeHandle = USB_HOST_DevicePipeOpen(cdcInstance->dataInterfaceHandle, 
                                     endpointDescriptor->bEndpointAddress);
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+                            cdcInstance->bulkInMaxPacketSize = endpointDescriptor->wMaxPacketSize & 0x7FF;
+#endif
                         }
                         else
                         {
@@ -851,6 +874,9 @@ void _USB_HOST_CDC_InterfaceAssign
                         {
                             cdcInstance->bulkOutPipeHandle = USB_HOST_DevicePipeOpen(cdcInstance->dataInterfaceHandle, 
                                     endpointDescriptor->bEndpointAddress);
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+                            cdcInstance->bulkOutMaxPacketSize = endpointDescriptor->wMaxPacketSize & 0x7FF;
+#endif
                         }
                         else
                         {
@@ -900,6 +926,366 @@ void _USB_HOST_CDC_InterfaceAssign
     }
 }
 
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_CDC_StreamStop
+    (
+        USB_HOST_CDC_INSTANCE_OBJ * cdcInstance
+    )
+
+  Summary:
+    Stops the stream of a CDC instance after a failed transfer.
+
+  Description:
+    This function marks the stream as stopped, so that completed transfers are
+    not queued again, and sends the USB_HOST_CDC_EVENT_STREAM_STOPPED event to
+    the application. The event is sent only once per stream.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static void _USB_HOST_CDC_StreamStop
+(
+    USB_HOST_CDC_INSTANCE_OBJ * cdcInstance
+)
+{
+    if(cdcInstance->stream.isStarted)
+    {
+        cdcInstance->stream.isStarted = false;
+
+        if(cdcInstance->eventHandler != NULL)
+        {
+            cdcInstance->eventHandler((USB_HOST_CDC_HANDLE)(cdcInstance), 
+                    USB_HOST_CDC_EVENT_STREAM_STOPPED, NULL, cdcInstance->context);
+        }
+    }
+}
+
+// *****************************************************************************
+/* Function:
+    USB_HOST_RESULT _USB_HOST_CDC_StreamReadSubmit
+    (
+        USB_HOST_CDC_INSTANCE_OBJ * cdcInstance,
+        unsigned int slot
+    )
+
+  Summary:
+    Queues the bulk IN transfer of a stream transfer slot.
+
+  Description:
+    This function queues a USB_HOST_CDC_STREAM_TRANSFER_SIZE bulk IN transfer
+    into the buffer of the specified slot. The slot is encoded in the transfer
+    context so that the completion can be matched to its buffer.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static USB_HOST_RESULT _USB_HOST_CDC_StreamReadSubmit
+(
+    USB_HOST_CDC_INSTANCE_OBJ * cdcInstance,
+    unsigned int slot
+)
+{
+    USB_HOST_CDC_STREAM * stream = &cdcInstance->stream;
+    USB_HOST_TRANSFER_HANDLE transferHandle;
+    USB_HOST_RESULT hostResult;
+
+    /* Count the transfer before it is queued. It may complete before
+     * USB_HOST_DeviceTransfer() returns. */
+    stream->rxTransfersPending ++;
+
+    hostResult = USB_HOST_DeviceTransfer(cdcInstance->bulkInPipeHandle, &transferHandle, 
+            stream->rxTransferBuffer[slot], USB_HOST_CDC_STREAM_TRANSFER_SIZE,
+            (uintptr_t)(USB_HOST_CDC_STREAM_CONTEXT_READ + slot));
+
+    if(hostResult != USB_HOST_RESULT_SUCCESS)
+    {
+        stream->rxTransfersPending --;
+    }
+
+    return(hostResult);
+}
+
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_CDC_StreamReadComplete
+    (
+        USB_HOST_CDC_INSTANCE_OBJ * cdcInstance,
+        unsigned int slot,
+        USB_HOST_DEVICE_INTERFACE_EVENT_TRANSFER_COMPLETE_DATA * transferData
+    )
+
+  Summary:
+    Handles the completion of a stream bulk IN transfer.
+
+  Description:
+    This function copies the received data to the receive ring and queues the
+    transfer again before the application is notified, so that the pipe always
+    has transfers queued. Data that does not fit in the receive ring is dropped
+    and added to the overflow count. The application then receives the
+    USB_HOST_CDC_EVENT_STREAM_READ_DATA_AVAILABLE event with the readable spans
+    of the ring.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application. It is called in the context of the transfer complete event,
+    which may be an interrupt context.
+*/
+
+static void _USB_HOST_CDC_StreamReadComplete
+(
+    USB_HOST_CDC_INSTANCE_OBJ * cdcInstance,
+    unsigned int slot,
+    USB_HOST_DEVICE_INTERFACE_EVENT_TRANSFER_COMPLETE_DATA * transferData
+)
+{
+    USB_HOST_CDC_STREAM * stream = &cdcInstance->stream;
+    USB_HOST_CDC_EVENT_STREAM_READ_DATA_AVAILABLE_DATA dataAvailable;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    uint8_t * source = stream->rxTransferBuffer[slot];
+    size_t length = transferData->length;
+    size_t freeSpace;
+    size_t chunk;
+
+    stream->rxTransfersPending --;
+
+    if(!(stream->isStarted))
+    {
+        /* The stream was stopped or the device detached */
+        return;
+    }
+
+    if(transferData->result != USB_HOST_RESULT_SUCCESS)
+    {
+        /* The pipe has stalled or the transfer was aborted */
+        _USB_HOST_CDC_StreamStop(cdcInstance);
+        return;
+    }
+
+    /* Only the driver adds to the ring, so the free space can only grow
+     * while the data is copied */
+    freeSpace = USB_HOST_CDC_STREAM_BUFFER_SIZE - stream->rxUsed;
+    if(length > freeSpace)
+    {
+        stream->overflowCount += (uint32_t)(length - freeSpace);
+        length = freeSpace;
+    }
+
+    /* Copy up to the end of the ring and then wrap around */
+    chunk = USB_HOST_CDC_STREAM_BUFFER_SIZE - stream->rxWrite;
+    if(chunk > length)
+    {
+        chunk = length;
+    }
+
+    memcpy(stream->rxBuffer + stream->rxWrite, source, chunk);
+    memcpy(stream->rxBuffer, source + chunk, length - chunk);
+    stream->rxWrite = (stream->rxWrite + length) % USB_HOST_CDC_STREAM_BUFFER_SIZE;
+
+    /* The application releases ring space in USB_HOST_CDC_StreamReadCommit() */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    stream->rxUsed += length;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+    /* The transfer buffer is free again. Queue it before the application
+     * handles the data. */
+    if(_USB_HOST_CDC_StreamReadSubmit(cdcInstance, slot) != USB_HOST_RESULT_SUCCESS)
+    {
+        _USB_HOST_CDC_StreamStop(cdcInstance);
+    }
+
+    if((transferData->length > 0) && (cdcInstance->eventHandler != NULL))
+    {
+        /* Report everything that the application has not consumed yet */
+        dataAvailable.length = USB_HOST_CDC_STREAM_BUFFER_SIZE - stream->rxRead;
+        if(dataAvailable.length > stream->rxUsed)
+        {
+            dataAvailable.length = stream->rxUsed;
+        }
+
+        dataAvailable.data = stream->rxBuffer + stream->rxRead;
+        dataAvailable.wrapData = stream->rxBuffer;
+        dataAvailable.wrapLength = stream->rxUsed - dataAvailable.length;
+        dataAvailable.overflowCount = stream->overflowCount;
+
+        cdcInstance->eventHandler((USB_HOST_CDC_HANDLE)(cdcInstance), 
+                USB_HOST_CDC_EVENT_STREAM_READ_DATA_AVAILABLE, &dataAvailable,
+                cdcInstance->context);
+    }
+}
+
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_CDC_StreamWriteSubmit
+    (
+        USB_HOST_CDC_INSTANCE_OBJ * cdcInstance
+    )
+
+  Summary:
+    Submits queued transmit ring data on the bulk OUT pipe.
+
+  Description:
+    This function submits queued transmit ring data while fewer than
+    USB_HOST_CDC_STREAM_IRPS_NUMBER bulk OUT transfers are in flight. Small
+    writes are coalesced. A transfer carries a multiple of the bulk OUT maximum
+    packet size whenever at least one packet is queued. Less than a packet is
+    held back while another transfer is in flight, so that it is sent together
+    with the data that the application writes next. It is sent as a short
+    packet once the pipe is idle. The ring span and the transfer slot are
+    reserved in a critical section and the transfer is queued outside it. If
+    the pipe does not accept the transfer, the reservation is returned and the
+    stream is stopped.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application. It is called from the application context and from the bulk
+    OUT transfer complete event.
+*/
+
+static void _USB_HOST_CDC_StreamWriteSubmit
+(
+    USB_HOST_CDC_INSTANCE_OBJ * cdcInstance
+)
+{
+    USB_HOST_CDC_STREAM * stream = &cdcInstance->stream;
+    USB_HOST_TRANSFER_HANDLE transferHandle;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    unsigned int slot;
+    size_t length;
+    uint8_t * data;
+
+    /* The bulk OUT transfer complete event also calls this function. Only one
+     * context submits at a time, else transfers could be queued out of ring
+     * order. */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    if(stream->txSubmitting)
+    {
+        /* The submitting context checks the ring again after each
+         * transfer */
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+        return;
+    }
+    stream->txSubmitting = true;
+
+    while(true)
+    {
+        if(!(stream->isStarted) || (stream->txCommitted == 0)
+                || (stream->txTransfersPending >= USB_HOST_CDC_STREAM_IRPS_NUMBER))
+        {
+            break;
+        }
+
+        /* A transfer covers contiguous ring data only */
+        length = USB_HOST_CDC_STREAM_BUFFER_SIZE - stream->txSend;
+        if(length > stream->txCommitted)
+        {
+            length = stream->txCommitted;
+        }
+
+        if(length >= cdcInstance->bulkOutMaxPacketSize)
+        {
+            /* Send full packets. The rest is sent with the next transfer. */
+            length -= length % cdcInstance->bulkOutMaxPacketSize;
+        }
+        else if((stream->txTransfersPending > 0) && (length == stream->txCommitted))
+        {
+            /* Less than a packet is queued and the pipe is busy. Let the
+             * application add to it. */
+            break;
+        }
+
+        /* Reserve the ring span and the transfer slot. The transfer may
+         * complete before USB_HOST_DeviceTransfer() returns. */
+        slot = stream->txSubmit;
+        data = stream->txBuffer + stream->txSend;
+        stream->txLength[slot] = length;
+        stream->txTransfersPending ++;
+        stream->txSubmit = (stream->txSubmit + 1) % USB_HOST_CDC_STREAM_IRPS_NUMBER;
+        stream->txSend = (stream->txSend + length) % USB_HOST_CDC_STREAM_BUFFER_SIZE;
+        stream->txCommitted -= length;
+
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+        if(USB_HOST_DeviceTransfer(cdcInstance->bulkOutPipeHandle, &transferHandle, data, length,
+                    (uintptr_t)(USB_HOST_CDC_STREAM_CONTEXT_WRITE + slot)) != USB_HOST_RESULT_SUCCESS)
+        {
+            /* No other context has reserved since, so the reservation can
+             * be returned. The data stays queued in the ring. */
+            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+            stream->txTransfersPending --;
+            stream->txSubmit = slot;
+            stream->txSend = (size_t)(data - stream->txBuffer);
+            stream->txCommitted += length;
+            stream->txSubmitting = false;
+            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+            /* The pipe does not accept transfers. The stream must be started
+             * again. */
+            _USB_HOST_CDC_StreamStop(cdcInstance);
+            return;
+        }
+
+        IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    }
+
+    stream->txSubmitting = false;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+}
+
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_CDC_StreamWriteComplete
+    (
+        USB_HOST_CDC_INSTANCE_OBJ * cdcInstance,
+        unsigned int slot,
+        USB_HOST_DEVICE_INTERFACE_EVENT_TRANSFER_COMPLETE_DATA * transferData
+    )
+
+  Summary:
+    Handles the completion of a stream bulk OUT transfer.
+
+  Description:
+    This function releases the transmit ring space of the completed transfer
+    and submits the data that was queued in the meantime.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+static void _USB_HOST_CDC_StreamWriteComplete
+(
+    USB_HOST_CDC_INSTANCE_OBJ * cdcInstance,
+    unsigned int slot,
+    USB_HOST_DEVICE_INTERFACE_EVENT_TRANSFER_COMPLETE_DATA * transferData
+)
+{
+    USB_HOST_CDC_STREAM * stream = &cdcInstance->stream;
+
+    stream->txTransfersPending --;
+
+    if(!(stream->isStarted))
+    {
+        return;
+    }
+
+    if(transferData->result != USB_HOST_RESULT_SUCCESS)
+    {
+        _USB_HOST_CDC_StreamStop(cdcInstance);
+        return;
+    }
+
+    /* Release the ring space and keep the pipe busy */
+    stream->txUsed -= stream->txLength[slot];
+    _USB_HOST_CDC_StreamWriteSubmit(cdcInstance);
+}
+#endif
+
 // *****************************************************************************
 /* Function:
     USB_HOST_DEVICE_INTERFACE_EVENT_RESPONSE _USB_HOST_CDC_InterfaceEventHandler
@@ -948,6 +1334,26 @@ USB_HOST_DEVICE_INTERFACE_EVENT_RESPONSE _USB_HOST_CDC_InterfaceEventHandler
 
             /* This means a data transfer has completed */
             dataTransferEvent = (USB_HOST_DEVICE_INTERFACE_EVENT_TRANSFER_COMPLETE_DATA *)(eventData);
+
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+            if((context & USB_HOST_CDC_STREAM_CONTEXT_MASK) == USB_HOST_CDC_STREAM_CONTEXT_READ)
+            {
+                /* A stream bulk IN transfer. There is no read complete
+                 * event for this transfer. */
+                _USB_HOST_CDC_StreamReadComplete(cdcInstance, 
+                        (unsigned int)(context & USB_HOST_CDC_STREAM_CONTEXT_SLOT), dataTransferEvent);
+                break;
+            }
+
+            if((context & USB_HOST_CDC_STREAM_CONTEXT_MASK) == USB_HOST_CDC_STREAM_CONTEXT_WRITE)
+            {
+                /* A stream bulk OUT transfer */
+                _USB_HOST_CDC_StreamWriteComplete(cdcInstance, 
+                        (unsigned int)(context & USB_HOST_CDC_STREAM_CONTEXT_SLOT), dataTransferEvent);
+                break;
+            }
+#endif
+
             cdcTransferCompleteData.transferHandle = dataTransferEvent->transferHandle;
             cdcTransferCompleteData.result = _USB_HOST_CDC_HostResutlToCDCResultMap(dataTransferEvent->result);
             cdcTransferCompleteData.length = dataTransferEvent->length;
@@ -1034,6 +1440,12 @@ void _USB_HOST_CDC_InterfaceRelease
         {
             cdcInstance->inUse = false;
 
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+            /* Transfers that the pipe close returns must not be queued
+             * again */
+            cdcInstance->stream.isStarted = false;
+#endif
+
             if(cdcInstance->bulkInPipeHandle != USB_HOST_PIPE_HANDLE_INVALID)
             {
                 /* Close the bulk in pipe and invalidate the pipe handle */
@@ -1056,6 +1468,12 @@ void _USB_HOST_CDC_InterfaceRelease
                 cdcInstance->interruptPipeHandle = USB_HOST_PIPE_HANDLE_INVALID;
             }
 
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+            /* The pipes are closed. No stream transfer is in flight. */
+            cdcInstance->stream.rxTransfersPending = 0;
+            cdcInstance->stream.txTransfersPending = 0;
+#endif
+
             if(cdcInstance->eventHandler != NULL)
             {
                 /* Let the client know that the device is detached */
@@ -1581,4 +1999,321 @@ USB_HOST_CDC_RESULT USB_HOST_CDC_SerialStateNotificationGet
     return(cdcResult);
 }
 
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+// ****************************************************************************
+/* Function:
+    USB_HOST_CDC_RESULT USB_HOST_CDC_StreamStart
+    (
+        USB_HOST_CDC_HANDLE handle
+    );
+           
+  Summary:
+    Starts the streaming mode of a CDC instance.
+
+  Description:
+    This function empties the receive and transmit rings of the CDC instance
+    and queues USB_HOST_CDC_STREAM_IRPS_NUMBER bulk IN transfers on the bulk IN
+    pipe.
+
+  Remarks:
+    Refer to usb_host_cdc.h for usage information.
+*/
+
+USB_HOST_CDC_RESULT USB_HOST_CDC_StreamStart
+(
+    USB_HOST_CDC_HANDLE handle
+)
+{
+    USB_HOST_CDC_INSTANCE_OBJ * cdcInstance;
+    USB_HOST_CDC_STREAM * stream;
+    USB_HOST_RESULT hostResult = USB_HOST_RESULT_SUCCESS;
+    unsigned int slot;
+
+    cdcInstance = (USB_HOST_CDC_INSTANCE_OBJ *)handle;
+
+    if(cdcInstance == NULL)
+    {
+        /* This handle is not valid */
+        return(USB_HOST_CDC_RESULT_HANDLE_INVALID);
+    }
+
+    if(!cdcInstance->inUse)
+    {
+        /* This object is not valid */
+        return(USB_HOST_CDC_RESULT_DEVICE_UNKNOWN);
+    }
+
+    if(cdcInstance->state != USB_HOST_CDC_STATE_READY)
+    {
+        /* The instance is not ready for requests */
+        return(USB_HOST_CDC_RESULT_BUSY);
+    }
+
+    stream = &cdcInstance->stream;
+
+    if(stream->isStarted)
+    {
+        /* The bulk IN transfers are already queued */
+        return(USB_HOST_CDC_RESULT_SUCCESS);
+    }
+
+    if((cdcInstance->bulkInMaxPacketSize == 0) ||
+            ((USB_HOST_CDC_STREAM_TRANSFER_SIZE % cdcInstance->bulkInMaxPacketSize) != 0))
+    {
+        /* A transfer must end on a packet boundary, else a full packet
+         * from the device would overrun it */
+        return(USB_HOST_CDC_RESULT_INVALID_PARAMETER);
+    }
+
+    if((stream->rxTransfersPending != 0) || (stream->txTransfersPending != 0))
+    {
+        /* Transfers of the last stream have not completed yet */
+        return(USB_HOST_CDC_RESULT_BUSY);
+    }
+
+    slot = (unsigned int)(cdcInstance - gUSBHostCDCObj);
+
+    stream->rxTransferBuffer = gUSBHostCDCStreamTransferBuffer[slot];
+    stream->rxBuffer = gUSBHostCDCStreamRxBuffer[slot];
+    stream->rxRead = 0;
+    stream->rxWrite = 0;
+    stream->rxUsed = 0;
+    stream->overflowCount = 0;
+
+    stream->txBuffer = gUSBHostCDCStreamTxBuffer[slot];
+    stream->txSubmit = 0;
+    stream->txWrite = 0;
+    stream->txSend = 0;
+    stream->txCommitted = 0;
+    stream->txUsed = 0;
+    stream->txSubmitting = false;
+
+    stream->isStarted = true;
+
+    for(slot = 0; slot < USB_HOST_CDC_STREAM_IRPS_NUMBER; slot ++)
+    {
+        hostResult = _USB_HOST_CDC_StreamReadSubmit(cdcInstance, slot);
+        if(hostResult != USB_HOST_RESULT_SUCCESS)
+        {
+            /* The transfers that were queued complete without being queued
+             * again. The stream can be started once they have completed. */
+            stream->isStarted = false;
+            break;
+        }
+    }
+
+    return(_USB_HOST_CDC_HostResutlToCDCResultMap(hostResult));
+}
+
+// ****************************************************************************
+/* Function:
+    size_t USB_HOST_CDC_StreamReadAcquire
+    (
+        USB_HOST_CDC_HANDLE handle,
+        void ** data
+    );
+           
+  Summary:
+    Returns received data that the application can read in place.
+
+  Description:
+    This function returns a pointer to the oldest unread data in the receive
+    ring and the number of contiguous bytes available at that pointer.
+
+  Remarks:
+    Refer to usb_host_cdc.h for usage information.
+*/
+
+size_t USB_HOST_CDC_StreamReadAcquire
+(
+    USB_HOST_CDC_HANDLE handle,
+    void ** data
+)
+{
+    USB_HOST_CDC_INSTANCE_OBJ * cdcInstance = (USB_HOST_CDC_INSTANCE_OBJ *)handle;
+    USB_HOST_CDC_STREAM * stream;
+    size_t length;
+
+    if((cdcInstance == NULL) || (data == NULL) || (!cdcInstance->inUse))
+    {
+        return 0;
+    }
+
+    stream = &cdcInstance->stream;
+    if(stream->rxBuffer == NULL)
+    {
+        /* The stream was never started */
+        return 0;
+    }
+
+    /* Unread data up to the end of the ring. Data that was received before
+     * the stream stopped can still be read. */
+    length = USB_HOST_CDC_STREAM_BUFFER_SIZE - stream->rxRead;
+    if(length > stream->rxUsed)
+    {
+        length = stream->rxUsed;
+    }
+
+    *data = stream->rxBuffer + stream->rxRead;
+    return length;
+}
+
+// ****************************************************************************
+/* Function:
+    USB_HOST_CDC_RESULT USB_HOST_CDC_StreamReadCommit
+    (
+        USB_HOST_CDC_HANDLE handle,
+        size_t size
+    );
+           
+  Summary:
+    Releases received data that the application has consumed.
+
+  Description:
+    This function releases the first size unread bytes of the receive ring.
+
+  Remarks:
+    Refer to usb_host_cdc.h for usage information.
+*/
+
+USB_HOST_CDC_RESULT USB_HOST_CDC_StreamReadCommit
+(
+    USB_HOST_CDC_HANDLE handle,
+    size_t size
+)
+{
+    USB_HOST_CDC_INSTANCE_OBJ * cdcInstance = (USB_HOST_CDC_INSTANCE_OBJ *)handle;
+    USB_HOST_CDC_STREAM * stream;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+
+    if(cdcInstance == NULL)
+    {
+        return(USB_HOST_CDC_RESULT_HANDLE_INVALID);
+    }
+
+    stream = &cdcInstance->stream;
+    if(size > stream->rxUsed)
+    {
+        /* More data than was received */
+        return(USB_HOST_CDC_RESULT_INVALID_PARAMETER);
+    }
+
+    stream->rxRead = (stream->rxRead + size) % USB_HOST_CDC_STREAM_BUFFER_SIZE;
+
+    /* The bulk IN transfer complete event adds to this counter */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    stream->rxUsed -= size;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+    return(USB_HOST_CDC_RESULT_SUCCESS);
+}
+
+// ****************************************************************************
+/* Function:
+    uint32_t USB_HOST_CDC_StreamOverflowCountGet
+    (
+        USB_HOST_CDC_HANDLE handle
+    );
+           
+  Summary:
+    Returns the number of received bytes that were dropped.
+
+  Description:
+    This function returns the number of bytes that were dropped since the
+    stream was started because the receive ring was full.
+
+  Remarks:
+    Refer to usb_host_cdc.h for usage information.
+*/
+
+uint32_t USB_HOST_CDC_StreamOverflowCountGet
+(
+    USB_HOST_CDC_HANDLE handle
+)
+{
+    USB_HOST_CDC_INSTANCE_OBJ * cdcInstance = (USB_HOST_CDC_INSTANCE_OBJ *)handle;
+
+    if(cdcInstance == NULL)
+    {
+        return 0;
+    }
+
+    return(cdcInstance->stream.overflowCount);
+}
+
+// ****************************************************************************
+/* Function:
+    size_t USB_HOST_CDC_StreamWrite
+    (
+        USB_HOST_CDC_HANDLE handle,
+        const void * data,
+        size_t size
+    );
+           
+  Summary:
+    Queues data for transmission to the attached device.
+
+  Description:
+    This function copies as much of the data as fits to the transmit ring and
+    submits it on the bulk OUT pipe. Small writes are coalesced into transfers
+    of whole packets.
+
+  Remarks:
+    Refer to usb_host_cdc.h for usage information.
+*/
+
+size_t USB_HOST_CDC_StreamWrite
+(
+    USB_HOST_CDC_HANDLE handle,
+    const void * data,
+    size_t size
+)
+{
+    USB_HOST_CDC_INSTANCE_OBJ * cdcInstance = (USB_HOST_CDC_INSTANCE_OBJ *)handle;
+    USB_HOST_CDC_STREAM * stream;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    size_t freeSpace;
+    size_t chunk;
+
+    if((cdcInstance == NULL) || ((size != 0) && (data == NULL)))
+    {
+        return 0;
+    }
+
+    stream = &cdcInstance->stream;
+    if(!(cdcInstance->inUse) || !(stream->isStarted))
+    {
+        return 0;
+    }
+
+    /* Only the transfer complete event frees ring space, so the free space
+     * can only grow while the data is copied */
+    freeSpace = USB_HOST_CDC_STREAM_BUFFER_SIZE - stream->txUsed;
+    if(size > freeSpace)
+    {
+        size = freeSpace;
+    }
+
+    /* Copy up to the end of the ring and then wrap around */
+    chunk = USB_HOST_CDC_STREAM_BUFFER_SIZE - stream->txWrite;
+    if(chunk > size)
+    {
+        chunk = size;
+    }
+
+    memcpy(stream->txBuffer + stream->txWrite, data, chunk);
+    memcpy(stream->txBuffer, (const uint8_t *)data + chunk, size - chunk);
+    stream->txWrite = (stream->txWrite + size) % USB_HOST_CDC_STREAM_BUFFER_SIZE;
+
+    /* The bulk OUT transfer complete event updates these counters */
+    IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    stream->txUsed += size;
+    stream->txCommitted += size;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+    _USB_HOST_CDC_StreamWriteSubmit(cdcInstance);
+
+    return size;
+}
+#endif
 
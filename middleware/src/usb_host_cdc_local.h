@@ -69,6 +69,28 @@
 #define USB_CDC_RESET           (0xFF)
 #define MARK_RESET_RECOVERY     (0x0E)
 
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+
+/* Number of bulk IN transfers that a CDC stream keeps queued */
+#if !defined(USB_HOST_CDC_STREAM_IRPS_NUMBER)
+#define USB_HOST_CDC_STREAM_IRPS_NUMBER     2
+#endif
+
+/* Size of each bulk IN transfer of a CDC stream */
+#if !defined(USB_HOST_CDC_STREAM_TRANSFER_SIZE)
+#define USB_HOST_CDC_STREAM_TRANSFER_SIZE   512
+#endif
+
+/* Transfer contexts of the stream transfers. The existing transfers use the
+ * CDC event as context, so these values must not overlap the
+ * USB_HOST_CDC_EVENT values. The low byte holds the transfer slot. */
+#define USB_HOST_CDC_STREAM_CONTEXT_READ    0x100
+#define USB_HOST_CDC_STREAM_CONTEXT_WRITE   0x200
+#define USB_HOST_CDC_STREAM_CONTEXT_MASK    0xFF00
+#define USB_HOST_CDC_STREAM_CONTEXT_SLOT    0x00FF
+
+#endif
+
 
 
 /*****************************************
@@ -143,6 +165,70 @@ typedef struct
 
 } USB_HOST_CDC_ATTACH_LISTENER_OBJ;
 
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+
+/*************************************************
+ * CDC stream object. Holds the receive ring that
+ * the queued bulk IN transfers fill and the
+ * transmit ring that the bulk OUT transfers send.
+ *************************************************/
+typedef struct
+{
+    /* True if the stream has been started and no transfer has failed */
+    volatile bool isStarted;
+
+    /* Buffers of the bulk IN transfers. Each completed transfer is copied
+     * to the receive ring and queued again at once. */
+    uint8_t (* rxTransferBuffer)[USB_HOST_CDC_STREAM_TRANSFER_SIZE];
+
+    /* Number of bulk IN transfers queued on the pipe */
+    volatile unsigned int rxTransfersPending;
+
+    /* Receive ring */
+    uint8_t * rxBuffer;
+
+    /* Ring offsets at which the application reads and the driver writes */
+    size_t rxRead;
+    size_t rxWrite;
+
+    /* Received bytes that the application has not consumed */
+    volatile size_t rxUsed;
+
+    /* Received bytes dropped because the receive ring was full */
+    volatile uint32_t overflowCount;
+
+    /* Transmit ring */
+    uint8_t * txBuffer;
+
+    /* Length of each bulk OUT transfer in flight */
+    size_t txLength[USB_HOST_CDC_STREAM_IRPS_NUMBER];
+
+    /* Next bulk OUT transfer slot */
+    unsigned int txSubmit;
+
+    /* Number of bulk OUT transfers in flight */
+    volatile unsigned int txTransfersPending;
+
+    /* Ring offset at which the application writes next */
+    size_t txWrite;
+
+    /* Ring offset of the first queued byte that is not submitted */
+    size_t txSend;
+
+    /* Queued bytes that are not submitted yet */
+    volatile size_t txCommitted;
+
+    /* Queued bytes that are not sent yet. The rest of the ring is free. */
+    volatile size_t txUsed;
+
+    /* True while a context submits bulk OUT transfers. Other contexts leave
+     * the submit to it, so that transfers are queued in ring order. */
+    volatile bool txSubmitting;
+
+} USB_HOST_CDC_STREAM;
+
+#endif
+
 /*************************************
  * USB Host CDC Client Driver Object
  *************************************/
@@ -198,6 +284,15 @@ typedef struct
     uint8_t commInterfaceNumber;
     uint8_t dataInterfaceNumber;
 
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+    /* Maximum packet sizes of the bulk endpoints */
+    uint16_t bulkInMaxPacketSize;
+    uint16_t bulkOutMaxPacketSize;
+
+    /* Streaming mode rings */
+    USB_HOST_CDC_STREAM stream;
+#endif
+
 } USB_HOST_CDC_INSTANCE_OBJ;
 
 extern USB_HOST_CDC_INSTANCE_OBJ gUSBHostCDCObj[USB_HOST_CDC_INSTANCES_NUMBER];
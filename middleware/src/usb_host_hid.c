@@ -114,6 +114,25 @@ USB_HOST_HID_OBJECT_HANDLE_POOL gUSBHostHIDObjectHandlePool
  **************************************************/
 USB_HOST_HID_INSTANCE  gUSBHostHIDInstance[USB_HOST_HID_INSTANCES_NUMBER];
 
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+/**************************************************
+ * Report buffers of the batched report engine. Each
+ * HID instance owns USB_HOST_HID_REPORT_BUFFERS_NUMBER
+ * buffers.
+ **************************************************/
+uint8_t gUSBHostHIDReportBuffer[USB_HOST_HID_INSTANCES_NUMBER]
+        [USB_HOST_HID_REPORT_BUFFERS_NUMBER][64] USB_ALIGN;
+
+/**************************************************
+ * Ready queue of received reports shared by all HID
+ * instances. Entries are added from the transfer
+ * complete event and removed from the task routine.
+ **************************************************/
+USB_HOST_HID_READY_REPORT gUSBHostHIDReadyQueue[USB_HOST_HID_READY_QUEUE_SIZE];
+volatile uint16_t gUSBHostHIDReadyQueueIn = 0;
+volatile uint16_t gUSBHostHIDReadyQueueOut = 0;
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // USB Host HID Local Functions
@@ -1937,13 +1956,14 @@ USB_HOST_HID_RESULT _USB_HOST_HID_ReportDescriptorGet
         
         if(NULL != hidInstanceInfo->reportDescBuffer)
         {
-            USB_HOST_FREE(hidInstanceInfo->reportDescBuffer);
+            _USB_HOST_BufferFree(hidInstanceInfo->reportDescBuffer);
             hidInstanceInfo->reportDescBuffer = NULL;
         }
 
         /* Allocate the memory for Report Descriptor Buffer */
         hidInstanceInfo->reportDescBuffer = 
-                USB_HOST_MALLOC((size_t)(hidInstanceInfo->reportDescLength));
+                _USB_HOST_BufferAllocate(USB_HOST_BUS_NUMBER(hidInstanceInfo->deviceObjHandle),
+                (size_t)(hidInstanceInfo->reportDescLength));
         if(NULL == hidInstanceInfo->reportDescBuffer)
         {
             /* Memory Allocation failed */
@@ -2409,6 +2429,12 @@ void _USB_HOST_HID_Initialize(void * hidInitData)
         memset(hidInstanceInfo->globalStack, 0,
                 (size_t)(sizeof(USB_HOST_HID_GLOBAL_ITEM) * 
                 USB_HID_GLOBAL_PUSH_POP_STACK_SIZE));
+#if defined(USB_HOST_HID_MAIN_ITEM_INDEX_SIZE)
+        hidInstanceInfo->mainItemIndexCount = 0;
+#endif
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+        _USB_HOST_HID_ReportEngineReset(iterator);
+#endif
 
         /* Make sure all the pipe handles are invalid */
         hidInstanceInfo->controlPipeHandle = USB_HOST_CONTROL_PIPE_HANDLE_INVALID;
@@ -2430,6 +2456,10 @@ void _USB_HOST_HID_Initialize(void * hidInitData)
         hidInstanceInfo->interruptOutPipeHandle = USB_HOST_PIPE_HANDLE_INVALID;
         hidInstanceInfo->state = USB_HOST_HID_STATE_WAIT;
     }
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+    gUSBHostHIDReadyQueueIn = 0;
+    gUSBHostHIDReadyQueueOut = 0;
+#endif
     
     if(NULL != hidInitData)
     {
@@ -2935,6 +2965,12 @@ void _USB_HOST_HID_InterfaceRelease
         memset(hidInstanceInfo->globalStack, 0,
                 (size_t)(sizeof(USB_HOST_HID_GLOBAL_ITEM) * 
                     USB_HID_GLOBAL_PUSH_POP_STACK_SIZE));
+#if defined(USB_HOST_HID_MAIN_ITEM_INDEX_SIZE)
+        hidInstanceInfo->mainItemIndexCount = 0;
+#endif
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+        _USB_HOST_HID_ReportEngineReset((uint8_t)hidInstanceIndex);
+#endif
         
         /* Reset request Object for this HID instance */
         hidInstanceInfo->requestObj.controlRequestDone = true;
@@ -3062,6 +3098,16 @@ USB_HOST_DEVICE_INTERFACE_EVENT_RESPONSE _USB_HOST_HID_InterfaceEventHandler
                 transferCompleteEventData =
                         (USB_HOST_DEVICE_INTERFACE_EVENT_TRANSFER_COMPLETE_DATA *)
                             (eventData);
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+                if((_USB_HOST_HID_ReportReceived((uint8_t)hidInstanceIndex,
+                        transferCompleteEventData)) &&
+                        (USB_HOST_RESULT_SUCCESS == transferCompleteEventData->result))
+                {
+                    /* The report is in the ready queue. The usage drivers get
+                     * it when the queue is drained in the task routine. */
+                    break;
+                }
+#endif
                 if(USB_HOST_RESULT_SUCCESS == transferCompleteEventData->result)
                 {
                     /* isHIDDriverAttached is true only if for this HID instance at
@@ -4147,6 +4193,11 @@ USB_HOST_HID_RESULT _USB_HOST_HID_ItemGet
                                     .type = 0,
                                     .tag = 0
                                  };
+#if defined(USB_HOST_HID_MAIN_ITEM_INDEX_SIZE)
+    USB_HOST_HID_INSTANCE *hidInstanceInfo = &gUSBHostHIDInstance[hidInstanceIndex];
+    USB_HOST_HID_MAIN_ITEM_INDEX *indexEntry = NULL;
+    uint8_t entryIndex = 0;
+#endif
     /* End of local variables */
     
     if(0 == index)
@@ -4159,6 +4210,41 @@ USB_HOST_HID_RESULT _USB_HOST_HID_ItemGet
     }
     else
     {
+#if defined(USB_HOST_HID_MAIN_ITEM_INDEX_SIZE)
+        if(!hidInstanceInfo->topLevelUsageProcessing)
+        {
+            /* Find the closest main item before the requested one from which
+             * parsing can resume. The entry of main item N is mainItemIndex[N-1]. */
+            entryIndex = index - 1;
+            if(entryIndex > hidInstanceInfo->mainItemIndexCount)
+            {
+                entryIndex = hidInstanceInfo->mainItemIndexCount;
+            }
+            while((entryIndex > 0) &&
+                    (!hidInstanceInfo->mainItemIndex[entryIndex - 1].isValid))
+            {
+                entryIndex--;
+            }
+
+            if(entryIndex > 0)
+            {
+                /* Restore the global items that were in effect after this
+                 * main item and continue parsing from the item following it */
+                indexEntry = &hidInstanceInfo->mainItemIndex[entryIndex - 1];
+                memcpy(hidInstanceInfo->mainItemData->globalItem,
+                        &indexEntry->globalItem, sizeof(USB_HOST_HID_GLOBAL_ITEM));
+                hidInstanceInfo->globalStackIndex = 0;
+                startAddress = startAddress + indexEntry->offset;
+                fieldCount = entryIndex;
+
+                if(startAddress == endAddress)
+                {
+                    /* There is no main item after this one */
+                    return USB_HOST_HID_RESULT_FAILURE;
+                }
+            }
+        }
+#endif
         do
         {
             startAddress = _USB_HOST_HID_ItemFetch(startAddress, endAddress, &itemData);
@@ -4295,6 +4381,479 @@ USB_HOST_HID_RESULT _USB_HOST_HID_ItemGet
 } /* End of _USB_HOST_HID_ItemGet() */
 
 
+#if defined(USB_HOST_HID_MAIN_ITEM_INDEX_SIZE)
+/*************************************************************************/
+/* Function:
+    void _USB_HOST_HID_MainItemIndexBuild(uint8_t hidInstanceIndex)
+
+  Summary:
+    Function builds the main item index of the Report Descriptor.
+
+  Description:
+    Function parses the Report Descriptor once and saves, for every valid main
+    item, the Report Descriptor offset of the next item and the global items
+    in effect at that point. _USB_HOST_HID_ItemGet() uses this index to resume
+    parsing close to the queried main item.
+
+  Remarks:
+    This is local function and should not be called directly by the application
+*/
+
+void _USB_HOST_HID_MainItemIndexBuild(uint8_t hidInstanceIndex)
+{
+    /* Start of local variables */
+    USB_HOST_HID_INSTANCE *hidInstanceInfo = &gUSBHostHIDInstance[hidInstanceIndex];
+    uint8_t *descriptorStart = hidInstanceInfo->reportDescBuffer;
+    uint8_t *startAddress = descriptorStart;
+    uint8_t *endAddress = startAddress + hidInstanceInfo->reportDescLength;
+    uint8_t collectionNestingLevel = hidInstanceInfo->collectionNestingLevel;
+    USB_HOST_HID_MAIN_ITEM *mainItemData = hidInstanceInfo->mainItemData;
+    USB_HOST_HID_RESULT result = USB_HOST_HID_RESULT_SUCCESS;
+    USB_HOST_HID_MAIN_ITEM_INDEX *indexEntry = NULL;
+    USB_HOST_HID_LOCAL_ITEM localItem;
+    USB_HOST_HID_GLOBAL_ITEM globalItem;
+    USB_HOST_HID_MAIN_ITEM mainItem;
+    USB_HOST_HID_ITEM itemData = {
+                                    .optionalItemData.signedData32 = 0,
+                                    .size = 0,
+                                    .type = 0,
+                                    .tag = 0
+                                 };
+    /* End of local variables */
+
+    hidInstanceInfo->isFieldProcessing = true;
+    hidInstanceInfo->mainItemIndexCount = 0;
+    hidInstanceInfo->globalStackIndex = 0;
+
+    memset(&localItem, 0, (size_t)sizeof(USB_HOST_HID_LOCAL_ITEM));
+    memset(&globalItem, 0, (size_t)sizeof(USB_HOST_HID_GLOBAL_ITEM));
+    memset(&(mainItem.data), 0, (size_t)sizeof(USB_HID_MAIN_ITEM_OPTIONAL_DATA));
+    mainItem.tag = 0;
+    mainItem.localItem = &localItem;
+    mainItem.globalItem = &globalItem;
+    hidInstanceInfo->mainItemData = &mainItem;
+
+    while((startAddress != endAddress) && (NULL != startAddress) &&
+            (USB_HOST_HID_RESULT_SUCCESS == result) &&
+            (hidInstanceInfo->mainItemIndexCount < USB_HOST_HID_MAIN_ITEM_INDEX_SIZE))
+    {
+        startAddress = _USB_HOST_HID_ItemFetch(startAddress, endAddress, &itemData);
+        if(NULL == startAddress)
+        {
+            /* Invalid item. The index ends here. */
+        }
+        else if(USB_HID_REPORT_ITEM_HEADER_BTYPE_MAIN == itemData.type)
+        {
+            /* Only main items that are counted by _USB_HOST_HID_ItemGet() get
+             * an index entry */
+            if(USB_HOST_HID_RESULT_SUCCESS ==
+                    _USB_HOST_HID_MainItemParse(hidInstanceIndex, &itemData))
+            {
+                indexEntry = &hidInstanceInfo->mainItemIndex[hidInstanceInfo->mainItemIndexCount];
+                indexEntry->offset = (uint16_t)(startAddress - descriptorStart);
+                indexEntry->isValid = (0 == hidInstanceInfo->globalStackIndex);
+                memcpy(&indexEntry->globalItem, &globalItem,
+                        sizeof(USB_HOST_HID_GLOBAL_ITEM));
+                hidInstanceInfo->mainItemIndexCount++;
+            }
+        }
+        else if(USB_HID_REPORT_ITEM_HEADER_BTYPE_GLOBAL == itemData.type)
+        {
+            /* A global item parse failure ends every query past this point.
+             * There is nothing to index after it. */
+            result = _USB_HOST_HID_GlobalItemParse(hidInstanceIndex, &itemData);
+        }
+        else
+        {
+            /* Local items apply to the next main item only */
+        }
+    }
+
+    /* Restore the parser state */
+    hidInstanceInfo->mainItemData = mainItemData;
+    hidInstanceInfo->collectionNestingLevel = collectionNestingLevel;
+    hidInstanceInfo->globalStackIndex = 0;
+    hidInstanceInfo->isFieldProcessing = false;
+
+} /* End of _USB_HOST_HID_MainItemIndexBuild() */
+#endif
+
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+/*************************************************************************/
+/* Function:
+    void _USB_HOST_HID_ReportEngineReset(uint8_t hidInstanceIndex)
+
+  Summary:
+    Function resets the batched report engine state of a HID instance.
+
+  Description:
+    Function marks all report buffers and INTERRUPT IN pipes of the HID
+    instance as free. Changing reportEpoch makes the ready queue drop the
+    reports that are still queued for this instance.
+
+  Remarks:
+    This is local function and should not be called directly by the application
+*/
+
+void _USB_HOST_HID_ReportEngineReset(uint8_t hidInstanceIndex)
+{
+    /* Start of local variables */
+    USB_HOST_HID_INSTANCE * hidInstanceInfo = &gUSBHostHIDInstance[hidInstanceIndex];
+    uint8_t loop = 0;
+    /* End of local variables */
+
+    for(loop = 0; loop < USB_HOST_HID_INTERRUPT_IN_ENDPOINTS_NUMBER; loop++)
+    {
+        hidInstanceInfo->reportTransferHandle[loop] = USB_HOST_TRANSFER_HANDLE_INVALID;
+        hidInstanceInfo->reportFillBuffer[loop] = USB_HOST_HID_REPORT_BUFFER_NONE;
+    }
+    hidInstanceInfo->reportBufferMask = 0;
+    hidInstanceInfo->reportQueuedMask = 0;
+    hidInstanceInfo->reportLastBuffer = USB_HOST_HID_REPORT_BUFFER_NONE;
+    hidInstanceInfo->reportLastLength = 0;
+    hidInstanceInfo->reportCoalesce = false;
+    hidInstanceInfo->reportEpoch++;
+
+} /* End of _USB_HOST_HID_ReportEngineReset() */
+
+
+/*************************************************************************/
+/* Function:
+    void _USB_HOST_HID_ReportCoalesceCheck(uint8_t hidInstanceIndex)
+
+  Summary:
+    Function decides if unchanged reports of a HID instance can be coalesced.
+
+  Description:
+    A report equal to the previous report carries no new information for
+    absolute data such as buttons, keys or positions. Relative data such as
+    mouse movement is repeated on purpose. The function scans the Report
+    Descriptor and allows coalescing only if no INPUT item is relative.
+
+  Remarks:
+    This is local function and should not be called directly by the application
+*/
+
+void _USB_HOST_HID_ReportCoalesceCheck(uint8_t hidInstanceIndex)
+{
+    /* Start of local variables */
+    USB_HOST_HID_INSTANCE * hidInstanceInfo = &gUSBHostHIDInstance[hidInstanceIndex];
+    uint8_t *startAddress = hidInstanceInfo->reportDescBuffer;
+    uint8_t *endAddress = startAddress + hidInstanceInfo->reportDescLength;
+    USB_HID_MAIN_ITEM_OPTIONAL_DATA inputData;
+    USB_HOST_HID_ITEM itemData = {
+                                    .optionalItemData.signedData32 = 0,
+                                    .size = 0,
+                                    .type = 0,
+                                    .tag = 0
+                                 };
+    /* End of local variables */
+
+    hidInstanceInfo->reportCoalesce = true;
+
+    while((startAddress != endAddress) && (NULL != startAddress))
+    {
+        /* Items without data leave the optional data untouched */
+        itemData.optionalItemData.signedData32 = 0;
+        startAddress = _USB_HOST_HID_ItemFetch(startAddress, endAddress, &itemData);
+        if((NULL != startAddress) &&
+                (USB_HID_REPORT_ITEM_HEADER_BTYPE_MAIN == itemData.type) &&
+                (USB_HID_MAIN_ITEM_TAG_INPUT == itemData.tag))
+        {
+            inputData.data4Bytes = itemData.optionalItemData.unsignedData32;
+            if(inputData.inputOptionalData.isRelative)
+            {
+                hidInstanceInfo->reportCoalesce = false;
+                break;
+            }
+        }
+    }
+
+} /* End of _USB_HOST_HID_ReportCoalesceCheck() */
+
+
+/*************************************************************************/
+/* Function:
+    void _USB_HOST_HID_ReportTransfersSubmit(uint8_t hidInstanceIndex)
+
+  Summary:
+    Function submits INTERRUPT IN transfers on the idle pipes of a HID
+    instance.
+
+  Description:
+    Every idle INTERRUPT IN pipe gets a free report buffer and a new transfer.
+    The instance moves to the WAIT state once all pipes have a transfer
+    pending. If all report buffers are waiting in the ready queue the instance
+    stays in the READY state and the submission is tried again in the next
+    task routine call.
+
+  Remarks:
+    This is local function and should not be called directly by the application
+*/
+
+void _USB_HOST_HID_ReportTransfersSubmit(uint8_t hidInstanceIndex)
+{
+    /* Start of local variables */
+    USB_HOST_HID_INSTANCE * hidInstanceInfo = &gUSBHostHIDInstance[hidInstanceIndex];
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    bool allPipesBusy = true;
+    uint8_t buffer = 0;
+    uint8_t loop = 0;
+    /* End of local variables */
+
+    for(loop = 0; loop < USB_HOST_HID_INTERRUPT_IN_ENDPOINTS_NUMBER; loop++)
+    {
+        if(USB_HOST_PIPE_HANDLE_INVALID == hidInstanceInfo->interruptInPipeHandle[loop])
+        {
+            break;
+        }
+        if(USB_HOST_TRANSFER_HANDLE_INVALID != hidInstanceInfo->reportTransferHandle[loop])
+        {
+            /* A transfer is pending on this pipe */
+            continue;
+        }
+
+        /* Find a free report buffer */
+        IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+        for(buffer = 0; buffer < USB_HOST_HID_REPORT_BUFFERS_NUMBER; buffer++)
+        {
+            if(0 == (hidInstanceInfo->reportBufferMask & (1u << buffer)))
+            {
+                hidInstanceInfo->reportBufferMask |= (1u << buffer);
+                break;
+            }
+        }
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+        if(USB_HOST_HID_REPORT_BUFFERS_NUMBER == buffer)
+        {
+            /* All buffers are waiting to be processed */
+            allPipesBusy = false;
+            break;
+        }
+
+        /* The transfer handle is updated before the transfer can complete.
+         * The transfer complete event uses it to find the pipe. */
+        hidInstanceInfo->reportFillBuffer[loop] = buffer;
+        if(USB_HOST_RESULT_SUCCESS != USB_HOST_DeviceTransfer
+                (
+                 hidInstanceInfo->interruptInPipeHandle[loop],
+                 &hidInstanceInfo->reportTransferHandle[loop],
+                 gUSBHostHIDReportBuffer[hidInstanceIndex][buffer],
+                 hidInstanceInfo->interruptInEndpointSize[loop],
+                 (uintptr_t)(hidInstanceInfo)
+                ))
+        {
+            hidInstanceInfo->reportTransferHandle[loop] = USB_HOST_TRANSFER_HANDLE_INVALID;
+            hidInstanceInfo->reportFillBuffer[loop] = USB_HOST_HID_REPORT_BUFFER_NONE;
+            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+            hidInstanceInfo->reportBufferMask &= ~(1u << buffer);
+            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+            allPipesBusy = false;
+        }
+    }
+
+    if(allPipesBusy && (0 != loop))
+    {
+        hidInstanceInfo->state = USB_HOST_HID_STATE_WAIT;
+    }
+
+} /* End of _USB_HOST_HID_ReportTransfersSubmit() */
+
+
+/*************************************************************************/
+/* Function:
+    bool _USB_HOST_HID_ReportReceived
+    (
+        uint8_t hidInstanceIndex,
+        USB_HOST_DEVICE_INTERFACE_EVENT_TRANSFER_COMPLETE_DATA * transferData
+    )
+
+  Summary:
+    Function adds a received INTERRUPT IN report to the ready queue.
+
+  Description:
+    Function finds the INTERRUPT IN pipe of the completed transfer. A report
+    that is equal to the last report of the instance is dropped if the
+    instance allows coalescing. Any other report becomes the last report and
+    is added to the ready queue. The buffer of a failed transfer is released.
+
+    Function returns true if the transfer was an INTERRUPT IN report transfer
+    and false otherwise.
+
+  Remarks:
+    This is local function and should not be called directly by the
+    application. Function is called from the transfer complete event, which
+    can run in interrupt context.
+*/
+
+bool _USB_HOST_HID_ReportReceived
+(
+    uint8_t hidInstanceIndex,
+    USB_HOST_DEVICE_INTERFACE_EVENT_TRANSFER_COMPLETE_DATA * transferData
+)
+{
+    /* Start of local variables */
+    USB_HOST_HID_INSTANCE * hidInstanceInfo = &gUSBHostHIDInstance[hidInstanceIndex];
+    USB_HOST_HID_READY_REPORT * readyReport = NULL;
+    uint16_t queueIn = 0;
+    uint8_t lastBuffer = 0;
+    uint8_t buffer = 0;
+    uint8_t loop = 0;
+    /* End of local variables */
+
+    for(loop = 0; loop < USB_HOST_HID_INTERRUPT_IN_ENDPOINTS_NUMBER; loop++)
+    {
+        if((USB_HOST_TRANSFER_HANDLE_INVALID != hidInstanceInfo->reportTransferHandle[loop]) &&
+                (transferData->transferHandle == hidInstanceInfo->reportTransferHandle[loop]))
+        {
+            break;
+        }
+    }
+    if(USB_HOST_HID_INTERRUPT_IN_ENDPOINTS_NUMBER == loop)
+    {
+        /* Not an INTERRUPT IN report transfer */
+        return false;
+    }
+
+    buffer = hidInstanceInfo->reportFillBuffer[loop];
+    hidInstanceInfo->reportFillBuffer[loop] = USB_HOST_HID_REPORT_BUFFER_NONE;
+    hidInstanceInfo->reportTransferHandle[loop] = USB_HOST_TRANSFER_HANDLE_INVALID;
+
+    if((USB_HOST_RESULT_SUCCESS != transferData->result) ||
+            (!hidInstanceInfo->isHIDDriverAttached))
+    {
+        /* Nobody will look at this report */
+        hidInstanceInfo->reportBufferMask &= ~(1u << buffer);
+        return true;
+    }
+
+    lastBuffer = hidInstanceInfo->reportLastBuffer;
+    if((hidInstanceInfo->reportCoalesce) &&
+            (USB_HOST_HID_REPORT_BUFFER_NONE != lastBuffer) &&
+            (transferData->length == hidInstanceInfo->reportLastLength) &&
+            (0 == memcmp(gUSBHostHIDReportBuffer[hidInstanceIndex][buffer],
+                    gUSBHostHIDReportBuffer[hidInstanceIndex][lastBuffer],
+                    transferData->length)))
+    {
+        /* Unchanged report. The usage drivers already have this data. */
+        hidInstanceInfo->reportBufferMask &= ~(1u << buffer);
+        return true;
+    }
+
+    queueIn = gUSBHostHIDReadyQueueIn;
+    if(((queueIn + 1) % USB_HOST_HID_READY_QUEUE_SIZE) == gUSBHostHIDReadyQueueOut)
+    {
+        /* The ready queue is full of reports of released instances. Drop
+         * this report. */
+        hidInstanceInfo->reportBufferMask &= ~(1u << buffer);
+        return true;
+    }
+
+    /* This report is the new reference for coalescing. The previous last
+     * buffer is free unless it is still waiting in the ready queue. */
+    if((USB_HOST_HID_REPORT_BUFFER_NONE != lastBuffer) &&
+            (0 == (hidInstanceInfo->reportQueuedMask & (1u << lastBuffer))))
+    {
+        hidInstanceInfo->reportBufferMask &= ~(1u << lastBuffer);
+    }
+    hidInstanceInfo->reportLastBuffer = buffer;
+    hidInstanceInfo->reportLastLength = transferData->length;
+    hidInstanceInfo->reportQueuedMask |= (1u << buffer);
+
+    readyReport = &gUSBHostHIDReadyQueue[queueIn];
+    readyReport->hidInstanceIndex = hidInstanceIndex;
+    readyReport->buffer = buffer;
+    readyReport->epoch = hidInstanceInfo->reportEpoch;
+    gUSBHostHIDReadyQueueIn = (queueIn + 1) % USB_HOST_HID_READY_QUEUE_SIZE;
+
+    return true;
+
+} /* End of _USB_HOST_HID_ReportReceived() */
+
+
+/*************************************************************************/
+/* Function:
+    void _USB_HOST_HID_ReadyQueueDrain(void)
+
+  Summary:
+    Function hands all queued reports to the usage drivers.
+
+  Description:
+    Function processes the ready queue of all HID instances in one pass. Each
+    usage driver of the instance gets a USB_HOST_HID_EVENT_REPORT_RECEIVED
+    event with a pointer to the report buffer followed by a call to its task
+    routine. The buffer is released after the task routines have returned, so
+    the report is not copied on its way to the usage drivers.
+
+  Remarks:
+    This is local function and should not be called directly by the application
+*/
+
+void _USB_HOST_HID_ReadyQueueDrain(void)
+{
+    /* Start of local variables */
+    USB_HOST_HID_INSTANCE * hidInstanceInfo = NULL;
+    USB_HOST_HID_READY_REPORT * readyReport = NULL;
+    USB_HOST_HID_USAGE_DRIVER_TABLE_ENTRY * usageDriverTableEntry = NULL;
+    USB_HOST_HID_OBJ_HANDLE handle = USB_HOST_HID_OBJ_HANDLE_INVALID;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    uint16_t queueOut = gUSBHostHIDReadyQueueOut;
+    uint8_t index = 0;
+    /* End of local variables */
+
+    usageDriverTableEntry = gUSBHostHIDInitData->usageDriverTable;
+
+    while(queueOut != gUSBHostHIDReadyQueueIn)
+    {
+        readyReport = &gUSBHostHIDReadyQueue[queueOut];
+        hidInstanceInfo = &gUSBHostHIDInstance[readyReport->hidInstanceIndex];
+
+        if((hidInstanceInfo->assigned) && (hidInstanceInfo->isHIDDriverAttached) &&
+                (readyReport->epoch == hidInstanceInfo->reportEpoch))
+        {
+            for(index = 0; index < USB_HOST_HID_USAGE_DRIVER_SUPPORT_NUMBER;
+                    index ++)
+            {
+                if(gUSBHostHIDObjectHandlePool[index].inUse &&
+                        (gUSBHostHIDObjectHandlePool[index].hidInstanceIndex ==
+                         readyReport->hidInstanceIndex))
+                {
+                    handle = (USB_HOST_HID_OBJ_HANDLE)&gUSBHostHIDObjectHandlePool[index];
+                    ((&usageDriverTableEntry
+                        [gUSBHostHIDObjectHandlePool[index].usageInstanceIndex])
+                            ->interface)->usageDriverEventHandler
+                        (
+                            handle,
+                            USB_HOST_HID_EVENT_REPORT_RECEIVED,
+                            gUSBHostHIDReportBuffer[readyReport->hidInstanceIndex]
+                                [readyReport->buffer]
+                        );
+                    ((&usageDriverTableEntry
+                        [gUSBHostHIDObjectHandlePool[index].usageInstanceIndex])
+                            ->interface)->usageDriverTask(handle);
+                }
+            }
+
+            /* Release the buffer. The last report stays allocated as it is
+             * the reference for coalescing. */
+            IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+            hidInstanceInfo->reportQueuedMask &= ~(1u << readyReport->buffer);
+            if(readyReport->buffer != hidInstanceInfo->reportLastBuffer)
+            {
+                hidInstanceInfo->reportBufferMask &= ~(1u << readyReport->buffer);
+            }
+            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+        }
+
+        queueOut = (queueOut + 1) % USB_HOST_HID_READY_QUEUE_SIZE;
+        gUSBHostHIDReadyQueueOut = queueOut;
+    }
+
+} /* End of _USB_HOST_HID_ReadyQueueDrain() */
+#endif
+
+
 /*************************************************************************/
 /* Function:
     USB_HOST_HID_RESULT USB_HOST_HID_MainItemGet
@@ -4970,6 +5529,9 @@ void _USB_HOST_HID_InterfaceTasks(USB_HOST_DEVICE_INTERFACE_HANDLE interfaceHand
                 /* Reset the global parameters */
                 hidInstanceInfo->nTopLevelUsages = 0;
                 hidInstanceInfo->collectionNestingLevel = 0;
+#if defined(USB_HOST_HID_MAIN_ITEM_INDEX_SIZE)
+                hidInstanceInfo->mainItemIndexCount = 0;
+#endif
 
                 /* The below function call will traverse across
                  * the entire Report Descriptor and will extract all
@@ -4988,6 +5550,15 @@ void _USB_HOST_HID_InterfaceTasks(USB_HOST_DEVICE_INTERFACE_HANDLE interfaceHand
                 }
                 else
                 {
+#if defined(USB_HOST_HID_MAIN_ITEM_INDEX_SIZE)
+                    /* Index the main items so that field queries from the
+                     * usage drivers do not parse the Report Descriptor from
+                     * the start */
+                    _USB_HOST_HID_MainItemIndexBuild((uint8_t)hidInstanceIndex);
+#endif
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+                    _USB_HOST_HID_ReportCoalesceCheck((uint8_t)hidInstanceIndex);
+#endif
                     hidInstanceInfo->state = USB_HOST_HID_STATE_ATTACHED;
                 }
 
@@ -5074,6 +5645,9 @@ void _USB_HOST_HID_InterfaceTasks(USB_HOST_DEVICE_INTERFACE_HANDLE interfaceHand
                 }
                 break;
             case USB_HOST_HID_STATE_READY:
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+                _USB_HOST_HID_ReportTransfersSubmit((uint8_t)hidInstanceIndex);
+#else
                 /* Start submitting INTERRUPT IN requests */
                 for(loop = 0; loop < USB_HOST_HID_INTERRUPT_IN_ENDPOINTS_NUMBER;
                         loop++)
@@ -5096,6 +5670,7 @@ void _USB_HOST_HID_InterfaceTasks(USB_HOST_DEVICE_INTERFACE_HANDLE interfaceHand
                         hidInstanceInfo->state = USB_HOST_HID_STATE_WAIT;
                     }
                 }
+#endif
                 break;
             case USB_HOST_HID_STATE_WAIT:
                 break;
@@ -5196,6 +5771,20 @@ void _USB_HOST_HID_InterfaceTasks(USB_HOST_DEVICE_INTERFACE_HANDLE interfaceHand
                 break;
         }
 
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+        /* The reports and the usage driver tasks of all HID instances are
+         * processed once per host task pass, by the lowest assigned
+         * instance. */
+        for(loop = 0; loop < hidInstanceIndex; loop++)
+        {
+            if(gUSBHostHIDInstance[loop].assigned)
+            {
+                return;
+            }
+        }
+        _USB_HOST_HID_ReadyQueueDrain();
+#endif
+
         usageDriverTableEntry = gUSBHostHIDInitData->usageDriverTable;
         for(index = 0; index < USB_HOST_HID_USAGE_DRIVER_SUPPORT_NUMBER;
                 index ++)
@@ -245,6 +245,9 @@ void _USB_HOST_HID_KEYBOARD_EventHandler
                                 sizeof(keyboardData[loop].lastKeyCode));
                         memset((void *)keyboardData[loop].buffer, 0,
                                 sizeof(keyboardData[loop].buffer));
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+                        keyboardData[loop].report = NULL;
+#endif
                         break;
                     }
                 }
@@ -314,6 +317,14 @@ void _USB_HOST_HID_KEYBOARD_EventHandler
                 }
                 if(loop != USB_HOST_HID_USAGE_DRIVER_SUPPORT_NUMBER)
                 {
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+                    /* Batched report engine. The HID client driver runs the
+                     * task routine right after this event, so keep a
+                     * reference to its buffer instead of queueing a copy. */
+                    keyboardData[loop].report = (int8_t *)eventData;
+                    keyboardData[loop].state = 
+                                    USB_HOST_HID_KEYBOARD_REPORT_PROCESS;
+#else
                     memcpy((void *)keyboardData[loop].buffer[keyboardData[loop].index].data,
                                     (const void *)eventData, 64);
                     
@@ -347,6 +358,7 @@ void _USB_HOST_HID_KEYBOARD_EventHandler
                         keyboardData[loop].buffer[keyboardData[loop].index].tobeDone
                             = false;
                     }
+#endif
                 }
                 else
                 {
@@ -394,7 +406,8 @@ void _USB_HOST_HID_KEYBOARD_Task(USB_HOST_HID_OBJ_HANDLE handle)
     int64_t keyboardDataBufferTemp = 0;
     int8_t * keyboardDataBuffer = NULL;
     int8_t *ptr = NULL;
-    int8_t dataTemp[64] = {0};
+    int8_t * reportData = NULL;
+    int8_t * fieldData = NULL;
     
     uint32_t reportOffset = 0;
     uint32_t currentReportOffsetTemp = 0;
@@ -402,11 +415,12 @@ void _USB_HOST_HID_KEYBOARD_Task(USB_HOST_HID_OBJ_HANDLE handle)
     uint32_t count = 0;
     
     uint8_t index = 1;
-    uint8_t loop = 0;
     uint8_t i = 0;
     uint8_t keyboardIndex = 0;
     
+#if !defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
     uint8_t counter = 0;
+#endif
     bool lastKeyFound = false;
     bool tobeDone = false;
     
@@ -445,6 +459,16 @@ void _USB_HOST_HID_KEYBOARD_Task(USB_HOST_HID_OBJ_HANDLE handle)
             break;
         case USB_HOST_HID_KEYBOARD_REPORT_PROCESS:
             tobeDone = false;
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+            if(keyboardData[keyboardIndex].report != NULL)
+            {
+                /* Parse the report in place. The HID client driver owns the
+                 * buffer and reclaims it once this task routine returns */
+                reportData = keyboardData[keyboardIndex].report;
+                keyboardData[keyboardIndex].report = NULL;
+                tobeDone = true;
+            }
+#else
             /*
              * Keyboard driver processes the IN Report on a sequential fashion
              * starting from counter = 0 to 
@@ -462,18 +486,17 @@ void _USB_HOST_HID_KEYBOARD_Task(USB_HOST_HID_OBJ_HANDLE handle)
              */
             if(keyboardData[keyboardIndex].buffer[counter].tobeDone)
             {
-                /* Keep a temp backup of the data */
-                memcpy(&dataTemp,(const void *)keyboardData[keyboardIndex].buffer
-                        [counter].data, 64);
+                reportData = keyboardData[keyboardIndex].buffer[counter].data;
                 tobeDone = true;
-            }
-            
-            if(tobeDone)
-            {
                 /* Increment the queue counter. Next task iteration the
                  * processing will start from here.
                  */
                 keyboardData[keyboardIndex].counter++;
+            }
+#endif
+            
+            if(tobeDone)
+            {
                 /* Reset global items only once as they are applicable
                  * through out */
                 memset(&globalItem, 0,
@@ -498,12 +521,6 @@ void _USB_HOST_HID_KEYBOARD_Task(USB_HOST_HID_OBJ_HANDLE handle)
 
                     if(result == USB_HOST_HID_RESULT_SUCCESS)
                     {
-                        /* Copy the data as while processing the last field
-                         we have changed the data for numbered report.*/
-                        memcpy((void *)keyboardData[keyboardIndex].buffer
-                                [counter].data,
-                                (const void *)&dataTemp, 64);
-                        
                         if(mainItem.tag ==
                                 USB_HID_MAIN_ITEM_TAG_BEGIN_COLLECTION)
                         {                
@@ -534,37 +551,23 @@ void _USB_HOST_HID_KEYBOARD_Task(USB_HOST_HID_OBJ_HANDLE handle)
                                 continue;
                             }
 
+                            fieldData = reportData;
                             if(!((mainItem.globalItem)->reportID == 0))
                             {
                                 /* Numbered report */
-                                if(keyboardData[keyboardIndex].buffer
-                                        [counter].data[0] !=
-                                        (mainItem.globalItem)->reportID)
+                                if(reportData[0] != (mainItem.globalItem)->reportID)
                                 {
                                         /* Report ID does not match. No point in
                                            parsing this data */
                                         index++;
                                         continue;
                                 }
-                                /* Numbered Report. Shift right by 1 byte */
-                                for(loop = 0; loop < 64; loop ++)
-                                {
-                                    if(loop == 63)
-                                    {
-                                        keyboardData[keyboardIndex].buffer
-                                                [counter].data[loop] = 0;
-                                        break;
-                                    }
-                                    keyboardData[keyboardIndex].buffer
-                                            [counter].data[loop] = 
-                                            keyboardData[keyboardIndex].buffer
-                                            [counter].data[loop + 1];
-                                    
-                                }
+                                /* Numbered Report. Field data starts after
+                                 * the report ID byte. */
+                                fieldData = reportData + 1;
                             } /* end of if numbered report */
                             
-                            keyboardDataBuffer = (int8_t *)keyboardData[keyboardIndex].buffer
-                                                    [counter].data;
+                            keyboardDataBuffer = fieldData;
                             
                             currentReportOffsetTemp = reportOffset;
                             reportOffset = reportOffset + 
@@ -587,8 +590,7 @@ void _USB_HOST_HID_KEYBOARD_Task(USB_HOST_HID_OBJ_HANDLE handle)
                                         while(usage <= 
                                                 (mainItem.localItem->usageMinMax.max))
                                         {
-                                            keyboardDataBuffer = (int8_t *)keyboardData[keyboardIndex].buffer
-                                                    [counter].data;
+                                            keyboardDataBuffer = fieldData;
 
                                             if((0x00FF & usage) == USB_HID_KEYBOARD_KEYPAD_KEYBOARD_LEFT_CONTROL)
                                             {
@@ -799,7 +801,9 @@ void _USB_HOST_HID_KEYBOARD_Task(USB_HOST_HID_OBJ_HANDLE handle)
                     
                 } while(result == USB_HOST_HID_RESULT_SUCCESS);
                 
+#if !defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
                 keyboardData[keyboardIndex].buffer[counter].tobeDone = false;
+#endif
                 
                 if(appKeyboardHandler != NULL)
                 {
@@ -122,6 +122,10 @@ typedef struct
     USB_HOST_HID_OBJ_HANDLE handle;
     USB_HOST_HID_KEYBOARD_DATA appData;
     uint8_t outputReport;
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+    /* Report lent by the HID client driver batched report engine */
+    int8_t * report;
+#endif
     
 } USB_HOST_HID_KEYBOARD_DATA_OBJ;
 
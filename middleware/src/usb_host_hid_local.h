@@ -353,6 +353,74 @@ typedef struct _USB_HOST_HID_DEVICE_INFO_
     
 } USB_HOST_HID_DEVICE_INFO;
 
+#if defined(USB_HOST_HID_MAIN_ITEM_INDEX_SIZE)
+// *****************************************************************************
+/*  USB Host HID Main Item Index entry
+
+  Summary:
+    USB Host HID Main Item Index entry
+
+  Description:
+    Structure holds the parser state that follows a main item in the Report
+    Descriptor. The index is built once when the Report Descriptor has been
+    obtained. A field query for main item N resumes parsing from the entry of
+    main item N-1 instead of parsing the Report Descriptor from the start.
+
+  Remarks:
+    None.
+*/
+
+typedef struct _USB_HOST_HID_MAIN_ITEM_INDEX_
+{
+    /* Report Descriptor offset of the item that follows the main item */
+    uint16_t offset;
+    /* True if parsing can resume from this entry. Entries taken while global
+     items are on the PUSH POP stack cannot be used. */
+    bool isValid;
+    /* Global items in effect after the main item */
+    USB_HOST_HID_GLOBAL_ITEM globalItem;
+
+} USB_HOST_HID_MAIN_ITEM_INDEX;
+
+#endif
+
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+// *****************************************************************************
+/*  USB Host HID Ready Report entry
+
+  Summary:
+    USB Host HID Ready Report entry
+
+  Description:
+    Entry of the ready queue that the batched report engine shares across all
+    HID instances. An entry is added from the INTERRUPT IN transfer complete
+    event and names the report buffer that holds the received report. The
+    queue is drained in one pass from the HID client driver task routine.
+
+  Remarks:
+    None.
+*/
+
+typedef struct _USB_HOST_HID_READY_REPORT_
+{
+    /* HID instance that received the report */
+    uint8_t hidInstanceIndex;
+    /* Report buffer of that instance */
+    uint8_t buffer;
+    /* Value of the instance reportEpoch when the report was queued */
+    uint8_t epoch;
+
+} USB_HOST_HID_READY_REPORT;
+
+/* Size of the ready queue. One entry is always left empty. */
+#define USB_HOST_HID_READY_QUEUE_SIZE \
+    ((USB_HOST_HID_INSTANCES_NUMBER * USB_HOST_HID_REPORT_BUFFERS_NUMBER) + 1)
+
+/* No report buffer */
+#define USB_HOST_HID_REPORT_BUFFER_NONE                        0xFF
+
+#endif
+
 // *****************************************************************************
 /* USB HOST HID Client Driver data structure
 
@@ -431,6 +499,33 @@ typedef struct
 	uint32_t globalStackIndex;
     /* Push-Pop stack */
 	USB_HOST_HID_GLOBAL_ITEM globalStack[USB_HID_GLOBAL_PUSH_POP_STACK_SIZE];
+#if defined(USB_HOST_HID_MAIN_ITEM_INDEX_SIZE)
+    /* Number of valid entries in the main item index */
+    uint8_t mainItemIndexCount;
+    /* Main item index */
+    USB_HOST_HID_MAIN_ITEM_INDEX mainItemIndex[USB_HOST_HID_MAIN_ITEM_INDEX_SIZE];
+#endif
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+    /* Pending INTERRUPT IN transfer of each pipe */
+    USB_HOST_TRANSFER_HANDLE reportTransferHandle[USB_HOST_HID_INTERRUPT_IN_ENDPOINTS_NUMBER];
+    /* Report buffer that each INTERRUPT IN pipe is filling */
+    uint8_t reportFillBuffer[USB_HOST_HID_INTERRUPT_IN_ENDPOINTS_NUMBER];
+    /* Report buffers in use. A buffer is in use while it is filling, waiting
+     in the ready queue or holding the last report. */
+    volatile uint32_t reportBufferMask;
+    /* Report buffers waiting in the ready queue */
+    volatile uint32_t reportQueuedMask;
+    /* Buffer holding the last report that was queued */
+    uint8_t reportLastBuffer;
+    /* Length of the last report that was queued */
+    size_t reportLastLength;
+    /* True if a report equal to the last report can be dropped. This is
+     false when the Report Descriptor has relative INPUT items. */
+    bool reportCoalesce;
+    /* Changes when the instance is released so that its ready queue entries
+     are dropped */
+    uint8_t reportEpoch;
+#endif
 
 } USB_HOST_HID_INSTANCE;
 
@@ -443,6 +538,22 @@ USB_HOST_HID_RESULT _USB_HOST_HID_ItemGet
     uint32_t * buffer,
     USB_HOST_HID_QUERY_TYPE query
 );
+
+#if defined(USB_HOST_HID_MAIN_ITEM_INDEX_SIZE)
+void _USB_HOST_HID_MainItemIndexBuild(uint8_t hidInstanceIndex);
+#endif
+
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+void _USB_HOST_HID_ReportEngineReset(uint8_t hidInstanceIndex);
+void _USB_HOST_HID_ReportCoalesceCheck(uint8_t hidInstanceIndex);
+void _USB_HOST_HID_ReportTransfersSubmit(uint8_t hidInstanceIndex);
+bool _USB_HOST_HID_ReportReceived
+(
+    uint8_t hidInstanceIndex,
+    USB_HOST_DEVICE_INTERFACE_EVENT_TRANSFER_COMPLETE_DATA * transferData
+);
+void _USB_HOST_HID_ReadyQueueDrain(void);
+#endif
 #endif
 
 /********************** END OF FILE ***************************/
@@ -145,6 +145,9 @@ void _USB_HOST_HID_MOUSE_EventHandler
                                 sizeof(USB_HOST_HID_MOUSE_DATA));
                         memset((void *)mouseData[loop].dataPing, 0,64);
                         memset((void *)mouseData[loop].dataPong, 0,64);
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+                        mouseData[loop].report = NULL;
+#endif
                         break;
                     }
                 }
@@ -194,6 +197,13 @@ void _USB_HOST_HID_MOUSE_EventHandler
                 }
                 if(loop != USB_HOST_HID_USAGE_DRIVER_SUPPORT_NUMBER)
                 {
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+                    /* Batched report engine. The HID client driver runs the
+                     * task routine right after this event, so keep a
+                     * reference to its buffer instead of a copy. */
+                    mouseData[loop].report = (int8_t *)eventData;
+                    mouseData[loop].state = USB_HOST_HID_MOUSE_REPORT_PROCESS;
+#else
                     if(mouseData[loop].nextPingPong)
                     {
                         if((mouseData[loop].isPongReportProcessing == false))
@@ -222,6 +232,7 @@ void _USB_HOST_HID_MOUSE_EventHandler
                                     USB_HOST_HID_MOUSE_REPORT_PROCESS;
                         }
                     }
+#endif
                 }
             default:
                 break;
@@ -254,7 +265,8 @@ void _USB_HOST_HID_MOUSE_Task(USB_HOST_HID_OBJ_HANDLE handle)
     int64_t mouseDataBufferTemp = 0;
     int8_t * mouseDataBuffer = NULL;
     int8_t *ptr = NULL;
-    int8_t dataTemp[64] ={0};
+    int8_t * reportData = NULL;
+    int8_t * fieldData = NULL;
     
     uint32_t reportOffset = 0;
     uint32_t currentReportOffset = 0;
@@ -299,14 +311,24 @@ void _USB_HOST_HID_MOUSE_Task(USB_HOST_HID_OBJ_HANDLE handle)
             break;
         case USB_HOST_HID_MOUSE_REPORT_PROCESS:
             tobeDone = false;
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+            if(mouseData[mouseIndex].report != NULL)
+            {
+                /* Parse the report in place. The HID client driver owns the
+                 * buffer and reclaims it once this task routine returns */
+                reportData = mouseData[mouseIndex].report;
+                mouseData[mouseIndex].report = NULL;
+                memset(&globalItem, 0,
+                        (size_t)sizeof(USB_HOST_HID_GLOBAL_ITEM));
+                tobeDone = true;
+            }
+#else
             if(!mouseData[mouseIndex].taskPingPong)
             {
                 if(mouseData[mouseIndex].isPingReportProcessing == true)
                 {
                     mouseData[mouseIndex].taskPingPong = true;
-                    /* Keep a temp backup of the data */
-                    memcpy(&dataTemp,
-                            (const void *)mouseData[mouseIndex].dataPing, 64);
+                    reportData = (int8_t *)mouseData[mouseIndex].dataPing;
                     /* Reset global items only once as they are applicable through out */
                     memset(&globalItem, 0,
                             (size_t)sizeof(USB_HOST_HID_GLOBAL_ITEM));
@@ -318,15 +340,14 @@ void _USB_HOST_HID_MOUSE_Task(USB_HOST_HID_OBJ_HANDLE handle)
                 if(mouseData[mouseIndex].isPongReportProcessing == true)
                 {
                     mouseData[mouseIndex].taskPingPong = false;
-                    /* Keep a temp backup of the data */
-                    memcpy(&dataTemp,
-                            (const void *)mouseData[mouseIndex].dataPong, 64);
+                    reportData = (int8_t *)mouseData[mouseIndex].dataPong;
                     /* Reset global items only once as they are applicable through out */
                     memset(&globalItem, 0,
                             (size_t)sizeof(USB_HOST_HID_GLOBAL_ITEM));
                     tobeDone = true;
                 }
             }
+#endif
             if(tobeDone)
             {
                 do
@@ -341,20 +362,6 @@ void _USB_HOST_HID_MOUSE_Task(USB_HOST_HID_OBJ_HANDLE handle)
                     result = USB_HOST_HID_MainItemGet(handle,index,&mainItem);
                     if(result == USB_HOST_HID_RESULT_SUCCESS)
                     {
-                        /* Copy the data as while processing the last field
-                         we have changed the data for numbered report. If
-                         taskPingPong is true that means we need to process
-                         Ping buffer, else Pong buffer */
-                        if(mouseData[mouseIndex].taskPingPong)
-                        {
-                            memcpy((void *)mouseData[mouseIndex].dataPing,
-                                    (const void *)&dataTemp, 64);
-                        }
-                        else
-                        {
-                            memcpy((void *)mouseData[mouseIndex].dataPong,
-                                    (const void *)&dataTemp, 64);
-                        }
                         if(mainItem.tag ==
                                 USB_HID_MAIN_ITEM_TAG_BEGIN_COLLECTION)
                         {    
@@ -379,61 +386,21 @@ void _USB_HOST_HID_MOUSE_Task(USB_HOST_HID_OBJ_HANDLE handle)
                                 index++;
                                 continue;
                             }
+                            fieldData = reportData;
                             if(!((mainItem.globalItem)->reportID == 0))
                             {
                                 /* Numbered report */
-                                if(mouseData[mouseIndex].taskPingPong)
+                                if(reportData[0] != (mainItem.globalItem)->reportID)
                                 {
-                                    if(mouseData[mouseIndex].dataPing[0] !=
-                                        (mainItem.globalItem)->reportID)
-                                    {
-                                        /* Report ID does not match */
-                                        index++;
-                                        continue;
-                                    }
-                                    /* Numbered Report. Shift right by 1 byte */
-                                    for(loop = 0; loop <64; loop ++)
-                                    {
-                                        if(loop == 63)
-                                        {
-                                            mouseData[mouseIndex].dataPing[loop] = 0;
-                                            break;
-                                        }
-                                        mouseData[mouseIndex].dataPing[loop] = 
-                                                mouseData[mouseIndex].dataPing[loop + 1];
-                                    }
-                                }
-                                else
-                                {
-                                    if(mouseData[mouseIndex].dataPong[0] !=
-                                        (mainItem.globalItem)->reportID)
-                                    {
-                                        /* Report ID does not match */
-                                        index++;
-                                        continue;
-                                    }
-                                    /* Numbered Report. Shift right by 1 byte */
-                                    for(loop = 0; loop <64; loop ++)
-                                    {
-                                        if(loop == 63)
-                                        {
-                                            mouseData[mouseIndex].dataPong[loop] = 0;
-                                            break;
-                                        }
-                                        mouseData[mouseIndex].dataPong[loop] = 
-                                                mouseData[mouseIndex].dataPong[loop + 1];
-                                    }
+                                    /* Report ID does not match */
+                                    index++;
+                                    continue;
                                 }
+                                /* Numbered Report. Field data starts after
+                                 * the report ID byte. */
+                                fieldData = reportData + 1;
                             }
-
-                            if(mouseData[mouseIndex].taskPingPong)
-                            {
-                                mouseDataBuffer = (int8_t *)mouseData[mouseIndex].dataPing;
-                            }
-                            else
-                            {
-                                mouseDataBuffer = (int8_t *)mouseData[mouseIndex].dataPong;
-                            }
+                            mouseDataBuffer = fieldData;
                             
                             currentReportOffset = reportOffset;
                             currentReportOffsetTemp = currentReportOffset;
@@ -454,14 +421,7 @@ void _USB_HOST_HID_MOUSE_Task(USB_HOST_HID_OBJ_HANDLE handle)
                                     while(usage <= 
                                             (mainItem.localItem->usageMinMax.max))
                                     {
-                                        if(mouseData[mouseIndex].taskPingPong)
-                                        {
-                                            mouseDataBuffer = (int8_t *)mouseData[mouseIndex].dataPing;
-                                        }
-                                        else
-                                        {
-                                            mouseDataBuffer = (int8_t *)mouseData[mouseIndex].dataPong;
-                                        }
+                                        mouseDataBuffer = fieldData;
                                         if(((0x00FF & usage) == USB_HID_USAGE_ID_BUTTON1) &&
                                                 (loop < USB_HOST_HID_MOUSE_BUTTONS_NUMBER))
                                         {
@@ -535,14 +495,7 @@ void _USB_HOST_HID_MOUSE_Task(USB_HOST_HID_OBJ_HANDLE handle)
                                     loop = 1;
                                     do
                                     {
-                                        if(mouseData[mouseIndex].taskPingPong)
-                                        {
-                                            mouseDataBuffer = (int8_t *)mouseData[mouseIndex].dataPing;
-                                        }
-                                        else
-                                        {
-                                            mouseDataBuffer = (int8_t *)mouseData[mouseIndex].dataPong;
-                                        }
+                                        mouseDataBuffer = fieldData;
                                         result = USB_HOST_HID_UsageGet
                                                 (
                                                     handle,
@@ -637,14 +590,7 @@ void _USB_HOST_HID_MOUSE_Task(USB_HOST_HID_OBJ_HANDLE handle)
                                     loop = 1;
                                     do
                                     {
-                                        if(mouseData[mouseIndex].taskPingPong)
-                                        {
-                                            mouseDataBuffer = (int8_t *)mouseData[mouseIndex].dataPing;
-                                        }
-                                        else
-                                        {
-                                            mouseDataBuffer = (int8_t *)mouseData[mouseIndex].dataPong;
-                                        }
+                                        mouseDataBuffer = fieldData;
                                         result = USB_HOST_HID_UsageGet
                                                 (
                                                     handle,
@@ -745,6 +691,7 @@ void _USB_HOST_HID_MOUSE_Task(USB_HOST_HID_OBJ_HANDLE handle)
                                 (void *)&mouseData[mouseIndex].appData);
                 }
                 
+#if !defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
                 if(mouseData[mouseIndex].taskPingPong)
                 {
                     mouseData[mouseIndex].isPingReportProcessing = false;
@@ -753,6 +700,7 @@ void _USB_HOST_HID_MOUSE_Task(USB_HOST_HID_OBJ_HANDLE handle)
                 {
                     mouseData[mouseIndex].isPongReportProcessing = false;
                 }
+#endif
             }/* end of report processing */
             break;
         default:
@@ -98,6 +98,10 @@ typedef struct
     bool taskPingPong;
     int8_t dataPing[64];
     int8_t dataPong[64];
+#if defined(USB_HOST_HID_REPORT_BUFFERS_NUMBER)
+    /* Report lent by the HID client driver batched report engine */
+    int8_t * report;
+#endif
     USB_HOST_HID_MOUSE_STATE state;
     USB_HOST_HID_OBJ_HANDLE handle;
     USB_HOST_HID_MOUSE_DATA appData;
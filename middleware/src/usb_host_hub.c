@@ -300,13 +300,15 @@ void _USB_HOST_HUB_DeviceAssign
         hubInstanceObj->hubTaskState = USB_HOST_HUB_TASK_STATE_HUB_STATUS_GET;
        
         /* Intialize all the port objects. Set the device handle to invalid.
-         * Initialize the port task state and set the timer handle to invalid. */
+         * Initialize the port task state and set the timer handle to invalid.
+         * All ports must be powered, so all ports are active. */
         for( portIndex = 0 ; portIndex < USB_HOST_HUB_PORTS_NUMBER ; portIndex++ )
         {
             portInfo = & (hubInstanceObj->portInfo[portIndex]);
             portInfo->deviceObjHandle = USB_HOST_DEVICE_OBJ_HANDLE_INVALID ;
             portInfo->portTaskState = USB_HOST_HUB_PORT_TASK_STATE_POWER_ENABLE ;
             portInfo->timerHandle = SYS_TMR_HANDLE_INVALID;
+            hubInstanceObj->portActive |= ((uint32_t)1 << (portIndex + 1));
         }
 
         /* Try opening a control pipe */
@@ -542,6 +544,9 @@ void _USB_HOST_HUB_DeviceTasks
     USB_HOST_RESULT             result;
     USB_HOST_TRANSFER_HANDLE    transferHandle;
     uint8_t                     portNumber;
+    uint32_t                    portPending;
+    uint32_t                    mask;
+    USB_HOST_HUB_PORT_INFO    * portInfo;
 
     /* Get the index of the device instance */
     hubInstanceIndex = _USB_HOST_HUB_DeviceHandleToInstance(hubDeviceHandle);
@@ -749,10 +754,50 @@ void _USB_HOST_HUB_DeviceTasks
                     /* Hub task handles the hub level change bits */
                     _USB_HOST_HUB_HubTasks( hubInstanceIndex );
 
-                    /* Port Tasks handles the port level change bits */
-                    for ( portNumber = 1 ; portNumber <= hubInstance->hubDescriptor.bNbrPorts ; portNumber++ )
+                    if(hubInstance->portCommandRequested)
+                    {
+                        /* A port command was requested by the host layer. Mark
+                         * the ports with pending commands as active. The flag is
+                         * cleared first so that a command requested during the
+                         * scan is seen in the next run. */
+                        hubInstance->portCommandRequested = false;
+                        for ( portNumber = 1 ; portNumber <= hubInstance->hubDescriptor.bNbrPorts ; portNumber++ )
+                        {
+                            if(hubInstance->portInfo[portNumber - 1].portCommand != 0)
+                            {
+                                hubInstance->portActive |= ((uint32_t)1 << portNumber);
+                            }
+                        }
+                    }
+
+                    /* Port Tasks handles the port level change bits. Only the
+                     * ports that have a change bit set or that have work in
+                     * progress are run. An idle port costs nothing here. */
+                    portPending = (hubInstance->changeStatus | hubInstance->portActive) & ~((uint32_t)0x01);
+                    for ( portNumber = 1 ; (portPending != 0) && (portNumber <= hubInstance->hubDescriptor.bNbrPorts) ; portNumber++ )
                     {
-                        _USB_HOST_HUB_PortTasks( hubInstanceIndex , portNumber );
+                        mask = ((uint32_t)1 << portNumber);
+                        if((portPending & mask) != 0)
+                        {
+                            portPending &= ~mask;
+                            _USB_HOST_HUB_PortTasks( hubInstanceIndex , portNumber );
+
+                            /* The port is idle when it waits for a change, has
+                             * no change bit set and has no command to execute.
+                             * It is run again when the hub reports a change or
+                             * when a command is requested. */
+                            portInfo = &(hubInstance->portInfo[portNumber - 1]);
+                            if(((portInfo->portTaskState == USB_HOST_HUB_PORT_TASK_STATE_CHECK_CHANGE_STATUS) ||
+                                        (portInfo->portTaskState == USB_HOST_HUB_PORT_TASK_STATE_OVERCURRENT)) &&
+                                    (portInfo->portCommand == 0) && ((hubInstance->changeStatus & mask) == 0))
+                            {
+                                hubInstance->portActive &= ~mask;
+                            }
+                            else
+                            {
+                                hubInstance->portActive |= mask;
+                            }
+                        }
                     }
                     break;
 
@@ -978,6 +1023,7 @@ void _USB_HOST_HUB_HubTasks( uint32_t hubInstanceIndex )
                                 portIndex = portNumber - 1;
                                 portInfo = &(hubInstance->portInfo[portIndex]);
                                 portInfo->portTaskState = USB_HOST_HUB_PORT_TASK_STATE_POWER_ENABLE;
+                                hubInstance->portActive |= ((uint32_t)1 << portNumber);
                             }
                         }
 
@@ -1543,6 +1589,7 @@ void _USB_HOST_HUB_PortTasks(uint32_t hubInstanceIndex, uint32_t portNumber)
                                 /* Enable the power */
                                 hubInstance->portInfo[tempPortIndex].portTaskState = USB_HOST_HUB_PORT_TASK_STATE_POWER_ENABLE;
                                 hubInstance->portInfo[tempPortIndex].isOCPoweredOff = false ;
+                                hubInstance->portActive |= ((uint32_t)1 << tempPortNumber);
                             }
                         }
                     }
@@ -1748,17 +1795,17 @@ void _USB_HOST_HUB_PortTasks(uint32_t hubInstanceIndex, uint32_t portNumber)
              * The port task routine will reach this state only if all change
              * sources have been cleared. */
 
-            if ((portInfo->portCommand & USB_HOST_PORT_COMMAND_RESET) == 1)
+            if ((portInfo->portCommand & USB_HOST_PORT_COMMAND_RESET) != 0)
             {
                 /* The port needs to be reset */
                 portInfo->portTaskState = USB_HOST_HUB_PORT_TASK_STATE_PORT_RESET  ;
             }
-            else if ((portInfo->portCommand & USB_HOST_PORT_COMMAND_SUSPEND) == 1)
+            else if ((portInfo->portCommand & USB_HOST_PORT_COMMAND_SUSPEND) != 0)
             {
                 /* The port needs to be suspended */
                 portInfo->portTaskState = USB_HOST_HUB_PORT_TASK_STATE_PORT_SUSPEND  ;
             }
-            else if ((portInfo->portCommand & USB_HOST_PORT_COMMAND_RESUME) == 1)
+            else if ((portInfo->portCommand & USB_HOST_PORT_COMMAND_RESUME) != 0)
             {
                 /* The port needs to be resumed */
                 portInfo->portTaskState = USB_HOST_HUB_PORT_TASK_STATE_PORT_RESUME  ;
@@ -2140,6 +2187,7 @@ USB_ERROR USB_HOST_HUB_PortReset  ( uintptr_t hubDeviceHandle, uint8_t portNumbe
                      * The command will be completed by the
                      * _USB_HOST_HUB_PortTasks() function. */
                     portInfo->portCommand |= USB_HOST_PORT_COMMAND_RESET ;
+                    hubInstance->portCommandRequested = true;
                     result = USB_ERROR_NONE;
                 }
             }
@@ -2288,6 +2336,7 @@ USB_ERROR USB_HOST_HUB_PortSuspend
                      * The command will be completed by the
                      * _USB_HOST_HUB_PortTasks() function. */
                     portInfo->portCommand |= USB_HOST_PORT_COMMAND_SUSPEND ;
+                    hubInstance->portCommandRequested = true;
                     result = USB_ERROR_NONE;
                 }
             }
@@ -2373,6 +2422,7 @@ USB_ERROR USB_HOST_HUB_PortResume
                      * The command will be completed by the
                      * _USB_HOST_HUB_PortTasks() function. */
                     portInfo->portCommand |= USB_HOST_PORT_COMMAND_RESUME ;
+                    hubInstance->portCommandRequested = true;
                     result = USB_ERROR_NONE;
                 }
             }
@@ -321,6 +321,14 @@ typedef struct _USB_HOST_HUB_INSTANCE_OBJ_
     /* Change status obtained from the hub over the interrupt pipe */
     uint32_t changeStatus;
 
+    /* Bitmap of the ports whose port task has work in progress. The bit
+     * positions are the same as in changeStatus. Only the ports that are set
+     * in this bitmap or in changeStatus are run by the hub device task. */
+    uint32_t portActive;
+
+    /* True if a port command was requested since the last device task run */
+    bool portCommandRequested;
+
     /* True if the control request is done */
     bool controlRequestDone;
 
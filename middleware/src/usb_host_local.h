@@ -309,6 +309,11 @@ typedef struct _USB_HOST_PIPE_OBJ_
     /* Device endpoint that this pipe connects to */
     USB_ENDPOINT_ADDRESS  endpointAddress;
 
+#if defined(USB_HOST_TRACE_RECORDS_NUMBER)
+    /* Transfer type of the endpoint. This is needed for the trace. */
+    USB_TRANSFER_TYPE transferType;
+#endif
+
 } USB_HOST_PIPE_OBJ;
 
 // *****************************************************************************
@@ -566,6 +571,18 @@ typedef struct  _USB_HOST_DEVICE_OBJ_
     /* Device configuration state */
     USB_HOST_DEVICE_CONFIG_STATE configurationState;
 
+    /* Timer handle for enumeration delays after the device is addressed */
+    SYS_TIME_HANDLE deviceOperationsTimerHandle;
+
+    /* Flag is set when the device timer expires */
+    bool timerExpired;
+
+#if defined(USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER)
+    /* Descriptor cache entry that matched the device at attach. NULL if the
+     * device was not found in the cache. */
+    struct _USB_HOST_DESCRIPTOR_CACHE_ENTRY_ * descriptorCacheEntry;
+#endif
+
 } USB_HOST_DEVICE_OBJ;
 
 // *****************************************************************************
@@ -668,7 +685,8 @@ typedef struct
     /* Based on bits position the device address assigned and free*/
     uint8_t addressBits[(USB_HOST_DEVICES_NUMBER/8) + 1];
 
-    /* Only one device should enumerate at a time */
+    /* Only one device should be at the default address at a time. This flag
+     * is held from port reset until the device has been addressed. */
     bool deviceIsEnumerating;
 
     /* Total bandwidth available in a bus */
@@ -725,7 +743,7 @@ typedef struct
     SYS_STATUS status;
 
     /* Supported Target peripheral list */
-    uint8_t  nTPLEntries;
+    uint16_t  nTPLEntries;
 
     /* Pointer to the entry of TPL*/
     USB_HOST_TPL_ENTRY * tpl;
@@ -744,6 +762,393 @@ typedef struct
     
 } USB_HOST_OBJ;
 
+#if defined(USB_HOST_TRACE_RECORDS_NUMBER)
+
+// *****************************************************************************
+/*  USB Host Trace IRP Information
+
+  Summary:
+    Information about an IRP that is traced.
+
+  Description:
+    The host layer replaces the callback of a traced IRP with its own callback
+    while the IRP is pending. This object stores the original callback and the
+    information that is needed to create the completion record.
+
+  Remarks:
+    There is one object for the control IRP of each device object and one for
+    the IRP of each transfer object.
+*/
+
+typedef struct
+{
+    /* Callback set by the host layer in the IRP */
+    void (*callback)(USB_HOST_IRP * irp);
+
+    /* Bus, device address, endpoint and transfer type of the IRP */
+    uint8_t bus;
+    uint8_t deviceAddress;
+    uint8_t endpoint;
+    uint8_t transferType;
+
+} USB_HOST_TRACE_IRP_INFO;
+
+// *****************************************************************************
+/*  USB Host Trace Object
+
+  Summary:
+    Stores the host layer trace.
+
+  Description:
+    The trace records are stored in a ring. Records are added in the IRP
+    callbacks and in the host layer tasks and are removed by
+    USB_HOST_TraceRead.
+
+  Remarks:
+    None.
+*/
+
+typedef struct
+{
+    /* The trace ring */
+    USB_HOST_TRACE_RECORD record[USB_HOST_TRACE_RECORDS_NUMBER];
+
+    /* Index of the next record to be written */
+    uint32_t writeIndex;
+
+    /* Index of the oldest record */
+    uint32_t readIndex;
+
+    /* Number of records in the ring */
+    uint32_t count;
+
+    /* Number of events that were lost because the ring was full */
+    uint32_t lostCount;
+
+    /* Traced IRP information. Device control IRPs come first, followed by the
+     * transfer object IRPs. */
+    USB_HOST_TRACE_IRP_INFO irpInfo[USB_HOST_CONTROLLERS_NUMBER + USB_HOST_DEVICES_NUMBER + USB_HOST_TRANSFERS_NUMBER];
+
+} USB_HOST_TRACE_OBJ;
+
+/* IRPs are submitted to the HCD through the trace when the trace is
+ * enabled */
+#define _USB_HOST_HCDIRPSubmit(deviceObj, drvPipeHandle, irp, endpoint, transferType) \
+    _USB_HOST_TraceIRPSubmit((deviceObj), (drvPipeHandle), (irp), (endpoint), (transferType))
+
+#else
+
+#define _USB_HOST_HCDIRPSubmit(deviceObj, drvPipeHandle, irp, endpoint, transferType) \
+    (deviceObj)->hcdInterface->hostIRPSubmit((drvPipeHandle), (irp))
+
+#endif
+
+#if defined(USB_HOST_TPL_INDEX_ENTRIES_NUMBER)
+
+// *****************************************************************************
+/*  USB Host TPL Index Lists
+
+  Summary:
+    Identifies the lists of the TPL index.
+
+  Description:
+    Each TPL entry is placed in one of these lists. The class and VID lists are
+    ordered by class code or VID and then by TPL position. The lists of entries
+    that ignore the class or the VID and PID are in TPL order.
+
+  Remarks:
+    None.
+*/
+
+typedef enum
+{
+    /* Class subclass protocol entries that specify a class */
+    USB_HOST_TPL_INDEX_LIST_CLASS = 0,
+
+    /* Class subclass protocol entries that ignore the class */
+    USB_HOST_TPL_INDEX_LIST_ANY_CLASS,
+
+    /* VID PID entries that specify a VID */
+    USB_HOST_TPL_INDEX_LIST_VID,
+
+    /* VID PID entries that ignore the VID and PID */
+    USB_HOST_TPL_INDEX_LIST_ANY_VID,
+
+    USB_HOST_TPL_INDEX_LISTS_NUMBER
+
+} USB_HOST_TPL_INDEX_LIST_TYPE;
+
+// *****************************************************************************
+/*  USB Host TPL Index Entry
+
+  Summary:
+    Refers to a TPL entry from the TPL index.
+
+  Description:
+    The key is the class code or the VID of the TPL entry. It is 0 in the lists
+    of entries that ignore the class or the VID and PID.
+
+  Remarks:
+    None.
+*/
+
+typedef struct
+{
+    /* Class code or VID of the TPL entry */
+    uint16_t key;
+
+    /* Position of the entry in the TPL */
+    uint16_t tplIndex;
+
+} USB_HOST_TPL_INDEX_ENTRY;
+
+// *****************************************************************************
+/*  USB Host TPL Index
+
+  Summary:
+    Ordered index of the TPL.
+
+  Description:
+    The index is built when the host layer is initialized. It allows the
+    driver search functions to find the first matching TPL entry at or after a
+    TPL position with a binary search instead of a walk through the TPL. The
+    TPL order, and so the priority of the entries, is preserved.
+
+  Remarks:
+    The index is not used if the TPL has more than
+    USB_HOST_TPL_INDEX_ENTRIES_NUMBER entries.
+*/
+
+typedef struct
+{
+    /* Entries of all lists. The lists follow each other. */
+    USB_HOST_TPL_INDEX_ENTRY entry[USB_HOST_TPL_INDEX_ENTRIES_NUMBER];
+
+    /* Position of the first entry of each list */
+    uint16_t listStart[USB_HOST_TPL_INDEX_LISTS_NUMBER];
+
+    /* Number of entries in each list */
+    uint16_t listSize[USB_HOST_TPL_INDEX_LISTS_NUMBER];
+
+    /* True if the index was built */
+    bool valid;
+
+} USB_HOST_TPL_INDEX;
+
+#endif
+
+#if defined(USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER)
+
+/* Default size of the configuration descriptor that can be cached */
+#ifndef USB_HOST_DESCRIPTOR_CACHE_CONFIGURATION_SIZE
+#define USB_HOST_DESCRIPTOR_CACHE_CONFIGURATION_SIZE    256
+#endif
+
+// *****************************************************************************
+/*  USB Host Descriptor Cache Entry
+
+  Summary:
+    Stores the descriptors of a device that was enumerated before.
+
+  Description:
+    The entry stores the device descriptor, the speed and the first
+    configuration descriptor of a device that passed the configuration
+    descriptor check and whose first configuration was set. A device that
+    attaches with the same device descriptor and speed and that returns the
+    same configuration descriptor header is enumerated from the entry.
+
+  Remarks:
+    The checksum covers the device descriptor and the configuration
+    descriptor and is verified each time the entry is used.
+*/
+
+typedef struct _USB_HOST_DESCRIPTOR_CACHE_ENTRY_
+{
+    /* Configuration descriptor of the first configuration */
+    uint32_t configurationDescriptor[(USB_HOST_DESCRIPTOR_CACHE_CONFIGURATION_SIZE + 3) / 4];
+
+    /* Device descriptor of the device */
+    USB_DEVICE_DESCRIPTOR deviceDescriptor;
+
+    /* Speed at which the device was enumerated */
+    USB_SPEED speed;
+
+    /* Checksum of the descriptors */
+    uint32_t checksum;
+
+    /* Value of the cache use counter when the entry was last used. The
+     * entry with the smallest value is replaced first. */
+    uint32_t lastUse;
+
+    /* True if the entry contains descriptors */
+    bool inUse;
+
+} USB_HOST_DESCRIPTOR_CACHE_ENTRY;
+
+// *****************************************************************************
+/*  USB Host Descriptor Cache Object
+
+  Summary:
+    Stores the descriptor cache.
+
+  Description:
+    The descriptor cache is used only in the host layer tasks context.
+
+  Remarks:
+    None.
+*/
+
+typedef struct
+{
+    /* Cache entries */
+    USB_HOST_DESCRIPTOR_CACHE_ENTRY entry[USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER];
+
+    /* Incremented each time an entry is used */
+    uint32_t useCount;
+
+} USB_HOST_DESCRIPTOR_CACHE_OBJ;
+
+#endif
+
+#if defined(USB_HOST_MEMORY_POOL_ENABLE)
+
+/* Default memory pool size classes. The defaults allow each device to hold a
+ * configuration descriptor and one report descriptor in each class. */
+#ifndef USB_HOST_MEMORY_POOL_SMALL_BLOCK_SIZE
+#define USB_HOST_MEMORY_POOL_SMALL_BLOCK_SIZE       64
+#endif
+
+#ifndef USB_HOST_MEMORY_POOL_SMALL_BLOCKS_NUMBER
+#define USB_HOST_MEMORY_POOL_SMALL_BLOCKS_NUMBER    (USB_HOST_DEVICES_NUMBER * 2)
+#endif
+
+#ifndef USB_HOST_MEMORY_POOL_MEDIUM_BLOCK_SIZE
+#define USB_HOST_MEMORY_POOL_MEDIUM_BLOCK_SIZE      256
+#endif
+
+#ifndef USB_HOST_MEMORY_POOL_MEDIUM_BLOCKS_NUMBER
+#define USB_HOST_MEMORY_POOL_MEDIUM_BLOCKS_NUMBER   (USB_HOST_DEVICES_NUMBER * 2)
+#endif
+
+#ifndef USB_HOST_MEMORY_POOL_LARGE_BLOCK_SIZE
+#define USB_HOST_MEMORY_POOL_LARGE_BLOCK_SIZE       1024
+#endif
+
+#ifndef USB_HOST_MEMORY_POOL_LARGE_BLOCKS_NUMBER
+#define USB_HOST_MEMORY_POOL_LARGE_BLOCKS_NUMBER    USB_HOST_DEVICES_NUMBER
+#endif
+
+/* Size of a block in 32 bit words. Blocks are word aligned. */
+#define USB_HOST_MEMORY_POOL_WORDS(size)   (((size) + 3) / 4)
+
+#define USB_HOST_MEMORY_POOL_BLOCKS_NUMBER  (USB_HOST_MEMORY_POOL_SMALL_BLOCKS_NUMBER \
+        + USB_HOST_MEMORY_POOL_MEDIUM_BLOCKS_NUMBER + USB_HOST_MEMORY_POOL_LARGE_BLOCKS_NUMBER)
+
+// *****************************************************************************
+/*  USB Host Memory Pool Block Information
+
+  Summary:
+    Ownership information of a memory pool block.
+
+  Description:
+    This object records the bus that allocated a block and the number of bytes
+    that were requested. A block is free if size is 0.
+
+  Remarks:
+    None.
+*/
+
+typedef struct
+{
+    /* Number of bytes requested by the allocation */
+    uint32_t size;
+
+    /* Bus that allocated the block */
+    uint8_t bus;
+
+} USB_HOST_MEMORY_POOL_BLOCK_INFO;
+
+// *****************************************************************************
+/*  USB Host Memory Pool Size Class Information
+
+  Summary:
+    Describes a size class of the memory pool.
+
+  Description:
+    This object describes where the blocks of a size class are stored and
+    where their ownership information starts.
+
+  Remarks:
+    None.
+*/
+
+typedef struct
+{
+    /* Memory of the first block */
+    uint8_t * memory;
+
+    /* Size of a block in bytes */
+    uint32_t blockSize;
+
+    /* Number of blocks */
+    uint32_t blocksNumber;
+
+    /* Index of the information of the first block */
+    uint32_t firstBlock;
+
+} USB_HOST_MEMORY_POOL_CLASS_INFO;
+
+// *****************************************************************************
+/*  USB Host Memory Pool Object
+
+  Summary:
+    Stores the host layer memory pool.
+
+  Description:
+    The memory pool replaces USB_HOST_MALLOC and USB_HOST_FREE for the
+    descriptor buffers of the host layer and the client drivers. Memory is
+    statically allocated in three size classes of fixed size blocks. An
+    allocation takes a block from the smallest class that fits and has a free
+    block, so the pool cannot fragment.
+
+  Remarks:
+    The last status entry holds the totals of all buses.
+*/
+
+typedef struct
+{
+    /* Block memory of the size classes */
+    uint32_t smallBlock[USB_HOST_MEMORY_POOL_SMALL_BLOCKS_NUMBER][USB_HOST_MEMORY_POOL_WORDS(USB_HOST_MEMORY_POOL_SMALL_BLOCK_SIZE)];
+    uint32_t mediumBlock[USB_HOST_MEMORY_POOL_MEDIUM_BLOCKS_NUMBER][USB_HOST_MEMORY_POOL_WORDS(USB_HOST_MEMORY_POOL_MEDIUM_BLOCK_SIZE)];
+    uint32_t largeBlock[USB_HOST_MEMORY_POOL_LARGE_BLOCKS_NUMBER][USB_HOST_MEMORY_POOL_WORDS(USB_HOST_MEMORY_POOL_LARGE_BLOCK_SIZE)];
+
+    /* Block ownership. Small blocks come first, followed by the medium and
+     * the large blocks. */
+    USB_HOST_MEMORY_POOL_BLOCK_INFO blockInfo[USB_HOST_MEMORY_POOL_BLOCKS_NUMBER];
+
+    /* Accounting for each bus and for all buses */
+    USB_HOST_MEMORY_POOL_STATUS status[USB_HOST_CONTROLLERS_NUMBER + 1];
+
+    /* Every failureInterval allocation fails if this is not 0 */
+    uint32_t failureInterval;
+
+    /* Allocations since failure injection was set */
+    uint32_t failureCount;
+
+} USB_HOST_MEMORY_POOL_OBJ;
+
+/* Descriptor buffers are allocated from the memory pool when the pool is
+ * enabled */
+#define _USB_HOST_BufferAllocate(bus, size)     _USB_HOST_MemoryPoolAllocate((bus), (size))
+#define _USB_HOST_BufferFree(ptr)               _USB_HOST_MemoryPoolFree(ptr)
+
+#else
+
+#define _USB_HOST_BufferAllocate(bus, size)     USB_HOST_MALLOC(size)
+#define _USB_HOST_BufferFree(ptr)               USB_HOST_FREE(ptr)
+
+#endif
+
 // ****************************************************************************
 // ****************************************************************************
 // USB Host Private Functions
@@ -892,6 +1297,36 @@ int _USB_HOST_FindClassSubClassProtocolDriver
     int startPoint
 );
 
+// *****************************************************************************
+/* Function:
+    int _USB_HOST_FindVIDPIDDriver
+    (
+        uint16_t idVendor,
+        uint16_t idProduct,
+        int startPoint
+    );
+
+  Summary:
+    This function will search for a matching VID PID driver in the TPL table.
+
+  Description:
+    This function will search for a matching VID PID driver in the TPL table.
+    If a driver was not found, the function will return the number of entries
+    in the TPL table. The function will start searching from (and including)
+    startPoint.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/    
+
+int _USB_HOST_FindVIDPIDDriver
+(
+    uint16_t idVendor,
+    uint16_t idProduct,
+    int startPoint
+);
+
 // *****************************************************************************
 /* Function:
     void _USB_HOST_UpdateConfigurationState
@@ -1192,4 +1627,130 @@ void * _USB_HOST_FindEndOfDescriptor(void * descriptor);
 */    
 
 void _USB_HOST_TimerCallback(uintptr_t context);
+
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_DeviceTimerCallback
+    (
+       uintptr_t context
+    )
+
+  Summary:
+    Function is called when the device timer expires.
+
+  Description:
+    Function is called when the device timer expires.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/    
+
+void _USB_HOST_DeviceTimerCallback(uintptr_t context);
+
+#if defined(USB_HOST_TRACE_RECORDS_NUMBER)
+
+// *****************************************************************************
+/* Function:
+    USB_ERROR _USB_HOST_TraceIRPSubmit
+    (
+        USB_HOST_DEVICE_OBJ * deviceObj,
+        DRV_USB_HOST_PIPE_HANDLE drvPipeHandle,
+        USB_HOST_IRP * irp,
+        USB_ENDPOINT_ADDRESS endpoint,
+        USB_TRANSFER_TYPE transferType
+    )
+
+  Summary:
+    Submits an IRP to the HCD and adds it to the trace.
+
+  Description:
+    This function adds a submit record to the trace and submits the IRP to the
+    HCD. The IRP callback is replaced by _USB_HOST_TraceIRPCallback until the
+    IRP completes.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+USB_ERROR _USB_HOST_TraceIRPSubmit
+(
+    USB_HOST_DEVICE_OBJ * deviceObj,
+    DRV_USB_HOST_PIPE_HANDLE drvPipeHandle,
+    USB_HOST_IRP * irp,
+    USB_ENDPOINT_ADDRESS endpoint,
+    USB_TRANSFER_TYPE transferType
+);
+
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_TraceIRPCallback( USB_HOST_IRP * irp )
+
+  Summary:
+    IRP callback that adds the completion record to the trace.
+
+  Description:
+    This function adds the completion record of a traced IRP to the trace,
+    restores the original IRP callback and calls it.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+void _USB_HOST_TraceIRPCallback( USB_HOST_IRP * irp );
+
+#endif
+
+#if defined(USB_HOST_MEMORY_POOL_ENABLE)
+
+// *****************************************************************************
+/* Function:
+    void * _USB_HOST_MemoryPoolAllocate
+    (
+        uint8_t bus,
+        size_t size
+    )
+
+  Summary:
+    Allocates a buffer from the host layer memory pool.
+
+  Description:
+    This function allocates a block from the smallest size class that fits the
+    requested size and has a free block. The block is accounted to the bus.
+    The function returns NULL if no block is available or if the allocation
+    was selected to fail by USB_HOST_MemoryPoolFailureInjectionSet.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application. Client drivers use the _USB_HOST_BufferAllocate macro.
+*/
+
+void * _USB_HOST_MemoryPoolAllocate
+(
+    uint8_t bus,
+    size_t size
+);
+
+// *****************************************************************************
+/* Function:
+    void _USB_HOST_MemoryPoolFree( void * buffer )
+
+  Summary:
+    Returns a buffer to the host layer memory pool.
+
+  Description:
+    This function returns a block that was allocated by
+    _USB_HOST_MemoryPoolAllocate to the pool. NULL and pointers that are not
+    in the pool are ignored.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application. Client drivers use the _USB_HOST_BufferFree macro.
+*/
+
+void _USB_HOST_MemoryPoolFree( void * buffer );
+
+#endif
 #endif
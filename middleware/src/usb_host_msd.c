@@ -95,6 +95,13 @@ USB_HOST_MSD_INSTANCE  gUSBHostMSDInstance[USB_HOST_MSD_INSTANCES_NUMBER];
 uint8_t gUSBHostMSDCBW[USB_HOST_MSD_INSTANCES_NUMBER][32] USB_ALIGN;
 uint8_t gUSBHostMSDCSW[USB_HOST_MSD_INSTANCES_NUMBER][16] USB_ALIGN;
 
+/***********************************************
+ * CBW of the queued transfer. The CBW of the
+ * next transfer is prepared in this buffer while
+ * the current transfer is in progress.
+ ***********************************************/
+uint8_t gUSBHostMSDQueuedCBW[USB_HOST_MSD_INSTANCES_NUMBER][32] USB_ALIGN;
+
 // *****************************************************************************
 // *****************************************************************************
 // USB Host MSD Local Functions
@@ -380,21 +387,129 @@ void _USB_HOST_MSD_TransferTasks
 
         if(transferIsDone)
         {
-            if(msdInstanceInfo->transferObj.callback != NULL)
+            /* Let the caller know that the transfer is done and start the
+             * queued transfer if there is one */
+            _USB_HOST_MSD_TransferComplete(msdInstanceIndex, msdResult, processedBytes);
+        }
+    }
+}
+
+// *****************************************************************************
+/* Function:
+   void _USB_HOST_MSD_TransferComplete
+   (
+        uintptr_t msdInstanceIndex,
+        USB_HOST_MSD_RESULT msdResult,
+        size_t processedBytes
+   );
+
+  Summary:
+    This function completes the current BOT transfer and starts the queued
+    transfer.
+
+  Description:
+    This function calls the callback of the current BOT transfer and releases
+    the transfer object. If a transfer was queued and the current command
+    passed, the CBW of the queued transfer, which was already prepared, is sent
+    immediately. If the CBW cannot be sent, the queued transfer is completed
+    with the error result. If the current command did not pass, the device
+    expects the host to find out why before the next command. The queued
+    transfer is then returned to its caller with a USB_HOST_MSD_RESULT_BUSY
+    result. A queued transfer whose CBW is still being prepared is started by
+    its caller.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application. This function is called in the context of the transfer
+    event handler or the transfer error tasks.
+*/
+
+void _USB_HOST_MSD_TransferComplete
+(
+    uintptr_t msdInstanceIndex,
+    USB_HOST_MSD_RESULT msdResult,
+    size_t processedBytes
+)
+{
+    USB_HOST_TRANSFER_HANDLE transferHandle;
+    USB_HOST_MSD_TRANSFER_OBJ * queuedTransferObj;
+    USB_HOST_MSD_TRANSFER_OBJ failedTransferObj;
+    USB_HOST_RESULT hostResult;
+    USB_MSD_CBW * msdCBW;
+    USB_HOST_MSD_INSTANCE * msdInstanceInfo = &gUSBHostMSDInstance[msdInstanceIndex];
+
+    if(msdInstanceInfo->transferObj.callback != NULL)
+    {
+        /* Let the caller who initiated the command know that this is
+         * done */
+        msdInstanceInfo->transferObj.callback(msdInstanceInfo->transferObj.lunHandle,
+                (USB_HOST_MSD_TRANSFER_HANDLE)(&msdInstanceInfo->transferObj), 
+                msdResult, processedBytes, msdInstanceInfo->transferObj.context);
+    }
+
+    queuedTransferObj = &msdInstanceInfo->queuedTransferObj;
+
+    if((queuedTransferObj->inUse) && (msdInstanceInfo->queuedTransferIsReady) &&
+            (msdResult == USB_HOST_MSD_RESULT_COMMAND_PASSED) &&
+            (msdInstanceInfo->msdState == USB_HOST_MSD_STATE_READY))
+    {
+        /* The queued transfer becomes the current transfer. Its CBW is
+         * already prepared. Swap the CBW buffers and send it. The transfer
+         * object stays in use. */
+        msdInstanceInfo->transferObj = *queuedTransferObj;
+        queuedTransferObj->inUse = false;
+        msdInstanceInfo->queuedTransferIsReady = false;
+
+        msdCBW = msdInstanceInfo->msdCBW;
+        msdInstanceInfo->msdCBW = msdInstanceInfo->msdQueuedCBW;
+        msdInstanceInfo->msdQueuedCBW = msdCBW;
+
+        msdInstanceInfo->cswPhaseError = false;
+        msdInstanceInfo->transferState = USB_HOST_MSD_TRANSFER_STATE_WAIT_FOR_CBW;
+        msdInstanceInfo->transferErrorTaskState = USB_HOST_MSD_TRANSFER_ERROR_STATE_NO_ERROR;
+
+        hostResult = USB_HOST_DeviceTransfer(msdInstanceInfo->bulkOutPipeHandle, &transferHandle, msdInstanceInfo->msdCBW, 31, msdInstanceIndex);
+
+        if(hostResult != USB_HOST_RESULT_SUCCESS)
+        {
+            /* The CBW could not be sent. Release the transfer object before
+             * the callback, so that the caller can start another transfer
+             * from it. */
+            failedTransferObj = msdInstanceInfo->transferObj;
+            msdInstanceInfo->transferObj.inUse = false;
+            msdInstanceInfo->transferState = USB_HOST_MSD_TRANSFER_STATE_READY;
+
+            if(failedTransferObj.callback != NULL)
             {
-                /* Let the caller who initiated the command know that this is
-                 * done */
-                msdInstanceInfo->transferObj.callback(msdInstanceInfo->transferObj.lunHandle,
+                failedTransferObj.callback(failedTransferObj.lunHandle,
                         (USB_HOST_MSD_TRANSFER_HANDLE)(&msdInstanceInfo->transferObj), 
-                        msdResult, processedBytes, msdInstanceInfo->transferObj.context);
+                        _USB_HOST_MSD_HostResultToMSDResultMap(hostResult), 0,
+                        failedTransferObj.context);
             }
+        }
+    }
+    else
+    {
+        if((queuedTransferObj->inUse) && (msdInstanceInfo->queuedTransferIsReady))
+        {
+            /* The queued transfer cannot be started. Return it to the
+             * caller. */
+            queuedTransferObj->inUse = false;
+            msdInstanceInfo->queuedTransferIsReady = false;
 
-            /* Return the transfer object back */
-            msdInstanceInfo->transferObj.inUse = false;
-
-            /* Make the transfer state ready for another transfer */
-            msdInstanceInfo->transferState = USB_HOST_MSD_TRANSFER_STATE_READY;
+            if(queuedTransferObj->callback != NULL)
+            {
+                queuedTransferObj->callback(queuedTransferObj->lunHandle,
+                        (USB_HOST_MSD_TRANSFER_HANDLE)(queuedTransferObj), 
+                        USB_HOST_MSD_RESULT_BUSY, 0, queuedTransferObj->context);
+            }
         }
+
+        /* Return the transfer object back */
+        msdInstanceInfo->transferObj.inUse = false;
+
+        /* Make the transfer state ready for another transfer */
+        msdInstanceInfo->transferState = USB_HOST_MSD_TRANSFER_STATE_READY;
     }
 }
 
@@ -893,21 +1008,9 @@ void USB_HOST_MSD_TransferErrorTasks
 
                 if(transferIsDone)
                 {
-                    if(msdInstanceInfo->transferObj.callback != NULL)
-                    {
-                        /* Let the caller who initiated the command know that this is
-                         * done */
-                        msdInstanceInfo->transferObj.callback(msdInstanceInfo->transferObj.lunHandle,
-                                (USB_HOST_MSD_TRANSFER_HANDLE)(&msdInstanceInfo->transferObj), 
-                                msdResult, processedBytes, 
-                                msdInstanceInfo->transferObj.context);
-                    }
-
-                    /* Return the transfer object back */
-                    msdInstanceInfo->transferObj.inUse = false;
-
-                    /* Make the transfer state ready for another transfer */
-                    msdInstanceInfo->transferState = USB_HOST_MSD_TRANSFER_STATE_READY;
+                    /* Let the caller know that the transfer is done and start
+                     * the queued transfer if there is one */
+                    _USB_HOST_MSD_TransferComplete(msdInstanceIndex, msdResult, processedBytes);
                 }
             }
         }
@@ -1056,6 +1159,7 @@ void _USB_HOST_MSD_Initialize(void * msdInitData)
         msdInstanceInfo->bulkOutPipeHandle = USB_HOST_PIPE_HANDLE_INVALID;
         msdInstanceInfo->msdCBW = (USB_MSD_CBW *)(&gUSBHostMSDCBW[iterator][0]);
         msdInstanceInfo->msdCSW = (USB_MSD_CSW *)(&gUSBHostMSDCSW[iterator][0]);
+        msdInstanceInfo->msdQueuedCBW = (USB_MSD_CBW *)(&gUSBHostMSDQueuedCBW[iterator][0]);
 
         /* We create mutexes at initialization time. This way we dont have to
          * deal with having to delete the mutex when the interface is released.
@@ -1214,6 +1318,8 @@ void _USB_HOST_MSD_InterfaceAssign
                                 gUSBHostMSDInstance[driverIndex].assigned = true;
                                 msdInstanceInfo = &gUSBHostMSDInstance[driverIndex];
                                 msdInstanceInfo->transferObj.inUse = false;
+                                msdInstanceInfo->queuedTransferObj.inUse = false;
+                                msdInstanceInfo->queuedTransferIsReady = false;
                                 msdInstanceInfo->transferState = USB_HOST_MSD_TRANSFER_STATE_READY;
                                 msdInstanceInfo->transferErrorTaskState = USB_HOST_MSD_TRANSFER_ERROR_STATE_NO_ERROR;
                                 msdInstanceInfo->msdState = USB_HOST_MSD_STATE_GET_MAX_LUN;
@@ -1577,34 +1683,34 @@ void _USB_HOST_MSD_InterfaceTasks
 
 // *****************************************************************************
 /* Function:
-   USB_HOST_MSD_RESULT USB_HOST_MSD_Transfer
+   USB_HOST_MSD_RESULT _USB_HOST_MSD_TransferSchedule
    (
-       uint8_t * cdb,
-       uint8_t cdbLength,
-       void * data,
-       size_t size,
-       USB_HOST_MSD_TRANSFER_DIRECTION transferDirection,
-       USB_HOST_MSD_TRANSFER_CALLBACK callback,
-       uintptr_t context
-   )
+        USB_HOST_MSD_LUN_HANDLE lunHandle,
+        uint8_t * cdb,
+        uint8_t cdbLength,
+        void * data,
+        size_t size,
+        USB_HOST_MSD_TRANSFER_DIRECTION transferDirection,
+        USB_HOST_MSD_TRANSFER_CALLBACK callback,
+        uintptr_t context,
+        bool queueEnable
+   );
 
   Summary:
-    This function schedules a MSD BOT transfer.
+    This function schedules or queues a MSD BOT transfer.
 
   Description:
-    This function schedules a MSD BOT transfer. The command to be executed is
-    specified in the cdb. This should be pointer to a 16 byte command descriptor
-    block. The actual length of the command is specified by cdbLength. If there
-    is data to be transferred, the pointer to the buffer is specified by data.
-    The size of the buffer is specified in size. When the transfer completes,
-    the callback function will be called. The context will be returned in the
-    callback function.
+    This function implements the USB_HOST_MSD_Transfer and the
+    USB_HOST_MSD_TransferQueue functions. If queueEnable is true and a BOT
+    transfer is in progress, the CBW of the new transfer is prepared and the
+    transfer is started when the current transfer completes.
 
   Remarks:
-    None.
+    This is a local function and should not be called directly by the
+    application.
 */
 
-USB_HOST_MSD_RESULT USB_HOST_MSD_Transfer
+USB_HOST_MSD_RESULT _USB_HOST_MSD_TransferSchedule
 (
     USB_HOST_MSD_LUN_HANDLE lunHandle,
     uint8_t * cdb,
@@ -1613,7 +1719,8 @@ USB_HOST_MSD_RESULT USB_HOST_MSD_Transfer
     size_t size,
     USB_HOST_MSD_TRANSFER_DIRECTION transferDirection,
     USB_HOST_MSD_TRANSFER_CALLBACK callback,
-    uintptr_t context
+    uintptr_t context,
+    bool queueEnable
 )
 {
     USB_HOST_MSD_RESULT result;
@@ -1622,6 +1729,10 @@ USB_HOST_MSD_RESULT USB_HOST_MSD_Transfer
     int msdInstanceIndex;
     USB_HOST_RESULT hostResult;
     USB_HOST_TRANSFER_HANDLE transferHandle;
+    USB_HOST_MSD_TRANSFER_OBJ * transferObj;
+    USB_MSD_CBW * msdCBW = NULL;
+    bool transferIsQueued = false;
+    bool interruptIsEnabled;
 
     if(USB_HOST_MSD_LUN_HANDLE_INVALID == lunHandle)
     {
@@ -1651,8 +1762,12 @@ USB_HOST_MSD_RESULT USB_HOST_MSD_Transfer
             {
                 /* We got the mutex. Now check if the BOT transfer object is
                  * free and if the MSD state machine can accept transfer
-                 * requests. */
+                 * requests. If the BOT transfer object is in use, the transfer
+                 * can still be queued if the caller allows this, the queued
+                 * transfer object is free and the current transfer is not
+                 * recovering from an error. */
 
+                transferObj = NULL;
 
                 if((msdInstanceInfo->msdState == USB_HOST_MSD_STATE_READY) && 
                         (!msdInstanceInfo->transferObj.inUse) &&
@@ -1660,54 +1775,112 @@ USB_HOST_MSD_RESULT USB_HOST_MSD_Transfer
                 {
                     /* We can proceed with the request. Grab the transfer object */
                     msdInstanceInfo->transferObj.inUse = true;
+                    transferObj = &msdInstanceInfo->transferObj;
+                    msdCBW = msdInstanceInfo->msdCBW;
+                }
+                else if((queueEnable) && (msdInstanceInfo->msdState == USB_HOST_MSD_STATE_READY) && 
+                        (msdInstanceInfo->transferObj.inUse) &&
+                        (!msdInstanceInfo->queuedTransferObj.inUse) &&
+                        (msdInstanceInfo->transferState != USB_HOST_MSD_TRANSFER_STATE_ERROR))
+                {
+                    /* The transfer will be queued. Claim the queued transfer
+                     * object while the mutex is held. The current transfer
+                     * starts it only after the CBW is prepared. */
+                    msdInstanceInfo->queuedTransferObj.inUse = true;
+                    transferObj = &msdInstanceInfo->queuedTransferObj;
+                    msdCBW = msdInstanceInfo->msdQueuedCBW;
+                }
 
+                if(transferObj != NULL)
+                {
                     /* We can release the mutex now */
                     OSAL_MUTEX_Unlock(&(msdInstanceInfo->mutexMSDInstanceObject));
                     
                     /* Setup the CBW */
-                    msdInstanceInfo->msdCBW->dCBWSignature = USB_MSD_VALID_CBW_SIGNATURE;
-                    msdInstanceInfo->msdCBW->dCBWTag = USB_MSD_VALID_CBW_TAG;
-                    msdInstanceInfo->msdCBW->bCBWCBLength = cdbLength;
-                    msdInstanceInfo->msdCBW->dCBWDataTransferLength = size;
-                    msdInstanceInfo->msdCBW->bmCBWFlags.value = transferDirection;
-                    
-                    /* Reset the phase error flag. This flag gets set is a phase
-                     * error has occurred. */
-                    msdInstanceInfo->cswPhaseError = false;
-
-                    msdInstanceInfo->msdCBW->bCBWLUN = USB_HOST_MSD_LUN(lunHandle);
+                    msdCBW->dCBWSignature = USB_MSD_VALID_CBW_SIGNATURE;
+                    msdCBW->dCBWTag = USB_MSD_VALID_CBW_TAG;
+                    msdCBW->bCBWCBLength = cdbLength;
+                    msdCBW->dCBWDataTransferLength = size;
+                    msdCBW->bmCBWFlags.value = transferDirection;
+                    msdCBW->bCBWLUN = USB_HOST_MSD_LUN(lunHandle);
 
                     /* Copy the cdb. It should be zero padded */
                     for(iterator = 0; iterator < 16; iterator ++)
                     {
                         /* Clear the command block */
-                        msdInstanceInfo->msdCBW->CBWCB[iterator] = 0;
+                        msdCBW->CBWCB[iterator] = 0;
                     }
 
                     /* Now copy the command */
                     for(iterator = 0; iterator < cdbLength; iterator ++)
                     {
-                        msdInstanceInfo->msdCBW->CBWCB[iterator] = cdb[iterator];
+                        msdCBW->CBWCB[iterator] = cdb[iterator];
                     }
 
                     /* Save the caller data in the transfer object */
-                    msdInstanceInfo->transferObj.callback = callback;
-                    msdInstanceInfo->transferObj.context = context;
-                    msdInstanceInfo->transferObj.size = size;
-                    msdInstanceInfo->transferObj.transferDirection = transferDirection;
-                    msdInstanceInfo->transferObj.cdb = cdb;
-                    msdInstanceInfo->transferObj.cdbLength = cdbLength;
-                    msdInstanceInfo->transferObj.lunHandle = lunHandle;
-                    msdInstanceInfo->transferObj.buffer = data;
-
-                    msdInstanceInfo->transferState = USB_HOST_MSD_TRANSFER_STATE_WAIT_FOR_CBW;
-                    msdInstanceInfo->transferErrorTaskState = USB_HOST_MSD_TRANSFER_ERROR_STATE_NO_ERROR;
-
-                    /* CBW must go out on the bulk out pipe handle */
-                    hostResult = USB_HOST_DeviceTransfer(msdInstanceInfo->bulkOutPipeHandle, &transferHandle, msdInstanceInfo->msdCBW, 31, (uintptr_t)(msdInstanceIndex));
-
-                    /* Map the result */
-                    result = _USB_HOST_MSD_HostResultToMSDResultMap(hostResult); 
+                    transferObj->callback = callback;
+                    transferObj->context = context;
+                    transferObj->size = size;
+                    transferObj->transferDirection = transferDirection;
+                    transferObj->cdb = cdb;
+                    transferObj->cdbLength = cdbLength;
+                    transferObj->lunHandle = lunHandle;
+                    transferObj->buffer = data;
+
+                    if(transferObj == &msdInstanceInfo->queuedTransferObj)
+                    {
+                        /* The current transfer completes in the transfer
+                         * event handler. The check and the update of the
+                         * queued transfer object must therefore be atomic. */
+                        interruptIsEnabled = SYS_INT_Disable();
+
+                        if(msdInstanceInfo->transferObj.inUse)
+                        {
+                            /* The current transfer is still in progress. The
+                             * queued transfer will be started when it
+                             * completes. */
+                            msdInstanceInfo->queuedTransferIsReady = true;
+                            transferIsQueued = true;
+                        }
+                        else
+                        {
+                            /* The current transfer completed in the meantime.
+                             * Start this transfer right away. Grab the
+                             * transfer object and swap the CBW buffers. */
+                            msdInstanceInfo->transferObj = *transferObj;
+                            transferObj->inUse = false;
+                            msdInstanceInfo->msdQueuedCBW = msdInstanceInfo->msdCBW;
+                            msdInstanceInfo->msdCBW = msdCBW;
+                        }
+
+                        if(interruptIsEnabled)
+                        {
+                            /* Re-enable the global interrupt */
+                            SYS_INT_Enable();
+                        }
+                    }
+
+                    if(transferIsQueued)
+                    {
+                        /* The CBW will be sent when the current transfer
+                         * completes */
+                        result = USB_HOST_MSD_RESULT_SUCCESS;
+                    }
+                    else
+                    {
+                        /* Reset the phase error flag. This flag gets set is a
+                         * phase error has occurred. */
+                        msdInstanceInfo->cswPhaseError = false;
+
+                        msdInstanceInfo->transferState = USB_HOST_MSD_TRANSFER_STATE_WAIT_FOR_CBW;
+                        msdInstanceInfo->transferErrorTaskState = USB_HOST_MSD_TRANSFER_ERROR_STATE_NO_ERROR;
+
+                        /* CBW must go out on the bulk out pipe handle */
+                        hostResult = USB_HOST_DeviceTransfer(msdInstanceInfo->bulkOutPipeHandle, &transferHandle, msdInstanceInfo->msdCBW, 31, (uintptr_t)(msdInstanceIndex));
+
+                        /* Map the result */
+                        result = _USB_HOST_MSD_HostResultToMSDResultMap(hostResult); 
+                    }
                 }
                 else if(msdInstanceInfo->msdState < USB_HOST_MSD_STATE_NOT_READY)
                 {
@@ -1739,3 +1912,95 @@ USB_HOST_MSD_RESULT USB_HOST_MSD_Transfer
 
     return(result);
 }
+
+// *****************************************************************************
+/* Function:
+   USB_HOST_MSD_RESULT USB_HOST_MSD_Transfer
+   (
+       uint8_t * cdb,
+       uint8_t cdbLength,
+       void * data,
+       size_t size,
+       USB_HOST_MSD_TRANSFER_DIRECTION transferDirection,
+       USB_HOST_MSD_TRANSFER_CALLBACK callback,
+       uintptr_t context
+   )
+
+  Summary:
+    This function schedules a MSD BOT transfer.
+
+  Description:
+    This function schedules a MSD BOT transfer. The command to be executed is
+    specified in the cdb. This should be pointer to a 16 byte command descriptor
+    block. The actual length of the command is specified by cdbLength. If there
+    is data to be transferred, the pointer to the buffer is specified by data.
+    The size of the buffer is specified in size. When the transfer completes,
+    the callback function will be called. The context will be returned in the
+    callback function.
+
+  Remarks:
+    None.
+*/
+
+USB_HOST_MSD_RESULT USB_HOST_MSD_Transfer
+(
+    USB_HOST_MSD_LUN_HANDLE lunHandle,
+    uint8_t * cdb,
+    uint8_t cdbLength,
+    void * data,
+    size_t size,
+    USB_HOST_MSD_TRANSFER_DIRECTION transferDirection,
+    USB_HOST_MSD_TRANSFER_CALLBACK callback,
+    uintptr_t context
+)
+{
+    /* Schedule the transfer. The transfer is not queued if another transfer
+     * is in progress. */
+    return(_USB_HOST_MSD_TransferSchedule(lunHandle, cdb, cdbLength, data, size, 
+                transferDirection, callback, context, false));
+}
+
+// *****************************************************************************
+/* Function:
+   USB_HOST_MSD_RESULT USB_HOST_MSD_TransferQueue
+   (
+       USB_HOST_MSD_LUN_HANDLE lunHandle,
+       uint8_t * cdb,
+       uint8_t cdbLength,
+       void * data,
+       size_t size,
+       USB_HOST_MSD_TRANSFER_DIRECTION transferDirection,
+       USB_HOST_MSD_TRANSFER_CALLBACK callback,
+       uintptr_t context
+   )
+
+  Summary:
+    This function schedules a MSD BOT transfer or queues it behind the
+    transfer in progress.
+
+  Description:
+    This function is similar to USB_HOST_MSD_Transfer. If a BOT transfer is in
+    progress, the CBW of this transfer is prepared and the transfer is started
+    as soon as the current transfer has completed with a passed status. One
+    transfer can be queued per MSD instance.
+
+  Remarks:
+    None.
+*/
+
+USB_HOST_MSD_RESULT USB_HOST_MSD_TransferQueue
+(
+    USB_HOST_MSD_LUN_HANDLE lunHandle,
+    uint8_t * cdb,
+    uint8_t cdbLength,
+    void * data,
+    size_t size,
+    USB_HOST_MSD_TRANSFER_DIRECTION transferDirection,
+    USB_HOST_MSD_TRANSFER_CALLBACK callback,
+    uintptr_t context
+)
+{
+    /* Schedule the transfer or queue it behind the current transfer */
+    return(_USB_HOST_MSD_TransferSchedule(lunHandle, cdb, cdbLength, data, size, 
+                transferDirection, callback, context, true));
+}
@@ -245,6 +245,10 @@ typedef struct
     /* Pointer to the CSW for this instance */
     USB_MSD_CSW   *msdCSW;
 
+    /* Pointer to the CBW of the queued transfer. This CBW is prepared while
+     * the current transfer is in progress. */
+    USB_MSD_CBW   *msdQueuedCBW;
+
     /* CSW phase error has occurred */
     bool cswPhaseError;
 
@@ -272,6 +276,14 @@ typedef struct
     /* Transfer object */
     USB_HOST_MSD_TRANSFER_OBJ transferObj;
 
+    /* Transfer object of the transfer that is started when the current
+     * transfer completes */
+    USB_HOST_MSD_TRANSFER_OBJ queuedTransferObj;
+
+    /* True once the CBW of the queued transfer is prepared. The queued
+     * transfer object is claimed before its CBW is prepared. */
+    volatile bool queuedTransferIsReady;
+
     /* Interface number */
     uint8_t bInterfaceNumber;
 
@@ -697,5 +709,80 @@ void _USB_HOST_MSD_TransferTasks
     size_t size
 );
 
+// *****************************************************************************
+/* Function:
+   void _USB_HOST_MSD_TransferComplete
+   (
+        uintptr_t msdInstanceIndex,
+        USB_HOST_MSD_RESULT msdResult,
+        size_t processedBytes
+   );
+
+  Summary:
+    This function completes the current BOT transfer and starts the queued
+    transfer.
+
+  Description:
+    This function calls the callback of the current BOT transfer and releases
+    the transfer object. If a transfer was queued and the current command
+    passed, the queued transfer is started immediately. If the current command
+    did not pass, the queued transfer is returned to its caller with a
+    USB_HOST_MSD_RESULT_BUSY result so that the caller can handle the failure
+    before submitting it again.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+void _USB_HOST_MSD_TransferComplete
+(
+    uintptr_t msdInstanceIndex,
+    USB_HOST_MSD_RESULT msdResult,
+    size_t processedBytes
+);
+
+// *****************************************************************************
+/* Function:
+   USB_HOST_MSD_RESULT _USB_HOST_MSD_TransferSchedule
+   (
+        USB_HOST_MSD_LUN_HANDLE lunHandle,
+        uint8_t * cdb,
+        uint8_t cdbLength,
+        void * data,
+        size_t size,
+        USB_HOST_MSD_TRANSFER_DIRECTION transferDirection,
+        USB_HOST_MSD_TRANSFER_CALLBACK callback,
+        uintptr_t context,
+        bool queueEnable
+   );
+
+  Summary:
+    This function schedules or queues a MSD BOT transfer.
+
+  Description:
+    This function implements the USB_HOST_MSD_Transfer and the
+    USB_HOST_MSD_TransferQueue functions. If queueEnable is true and a BOT
+    transfer is in progress, the CBW of the new transfer is prepared and the
+    transfer is started when the current transfer completes.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+USB_HOST_MSD_RESULT _USB_HOST_MSD_TransferSchedule
+(
+    USB_HOST_MSD_LUN_HANDLE lunHandle,
+    uint8_t * cdb,
+    uint8_t cdbLength,
+    void * data,
+    size_t size,
+    USB_HOST_MSD_TRANSFER_DIRECTION transferDirection,
+    USB_HOST_MSD_TRANSFER_CALLBACK callback,
+    uintptr_t context,
+    bool queueEnable
+);
+
 #endif
 
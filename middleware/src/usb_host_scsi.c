@@ -158,9 +158,10 @@ void _USB_HOST_SCSI_Transfer
 )
 {
     USB_HOST_SCSI_INSTANCE_OBJ * scsiObj;
-    USB_HOST_SCSI_COMMAND_OBJ * commandObj;
+    USB_HOST_SCSI_COMMAND_OBJ * requestObj = NULL;
     USB_HOST_MSD_RESULT result;
     USB_HOST_MSD_TRANSFER_HANDLE temp, * commandHandle;
+    OSAL_CRITSECT_DATA_TYPE IntState;
 
     /* If the transfer handle parameter is NULL, we set up a local variable to
      * temporarily store the transfer handle */
@@ -185,9 +186,8 @@ void _USB_HOST_SCSI_Transfer
         scsiObj = (USB_HOST_SCSI_INSTANCE_OBJ *)(scsiHandle);
 
         if((scsiObj->inUse) && (scsiObj->state == USB_HOST_SCSI_STATE_READY) &&
-                (!scsiObj->commandObj.inUse) && (scsiObj->isMediaReady))
+                (scsiObj->isMediaReady) && (nSectors <= scsiObj->blockCommandSectorsMax))
         {
-
             /* Check if the media is write protected */
             if((direction == USB_HOST_MSD_TRANSFER_DIRECTION_HOST_TO_DEVICE) && (scsiObj->isWriteProtected))
             {
@@ -195,14 +195,219 @@ void _USB_HOST_SCSI_Transfer
             }
             else
             {
-                /* This means the SCSI instance is valid and the command object is
-                 * available. Start by grabbing the command object */
+                /* Add the request to the queue. The queue is also updated in
+                 * the block transfer callback. */
+                IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+                if(scsiObj->queueCount < USB_HOST_SCSI_COMMAND_QUEUE_DEPTH)
+                {
+                    requestObj = &scsiObj->commandQueue[(scsiObj->queueHead + scsiObj->queueCount) % USB_HOST_SCSI_COMMAND_QUEUE_DEPTH];
+                    requestObj->inUse = true;
+                    requestObj->commandCompleted = false;
+                    requestObj->startSector = startSector;
+                    requestObj->nSectors = nSectors;
+                    requestObj->direction = direction;
+                    requestObj->buffer = buffer;
+                    scsiObj->queueCount ++;
+                }
+
+                OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+                if(requestObj == NULL)
+                {
+                    /* The queue is full */
+                    SYS_DEBUG_PRINT(SYS_ERROR_DEBUG, "\r\nUSB Host SCSI: SCSI Instance command queue is full");
+                    *commandHandle = SYS_FS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID;
+                    _USB_HOST_SCSI_ERROR_CALLBACK((uintptr_t)scsiHandle, USB_HOST_SCSI_ERROR_CODE_INSTANCE_BUSY);
+                }
+                else
+                {
+                    /* Initialize the command handle */
+                    *commandHandle = (SYS_FS_MEDIA_BLOCK_COMMAND_HANDLE)(requestObj);
+
+                    /* Schedule the transfer. If the MSD driver is busy, the
+                     * SCSI transfer tasks will continue to try scheduling the
+                     * transfer. The caller will still get a valid command
+                     * handle. */
+                    result = _USB_HOST_SCSI_BlockCommandSchedule(scsiObj);
+
+                    if(result == USB_HOST_MSD_RESULT_FAILURE)
+                    {
+                        IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+                        if((scsiObj->commandCount == 0) && (scsiObj->queueCount == 1))
+                        {
+                            /* The request failed and no other request is
+                             * pending. Return the request object and return an
+                             * invalid handle */
+
+                            SYS_DEBUG_PRINT(SYS_ERROR_DEBUG, "\r\nUSB Host SCSI: Could not schedule BOT transfer");
+                            *commandHandle = SYS_FS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID;
+                            requestObj->inUse = false;
+                            scsiObj->queueCount = 0;
+                        }
+
+                        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+                    }
+                }
+            }
+        }
+        else
+        {
+            /* The SCSI instance is not ready */
+            SYS_DEBUG_PRINT(SYS_ERROR_DEBUG, "\r\nUSB Host SCSI: SCSI Instance is not ready");
+            *commandHandle = SYS_FS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID;
+            _USB_HOST_SCSI_ERROR_CALLBACK((uintptr_t)scsiHandle, USB_HOST_SCSI_ERROR_CODE_INSTANCE_BUSY);
+        }
+    }
+}
+
+// ******************************************************************************
+/* Function:
+    USB_HOST_MSD_RESULT _USB_HOST_SCSI_BlockCommandSchedule
+    (
+        USB_HOST_SCSI_INSTANCE_OBJ * scsiObj
+    );
+
+  Summary:
+    This function submits queued block requests to the MSD Host Client driver.
+
+  Description:
+    This function builds a READ10 or WRITE10 command from the oldest block
+    requests that have not been submitted yet and submits it to the MSD Host
+    Client driver. Requests are merged into one command if they have the same
+    direction, if the sectors follow each other and if the buffers follow each
+    other in memory. While one command is in progress, the next command is
+    queued in the MSD Host Client driver. Its CBW is then sent as soon as the
+    CSW of the command in progress is received.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+USB_HOST_MSD_RESULT _USB_HOST_SCSI_BlockCommandSchedule
+(
+    USB_HOST_SCSI_INSTANCE_OBJ * scsiObj
+)
+{
+    USB_HOST_SCSI_COMMAND_OBJ * commandObj;
+    USB_HOST_SCSI_COMMAND_OBJ * requestObj;
+    USB_HOST_MSD_RESULT result = USB_HOST_MSD_RESULT_SUCCESS;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+    size_t requestIndex;
+    size_t sectorsMax;
+    bool isFirstCommand = false;
+
+    /* Requests are merged up to the READ10 or WRITE10 limit unless the logical
+     * unit has accepted the read capacity (16) command and is therefore
+     * accessed with READ16 or WRITE16 commands. */
+    sectorsMax = scsiObj->blockCommandSectorsMax;
+
+    if((!scsiObj->useLongCommands) && (sectorsMax > USB_HOST_SCSI_BLOCK_COMMAND_SECTORS_MAX))
+    {
+        sectorsMax = USB_HOST_SCSI_BLOCK_COMMAND_SECTORS_MAX;
+    }
+
+    do
+    {
+        commandObj = NULL;
+
+        /* Block commands are not submitted while the transfer state machine is
+         * recovering from a failed command. The command object is reserved in
+         * a critical section because the block transfer callback updates the
+         * queue. */
+
+        IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+
+        if((scsiObj->transferTaskState == USB_HOST_SCSI_TRANSFER_STATE_IDLE) &&
+                (scsiObj->commandCount < USB_HOST_SCSI_BLOCK_COMMANDS_NUMBER) &&
+                (scsiObj->queueSubmitted < scsiObj->queueCount))
+        {
+            isFirstCommand = (scsiObj->commandCount == 0);
+            commandObj = &scsiObj->commandObj[(scsiObj->commandHead + scsiObj->commandCount) % USB_HOST_SCSI_BLOCK_COMMANDS_NUMBER];
+
+            /* Start with the oldest request that is not submitted */
+            requestIndex = (scsiObj->queueHead + scsiObj->queueSubmitted) % USB_HOST_SCSI_COMMAND_QUEUE_DEPTH;
+            requestObj = &scsiObj->commandQueue[requestIndex];
+
+            commandObj->inUse = true;
+            commandObj->startSector = requestObj->startSector;
+            commandObj->nSectors = requestObj->nSectors;
+            commandObj->direction = requestObj->direction;
+            commandObj->buffer = requestObj->buffer;
+            commandObj->nRequests = 1;
+
+            /* Merge the following requests if they are contiguous */
+            while((scsiObj->queueSubmitted + commandObj->nRequests) < scsiObj->queueCount)
+            {
+                requestObj = &scsiObj->commandQueue[(requestIndex + commandObj->nRequests) % USB_HOST_SCSI_COMMAND_QUEUE_DEPTH];
+
+                if((requestObj->direction != commandObj->direction) ||
+                        (requestObj->startSector != (commandObj->startSector + commandObj->nSectors)) ||
+                        (requestObj->buffer != (void *)((uint8_t *)(commandObj->buffer) + (commandObj->nSectors * scsiObj->blockSize))) ||
+                        (commandObj->nSectors >= sectorsMax) ||
+                        (requestObj->nSectors > (sectorsMax - commandObj->nSectors)))
+                {
+                    break;
+                }
+
+                commandObj->nSectors += requestObj->nSectors;
+                commandObj->nRequests ++;
+            }
+
+            scsiObj->commandCount ++;
+            scsiObj->queueSubmitted += commandObj->nRequests;
+        }
+
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+        if(commandObj != NULL)
+        {
+            if((scsiObj->useLongCommands) || (commandObj->nSectors > USB_HOST_SCSI_BLOCK_COMMAND_SECTORS_MAX))
+            {
+                /* The logical unit requires 16 byte commands or the number of
+                 * sectors does not fit in a READ10 or WRITE10 command */
+                if(commandObj->direction == USB_HOST_MSD_TRANSFER_DIRECTION_DEVICE_TO_HOST)
+                {
+                    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\n\r USB_HOST_SCSI_READ16_COMMAND");
+                    commandObj->cdb[0] = USB_HOST_SCSI_READ16_COMMAND;
+                    commandObj->cdb[1] = 0x00;
+                }
+                else
+                {
+                    commandObj->cdb[0] = USB_HOST_SCSI_WRITE16_COMMAND;
+
+                    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\n\r USB_HOST_SCSI_WRITE16_COMMAND");
+                    /* Set the FUA bit in the command as in the WRITE10
+                     * command. */
+                    commandObj->cdb[1] = 0x04;
+                }
 
-                scsiObj->commandObj.inUse = true;
-                commandObj = &scsiObj->commandObj;
+                /* Set up the sector address. The file system addresses the
+                 * media with 32 bit sector numbers. */
+                commandObj->cdb[2] = 0x00;
+                commandObj->cdb[3] = 0x00;
+                commandObj->cdb[4] = 0x00;
+                commandObj->cdb[5] = 0x00;
+                commandObj->cdb[6] = (uint8_t)(commandObj->startSector >> 24);
+                commandObj->cdb[7] = (uint8_t)(commandObj->startSector >> 16);
+                commandObj->cdb[8] = (uint8_t)(commandObj->startSector >> 8);
+                commandObj->cdb[9] = (uint8_t)(commandObj->startSector);
 
+                /* The number of sectors to read or write */
+                commandObj->cdb[10] = (uint8_t)(commandObj->nSectors >> 24);
+                commandObj->cdb[11] = (uint8_t)(commandObj->nSectors >> 16);
+                commandObj->cdb[12] = (uint8_t)(commandObj->nSectors >> 8);
+                commandObj->cdb[13] = (uint8_t)(commandObj->nSectors);
+                commandObj->cdb[14] = 0x00;
+                commandObj->cdb[15] = 0x00;
+                commandObj->cdbLength = 0x10;
+            }
+            else
+            {
                 /* Set up the command based on direction */
-                if(direction == USB_HOST_MSD_TRANSFER_DIRECTION_DEVICE_TO_HOST)
+                if(commandObj->direction == USB_HOST_MSD_TRANSFER_DIRECTION_DEVICE_TO_HOST)
                 {
                     SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\n\r USB_HOST_SCSI_READ10_COMMAND");
                     commandObj->cdb[0] = USB_HOST_SCSI_READ10_COMMAND;
@@ -220,73 +425,112 @@ void _USB_HOST_SCSI_Transfer
                 }
 
                 /* Set up the sector address */
-                commandObj->cdb[2] = (uint8_t)(startSector >> 24);
-                commandObj->cdb[3] = (uint8_t)(startSector >> 16);
-                commandObj->cdb[4] = (uint8_t)(startSector >> 8);
-                commandObj->cdb[5] = (uint8_t)(startSector);
+                commandObj->cdb[2] = (uint8_t)(commandObj->startSector >> 24);
+                commandObj->cdb[3] = (uint8_t)(commandObj->startSector >> 16);
+                commandObj->cdb[4] = (uint8_t)(commandObj->startSector >> 8);
+                commandObj->cdb[5] = (uint8_t)(commandObj->startSector);
 
                 /* The number of sectors to read or write */
                 commandObj->cdb[6] = 0x00;
-                commandObj->cdb[7] = (uint8_t)(nSectors >> 8);
-                commandObj->cdb[8] = (uint8_t)(nSectors);
+                commandObj->cdb[7] = (uint8_t)(commandObj->nSectors >> 8);
+                commandObj->cdb[8] = (uint8_t)(commandObj->nSectors);
                 commandObj->cdb[9] = 0x00;
+                commandObj->cdbLength = 0x0A;
+            }
 
-                /* Initialize the command handle */
-                *commandHandle = (SYS_FS_MEDIA_BLOCK_COMMAND_HANDLE)(commandObj);
+            /* Schedule the transfer. If a block command is in progress, the
+             * MSD driver queues this command. */
+            result = USB_HOST_MSD_TransferQueue(scsiObj->lunHandle, 
+                    commandObj->cdb, commandObj->cdbLength, commandObj->buffer, (commandObj->nSectors * scsiObj->blockSize), 
+                    commandObj->direction, _USB_HOST_SCSI_BlockTransferCallback, (uintptr_t)(commandObj));
 
-                /* Make sure the transfer state is set to a know value */
-                scsiObj->transferTaskState = USB_HOST_SCSI_TRANSFER_STATE_IDLE;
+            if(result != USB_HOST_MSD_RESULT_SUCCESS)
+            {
+                /* The command could not be submitted. Release the command
+                 * object. The requests remain in the queue. */
+                IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+                commandObj->inUse = false;
+                scsiObj->commandCount --;
+                scsiObj->queueSubmitted -= commandObj->nRequests;
+                OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+
+                if((result == USB_HOST_MSD_RESULT_BUSY) && (isFirstCommand))
+                {
+                    /* The MSD driver is busy completing another transfer. The
+                     * SCSI transfer tasks will retry. */
+                    _USB_HOST_SCSI_ERROR_CALLBACK((uintptr_t)scsiObj, USB_HOST_SCSI_ERROR_CODE_BOT_REQUEST_DEFERRED);
+                }
+            }
+        }
 
-                /* Set the command delay to 0 */
-                scsiObj->nCommandFailureTestUnitReadyAttempts = 0;
+    } while((commandObj != NULL) && (result == USB_HOST_MSD_RESULT_SUCCESS));
 
-                /* Initialize the other members of the command object. These
-                 * would be needed if an error has occurred and the block
-                 * command needs to retried. */
+    return(result);
+}
 
-                scsiObj->commandObj.nSectors = nSectors;
-                scsiObj->commandObj.direction = direction;
-                scsiObj->commandObj.buffer = buffer;
+// ******************************************************************************
+/* Function:
+    void _USB_HOST_SCSI_BlockRequestsComplete
+    (
+        USB_HOST_SCSI_INSTANCE_OBJ * scsiObj,
+        size_t nRequests,
+        USB_HOST_MSD_RESULT result,
+        SYS_MEDIA_BLOCK_EVENT event
+    );
 
-                /* Schedule the transfer */
-                result = USB_HOST_MSD_Transfer(scsiObj->lunHandle, 
-                        scsiObj->commandObj.cdb, 0x0A, buffer , (nSectors << 9) /* The left shift multiplies by 512 */, 
-                        direction, _USB_HOST_SCSI_BlockTransferCallback, (uintptr_t)(scsiObj));
+  Summary:
+    This function completes the oldest block requests in the queue.
 
-                if(result == USB_HOST_MSD_RESULT_SUCCESS)
-                {
-                    /* This means the transfer was scheduled. We dont have to do
-                     * anything. */
-                }
-                else if(result == USB_HOST_MSD_RESULT_BUSY)
-                {
-                    /* The transfer could not be scheduled because the MSD
-                     * driver is busy completing another transfer. We let the
-                     * SCSI transfer tasks continue to try scheduling the
-                     * transfer. The caller will still get a valid command
-                     * handle */
+  Description:
+    This function generates the specified event for the oldest nRequests block
+    requests in the queue and removes them from the queue.
 
-                    scsiObj->transferTaskState = USB_HOST_SCSI_TRANSFER_STATE_BLOCK_COMMAND_RETRY;
-                    _USB_HOST_SCSI_ERROR_CALLBACK((uintptr_t)scsiHandle, USB_HOST_SCSI_ERROR_CODE_BOT_REQUEST_DEFERRED);
-                }
-                else 
-                {
-                    /* The request failed. Return the command object continue
-                     * and return an invalid handle */
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
 
-                    SYS_DEBUG_PRINT(SYS_ERROR_DEBUG, "\r\nUSB Host SCSI: Could not schedule BOT transfer");
-                    *commandHandle = SYS_FS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID;
-                    commandObj->inUse = false;
-                }
-            }
+void _USB_HOST_SCSI_BlockRequestsComplete
+(
+    USB_HOST_SCSI_INSTANCE_OBJ * scsiObj,
+    size_t nRequests,
+    USB_HOST_MSD_RESULT result,
+    SYS_MEDIA_BLOCK_EVENT event
+)
+{
+    USB_HOST_SCSI_COMMAND_OBJ * requestObj;
+    OSAL_CRITSECT_DATA_TYPE IntState;
+
+    while((nRequests > 0) && (scsiObj->queueCount > 0))
+    {
+        requestObj = &scsiObj->commandQueue[scsiObj->queueHead];
+
+        /* Update the request */
+        requestObj->result = result;
+        requestObj->size = (event == SYS_MEDIA_EVENT_BLOCK_COMMAND_COMPLETE) ? (requestObj->nSectors * scsiObj->blockSize) : 0;
+        requestObj->commandCompleted = true;
+
+        /* If there is an event handler registered, then call the event handler
+         * */
+        if(scsiObj->eventHandler != NULL)
+        {
+            /* Generate the event */
+            (scsiObj->eventHandler)(event, (USB_HOST_SCSI_COMMAND_HANDLE)(requestObj), scsiObj->context);
         }
-        else
+
+        /* Return the request object */
+        IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+        requestObj->inUse = false;
+        scsiObj->queueHead = (scsiObj->queueHead + 1) % USB_HOST_SCSI_COMMAND_QUEUE_DEPTH;
+        scsiObj->queueCount --;
+
+        if(scsiObj->queueSubmitted > 0)
         {
-            /* The SCSI instance is not ready */
-            SYS_DEBUG_PRINT(SYS_ERROR_DEBUG, "\r\nUSB Host SCSI: SCSI Instance is not ready");
-            *commandHandle = SYS_FS_MEDIA_BLOCK_COMMAND_HANDLE_INVALID;
-            _USB_HOST_SCSI_ERROR_CALLBACK((uintptr_t)scsiHandle, USB_HOST_SCSI_ERROR_CODE_INSTANCE_BUSY);
+            scsiObj->queueSubmitted --;
         }
+
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+        nRequests --;
     }
 }
 
@@ -376,6 +620,7 @@ void _USB_HOST_SCSI_BlockTransferCallback
     int scsiObjIndex;
     USB_HOST_SCSI_INSTANCE_OBJ * scsiObj;
     USB_HOST_SCSI_COMMAND_OBJ * commandObj;
+    OSAL_CRITSECT_DATA_TYPE IntState;
 
     /* Get the SCSI object index from the lunHandle */
     scsiObjIndex = _USB_HOST_SCSI_LUNHandleToSCSIInstance(lunHandle);
@@ -383,8 +628,9 @@ void _USB_HOST_SCSI_BlockTransferCallback
     /* Get the pointer to the SCSI object */
     scsiObj = &gUSBHostSCSIObj[scsiObjIndex];
 
-    /* Pointer to the command object */
-    commandObj = &scsiObj->commandObj;
+    /* The context for this callback is the pointer to the block command
+     * object */
+    commandObj = (USB_HOST_SCSI_COMMAND_OBJ *)(context);
 
     /* The processed size */
     commandObj->size = size;
@@ -392,26 +638,46 @@ void _USB_HOST_SCSI_BlockTransferCallback
     /* The result of the command */
     commandObj->result = result;
 
-    /* Let the main state machine know that the command is completed */
-    commandObj->commandCompleted = true;
-
-    if((result == USB_HOST_MSD_RESULT_SUCCESS) || (result == USB_HOST_MSD_RESULT_COMMAND_PASSED))
+    if(result == USB_HOST_MSD_RESULT_BUSY)
     {
-        /* If there is an event handler registered, then call the event handler
-         * */
-        if(scsiObj->eventHandler != NULL)
-        {
-            /* Generate the event */
-            (scsiObj->eventHandler)(USB_HOST_SCSI_EVENT_COMMAND_COMPLETE, (USB_HOST_SCSI_COMMAND_HANDLE)(commandObj), scsiObj->context);
-        }
-        
+        /* This block command was queued in the MSD driver but was not started
+         * because the command before it did not pass. This is always the last
+         * submitted command. Return the command object. The requests remain in
+         * the queue and will be submitted again. */
+        IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+        commandObj->inUse = false;
+        scsiObj->commandCount --;
+        scsiObj->queueSubmitted -= commandObj->nRequests;
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
+    }
+    else if((result == USB_HOST_MSD_RESULT_SUCCESS) || (result == USB_HOST_MSD_RESULT_COMMAND_PASSED))
+    {
+        /* Let the main state machine know that the command is completed */
+        commandObj->commandCompleted = true;
+
+        /* The block command passed. Reset the number of Test Unit Ready
+         * attempts for the next command. */
+        scsiObj->nCommandFailureTestUnitReadyAttempts = 0;
+
+        /* Complete all the requests that were merged in this command. This
+         * is always the oldest submitted command. */
+        _USB_HOST_SCSI_BlockRequestsComplete(scsiObj, commandObj->nRequests, result, SYS_MEDIA_EVENT_BLOCK_COMMAND_COMPLETE);
+
         /* Return the command object */
+        IntState = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
         commandObj->inUse = false;
+        scsiObj->commandHead = (scsiObj->commandHead + 1) % USB_HOST_SCSI_BLOCK_COMMANDS_NUMBER;
+        scsiObj->commandCount --;
+        OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, IntState);
     }
     else
     {
+        /* Let the main state machine know that the command is completed */
+        commandObj->commandCompleted = true;
+
         /* The command failed. Transfer control to the transfer state machine to
-         * find out why */
+         * find out why. A block command that was queued behind this one will
+         * be returned by the MSD driver. */
 
         scsiObj->transferTaskState = USB_HOST_SCSI_TRANSFER_STATE_REQUEST_SENSE;
     }
@@ -509,6 +775,101 @@ void _USB_HOST_SCSI_ReadCapacityCommand (uint8_t * scsiCommand )
     scsiCommand[9] = 0x00;
 }
 
+// ******************************************************************************
+/* Function:
+    void _USB_HOST_SCSI_ReadCapacity16Command
+    (
+        uint8_t * scsiCommand
+    )
+
+  Summary:
+    Sets up the Read Capacity (16) Command.
+
+  Description:
+    This function sets up the Read Capacity (16) Command. The command requests
+    the 32 byte long parameter data.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+void _USB_HOST_SCSI_ReadCapacity16Command (uint8_t * scsiCommand )
+{
+    int iterator;
+
+    /* Clear the command */
+    for(iterator = 0; iterator < 16; iterator ++)
+    {
+        scsiCommand[iterator] = 0x00;
+    }
+
+    /* Set up the Read Capacity (16) Command */
+    scsiCommand[0] = SCSI_SERVICE_ACTION_IN_16;
+    scsiCommand[1] = SCSI_SERVICE_ACTION_READ_CAPACITY_16;
+
+    /* The allocation length */
+    scsiCommand[13] = 0x20;
+}
+
+// ******************************************************************************
+/* Function:
+    void _USB_HOST_SCSI_MediaGeometrySet
+    (
+        USB_HOST_SCSI_INSTANCE_OBJ * scsiObj,
+        uint32_t blockSize,
+        uint32_t numBlocks
+    )
+
+  Summary:
+    Updates the media geometry of the logical unit.
+
+  Description:
+    This function updates the media geometry that is reported to the file
+    system and the block size limits used for block commands.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+void _USB_HOST_SCSI_MediaGeometrySet
+(
+    USB_HOST_SCSI_INSTANCE_OBJ * scsiObj,
+    uint32_t blockSize,
+    uint32_t numBlocks
+)
+{
+    /* The read and write will be blocking */
+    scsiObj->mediaGeometry.mediaProperty = (SYS_FS_MEDIA_WRITE_IS_BLOCKING|SYS_FS_MEDIA_READ_IS_BLOCKING);
+
+    /* There is one read, write and erase region */
+    scsiObj->mediaGeometry.numReadRegions = 1;
+    scsiObj->mediaGeometry.numWriteRegions = 1;
+    scsiObj->mediaGeometry.numEraseRegions = 1;
+
+    /* The size of the read region and size of the read block */
+    scsiObj->mediaRegionGeometry[0].blockSize = blockSize;
+    scsiObj->mediaRegionGeometry[0].numBlocks = numBlocks;
+
+    /* The size of the write region and size of the read block */
+    scsiObj->mediaRegionGeometry[1].blockSize = blockSize;
+    scsiObj->mediaRegionGeometry[1].numBlocks = numBlocks;
+
+    /* The size of the erase region and size of the read block */
+    scsiObj->mediaRegionGeometry[2].blockSize = blockSize;
+    scsiObj->mediaRegionGeometry[2].numBlocks = numBlocks;
+
+    /* Adding the region specific geometry table */
+    scsiObj->mediaGeometry.geometryTable = scsiObj->mediaRegionGeometry;
+
+    /* A block command cannot transfer more than what fits in the data
+     * transfer length of the CBW. A zero block size is not valid and leaves
+     * the logical unit unusable. */
+    scsiObj->blockSize = blockSize;
+    scsiObj->blockCommandSectorsMax = (blockSize == 0) ? 0 : (USB_HOST_SCSI_BLOCK_COMMAND_BYTES_MAX / blockSize);
+}
+
 // ******************************************************************************
 /* Function:
     void _USB_HOST_SCSI_InquiryResponseCommand 
@@ -650,6 +1011,7 @@ void USB_HOST_SCSI_Initialize(USB_HOST_MSD_LUN_HANDLE lunHandle)
             scsiObj->buffer = &gUSBSCSIBuffer[iterator][0];
             scsiObj->state = USB_HOST_SCSI_STATE_INQUIRY_RESPONSE;
             scsiObj->fsHandle = SYS_FS_MEDIA_HANDLE_INVALID;
+            scsiObj->blockSize = 512;
             break;
         }
     }
@@ -702,15 +1064,10 @@ void USB_HOST_SCSI_Deinitialize(USB_HOST_MSD_LUN_HANDLE lunHandle)
          * requested by the file system. In such a case we should let the file
          * system know that command has failed */
         
-        if(scsiObj->commandObj.inUse)
+        if(scsiObj->queueCount > 0)
         {
-            /* This means a command was requested */
-            
-            if(scsiObj->eventHandler != NULL)
-            {
-                /* Generate the error event */
-                (scsiObj->eventHandler)(USB_HOST_SCSI_EVENT_COMMAND_ERROR, (USB_HOST_SCSI_COMMAND_HANDLE)(&scsiObj->commandObj), scsiObj->context);
-            }
+            /* This means commands were requested. Fail all of them. */
+            _USB_HOST_SCSI_BlockRequestsComplete(scsiObj, scsiObj->queueCount, USB_HOST_MSD_RESULT_FAILURE, SYS_MEDIA_EVENT_BLOCK_COMMAND_ERROR);
         }
         
         if(scsiObj->eventHandler != NULL)
@@ -807,7 +1164,9 @@ void _USB_HOST_SCSI_TasksByIndex(int scsiObjIndex)
         case USB_HOST_SCSI_STATE_READ_CAPACITY:
 
             SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\n\r USB_HOST_SCSI_STATE_READ_CAPACITY ");
-            /* Here we send the read capacity command */
+            /* Here we send the read capacity command. 16 byte commands are
+             * used only once the read capacity (16) command has passed. */
+            scsiObj->useLongCommands = false;
             _USB_HOST_SCSI_ReadCapacityCommand(scsiObj->taskCommandObj.cdb);
 
             /* The commandCompleted flag will be updated in the callback.
@@ -840,35 +1199,30 @@ void _USB_HOST_SCSI_TasksByIndex(int scsiObjIndex)
                      * object */
 
                     uint8_t * buffer = scsiObj->buffer;
+                    uint32_t lastBlockAddress;
 
-                    /* The read and write will be blocking */
-                    scsiObj->mediaGeometry.mediaProperty = (SYS_FS_MEDIA_WRITE_IS_BLOCKING|SYS_FS_MEDIA_READ_IS_BLOCKING);
-
-                    /* There is one read, write and erase region */
-                    scsiObj->mediaGeometry.numReadRegions = 1;
-                    scsiObj->mediaGeometry.numWriteRegions = 1;
-                    scsiObj->mediaGeometry.numEraseRegions = 1;
-
-                    /* The size of the read region and size of the read block */
-                    scsiObj->mediaRegionGeometry[0].blockSize = (buffer[7])|(buffer[6] << 8)|(buffer[5]<<16)| (buffer[4] << 24);
-                    scsiObj->mediaRegionGeometry[0].numBlocks = ((buffer[3])|(buffer[2] << 8)|(buffer[1]<<16)| (buffer[0] << 24)) + 1;
+                    lastBlockAddress = (buffer[3])|(buffer[2] << 8)|(buffer[1]<<16)| ((uint32_t)buffer[0] << 24);
 
-                    /* The size of the write region and size of the read block */
-                    scsiObj->mediaRegionGeometry[1].blockSize = scsiObj->mediaRegionGeometry[0].blockSize;
-                    scsiObj->mediaRegionGeometry[1].numBlocks = scsiObj->mediaRegionGeometry[0].numBlocks;
-
-                    /* The size of the erase region and size of the read block */
-                    scsiObj->mediaRegionGeometry[2].blockSize = scsiObj->mediaRegionGeometry[0].blockSize;
-                    scsiObj->mediaRegionGeometry[2].numBlocks = scsiObj->mediaRegionGeometry[0].numBlocks;
-
-                    /* Adding the region specific geometry table */
-                    scsiObj->mediaGeometry.geometryTable = scsiObj->mediaRegionGeometry;
                     SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host SCSI: SCSI Instance %d Read Capacity Successful", scsiObjIndex);
-                    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host SCSI: SCSI Instance %d Capacity is %d blocks", scsiObjIndex, scsiObj->mediaRegionGeometry[1].numBlocks);
 
-                    /* Now we can check if the device is write protected.
-                     * */
-                    scsiObj->state = USB_HOST_SCSI_STATE_MODE_SENSE;
+                    if(lastBlockAddress == 0xFFFFFFFF)
+                    {
+                        /* The number of blocks does not fit in the response.
+                         * The read capacity (16) command must be used. Until
+                         * then the geometry is limited to the blocks that the
+                         * file system can address. */
+                        _USB_HOST_SCSI_MediaGeometrySet(scsiObj, (buffer[7])|(buffer[6] << 8)|(buffer[5]<<16)| ((uint32_t)buffer[4] << 24), 0xFFFFFFFF);
+                        scsiObj->state = USB_HOST_SCSI_STATE_READ_CAPACITY_16;
+                    }
+                    else
+                    {
+                        _USB_HOST_SCSI_MediaGeometrySet(scsiObj, (buffer[7])|(buffer[6] << 8)|(buffer[5]<<16)| ((uint32_t)buffer[4] << 24), lastBlockAddress + 1);
+                        SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host SCSI: SCSI Instance %d Capacity is %d blocks", scsiObjIndex, scsiObj->mediaRegionGeometry[1].numBlocks);
+
+                        /* Now we can check if the device is write protected.
+                         * */
+                        scsiObj->state = USB_HOST_SCSI_STATE_MODE_SENSE;
+                    }
                 }
                 else
                 {
@@ -890,6 +1244,88 @@ void _USB_HOST_SCSI_TasksByIndex(int scsiObjIndex)
 
             break;
 
+        case USB_HOST_SCSI_STATE_READ_CAPACITY_16:
+
+            SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\n\r USB_HOST_SCSI_STATE_READ_CAPACITY_16 ");
+            /* Here we send the read capacity (16) command */
+            _USB_HOST_SCSI_ReadCapacity16Command(scsiObj->taskCommandObj.cdb);
+
+            /* The commandCompleted flag will be updated in the callback.
+             * Update the state and send the command.   */
+            scsiObj->taskCommandObj.inUse = true;
+            scsiObj->taskCommandObj.commandCompleted = false;
+
+            result = USB_HOST_MSD_Transfer(scsiObj->lunHandle, 
+                    scsiObj->taskCommandObj.cdb, 0x10, scsiObj->buffer, 0x20 , 
+                    USB_HOST_MSD_TRANSFER_DIRECTION_DEVICE_TO_HOST,
+                    _USB_HOST_SCSI_CommandCallback, (uintptr_t)(&scsiObj->taskCommandObj));
+
+            if(result == USB_HOST_MSD_RESULT_SUCCESS)
+            {
+                /* Go to the next state only if the request was placed
+                 * successfully. */
+                scsiObj->state = USB_HOST_SCSI_STATE_WAIT_READ_CAPACITY_16;
+            }
+
+            break;
+
+        case USB_HOST_SCSI_STATE_WAIT_READ_CAPACITY_16:
+
+            /* Here we wait for the read capacity (16) to complete */
+            if(scsiObj->taskCommandObj.commandCompleted)
+            {
+                if(scsiObj->taskCommandObj.result == USB_HOST_MSD_RESULT_COMMAND_PASSED)
+                {
+                    /* The response contains a 64 bit last logical block
+                     * address followed by the block size */
+
+                    uint8_t * buffer = scsiObj->buffer;
+                    uint32_t numBlocks;
+
+                    if((buffer[0] | buffer[1] | buffer[2] | buffer[3]) != 0)
+                    {
+                        /* The file system addresses the media with 32 bit
+                         * sector numbers. Limit the media to the blocks that
+                         * can be addressed. */
+                        numBlocks = 0xFFFFFFFF;
+                    }
+                    else
+                    {
+                        numBlocks = (buffer[7])|(buffer[6] << 8)|(buffer[5]<<16)| ((uint32_t)buffer[4] << 24);
+                        numBlocks = (numBlocks == 0xFFFFFFFF) ? numBlocks : (numBlocks + 1);
+                    }
+
+                    _USB_HOST_SCSI_MediaGeometrySet(scsiObj, (buffer[11])|(buffer[10] << 8)|(buffer[9]<<16)| ((uint32_t)buffer[8] << 24), numBlocks);
+
+                    /* The logical unit accepts 16 byte commands. Block
+                     * requests can now be merged beyond the READ10 and
+                     * WRITE10 limit. */
+                    scsiObj->useLongCommands = true;
+                    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host SCSI: SCSI Instance %d Read Capacity (16) Successful", scsiObjIndex);
+                }
+                else
+                {
+                    /* The device does not support the read capacity (16)
+                     * command. Continue with the geometry obtained with the
+                     * read capacity command and with 10 byte commands. */
+                    scsiObj->useLongCommands = false;
+                    SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host SCSI: SCSI Instance %d Read Capacity (16) Failed", scsiObjIndex);
+                }
+
+                SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\r\nUSB Host SCSI: SCSI Instance %d Capacity is %d blocks", scsiObjIndex, scsiObj->mediaRegionGeometry[1].numBlocks);
+
+                /* Now we can check if the device is write protected. */
+                scsiObj->state = USB_HOST_SCSI_STATE_MODE_SENSE;
+            }
+            else
+            {
+                /* We must run the Transfer Error tasks while we are waiting
+                 * for the transfer to complete. */                   
+                USB_HOST_MSD_TransferErrorTasks(scsiObj->lunHandle);
+            }
+
+            break;
+
         case USB_HOST_SCSI_STATE_MODE_SENSE:
 
             SYS_DEBUG_PRINT(SYS_ERROR_INFO, "\n\r USB_HOST_SCSI_STATE_MODE_SENSE ");
@@ -1792,13 +2228,25 @@ void USB_HOST_SCSI_TransferTasks(USB_HOST_MSD_LUN_HANDLE lunHandle)
     if(scsiObjIndex >= 0)
     {
         scsiObj = &gUSBHostSCSIObj[scsiObjIndex];
-        commandObj = &scsiObj->commandObj;
+
+        /* The transfer error states operate on the oldest submitted block
+         * command */
+        commandObj = &scsiObj->commandObj[scsiObj->commandHead];
 
         switch(scsiObj->transferTaskState)
         {
             case USB_HOST_SCSI_TRANSFER_STATE_IDLE:
 
-                /* In this state we don't have anything to do. */
+                /* Submit the block requests that are waiting in the queue */
+                result = _USB_HOST_SCSI_BlockCommandSchedule(scsiObj);
+
+                if((result == USB_HOST_MSD_RESULT_FAILURE) && (scsiObj->commandCount == 0) &&
+                        (scsiObj->queueCount > 0))
+                {
+                    /* The oldest request could not be submitted and no command
+                     * is in progress. Fail this request. */
+                    _USB_HOST_SCSI_BlockRequestsComplete(scsiObj, 1, result, SYS_MEDIA_EVENT_BLOCK_COMMAND_ERROR);
+                }
                 break;
 
             case USB_HOST_SCSI_TRANSFER_STATE_REQUEST_SENSE:
@@ -1991,8 +2439,8 @@ void USB_HOST_SCSI_TransferTasks(USB_HOST_MSD_LUN_HANDLE lunHandle)
                  * part of the command object */
 
                 result = USB_HOST_MSD_Transfer(scsiObj->lunHandle, 
-                        scsiObj->commandObj.cdb, 0x0A, scsiObj->commandObj.buffer , (scsiObj->commandObj.nSectors << 9) /* The left shift multiplies by 512 */, 
-                        scsiObj->commandObj.direction, _USB_HOST_SCSI_BlockTransferCallback, (uintptr_t)(scsiObj));
+                        commandObj->cdb, commandObj->cdbLength, commandObj->buffer , (commandObj->nSectors * scsiObj->blockSize), 
+                        commandObj->direction, _USB_HOST_SCSI_BlockTransferCallback, (uintptr_t)(commandObj));
 
                 /* Update the transfer handle */
                 if(result == USB_HOST_MSD_RESULT_SUCCESS)
@@ -2027,17 +2475,14 @@ void USB_HOST_SCSI_TransferTasks(USB_HOST_MSD_LUN_HANDLE lunHandle)
             /* We should let the client know that transfer has failed.
              * The transfer error tasks routine must return back to not
              * doing anything. */
-            if(scsiObj->eventHandler != NULL)
-            {
-                /* Generate the event */
-                (scsiObj->eventHandler)(USB_HOST_SCSI_EVENT_COMMAND_ERROR, 
-                                        (USB_HOST_SCSI_COMMAND_HANDLE)(commandObj), 
-                                        scsiObj->context);
-            }
+            _USB_HOST_SCSI_BlockRequestsComplete(scsiObj, commandObj->nRequests, 
+                    USB_HOST_MSD_RESULT_FAILURE, SYS_MEDIA_EVENT_BLOCK_COMMAND_ERROR);
             
             /* Release the command object and reset the transfer state machine since 
                the command failed. */
-            scsiObj->commandObj.inUse = false;
+            commandObj->inUse = false;
+            scsiObj->commandHead = (scsiObj->commandHead + 1) % USB_HOST_SCSI_BLOCK_COMMANDS_NUMBER;
+            scsiObj->commandCount --;
             scsiObj->transferTaskState = USB_HOST_SCSI_TRANSFER_STATE_IDLE;
         }    
     }
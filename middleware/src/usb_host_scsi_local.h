@@ -51,6 +51,7 @@
 #include "configuration.h"
 #include "usb/usb_host_scsi.h"
 #include "system/time/sys_time.h"
+#include "osal/osal.h"
 
 /* If the USB_HOST_SCSI_FILE_SYSTEM_REGISTER constant is defined and is set to
  * to false, then the any instance of the SCSI driver will not register with 
@@ -107,6 +108,32 @@
 #endif
 
 
+/* If the USB_HOST_SCSI_COMMAND_QUEUE_DEPTH constant is not defined, then the
+ * SCSI driver accepts one block request per LUN at a time. */
+
+#if !defined(USB_HOST_SCSI_COMMAND_QUEUE_DEPTH)
+    #define USB_HOST_SCSI_COMMAND_QUEUE_DEPTH 1
+#endif
+
+/* Defines the number of block commands (READ10 or WRITE10) per LUN that the
+ * SCSI driver can submit to the MSD Host Client driver. The first command is
+ * the command in progress. The second command is queued in the MSD Host Client
+ * driver and is started as soon as the first command has completed. */
+
+#define USB_HOST_SCSI_BLOCK_COMMANDS_NUMBER 2
+
+/* Defines the maximum number of sectors that a READ10 or WRITE10 command can
+ * transfer. Contiguous block requests are merged up to this limit unless the
+ * logical unit requires READ16 and WRITE16 commands. Larger requests are
+ * transferred with READ16 or WRITE16 commands. */
+
+#define USB_HOST_SCSI_BLOCK_COMMAND_SECTORS_MAX 0xFFFF
+
+/* Defines the maximum number of bytes that one block command can transfer.
+ * This is limited by the 32-bit data transfer length field of the CBW. */
+
+#define USB_HOST_SCSI_BLOCK_COMMAND_BYTES_MAX 0xFFFFFFFF
+
 /* Defines the number of times the SCSI driver will send the Test Unit Ready
  * command when a block command fails due to a unit not being ready. The device
  * must declare ready within these many times before the driver fails the block
@@ -165,6 +192,13 @@ typedef enum
     /* Wait for read capacity to complete */
     USB_HOST_SCSI_STATE_WAIT_READ_CAPACITY,
 
+    /* Send read capacity (16) command. This is needed when the number of
+     * blocks does not fit in the read capacity (10) response. */
+    USB_HOST_SCSI_STATE_READ_CAPACITY_16,
+
+    /* Wait for read capacity (16) to complete */
+    USB_HOST_SCSI_STATE_WAIT_READ_CAPACITY_16,
+
     /* Send mode sense command */
     USB_HOST_SCSI_STATE_MODE_SENSE,
 
@@ -284,6 +318,15 @@ typedef struct
     /* The direction of the transfer */
     USB_HOST_MSD_TRANSFER_DIRECTION direction;
 
+    /* The first sector to be transferred */
+    uint32_t startSector;
+
+    /* The length of the command in the CDB buffer */
+    uint8_t cdbLength;
+
+    /* The number of block requests that were merged into this block command */
+    size_t nRequests;
+
 } USB_HOST_SCSI_COMMAND_OBJ;
 
 /******************************************************
@@ -312,8 +355,29 @@ typedef struct
     /* The LUN Handle provided by MSD */
     USB_HOST_MSD_LUN_HANDLE lunHandle;
 
-    /* The command object used for block commands */
-    USB_HOST_SCSI_COMMAND_OBJ commandObj;
+    /* The block requests queued by the client. The command handle that is
+     * returned to the client is a pointer to the request. */
+    USB_HOST_SCSI_COMMAND_OBJ commandQueue[USB_HOST_SCSI_COMMAND_QUEUE_DEPTH];
+
+    /* Index of the oldest block request in the queue */
+    size_t queueHead;
+
+    /* Number of block requests in the queue */
+    size_t queueCount;
+
+    /* Number of block requests, starting from the oldest one, that are
+     * part of a submitted block command */
+    size_t queueSubmitted;
+
+    /* The command objects used for block commands. A block command transfers
+     * one or more contiguous block requests. */
+    USB_HOST_SCSI_COMMAND_OBJ commandObj[USB_HOST_SCSI_BLOCK_COMMANDS_NUMBER];
+
+    /* Index of the oldest submitted block command */
+    size_t commandHead;
+
+    /* Number of submitted block commands */
+    size_t commandCount;
 
     /* The task command object used by the SCSI task */
     USB_HOST_SCSI_COMMAND_OBJ taskCommandObj;
@@ -328,6 +392,16 @@ typedef struct
     /* Media region table */
     SYS_FS_MEDIA_REGION_GEOMETRY mediaRegionGeometry[3];
 
+    /* Size of a logical block in bytes */
+    uint32_t blockSize;
+
+    /* Maximum number of blocks that one block command can transfer */
+    uint32_t blockCommandSectorsMax;
+
+    /* True if the logical unit has completed the read capacity (16) command
+     * and is accessed with READ16 and WRITE16 commands */
+    bool useLongCommands;
+
     /* Event Handler */
     USB_HOST_SCSI_EVENT_HANDLER eventHandler;
 
@@ -368,6 +442,8 @@ typedef struct
 #define    USB_HOST_SCSI_READ10_COMMAND        0x28  // Read
 #define    USB_HOST_SCSI_WRITE6_COMMAND        0x0A  // write
 #define    USB_HOST_SCSI_WRITE10_COMMAND        0x2A  // write
+#define    USB_HOST_SCSI_READ16_COMMAND         0x88  // Read
+#define    USB_HOST_SCSI_WRITE16_COMMAND        0x8A  // write
 #define    USB_HOST_SCSI_SEEK6_COMMAND          0x0B  // track access
 #define    USB_HOST_SCSI_SEEK10_COMMAND         0x2B  // track access
 
@@ -518,6 +594,54 @@ int _USB_HOST_SCSI_LUNHandleToSCSIInstance
 
 void _USB_HOST_SCSI_ReadCapacityCommand (uint8_t * scsiCommand );
 
+// ******************************************************************************
+/* Function:
+    void _USB_HOST_SCSI_ReadCapacity16Command
+    (
+        uint8_t * scsiCommand
+    )
+
+  Summary:
+    Sets up the Read Capacity (16) Command.
+
+  Description:
+    This function sets up the Read Capacity (16) Command.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+void _USB_HOST_SCSI_ReadCapacity16Command (uint8_t * scsiCommand );
+
+// ******************************************************************************
+/* Function:
+    void _USB_HOST_SCSI_MediaGeometrySet
+    (
+        USB_HOST_SCSI_INSTANCE_OBJ * scsiObj,
+        uint32_t blockSize,
+        uint32_t numBlocks
+    )
+
+  Summary:
+    Updates the media geometry of the logical unit.
+
+  Description:
+    This function updates the media geometry that is reported to the file
+    system and the block size limits used for block commands.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+void _USB_HOST_SCSI_MediaGeometrySet
+(
+    USB_HOST_SCSI_INSTANCE_OBJ * scsiObj,
+    uint32_t blockSize,
+    uint32_t numBlocks
+);
+
 // ******************************************************************************
 /* Function:
     void _USB_HOST_SCSI_RequestSenseCommand 
@@ -569,6 +693,63 @@ void _USB_HOST_SCSI_BlockTransferCallback
     uintptr_t context
 );
 
+// ******************************************************************************
+/* Function:
+    USB_HOST_MSD_RESULT _USB_HOST_SCSI_BlockCommandSchedule
+    (
+        USB_HOST_SCSI_INSTANCE_OBJ * scsiObj
+    );
+
+  Summary:
+    This function submits queued block requests to the MSD Host Client driver.
+
+  Description:
+    This function builds a READ10 or WRITE10 command from the oldest block
+    requests that have not been submitted yet and submits it to the MSD Host
+    Client driver. Contiguous requests are merged into one command. Up to
+    USB_HOST_SCSI_BLOCK_COMMANDS_NUMBER commands can be submitted at a time. The
+    function returns the result of the last submission attempt.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+USB_HOST_MSD_RESULT _USB_HOST_SCSI_BlockCommandSchedule
+(
+    USB_HOST_SCSI_INSTANCE_OBJ * scsiObj
+);
+
+// ******************************************************************************
+/* Function:
+    void _USB_HOST_SCSI_BlockRequestsComplete
+    (
+        USB_HOST_SCSI_INSTANCE_OBJ * scsiObj,
+        size_t nRequests,
+        USB_HOST_MSD_RESULT result,
+        SYS_MEDIA_BLOCK_EVENT event
+    );
+
+  Summary:
+    This function completes the oldest block requests in the queue.
+
+  Description:
+    This function generates the specified event for the oldest nRequests block
+    requests in the queue and removes them from the queue.
+
+  Remarks:
+    This is a local function and should not be called directly by the
+    application.
+*/
+
+void _USB_HOST_SCSI_BlockRequestsComplete
+(
+    USB_HOST_SCSI_INSTANCE_OBJ * scsiObj,
+    size_t nRequests,
+    USB_HOST_MSD_RESULT result,
+    SYS_MEDIA_BLOCK_EVENT event
+);
+
 // ******************************************************************************
 /* Function:
     void _USB_HOST_SCSI_DetachDetectTasks(int scsiObjIndex);
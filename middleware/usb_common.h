@@ -192,7 +192,18 @@ typedef enum
      * is more than endpoint size but not a multiple, only
      * endpoint multiple size of data is sent.*/
 
-    USB_DEVICE_IRP_FLAG_DATA_PENDING = 0x2
+    USB_DEVICE_IRP_FLAG_DATA_PENDING = 0x2,
+
+    /* This flag can be combined with the other flags. It indicates that the
+     * data member of the IRP points to an array of USB_IRP_DATA_SEGMENT
+     * elements instead of a data buffer. The size member of the IRP is the
+     * total size of the transfer. The segments are used in array order until
+     * size bytes are transferred. This flag can only be specified if the USB
+     * driver reports the DRV_USB_CAPABILITY_IRP_DATA_SEGMENTS capability or
+     * if the Device Layer bounce buffers are enabled with
+     * USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER. It is not supported on endpoint
+     * 0. */
+    USB_DEVICE_IRP_FLAG_DATA_SEGMENTS = 0x4
 
 } USB_DEVICE_IRP_FLAG;
 
@@ -233,6 +244,35 @@ typedef enum
 
 } USB_HOST_IRP_FLAG;
 
+// *****************************************************************************
+/* USB IRP Data Segment
+
+  Summary:
+    Describes one segment of the data of an IRP.
+
+  Description:
+    This structure describes one segment of the data of an IRP. An IRP that is
+    submitted with the USB_DEVICE_IRP_FLAG_DATA_SEGMENTS flag points to an
+    array of segments instead of one data buffer. This allows a client to send
+    a header and a payload that are stored in different buffers, or to receive
+    data into different buffers, without copying the data into a contiguous
+    buffer and without splitting the transfer into several IRPs.
+
+  Remarks:
+    The segment array and the segment buffers must not be changed until the
+    IRP has completed.
+*/
+
+typedef struct
+{
+    /* Pointer to the data of this segment */
+    void * data;
+
+    /* Size of this segment in bytes */
+    unsigned int size;
+
+} USB_IRP_DATA_SEGMENT;
+
 // *****************************************************************************
 /* USB Endpoint and Direction Type
 
@@ -307,6 +347,10 @@ typedef struct _USB_DEVICE_IRP
      ***********************************/
     uint32_t privateData[3];
 
+    /* Tracking data of the Device Layer while the IRP is pending. The
+     * controller drivers use privateData. */
+    void * layerData;
+
 } USB_DEVICE_IRP;
 
 // *****************************************************************************
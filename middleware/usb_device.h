@@ -1015,7 +1015,9 @@ typedef struct
        Read requests in the queue. Each Endpoint Write queue element would 
        consume 36 Bytes of RAM. Value of this field should be at least 1. This 
        is applicable only for applications using Endpoint Read/Write functions 
-       like USB Vendor Device.  */
+       like USB Vendor Device. The sum of the Endpoint Read and Write queue
+       sizes of all device layer instances should not exceed
+       USB_DEVICE_ENDPOINT_QUEUE_DEPTH_COMBINED. */
     uint16_t queueSizeEndpointWrite;
 
     /* System Module Index of the driver that this device layer should open */
@@ -1174,6 +1176,77 @@ typedef struct
 
 } USB_DEVICE_EVENT_DATA_SOF;
 
+// *****************************************************************************
+/* USB Device Endpoint Statistics Latency Buckets
+
+  Summary:
+    Number of buckets in the endpoint statistics latency histogram.
+
+  Description:
+    This constant defines the number of buckets in the latency histogram of
+    the USB_DEVICE_ENDPOINT_STATISTICS data type. Bucket 0 counts IRPs that
+    completed in the frame in which they were submitted. Bucket n counts IRPs
+    whose latency was at least 2^(n-1) and less than 2^n frames. The last
+    bucket also counts all longer latencies.
+
+  Remarks:
+    None.
+*/
+
+#define USB_DEVICE_ENDPOINT_STATISTICS_LATENCY_BUCKETS  16
+
+// *****************************************************************************
+/* USB Device Endpoint Statistics Data Type
+
+  Summary:
+    Transfer statistics of one endpoint direction.
+
+  Description:
+    This data type contains the transfer statistics that the Device Layer
+    collects for one direction of an endpoint, when the
+    USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER configuration constant is
+    specified. The statistics cover all IRPs that the function drivers and the
+    endpoint read and write functions submit on the endpoint. The data type is
+    also the format of the data stage of the statistics vendor request. All
+    members are little endian on the supported microcontrollers.
+
+  Remarks:
+    Latency is measured in USB frames unless the
+    USB_DEVICE_STATISTICS_TIMESTAMP_GET configuration macro is specified.
+*/
+
+typedef struct
+{
+    /* Number of bytes transferred by completed IRPs */
+    uint32_t bytes;
+
+    /* Number of IRPs that were submitted successfully */
+    uint32_t irps;
+
+    /* Number of IRPs that completed with an error status */
+    uint32_t errors;
+
+    /* Number of IRPs that were aborted or terminated */
+    uint32_t aborts;
+
+    /* Number of times the endpoint was stalled by the device */
+    uint32_t stalls;
+
+    /* Number of IRPs that could not be tracked because the IRP tracking table
+     * was full. Bytes and latency of these IRPs are not recorded. */
+    uint32_t untracked;
+
+    /* Number of tracked IRPs that are pending on the endpoint */
+    uint16_t pending;
+
+    /* Highest number of tracked IRPs that were pending on the endpoint */
+    uint16_t pendingHighWaterMark;
+
+    /* log2 histogram of the IRP latencies */
+    uint32_t latency[USB_DEVICE_ENDPOINT_STATISTICS_LATENCY_BUCKETS];
+
+} USB_DEVICE_ENDPOINT_STATISTICS;
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: USB Device Layer System Interface Routines
@@ -3491,6 +3564,130 @@ USB_DEVICE_RESULT USB_DEVICE_EndpointTransferCancel
     USB_DEVICE_TRANSFER_HANDLE transferHandle
 );
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: Endpoint Statistics Routines
+// *****************************************************************************
+// *****************************************************************************
+
+//******************************************************************************
+/* Function:
+    USB_ERROR USB_DEVICE_EndpointStatisticsGet
+    (
+        USB_DEVICE_HANDLE usbDeviceHandle,
+        USB_ENDPOINT_ADDRESS endpoint,
+        USB_DEVICE_ENDPOINT_STATISTICS * statistics
+    );
+ 
+  Summary:
+    This function returns the transfer statistics of an endpoint.
+
+  Description:
+    This function copies the transfer statistics that the Device Layer has
+    collected for the specified endpoint and direction to the statistics
+    object. The statistics are collected from the time the Device Layer was
+    initialized or the statistics were last cleared. The copy is made in a
+    critical section and is consistent.
+
+  Precondition:
+    The USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER configuration constant must be
+    specified.
+
+  Parameters:
+    usbDeviceHandle - USB Device Layer Handle.
+
+    endpoint        - Endpoint address (number and direction).
+
+    statistics      - Pointer to the object where the statistics should be
+                      copied.
+    
+  Returns:
+    USB_ERROR_NONE              - The statistics were copied.
+
+    USB_ERROR_PARAMETER_INVALID - The handle or the statistics pointer is not
+                                  valid, or the endpoint number is not less
+                                  than USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER.
+
+  Example:
+    <code>
+
+    // The following code example reads the statistics of endpoint 1, IN
+    // direction.
+
+    USB_DEVICE_ENDPOINT_STATISTICS statistics;
+
+    if(USB_DEVICE_EndpointStatisticsGet(usbDeviceHandle, 
+                (0x1|USB_EP_DIRECTION_IN), &statistics) == USB_ERROR_NONE)
+    {
+        // statistics.bytes contains the number of bytes sent to the host.
+    }
+    
+    </code>
+
+  Remarks:
+    None.
+*/
+
+USB_ERROR USB_DEVICE_EndpointStatisticsGet
+(
+    USB_DEVICE_HANDLE usbDeviceHandle,
+    USB_ENDPOINT_ADDRESS endpoint,
+    USB_DEVICE_ENDPOINT_STATISTICS * statistics
+);
+
+//******************************************************************************
+/* Function:
+    USB_ERROR USB_DEVICE_EndpointStatisticsClear
+    (
+        USB_DEVICE_HANDLE usbDeviceHandle,
+        USB_ENDPOINT_ADDRESS endpoint
+    );
+ 
+  Summary:
+    This function clears the transfer statistics of an endpoint.
+
+  Description:
+    This function clears the transfer statistics of the specified endpoint and
+    direction. The number of pending IRPs is not cleared, as these IRPs are
+    still tracked. The high water mark is set to the number of pending IRPs.
+
+  Precondition:
+    The USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER configuration constant must be
+    specified.
+
+  Parameters:
+    usbDeviceHandle - USB Device Layer Handle.
+
+    endpoint        - Endpoint address (number and direction).
+    
+  Returns:
+    USB_ERROR_NONE              - The statistics were cleared.
+
+    USB_ERROR_PARAMETER_INVALID - The handle is not valid or the endpoint
+                                  number is not less than
+                                  USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER.
+
+  Example:
+    <code>
+
+    // The following code example clears the statistics of endpoint 1, OUT
+    // direction.
+
+    USB_DEVICE_EndpointStatisticsClear(usbDeviceHandle, 
+                (0x1|USB_EP_DIRECTION_OUT));
+    
+    </code>
+
+  Remarks:
+    None.
+*/
+
+USB_ERROR USB_DEVICE_EndpointStatisticsClear
+(
+    USB_DEVICE_HANDLE usbDeviceHandle,
+    USB_ENDPOINT_ADDRESS endpoint
+);
+
 
 //DOM-IGNORE-BEGIN
 #ifdef __cplusplus
@@ -676,6 +676,78 @@ typedef struct
 
 } USB_DEVICE_AUDIO_V2_EVENT_DATA_SET_ALTERNATE_INTERFACE;
 
+#if defined(USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER)
+// *****************************************************************************
+/* USB Device Audio v2.0 Function Driver Stream Configuration.
+
+  Summary:
+    USB Device Audio v2.0 Function Driver stream configuration.
+
+  Description:
+    This data type defines the configuration of an isochronous stream that is
+    passed to the USB_DEVICE_AUDIO_V2_StreamStart function.
+
+  Remarks:
+    None.
+*/
+
+typedef struct
+{
+    /* Ring owned by the application. In case of PIC32MZ device, the ring
+     * should be located in coherent memory and aligned at a 16 byte
+     * boundary. */
+    void * buffer;
+
+    /* Size of the ring in bytes */
+    size_t bufferSize;
+
+    /* Sample rate of the stream in Hz */
+    uint32_t sampleRate;
+
+    /* Size of an audio frame in bytes. This is the number of channels times
+     * the subslot size. */
+    size_t frameSize;
+
+} USB_DEVICE_AUDIO_V2_STREAM_CONFIG;
+
+// *****************************************************************************
+/* USB Device Audio v2.0 Function Driver Stream Statistics.
+
+  Summary:
+    USB Device Audio v2.0 Function Driver stream statistics.
+
+  Description:
+    This data type defines the statistics of an isochronous stream that are
+    returned by the USB_DEVICE_AUDIO_V2_StreamStatisticsGet function. The
+    counters are cleared when the stream is started.
+
+  Remarks:
+    None.
+*/
+
+typedef struct
+{
+    /* Number of packets received or sent */
+    uint32_t packets;
+
+    /* Number of times the application found no received data (OUT
+     * endpoint) or the stream had no data to send (IN endpoint) */
+    uint32_t underruns;
+
+    /* Number of times the ring was full. Received packets are lost (OUT
+     * endpoint) or the application found no space to write (IN endpoint). */
+    uint32_t overruns;
+
+    /* Last value sent on the feedback endpoint. This is in 16.16 format at
+     * high speed and in 10.14 format at full speed. */
+    uint32_t feedback;
+
+    /* Current ring level in bytes */
+    size_t level;
+
+} USB_DEVICE_AUDIO_V2_STREAM_STATISTICS;
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: USB Device Audio v2.0 Interface Function Definitions
@@ -1050,6 +1122,442 @@ USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_TransferCancel
     USB_DEVICE_AUDIO_V2_TRANSFER_HANDLE transferHandle
 );
 
+#if defined(USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER)
+//******************************************************************************
+/* Function:
+    USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamStart
+    (
+        USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+        uint8_t interfaceNumber,
+        const USB_DEVICE_AUDIO_V2_STREAM_CONFIG * config
+    );
+
+  Summary:
+    Starts the isochronous stream of an audio streaming interface.
+
+  Description:
+    This function starts the isochronous stream of the specified audio
+    streaming interface. The stream moves the audio data between the
+    isochronous data endpoint of the active alternate setting and a ring
+    owned by the application, with no read or write requests and no events.
+    It keeps USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER packet transfers in
+    flight.
+
+    If the data endpoint is an OUT endpoint, the ring is split into one slot
+    per packet. Received packets are read in place with
+    USB_DEVICE_AUDIO_V2_StreamReadAcquire() and
+    USB_DEVICE_AUDIO_V2_StreamReadCommit(). If the alternate setting has an
+    explicit feedback endpoint, the stream sends the rate at which the
+    application consumes audio frames, measured against the SOF frame number
+    and corrected by the ring level, so that the ring stays half full.
+
+    If the data endpoint is an IN endpoint, the application writes audio
+    frames in place with USB_DEVICE_AUDIO_V2_StreamWriteAcquire() and
+    USB_DEVICE_AUDIO_V2_StreamWriteCommit(). The packets follow the sample
+    rate and carry one audio frame more or less to keep the ring half full.
+
+    In both directions, no data is returned or sent until the ring has been
+    filled to half of its size, and again after an underrun.
+
+    The stream stops when the host changes the alternate setting of the
+    interface or when the device is deconfigured. The application must
+    start it again once the interface setting has changed.
+
+  Precondition:
+    The host should have selected a non zero alternate setting of the
+    interface.
+
+  Parameters:
+    instanceIndex   - USB Device Audio v2.0 Function Driver instance.
+    interfaceNumber - Audio streaming interface number.
+    config          - Pointer to the stream configuration.
+
+  Returns:
+    - USB_DEVICE_AUDIO_V2_RESULT_OK - The stream was started or is already
+      running.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_PARAMETER_INVALID - The ring is too
+      small for the sample rate and the number of packets, or a packet of
+      the sample rate does not fit in the data endpoint.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_TRANSFER_QUEUE_FULL - IRPs of the
+      last stream have not been returned by the driver yet.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_INSTANCE_NOT_CONFIGURED - The interface
+      is in alternate setting 0.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_INVALID_INTERFACE_ID - The interface
+      number is not valid.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_INSTANCE_INVALID - The specified
+      instance was not provisioned in the application and is invalid.
+
+  Example:
+    <code>
+    // Starts a 24 bit stereo stream at 192 kHz when the host selects
+    // alternate setting 1 of the speaker interface.
+
+    uint8_t speakerRing[4096] __attribute__((coherent, aligned(16)));
+    USB_DEVICE_AUDIO_V2_STREAM_CONFIG streamConfig;
+
+    case USB_DEVICE_AUDIO_V2_EVENT_INTERFACE_SETTING_CHANGED:
+
+        interfaceInfo = (USB_DEVICE_AUDIO_V2_EVENT_DATA_SET_ALTERNATE_INTERFACE *)pData;
+        if(interfaceInfo->interfaceAlternateSetting == 1)
+        {
+            streamConfig.buffer = speakerRing;
+            streamConfig.bufferSize = sizeof(speakerRing);
+            streamConfig.sampleRate = 192000;
+            streamConfig.frameSize = 2 * 4;
+
+            USB_DEVICE_AUDIO_V2_StreamStart(appData.audioInstance,
+                    interfaceInfo->interfaceNumber, &streamConfig);
+        }
+        break;
+    </code>
+
+  Remarks:
+    USB_DEVICE_AUDIO_V2_Read() and USB_DEVICE_AUDIO_V2_Write() should not be
+    used on an interface while its stream is started. A ring of at least
+    four packets per packet in flight is recommended.
+*/
+
+USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamStart
+(
+    USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+    uint8_t interfaceNumber,
+    const USB_DEVICE_AUDIO_V2_STREAM_CONFIG * config
+);
+
+//******************************************************************************
+/* Function:
+    USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamStop
+    (
+        USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+        uint8_t interfaceNumber
+    );
+
+  Summary:
+    Stops the isochronous stream of an audio streaming interface.
+
+  Description:
+    This function stops the isochronous stream of the specified audio
+    streaming interface and cancels its transfers. The application can use
+    the ring once the function has returned.
+
+  Precondition:
+    None.
+
+  Parameters:
+    instanceIndex   - USB Device Audio v2.0 Function Driver instance.
+    interfaceNumber - Audio streaming interface number.
+
+  Returns:
+    - USB_DEVICE_AUDIO_V2_RESULT_OK - The stream was stopped.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_INVALID_INTERFACE_ID - The interface
+      number is not valid.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_INSTANCE_INVALID - The specified
+      instance was not provisioned in the application and is invalid.
+
+  Example:
+    <code>
+    USB_DEVICE_AUDIO_V2_StreamStop(appData.audioInstance, 1);
+    </code>
+
+  Remarks:
+    None.
+*/
+
+USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamStop
+(
+    USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+    uint8_t interfaceNumber
+);
+
+//******************************************************************************
+/* Function:
+    size_t USB_DEVICE_AUDIO_V2_StreamReadAcquire
+    (
+        USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+        uint8_t interfaceNumber,
+        void ** data
+    );
+
+  Summary:
+    Returns received audio data that the application can read in place.
+
+  Description:
+    This function returns, in the data parameter, a pointer to the oldest
+    received audio data of the stream of an OUT data endpoint. The return
+    value is the number of bytes available at that pointer. The data stays
+    valid until it is released with USB_DEVICE_AUDIO_V2_StreamReadCommit().
+
+    The function returns 0 until the ring has been filled to half of its
+    size. If no data is available after that, the function counts an
+    underrun and waits for the ring to be half full again.
+
+  Precondition:
+    The stream should have been started with USB_DEVICE_AUDIO_V2_StreamStart().
+
+  Parameters:
+    instanceIndex   - USB Device Audio v2.0 Function Driver instance.
+    interfaceNumber - Audio streaming interface number.
+    data            - Pointer to a variable that receives the data pointer.
+
+  Returns:
+    Number of bytes available at the returned pointer. 0 if no data is
+    available or if the stream is not started.
+
+  Example:
+    <code>
+    // Called by the application when its audio output needs more samples,
+    // at the rate of the audio clock.
+
+    void * data;
+    size_t length;
+
+    length = USB_DEVICE_AUDIO_V2_StreamReadAcquire(appData.audioInstance,
+            1, &data);
+    if(length > 0)
+    {
+        length = APP_CodecWrite(data, length);
+        USB_DEVICE_AUDIO_V2_StreamReadCommit(appData.audioInstance,
+                1, length);
+    }
+    else
+    {
+        APP_CodecWriteSilence();
+    }
+    </code>
+
+  Remarks:
+    The data of a packet is never contiguous with the data of the next packet.
+    Call the function again after a commit to get the next data. The feedback
+    value follows the rate at which data is committed, so the application
+    should consume the data at the rate of its audio clock.
+*/
+
+size_t USB_DEVICE_AUDIO_V2_StreamReadAcquire
+(
+    USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+    uint8_t interfaceNumber,
+    void ** data
+);
+
+//******************************************************************************
+/* Function:
+    USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamReadCommit
+    (
+        USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+        uint8_t interfaceNumber,
+        size_t size
+    );
+
+  Summary:
+    Releases received audio data that the application has consumed.
+
+  Description:
+    This function releases the first size bytes of the data returned by
+    USB_DEVICE_AUDIO_V2_StreamReadAcquire(). A ring slot is armed again as
+    soon as all of its data has been released.
+
+  Precondition:
+    The stream should have been started with USB_DEVICE_AUDIO_V2_StreamStart().
+
+  Parameters:
+    instanceIndex   - USB Device Audio v2.0 Function Driver instance.
+    interfaceNumber - Audio streaming interface number.
+    size            - Number of bytes consumed by the application.
+
+  Returns:
+    - USB_DEVICE_AUDIO_V2_RESULT_OK - The data was released.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_PARAMETER_INVALID - size is larger
+      than the number of bytes returned by
+      USB_DEVICE_AUDIO_V2_StreamReadAcquire().
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_INVALID_INTERFACE_ID - The interface
+      number is not valid.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_INSTANCE_INVALID - The specified
+      instance was not provisioned in the application and is invalid.
+
+  Example:
+    <code>
+    // Refer to the example of USB_DEVICE_AUDIO_V2_StreamReadAcquire().
+    </code>
+
+  Remarks:
+    None.
+*/
+
+USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamReadCommit
+(
+    USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+    uint8_t interfaceNumber,
+    size_t size
+);
+
+//******************************************************************************
+/* Function:
+    size_t USB_DEVICE_AUDIO_V2_StreamWriteAcquire
+    (
+        USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+        uint8_t interfaceNumber,
+        void ** data
+    );
+
+  Summary:
+    Returns free ring space that the application can write in place.
+
+  Description:
+    This function returns, in the data parameter, a pointer to the free space
+    of the ring of the stream of an IN data endpoint. The return value is the
+    number of contiguous bytes that can be written at that pointer. If the
+    ring is full, the function counts an overrun.
+
+  Precondition:
+    The stream should have been started with USB_DEVICE_AUDIO_V2_StreamStart().
+
+  Parameters:
+    instanceIndex   - USB Device Audio v2.0 Function Driver instance.
+    interfaceNumber - Audio streaming interface number.
+    data            - Pointer to a variable that receives the data pointer.
+
+  Returns:
+    Number of bytes that can be written at the returned pointer. 0 if the
+    ring is full or if the stream is not started.
+
+  Example:
+    <code>
+    // Called by the application when its audio input has new samples.
+
+    void * data;
+    size_t length;
+
+    length = USB_DEVICE_AUDIO_V2_StreamWriteAcquire(appData.audioInstance,
+            2, &data);
+    length = APP_CodecRead(data, length);
+    USB_DEVICE_AUDIO_V2_StreamWriteCommit(appData.audioInstance,
+            2, length);
+    </code>
+
+  Remarks:
+    None.
+*/
+
+size_t USB_DEVICE_AUDIO_V2_StreamWriteAcquire
+(
+    USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+    uint8_t interfaceNumber,
+    void ** data
+);
+
+//******************************************************************************
+/* Function:
+    USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamWriteCommit
+    (
+        USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+        uint8_t interfaceNumber,
+        size_t size
+    );
+
+  Summary:
+    Queues audio data written to the ring for transmission.
+
+  Description:
+    This function queues size bytes written at the pointer returned by
+    USB_DEVICE_AUDIO_V2_StreamWriteAcquire() for transmission to the host.
+    The size must be a multiple of the audio frame size.
+
+  Precondition:
+    The stream should have been started with USB_DEVICE_AUDIO_V2_StreamStart().
+
+  Parameters:
+    instanceIndex   - USB Device Audio v2.0 Function Driver instance.
+    interfaceNumber - Audio streaming interface number.
+    size            - Number of bytes written by the application.
+
+  Returns:
+    - USB_DEVICE_AUDIO_V2_RESULT_OK - The data was queued.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_PARAMETER_INVALID - size is larger
+      than the number of bytes returned by
+      USB_DEVICE_AUDIO_V2_StreamWriteAcquire() or is not a multiple of the
+      audio frame size.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_INSTANCE_NOT_CONFIGURED - The stream
+      is not started.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_INVALID_INTERFACE_ID - The interface
+      number is not valid.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_INSTANCE_INVALID - The specified
+      instance was not provisioned in the application and is invalid.
+
+  Example:
+    <code>
+    // Refer to the example of USB_DEVICE_AUDIO_V2_StreamWriteAcquire().
+    </code>
+
+  Remarks:
+    None.
+*/
+
+USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamWriteCommit
+(
+    USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+    uint8_t interfaceNumber,
+    size_t size
+);
+
+//******************************************************************************
+/* Function:
+    USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamStatisticsGet
+    (
+        USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+        uint8_t interfaceNumber,
+        USB_DEVICE_AUDIO_V2_STREAM_STATISTICS * statistics
+    );
+
+  Summary:
+    Returns the statistics of the isochronous stream of an audio streaming
+    interface.
+
+  Description:
+    This function returns the packet, underrun and overrun counts, the last
+    feedback value and the ring level of the stream of the specified audio
+    streaming interface.
+
+  Precondition:
+    None.
+
+  Parameters:
+    instanceIndex   - USB Device Audio v2.0 Function Driver instance.
+    interfaceNumber - Audio streaming interface number.
+    statistics      - Pointer to the structure that receives the statistics.
+
+  Returns:
+    - USB_DEVICE_AUDIO_V2_RESULT_OK - The statistics were returned.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_PARAMETER_INVALID - statistics is NULL.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_INVALID_INTERFACE_ID - The interface
+      number is not valid.
+    - USB_DEVICE_AUDIO_V2_RESULT_ERROR_INSTANCE_INVALID - The specified
+      instance was not provisioned in the application and is invalid.
+
+  Example:
+    <code>
+    USB_DEVICE_AUDIO_V2_STREAM_STATISTICS statistics;
+
+    USB_DEVICE_AUDIO_V2_StreamStatisticsGet(appData.audioInstance, 1,
+            &statistics);
+    if(statistics.underruns != appData.underruns)
+    {
+        // The audio output played silence since the last check
+        appData.underruns = statistics.underruns;
+    }
+    </code>
+
+  Remarks:
+    None.
+*/
+
+USB_DEVICE_AUDIO_V2_RESULT USB_DEVICE_AUDIO_V2_StreamStatisticsGet
+(
+    USB_DEVICE_AUDIO_V2_INDEX instanceIndex,
+    uint8_t interfaceNumber,
+    USB_DEVICE_AUDIO_V2_STREAM_STATISTICS * statistics
+);
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Global Data Types. This section is specific to PIC32 implementation
@@ -1347,6 +1347,286 @@ USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_SerialStateNotificationSend
     USB_CDC_SERIAL_STATE * notificationData
 );
 
+#if defined(USB_DEVICE_CDC_STREAM_BUFFER_SIZE)
+// *****************************************************************************
+/* Function:
+    USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_StreamStart
+    (
+        USB_DEVICE_CDC_INDEX instanceIndex
+    );
+
+  Summary:
+    Starts the streaming mode of a CDC instance.
+
+  Description:
+    This function starts the streaming mode of the specified CDC instance. In
+    streaming mode, the CDC function driver owns a receive ring and a transmit
+    ring of USB_DEVICE_CDC_STREAM_BUFFER_SIZE bytes each. The receive ring is
+    split into USB_DEVICE_CDC_STREAM_IRPS_NUMBER slots that are kept armed on
+    the bulk OUT endpoint. The application reads and writes the rings in place
+    through the USB_DEVICE_CDC_StreamReadAcquire(),
+    USB_DEVICE_CDC_StreamReadCommit(), USB_DEVICE_CDC_StreamWriteAcquire() and
+    USB_DEVICE_CDC_StreamWriteCommit() functions. No read or write complete
+    events are generated for stream data.
+
+    The function empties both rings. The stream stops when the device is
+    deconfigured or when a stream transfer is aborted. The acquire functions
+    then return 0 and the application must start the stream again.
+
+  Precondition:
+    The function driver should have been configured.
+
+  Parameters:
+    instance        - USB Device CDC Function Driver instance.
+
+  Returns:
+    USB_DEVICE_CDC_RESULT_OK - The stream was started or is already running.
+
+    USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_SIZE_INVALID - The receive ring slot
+    size is not a multiple of the bulk OUT endpoint size.
+
+    USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_QUEUE_FULL - Transmit IRPs of the
+    last stream have not been returned by the driver yet.
+
+    USB_DEVICE_CDC_RESULT_ERROR_INSTANCE_NOT_CONFIGURED - The specified 
+    instance is not configured yet.
+
+    USB_DEVICE_CDC_RESULT_ERROR_INSTANCE_INVALID - The specified instance
+    was not provisioned in the application and is invalid.
+
+  Example:
+    <code>
+    // Start the stream after the device has been configured.
+
+    case USB_DEVICE_EVENT_CONFIGURED:
+
+        USB_DEVICE_CDC_EventHandlerSet(USB_DEVICE_CDC_INDEX_0,
+                APP_USBDeviceCDCEventHandler, (uintptr_t)&appData);
+        USB_DEVICE_CDC_StreamStart(USB_DEVICE_CDC_INDEX_0);
+        break;
+    </code>
+
+  Remarks:
+    USB_DEVICE_CDC_Read() and USB_DEVICE_CDC_Write() should not be used on an
+    instance while its stream is started.
+*/
+
+USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_StreamStart
+(
+    USB_DEVICE_CDC_INDEX instanceIndex
+);
+
+// *****************************************************************************
+/* Function:
+    size_t USB_DEVICE_CDC_StreamReadAcquire
+    (
+        USB_DEVICE_CDC_INDEX instanceIndex,
+        void ** data
+    );
+
+  Summary:
+    Returns the received data that the application can read in place.
+
+  Description:
+    This function returns, in the data parameter, a pointer to the oldest
+    received data in the receive ring. The return value is the number of
+    contiguous bytes available at that pointer. The data stays valid until it
+    is released with USB_DEVICE_CDC_StreamReadCommit().
+
+  Precondition:
+    The stream should have been started with USB_DEVICE_CDC_StreamStart().
+
+  Parameters:
+    instance        - USB Device CDC Function Driver instance.
+
+    data            - Pointer to a variable that receives the data pointer.
+
+  Returns:
+    Number of bytes available at the returned pointer. 0 if no data has been
+    received or if the stream is not started.
+
+  Example:
+    <code>
+    void * data;
+    size_t length;
+
+    length = USB_DEVICE_CDC_StreamReadAcquire(USB_DEVICE_CDC_INDEX_0, &data);
+    if(length > 0)
+    {
+        // Consume the data, for example by queuing it to a UART driver.
+        length = APP_UARTWrite(data, length);
+        USB_DEVICE_CDC_StreamReadCommit(USB_DEVICE_CDC_INDEX_0, length);
+    }
+    </code>
+
+  Remarks:
+    Data received in one slot is never contiguous with the data of the next
+    slot. Call the function again after a commit to get the next data.
+*/
+
+size_t USB_DEVICE_CDC_StreamReadAcquire
+(
+    USB_DEVICE_CDC_INDEX instanceIndex,
+    void ** data
+);
+
+// *****************************************************************************
+/* Function:
+    USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_StreamReadCommit
+    (
+        USB_DEVICE_CDC_INDEX instanceIndex,
+        size_t size
+    );
+
+  Summary:
+    Releases received data that the application has consumed.
+
+  Description:
+    This function releases the first size bytes of the data returned by
+    USB_DEVICE_CDC_StreamReadAcquire(). A receive ring slot is armed again on
+    the bulk OUT endpoint as soon as all of its data has been released.
+
+  Precondition:
+    The stream should have been started with USB_DEVICE_CDC_StreamStart().
+
+  Parameters:
+    instance        - USB Device CDC Function Driver instance.
+
+    size            - Number of bytes consumed by the application.
+
+  Returns:
+    USB_DEVICE_CDC_RESULT_OK - The data was released.
+
+    USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_SIZE_INVALID - size is larger than
+    the number of bytes returned by USB_DEVICE_CDC_StreamReadAcquire().
+
+    USB_DEVICE_CDC_RESULT_ERROR_INSTANCE_INVALID - The specified instance
+    was not provisioned in the application and is invalid.
+
+  Example:
+    <code>
+    // Refer to the example of USB_DEVICE_CDC_StreamReadAcquire().
+    </code>
+
+  Remarks:
+    None.
+*/
+
+USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_StreamReadCommit
+(
+    USB_DEVICE_CDC_INDEX instanceIndex,
+    size_t size
+);
+
+// *****************************************************************************
+/* Function:
+    size_t USB_DEVICE_CDC_StreamWriteAcquire
+    (
+        USB_DEVICE_CDC_INDEX instanceIndex,
+        void ** data
+    );
+
+  Summary:
+    Returns free transmit ring space that the application can write in place.
+
+  Description:
+    This function returns, in the data parameter, a pointer to free space in
+    the transmit ring. The return value is the number of contiguous bytes that
+    can be written at that pointer. The data is sent to the host after it has
+    been committed with USB_DEVICE_CDC_StreamWriteCommit().
+
+  Precondition:
+    The stream should have been started with USB_DEVICE_CDC_StreamStart().
+
+  Parameters:
+    instance        - USB Device CDC Function Driver instance.
+
+    data            - Pointer to a variable that receives the data pointer.
+
+  Returns:
+    Number of bytes that can be written at the returned pointer. 0 if the ring
+    is full or if the stream is not started.
+
+  Example:
+    <code>
+    void * data;
+    size_t length;
+
+    length = USB_DEVICE_CDC_StreamWriteAcquire(USB_DEVICE_CDC_INDEX_0, &data);
+    if(length > 0)
+    {
+        // Fill the ring, for example from a UART driver.
+        length = APP_UARTRead(data, length);
+        USB_DEVICE_CDC_StreamWriteCommit(USB_DEVICE_CDC_INDEX_0, length);
+    }
+    </code>
+
+  Remarks:
+    The free space wraps at the end of the ring. Call the function again after
+    a commit to get the free space at the start of the ring.
+*/
+
+size_t USB_DEVICE_CDC_StreamWriteAcquire
+(
+    USB_DEVICE_CDC_INDEX instanceIndex,
+    void ** data
+);
+
+// *****************************************************************************
+/* Function:
+    USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_StreamWriteCommit
+    (
+        USB_DEVICE_CDC_INDEX instanceIndex,
+        size_t size
+    );
+
+  Summary:
+    Queues data written to the transmit ring for transmission.
+
+  Description:
+    This function queues size bytes, written at the pointer returned by
+    USB_DEVICE_CDC_StreamWriteAcquire(), for transmission to the host. Up to
+    USB_DEVICE_CDC_STREAM_IRPS_NUMBER transfers are kept in flight on the bulk
+    IN endpoint. Committed data is sent in full packets while more committed
+    data follows it. The last committed data ends with a short packet, or with
+    a zero length packet if it fills a whole number of packets.
+
+  Precondition:
+    The stream should have been started with USB_DEVICE_CDC_StreamStart().
+
+  Parameters:
+    instance        - USB Device CDC Function Driver instance.
+
+    size            - Number of bytes written by the application.
+
+  Returns:
+    USB_DEVICE_CDC_RESULT_OK - The data was queued.
+
+    USB_DEVICE_CDC_RESULT_ERROR_TRANSFER_SIZE_INVALID - size is larger than
+    the number of bytes returned by USB_DEVICE_CDC_StreamWriteAcquire().
+
+    USB_DEVICE_CDC_RESULT_ERROR_INSTANCE_NOT_CONFIGURED - The stream is not
+    started.
+
+    USB_DEVICE_CDC_RESULT_ERROR_INSTANCE_INVALID - The specified instance
+    was not provisioned in the application and is invalid.
+
+  Example:
+    <code>
+    // Refer to the example of USB_DEVICE_CDC_StreamWriteAcquire().
+    </code>
+
+  Remarks:
+    None.
+*/
+
+USB_DEVICE_CDC_RESULT USB_DEVICE_CDC_StreamWriteCommit
+(
+    USB_DEVICE_CDC_INDEX instanceIndex,
+    size_t size
+);
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Global Data Types. This section is specific to PIC32 implementation
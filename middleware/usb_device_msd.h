@@ -279,6 +279,194 @@ typedef struct
 
 } USB_DEVICE_MSD_INIT;
 
+// *****************************************************************************
+/* USB Device MSD Write Cache Statistics
+
+  Summary:
+    Contains the write cache statistics of an MSD function driver instance.
+
+  Description:
+    This structure contains the write cache statistics of an MSD function
+    driver instance. The hit rate of the cache is hits / (hits + misses). The
+    counters are reset when the function driver is initialized by the Device
+    Layer.
+
+  Remarks:
+    The write cache is available only if the
+    USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER configuration constant is
+    specified.
+*/
+
+typedef struct
+{
+    /* Number of host writes that were merged into a block already in the
+     * cache */
+    uint32_t hits;
+
+    /* Number of host writes that required a media write block to be read
+     * into the cache */
+    uint32_t misses;
+
+    /* Number of modified blocks written back to the media to make room for
+     * another block */
+    uint32_t evictions;
+
+    /* Number of modified blocks written back to the media by a cache flush */
+    uint32_t flushes;
+
+} USB_DEVICE_MSD_WRITE_CACHE_STATISTICS;
+
+// *****************************************************************************
+/* USB Device MSD LUN Statistics
+
+  Summary:
+    Contains the statistics of a logical unit of an MSD function driver
+    instance.
+
+  Description:
+    This structure contains the command, sector and read ahead counters of a
+    logical unit (LUN). The application can find the throughput of a LUN by
+    sampling the sector counters at a known interval. The hit rate of the read
+    ahead is readAheadHits / (readAheadHits + readAheadMisses). The counters
+    are reset when the function driver is initialized by the Device Layer.
+
+  Remarks:
+    The statistics are available only if the
+    USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER configuration constant is
+    specified.
+*/
+
+typedef struct
+{
+    /* Number of READ (10) commands accepted from the host */
+    uint32_t readCommands;
+
+    /* Number of sectors requested by the READ (10) commands */
+    uint32_t sectorsRead;
+
+    /* Number of WRITE (10) commands accepted from the host */
+    uint32_t writeCommands;
+
+    /* Number of sectors requested by the WRITE (10) commands */
+    uint32_t sectorsWritten;
+
+    /* Number of READ (10) commands whose first sectors were sent from the
+     * read ahead buffer */
+    uint32_t readAheadHits;
+
+    /* Number of READ (10) commands that did not start at the sector that was
+     * read ahead */
+    uint32_t readAheadMisses;
+
+} USB_DEVICE_MSD_LUN_STATISTICS;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: MSD Function Driver Client Routines
+// *****************************************************************************
+// *****************************************************************************
+
+// *****************************************************************************
+/* Function:
+    void USB_DEVICE_MSD_WriteCacheStatisticsGet
+    (
+        SYS_MODULE_INDEX iMSD,
+        USB_DEVICE_MSD_WRITE_CACHE_STATISTICS * statistics
+    )
+
+  Summary:
+    Returns the write cache statistics of an MSD function driver instance.
+
+  Description:
+    This function copies the write cache statistics of the specified MSD
+    function driver instance to the statistics structure.
+
+  Precondition:
+    The USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER configuration constant must
+    be specified.
+
+  Parameters:
+    iMSD - MSD function driver instance index.
+
+    statistics - Pointer to the structure where the statistics should be
+    copied.
+
+  Returns:
+    None.
+
+  Example:
+    <code>
+    USB_DEVICE_MSD_WRITE_CACHE_STATISTICS statistics;
+
+    USB_DEVICE_MSD_WriteCacheStatisticsGet(0, &statistics);
+    </code>
+
+  Remarks:
+    None.
+*/
+
+void USB_DEVICE_MSD_WriteCacheStatisticsGet
+(
+    SYS_MODULE_INDEX iMSD,
+    USB_DEVICE_MSD_WRITE_CACHE_STATISTICS * statistics
+);
+
+// *****************************************************************************
+/* Function:
+    void USB_DEVICE_MSD_LUNStatisticsGet
+    (
+        SYS_MODULE_INDEX iMSD,
+        uint8_t logicalUnit,
+        USB_DEVICE_MSD_LUN_STATISTICS * statistics
+    )
+
+  Summary:
+    Returns the statistics of a logical unit of an MSD function driver
+    instance.
+
+  Description:
+    This function copies the statistics of the specified logical unit of the
+    specified MSD function driver instance to the statistics structure.
+
+  Precondition:
+    The USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER configuration constant must
+    be specified.
+
+  Parameters:
+    iMSD - MSD function driver instance index.
+
+    logicalUnit - Logical unit number. This must be less than the number of
+    logical units of the MSD function driver instance.
+
+    statistics - Pointer to the structure where the statistics should be
+    copied.
+
+  Returns:
+    None.
+
+  Example:
+    <code>
+    USB_DEVICE_MSD_LUN_STATISTICS statistics;
+    uint32_t sectorsRead;
+
+    // Find the number of sectors read from LUN 1 since the last call. The
+    // application calls this periodically to find the read throughput.
+    USB_DEVICE_MSD_LUNStatisticsGet(0, 1, &statistics);
+    sectorsRead = statistics.sectorsRead - appData.lastSectorsRead;
+    appData.lastSectorsRead = statistics.sectorsRead;
+    </code>
+
+  Remarks:
+    None.
+*/
+
+void USB_DEVICE_MSD_LUNStatisticsGet
+(
+    SYS_MODULE_INDEX iMSD,
+    uint8_t logicalUnit,
+    USB_DEVICE_MSD_LUN_STATISTICS * statistics
+);
+
 // *****************************************************************************
 /* USB Device MSD Function Driver Function Pointer
 
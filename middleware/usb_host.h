@@ -53,6 +53,7 @@
 #include "usb/usb_chapter_9.h"
 #include "usb/usb_common.h"
 #include "system/system_module.h"
+#include <stdbool.h>
 #include <stddef.h>
 
 // DOM-IGNORE-BEGIN
@@ -909,6 +910,173 @@ typedef enum
 
 } USB_HOST_RESULT;
 
+// *****************************************************************************
+/* USB Host Trace Event
+
+  Summary:
+    Identifies the type of a host layer trace record.
+
+  Description:
+    This enumeration identifies the type of a host layer trace record. The
+    values are the event type characters of the Linux usbmon interface.
+
+  Remarks:
+    None.
+*/
+
+typedef enum
+{
+    /* The IRP was submitted to the host controller driver */
+    USB_HOST_TRACE_EVENT_SUBMIT = 'S',
+
+    /* The IRP was completed by the host controller driver */
+    USB_HOST_TRACE_EVENT_COMPLETE = 'C',
+
+    /* The host controller driver did not accept the IRP */
+    USB_HOST_TRACE_EVENT_SUBMIT_ERROR = 'E'
+
+} USB_HOST_TRACE_EVENT;
+
+// *****************************************************************************
+/* USB Host Trace Record
+
+  Summary:
+    Describes one event in the host layer trace.
+
+  Description:
+    This data type describes one event in the host layer trace. The host layer
+    adds a record when it submits an IRP to the host controller driver and
+    when the IRP completes, if the USB_HOST_TRACE_RECORDS_NUMBER configuration
+    constant is specified. The records are read with the USB_HOST_TraceRead
+    function.
+
+  Remarks:
+    None.
+*/
+
+typedef struct
+{
+    /* SYS_TIME counter value at which the event occurred */
+    uint64_t timeStamp;
+
+    /* Identifies the IRP. The submit and completion records of an IRP have
+     * the same identifier. */
+    uint32_t id;
+
+    /* Size of the IRP data stage when submitted, number of bytes transferred
+     * when completed */
+    uint32_t length;
+
+    /* Setup packet of a control transfer. Valid if setupValid is true. */
+    uint8_t setup[8];
+
+    /* IRP status. This is USB_HOST_IRP_STATUS_IN_PROGRESS for a submit
+     * record. */
+    int8_t status;
+
+    /* Event type (USB_HOST_TRACE_EVENT) */
+    uint8_t event;
+
+    /* Transfer type of the pipe (USB_TRANSFER_TYPE) */
+    uint8_t transferType;
+
+    /* Index of the bus to which the device is attached */
+    uint8_t bus;
+
+    /* Address of the device */
+    uint8_t deviceAddress;
+
+    /* Endpoint number and direction */
+    uint8_t endpoint;
+
+    /* True if setup contains the setup packet */
+    bool setupValid;
+
+} USB_HOST_TRACE_RECORD;
+
+// *****************************************************************************
+/* USB Host Trace pcap Sizes
+
+  Summary:
+    Sizes of the pcap data that is created from trace records.
+
+  Description:
+    USB_HOST_TRACE_PCAP_HEADER_SIZE is the size of the pcap file header that
+    USB_HOST_TracePcapHeaderGet creates. USB_HOST_TRACE_PCAP_RECORD_SIZE is the
+    size of the pcap packet that USB_HOST_TracePcapRecordGet creates for one
+    trace record.
+
+  Remarks:
+    None.
+*/
+
+#define USB_HOST_TRACE_PCAP_HEADER_SIZE   24
+#define USB_HOST_TRACE_PCAP_RECORD_SIZE   80
+
+// *****************************************************************************
+/* USB Host Memory Pool Size Classes
+
+  Summary:
+    Identifies the size classes of the host layer memory pool.
+
+  Description:
+    The host layer memory pool has a small, a medium and a large size class of
+    fixed size blocks. The sizes and the number of blocks of each class are
+    defined by configuration constants.
+
+  Remarks:
+    None.
+*/
+
+typedef enum
+{
+    USB_HOST_MEMORY_POOL_CLASS_SMALL = 0,
+    USB_HOST_MEMORY_POOL_CLASS_MEDIUM,
+    USB_HOST_MEMORY_POOL_CLASS_LARGE,
+
+    /* Number of size classes */
+    USB_HOST_MEMORY_POOL_CLASSES_NUMBER
+
+} USB_HOST_MEMORY_POOL_CLASS;
+
+// *****************************************************************************
+/* USB Host Memory Pool Status
+
+  Summary:
+    Describes the use of the host layer memory pool.
+
+  Description:
+    This data type is returned by USB_HOST_MemoryPoolStatusGet. It describes
+    the use of the host layer memory pool by one bus or by all buses. The
+    memory pool is enabled by the USB_HOST_MEMORY_POOL_ENABLE configuration
+    constant.
+
+  Remarks:
+    High water marks are kept from system start.
+*/
+
+typedef struct
+{
+    /* Number of blocks of each size class that are in use */
+    uint16_t blocksInUse[USB_HOST_MEMORY_POOL_CLASSES_NUMBER];
+
+    /* Largest number of blocks of each size class that were in use */
+    uint16_t blocksHighWaterMark[USB_HOST_MEMORY_POOL_CLASSES_NUMBER];
+
+    /* Number of requested bytes in use */
+    uint32_t bytesInUse;
+
+    /* Largest number of requested bytes that were in use */
+    uint32_t bytesHighWaterMark;
+
+    /* Number of successful allocations */
+    uint32_t allocations;
+
+    /* Number of allocations that failed, including injected failures */
+    uint32_t failures;
+
+} USB_HOST_MEMORY_POOL_STATUS;
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: USB Host Layer MPLAB Harmony System Functions
@@ -1733,6 +1901,329 @@ USB_HOST_RESULT USB_HOST_EventHandlerSet
     uintptr_t context
 );
 
+// *****************************************************************************
+// *****************************************************************************
+// Section: USB Host Layer Trace Routines
+// *****************************************************************************
+// *****************************************************************************
+
+// *****************************************************************************
+/* Function:
+    size_t USB_HOST_TraceRead
+    (
+        USB_HOST_TRACE_RECORD * records,
+        size_t count
+    );
+
+  Summary:
+    Reads records from the host layer trace.
+
+  Description:
+    This function copies up to count of the oldest records in the host layer
+    trace to the records array and removes them from the trace. The host layer
+    keeps USB_HOST_TRACE_RECORDS_NUMBER records. Events that occur while the
+    trace is full are not recorded and are counted instead. The count is
+    returned by USB_HOST_TraceLostCountGet.
+
+  Precondition:
+    The USB_HOST_TRACE_RECORDS_NUMBER configuration constant must be
+    specified.
+
+  Parameters:
+    records - Array where the records should be copied.
+
+    count   - Number of records that fit in the records array.
+
+  Returns:
+    Number of records that were copied.
+
+  Example:
+    <code>
+    // This code shows how the trace can be written to a pcap file. The
+    // APP_Write function is an application function.
+
+    USB_HOST_TRACE_RECORD record;
+    uint8_t buffer[USB_HOST_TRACE_PCAP_RECORD_SIZE];
+
+    APP_Write(buffer, USB_HOST_TracePcapHeaderGet(buffer, sizeof(buffer)));
+
+    while(USB_HOST_TraceRead(&record, 1) == 1)
+    {
+        APP_Write(buffer, USB_HOST_TracePcapRecordGet(&record, buffer, sizeof(buffer)));
+    }
+    </code>
+
+  Remarks:
+    This function can be called from any thread.
+*/
+
+size_t USB_HOST_TraceRead
+(
+    USB_HOST_TRACE_RECORD * records,
+    size_t count
+);
+
+// *****************************************************************************
+/* Function:
+    uint32_t USB_HOST_TraceLostCountGet(void);
+
+  Summary:
+    Returns the number of events that were not recorded.
+
+  Description:
+    This function returns the number of trace events that were not recorded
+    because the trace was full.
+
+  Precondition:
+    The USB_HOST_TRACE_RECORDS_NUMBER configuration constant must be
+    specified.
+
+  Parameters:
+    None.
+
+  Returns:
+    Number of events that were not recorded.
+
+  Example:
+    <code>
+    </code>
+
+  Remarks:
+    None.
+*/
+
+uint32_t USB_HOST_TraceLostCountGet(void);
+
+// *****************************************************************************
+/* Function:
+    size_t USB_HOST_TracePcapHeaderGet
+    (
+        uint8_t * buffer,
+        size_t size
+    );
+
+  Summary:
+    Creates the header of a pcap file.
+
+  Description:
+    This function writes the header of a pcap file with the
+    LINKTYPE_USB_LINUX_MMAPPED link type to the buffer. The packets of the
+    file are created with USB_HOST_TracePcapRecordGet. The resulting file can
+    be opened with Wireshark and other tools that support Linux usbmon
+    captures.
+
+  Precondition:
+    The USB_HOST_TRACE_RECORDS_NUMBER configuration constant must be
+    specified.
+
+  Parameters:
+    buffer  - Buffer where the header should be written.
+
+    size    - Size of the buffer.
+
+  Returns:
+    USB_HOST_TRACE_PCAP_HEADER_SIZE if the header was written. 0 if the buffer
+    is too small.
+
+  Example:
+    <code>
+    // See the example of USB_HOST_TraceRead.
+    </code>
+
+  Remarks:
+    The file is little endian.
+*/
+
+size_t USB_HOST_TracePcapHeaderGet
+(
+    uint8_t * buffer,
+    size_t size
+);
+
+// *****************************************************************************
+/* Function:
+    size_t USB_HOST_TracePcapRecordGet
+    (
+        const USB_HOST_TRACE_RECORD * record,
+        uint8_t * buffer,
+        size_t size
+    );
+
+  Summary:
+    Converts a trace record to a pcap packet.
+
+  Description:
+    This function writes a pcap packet header followed by a 64 byte usbmon
+    packet header for the trace record to the buffer. The IRP status is
+    converted to the errno value that Linux reports for the corresponding
+    error. The transferred data is not part of the trace and is not written.
+
+  Precondition:
+    The USB_HOST_TRACE_RECORDS_NUMBER configuration constant must be
+    specified.
+
+  Parameters:
+    record  - Trace record returned by USB_HOST_TraceRead.
+
+    buffer  - Buffer where the packet should be written.
+
+    size    - Size of the buffer.
+
+  Returns:
+    USB_HOST_TRACE_PCAP_RECORD_SIZE if the packet was written. 0 if the buffer
+    is too small.
+
+  Example:
+    <code>
+    // See the example of USB_HOST_TraceRead.
+    </code>
+
+  Remarks:
+    Bus numbers in the packet start at 1, as in Linux.
+*/
+
+size_t USB_HOST_TracePcapRecordGet
+(
+    const USB_HOST_TRACE_RECORD * record,
+    uint8_t * buffer,
+    size_t size
+);
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: USB Host Layer Memory Pool Routines
+// *****************************************************************************
+// *****************************************************************************
+
+// *****************************************************************************
+/* Function:
+    USB_HOST_RESULT USB_HOST_MemoryPoolStatusGet
+    (
+        USB_HOST_BUS bus,
+        USB_HOST_MEMORY_POOL_STATUS * status
+    );
+
+  Summary:
+    Returns the use of the host layer memory pool.
+
+  Description:
+    This function returns the number of memory pool blocks and bytes that are
+    in use by the specified bus, their high water marks and the number of
+    allocations and allocation failures. If bus is USB_HOST_BUS_ALL, the
+    function returns the totals of all buses.
+
+  Precondition:
+    The USB_HOST_MEMORY_POOL_ENABLE configuration constant must be specified.
+
+  Parameters:
+    bus     - The bus or USB_HOST_BUS_ALL.
+
+    status  - Pointer to where the status should be copied.
+
+  Returns:
+    USB_HOST_RESULT_SUCCESS - The status was copied.
+    USB_HOST_RESULT_BUS_UNKNOWN - The specified bus does not exist.
+    USB_HOST_RESULT_PARAMETER_INVALID - status is NULL.
+
+  Example:
+    <code>
+    USB_HOST_MEMORY_POOL_STATUS poolStatus;
+
+    USB_HOST_MemoryPoolStatusGet(USB_HOST_BUS_ALL, &poolStatus);
+
+    if(poolStatus.blocksHighWaterMark[USB_HOST_MEMORY_POOL_CLASS_LARGE] == USB_HOST_MEMORY_POOL_LARGE_BLOCKS_NUMBER)
+    {
+        // All large blocks were in use at some point.
+    }
+    </code>
+
+  Remarks:
+    This function can be called from any thread.
+*/
+
+USB_HOST_RESULT USB_HOST_MemoryPoolStatusGet
+(
+    USB_HOST_BUS bus,
+    USB_HOST_MEMORY_POOL_STATUS * status
+);
+
+// *****************************************************************************
+/* Function:
+    void USB_HOST_MemoryPoolFailureInjectionSet(uint32_t interval);
+
+  Summary:
+    Makes allocations from the host layer memory pool fail periodically.
+
+  Description:
+    This function is intended for testing the handling of memory allocation
+    failures. After this function is called, every interval allocation from
+    the host layer memory pool fails as if the pool were exhausted. The failed
+    allocations are counted in the failures member of the memory pool status.
+    Setting interval to 0 stops the failure injection.
+
+  Precondition:
+    The USB_HOST_MEMORY_POOL_ENABLE configuration constant must be specified.
+
+  Parameters:
+    interval - Every interval allocation fails. 0 disables failure injection.
+
+  Returns:
+    None.
+
+  Example:
+    <code>
+    // Make every third allocation fail.
+    USB_HOST_MemoryPoolFailureInjectionSet(3);
+    </code>
+
+  Remarks:
+    Failure injection is disabled by default.
+*/
+
+void USB_HOST_MemoryPoolFailureInjectionSet(uint32_t interval);
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: USB Host Layer Descriptor Cache Routines
+// *****************************************************************************
+// *****************************************************************************
+
+// *****************************************************************************
+/* Function:
+    void USB_HOST_DescriptorCacheClear(void);
+
+  Summary:
+    Removes all devices from the descriptor cache.
+
+  Description:
+    This function removes all devices from the host layer descriptor cache.
+    Devices that attach after this function is called are enumerated with all
+    descriptor requests and are added to the cache again. Devices that are
+    already attached are not affected.
+
+  Precondition:
+    The USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER configuration constant must
+    be specified.
+
+  Parameters:
+    None.
+
+  Returns:
+    None.
+
+  Example:
+    <code>
+    // Forget all known devices, for example after a firmware update of the
+    // attached devices.
+    USB_HOST_DescriptorCacheClear();
+    </code>
+
+  Remarks:
+    This function must be called from the thread that calls USB_HOST_Tasks.
+*/
+
+void USB_HOST_DescriptorCacheClear(void);
+
 
 //DOM-IGNORE-BEGIN
 #ifdef __cplusplus
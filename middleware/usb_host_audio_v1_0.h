@@ -2540,6 +2540,277 @@ USB_HOST_AUDIO_V1_RESULT USB_HOST_AUDIO_V1_StreamRead
     size_t length
 );
 
+#if defined(USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER)
+// *****************************************************************************
+/* USB Host Audio v1.0 Application Sample Format
+
+  Summary:
+    Identifies the sample format of the application audio buffers.
+
+  Description:
+    This enumeration identifies the sample format of the audio buffers that
+    the application passes to the USB_HOST_AUDIO_V1_StreamConvertWrite() and
+    USB_HOST_AUDIO_V1_StreamConvertRead() functions.
+
+  Remarks:
+    None.
+*/
+
+typedef enum
+{
+    /* 32 bit signed samples. Full scale is the int32_t range. */
+    USB_HOST_AUDIO_V1_SAMPLE_FORMAT_INT32 = 0,
+
+    /* 32 bit floating point samples. Full scale is -1.0 to 1.0. */
+    USB_HOST_AUDIO_V1_SAMPLE_FORMAT_FLOAT
+
+} USB_HOST_AUDIO_V1_SAMPLE_FORMAT;
+
+// *****************************************************************************
+/* USB Host Audio v1.0 Stream Conversion
+
+  Summary:
+    Describes the conversion between the application audio buffers and the
+    audio stream.
+
+  Description:
+    This structure describes the conversion that the
+    USB_HOST_AUDIO_V1_StreamConvertWrite() and
+    USB_HOST_AUDIO_V1_StreamConvertRead() functions apply between the
+    application audio buffers and the audio stream. The stream side format is
+    the subframe size and the number of channels of the active alternate
+    setting of the audio stream.
+
+  Remarks:
+    None.
+*/
+
+typedef struct
+{
+    /* Sample format of the application buffers */
+    USB_HOST_AUDIO_V1_SAMPLE_FORMAT format;
+
+    /* If true, the application buffers hold one block of samples per
+     * channel. If false, the application buffers hold interleaved audio
+     * frames like the audio stream. */
+    bool planar;
+
+    /* If true, USB_HOST_AUDIO_V1_StreamConvertRead() adds the samples to
+     * the destination buffer instead of overwriting it */
+    bool mix;
+
+    /* Gain in 16.16 format. 0x10000 leaves the samples unchanged. Results are
+     * saturated to full scale. */
+    uint32_t gain;
+
+    /* Sampling frequencies of the application buffers and of the audio
+     * stream in Hz. If they are equal or if either is zero, no rate
+     * adaptation is done. */
+    uint32_t applicationRate;
+    uint32_t streamRate;
+
+} USB_HOST_AUDIO_V1_CONVERSION;
+
+// *****************************************************************************
+/* Function:
+    USB_HOST_AUDIO_V1_RESULT USB_HOST_AUDIO_V1_StreamConversionSet
+    (
+        USB_HOST_AUDIO_V1_STREAM_HANDLE streamHandle,
+        const USB_HOST_AUDIO_V1_CONVERSION * conversion
+    );
+
+  Summary:
+    Sets the conversion applied by the converting stream read and write
+    functions.
+
+  Description:
+    This function sets the application sample format, the buffer layout, the
+    gain and the rate adaptation that the USB_HOST_AUDIO_V1_StreamConvertWrite()
+    and USB_HOST_AUDIO_V1_StreamConvertRead() functions apply. It also resets
+    the rate adaptation state. The function can be called again to change the
+    gain while the stream is running.
+
+  Precondition:
+    The audio stream should have been opened.
+
+  Parameters:
+    streamHandle - Handle to the Audio v1.0 stream
+    conversion   - Pointer to the conversion. The structure is copied.
+
+  Returns:
+    - USB_HOST_AUDIO_V1_RESULT_SUCCESS - The operation was successful
+    - USB_HOST_AUDIO_V1_RESULT_INVALID_PARAMETER - The stream handle or the
+      conversion is not valid
+
+  Example:
+    <code>
+    USB_HOST_AUDIO_V1_CONVERSION conversion;
+
+    conversion.format = USB_HOST_AUDIO_V1_SAMPLE_FORMAT_FLOAT;
+    conversion.planar = false;
+    conversion.mix = false;
+    conversion.gain = 0x10000;
+    conversion.applicationRate = 48000;
+    conversion.streamRate = 44100;
+
+    USB_HOST_AUDIO_V1_StreamConversionSet(appData.outStreamHandle, &conversion);
+    </code>
+
+  Remarks:
+    The rate adaptation uses linear interpolation. It suits small rate
+    differences and clock drift correction better than conversion between
+    unrelated sampling frequencies.
+*/
+
+USB_HOST_AUDIO_V1_RESULT USB_HOST_AUDIO_V1_StreamConversionSet
+(
+    USB_HOST_AUDIO_V1_STREAM_HANDLE streamHandle,
+    const USB_HOST_AUDIO_V1_CONVERSION * conversion
+);
+
+// *****************************************************************************
+/* Function:
+    USB_HOST_AUDIO_V1_RESULT USB_HOST_AUDIO_V1_StreamConvertWrite
+    (
+        USB_HOST_AUDIO_V1_STREAM_HANDLE streamHandle,
+        USB_HOST_AUDIO_V1_STREAM_TRANSFER_HANDLE * transferHandle,
+        const void * source,
+        size_t frames,
+        void * buffer,
+        size_t bufferSize
+    );
+
+  Summary:
+    Converts application audio frames and schedules an audio stream write
+    request with the result.
+
+  Description:
+    This function converts the application audio frames to the format of the
+    audio stream, applying the gain and the rate adaptation set by
+    USB_HOST_AUDIO_V1_StreamConversionSet(), and stores them in the transfer
+    buffer. It then schedules a write request of the converted data like
+    USB_HOST_AUDIO_V1_StreamWrite(). A
+    USB_HOST_AUDIO_V1_STREAM_EVENT_WRITE_COMPLETE event is generated when the
+    request is completed.
+
+    All source frames are consumed. With rate adaptation, the number of
+    frames sent differs from the number of source frames, and the fraction
+    of a frame is carried to the next call.
+
+  Precondition:
+    The audio stream should have been opened and enabled, and
+    USB_HOST_AUDIO_V1_StreamConversionSet() should have been called. The
+    direction of the audio stream should be USB_HOST_AUDIO_V1_DIRECTION_OUT.
+
+  Parameters:
+    streamHandle    - Handle to the Audio v1.0 stream
+    transferHandle  - Handle to the stream write transfer request
+    source          - Pointer to the application audio frames. In planar
+                      layout, the block of each channel is frames samples
+                      long.
+    frames          - Number of application audio frames
+    buffer          - Transfer buffer. It must remain valid until the request
+                      has completed.
+    bufferSize      - Size of the transfer buffer in bytes
+
+  Returns:
+    - USB_HOST_AUDIO_V1_RESULT_SUCCESS - The operation was successful
+    - USB_HOST_AUDIO_V1_RESULT_INVALID_PARAMETER - A parameter is not valid,
+      the transfer buffer is too small or the stream format is not supported
+    - USB_HOST_AUDIO_V1_RESULT_BUSY - The request could not be scheduled. The
+      source frames were not consumed.
+    - USB_HOST_AUDIO_V1_RESULT_FAILURE - An unknown failure occurred
+
+  Example:
+    <code>
+    // appData.samples holds 48 interleaved stereo float frames. appData.packet
+    // is large enough for the converted frames.
+    USB_HOST_AUDIO_V1_StreamConvertWrite(appData.outStreamHandle,
+            &appData.transferHandle, appData.samples, 48,
+            appData.packet, sizeof(appData.packet));
+    </code>
+
+  Remarks:
+    Supported stream formats are PCM with 1 to 4 byte subframes and PCM8,
+    with up to USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER channels.
+*/
+
+USB_HOST_AUDIO_V1_RESULT USB_HOST_AUDIO_V1_StreamConvertWrite
+(
+    USB_HOST_AUDIO_V1_STREAM_HANDLE streamHandle,
+    USB_HOST_AUDIO_V1_STREAM_TRANSFER_HANDLE * transferHandle,
+    const void * source,
+    size_t frames,
+    void * buffer,
+    size_t bufferSize
+);
+
+// *****************************************************************************
+/* Function:
+    USB_HOST_AUDIO_V1_RESULT USB_HOST_AUDIO_V1_StreamConvertRead
+    (
+        USB_HOST_AUDIO_V1_STREAM_HANDLE streamHandle,
+        const void * buffer,
+        size_t length,
+        void * destination,
+        size_t * frames
+    );
+
+  Summary:
+    Converts audio stream data received by a read request to application
+    audio frames.
+
+  Description:
+    This function converts the data of a completed audio stream read request
+    to the application format, applying the rate adaptation and the gain set
+    by USB_HOST_AUDIO_V1_StreamConversionSet(). If mixing is enabled, the
+    samples are added to the destination buffer. The application calls this
+    function when it receives the
+    USB_HOST_AUDIO_V1_STREAM_EVENT_READ_COMPLETE event, with the buffer of the
+    request and the length reported by the event.
+
+  Precondition:
+    USB_HOST_AUDIO_V1_StreamConversionSet() should have been called. The
+    direction of the audio stream should be USB_HOST_AUDIO_V1_DIRECTION_IN.
+
+  Parameters:
+    streamHandle - Handle to the Audio v1.0 stream
+    buffer       - Buffer of the completed read request
+    length       - Number of bytes received
+    destination  - Pointer to the application audio frames
+    frames       - On input, the capacity of the destination buffer in audio
+                   frames. In planar layout, this is also the length of the
+                   block of each channel. On output, the number of audio
+                   frames stored.
+
+  Returns:
+    - USB_HOST_AUDIO_V1_RESULT_SUCCESS - The operation was successful
+    - USB_HOST_AUDIO_V1_RESULT_INVALID_PARAMETER - A parameter is not valid
+      or the stream format is not supported
+
+  Example:
+    <code>
+    size_t frames = 64;
+
+    // In the USB_HOST_AUDIO_V1_STREAM_EVENT_READ_COMPLETE event
+    USB_HOST_AUDIO_V1_StreamConvertRead(appData.inStreamHandle,
+            appData.packet, readCompleteData->length, appData.samples, &frames);
+    </code>
+
+  Remarks:
+    Frames that do not fit in the destination buffer are dropped.
+*/
+
+USB_HOST_AUDIO_V1_RESULT USB_HOST_AUDIO_V1_StreamConvertRead
+(
+    USB_HOST_AUDIO_V1_STREAM_HANDLE streamHandle,
+    const void * buffer,
+    size_t length,
+    void * destination,
+    size_t * frames
+);
+#endif
+
 // *****************************************************************************
 // Section: Global Data Types. This section is specific to PIC32 implementation
 //          of the USB Host Audio V1 Client Driver
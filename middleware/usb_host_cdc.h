@@ -314,6 +314,44 @@ USB_HOST_CDC_EVENT_SERIAL_STATE_NOTIFICATION_RECEIVED_DATA,
 USB_HOST_CDC_EVENT_READ_COMPLETE_DATA,
 USB_HOST_CDC_EVENT_WRITE_COMPLETE_DATA;
 
+// *****************************************************************************
+/* USB Host CDC Client Driver Stream Read Event Data.
+ 
+  Summary:
+    USB Host CDC Client Driver Stream Read Event Data.
+
+  Description:
+    This data type defines the data structure returned by the driver along with
+    the USB_HOST_CDC_EVENT_STREAM_READ_DATA_AVAILABLE event. The unread data
+    in the receive ring is described by two spans. The second span is used
+    only when the unread data wraps around the end of the ring. Its length is
+    0 otherwise.
+
+  Remarks:
+    The spans stay valid until the application releases the data with
+    USB_HOST_CDC_StreamReadCommit().
+*/
+
+typedef struct
+{
+    /* First span of unread data */
+    uint8_t * data;
+
+    /* Size of the first span */
+    size_t length;
+
+    /* Second span of unread data, at the start of the ring */
+    uint8_t * wrapData;
+
+    /* Size of the second span */
+    size_t wrapLength;
+
+    /* Received bytes dropped since the stream was started because the
+     * receive ring was full */
+    uint32_t overflowCount;
+}
+USB_HOST_CDC_EVENT_STREAM_READ_DATA_AVAILABLE_DATA;
+
 // *****************************************************************************
 /* CDC Class Driver Events
 
@@ -424,7 +462,23 @@ typedef enum
     /* This event occurs when the device that this client was connected to has
      * been detached. The client should close the CDC instance. There is no
      * event data associated with this event */
-    USB_HOST_CDC_EVENT_DEVICE_DETACHED
+    USB_HOST_CDC_EVENT_DEVICE_DETACHED,
+
+    /* This event occurs when a stream bulk IN transfer has added data to the
+       receive ring. It is generated only after the application has called
+       USB_HOST_CDC_StreamStart(). The eventData parameter in the event call
+       back function will be of a pointer to a
+       USB_HOST_CDC_EVENT_STREAM_READ_DATA_AVAILABLE_DATA structure. This
+       contains the spans of the receive ring that hold unread data and the
+       overflow count of the stream. The application may consume the data and
+       call USB_HOST_CDC_StreamReadCommit() from the event handler. */
+    USB_HOST_CDC_EVENT_STREAM_READ_DATA_AVAILABLE,
+
+    /* This event occurs when a stream transfer has failed, for example because
+       the device stalled a bulk pipe. The stream does not queue transfers
+       anymore and must be started again. There is no event data associated
+       with this event. */
+    USB_HOST_CDC_EVENT_STREAM_STOPPED
 
 } USB_HOST_CDC_EVENT;
 
@@ -1011,6 +1065,279 @@ USB_HOST_CDC_RESULT USB_HOST_CDC_ACM_ControlLineStateSet
     USB_CDC_CONTROL_LINE_STATE * controlLineState
 );
 
+#if defined(USB_HOST_CDC_STREAM_BUFFER_SIZE)
+// ****************************************************************************
+/* Function:
+    USB_HOST_CDC_RESULT USB_HOST_CDC_StreamStart
+    (
+        USB_HOST_CDC_HANDLE handle
+    );
+           
+  Summary:
+    Starts the streaming mode of a CDC instance.
+
+  Description:
+    This function starts the streaming mode of the specified CDC instance. In
+    streaming mode, the CDC client driver keeps USB_HOST_CDC_STREAM_IRPS_NUMBER
+    bulk IN transfers of USB_HOST_CDC_STREAM_TRANSFER_SIZE bytes queued on the
+    bulk IN pipe. Each completed transfer is copied to a receive ring of
+    USB_HOST_CDC_STREAM_BUFFER_SIZE bytes and queued again at once, so the
+    device is polled continuously and does not have to wait for the
+    application. The application is notified with the
+    USB_HOST_CDC_EVENT_STREAM_READ_DATA_AVAILABLE event and reads the ring in
+    place. Data that arrives while the receive ring is full is dropped and
+    counted in the overflow count.
+
+    Data written with USB_HOST_CDC_StreamWrite() is queued in a transmit ring
+    of the same size and sent on the bulk OUT pipe. No read complete or write
+    complete events are generated for stream data.
+
+    The function empties both rings and clears the overflow count. The stream
+    stops when the device is detached or when a stream transfer fails.
+
+  Precondition:
+    The client handle should be valid.
+
+  Input:
+    handle - handle to the CDC device instance.
+
+  Return:
+    USB_HOST_CDC_RESULT_SUCCESS - The stream was started or is already running.
+
+    USB_HOST_CDC_RESULT_BUSY - The instance is not ready or transfers of the
+    last stream have not completed yet. The client should try again.
+
+    USB_HOST_CDC_RESULT_INVALID_PARAMETER - USB_HOST_CDC_STREAM_TRANSFER_SIZE
+    is not a multiple of the bulk IN maximum packet size of the device.
+
+    USB_HOST_CDC_RESULT_DEVICE_UNKNOWN - The device that this request was
+    targeted to does not exist in the system.
+
+    USB_HOST_CDC_RESULT_FAILURE - The bulk IN transfers could not be queued.
+
+    USB_HOST_CDC_RESULT_HANDLE_INVALID - The client handle is not valid.
+    
+  Example:
+    <code>
+    // Start the stream once the device is attached and the line coding is
+    // set.
+
+    USB_HOST_CDC_EventHandlerSet(appData.cdcHostHandle, APP_USBHostCDCEventHandler,
+            (uintptr_t)&appData);
+    USB_HOST_CDC_StreamStart(appData.cdcHostHandle);
+    </code>
+
+  Remarks:
+    Each stream uses USB_HOST_CDC_STREAM_IRPS_NUMBER host transfer objects for
+    the bulk IN pipe and up to as many for the bulk OUT pipe. 
+    USB_HOST_TRANSFERS_NUMBER should account for them. USB_HOST_CDC_Read()
+    and USB_HOST_CDC_Write() should not be used on an instance while its
+    stream is started.
+*/
+
+USB_HOST_CDC_RESULT USB_HOST_CDC_StreamStart
+(
+    USB_HOST_CDC_HANDLE handle
+);
+
+// ****************************************************************************
+/* Function:
+    size_t USB_HOST_CDC_StreamReadAcquire
+    (
+        USB_HOST_CDC_HANDLE handle,
+        void ** data
+    );
+           
+  Summary:
+    Returns received data that the application can read in place.
+
+  Description:
+    This function returns, in the data parameter, a pointer to the oldest
+    unread data in the receive ring. The return value is the number of
+    contiguous bytes available at that pointer. The data stays valid until it
+    is released with USB_HOST_CDC_StreamReadCommit().
+
+  Precondition:
+    The stream should have been started with USB_HOST_CDC_StreamStart().
+
+  Input:
+    handle - handle to the CDC device instance.
+
+    data - Pointer to a variable that receives the data pointer.
+
+  Return:
+    Number of bytes available at the returned pointer. 0 if there is no
+    unread data.
+    
+  Example:
+    <code>
+    void * data;
+    size_t length;
+
+    length = USB_HOST_CDC_StreamReadAcquire(appData.cdcHostHandle, &data);
+    if(length > 0)
+    {
+        // Consume the data, for example by queuing it to a UART driver.
+        length = APP_UARTWrite(data, length);
+        USB_HOST_CDC_StreamReadCommit(appData.cdcHostHandle, length);
+    }
+    </code>
+
+  Remarks:
+    Unread data that wraps around the end of the ring is returned by the next
+    call after the first part has been released. Data that was received
+    before the stream stopped can still be read.
+*/
+
+size_t USB_HOST_CDC_StreamReadAcquire
+(
+    USB_HOST_CDC_HANDLE handle,
+    void ** data
+);
+
+// ****************************************************************************
+/* Function:
+    USB_HOST_CDC_RESULT USB_HOST_CDC_StreamReadCommit
+    (
+        USB_HOST_CDC_HANDLE handle,
+        size_t size
+    );
+           
+  Summary:
+    Releases received data that the application has consumed.
+
+  Description:
+    This function releases the first size bytes of unread data in the
+    receive ring. The released space is available to the next bulk IN
+    transfers.
+
+  Precondition:
+    The stream should have been started with USB_HOST_CDC_StreamStart().
+
+  Input:
+    handle - handle to the CDC device instance.
+
+    size - Number of bytes consumed by the application.
+
+  Return:
+    USB_HOST_CDC_RESULT_SUCCESS - The data was released.
+
+    USB_HOST_CDC_RESULT_INVALID_PARAMETER - size is larger than the amount of
+    unread data.
+
+    USB_HOST_CDC_RESULT_HANDLE_INVALID - The client handle is not valid.
+    
+  Example:
+    <code>
+    </code>
+
+  Remarks:
+    This function can be called from the
+    USB_HOST_CDC_EVENT_STREAM_READ_DATA_AVAILABLE event handler.
+*/
+
+USB_HOST_CDC_RESULT USB_HOST_CDC_StreamReadCommit
+(
+    USB_HOST_CDC_HANDLE handle,
+    size_t size
+);
+
+// ****************************************************************************
+/* Function:
+    uint32_t USB_HOST_CDC_StreamOverflowCountGet
+    (
+        USB_HOST_CDC_HANDLE handle
+    );
+           
+  Summary:
+    Returns the number of received bytes that the stream has dropped.
+
+  Description:
+    This function returns the number of received bytes that were dropped
+    since the stream was started because the receive ring was full. A growing
+    count means that the application does not consume the data as fast as the
+    device sends it.
+
+  Precondition:
+    The stream should have been started with USB_HOST_CDC_StreamStart().
+
+  Input:
+    handle - handle to the CDC device instance.
+
+  Return:
+    Number of dropped bytes.
+    
+  Example:
+    <code>
+    </code>
+
+  Remarks:
+    The same count is reported with each
+    USB_HOST_CDC_EVENT_STREAM_READ_DATA_AVAILABLE event.
+*/
+
+uint32_t USB_HOST_CDC_StreamOverflowCountGet
+(
+    USB_HOST_CDC_HANDLE handle
+);
+
+// ****************************************************************************
+/* Function:
+    size_t USB_HOST_CDC_StreamWrite
+    (
+        USB_HOST_CDC_HANDLE handle,
+        const void * data,
+        size_t size
+    );
+           
+  Summary:
+    Queues data for transmission to the attached device.
+
+  Description:
+    This function copies data to the transmit ring of the stream and returns
+    the number of bytes that were accepted. This is less than size if the
+    ring does not have enough free space. The data is sent on the bulk OUT
+    pipe with up to USB_HOST_CDC_STREAM_IRPS_NUMBER transfers in flight.
+
+    Small writes are coalesced. While a transfer is in flight, data that does
+    not fill a packet is held back and sent together with the data that is
+    written next. A transfer carries a multiple of the bulk OUT maximum packet
+    size whenever at least one packet is queued. The remainder is sent as a
+    short packet once the pipe is idle.
+
+  Precondition:
+    The stream should have been started with USB_HOST_CDC_StreamStart().
+
+  Input:
+    handle - handle to the CDC device instance.
+
+    data - Pointer to the data to be sent.
+
+    size - Number of bytes to be sent.
+
+  Return:
+    Number of bytes accepted. 0 if the ring is full or if the stream is not
+    started.
+    
+  Example:
+    <code>
+    // Queue what fits and send the rest in a later application task.
+    appData.written += USB_HOST_CDC_StreamWrite(appData.cdcHostHandle,
+            &appData.buffer[appData.written], appData.length - appData.written);
+    </code>
+
+  Remarks:
+    The data buffer can be reused as soon as the function returns.
+*/
+
+size_t USB_HOST_CDC_StreamWrite
+(
+    USB_HOST_CDC_HANDLE handle,
+    const void * data,
+    size_t size
+);
+#endif
+
 
 //DOM-IGNORE-BEGIN
 #ifdef __cplusplus
@@ -333,7 +333,11 @@ typedef enum
        usageDriverEventHandler function callback will notify this event with
        unprocessed INTERRUPT IN data (raw data as sent by device) as event
        specific data. This event data needs to be type caste to uint64_t.
-       Report ID, if present, is not extracted from the data. */
+       Report ID, if present, is not extracted from the data.
+       When USB_HOST_HID_REPORT_BUFFERS_NUMBER is defined the data points to
+       a report buffer of the HID client driver. The buffer is valid until the
+       usage driver task routine, which is called right after this event,
+       returns. The usage driver must not modify the data. */
     USB_HOST_HID_EVENT_REPORT_RECEIVED,
 
     /* OUTPUT Report sent - This event occurs when OUTPUT REPORT is sent by
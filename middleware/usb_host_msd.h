@@ -412,6 +412,68 @@ USB_HOST_MSD_RESULT USB_HOST_MSD_Transfer
     uintptr_t context
 );
 
+// *****************************************************************************
+/* Function:
+   USB_HOST_MSD_RESULT USB_HOST_MSD_TransferQueue
+   (
+       USB_HOST_MSD_LUN_HANDLE lunHandle,
+       uint8_t * cdb,
+       uint8_t cdbLength,
+       void * data,
+       size_t size,
+       USB_HOST_MSD_TRANSFER_DIRECTION transferDirection,
+       USB_HOST_MSD_TRANSFER_CALLBACK callback,
+       uintptr_t context
+   )
+
+  Summary:
+    This function schedules a MSD BOT transfer or queues it behind the
+    transfer in progress.
+
+  Description:
+    This function is similar to USB_HOST_MSD_Transfer. If a BOT transfer is in
+    progress, the CBW of this transfer is prepared and the transfer is started
+    from the transfer event handler as soon as the current transfer has
+    completed with a passed status. This removes the task latency between the
+    CSW of one command and the CBW of the next command. One transfer can be
+    queued per MSD instance.
+
+  Preconditions:
+    None.
+
+  Parameters:
+    The parameters are the same as those of the USB_HOST_MSD_Transfer
+    function.
+
+  Returns:
+    USB_HOST_MSD_RESULT_FAILURE - An unknown failure occurred.
+    USB_HOST_MSD_RESULT_BUSY - The transfer cannot be scheduled or queued
+    right now. The caller should retry.
+    USB_HOST_MSD_RESULT_LUN_HANDLE_INVALID - This LUN does not exist in the
+    system.
+    USB_HOST_MSD_RESULT_SUCCESS - The transfer request was scheduled or
+    queued.
+
+  Remarks:
+    If the transfer in progress does not pass, the queued transfer is not
+    started. Its callback is then called with a USB_HOST_MSD_RESULT_BUSY
+    result. The caller should find out why the previous command failed and
+    then submit the transfer again. This is a local function and should not be
+    called directly by the application.
+*/
+
+USB_HOST_MSD_RESULT USB_HOST_MSD_TransferQueue
+(
+    USB_HOST_MSD_LUN_HANDLE lunHandle,
+    uint8_t * cdb,
+    uint8_t cdbLength,
+    void * data,
+    size_t size,
+    USB_HOST_MSD_TRANSFER_DIRECTION transferDirection,
+    USB_HOST_MSD_TRANSFER_CALLBACK callback,
+    uintptr_t context
+);
+
 // *****************************************************************************
 /* Function:
     void USB_HOST_MSD_TransferErrorTasks
@@ -147,6 +147,11 @@
 <#elseif usb_device_audio_0.CONFIG_USB_DEVICE_FUNCTION_AUDIO_VERSION == "Audio v2">
 #define USB_DEVICE_AUDIO_V2_MAX_ALTERNATE_SETTING      ${maxAlternateInterfaceSetting}
 </#if>
+<#if usb_device_audio_0.CONFIG_USB_DEVICE_FUNCTION_AUDIO_VERSION == "Audio v2" && CONFIG_USB_DEVICE_AUDIO_V2_STREAM_ENABLE == true>
+
+/* Packet IRPs per Audio 2.0 isochronous stream */
+#define USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER      ${CONFIG_USB_DEVICE_AUDIO_V2_STREAM_PACKETS_NUMBER}
+</#if>
 
 <#--
 /*******************************************************************************
@@ -49,6 +49,12 @@ SUBSTITUTE  GOODS,  TECHNOLOGY,  SERVICES,  OR  ANY  CLAIMS  BY  THIRD   PARTIES
    write. Applicable to all instances of the
    function driver */
 #define USB_DEVICE_CDC_QUEUE_DEPTH_COMBINED                 ${CONFIG_USB_DEVICE_CDC_QUEUE_DEPTH_COMBINED}
+<#if CONFIG_USB_DEVICE_CDC_STREAM_ENABLE == true>
+
+/* CDC streaming mode ring size and number of IRPs per bulk endpoint */
+#define USB_DEVICE_CDC_STREAM_BUFFER_SIZE                   ${CONFIG_USB_DEVICE_CDC_STREAM_BUFFER_SIZE}
+#define USB_DEVICE_CDC_STREAM_IRPS_NUMBER                   ${CONFIG_USB_DEVICE_CDC_STREAM_IRPS_NUMBER}
+</#if>
 <#--
 /*******************************************************************************
  End of File
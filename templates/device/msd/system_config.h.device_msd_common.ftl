@@ -46,6 +46,17 @@
 #define USB_DEVICE_MSD_INSTANCES_NUMBER     ${__INSTANCE_COUNT} 
 
 #define USB_DEVICE_MSD_NUM_SECTOR_BUFFERS ${CONFIG_USB_DEVICE_FUNCTION_MSD_MAX_SECTORS_COMMON}
+<#if CONFIG_USB_DEVICE_FUNCTION_MSD_WRITE_CACHE_ENABLE == true>
+
+/* MSD write cache */
+#define USB_DEVICE_MSD_WRITE_CACHE_BLOCKS_NUMBER ${CONFIG_USB_DEVICE_FUNCTION_MSD_WRITE_CACHE_BLOCKS}
+#define USB_DEVICE_MSD_WRITE_CACHE_BLOCK_SIZE ${CONFIG_USB_DEVICE_FUNCTION_MSD_WRITE_CACHE_BLOCK_SIZE}
+</#if>
+<#if CONFIG_USB_DEVICE_FUNCTION_MSD_READ_AHEAD_ENABLE == true>
+
+/* MSD read ahead */
+#define USB_DEVICE_MSD_READ_AHEAD_SECTORS_NUMBER ${CONFIG_USB_DEVICE_FUNCTION_MSD_READ_AHEAD_SECTORS}
+</#if>
 
 <#-- Find out max LUN -->
 <#assign maxLUN = 0>
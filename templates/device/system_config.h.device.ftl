@@ -85,6 +85,26 @@
 #define USB_DEVICE_BOS_DESCRIPTOR_SUPPORT_ENABLE
 </#if>
 
+<#if CONFIG_USB_DEVICE_FEATURE_ENABLE_STATISTICS == true>
+/* Enable endpoint statistics */
+#define USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER              ${CONFIG_USB_DEVICE_STATISTICS_ENDPOINTS_NUMBER}
+#define USB_DEVICE_STATISTICS_IRPS_NUMBER                   ${CONFIG_USB_DEVICE_STATISTICS_IRPS_NUMBER}
+<#if CONFIG_USB_DEVICE_STATISTICS_VENDOR_REQUEST != 0>
+#define USB_DEVICE_STATISTICS_VENDOR_REQUEST                ${CONFIG_USB_DEVICE_STATISTICS_VENDOR_REQUEST}
+</#if>
+</#if>
+
+<#if CONFIG_USB_DEVICE_FEATURE_ENABLE_IRP_BOUNCE_BUFFERS == true>
+/* Bounce buffers for IRPs with data segments */
+#define USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER                ${CONFIG_USB_DEVICE_IRP_BOUNCE_BUFFERS_NUMBER}
+#define USB_DEVICE_IRP_BOUNCE_BUFFER_SIZE                   ${CONFIG_USB_DEVICE_IRP_BOUNCE_BUFFER_SIZE}
+</#if>
+
+<#if CONFIG_USB_DEVICE_FEATURE_ENABLE_IRP_POOL == true>
+/* Number of IRPs in the pool shared by the function drivers */
+#define USB_DEVICE_IRP_POOL_SIZE                            ${CONFIG_USB_DEVICE_IRP_POOL_SIZE}
+</#if>
+
 <#if CONFIG_USB_DEVICE_FEATURE_ENABLE_ADVANCED_STRING_DESCRIPTOR_TABLE == true>
 /* Enable Advanced String Descriptor table. This feature lets the user specify
    String Index along with the String descriptor Structure  */
@@ -56,6 +56,12 @@
 /* Maximum Number of pipes */
 #define DRV_USB_UHP_PIPES_NUMBER                       10  
 
+/* Number of EHCI qTDs shared by the bulk pipes */
+#define DRV_USB_UHP_EHCI_QTD_NUMBER                    ${USB_DRV_HOST_EHCI_QTD_NUMBER}
+
+/* Number of EHCI iTDs of each isochronous pipe */
+#define DRV_USB_UHP_EHCI_ITD_NUMBER                    ${USB_DRV_HOST_EHCI_ITD_NUMBER}
+
 /* Attach Debounce duration in milli Seconds */ 
 #define DRV_USB_UHP_ATTACH_DEBOUNCE_DURATION           ${USB_DRV_HOST_ATTACH_DEBOUNCE_DURATION}
 
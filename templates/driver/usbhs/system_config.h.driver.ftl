@@ -58,6 +58,18 @@
 	
 /* Disable Host Support */
 #define DRV_USBHS_HOST_SUPPORT                            false
+<#if (USB_DRV_DEVICE_DMA_SCHEDULER_ENABLE?has_content)
+	  && (USB_DRV_DEVICE_DMA_SCHEDULER_ENABLE == true)>
+
+/* DMA channels reserved for each higher endpoint weight level */
+#define DRV_USBHS_DEVICE_DMA_CHANNELS_RESERVED            ${USB_DRV_DEVICE_DMA_CHANNELS_RESERVED}
+
+/* Number of DMA bounce buffers for unaligned buffers */
+#define DRV_USBHS_DEVICE_DMA_BOUNCE_BUFFERS_NUMBER        ${USB_DRV_DEVICE_DMA_BOUNCE_BUFFERS_NUMBER}
+
+/* Size of a DMA bounce buffer */
+#define DRV_USBHS_DEVICE_DMA_BOUNCE_BUFFER_SIZE           ${USB_DRV_DEVICE_DMA_BOUNCE_BUFFER_SIZE}
+</#if>
 
 
 
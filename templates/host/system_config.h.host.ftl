@@ -93,6 +93,33 @@
 
 /* Number of Host Layer Clients */
 #define USB_HOST_CLIENTS_NUMBER                             1   
+<#if CONFIG_USB_HOST_TRACE_ENABLE == true>
+
+/* Number of records in the host layer transfer trace */
+#define USB_HOST_TRACE_RECORDS_NUMBER                       ${CONFIG_USB_HOST_TRACE_RECORDS_NUMBER}
+</#if>
+<#if CONFIG_USB_HOST_MEMORY_POOL_ENABLE == true>
+
+/* Host layer static memory pool for descriptor buffers */
+#define USB_HOST_MEMORY_POOL_ENABLE
+#define USB_HOST_MEMORY_POOL_SMALL_BLOCK_SIZE               ${CONFIG_USB_HOST_MEMORY_POOL_SMALL_BLOCK_SIZE}
+#define USB_HOST_MEMORY_POOL_SMALL_BLOCKS_NUMBER            ${CONFIG_USB_HOST_MEMORY_POOL_SMALL_BLOCKS_NUMBER}
+#define USB_HOST_MEMORY_POOL_MEDIUM_BLOCK_SIZE              ${CONFIG_USB_HOST_MEMORY_POOL_MEDIUM_BLOCK_SIZE}
+#define USB_HOST_MEMORY_POOL_MEDIUM_BLOCKS_NUMBER           ${CONFIG_USB_HOST_MEMORY_POOL_MEDIUM_BLOCKS_NUMBER}
+#define USB_HOST_MEMORY_POOL_LARGE_BLOCK_SIZE               ${CONFIG_USB_HOST_MEMORY_POOL_LARGE_BLOCK_SIZE}
+#define USB_HOST_MEMORY_POOL_LARGE_BLOCKS_NUMBER            ${CONFIG_USB_HOST_MEMORY_POOL_LARGE_BLOCKS_NUMBER}
+</#if>
+<#if CONFIG_USB_HOST_DESCRIPTOR_CACHE_ENABLE == true>
+
+/* Host layer descriptor cache for fast re-enumeration */
+#define USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER            ${CONFIG_USB_HOST_DESCRIPTOR_CACHE_ENTRIES_NUMBER}
+#define USB_HOST_DESCRIPTOR_CACHE_CONFIGURATION_SIZE        ${CONFIG_USB_HOST_DESCRIPTOR_CACHE_CONFIGURATION_SIZE}
+</#if>
+<#if CONFIG_USB_HOST_TPL_INDEX_ENABLE == true>
+
+/* Index of the Target Peripheral List */
+#define USB_HOST_TPL_INDEX_ENTRIES_NUMBER                   ${CONFIG_USB_HOST_TPL_INDEX_ENTRIES_NUMBER}
+</#if>
 <#--
 /*******************************************************************************
  End of File
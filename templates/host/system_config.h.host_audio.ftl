@@ -56,6 +56,11 @@
 
 /* Maximum number of discrete Sampling frequencies supported by the Attached Audio Device */ 
 #define USB_HOST_AUDIO_V1_SAMPLING_FREQUENCIES_NUMBER 0
+<#if CONFIG_USB_HOST_AUDIO_CONVERSION_ENABLE == true>
+
+/* Maximum number of channels of a converted Audio stream */
+#define USB_HOST_AUDIO_V1_CONVERSION_CHANNELS_NUMBER ${CONFIG_USB_HOST_AUDIO_CONVERSION_CHANNELS_NUMBER}
+</#if>
 <#--
 /*******************************************************************************
  End of File
@@ -47,6 +47,13 @@
 
 /* Number of CDC Attach Listeners */ 
 #define USB_HOST_CDC_ATTACH_LISTENERS_NUMBER        ${CONFIG_USB_HOST_CDC_ATTACH_LISTENERS_NUMBER}
+<#if CONFIG_USB_HOST_CDC_STREAM_ENABLE == true>
+
+/* CDC streaming mode ring size, queued transfers and transfer size */
+#define USB_HOST_CDC_STREAM_BUFFER_SIZE             ${CONFIG_USB_HOST_CDC_STREAM_BUFFER_SIZE}
+#define USB_HOST_CDC_STREAM_IRPS_NUMBER             ${CONFIG_USB_HOST_CDC_STREAM_IRPS_NUMBER}
+#define USB_HOST_CDC_STREAM_TRANSFER_SIZE           ${CONFIG_USB_HOST_CDC_STREAM_TRANSFER_SIZE}
+</#if>
 <#--
 /*******************************************************************************
  End of File
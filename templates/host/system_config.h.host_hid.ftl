@@ -54,6 +54,17 @@
 /* Maximum number PUSH items that can be saved in the Global item queue per field
  * per HID interface */
 #define USB_HID_GLOBAL_PUSH_POP_STACK_SIZE 1
+<#if CONFIG_USB_HOST_HID_MAIN_ITEM_INDEX_SIZE gt 0>
+
+/* Number of main items indexed per HID interface Report Descriptor */
+#define USB_HOST_HID_MAIN_ITEM_INDEX_SIZE ${CONFIG_USB_HOST_HID_MAIN_ITEM_INDEX_SIZE}
+</#if>
+<#if CONFIG_USB_HOST_HID_REPORT_BUFFERS_NUMBER gt 1>
+
+/* Number of INTERRUPT IN report buffers per HID interface. Enables the
+ * batched report engine. */
+#define USB_HOST_HID_REPORT_BUFFERS_NUMBER ${CONFIG_USB_HOST_HID_REPORT_BUFFERS_NUMBER}
+</#if>
 
 <#if CONFIG_USB_HOST_USE_MOUSE == true>
 /* Maximum number Mouse buttons whose value will be captured per HID Mouse device */
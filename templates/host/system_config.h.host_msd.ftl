@@ -49,6 +49,9 @@
 #define USB_HOST_SCSI_INSTANCES_NUMBER        ${CONFIG_USB_HOST_MSD_NUMBER_OF_INSTANCES}
 #define USB_HOST_MSD_LUN_NUMBERS              ${CONFIG_USB_HOST_MSD_NUMBER_OF_INSTANCES}
 
+/* Number of block requests that can be queued per Logical Unit */
+#define USB_HOST_SCSI_COMMAND_QUEUE_DEPTH     ${CONFIG_USB_HOST_SCSI_COMMAND_QUEUE_DEPTH}
+
 <#--
 /*******************************************************************************
  End of File